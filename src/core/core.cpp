@@ -81,6 +81,7 @@
 #include "dockmanager.h"
 #include "entitymanager.h"
 #include "rootwindowsmanager.h"
+#include "tracer.h"
 
 using namespace LeechCraft::Util;
 
@@ -157,6 +158,8 @@ namespace LeechCraft
 
 					XmlSettingsManager::Instance ()->Release ();
 
+					Tracer::Instance ().Dump ();
+
 					qApp->quit ();
 				});
 	}
@@ -39,6 +39,7 @@
 #include "config.h"
 #include "colorthemeengine.h"
 #include "rootwindowsmanager.h"
+#include "tracer.h"
 
 namespace LeechCraft
 {
@@ -83,6 +84,11 @@ namespace LeechCraft
 		return &ColorThemeEngine::Instance ();
 	}
 
+	ITracer* CoreProxy::GetTracer () const
+	{
+		return &Tracer::Instance ();
+	}
+
 	ITagsManager* CoreProxy::GetTagsManager () const
 	{
 		return &TagsManager::Instance ();
@@ -62,6 +62,7 @@ namespace LeechCraft
 		IColorThemeManager* GetColorThemeManager () const;
 
 		ITagsManager* GetTagsManager () const;
+		ITracer* GetTracer () const;
 		QStringList GetSearchCategories () const;
 		int GetID ();
 		void FreeID (int);
@@ -33,9 +33,11 @@
 #include <QThread>
 #include <QDesktopServices>
 #include <QUrl>
+#include <QElapsedTimer>
 #include "util/util.h"
 #include "util/sll/prelude.h"
 #include "util/sll/slotclosure.h"
+#include "util/sys/tracespan.h"
 #include "interfaces/structures.h"
 #include "interfaces/idownload.h"
 #include "interfaces/ientityhandler.h"
@@ -44,6 +46,8 @@
 #include "pluginmanager.h"
 #include "xmlsettingsmanager.h"
 #include "handlerchoicedialog.h"
+#include "entityroutingindex.h"
+#include "tracer.h"
 
 namespace LeechCraft
 {
@@ -57,12 +61,25 @@ namespace LeechCraft
 		template<typename T, typename F>
 		QObjectList GetSubtype (const Entity& e, bool fullScan, const F& queryFunc)
 		{
-			auto pm = Core::Instance ().GetPluginManager ();
+			auto& tracer = Tracer::Instance ();
+
+			const auto index = Core::Instance ().GetPluginManager ()->GetEntityRoutingIndex ();
+			const auto iid = qobject_interface_iid<T> ();
+			const auto& shape = index->GetShape (e, iid);
+
+			const auto& candidates = index->GetCandidates (e, iid, shape);
+			tracer.SetCounter ("entity", "Dispatch candidates", candidates.size ());
+
 			QMap<int, QObjectList> result;
 			int cutoffPriority = 0;
-			for (const auto& plugin : pm->GetAllCastableRoots<T> ())
+			for (const auto& plugin : candidates)
 			{
+				Util::TraceSpan span { &tracer, "entity",
+						[plugin] { return "Querying " + qobject_cast<IInfo*> (plugin)->GetName (); } };
+
 				EntityTestHandleResult r;
+				QElapsedTimer timer;
+				timer.start ();
 				try
 				{
 					r = queryFunc (e, qobject_cast<T> (plugin));
@@ -82,6 +99,9 @@ namespace LeechCraft
 						<< plugin;
 					continue;
 				}
+
+				index->RecordResult (plugin, shape, r.HandlePriority_ > 0, timer.nsecsElapsed ());
+
 				if (r.HandlePriority_ <= 0)
 					continue;
 
@@ -113,6 +133,8 @@ namespace LeechCraft
 			if (Core::Instance ().IsShuttingDown ())
 				return {};
 
+			Core::Instance ().GetPluginManager ()->LoadDeferredFor (e);
+
 			const auto& unwanted = e.Additional_ ["IgnorePlugins"].toStringList ();
 			auto removeUnwanted = [&unwanted] (QObjectList& handlers)
 			{
@@ -264,6 +286,8 @@ namespace LeechCraft
 		if (!CheckInitStage (e, desired, &EntityManager::DelegateEntity))
 			return {};
 
+		Util::TraceSpan span { &Tracer::Instance (), "entity", "EntityManager::DelegateEntity" };
+
 		e.Parameters_ |= OnlyDownload;
 		QObjectList handlers;
 		const bool foundOk = GetPreparedObjectList (e, desired, handlers, false);
@@ -290,6 +314,8 @@ namespace LeechCraft
 			return res;
 		}
 
+		Util::TraceSpan span { &Tracer::Instance (), "entity", "EntityManager::CouldHandle" };
+
 		const auto pm = Core::Instance ().GetPluginManager ();
 		if (pm->GetInitStage () == PluginManager::InitStage::BeforeFirst)
 		{
@@ -320,6 +346,8 @@ namespace LeechCraft
 		if (!CheckInitStage (e, desired, &EntityManager::HandleEntity))
 			return false;
 
+		Util::TraceSpan span { &Tracer::Instance (), "entity", "EntityManager::HandleEntity" };
+
 		QObjectList handlers;
 		const bool foundOk = GetPreparedObjectList (e, desired, handlers, true);
 		if (!foundOk || handlers.isEmpty ())
@@ -348,6 +376,8 @@ namespace LeechCraft
 
 	QList<QObject*> EntityManager::GetPossibleHandlers (const Entity& e)
 	{
+		Util::TraceSpan span { &Tracer::Instance (), "entity", "EntityManager::GetPossibleHandlers" };
+
 		const auto pm = Core::Instance ().GetPluginManager ();
 		if (pm->GetInitStage () == PluginManager::InitStage::BeforeFirst)
 		{
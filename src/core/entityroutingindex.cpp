@@ -0,0 +1,287 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "entityroutingindex.h"
+#include <algorithm>
+#include <QUrl>
+#include <QtDebug>
+#include "interfaces/structures.h"
+#include "interfaces/iinfo.h"
+
+namespace LeechCraft
+{
+	namespace
+	{
+		const int MaxCachedShapes = 1024;
+
+		QString GetScheme (const Entity& e)
+		{
+			return e.Entity_.type () == QVariant::Url ?
+					e.Entity_.toUrl ().scheme () :
+					QString {};
+		}
+
+		QString GetType (const Entity& e)
+		{
+			return QString::fromLatin1 (e.Entity_.typeName ());
+		}
+	}
+
+	bool EntityRoutingIndex::Filter::Matches (const Entity& e, const QString& scheme, const QString& type) const
+	{
+		if (!Mimes_.isEmpty () || !MimePrefixes_.isEmpty ())
+		{
+			const bool mimeMatches = Mimes_.contains (e.Mime_) ||
+					std::any_of (MimePrefixes_.begin (), MimePrefixes_.end (),
+							[&e] (const QString& prefix) { return e.Mime_.startsWith (prefix); });
+			if (!mimeMatches)
+				return false;
+		}
+
+		if (!Schemes_.isEmpty () && !Schemes_.contains (scheme))
+			return false;
+
+		if (!EntityTypes_.isEmpty () && !EntityTypes_.contains (type))
+			return false;
+
+		if (!AdditionalKeys_.isEmpty () &&
+				std::none_of (AdditionalKeys_.begin (), AdditionalKeys_.end (),
+						[&e] (const QString& key) { return e.Additional_.contains (key); }))
+			return false;
+
+		return true;
+	}
+
+	EntityRoutingIndex::EntityRoutingIndex (const PluginsGetter_f& pluginsGetter,
+			const ManifestGetter_f& manifestGetter)
+	: GetPlugins_ { pluginsGetter }
+	, GetManifest_ { manifestGetter }
+	{
+	}
+
+	void EntityRoutingIndex::Invalidate ()
+	{
+		IsValid_ = false;
+	}
+
+	QByteArray EntityRoutingIndex::GetShape (const Entity& e, const char *iid) const
+	{
+		QByteArray result { iid };
+		result += '\n';
+		result += e.Mime_.toUtf8 ();
+		result += '\n';
+		result += GetScheme (e).toUtf8 ();
+		result += '\n';
+		result += e.Entity_.typeName ();
+		result += '\n';
+		result += QByteArray::number (static_cast<int> (e.Parameters_));
+		for (const auto& key : e.Additional_.keys ())
+		{
+			result += '\n';
+			result += key.toUtf8 ();
+		}
+		return result;
+	}
+
+	QObjectList EntityRoutingIndex::GetCandidates (const Entity& e, const char *iid, const QByteArray& shape)
+	{
+		if (!IsValid_)
+			Rebuild ();
+
+		const auto& scheme = GetScheme (e);
+		const auto& type = GetType (e);
+
+		QSet<QObject*> matched;
+		auto collect = [&] (const QObjectList& plugins)
+		{
+			for (const auto plugin : plugins)
+				if (Filters_ [plugin].Matches (e, scheme, type))
+					matched << plugin;
+		};
+		collect (Mime2Plugins_.value (e.Mime_));
+		collect (Scheme2Plugins_.value (scheme));
+		collect (Type2Plugins_.value (type));
+		collect (Unindexed_);
+
+		const auto& negatives = Negatives_.value (shape);
+
+		QObjectList result;
+		for (const auto plugin : GetRoots (iid))
+			if ((Unfiltered_.contains (plugin) || matched.contains (plugin)) &&
+					!negatives.contains (plugin))
+				result << plugin;
+		return result;
+	}
+
+	void EntityRoutingIndex::RecordResult (QObject *plugin, const QByteArray& shape, bool accepted, qint64 elapsedNs)
+	{
+		auto& stats = Stats_ [plugin];
+		++stats.Queries_;
+		if (accepted)
+			++stats.Accepted_;
+		stats.TotalNs_ += elapsedNs;
+		stats.MaxNs_ = std::max (stats.MaxNs_, elapsedNs);
+
+		if (accepted || !Filters_.value (plugin).CacheNegative_)
+			return;
+
+		if (Negatives_.size () >= MaxCachedShapes && !Negatives_.contains (shape))
+			Negatives_.clear ();
+
+		Negatives_ [shape] << plugin;
+	}
+
+	const QHash<QObject*, EntityRoutingIndex::DispatchStats>& EntityRoutingIndex::GetDispatchStats () const
+	{
+		return Stats_;
+	}
+
+	void EntityRoutingIndex::DumpDispatchStats () const
+	{
+		auto plugins = Stats_.keys ();
+		std::sort (plugins.begin (), plugins.end (),
+				[this] (QObject *left, QObject *right)
+					{ return Stats_ [left].TotalNs_ > Stats_ [right].TotalNs_; });
+
+		qDebug () << Q_FUNC_INFO
+				<< "entity dispatch stats:";
+		for (const auto plugin : plugins)
+		{
+			const auto& stats = Stats_ [plugin];
+			const auto ii = qobject_cast<IInfo*> (plugin);
+			qDebug () << "\t"
+					<< (ii ? ii->GetUniqueID () : QByteArray { "<unknown>" })
+					<< stats.Queries_
+					<< "queries,"
+					<< stats.Accepted_
+					<< "accepted,"
+					<< stats.TotalNs_ / 1000
+					<< "us total,"
+					<< stats.MaxNs_ / 1000
+					<< "us max";
+		}
+	}
+
+	bool EntityRoutingIndex::MayHandle (const QByteArray& id, const QVariantMap& manifest, const Entity& e)
+	{
+		auto pos = DeferredFilters_.find (id);
+		if (pos == DeferredFilters_.end ())
+			pos = DeferredFilters_.insert (id, ParseFilter (manifest));
+
+		return !*pos || (*pos)->Matches (e, GetScheme (e), GetType (e));
+	}
+
+	boost::optional<EntityRoutingIndex::Filter> EntityRoutingIndex::ParseFilter (const QVariantMap& manifest)
+	{
+		const auto& filterMap = manifest ["EntityFilter"].toMap ();
+		if (filterMap.isEmpty ())
+			return {};
+
+		Filter filter;
+		for (const auto& mime : filterMap ["Mimes"].toStringList ())
+			if (mime.endsWith ('*'))
+				filter.MimePrefixes_ << mime.left (mime.size () - 1);
+			else
+				filter.Mimes_ << mime;
+		filter.Schemes_ = filterMap ["Schemes"].toStringList ().toSet ();
+		filter.EntityTypes_ = filterMap ["EntityTypes"].toStringList ().toSet ();
+		filter.AdditionalKeys_ = filterMap ["AdditionalKeys"].toStringList ();
+		filter.CacheNegative_ = filterMap ["CacheNegative"].toBool ();
+		return filter;
+	}
+
+	void EntityRoutingIndex::Rebuild ()
+	{
+		Plugins_ = GetPlugins_ ();
+		IID2Roots_.clear ();
+
+		Unfiltered_.clear ();
+		Filters_.clear ();
+		Mime2Plugins_.clear ();
+		Scheme2Plugins_.clear ();
+		Type2Plugins_.clear ();
+		Unindexed_.clear ();
+
+		Negatives_.clear ();
+
+		const auto& present = Plugins_.toSet ();
+		for (auto i = Stats_.begin (); i != Stats_.end (); )
+			if (present.contains (i.key ()))
+				++i;
+			else
+				i = Stats_.erase (i);
+
+		for (const auto plugin : Plugins_)
+		{
+			const auto& maybeFilter = ParseFilter (GetManifest_ (plugin));
+			if (!maybeFilter)
+			{
+				Unfiltered_ << plugin;
+				continue;
+			}
+
+			const auto& filter = *maybeFilter;
+
+			// Any single category is a necessary condition, so a plugin
+			// is indexed by the most selective one it declares.
+			if (!filter.Mimes_.isEmpty () && filter.MimePrefixes_.isEmpty ())
+				for (const auto& mime : filter.Mimes_)
+					Mime2Plugins_ [mime] << plugin;
+			else if (!filter.Schemes_.isEmpty ())
+				for (const auto& scheme : filter.Schemes_)
+					Scheme2Plugins_ [scheme] << plugin;
+			else if (!filter.EntityTypes_.isEmpty ())
+				for (const auto& type : filter.EntityTypes_)
+					Type2Plugins_ [type] << plugin;
+			else
+				Unindexed_ << plugin;
+
+			Filters_ [plugin] = filter;
+		}
+
+		IsValid_ = true;
+	}
+
+	const QObjectList& EntityRoutingIndex::GetRoots (const char *iid)
+	{
+		const QByteArray iidStr { iid };
+
+		auto pos = IID2Roots_.find (iidStr);
+		if (pos == IID2Roots_.end ())
+		{
+			QObjectList roots;
+			for (const auto plugin : Plugins_)
+				if (plugin->qt_metacast (iid))
+					roots << plugin;
+			pos = IID2Roots_.insert (iidStr, roots);
+		}
+		return *pos;
+	}
+}
@@ -0,0 +1,170 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#pragma once
+
+#include <functional>
+#include <QObjectList>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QVariantMap>
+#include <boost/optional.hpp>
+
+namespace LeechCraft
+{
+	struct Entity;
+
+	/** @brief Caches which plugins could possibly handle an entity.
+	 *
+	 * Plugins may declare cheap prefilters for the entities they are
+	 * interested in, in the "EntityFilter" object of their manifest:
+	 *
+	 * @code
+	 * "EntityFilter": {
+	 *     "Mimes": [ "x-leechcraft/notification*" ],
+	 *     "Schemes": [ "magnet" ],
+	 *     "EntityTypes": [ "QUrl", "QByteArray" ],
+	 *     "AdditionalKeys": [ "org.LC.AdvNotifications.EventID" ],
+	 *     "CacheNegative": true
+	 * }
+	 * @endcode
+	 *
+	 * Every listed category should match for the plugin to be asked,
+	 * and a category matches if any of its values matches. A trailing
+	 * asterisk in a MIME denotes a prefix match, schemes are only
+	 * checked for QUrl entities, entity types are compared against
+	 * QVariant::typeName(), and AdditionalKeys match if the entity has
+	 * any of the keys in its Additional_ map.
+	 *
+	 * If CacheNegative is set, the plugin promises that its
+	 * CouldHandle()/CouldDownload() result depends only on the entity
+	 * shape (its MIME, URL scheme, type, parameters and the set of
+	 * additional keys), so negative answers are remembered for the
+	 * identical shapes.
+	 *
+	 * Plugins without an EntityFilter are always asked.
+	 *
+	 * The index is rebuilt lazily after Invalidate(), which the plugin
+	 * manager calls each time the set of plugins changes.
+	 */
+	class EntityRoutingIndex
+	{
+	public:
+		typedef std::function<QObjectList ()> PluginsGetter_f;
+		typedef std::function<QVariantMap (QObject*)> ManifestGetter_f;
+
+		struct DispatchStats
+		{
+			quint64 Queries_ = 0;
+			quint64 Accepted_ = 0;
+			qint64 TotalNs_ = 0;
+			qint64 MaxNs_ = 0;
+		};
+	private:
+		const PluginsGetter_f GetPlugins_;
+		const ManifestGetter_f GetManifest_;
+
+		struct Filter
+		{
+			QSet<QString> Mimes_;
+			QStringList MimePrefixes_;
+			QSet<QString> Schemes_;
+			QSet<QString> EntityTypes_;
+			QStringList AdditionalKeys_;
+
+			bool CacheNegative_ = false;
+
+			bool Matches (const Entity&, const QString& scheme, const QString& type) const;
+		};
+
+		bool IsValid_ = false;
+
+		QObjectList Plugins_;
+		QHash<QByteArray, QObjectList> IID2Roots_;
+
+		QSet<QObject*> Unfiltered_;
+		QHash<QObject*, Filter> Filters_;
+
+		QHash<QString, QObjectList> Mime2Plugins_;
+		QHash<QString, QObjectList> Scheme2Plugins_;
+		QHash<QString, QObjectList> Type2Plugins_;
+		QObjectList Unindexed_;
+
+		QHash<QByteArray, QSet<QObject*>> Negatives_;
+
+		QHash<QObject*, DispatchStats> Stats_;
+
+		// empty for the deferred plugins without an EntityFilter
+		QHash<QByteArray, boost::optional<Filter>> DeferredFilters_;
+	public:
+		EntityRoutingIndex (const PluginsGetter_f&, const ManifestGetter_f&);
+
+		void Invalidate ();
+
+		/** @brief Returns the key identifying entities of the same shape
+		 * queried against the interface with the given IID.
+		 */
+		QByteArray GetShape (const Entity&, const char *iid) const;
+
+		/** @brief Returns the plugins implementing the interface with the
+		 * given IID that should be asked about the entity.
+		 *
+		 * The order of the plugins is the same as in the plugin
+		 * manager's GetAllPlugins().
+		 */
+		QObjectList GetCandidates (const Entity&, const char *iid, const QByteArray& shape);
+
+		void RecordResult (QObject*, const QByteArray& shape, bool accepted, qint64 elapsedNs);
+
+		const QHash<QObject*, DispatchStats>& GetDispatchStats () const;
+
+		/** @brief Writes the dispatch stats to the debug log.
+		 *
+		 * This is meant for profiling, so callers should only do this
+		 * when the tracer is enabled.
+		 */
+		void DumpDispatchStats () const;
+
+		/** @brief Checks whether a plugin with the given manifest might
+		 * be interested in the entity.
+		 *
+		 * This is used for plugins that are not loaded yet. The filter
+		 * is parsed from the manifest only the first time a plugin with
+		 * the given ID is checked.
+		 */
+		bool MayHandle (const QByteArray& id, const QVariantMap& manifest, const Entity&);
+	private:
+		static boost::optional<Filter> ParseFilter (const QVariantMap& manifest);
+
+		void Rebuild ();
+		const QObjectList& GetRoots (const char *iid);
+	};
+}
@@ -70,6 +70,11 @@ namespace DBus
 		return nullptr;
 	}
 
+	ITracer* CoreProxyProxy::GetTracer () const
+	{
+		return nullptr;
+	}
+
 	IRootWindowsManager* CoreProxyProxy::GetRootWindowsManager () const
 	{
 		return nullptr;
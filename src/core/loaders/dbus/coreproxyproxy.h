@@ -57,6 +57,7 @@ namespace DBus
 		IColorThemeManager* GetColorThemeManager () const;
 		IRootWindowsManager* GetRootWindowsManager () const;
 		ITagsManager* GetTagsManager () const;
+		ITracer* GetTracer () const;
 		QStringList GetSearchCategories () const;
 		int GetID ();
 		void FreeID (int);
@@ -37,8 +37,9 @@ namespace LeechCraft
 {
 namespace Loaders
 {
-	SOPluginLoader::SOPluginLoader (const QString& filename)
+	SOPluginLoader::SOPluginLoader (const QString& filename, const boost::optional<QVariantMap>& manifest)
 	: Loader_ { std::make_shared<QPluginLoader> (filename) }
+	, Manifest_ { manifest }
 	{
 		Loader_->setLoadHints (QLibrary::ExportExternalSymbolsHint);
 	}
@@ -100,7 +101,9 @@ namespace Loaders
 
 	QVariantMap SOPluginLoader::GetManifest () const
 	{
-		return Loader_->metaData ().toVariantMap () ["MetaData"].toMap ();
+		if (!Manifest_)
+			Manifest_ = Loader_->metaData ().toVariantMap () ["MetaData"].toMap ();
+		return *Manifest_;
 	}
 }
 }
@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
+#include <QVariantMap>
 #include "ipluginloader.h"
 
 class QPluginLoader;
@@ -41,8 +43,16 @@ namespace Loaders
 	{
 		std::shared_ptr<QPluginLoader> Loader_;
 		bool IsLoaded_ = false;
+
+		mutable boost::optional<QVariantMap> Manifest_;
 	public:
-		SOPluginLoader (const QString&);
+		/** Constructs the loader for the given file.
+		 *
+		 * If the manifest of the plugin is already known (for example,
+		 * from the manifest cache), it can be passed here to avoid
+		 * scanning the library for the metadata.
+		 */
+		SOPluginLoader (const QString&, const boost::optional<QVariantMap>& manifest = {});
 
 		SOPluginLoader (const SOPluginLoader&) = delete;
 		SOPluginLoader (SOPluginLoader&&) = delete;
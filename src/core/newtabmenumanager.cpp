@@ -34,8 +34,10 @@
 #include "interfaces/iinfo.h"
 #include "interfaces/ihavetabs.h"
 #include <interfaces/iplugin2.h>
+#include <util/sys/tracespan.h>
 #include "xmlsettingsmanager.h"
 #include "core.h"
+#include "tracer.h"
 
 namespace LeechCraft
 {
@@ -210,7 +212,11 @@ namespace LeechCraft
 		}
 
 		const QByteArray& tabClass = action->property ("TabClass").toByteArray ();
-		tabs->TabOpenRequested (tabClass);
+		{
+			Util::TraceSpan span { &Tracer::Instance (), "tabs",
+					[&tabClass] { return "Opening " + QString::fromUtf8 (tabClass); } };
+			tabs->TabOpenRequested (tabClass);
+		}
 
 		const auto& classes = tabs->GetTabClasses ();
 		if (action->property ("Single").toBool ())
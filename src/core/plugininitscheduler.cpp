@@ -0,0 +1,226 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "plugininitscheduler.h"
+#include <atomic>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QMutex>
+#include <QSet>
+#include <QThreadPool>
+#include <QtConcurrentRun>
+#include <QtDebug>
+#include "interfaces/core/itracer.h"
+
+namespace LeechCraft
+{
+	PluginInitScheduler::PluginInitScheduler (const QObjectList& ordered,
+			const QHash<QObject*, QObjectList>& deps)
+	: Ordered_ (ordered)
+	, Deps_ (deps)
+	, Pool_ (QThreadPool::globalInstance ())
+	{
+	}
+
+	void PluginInitScheduler::SetAnyThreadPredicate (const AnyThread_f& anyThread)
+	{
+		AnyThread_ = anyThread;
+	}
+
+	void PluginInitScheduler::SetStartedHandler (const Started_f& started)
+	{
+		Started_ = started;
+	}
+
+	void PluginInitScheduler::SetFinishedHandler (const Finished_f& finished)
+	{
+		Finished_ = finished;
+	}
+
+	void PluginInitScheduler::SetThreadPool (QThreadPool *pool)
+	{
+		Pool_ = pool;
+	}
+
+	void PluginInitScheduler::SetTracer (ITracer *tracer,
+			const char *category, const NameGetter_f& nameGetter)
+	{
+		Tracer_ = tracer && tracer->IsEnabled () ? tracer : nullptr;
+		Category_ = category;
+		NameGetter_ = nameGetter;
+	}
+
+	PluginInitScheduler::Result PluginInitScheduler::Run (const Runner_f& runner)
+	{
+		Result result;
+
+		QElapsedTimer elapsed;
+		elapsed.start ();
+		std::atomic<qint64> busyNsecs { 0 };
+
+		const auto& orderedSet = Ordered_.toSet ();
+		QObjectList queue = Ordered_;
+		QSet<QObject*> done;
+		QSet<QObject*> running;
+		bool stopped = false;
+
+		const auto isReady = [&] (QObject *obj)
+		{
+			for (const auto dep : Deps_.value (obj))
+				if (orderedSet.contains (dep) && !done.contains (dep))
+					return false;
+			return true;
+		};
+
+		const auto timedRun = [this, &runner, &busyNsecs] (QObject *obj)
+		{
+			QElapsedTimer timer;
+			timer.start ();
+
+			const auto start = Tracer_ ? Tracer_->Now () : 0;
+			const bool ok = runner (obj);
+			if (Tracer_)
+				Tracer_->AddSpan (Category_, NameGetter_ (obj), start, Tracer_->Now ());
+
+			busyNsecs += timer.nsecsElapsed ();
+			return ok;
+		};
+
+		const auto handleFinished = [&] (QObject *obj, bool ok)
+		{
+			if (ok)
+			{
+				done << obj;
+				result.Initialized_ << obj;
+			}
+			else
+			{
+				result.Failed_ << obj;
+				stopped = true;
+			}
+
+			if (Finished_)
+				Finished_ (obj, ok);
+		};
+
+		/* Workers append to the finished queue and post a quit to the
+		 * wait loop while holding the mutex, so once the entry is seen
+		 * here the worker doesn't touch anything on this stack anymore.
+		 */
+		QEventLoop waitLoop;
+		QMutex finishedMutex;
+		QList<QPair<QObject*, bool>> finishedQueue;
+
+		while (true)
+		{
+			QList<QPair<QObject*, bool>> finished;
+			{
+				QMutexLocker locker { &finishedMutex };
+				std::swap (finished, finishedQueue);
+			}
+			for (const auto& pair : finished)
+			{
+				running.remove (pair.first);
+				handleFinished (pair.first, pair.second);
+			}
+
+			QObject *localObj = nullptr;
+			if (!stopped)
+			{
+				for (auto i = queue.begin (); i != queue.end (); )
+				{
+					const auto obj = *i;
+					const bool anyThread = AnyThread_ && AnyThread_ (obj);
+					if ((!anyThread && localObj) || !isReady (obj))
+					{
+						++i;
+						continue;
+					}
+
+					i = queue.erase (i);
+					if (!anyThread)
+					{
+						localObj = obj;
+						continue;
+					}
+
+					if (Started_)
+						Started_ (obj);
+
+					running << obj;
+					QtConcurrent::run (Pool_,
+							[obj, &timedRun, &finishedMutex, &finishedQueue, &waitLoop]
+							{
+								const bool ok = timedRun (obj);
+
+								QMutexLocker locker { &finishedMutex };
+								finishedQueue.append ({ obj, ok });
+								QMetaObject::invokeMethod (&waitLoop, "quit", Qt::QueuedConnection);
+							});
+				}
+
+				if (!localObj && running.isEmpty () && !queue.isEmpty ())
+				{
+					qWarning () << Q_FUNC_INFO
+							<< "unsatisfiable dependencies for"
+							<< queue
+							<< "; falling back to the plain order";
+					localObj = queue.takeFirst ();
+				}
+			}
+
+			if (localObj)
+			{
+				if (Started_)
+					Started_ (localObj);
+				handleFinished (localObj, timedRun (localObj));
+				continue;
+			}
+
+			if (running.isEmpty ())
+				break;
+
+			{
+				QMutexLocker locker { &finishedMutex };
+				if (!finishedQueue.isEmpty ())
+					continue;
+			}
+
+			const auto waitStart = Tracer_ ? Tracer_->Now () : 0;
+			waitLoop.exec (QEventLoop::ExcludeUserInputEvents | QEventLoop::ExcludeSocketNotifiers);
+			if (Tracer_)
+				Tracer_->AddSpan (Category_, "Waiting for the thread pool", waitStart, Tracer_->Now ());
+		}
+
+		result.BusyNsecs_ = busyNsecs;
+		result.ElapsedNsecs_ = elapsed.nsecsElapsed ();
+		return result;
+	}
+}
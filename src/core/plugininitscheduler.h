@@ -0,0 +1,140 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#pragma once
+
+#include <functional>
+#include <QObjectList>
+#include <QHash>
+#include <QString>
+
+class QThreadPool;
+class ITracer;
+
+namespace LeechCraft
+{
+	/** @brief Runs an initialization phase along the dependency graph.
+	 *
+	 * Each object is initialized only after all of its dependencies have
+	 * been initialized successfully. Objects for which the AnyThread_f
+	 * predicate returns true may be initialized on a thread pool,
+	 * concurrently with other independent objects. Others are always
+	 * initialized in the thread that has called Run().
+	 *
+	 * The calling thread runs a local event loop while waiting for the
+	 * pool, so that the objects being initialized in other threads can
+	 * still make blocking queued calls to the GUI thread. This loop
+	 * skips user input and socket notifications, but it does deliver
+	 * timers and posted events, including queued signals. So the
+	 * objects that have already been initialized may get their timers
+	 * fired and queued slots invoked before the whole phase is done,
+	 * just like with a nested event loop in any of them.
+	 *
+	 * Upon the first failure no more objects are scheduled, the already
+	 * running ones are waited for, and Run() returns.
+	 */
+	class PluginInitScheduler
+	{
+	public:
+		/** Initializes the given object, returning whether it has been
+		 * initialized successfully. May be called from any thread for
+		 * objects allowed by the AnyThread_f, and shouldn't throw.
+		 */
+		typedef std::function<bool (QObject*)> Runner_f;
+
+		typedef std::function<bool (QObject*)> AnyThread_f;
+
+		/** Called in the Run() thread right before an object is scheduled
+		 * for initialization.
+		 */
+		typedef std::function<void (QObject*)> Started_f;
+
+		/** Called in the Run() thread after an object has been
+		 * initialized, with the result of the corresponding Runner_f.
+		 */
+		typedef std::function<void (QObject*, bool)> Finished_f;
+
+		typedef std::function<QString (QObject*)> NameGetter_f;
+
+		struct Result
+		{
+			QObjectList Initialized_;
+			QObjectList Failed_;
+
+			/** The total time spent in the Runner_f over all objects,
+			 * in nanoseconds.
+			 */
+			qint64 BusyNsecs_ = 0;
+
+			/** The time Run() has taken, in nanoseconds. The
+			 * difference with BusyNsecs_ is what the concurrent
+			 * initialization has saved.
+			 */
+			qint64 ElapsedNsecs_ = 0;
+		};
+	private:
+		const QObjectList Ordered_;
+		const QHash<QObject*, QObjectList> Deps_;
+
+		AnyThread_f AnyThread_;
+		Started_f Started_;
+		Finished_f Finished_;
+
+		QThreadPool *Pool_ = nullptr;
+
+		ITracer *Tracer_ = nullptr;
+		const char *Category_ = nullptr;
+		NameGetter_f NameGetter_;
+	public:
+		/** Constructs the scheduler for the given objects in the
+		 * given (topologically sorted) order, and given dependencies.
+		 * Dependencies missing from the ordered list are considered to
+		 * be already initialized.
+		 */
+		PluginInitScheduler (const QObjectList& ordered,
+				const QHash<QObject*, QObjectList>& deps);
+
+		void SetAnyThreadPredicate (const AnyThread_f&);
+		void SetStartedHandler (const Started_f&);
+		void SetFinishedHandler (const Finished_f&);
+
+		/** Sets the thread pool to use. The global instance is used by
+		 * default.
+		 */
+		void SetThreadPool (QThreadPool*);
+
+		/** Sets the tracer to record the initialization of each object
+		 * and the waits of the calling thread into.
+		 */
+		void SetTracer (ITracer*, const char *category, const NameGetter_f&);
+
+		Result Run (const Runner_f&);
+	};
+}
@@ -43,12 +43,21 @@
 #include <util/exceptions.h>
 #include <util/sll/prelude.h>
 #include <util/sll/scopeguards.h>
+#include <util/sys/tracespan.h>
 #include <interfaces/iinfo.h>
 #include <interfaces/iplugin2.h>
 #include <interfaces/ipluginready.h>
 #include <interfaces/ipluginadaptor.h>
 #include <interfaces/ihaveshortcuts.h>
 #include <interfaces/ishutdownlistener.h>
+#include <interfaces/ihavetabs.h>
+#include <interfaces/ihaverecoverabletabs.h>
+#include <interfaces/ihavesettings.h>
+#include <interfaces/iactionsexporter.h>
+#include <interfaces/ijobholder.h>
+#include <interfaces/ifinder.h>
+#include <interfaces/istartupwizard.h>
+#include <interfaces/isummaryrepresentation.h>
 #include "core.h"
 #include "pluginmanager.h"
 #include "mainwindow.h"
@@ -64,6 +73,9 @@
 #include "loaders/sopluginloader.h"
 #include "loadprocessbase.h"
 #include "splashscreen.h"
+#include "entityroutingindex.h"
+#include "pluginmanifestcache.h"
+#include "tracer.h"
 
 #ifdef WITH_DBUS_LOADERS
 #include "loaders/dbuspluginloader.h"
@@ -74,9 +86,23 @@ namespace LeechCraft
 	PluginManager::PluginManager (const QStringList& pluginPaths, QObject *parent)
 	: QAbstractItemModel (parent)
 	, DBusMode_ (static_cast<Application*> (qApp)->GetVarMap ().count ("multiprocess"))
+	, ManifestCache_ (std::make_shared<PluginManifestCache> ())
 	, PluginTreeBuilder_ (new PluginTreeBuilder)
 	, CacheValid_ (false)
 	{
+		{
+			QSettings settings (QCoreApplication::organizationName (),
+					QCoreApplication::applicationName () + "-pg");
+			ManifestCache_->Load (settings);
+		}
+
+		RoutingIndex_ = std::make_shared<EntityRoutingIndex> ([this] { return GetAllPlugins (); },
+				[this] (QObject *plugin)
+				{
+					const auto& loader = Obj2Loader_.value (plugin);
+					return loader ? loader->GetManifest () : QVariantMap {};
+				});
+
 		Headers_ << tr ("Name")
 			<< tr ("Description");
 
@@ -264,6 +290,11 @@ namespace LeechCraft
 
 		auto loader = AvailablePlugins_.at (index.row ());
 
+		if (!data.toBool ())
+			DeferredPlugins_.erase (std::remove_if (DeferredPlugins_.begin (), DeferredPlugins_.end (),
+						[&loader] (const DeferredPlugin& plugin) { return plugin.Loader_ == loader; }),
+					DeferredPlugins_.end ());
+
 		if (!data.toBool () &&
 				PluginContainers_.contains (loader))
 		{
@@ -386,51 +417,127 @@ namespace LeechCraft
 		}
 	};
 
-	QObject* PluginManager::TryFirstInit (QObjectList ordered, PluginLoadProcess *proc)
+	namespace
+	{
+		/* Plugins whose Init() doesn't touch GUI and other thread-affine
+		 * stuff may declare it in their manifest, so that they are
+		 * initialized on the thread pool, concurrently with other
+		 * plugins that don't depend on them.
+		 */
+		bool IsThreadSafeInit (const Loaders::IPluginLoader_ptr& loader)
+		{
+			return loader && loader->GetManifest () ["ThreadSafeInit"].toBool ();
+		}
+	}
+
+	PluginInitScheduler::Result PluginManager::TryFirstInit (const QObjectList& ordered, PluginLoadProcess *proc)
 	{
 		QSettings settings (QCoreApplication::organizationName (),
 				QCoreApplication::applicationName () + "-pg");
 		const auto guard = Util::BeginGroup (settings, "Plugins");
 
+		/* The core instance object sets up some of the stuff the other
+		 * plugins may rely upon without declaring it, so it goes first.
+		 */
+		const auto coreInstanceObj = Core::Instance ().GetCoreInstanceObject ();
+		auto deps = PluginTreeBuilder_->GetDependencies ();
+
+		// Everything touched from the pool is prepared in the GUI thread.
+		QHash<QObject*, ICoreProxy_ptr> proxies;
+		QHash<QObject*, QString> names;
+		QSet<QObject*> threadSafe;
 		for (const auto obj : ordered)
 		{
-			++*proc;
+			if (obj != coreInstanceObj)
+				deps [obj] << coreInstanceObj;
 
-			const auto ii = qobject_cast<IInfo*> (obj);
-			try
-			{
-				qDebug () << "Initializing" << ii->GetName ();
-				emit loadProgress (tr ("Initializing %1: stage one...").arg (ii->GetName ()));
-				ii->Init (std::make_shared<CoreProxy> ());
+			proxies [obj] = std::make_shared<CoreProxy> ();
+			names [obj] = qobject_cast<IInfo*> (obj)->GetName ();
+			if (IsThreadSafeInit (Obj2Loader_.value (obj)))
+				threadSafe << obj;
+		}
 
-				const auto& path = GetPluginLibraryPath (obj);
-				if (path.isEmpty ())
-					continue;
+		PluginInitScheduler scheduler { ordered, deps };
+		scheduler.SetAnyThreadPredicate ([&threadSafe] (QObject *obj) { return threadSafe.contains (obj); });
+		scheduler.SetTracer (&Tracer::Instance (), "init",
+				[&names] (QObject *obj) { return names.value (obj); });
+		scheduler.SetStartedHandler ([this, &names] (QObject *obj)
+				{
+					qDebug () << "Initializing" << names.value (obj);
+					emit loadProgress (tr ("Initializing %1: stage one...").arg (names.value (obj)));
+				});
+		scheduler.SetFinishedHandler ([this, proc, &settings] (QObject *obj, bool ok)
+				{
+					++*proc;
+					if (!ok)
+						return;
 
-				settings.beginGroup (path);
-				settings.setValue ("Info", ii->GetInfo ());
-				settings.endGroup ();
-			}
-			catch (const std::exception& e)
-			{
-				qWarning () << Q_FUNC_INFO
-						<< "while initializing"
-						<< obj
-						<< "got"
-						<< e.what ();
-				return obj;
-			}
-			catch (...)
-			{
-				qWarning () << Q_FUNC_INFO
-						<< "while initializing"
-						<< obj
-						<< "caught unknown exception";
-				return obj;
-			}
-		}
+					const auto& path = GetPluginLibraryPath (obj);
+					if (path.isEmpty ())
+						return;
+
+					settings.beginGroup (path);
+					settings.setValue ("Info", qobject_cast<IInfo*> (obj)->GetInfo ());
+					settings.endGroup ();
+				});
 
-		return 0;
+		return scheduler.Run ([&proxies] (QObject *obj)
+				{
+					try
+					{
+						qobject_cast<IInfo*> (obj)->Init (proxies.value (obj));
+						return true;
+					}
+					catch (const std::exception& e)
+					{
+						qWarning () << Q_FUNC_INFO
+								<< "while initializing"
+								<< obj
+								<< "got"
+								<< e.what ();
+					}
+					catch (...)
+					{
+						qWarning () << Q_FUNC_INFO
+								<< "while initializing"
+								<< obj
+								<< "caught unknown exception";
+					}
+					return false;
+				});
+	}
+
+	void PluginManager::SecondInitAll (const QObjectList& ordered, PluginLoadProcess *proc)
+	{
+		proc->SetCount (ordered.size ());
+
+		PluginInitScheduler scheduler { ordered, {} };
+		scheduler.SetTracer (&Tracer::Instance (), "init",
+				[] (QObject *obj) { return qobject_cast<IInfo*> (obj)->GetName () + " (stage two)"; });
+		scheduler.SetStartedHandler ([this, proc] (QObject *obj)
+				{
+					++*proc;
+					const auto ii = qobject_cast<IInfo*> (obj);
+					emit loadProgress (tr ("Initializing %1: stage two...").arg (ii->GetName ()));
+				});
+
+		// A failed second init doesn't prevent others from initializing.
+		scheduler.Run ([] (QObject *obj)
+				{
+					try
+					{
+						qobject_cast<IInfo*> (obj)->SecondInit ();
+					}
+					catch (const std::exception& e)
+					{
+						qWarning () << Q_FUNC_INFO
+								<< "while initializing"
+								<< obj
+								<< "got"
+								<< e.what ();
+					}
+					return true;
+				});
 	}
 
 	void PluginManager::TryUnload (QObjectList plugins)
@@ -450,16 +557,29 @@ namespace LeechCraft
 							{ return loader->Instance () == object; }),
 					PluginContainers_.end ());
 		}
+
+		RoutingIndex_->Invalidate ();
 	}
 
 	void PluginManager::Init (bool safeMode)
 	{
+		QElapsedTimer initTimer;
+		initTimer.start ();
+
+		auto& tracer = Tracer::Instance ();
+		const auto initStart = tracer.Now ();
+
 		DefaultPluginIcon_ = QIcon ("lcicons:/resources/images/defaultpluginicon.svg");
 		CheckPlugins ();
 		FillInstances ();
 
+		const auto checkTime = initTimer.elapsed ();
+
 		if (safeMode)
+		{
 			Plugins_.clear ();
+			DeferredPlugins_.clear ();
+		}
 
 		Plugins_.prepend (Core::Instance ().GetCoreInstanceObject ());
 
@@ -504,27 +624,7 @@ namespace LeechCraft
 					provider->AddPlugin (ip2);
 		}
 
-		sndInitProc->SetCount (ordered.size ());
-
-		for (const auto obj : ordered)
-		{
-			++*sndInitProc;
-			const auto ii = qobject_cast<IInfo*> (obj);
-			try
-			{
-				emit loadProgress (tr ("Initializing %1: stage two...").arg (ii->GetName ()));
-				ii->SecondInit ();
-			}
-			catch (const std::exception& e)
-			{
-				qWarning () << Q_FUNC_INFO
-						<< "while initializing"
-						<< obj
-						<< "got"
-						<< e.what ();
-				continue;
-			}
-		}
+		SecondInitAll (ordered, sndInitProc.get ());
 
 		SetInitStage (InitStage::PostSecond);
 
@@ -534,10 +634,53 @@ namespace LeechCraft
 		SetInitStage (InitStage::Complete);
 
 		TryUnload (failed);
+
+		qDebug () << Q_FUNC_INFO
+				<< "loaded"
+				<< PluginContainers_.size ()
+				<< "plugins in"
+				<< initTimer.elapsed ()
+				<< "ms, of which checks took"
+				<< checkTime
+				<< "ms;"
+				<< DeferredPlugins_.size ()
+				<< "plugins are deferred";
+
+		if (tracer.IsEnabled ())
+		{
+			tracer.AddSpan ("init", "PluginManager::Init", initStart, tracer.Now ());
+			tracer.SetCounter ("plugins", "Loaded plugins", PluginContainers_.size ());
+			tracer.SetCounter ("plugins", "Deferred plugins", DeferredPlugins_.size ());
+			tracer.Dump ();
+		}
+
+		if (safeMode)
+			return;
+
+		const auto knownInterfaces = ManifestCache_->GetInterfaces ().size ();
+		for (const auto& loader : PluginContainers_)
+		{
+			const auto& record = ManifestCache_->Get (loader->GetFileName ());
+			if (!record ||
+					record->APILevel_ != CURRENT_API_LEVEL ||
+					record->CheckedInterfaces_ != knownInterfaces)
+				UpdateManifestCache (loader);
+		}
+		SaveManifestCache ();
 	}
 
 	void PluginManager::Release ()
 	{
+		if (Tracer::Instance ().IsEnabled ())
+			RoutingIndex_->DumpDispatchStats ();
+		RoutingIndex_->Invalidate ();
+
+		// Interfaces first queried after the startup are to be saved.
+		SaveManifestCache ();
+
+		// Nothing should be brought up by the queries during shutdown.
+		DeferredPlugins_.clear ();
+
 		auto ordered = PluginTreeBuilder_->GetResult ();
 		std::reverse (ordered.begin (), ordered.end ());
 
@@ -640,7 +783,17 @@ namespace LeechCraft
 					break;
 				}
 
-		return PluginID2PluginCache_ [id];
+		if (const auto plugin = PluginID2PluginCache_ [id])
+			return plugin;
+
+		const auto pos = std::find_if (DeferredPlugins_.begin (), DeferredPlugins_.end (),
+				[&id] (const DeferredPlugin& plugin) { return plugin.Record_.UniqueID_ == id; });
+		if (pos == DeferredPlugins_.end ())
+			return nullptr;
+
+		// Asking for a plugin by its ID is a request to use it, so
+		// this is a natural point to bring it up.
+		return const_cast<PluginManager*> (this)->LoadDeferred (*pos);
 	}
 
 	QObjectList PluginManager::GetFirstLevels (const QByteArray& pclass) const
@@ -683,6 +836,8 @@ namespace LeechCraft
 							.intersect (classes).isEmpty ())
 						ipr->AddPlugin (object);
 			}
+
+			RoutingIndex_->Invalidate ();
 		}
 		catch (const std::exception& e)
 		{
@@ -711,6 +866,7 @@ namespace LeechCraft
 			qDebug () << "Releasing"
 					<< qobject_cast<IInfo*> (object)->GetName ();
 			qobject_cast<IInfo*> (object)->Release ();
+			RoutingIndex_->Invalidate ();
 		}
 		catch (const std::exception& e)
 		{
@@ -769,6 +925,17 @@ namespace LeechCraft
 		return std::make_shared<LoadProgressReporter> ();
 	}
 
+	QObjectList PluginManager::GetAllImplementing (const char *iid) const
+	{
+		const_cast<PluginManager*> (this)->LoadDeferredImplementing (iid);
+
+		QObjectList result;
+		for (const auto plugin : GetAllPlugins ())
+			if (plugin->qt_metacast (iid))
+				result << plugin;
+		return result;
+	}
+
 	QObject* PluginManager::GetProvider (const QString& feature) const
 	{
 		if (!FeatureProviders_.contains (feature))
@@ -792,9 +959,29 @@ namespace LeechCraft
 			return;
 
 		InitStage_ = stage;
+		RoutingIndex_->Invalidate ();
 		emit initStageChanged (stage);
 	}
 
+	EntityRoutingIndex* PluginManager::GetEntityRoutingIndex () const
+	{
+		return RoutingIndex_.get ();
+	}
+
+	void PluginManager::LoadDeferredFor (const Entity& e)
+	{
+		if (DeferredPlugins_.isEmpty ())
+			return;
+
+		QList<DeferredPlugin> toLoad;
+		for (const auto& plugin : DeferredPlugins_)
+			if (RoutingIndex_->MayHandle (plugin.Record_.UniqueID_, plugin.Record_.Manifest_, e))
+				toLoad << plugin;
+
+		for (const auto& plugin : toLoad)
+			LoadDeferred (plugin);
+	}
+
 	QStringList PluginManager::FindPluginsPaths () const
 	{
 		QStringList result;
@@ -832,23 +1019,39 @@ namespace LeechCraft
 
 	void PluginManager::FindPlugins ()
 	{
-		ScanPlugins (FindPluginsPaths ());
+		const auto& paths = FindPluginsPaths ();
+		ManifestCache_->Prune (paths);
+		ScanPlugins (paths);
 	}
 
 	void PluginManager::ScanPlugins (const QStringList& paths)
 	{
+		Util::TraceSpan span { &Tracer::Instance (), "plugins", "PluginManager::ScanPlugins" };
+
 		QSettings settings (QCoreApplication::organizationName (),
 				QCoreApplication::applicationName () + "-pg");
 		settings.beginGroup ("Plugins");
 
+		const bool allowDeferring = !DBusMode_ && qgetenv ("LC_LOAD_ALL_PLUGINS") != "1";
+
 		for (const QFileInfo fileinfo : paths)
 		{
 			auto name = fileinfo.canonicalFilePath ();
 			settings.beginGroup (name);
 
-			const auto loader = MakeLoader (name);
+			const auto& record = ManifestCache_->Get (name);
+			const auto loader = MakeLoader (name,
+					record ? record->Manifest_ : boost::optional<QVariantMap> {});
 			if (settings.value ("AllowLoad", true).toBool ())
-				PluginContainers_.push_back (loader);
+			{
+				if (allowDeferring &&
+						record &&
+						record->CanDefer_ &&
+						record->APILevel_ == CURRENT_API_LEVEL)
+					DeferredPlugins_.append ({ loader, *record });
+				else
+					PluginContainers_.push_back (loader);
+			}
 			AvailablePlugins_.push_back (loader);
 
 			settings.endGroup ();
@@ -956,6 +1159,8 @@ namespace LeechCraft
 
 	void PluginManager::CheckPlugins ()
 	{
+		Util::TraceSpan span { &Tracer::Instance (), "plugins", "PluginManager::CheckPlugins" };
+
 		QSettings settings (QCoreApplication::organizationName (),
 				QCoreApplication::applicationName () + "-pg");
 		settings.beginGroup ("Plugins");
@@ -973,6 +1178,9 @@ namespace LeechCraft
 
 		auto thrCheck = [shouldDump, checks] (Loaders::IPluginLoader_ptr loader) -> boost::optional<Checks::Fail>
 		{
+			Util::TraceSpan span { &Tracer::Instance (), "plugins",
+					[&loader] { return "Checking " + loader->GetFileName (); } };
+
 			QElapsedTimer timer;
 			if (shouldDump)
 			{
@@ -1039,6 +1247,9 @@ namespace LeechCraft
 		{
 			auto loader = PluginContainers_.at (i);
 
+			Util::TraceSpan span { &Tracer::Instance (), "plugins",
+					[&loader] { return "Instantiating " + loader->GetFileName (); } };
+
 			bool success = true;
 			for (auto check : checks)
 				try
@@ -1126,23 +1337,30 @@ namespace LeechCraft
 		QObjectList initialized;
 		QObjectList failedList;
 
-		QObject *failed = 0;
-		while ((failed = TryFirstInit (ordered, proc)))
+		qint64 busyNsecs = 0;
+		qint64 elapsedNsecs = 0;
+
+		while (true)
 		{
+			const auto& result = TryFirstInit (ordered, proc);
+			initialized += result.Initialized_;
+			busyNsecs += result.BusyNsecs_;
+			elapsedNsecs += result.ElapsedNsecs_;
+			if (result.Failed_.isEmpty ())
+				break;
+
 			CacheValid_ = false;
+			RoutingIndex_->Invalidate ();
 
-			failedList << failed;
-			for (const auto obj : ordered)
+			failedList += result.Failed_;
+			for (const auto failed : result.Failed_)
 			{
-				if (failed == obj)
-					break;
-				initialized << obj;
+				qDebug () << failed
+						<< "failed to initialize";
+				PluginTreeBuilder_->RemoveObject (failed);
 			}
 
-			PluginTreeBuilder_->RemoveObject (failed);
-
-			qDebug () << failed
-					<< "failed to initialize, recalculating dep tree...";
+			qDebug () << "recalculating dep tree...";
 			PluginTreeBuilder_->Calculate ();
 
 			ordered = PluginTreeBuilder_->GetResult ();
@@ -1153,17 +1371,218 @@ namespace LeechCraft
 			proc->ReportValue (initialized.size ());
 		}
 
+		// the difference is what the thread-safe plugins have saved
+		qDebug () << Q_FUNC_INFO
+				<< "first stage took"
+				<< elapsedNsecs / 1000000
+				<< "ms, with"
+				<< busyNsecs / 1000000
+				<< "ms spent in the plugins' Init()";
+
+		auto& tracer = Tracer::Instance ();
+		if (tracer.IsEnabled ())
+		{
+			tracer.SetCounter ("init", "First stage, ms", elapsedNsecs / 1000000);
+			tracer.SetCounter ("init", "Plugins' Init() total, ms", busyNsecs / 1000000);
+		}
+
 		return failedList;
 	}
 
-	Loaders::IPluginLoader_ptr PluginManager::MakeLoader (const QString& filename)
+	Loaders::IPluginLoader_ptr PluginManager::MakeLoader (const QString& filename,
+			const boost::optional<QVariantMap>& manifest)
 	{
 
 #ifdef WITH_DBUS_LOADERS
 		if (DBusMode_)
 			return std::make_shared<Loaders::DBusPluginLoader> (filename);
 #endif
-		return std::make_shared<Loaders::SOPluginLoader> (filename);
+		return std::make_shared<Loaders::SOPluginLoader> (filename, manifest);
+	}
+
+	namespace
+	{
+		/* A plugin can only be loaded on demand if it asks for it in its
+		 * manifest, if nothing depends on it and if it doesn't implement
+		 * any of the interfaces that are queried during the startup
+		 * (otherwise it would be loaded by the very first query anyway).
+		 * Such plugins are loaded once an entity they may handle is
+		 * dispatched, when they are requested by their ID or when an
+		 * interface they implement is queried via GetAllImplementing().
+		 */
+		bool CanDefer (QObject *obj, const QVariantMap& manifest)
+		{
+			if (!manifest ["LoadOnDemand"].toBool ())
+				return false;
+
+			const auto ii = qobject_cast<IInfo*> (obj);
+			if (!ii->Provides ().isEmpty () ||
+					!ii->Needs ().isEmpty () ||
+					!ii->Uses ().isEmpty ())
+				return false;
+
+			return !qobject_cast<IPlugin2*> (obj) &&
+					!qobject_cast<IPluginReady*> (obj) &&
+					!qobject_cast<IPluginAdaptor*> (obj) &&
+					!qobject_cast<IHaveTabs*> (obj) &&
+					!qobject_cast<IHaveRecoverableTabs*> (obj) &&
+					!qobject_cast<IHaveSettings*> (obj) &&
+					!qobject_cast<IHaveShortcuts*> (obj) &&
+					!qobject_cast<IActionsExporter*> (obj) &&
+					!qobject_cast<IJobHolder*> (obj) &&
+					!qobject_cast<IFinder*> (obj) &&
+					!qobject_cast<IStartupWizard*> (obj) &&
+					!qobject_cast<ISummaryRepresentation*> (obj);
+		}
+	}
+
+	QObject* PluginManager::LoadDeferred (DeferredPlugin plugin)
+	{
+		const auto loader = plugin.Loader_;
+
+		const auto pos = std::find_if (DeferredPlugins_.begin (), DeferredPlugins_.end (),
+				[&loader] (const DeferredPlugin& other) { return other.Loader_ == loader; });
+		// Might have been already loaded by a nested request.
+		if (pos == DeferredPlugins_.end ())
+			return nullptr;
+		DeferredPlugins_.erase (pos);
+
+		QElapsedTimer timer;
+		timer.start ();
+
+		Util::TraceSpan span { &Tracer::Instance (), "plugins",
+				[&plugin] { return "Loading deferred " + QString::fromUtf8 (plugin.Record_.UniqueID_); } };
+
+		qDebug () << Q_FUNC_INFO
+				<< "loading deferred plugin"
+				<< plugin.Record_.UniqueID_
+				<< "from"
+				<< loader->GetFileName ();
+
+		try
+		{
+			for (const auto& check : { Checks::IsFile, Checks::TryLoad, Checks::APILevel, Checks::TryInstance })
+				check (loader);
+		}
+		catch (const Checks::Fail& f)
+		{
+			PluginLoadErrors_ << f.Error_;
+			if (f.Unload_)
+				loader->Unload ();
+			ManifestCache_->Remove (loader->GetFileName ());
+			SaveManifestCache ();
+			return nullptr;
+		}
+
+		const auto inst = loader->Instance ();
+		if (qobject_cast<IInfo*> (inst)->GetUniqueID () != plugin.Record_.UniqueID_)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "plugin ID mismatch for"
+					<< loader->GetFileName ()
+					<< "; the cached one is"
+					<< plugin.Record_.UniqueID_;
+			loader->Unload ();
+			ManifestCache_->Remove (loader->GetFileName ());
+			SaveManifestCache ();
+			return nullptr;
+		}
+
+		PluginContainers_ << loader;
+		Plugins_ << inst;
+		Obj2Loader_ [inst] = loader;
+
+		PluginTreeBuilder_->AddObjects ({ inst });
+		PluginTreeBuilder_->Calculate ();
+		CacheValid_ = false;
+		PluginID2PluginCache_.clear ();
+
+		try
+		{
+			InjectPlugin (inst);
+		}
+		catch (...)
+		{
+			PluginTreeBuilder_->RemoveObject (inst);
+			PluginTreeBuilder_->Calculate ();
+			Plugins_.removeAll (inst);
+			CacheValid_ = false;
+			PluginID2PluginCache_.clear ();
+			TryUnload ({ inst });
+			return nullptr;
+		}
+
+		qDebug () << Q_FUNC_INFO
+				<< "loaded"
+				<< plugin.Record_.UniqueID_
+				<< "in"
+				<< timer.elapsed ()
+				<< "ms";
+
+		UpdateManifestCache (loader);
+		SaveManifestCache ();
+
+		const auto row = AvailablePlugins_.indexOf (loader);
+		if (row >= 0)
+			emit dataChanged (index (row, 0), index (row, columnCount () - 1));
+
+		return inst;
+	}
+
+	void PluginManager::LoadDeferredImplementing (const QByteArray& iid)
+	{
+		ManifestCache_->AddInterface (iid);
+
+		if (DeferredPlugins_.isEmpty ())
+			return;
+
+		QList<DeferredPlugin> toLoad;
+		for (const auto& plugin : DeferredPlugins_)
+			if (ManifestCache_->MayImplement (plugin.Record_, iid))
+				toLoad << plugin;
+
+		for (const auto& plugin : toLoad)
+			LoadDeferred (plugin);
+	}
+
+	void PluginManager::UpdateManifestCache (const Loaders::IPluginLoader_ptr& loader)
+	{
+		const auto inst = loader->Instance ();
+		const auto ii = qobject_cast<IInfo*> (inst);
+		if (!ii)
+			return;
+
+		PluginManifestCache::Record record;
+		record.APILevel_ = CURRENT_API_LEVEL;
+		record.Manifest_ = loader->GetManifest ();
+		try
+		{
+			record.UniqueID_ = ii->GetUniqueID ();
+			record.CanDefer_ = CanDefer (inst, record.Manifest_);
+
+			const auto& interfaces = ManifestCache_->GetInterfaces ();
+			for (const auto& iid : interfaces)
+				if (inst->qt_metacast (iid.constData ()))
+					record.Interfaces_ << iid;
+			record.CheckedInterfaces_ = interfaces.size ();
+		}
+		catch (const std::exception& e)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to query"
+					<< loader->GetFileName ()
+					<< e.what ();
+			return;
+		}
+
+		ManifestCache_->Set (loader->GetFileName (), record);
+	}
+
+	void PluginManager::SaveManifestCache ()
+	{
+		QSettings settings (QCoreApplication::organizationName (),
+				QCoreApplication::applicationName () + "-pg");
+		ManifestCache_->Save (settings);
 	}
 
 	QList<PluginManager::Plugins_t::iterator>
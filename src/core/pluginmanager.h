@@ -30,6 +30,7 @@
 #pragma once
 
 #include <memory>
+#include <boost/optional.hpp>
 #include <QAbstractItemModel>
 #include <QMap>
 #include <QMultiMap>
@@ -39,11 +40,14 @@
 #include "loaders/ipluginloader.h"
 #include "interfaces/iinfo.h"
 #include "interfaces/core/ipluginsmanager.h"
+#include "plugininitscheduler.h"
+#include "pluginmanifestcache.h"
 
 namespace LeechCraft
 {
 	class MainWindow;
 	class PluginTreeBuilder;
+	class EntityRoutingIndex;
 
 	class PluginManager : public QAbstractItemModel
 						, public IPluginsManager
@@ -64,6 +68,18 @@ namespace LeechCraft
 
 		// All plugins ever seen
 		PluginsContainer_t AvailablePlugins_;
+
+		std::shared_ptr<PluginManifestCache> ManifestCache_;
+
+		/* Plugins allowed to be loaded that are not needed at startup
+		 * and will be loaded the first time something needs them.
+		 */
+		struct DeferredPlugin
+		{
+			Loaders::IPluginLoader_ptr Loader_;
+			PluginManifestCache::Record Record_;
+		};
+		QList<DeferredPlugin> DeferredPlugins_;
 		QMap<QString, PluginsContainer_t::const_iterator> FeatureProviders_;
 
 		QStringList Headers_;
@@ -72,6 +88,7 @@ namespace LeechCraft
 		mutable QMap<QByteArray, QObject*> PluginID2PluginCache_;
 
 		std::shared_ptr<PluginTreeBuilder> PluginTreeBuilder_;
+		std::shared_ptr<EntityRoutingIndex> RoutingIndex_;
 
 		mutable bool CacheValid_;
 		mutable QObjectList SortedCache_;
@@ -133,11 +150,20 @@ namespace LeechCraft
 
 		ILoadProgressReporter_ptr CreateLoadProgressReporter (QObject*);
 
+		QObjectList GetAllImplementing (const char*) const;
+
 		QObject* GetProvider (const QString&) const;
 
 		const QStringList& GetPluginLoadErrors () const;
 
 		InitStage GetInitStage () const;
+
+		EntityRoutingIndex* GetEntityRoutingIndex () const;
+
+		/** Loads the deferred plugins that might be interested in the
+		 * given entity.
+		 */
+		void LoadDeferredFor (const Entity&);
 	private:
 		void SetInitStage (InitStage);
 
@@ -160,19 +186,30 @@ namespace LeechCraft
 		 */
 		QList<QObject*> FirstInitAll (PluginLoadProcess*);
 
-		/** Tries to perform IInfo::Init() on plugins and returns the
-		 * first plugin that has failed to initialize. This function
-		 * stops initializing plugins upon first failure. If all plugins
-		 * were initialized successfully, this function returns NULL.
+		/** Tries to perform IInfo::Init() on plugins along the
+		 * dependency graph, running independent thread-safe plugins
+		 * concurrently. This function stops scheduling plugins upon
+		 * first failure and returns both the plugins that have been
+		 * initialized and the ones that have failed.
 		 */
-		QObject* TryFirstInit (QObjectList, PluginLoadProcess*);
+		PluginInitScheduler::Result TryFirstInit (const QObjectList&, PluginLoadProcess*);
+
+		/** Performs IInfo::SecondInit() on the given plugins in order.
+		 */
+		void SecondInitAll (const QObjectList&, PluginLoadProcess*);
 
 		/** Plainly tries to find a corresponding QPluginLoader and
 		 * unload the corresponding library.
 		 */
 		void TryUnload (QObjectList);
 
-		Loaders::IPluginLoader_ptr MakeLoader (const QString&);
+		Loaders::IPluginLoader_ptr MakeLoader (const QString&,
+				const boost::optional<QVariantMap>& manifest = {});
+
+		QObject* LoadDeferred (DeferredPlugin);
+		void LoadDeferredImplementing (const QByteArray&);
+		void UpdateManifestCache (const Loaders::IPluginLoader_ptr&);
+		void SaveManifestCache ();
 
 		QList<Plugins_t::iterator> FindProviders (const QString&);
 		QList<Plugins_t::iterator> FindProviders (const QSet<QByteArray>&);
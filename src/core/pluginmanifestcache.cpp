@@ -0,0 +1,217 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "pluginmanifestcache.h"
+#include <algorithm>
+#include <QSettings>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSet>
+
+namespace LeechCraft
+{
+	namespace
+	{
+		const QString ArrayName = "ManifestCache";
+		const QString InterfacesKey = "ManifestCacheInterfaces";
+
+		QStringList ToStrings (const QList<QByteArray>& list)
+		{
+			QStringList result;
+			for (const auto& item : list)
+				result << QString::fromLatin1 (item);
+			return result;
+		}
+
+		QList<QByteArray> FromStrings (const QStringList& list)
+		{
+			QList<QByteArray> result;
+			for (const auto& item : list)
+				result << item.toLatin1 ();
+			return result;
+		}
+
+		bool IsSameRecord (const PluginManifestCache::Record& r1, const PluginManifestCache::Record& r2)
+		{
+			return r1.MTime_ == r2.MTime_ &&
+					r1.Size_ == r2.Size_ &&
+					r1.APILevel_ == r2.APILevel_ &&
+					r1.UniqueID_ == r2.UniqueID_ &&
+					r1.CanDefer_ == r2.CanDefer_ &&
+					r1.CheckedInterfaces_ == r2.CheckedInterfaces_ &&
+					r1.Interfaces_ == r2.Interfaces_ &&
+					r1.Manifest_ == r2.Manifest_;
+		}
+
+		QPair<qint64, qint64> GetStamp (const QString& filename)
+		{
+			const QFileInfo fi { filename };
+			if (!fi.exists ())
+				return { -1, -1 };
+
+			return { fi.lastModified ().toMSecsSinceEpoch (), fi.size () };
+		}
+	}
+
+	void PluginManifestCache::Load (QSettings& settings)
+	{
+		Records_.clear ();
+		Interfaces_ = FromStrings (settings.value (InterfacesKey).toStringList ());
+
+		const int size = settings.beginReadArray (ArrayName);
+		for (int i = 0; i < size; ++i)
+		{
+			settings.setArrayIndex (i);
+
+			Record record;
+			record.MTime_ = settings.value ("MTime", -1).toLongLong ();
+			record.Size_ = settings.value ("Size", -1).toLongLong ();
+			record.APILevel_ = settings.value ("APILevel").toULongLong ();
+			record.Manifest_ = settings.value ("Manifest").toMap ();
+			record.UniqueID_ = settings.value ("UniqueID").toByteArray ();
+			record.CanDefer_ = settings.value ("CanDefer").toBool ();
+			record.Interfaces_ = FromStrings (settings.value ("Interfaces").toStringList ());
+			record.CheckedInterfaces_ = std::min (settings.value ("CheckedInterfaces").toInt (),
+					Interfaces_.size ());
+			Records_ [settings.value ("Filename").toString ()] = record;
+		}
+		settings.endArray ();
+
+		IsDirty_ = false;
+	}
+
+	void PluginManifestCache::Save (QSettings& settings)
+	{
+		if (!IsDirty_)
+			return;
+
+		settings.setValue (InterfacesKey, ToStrings (Interfaces_));
+
+		settings.remove (ArrayName);
+		settings.beginWriteArray (ArrayName, Records_.size ());
+		int i = 0;
+		for (auto it = Records_.begin (); it != Records_.end (); ++it, ++i)
+		{
+			settings.setArrayIndex (i);
+
+			const auto& record = it.value ();
+			settings.setValue ("Filename", it.key ());
+			settings.setValue ("MTime", record.MTime_);
+			settings.setValue ("Size", record.Size_);
+			settings.setValue ("APILevel", record.APILevel_);
+			settings.setValue ("Manifest", record.Manifest_);
+			settings.setValue ("UniqueID", record.UniqueID_);
+			settings.setValue ("CanDefer", record.CanDefer_);
+			settings.setValue ("Interfaces", ToStrings (record.Interfaces_));
+			settings.setValue ("CheckedInterfaces", record.CheckedInterfaces_);
+		}
+		settings.endArray ();
+
+		IsDirty_ = false;
+	}
+
+	bool PluginManifestCache::IsDirty () const
+	{
+		return IsDirty_;
+	}
+
+	boost::optional<PluginManifestCache::Record> PluginManifestCache::Get (const QString& filename) const
+	{
+		const auto pos = Records_.find (filename);
+		if (pos == Records_.end ())
+			return {};
+
+		const auto& stamp = GetStamp (filename);
+		if (stamp.first != pos->MTime_ || stamp.second != pos->Size_)
+			return {};
+
+		return *pos;
+	}
+
+	void PluginManifestCache::Set (const QString& filename, Record record)
+	{
+		const auto& stamp = GetStamp (filename);
+		record.MTime_ = stamp.first;
+		record.Size_ = stamp.second;
+
+		const auto pos = Records_.find (filename);
+		if (pos == Records_.end ())
+			Records_.insert (filename, record);
+		else if (!IsSameRecord (*pos, record))
+			*pos = record;
+		else
+			return;
+
+		IsDirty_ = true;
+	}
+
+	void PluginManifestCache::Remove (const QString& filename)
+	{
+		if (Records_.remove (filename))
+			IsDirty_ = true;
+	}
+
+	void PluginManifestCache::Prune (const QStringList& filenames)
+	{
+		const auto& existing = filenames.toSet ();
+		for (auto it = Records_.begin (); it != Records_.end (); )
+			if (existing.contains (it.key ()))
+				++it;
+			else
+			{
+				it = Records_.erase (it);
+				IsDirty_ = true;
+			}
+	}
+
+	bool PluginManifestCache::AddInterface (const QByteArray& iid)
+	{
+		if (Interfaces_.contains (iid))
+			return false;
+
+		Interfaces_ << iid;
+		IsDirty_ = true;
+		return true;
+	}
+
+	const QList<QByteArray>& PluginManifestCache::GetInterfaces () const
+	{
+		return Interfaces_;
+	}
+
+	bool PluginManifestCache::MayImplement (const Record& record, const QByteArray& iid) const
+	{
+		if (record.Interfaces_.contains (iid))
+			return true;
+
+		const auto idx = Interfaces_.indexOf (iid);
+		return idx < 0 || idx >= record.CheckedInterfaces_;
+	}
+}
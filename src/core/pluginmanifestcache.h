@@ -0,0 +1,110 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <QHash>
+#include <QStringList>
+#include <QVariantMap>
+
+class QSettings;
+
+namespace LeechCraft
+{
+	/** @brief Persists what we know about plugin libraries between runs.
+	 *
+	 * For each plugin file the cache keeps its manifest, API level and
+	 * unique ID along with whether the plugin may be loaded on demand.
+	 * A record is only considered valid while the file's modification
+	 * time and size match the ones the record has been created for.
+	 *
+	 * The cache also keeps the list of the interfaces plugins have ever
+	 * been queried for, and each record lists the ones among them its
+	 * plugin implements. The list is only appended to, so a record
+	 * just remembers how many interfaces have been checked.
+	 */
+	class PluginManifestCache
+	{
+	public:
+		struct Record
+		{
+			qint64 MTime_ = -1;
+			qint64 Size_ = -1;
+
+			quint64 APILevel_ = 0;
+			QVariantMap Manifest_;
+			QByteArray UniqueID_;
+
+			bool CanDefer_ = false;
+
+			QList<QByteArray> Interfaces_;
+			int CheckedInterfaces_ = 0;
+		};
+	private:
+		QHash<QString, Record> Records_;
+		QList<QByteArray> Interfaces_;
+		bool IsDirty_ = false;
+	public:
+		void Load (QSettings&);
+		void Save (QSettings&);
+
+		bool IsDirty () const;
+
+		boost::optional<Record> Get (const QString& filename) const;
+
+		/** @brief Updates the record for the given file.
+		 *
+		 * The stamp fields of the record are filled in by this
+		 * function from the current state of the file. The cache is
+		 * only marked as dirty if the record has actually changed.
+		 */
+		void Set (const QString& filename, Record);
+		void Remove (const QString& filename);
+
+		/** @brief Removes the records for the files not in the list.
+		 */
+		void Prune (const QStringList& filenames);
+
+		/** @brief Remembers that plugins are queried for the interface.
+		 *
+		 * @return Whether the interface hasn't been known before.
+		 */
+		bool AddInterface (const QByteArray& iid);
+		const QList<QByteArray>& GetInterfaces () const;
+
+		/** @brief Checks if the record's plugin may implement the iid.
+		 *
+		 * This is true if the plugin is known to implement it or if it
+		 * hasn't been checked against the interface.
+		 */
+		bool MayImplement (const Record&, const QByteArray& iid) const;
+	};
+}
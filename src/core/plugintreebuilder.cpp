@@ -182,6 +182,7 @@ namespace LeechCraft
 		Graph_.clear ();
 		Object2Vertex_.clear ();
 		Result_.clear ();
+		Dependencies_.clear ();
 
 		CreateGraph ();
 		const auto& edge2vert = MakeEdges ();
@@ -212,6 +213,17 @@ namespace LeechCraft
 		boost::topological_sort (fulfilledSubgraph, std::back_inserter (vertices));
 		for (const auto& vertex : vertices)
 			Result_ << fulfilledSubgraph [vertex].Object_;
+
+		const auto& resultSet = Result_.toSet ();
+		for (const auto& pair : edge2vert)
+		{
+			const auto dependent = Graph_ [pair.first].Object_;
+			const auto dependency = Graph_ [pair.second].Object_;
+			if (resultSet.contains (dependent) &&
+					resultSet.contains (dependency) &&
+					!Dependencies_ [dependent].contains (dependency))
+				Dependencies_ [dependent] << dependency;
+		}
 	}
 
 	QObjectList PluginTreeBuilder::GetResult () const
@@ -219,6 +231,11 @@ namespace LeechCraft
 		return Result_;
 	}
 
+	QHash<QObject*, QObjectList> PluginTreeBuilder::GetDependencies () const
+	{
+		return Dependencies_;
+	}
+
 	void PluginTreeBuilder::CreateGraph ()
 	{
 		for (const auto object : Instances_)
@@ -80,6 +80,7 @@ namespace LeechCraft
 
 		QHash<QObject*, Vertex_t> Object2Vertex_;
 		QObjectList Result_;
+		QHash<QObject*, QObjectList> Dependencies_;
 	public:
 		PluginTreeBuilder ();
 
@@ -87,6 +88,13 @@ namespace LeechCraft
 		void RemoveObject (QObject*);
 		void Calculate ();
 		QObjectList GetResult () const;
+
+		/** Returns the direct dependencies of each object from the
+		 * result of the last Calculate() call, that is, the objects
+		 * that should be initialized before the key object. Objects
+		 * without dependencies are missing from the returned hash.
+		 */
+		QHash<QObject*, QObjectList> GetDependencies () const;
 	private:
 		void CreateGraph ();
 		QMap<Edge_t, QPair<Vertex_t, Vertex_t>> MakeEdges ();
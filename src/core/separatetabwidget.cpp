@@ -45,6 +45,7 @@
 #include <interfaces/ihaverecoverabletabs.h>
 #include "util/xpc/defaulthookproxy.h"
 #include "util/sll/prelude.h"
+#include "util/sys/tracespan.h"
 #include "coreproxy.h"
 #include "separatetabbar.h"
 #include "xmlsettingsmanager.h"
@@ -55,6 +56,7 @@
 #include "rootwindowsmanager.h"
 #include "mainwindow.h"
 #include "iconthemeengine.h"
+#include "tracer.h"
 
 namespace LeechCraft
 {
@@ -818,6 +820,8 @@ namespace LeechCraft
 							<< "is not a IMultiTabs";
 				else
 				{
+					Util::TraceSpan span { &Tracer::Instance (), "tabs",
+							[&tabClass] { return "Opening " + QString::fromUtf8 (tabClass); } };
 					iht->TabOpenRequested (tabClass);
 					return;
 				}
@@ -856,6 +860,8 @@ namespace LeechCraft
 			return;
 		}
 
+		Util::TraceSpan span { &Tracer::Instance (), "tabs",
+				[&highestTabClass] { return "Opening " + QString::fromUtf8 (highestTabClass); } };
 		highestIHT->TabOpenRequested (highestTabClass);
 	}
 
@@ -34,6 +34,7 @@
 #include <QMenu>
 #include <QtDebug>
 #include <interfaces/ihavetabs.h>
+#include <util/sys/tracespan.h>
 #include "core.h"
 #include "xmlsettingsmanager.h"
 #include "separatetabwidget.h"
@@ -41,6 +42,7 @@
 #include "newtabmenumanager.h"
 #include "separatetabbar.h"
 #include "mainwindowmenumanager.h"
+#include "tracer.h"
 
 using namespace LeechCraft;
 
@@ -166,6 +168,8 @@ void TabManager::add (const QString& name, QWidget *contents)
 void TabManager::add (const QString& name, QWidget *contents,
 		QIcon icon)
 {
+	Util::TraceSpan span { &Tracer::Instance (), "tabs", "TabManager::add" };
+
 	if (icon.isNull ())
 	{
 		ITabWidget *itw = qobject_cast<ITabWidget*> (contents);
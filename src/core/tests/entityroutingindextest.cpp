@@ -0,0 +1,391 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "entityroutingindextest.h"
+#include <memory>
+#include <QtTest>
+#include <QUrl>
+#include "entityroutingindex.h"
+
+QTEST_GUILESS_MAIN (LeechCraft::EntityRoutingIndexTest)
+
+namespace LeechCraft
+{
+	FakeHandler::FakeHandler (const QString& mime, const QVariantMap& manifest)
+	: Mime_ { mime }
+	, Manifest_ { manifest }
+	{
+	}
+
+	EntityTestHandleResult FakeHandler::CouldHandle (const Entity& e) const
+	{
+		++Queries_;
+		return e.Mime_ == Mime_ && !e.Additional_ ["Text"].toString ().isEmpty () ?
+				EntityTestHandleResult { EntityTestHandleResult::PHigh } :
+				EntityTestHandleResult {};
+	}
+
+	void FakeHandler::Handle (Entity)
+	{
+	}
+
+	namespace
+	{
+		const char * const HandlerIID = qobject_interface_iid<IEntityHandler*> ();
+
+		QVariantMap MakeManifest (const QVariantMap& filter)
+		{
+			return { { "EntityFilter", filter } };
+		}
+
+		class Plugins
+		{
+			std::vector<std::unique_ptr<QObject>> Owned_;
+		public:
+			QObjectList List_;
+
+			FakeHandler* Add (const QString& mime, const QVariantMap& manifest = {})
+			{
+				const auto handler = new FakeHandler { mime, manifest };
+				Owned_.emplace_back (handler);
+				List_ << handler;
+				return handler;
+			}
+
+			QObject* AddPlain ()
+			{
+				const auto obj = new QObject;
+				Owned_.emplace_back (obj);
+				List_ << obj;
+				return obj;
+			}
+
+			EntityRoutingIndex MakeIndex () const
+			{
+				const auto& list = List_;
+				return
+				{
+					[list] { return list; },
+					[] (QObject *obj)
+					{
+						const auto handler = qobject_cast<FakeHandler*> (obj);
+						return handler ? handler->Manifest_ : QVariantMap {};
+					}
+				};
+			}
+		};
+
+		Entity MakeEntity (const QVariant& entity, const QString& mime, const QVariantMap& additional = {})
+		{
+			Entity e;
+			e.Entity_ = entity;
+			e.Mime_ = mime;
+			e.Additional_ = additional;
+			return e;
+		}
+
+		QObjectList GetCandidates (EntityRoutingIndex& index, const Entity& e)
+		{
+			return index.GetCandidates (e, HandlerIID, index.GetShape (e, HandlerIID));
+		}
+
+		const QString NotificationMime = "x-leechcraft/notification";
+	}
+
+	void EntityRoutingIndexTest::testUnfiltered ()
+	{
+		Plugins plugins;
+		plugins.Add (NotificationMime);
+		plugins.Add ("text/plain");
+
+		auto index = plugins.MakeIndex ();
+		QCOMPARE (GetCandidates (index, MakeEntity ("title", NotificationMime)), plugins.List_);
+	}
+
+	void EntityRoutingIndexTest::testMimeFilter ()
+	{
+		Plugins plugins;
+		const auto notifier = plugins.Add (NotificationMime,
+				MakeManifest ({ { "Mimes", QStringList { NotificationMime } } }));
+		const auto other = plugins.Add ("text/plain",
+				MakeManifest ({ { "Mimes", QStringList { "text/plain" } } }));
+
+		auto index = plugins.MakeIndex ();
+		QCOMPARE (GetCandidates (index, MakeEntity ("title", NotificationMime)), QObjectList { notifier });
+		QCOMPARE (GetCandidates (index, MakeEntity ("title", "text/plain")), QObjectList { other });
+		QVERIFY (GetCandidates (index, MakeEntity ("title", {})).isEmpty ());
+	}
+
+	void EntityRoutingIndexTest::testMimePrefixFilter ()
+	{
+		Plugins plugins;
+		const auto notifier = plugins.Add (NotificationMime,
+				MakeManifest ({ { "Mimes", QStringList { NotificationMime + "*" } } }));
+
+		auto index = plugins.MakeIndex ();
+		QCOMPARE (GetCandidates (index, MakeEntity ("title", NotificationMime + "-rule-create")),
+				QObjectList { notifier });
+		QVERIFY (GetCandidates (index, MakeEntity ("title", "text/plain")).isEmpty ());
+	}
+
+	void EntityRoutingIndexTest::testSchemeFilter ()
+	{
+		Plugins plugins;
+		const auto magnets = plugins.Add ({},
+				MakeManifest ({ { "Schemes", QStringList { "magnet" } } }));
+
+		auto index = plugins.MakeIndex ();
+		QCOMPARE (GetCandidates (index, MakeEntity (QUrl { "magnet:?xt=urn:btih:abc" }, {})),
+				QObjectList { magnets });
+		QVERIFY (GetCandidates (index, MakeEntity (QUrl { "http://example.com" }, {})).isEmpty ());
+		QVERIFY (GetCandidates (index, MakeEntity (QString { "magnet:?xt=urn:btih:abc" }, {})).isEmpty ());
+	}
+
+	void EntityRoutingIndexTest::testAdditionalKeysFilter ()
+	{
+		Plugins plugins;
+		const auto handler = plugins.Add (NotificationMime,
+				MakeManifest ({ { "AdditionalKeys", QStringList { "Text", "Body" } } }));
+
+		auto index = plugins.MakeIndex ();
+		QCOMPARE (GetCandidates (index, MakeEntity ("title", NotificationMime, { { "Body", "text" } })),
+				QObjectList { handler });
+		QVERIFY (GetCandidates (index, MakeEntity ("title", NotificationMime, { { "Other", "text" } })).isEmpty ());
+	}
+
+	void EntityRoutingIndexTest::testCombinedFilter ()
+	{
+		Plugins plugins;
+		const auto handler = plugins.Add (NotificationMime,
+				MakeManifest ({
+						{ "Mimes", QStringList { NotificationMime } },
+						{ "EntityTypes", QStringList { "QString" } }
+					}));
+
+		auto index = plugins.MakeIndex ();
+		QCOMPARE (GetCandidates (index, MakeEntity (QString { "title" }, NotificationMime)),
+				QObjectList { handler });
+		QVERIFY (GetCandidates (index, MakeEntity (QByteArray { "title" }, NotificationMime)).isEmpty ());
+	}
+
+	void EntityRoutingIndexTest::testInterfaceRoots ()
+	{
+		Plugins plugins;
+		plugins.AddPlain ();
+		const auto handler = plugins.Add (NotificationMime);
+
+		auto index = plugins.MakeIndex ();
+		QCOMPARE (GetCandidates (index, MakeEntity ("title", NotificationMime)), QObjectList { handler });
+	}
+
+	void EntityRoutingIndexTest::testNegativeCache ()
+	{
+		Plugins plugins;
+		const auto handler = plugins.Add (NotificationMime,
+				MakeManifest ({
+						{ "Mimes", QStringList { NotificationMime } },
+						{ "CacheNegative", true }
+					}));
+
+		auto index = plugins.MakeIndex ();
+
+		const auto& e = MakeEntity ("title", NotificationMime);
+		const auto& shape = index.GetShape (e, HandlerIID);
+		QCOMPARE (index.GetCandidates (e, HandlerIID, shape), QObjectList { handler });
+
+		index.RecordResult (handler, shape, false, 0);
+		QVERIFY (index.GetCandidates (e, HandlerIID, shape).isEmpty ());
+
+		const auto& withText = MakeEntity ("title", NotificationMime, { { "Text", "text" } });
+		QCOMPARE (GetCandidates (index, withText), QObjectList { handler });
+	}
+
+	void EntityRoutingIndexTest::testNoNegativeCacheByDefault ()
+	{
+		Plugins plugins;
+		const auto handler = plugins.Add (NotificationMime,
+				MakeManifest ({ { "Mimes", QStringList { NotificationMime } } }));
+
+		auto index = plugins.MakeIndex ();
+
+		const auto& e = MakeEntity ("title", NotificationMime);
+		const auto& shape = index.GetShape (e, HandlerIID);
+		index.RecordResult (handler, shape, false, 0);
+		QCOMPARE (index.GetCandidates (e, HandlerIID, shape), QObjectList { handler });
+	}
+
+	void EntityRoutingIndexTest::testInvalidate ()
+	{
+		Plugins plugins;
+		const auto handler = plugins.Add (NotificationMime,
+				MakeManifest ({
+						{ "Mimes", QStringList { NotificationMime } },
+						{ "CacheNegative", true }
+					}));
+
+		auto list = plugins.List_;
+		EntityRoutingIndex index
+		{
+			[&list] { return list; },
+			[] (QObject *obj) { return qobject_cast<FakeHandler*> (obj)->Manifest_; }
+		};
+
+		const auto& e = MakeEntity ("title", NotificationMime);
+		const auto& shape = index.GetShape (e, HandlerIID);
+		index.GetCandidates (e, HandlerIID, shape);
+		index.RecordResult (handler, shape, false, 0);
+
+		const auto added = plugins.Add (NotificationMime);
+		list = plugins.List_;
+		QVERIFY (index.GetCandidates (e, HandlerIID, shape).isEmpty ());
+
+		index.Invalidate ();
+		QCOMPARE (index.GetCandidates (e, HandlerIID, shape), (QObjectList { handler, added }));
+	}
+
+	void EntityRoutingIndexTest::testStats ()
+	{
+		Plugins plugins;
+		const auto handler = plugins.Add (NotificationMime);
+
+		auto index = plugins.MakeIndex ();
+		GetCandidates (index, MakeEntity ("title", NotificationMime));
+
+		index.RecordResult (handler, {}, true, 3000);
+		index.RecordResult (handler, {}, false, 1000);
+
+		const auto& stats = index.GetDispatchStats () [handler];
+		QCOMPARE (stats.Queries_, 2ull);
+		QCOMPARE (stats.Accepted_, 1ull);
+		QCOMPARE (stats.TotalNs_, 4000ll);
+		QCOMPARE (stats.MaxNs_, 3000ll);
+	}
+
+	void EntityRoutingIndexTest::testMayHandle ()
+	{
+		Plugins plugins;
+		auto index = plugins.MakeIndex ();
+
+		const auto& manifest = MakeManifest ({ { "Mimes", QStringList { NotificationMime } } });
+		const auto& notification = MakeEntity ("title", NotificationMime);
+		const auto& other = MakeEntity ("title", "x-test/other");
+
+		QVERIFY (index.MayHandle ("filtered", manifest, notification));
+		QVERIFY (!index.MayHandle ("filtered", manifest, other));
+		QVERIFY (index.MayHandle ("unfiltered", {}, other));
+
+		// the filter is parsed only once per plugin
+		QVERIFY (!index.MayHandle ("filtered", {}, other));
+	}
+
+	namespace
+	{
+		const int BenchPluginsCount = 120;
+		const int BenchUnfilteredCount = 10;
+
+		/* Mimics a typical installation: most plugins are interested
+		 * in a couple of specific MIMEs, and a few of them don't
+		 * declare any filters at all.
+		 */
+		void FillBenchPlugins (Plugins& plugins)
+		{
+			for (int i = 0; i < BenchPluginsCount - BenchUnfilteredCount; ++i)
+			{
+				const auto& mime = QString { "x-test/mime%1" }.arg (i);
+				plugins.Add (mime,
+						MakeManifest ({
+								{ "Mimes", QStringList { mime } },
+								{ "CacheNegative", true }
+							}));
+			}
+
+			for (int i = 0; i < BenchUnfilteredCount; ++i)
+				plugins.Add (NotificationMime);
+		}
+
+		int Dispatch (const QObjectList& candidates, const Entity& e,
+				const std::function<void (QObject*, bool)>& record)
+		{
+			int accepted = 0;
+			for (const auto plugin : candidates)
+			{
+				EntityTestHandleResult r;
+				try
+				{
+					r = qobject_cast<IEntityHandler*> (plugin)->CouldHandle (e);
+				}
+				catch (...)
+				{
+					continue;
+				}
+
+				record (plugin, r.HandlePriority_ > 0);
+
+				if (r.HandlePriority_ > 0)
+					++accepted;
+			}
+			return accepted;
+		}
+	}
+
+	void EntityRoutingIndexTest::benchFullScan ()
+	{
+		Plugins plugins;
+		FillBenchPlugins (plugins);
+
+		const auto& e = MakeEntity ("title", NotificationMime, { { "Text", "text" } });
+
+		int accepted = 0;
+		QBENCHMARK
+		{
+			accepted = Dispatch (plugins.List_, e, [] (QObject*, bool) {});
+		}
+		QCOMPARE (accepted, BenchUnfilteredCount);
+	}
+
+	void EntityRoutingIndexTest::benchIndexed ()
+	{
+		Plugins plugins;
+		FillBenchPlugins (plugins);
+
+		auto index = plugins.MakeIndex ();
+
+		const auto& e = MakeEntity ("title", NotificationMime, { { "Text", "text" } });
+
+		int accepted = 0;
+		QBENCHMARK
+		{
+			const auto& shape = index.GetShape (e, HandlerIID);
+			accepted = Dispatch (index.GetCandidates (e, HandlerIID, shape), e,
+					[&] (QObject *plugin, bool ok) { index.RecordResult (plugin, shape, ok, 0); });
+		}
+		QCOMPARE (accepted, BenchUnfilteredCount);
+	}
+}
@@ -0,0 +1,314 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "plugininitschedulertest.h"
+#include <memory>
+#include <QtTest>
+#include <QThread>
+#include <QThreadPool>
+#include <QMutex>
+#include <QTemporaryDir>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include "plugininitscheduler.h"
+#include "tracer.h"
+
+QTEST_GUILESS_MAIN (LeechCraft::PluginInitSchedulerTest)
+
+namespace LeechCraft
+{
+	namespace
+	{
+		struct Objects
+		{
+			std::vector<std::unique_ptr<QObject>> Holder_;
+			QObjectList List_;
+
+			Objects (int count)
+			{
+				for (int i = 0; i < count; ++i)
+				{
+					Holder_.emplace_back (new QObject);
+					Holder_.back ()->setObjectName (QString::number (i));
+					List_ << Holder_.back ().get ();
+				}
+			}
+
+			QObject* operator[] (int idx) const
+			{
+				return List_.at (idx);
+			}
+		};
+
+		class Recorder
+		{
+			mutable QMutex Mutex_;
+			QObjectList Order_;
+			QHash<QObject*, QThread*> Threads_;
+			int Running_ = 0;
+			int MaxRunning_ = 0;
+		public:
+			bool Run (QObject *obj, int sleepMs = 0)
+			{
+				{
+					QMutexLocker locker { &Mutex_ };
+					MaxRunning_ = std::max (MaxRunning_, ++Running_);
+				}
+
+				if (sleepMs)
+					QThread::msleep (sleepMs);
+
+				QMutexLocker locker { &Mutex_ };
+				--Running_;
+				Order_ << obj;
+				Threads_ [obj] = QThread::currentThread ();
+				return true;
+			}
+
+			QObjectList GetOrder () const
+			{
+				QMutexLocker locker { &Mutex_ };
+				return Order_;
+			}
+
+			QThread* GetThread (QObject *obj) const
+			{
+				QMutexLocker locker { &Mutex_ };
+				return Threads_.value (obj);
+			}
+
+			int GetMaxRunning () const
+			{
+				QMutexLocker locker { &Mutex_ };
+				return MaxRunning_;
+			}
+		};
+	}
+
+	void PluginInitSchedulerTest::testSequentialOrder ()
+	{
+		Objects objs { 5 };
+		Recorder rec;
+
+		PluginInitScheduler scheduler { objs.List_, {} };
+		const auto& result = scheduler.Run ([&rec] (QObject *obj) { return rec.Run (obj); });
+
+		QCOMPARE (rec.GetOrder (), objs.List_);
+		QCOMPARE (result.Initialized_, objs.List_);
+		QVERIFY (result.Failed_.isEmpty ());
+	}
+
+	void PluginInitSchedulerTest::testDependenciesRespected ()
+	{
+		Objects objs { 4 };
+		const QHash<QObject*, QObjectList> deps
+		{
+			{ objs [2], { objs [0], objs [1] } },
+			{ objs [3], { objs [2] } }
+		};
+
+		QThreadPool pool;
+		pool.setMaxThreadCount (4);
+
+		Recorder rec;
+		PluginInitScheduler scheduler { objs.List_, deps };
+		scheduler.SetThreadPool (&pool);
+		scheduler.SetAnyThreadPredicate ([] (QObject*) { return true; });
+		const auto& result = scheduler.Run ([&rec, &objs] (QObject *obj)
+				{
+					return rec.Run (obj, obj == objs [0] ? 50 : 0);
+				});
+
+		const auto& order = rec.GetOrder ();
+		QCOMPARE (order.size (), 4);
+		QVERIFY (order.indexOf (objs [2]) > order.indexOf (objs [0]));
+		QVERIFY (order.indexOf (objs [2]) > order.indexOf (objs [1]));
+		QCOMPARE (order.last (), objs [3]);
+		QCOMPARE (result.Initialized_.size (), 4);
+	}
+
+	void PluginInitSchedulerTest::testIndependentRunConcurrently ()
+	{
+		Objects objs { 4 };
+
+		QThreadPool pool;
+		pool.setMaxThreadCount (4);
+
+		Recorder rec;
+		PluginInitScheduler scheduler { objs.List_, {} };
+		scheduler.SetThreadPool (&pool);
+		scheduler.SetAnyThreadPredicate ([] (QObject*) { return true; });
+		scheduler.Run ([&rec] (QObject *obj) { return rec.Run (obj, 100); });
+
+		QCOMPARE (rec.GetOrder ().size (), 4);
+		QVERIFY (rec.GetMaxRunning () > 1);
+	}
+
+	void PluginInitSchedulerTest::testLocalStaysInCallingThread ()
+	{
+		Objects objs { 6 };
+
+		QThreadPool pool;
+		pool.setMaxThreadCount (2);
+
+		Recorder rec;
+		PluginInitScheduler scheduler { objs.List_, {} };
+		scheduler.SetThreadPool (&pool);
+		scheduler.SetAnyThreadPredicate ([] (QObject *obj) { return obj->objectName ().toInt () % 2; });
+		scheduler.Run ([&rec] (QObject *obj) { return rec.Run (obj, 10); });
+
+		QCOMPARE (rec.GetOrder ().size (), 6);
+		for (int i = 0; i < 6; i += 2)
+			QCOMPARE (rec.GetThread (objs [i]), QThread::currentThread ());
+		for (int i = 1; i < 6; i += 2)
+			QVERIFY (rec.GetThread (objs [i]) != QThread::currentThread ());
+	}
+
+	void PluginInitSchedulerTest::testFailureStopsScheduling ()
+	{
+		Objects objs { 4 };
+		const QHash<QObject*, QObjectList> deps { { objs [2], { objs [1] } } };
+
+		Recorder rec;
+		PluginInitScheduler scheduler { objs.List_, deps };
+
+		QObjectList finishedFailed;
+		scheduler.SetFinishedHandler ([&finishedFailed] (QObject *obj, bool ok)
+				{
+					if (!ok)
+						finishedFailed << obj;
+				});
+
+		const auto& result = scheduler.Run ([&rec, &objs] (QObject *obj)
+				{
+					rec.Run (obj);
+					return obj != objs [1];
+				});
+
+		QCOMPARE (result.Initialized_, (QObjectList { objs [0] }));
+		QCOMPARE (result.Failed_, (QObjectList { objs [1] }));
+		QCOMPARE (finishedFailed, result.Failed_);
+		QCOMPARE (rec.GetOrder (), (QObjectList { objs [0], objs [1] }));
+	}
+
+	void PluginInitSchedulerTest::testExternalDependencies ()
+	{
+		Objects objs { 3 };
+		const QHash<QObject*, QObjectList> deps { { objs [1], { objs [0] } }, { objs [2], { objs [1] } } };
+
+		Recorder rec;
+		PluginInitScheduler scheduler { { objs [1], objs [2] }, deps };
+		const auto& result = scheduler.Run ([&rec] (QObject *obj) { return rec.Run (obj); });
+
+		QCOMPARE (result.Initialized_, (QObjectList { objs [1], objs [2] }));
+	}
+
+	void PluginInitSchedulerTest::testTracer ()
+	{
+		Objects objs { 3 };
+
+		QThreadPool pool;
+		pool.setMaxThreadCount (2);
+
+		QTemporaryDir dir;
+		QVERIFY (dir.isValid ());
+		const auto& path = dir.path () + "/trace.json";
+
+		Tracer tracer;
+		tracer.Enable (path);
+
+		Recorder rec;
+		PluginInitScheduler scheduler { objs.List_, {} };
+		scheduler.SetThreadPool (&pool);
+		scheduler.SetAnyThreadPredicate ([] (QObject*) { return true; });
+		scheduler.SetTracer (&tracer, "init", [] (QObject *obj) { return obj->objectName (); });
+		scheduler.Run ([&rec] (QObject *obj) { return rec.Run (obj, 20); });
+
+		QVERIFY (tracer.Dump ());
+
+		QFile file { path };
+		QVERIFY (file.open (QIODevice::ReadOnly));
+		const auto& events = QJsonDocument::fromJson (file.readAll ()).object () ["traceEvents"].toArray ();
+
+		QSet<QString> initialized;
+		bool hasWaits = false;
+		for (const auto& eventVal : events)
+		{
+			const auto& event = eventVal.toObject ();
+			if (event ["ph"].toString () != "X")
+				continue;
+
+			QVERIFY (event ["dur"].toDouble () >= 0);
+			const auto& name = event ["name"].toString ();
+			if (name == "Waiting for the thread pool")
+				hasWaits = true;
+			else
+				initialized << name;
+		}
+
+		QCOMPARE (initialized, (QSet<QString> { "0", "1", "2" }));
+		QVERIFY (hasWaits);
+	}
+
+	void PluginInitSchedulerTest::testTimes ()
+	{
+		Objects objs { 4 };
+
+		QThreadPool pool;
+		pool.setMaxThreadCount (4);
+
+		PluginInitScheduler scheduler { objs.List_, {} };
+		scheduler.SetThreadPool (&pool);
+		scheduler.SetAnyThreadPredicate ([] (QObject*) { return true; });
+		const auto& result = scheduler.Run ([] (QObject*) { QThread::msleep (50); return true; });
+
+		const qint64 msec = 1000 * 1000;
+		QVERIFY (result.BusyNsecs_ >= 4 * 50 * msec);
+		QVERIFY (result.ElapsedNsecs_ >= 50 * msec);
+		QVERIFY (result.ElapsedNsecs_ < result.BusyNsecs_);
+	}
+
+	void PluginInitSchedulerTest::benchIndependent ()
+	{
+		Objects objs { 8 };
+
+		QThreadPool pool;
+		pool.setMaxThreadCount (8);
+
+		QBENCHMARK
+		{
+			PluginInitScheduler scheduler { objs.List_, {} };
+			scheduler.SetThreadPool (&pool);
+			scheduler.SetAnyThreadPredicate ([] (QObject*) { return true; });
+			scheduler.Run ([] (QObject*) { QThread::msleep (20); return true; });
+		}
+	}
+}
@@ -0,0 +1,292 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "pluginmanifestcachetest.h"
+#include <QtTest>
+#include <QSettings>
+#include "pluginmanifestcache.h"
+
+QTEST_GUILESS_MAIN (LeechCraft::PluginManifestCacheTest)
+
+namespace LeechCraft
+{
+	namespace
+	{
+		void WriteFile (const QString& path, const QByteArray& contents)
+		{
+			QFile file { path };
+			QVERIFY (file.open (QIODevice::WriteOnly));
+			QCOMPARE (file.write (contents), static_cast<qint64> (contents.size ()));
+		}
+
+		PluginManifestCache::Record MakeRecord (const QByteArray& id)
+		{
+			PluginManifestCache::Record record;
+			record.APILevel_ = 20;
+			record.UniqueID_ = id;
+			record.Manifest_ = QVariantMap { { "LoadOnDemand", true } };
+			record.CanDefer_ = true;
+			return record;
+		}
+
+		PluginManifestCache Reload (const QString& settingsPath, PluginManifestCache& cache)
+		{
+			{
+				QSettings settings { settingsPath, QSettings::IniFormat };
+				cache.Save (settings);
+			}
+
+			QSettings settings { settingsPath, QSettings::IniFormat };
+			PluginManifestCache result;
+			result.Load (settings);
+			return result;
+		}
+	}
+
+	void PluginManifestCacheTest::init ()
+	{
+		Dir_.reset (new QTemporaryDir);
+		QVERIFY (Dir_->isValid ());
+
+		WriteFile (Dir_->filePath ("libleechcraft_test.so"), "library");
+	}
+
+	void PluginManifestCacheTest::cleanup ()
+	{
+		Dir_.reset ();
+	}
+
+	void PluginManifestCacheTest::testRoundtrip ()
+	{
+		const auto& lib = Dir_->filePath ("libleechcraft_test.so");
+
+		PluginManifestCache cache;
+		cache.Set (lib, MakeRecord ("org.LeechCraft.Test"));
+
+		const auto& loaded = Reload (Dir_->filePath ("settings.ini"), cache);
+		const auto& record = loaded.Get (lib);
+		QVERIFY (record);
+		QCOMPARE (record->UniqueID_, QByteArray { "org.LeechCraft.Test" });
+		QCOMPARE (record->APILevel_, 20ull);
+		QCOMPARE (record->Manifest_ ["LoadOnDemand"].toBool (), true);
+		QCOMPARE (record->CanDefer_, true);
+		QCOMPARE (record->Size_, QFileInfo { lib }.size ());
+	}
+
+	void PluginManifestCacheTest::testMissing ()
+	{
+		PluginManifestCache cache;
+		QVERIFY (!cache.Get (Dir_->filePath ("libleechcraft_test.so")));
+
+		cache.Set (Dir_->filePath ("libleechcraft_none.so"), MakeRecord ("org.LeechCraft.None"));
+		QVERIFY (!cache.Get (Dir_->filePath ("libleechcraft_none.so")));
+	}
+
+	void PluginManifestCacheTest::testStaleMTime ()
+	{
+		const auto& lib = Dir_->filePath ("libleechcraft_test.so");
+
+		PluginManifestCache cache;
+		cache.Set (lib, MakeRecord ("org.LeechCraft.Test"));
+
+		QFile file { lib };
+		QVERIFY (file.open (QIODevice::ReadWrite));
+		QVERIFY (file.setFileTime (QDateTime::currentDateTime ().addSecs (60), QFileDevice::FileModificationTime));
+		file.close ();
+
+		QVERIFY (!cache.Get (lib));
+	}
+
+	void PluginManifestCacheTest::testStaleSize ()
+	{
+		const auto& lib = Dir_->filePath ("libleechcraft_test.so");
+
+		PluginManifestCache cache;
+		cache.Set (lib, MakeRecord ("org.LeechCraft.Test"));
+
+		const auto mtime = QFileInfo { lib }.lastModified ();
+		WriteFile (lib, "a rebuilt library");
+		QFile file { lib };
+		QVERIFY (file.open (QIODevice::ReadWrite));
+		QVERIFY (file.setFileTime (mtime, QFileDevice::FileModificationTime));
+		file.close ();
+
+		QVERIFY (!cache.Get (lib));
+	}
+
+	void PluginManifestCacheTest::testRemove ()
+	{
+		const auto& lib = Dir_->filePath ("libleechcraft_test.so");
+
+		PluginManifestCache cache;
+		cache.Set (lib, MakeRecord ("org.LeechCraft.Test"));
+		cache.Remove (lib);
+
+		const auto& loaded = Reload (Dir_->filePath ("settings.ini"), cache);
+		QVERIFY (!loaded.Get (lib));
+	}
+
+	void PluginManifestCacheTest::testSetUnchanged ()
+	{
+		const auto& lib = Dir_->filePath ("libleechcraft_test.so");
+
+		PluginManifestCache cache;
+		cache.Set (lib, MakeRecord ("org.LeechCraft.Test"));
+		QVERIFY (cache.IsDirty ());
+
+		QSettings settings { Dir_->filePath ("settings.ini"), QSettings::IniFormat };
+		cache.Save (settings);
+		QVERIFY (!cache.IsDirty ());
+
+		cache.Set (lib, MakeRecord ("org.LeechCraft.Test"));
+		QVERIFY (!cache.IsDirty ());
+
+		auto record = MakeRecord ("org.LeechCraft.Test");
+		record.CanDefer_ = false;
+		cache.Set (lib, record);
+		QVERIFY (cache.IsDirty ());
+	}
+
+	void PluginManifestCacheTest::testPrune ()
+	{
+		const auto& lib = Dir_->filePath ("libleechcraft_test.so");
+		const auto& other = Dir_->filePath ("libleechcraft_other.so");
+		WriteFile (other, "library");
+
+		PluginManifestCache cache;
+		cache.Set (lib, MakeRecord ("org.LeechCraft.Test"));
+		cache.Set (other, MakeRecord ("org.LeechCraft.Other"));
+
+		QSettings settings { Dir_->filePath ("settings.ini"), QSettings::IniFormat };
+		cache.Save (settings);
+
+		cache.Prune ({ lib, other });
+		QVERIFY (!cache.IsDirty ());
+
+		cache.Prune ({ lib });
+		QVERIFY (cache.IsDirty ());
+		QVERIFY (cache.Get (lib));
+		QVERIFY (!cache.Get (other));
+	}
+
+	void PluginManifestCacheTest::testInterfaces ()
+	{
+		const auto& lib = Dir_->filePath ("libleechcraft_test.so");
+
+		PluginManifestCache cache;
+		QVERIFY (cache.AddInterface ("org.LeechCraft.IFoo/1.0"));
+		QVERIFY (cache.AddInterface ("org.LeechCraft.IBar/1.0"));
+		QVERIFY (!cache.AddInterface ("org.LeechCraft.IFoo/1.0"));
+
+		auto record = MakeRecord ("org.LeechCraft.Test");
+		record.Interfaces_ << "org.LeechCraft.IBar/1.0";
+		record.CheckedInterfaces_ = 2;
+		cache.Set (lib, record);
+
+		cache.AddInterface ("org.LeechCraft.IBaz/1.0");
+
+		const auto& loaded = Reload (Dir_->filePath ("settings.ini"), cache);
+		QCOMPARE (loaded.GetInterfaces ().size (), 3);
+
+		const auto& loadedRecord = loaded.Get (lib);
+		QVERIFY (loadedRecord);
+		QVERIFY (!loaded.MayImplement (*loadedRecord, "org.LeechCraft.IFoo/1.0"));
+		QVERIFY (loaded.MayImplement (*loadedRecord, "org.LeechCraft.IBar/1.0"));
+		QVERIFY (loaded.MayImplement (*loadedRecord, "org.LeechCraft.IBaz/1.0"));
+		QVERIFY (loaded.MayImplement (*loadedRecord, "org.LeechCraft.IQux/1.0"));
+	}
+
+	namespace
+	{
+		const int PluginsCount = 150;
+
+		QStringList MakeLibs (const QTemporaryDir& dir)
+		{
+			QStringList libs;
+			for (int i = 0; i < PluginsCount; ++i)
+			{
+				const auto& lib = dir.filePath (QString { "libleechcraft_test%1.so" }.arg (i));
+				WriteFile (lib, "library");
+				libs << lib;
+			}
+			return libs;
+		}
+
+		/* Mimics what PluginManager does with the cache during the
+		 * startup: loads it, looks up the records for all the plugins,
+		 * updates the missing ones and saves the cache back.
+		 */
+		int RunStartup (const QString& settingsPath, const QStringList& libs)
+		{
+			QSettings settings { settingsPath, QSettings::IniFormat };
+			PluginManifestCache cache;
+			cache.Load (settings);
+			cache.Prune (libs);
+
+			int valid = 0;
+			for (int i = 0; i < libs.size (); ++i)
+				if (cache.Get (libs.at (i)))
+					++valid;
+				else
+					cache.Set (libs.at (i), MakeRecord ("org.LeechCraft.Test" + QByteArray::number (i)));
+
+			cache.Save (settings);
+			return valid;
+		}
+	}
+
+	void PluginManifestCacheTest::benchColdStartup ()
+	{
+		const auto& libs = MakeLibs (*Dir_);
+		const auto& settingsPath = Dir_->filePath ("settings.ini");
+
+		int valid = -1;
+		QBENCHMARK
+		{
+			QFile::remove (settingsPath);
+			valid = RunStartup (settingsPath, libs);
+		}
+		QCOMPARE (valid, 0);
+	}
+
+	void PluginManifestCacheTest::benchWarmStartup ()
+	{
+		const auto& libs = MakeLibs (*Dir_);
+		const auto& settingsPath = Dir_->filePath ("settings.ini");
+		RunStartup (settingsPath, libs);
+
+		int valid = -1;
+		QBENCHMARK
+		{
+			valid = RunStartup (settingsPath, libs);
+		}
+		QCOMPARE (valid, PluginsCount);
+	}
+}
@@ -0,0 +1,216 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "tracertest.h"
+#include <QtTest>
+#include <QtConcurrentRun>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <util/sys/tracespan.h>
+#include "tracer.h"
+
+QTEST_GUILESS_MAIN (LeechCraft::TracerTest)
+
+namespace LeechCraft
+{
+	namespace
+	{
+		QList<QJsonObject> ReadEvents (const QString& path, const QString& phase)
+		{
+			QFile file { path };
+			if (!file.open (QIODevice::ReadOnly))
+				return {};
+
+			QList<QJsonObject> result;
+			for (const auto& eventVal : QJsonDocument::fromJson (file.readAll ()).object () ["traceEvents"].toArray ())
+			{
+				const auto& event = eventVal.toObject ();
+				if (event ["ph"].toString () == phase)
+					result << event;
+			}
+			return result;
+		}
+	}
+
+	void TracerTest::init ()
+	{
+		Dir_ = std::make_unique<QTemporaryDir> ();
+		QVERIFY (Dir_->isValid ());
+	}
+
+	void TracerTest::cleanup ()
+	{
+		Dir_.reset ();
+	}
+
+	void TracerTest::testDisabled ()
+	{
+		Tracer tracer;
+		QVERIFY (!tracer.IsEnabled ());
+		QCOMPARE (tracer.Now (), qint64 { 0 });
+
+		tracer.AddSpan ("test", "span", 0, 1);
+		tracer.SetCounter ("test", "counter", 1);
+		QVERIFY (!tracer.Dump ());
+	}
+
+	void TracerTest::testSpansAndCounters ()
+	{
+		const auto& path = Dir_->path () + "/trace.json";
+
+		Tracer tracer;
+		tracer.Enable (path);
+		QVERIFY (tracer.IsEnabled ());
+
+		tracer.AddSpan ("test", "static", 10, 30);
+		tracer.AddSpan ("test", QString { "dynamic %1" }.arg (42), 40, 45);
+		tracer.SetCounter ("test", "counter", 7);
+		QVERIFY (tracer.Dump ());
+
+		const auto& spans = ReadEvents (path, "X");
+		QCOMPARE (spans.size (), 2);
+		QCOMPARE (spans [0] ["name"].toString (), QString { "static" });
+		QCOMPARE (spans [0] ["cat"].toString (), QString { "test" });
+		QCOMPARE (spans [0] ["ts"].toDouble (), 10.);
+		QCOMPARE (spans [0] ["dur"].toDouble (), 20.);
+		QCOMPARE (spans [1] ["name"].toString (), QString { "dynamic 42" });
+		QCOMPARE (spans [1] ["dur"].toDouble (), 5.);
+
+		const auto& counters = ReadEvents (path, "C");
+		QCOMPARE (counters.size (), 1);
+		QCOMPARE (counters [0] ["args"].toObject () ["counter"].toDouble (), 7.);
+
+		QCOMPARE (ReadEvents (path, "M").size (), 1);
+	}
+
+	void TracerTest::testRingBufferWraps ()
+	{
+		const auto& path = Dir_->path () + "/trace.json";
+
+		Tracer tracer;
+		tracer.Enable (path, 4);
+		for (int i = 0; i < 10; ++i)
+			tracer.AddSpan ("test", QString::number (i), i, i + 1);
+		QVERIFY (tracer.Dump ());
+
+		QStringList names;
+		for (const auto& span : ReadEvents (path, "X"))
+			names << span ["name"].toString ();
+		QCOMPARE (names, (QStringList { "6", "7", "8", "9" }));
+	}
+
+	void TracerTest::testPerThreadBuffers ()
+	{
+		const auto& path = Dir_->path () + "/trace.json";
+
+		Tracer tracer;
+		tracer.Enable (path);
+
+		QThreadPool pool;
+		pool.setMaxThreadCount (4);
+
+		QList<QFuture<void>> futures;
+		for (int i = 0; i < 4; ++i)
+			futures << QtConcurrent::run (&pool,
+					[&tracer]
+					{
+						for (int j = 0; j < 100; ++j)
+							tracer.AddSpan ("test", "span", tracer.Now (), tracer.Now ());
+						QThread::msleep (50);
+					});
+		for (auto& future : futures)
+			future.waitForFinished ();
+
+		QVERIFY (tracer.Dump ());
+
+		const auto& spans = ReadEvents (path, "X");
+		QCOMPARE (spans.size (), 400);
+
+		QSet<int> tids;
+		for (const auto& span : spans)
+			tids << span ["tid"].toInt ();
+		QCOMPARE (tids.size (), ReadEvents (path, "M").size ());
+		QVERIFY (tids.size () > 1);
+	}
+
+	void TracerTest::testTraceSpan ()
+	{
+		const auto& path = Dir_->path () + "/trace.json";
+
+		Tracer disabled;
+		bool nameRequested = false;
+		{
+			Util::TraceSpan span { &disabled, "test",
+					[&nameRequested] { nameRequested = true; return QString { "lazy" }; } };
+		}
+		QVERIFY (!nameRequested);
+
+		{
+			Util::TraceSpan span { nullptr, "test", "null" };
+		}
+
+		Tracer tracer;
+		tracer.Enable (path);
+		{
+			Util::TraceSpan span { &tracer, "test", "static" };
+		}
+		{
+			Util::TraceSpan span { &tracer, "test",
+					[&nameRequested] { nameRequested = true; return QString { "lazy" }; } };
+		}
+		QVERIFY (nameRequested);
+		QVERIFY (tracer.Dump ());
+
+		QStringList names;
+		for (const auto& span : ReadEvents (path, "X"))
+			names << span ["name"].toString ();
+		QCOMPARE (names, (QStringList { "static", "lazy" }));
+	}
+
+	void TracerTest::benchDisabledSpan ()
+	{
+		Tracer tracer;
+		QBENCHMARK
+		{
+			Util::TraceSpan span { &tracer, "test", "span" };
+		}
+	}
+
+	void TracerTest::benchEnabledSpan ()
+	{
+		Tracer tracer;
+		tracer.Enable (Dir_->path () + "/trace.json");
+		QBENCHMARK
+		{
+			Util::TraceSpan span { &tracer, "test", "span" };
+		}
+	}
+}
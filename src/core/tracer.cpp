@@ -0,0 +1,238 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "tracer.h"
+#include <QCoreApplication>
+#include <QThread>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QtDebug>
+
+namespace LeechCraft
+{
+	Tracer& Tracer::Instance ()
+	{
+		static Tracer tracer;
+		static const bool enabled = [] () -> bool
+			{
+				const auto& path = QString::fromLocal8Bit (qgetenv ("LC_TRACE"));
+				if (path.isEmpty ())
+					return false;
+
+				qDebug () << Q_FUNC_INFO
+						<< "tracing to"
+						<< path;
+				tracer.Enable (path);
+				return true;
+			} ();
+		Q_UNUSED (enabled)
+		return tracer;
+	}
+
+	void Tracer::Enable (const QString& path, int eventsPerThread)
+	{
+		Path_ = path;
+		Capacity_ = eventsPerThread;
+		Timer_.start ();
+		Enabled_.store (true, std::memory_order_release);
+	}
+
+	bool Tracer::Dump () const
+	{
+		if (!IsEnabled ())
+			return false;
+
+		QJsonArray events;
+
+		const auto& appendEvent = [&events] (int tid, const Event& event)
+		{
+			const auto& name = event.Name_ ?
+					QString::fromLatin1 (event.Name_) :
+					event.DynamicName_;
+			switch (event.Type_)
+			{
+			case Event::Type::Span:
+				events.append (QJsonObject
+						{
+							{ "name", name },
+							{ "cat", event.Category_ },
+							{ "ph", "X" },
+							{ "pid", 1 },
+							{ "tid", tid },
+							{ "ts", static_cast<double> (event.Start_) },
+							{ "dur", static_cast<double> (event.Value_ - event.Start_) }
+						});
+				break;
+			case Event::Type::Counter:
+				events.append (QJsonObject
+						{
+							{ "name", name },
+							{ "cat", event.Category_ },
+							{ "ph", "C" },
+							{ "pid", 1 },
+							{ "tid", tid },
+							{ "ts", static_cast<double> (event.Start_) },
+							{ "args", QJsonObject { { name, static_cast<double> (event.Value_) } } }
+						});
+				break;
+			}
+		};
+
+		QList<ThreadBuffer_ptr> buffers;
+		{
+			QMutexLocker locker { &BuffersMutex_ };
+			buffers = Buffers_;
+		}
+
+		for (const auto& buffer : buffers)
+		{
+			QMutexLocker locker { &buffer->Mutex_ };
+
+			events.append (QJsonObject
+					{
+						{ "name", "thread_name" },
+						{ "ph", "M" },
+						{ "pid", 1 },
+						{ "tid", buffer->ID_ },
+						{ "args", QJsonObject { { "name", buffer->Name_ } } }
+					});
+
+			if (buffer->Wrapped_)
+				for (int i = buffer->Next_; i < buffer->Events_.size (); ++i)
+					appendEvent (buffer->ID_, buffer->Events_.at (i));
+			for (int i = 0; i < buffer->Next_; ++i)
+				appendEvent (buffer->ID_, buffer->Events_.at (i));
+		}
+
+		QFile file { Path_ };
+		if (!file.open (QIODevice::WriteOnly))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to open"
+					<< Path_
+					<< "for writing:"
+					<< file.errorString ();
+			return false;
+		}
+
+		const QJsonObject root { { "traceEvents", events } };
+		file.write (QJsonDocument { root }.toJson (QJsonDocument::Compact));
+		return true;
+	}
+
+	bool Tracer::IsEnabled () const
+	{
+		return Enabled_.load (std::memory_order_acquire);
+	}
+
+	qint64 Tracer::Now () const
+	{
+		return IsEnabled () ? Timer_.nsecsElapsed () / 1000 : 0;
+	}
+
+	void Tracer::AddSpan (const char *category, const char *name, qint64 start, qint64 end)
+	{
+		if (IsEnabled ())
+			Append ({ Event::Type::Span, category, name, {}, start, end });
+	}
+
+	void Tracer::AddSpan (const char *category, const QString& name, qint64 start, qint64 end)
+	{
+		if (IsEnabled ())
+			Append ({ Event::Type::Span, category, nullptr, name, start, end });
+	}
+
+	void Tracer::SetCounter (const char *category, const char *name, qint64 value)
+	{
+		if (IsEnabled ())
+			Append ({ Event::Type::Counter, category, name, {}, Now (), value });
+	}
+
+	void Tracer::Append (Event&& event)
+	{
+		auto& buffer = GetThreadBuffer ();
+
+		event.Category_ = Intern (buffer, event.Category_);
+		event.Name_ = Intern (buffer, event.Name_);
+
+		QMutexLocker locker { &buffer.Mutex_ };
+		buffer.Events_ [buffer.Next_] = std::move (event);
+		if (++buffer.Next_ == buffer.Events_.size ())
+		{
+			buffer.Next_ = 0;
+			buffer.Wrapped_ = true;
+		}
+	}
+
+	const char* Tracer::Intern (ThreadBuffer& buffer, const char *str)
+	{
+		if (!str)
+			return nullptr;
+
+		// The same address might hold a different string if the plugin
+		// it belonged to has been unloaded, hence the comparison.
+		const auto pos = buffer.Interned_.constFind (str);
+		if (pos != buffer.Interned_.constEnd () && !qstrcmp (*pos, str))
+			return *pos;
+
+		QMutexLocker locker { &StringsMutex_ };
+		const auto interned = Strings_.insert (QByteArray { str })->constData ();
+		buffer.Interned_ [str] = interned;
+		return interned;
+	}
+
+	Tracer::ThreadBuffer& Tracer::GetThreadBuffer ()
+	{
+		if (CurrentBuffer_.hasLocalData ())
+			return *CurrentBuffer_.localData ();
+
+		const auto buffer = std::make_shared<ThreadBuffer> ();
+		buffer->Events_.resize (Capacity_);
+
+		const auto thread = QThread::currentThread ();
+		if (qApp && thread == qApp->thread ())
+			buffer->Name_ = "GUI thread";
+		else if (!thread->objectName ().isEmpty ())
+			buffer->Name_ = thread->objectName ();
+
+		{
+			QMutexLocker locker { &BuffersMutex_ };
+			buffer->ID_ = Buffers_.size ();
+			if (buffer->Name_.isEmpty ())
+				buffer->Name_ = QString { "Thread %1" }.arg (buffer->ID_);
+			Buffers_ << buffer;
+		}
+
+		CurrentBuffer_.setLocalData (buffer);
+		return *buffer;
+	}
+}
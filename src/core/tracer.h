@@ -0,0 +1,138 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <QByteArray>
+#include <QString>
+#include <QThreadStorage>
+#include <QVector>
+#include "interfaces/core/itracer.h"
+
+namespace LeechCraft
+{
+	/** @brief Implements the ITracer interface.
+	 *
+	 * Each thread writes its events into its own fixed-size ring buffer,
+	 * so only the latest events are kept if the buffer overflows. The
+	 * buffers are locked only by their own thread, except when the
+	 * trace is being written.
+	 *
+	 * The category and the static names are interned on the first use,
+	 * so the events don't refer to the strings of the plugins that might
+	 * get unloaded before the trace is written.
+	 */
+	class Tracer : public ITracer
+	{
+		std::atomic<bool> Enabled_ { false };
+		QElapsedTimer Timer_;
+		QString Path_;
+		int Capacity_ = 0;
+
+		struct Event
+		{
+			enum class Type
+			{
+				Span,
+				Counter
+			} Type_;
+
+			const char *Category_;
+			const char *Name_;
+			QString DynamicName_;
+			qint64 Start_;
+
+			// The end timestamp for spans, the value for counters.
+			qint64 Value_;
+		};
+
+		struct ThreadBuffer
+		{
+			QMutex Mutex_;
+			QVector<Event> Events_;
+			int Next_ = 0;
+			bool Wrapped_ = false;
+
+			int ID_;
+			QString Name_;
+
+			// the strings passed by this thread to their interned copies
+			QHash<const char*, const char*> Interned_;
+		};
+		typedef std::shared_ptr<ThreadBuffer> ThreadBuffer_ptr;
+
+		QThreadStorage<ThreadBuffer_ptr> CurrentBuffer_;
+
+		mutable QMutex BuffersMutex_;
+		QList<ThreadBuffer_ptr> Buffers_;
+
+		QMutex StringsMutex_;
+		QSet<QByteArray> Strings_;
+	public:
+		/** Constructs a disabled tracer.
+		 */
+		Tracer () = default;
+
+		/** Returns the application-wide tracer, enabled if the
+		 * LC_TRACE environment variable is set.
+		 */
+		static Tracer& Instance ();
+
+		/** Enables the tracer with the given output path and the
+		 * number of events to keep per thread. Should be called before
+		 * any events are recorded.
+		 */
+		void Enable (const QString& path, int eventsPerThread = 16384);
+
+		/** Writes the trace to the path passed to Enable(). The events
+		 * are kept, so the subsequent calls write a superset of what has
+		 * been written before, save for the events pushed out of the
+		 * ring buffers.
+		 */
+		bool Dump () const;
+
+		bool IsEnabled () const override;
+		qint64 Now () const override;
+		void AddSpan (const char*, const char*, qint64, qint64) override;
+		void AddSpan (const char*, const QString&, qint64, qint64) override;
+		void SetCounter (const char*, const char*, qint64) override;
+	private:
+		void Append (Event&&);
+		const char* Intern (ThreadBuffer&, const char*);
+		ThreadBuffer& GetThreadBuffer ();
+	};
+}
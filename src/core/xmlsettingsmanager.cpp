@@ -31,7 +31,9 @@
 #include <QDynamicPropertyChangeEvent>
 #include <QCoreApplication>
 #include <QtDebug>
+#include <util/sys/tracespan.h>
 #include "xmlsettingsmanager.h"
+#include "tracer.h"
 
 namespace LeechCraft
 {
@@ -60,5 +62,33 @@ namespace LeechCraft
 	void XmlSettingsManager::EndSettings (QSettings*) const
 	{
 	}
+
+	bool XmlSettingsManager::event (QEvent *e)
+	{
+		if (e->type () != QEvent::DynamicPropertyChange)
+			return Util::BaseSettingsManager::event (e);
+
+		const auto propName = static_cast<QDynamicPropertyChangeEvent*> (e)->propertyName ();
+		Util::TraceSpan span { &Tracer::Instance (), "settings",
+				[&propName] { return "Setting " + QString::fromUtf8 (propName); } };
+		return Util::BaseSettingsManager::event (e);
+	}
+
+	Settings_ptr XmlSettingsManager::GetSettings () const
+	{
+		auto& tracer = Tracer::Instance ();
+		if (!tracer.IsEnabled ())
+			return Util::BaseSettingsManager::GetSettings ();
+
+		// The span covers the whole lifetime of the QSettings object.
+		const auto start = tracer.Now ();
+		const auto& settings = Util::BaseSettingsManager::GetSettings ();
+		return Settings_ptr (settings.get (),
+				[settings, start, &tracer] (QSettings*) mutable
+				{
+					settings.reset ();
+					tracer.AddSpan ("settings", "XmlSettingsManager::GetSettings", start, tracer.Now ());
+				});
+	}
 };
 
@@ -44,6 +44,9 @@ namespace LeechCraft
 	protected:
 		virtual QSettings* BeginSettings () const;
 		virtual void EndSettings (QSettings*) const;
+
+		bool event (QEvent*) override;
+		Settings_ptr GetSettings () const override;
 	};
 };
 
@@ -47,6 +47,7 @@ class QAbstractItemModel;
 class QTabWidget;
 class IColorThemeManager;
 class IIconThemeManager;
+class ITracer;
 class QAction;
 
 namespace LeechCraft
@@ -137,6 +138,18 @@ public:
 	 */
 	virtual ITagsManager* GetTagsManager () const = 0;
 
+	/** @brief Returns the application-wide tracer.
+	 *
+	 * The returned pointer may be null if the tracing isn't supported by
+	 * the current plugin loader. LeechCraft::Util::TraceSpan handles
+	 * this case.
+	 *
+	 * @return The application-wide tracer.
+	 *
+	 * @sa ITracer
+	 */
+	virtual ITracer* GetTracer () const = 0;
+
 	/** Returns the list of all possible search categories from the
 	 * finders installed.
 	 *
@@ -31,6 +31,7 @@
 
 #include <memory>
 #include <QStringList>
+#include <QObject>
 #include <QObjectList>
 
 class ILoadProgressReporter;
@@ -86,12 +87,17 @@ public:
 	 * and returns only those that can be casted to T via passing the
 	 * result of GetAllPlugins() to Filter<T>().
 	 *
+	 * If T is an interface, the plugins that are not loaded yet but
+	 * may implement it are loaded first, see GetAllImplementing().
+	 *
 	 * @return The list of pointers to plugin instances that are
 	 * castable to type T.
 	 */
 	template<typename T>
 	QObjectList GetAllCastableRoots () const
 	{
+		if (const auto iid = qobject_interface_iid<T> ())
+			return GetAllImplementing (iid);
 		return Filter<T> (GetAllPlugins ());
 	}
 
@@ -208,6 +214,20 @@ public:
 	 * @sa ILoadProgressReporter
 	 */
 	virtual ILoadProgressReporter_ptr CreateLoadProgressReporter (QObject *thisPlugin) = 0;
+
+	/** @brief Returns all plugins implementing the given interface.
+	 *
+	 * Plugins loaded on demand (see the LoadOnDemand manifest key) that
+	 * may implement the interface are loaded by this function before
+	 * the result is collected.
+	 *
+	 * Prefer GetAllCastableRoots(), which calls this function for
+	 * interface types.
+	 *
+	 * @param[in] iid The IID of the interface, as in Q_DECLARE_INTERFACE.
+	 * @return The list of plugins implementing the interface.
+	 */
+	virtual QObjectList GetAllImplementing (const char *iid) const = 0;
 };
 
 Q_DECLARE_INTERFACE (IPluginsManager, "org.Deviant.LeechCraft.IPluginsManager/1.0")
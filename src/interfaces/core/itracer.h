@@ -0,0 +1,104 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#pragma once
+
+#include <QObject>
+
+class QString;
+
+/** @brief Interface to the application-wide tracing subsystem.
+ *
+ * The tracer collects timed spans and counter values into per-thread
+ * ring buffers, which are then written in the Chrome trace event format
+ * (viewable in chrome://tracing or similar tools). Tracing is enabled by
+ * setting the \em LC_TRACE environment variable to the path of the
+ * resulting file, and costs a single virtual call per event otherwise.
+ *
+ * All the methods of this interface are thread-safe.
+ *
+ * The category and static names only need to be valid during the call:
+ * the tracer keeps its own copies of them, so it is fine to pass the
+ * strings of a plugin that is unloaded before the trace is written.
+ *
+ * Prefer the LeechCraft::Util::TraceSpan class to calling AddSpan()
+ * directly.
+ *
+ * @sa ICoreProxy::GetTracer()
+ * @sa LeechCraft::Util::TraceSpan
+ */
+class Q_DECL_EXPORT ITracer
+{
+public:
+	virtual ~ITracer () {}
+
+	/** @brief Returns whether tracing is enabled.
+	 *
+	 * If this function returns false, all other functions do nothing,
+	 * so there is no point in preparing any dynamic names or values for
+	 * them.
+	 *
+	 * @return Whether tracing is enabled.
+	 */
+	virtual bool IsEnabled () const = 0;
+
+	/** @brief Returns the current trace timestamp.
+	 *
+	 * @return Microseconds since the tracing has started, or 0 if
+	 * tracing is disabled.
+	 */
+	virtual qint64 Now () const = 0;
+
+	/** @brief Records a span on the current thread.
+	 *
+	 * @param[in] category The category of the span, like \em entity
+	 * or \em settings.
+	 * @param[in] name The static name of the span.
+	 * @param[in] start The start timestamp as returned by Now().
+	 * @param[in] end The end timestamp as returned by Now().
+	 */
+	virtual void AddSpan (const char *category, const char *name, qint64 start, qint64 end) = 0;
+
+	/** @brief Records a span with a dynamic name on the current thread.
+	 *
+	 * This is an overloaded function provided for convenience.
+	 */
+	virtual void AddSpan (const char *category, const QString& name, qint64 start, qint64 end) = 0;
+
+	/** @brief Records the current value of the given counter.
+	 *
+	 * @param[in] category The category of the counter.
+	 * @param[in] name The static name of the counter.
+	 * @param[in] value The current value of the counter.
+	 */
+	virtual void SetCounter (const char *category, const char *name, qint64 value) = 0;
+};
+
+Q_DECLARE_INTERFACE (ITracer, "org.Deviant.LeechCraft.ITracer/1.0")
@@ -80,6 +80,25 @@ public:
 	 * plugins etc. That also means that in this function you can't rely
 	 * on other plugins being initialized.
 	 *
+	 * If this method doesn't create widgets or otherwise touch any
+	 * thread-affine objects, the plugin may set the "ThreadSafeInit"
+	 * key of its manifest to true. Then it will be initialized on a
+	 * worker thread concurrently with other independent plugins, with
+	 * all the plugins it depends on already initialized. In this case:
+	 * - Objects created in this method live in that worker thread and
+	 *   should be moved to the GUI thread if needed.
+	 * - Such objects must not be parented to the plugin instance object
+	 *   or any other object living in the GUI thread, since QObject
+	 *   doesn't allow parents from other threads.
+	 * - Database connections are bound to the thread that has opened
+	 *   them, so they shouldn't be opened here either.
+	 * - Installing translators via Util::InstallTranslator() is fine.
+	 *
+	 * While waiting for such plugins, the GUI thread keeps processing
+	 * timers and queued calls (but not user input), so the plugins
+	 * initialized earlier may have their timers and queued slots run
+	 * before this stage is complete.
+	 *
 	 * @param[in] proxy The pointer to proxy to LeechCraft.
 	 *
 	 * @sa Release
@@ -371,3 +390,4 @@ Q_DECLARE_INTERFACE (IInfo, "org.Deviant.LeechCraft.IInfo/1.0")
 	}
 
 #define LC_PLUGIN_METADATA(id) Q_PLUGIN_METADATA (IID id)
+#define LC_PLUGIN_METADATA_FILE(id,file) Q_PLUGIN_METADATA (IID id FILE file)
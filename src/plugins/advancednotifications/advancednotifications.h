@@ -65,7 +65,7 @@ namespace AdvancedNotifications
 				IPluginReady
 				IANRulesStorage)
 
-		LC_PLUGIN_METADATA ("org.LeechCraft.AdvancedNotifications")
+		LC_PLUGIN_METADATA_FILE ("org.LeechCraft.AdvancedNotifications", "manifest.json")
 
 		ICoreProxy_ptr Proxy_;
 
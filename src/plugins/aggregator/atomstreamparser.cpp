@@ -0,0 +1,241 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "atomstreamparser.h"
+#include <QObject>
+#include <QXmlStreamReader>
+#include "feedelements.h"
+
+namespace LeechCraft
+{
+namespace Aggregator
+{
+	channels_container_t AtomStreamParser::Parse (QXmlStreamReader& reader,
+			const IDType_t& feedId) const
+	{
+		const auto chan = std::make_shared<Channel> (feedId);
+
+		auto head = FeedElements::ReadRoot (reader);
+		AuthorTracker author;
+
+		MRSSLocatedData context;
+		bool contextDirty = false;
+
+		while (reader.readNextStartElement ())
+		{
+			if (reader.name () != "entry")
+			{
+				const auto child = head.Append (reader);
+				TrackAuthor (author, head, child);
+				contextDirty = true;
+				continue;
+			}
+
+			const auto& entryElems = FeedElements::Read (reader);
+			TrackAuthor (author, entryElems, 0);
+
+			if (contextDirty)
+			{
+				context = GetMRSSLocatedData (head, 0);
+				contextDirty = false;
+			}
+
+			chan->Items_.push_back (ParseItem (entryElems, chan->ChannelID_, context));
+		}
+
+		FillChannel (*chan, head, author);
+
+		return { chan };
+	}
+
+	QString AtomStreamParser::ParseEscapeAware (const FeedElements& elems, int parent) const
+	{
+		const auto& type = elems.Attribute (parent, "type");
+		if (!elems.HasAttribute (parent, "type") ||
+				type == "text" ||
+				(type == "text/html" &&
+					elems.Attribute (parent, "mode") != "escaped"))
+			return elems.Text (parent);
+		else
+			return UnescapeHTML (elems.Text (parent));
+	}
+
+	QList<Enclosure> AtomStreamParser::GetEnclosures (const FeedElements& elems,
+			int entry, const IDType_t& itemId) const
+	{
+		QList<Enclosure> result;
+		for (const auto link : elems.ByTagName (entry, "link"))
+		{
+			if (elems.Attribute (link, "rel") != "enclosure")
+				continue;
+
+			Enclosure e (itemId);
+			e.URL_ = elems.Attribute (link, "href");
+			e.Type_ = elems.Attribute (link, "type");
+			e.Length_ = elems.Attribute (link, "length", "-1").toLongLong ();
+			e.Lang_ = elems.Attribute (link, "hreflang");
+			result << e;
+		}
+		return result;
+	}
+
+	Atom10StreamParser& Atom10StreamParser::Instance ()
+	{
+		static Atom10StreamParser inst;
+		return inst;
+	}
+
+	bool Atom10StreamParser::CouldParse (const QXmlStreamReader& reader) const
+	{
+		if (reader.name () != "feed")
+			return false;
+		const auto& attrs = reader.attributes ();
+		return !attrs.hasAttribute ("version") || attrs.value ("version") == "1.0";
+	}
+
+	void Atom10StreamParser::FillChannel (Channel& chan,
+			const FeedElements& head, const AuthorTracker& author) const
+	{
+		chan.Title_ = head.Text (head.FirstChild (0, "title")).trimmed ();
+		if (chan.Title_.isEmpty ())
+			chan.Title_ = QObject::tr ("(No title)");
+		chan.LastBuild_ = FromRFC3339 (head.Text (head.FirstChild (0, "updated")));
+		chan.Link_ = GetLink (head, 0);
+		chan.Description_ = head.Text (head.FirstChild (0, "subtitle"));
+		chan.Author_ = author.GetAuthor ();
+		if (chan.Author_.isEmpty ())
+		{
+			const auto authorElem = head.FirstChild (0, "author");
+			chan.Author_ = head.Text (head.FirstChild (authorElem, "name")) +
+				" (" +
+				head.Text (head.FirstChild (authorElem, "email")) +
+				")";
+		}
+		chan.Language_ = "<>";
+	}
+
+	Item_ptr Atom10StreamParser::ParseItem (const FeedElements& entry,
+			const IDType_t& channelId, const MRSSLocatedData& context) const
+	{
+		const auto item = std::make_shared<Item> (channelId);
+
+		item->Title_ = entry.Text (entry.FirstChild (0, "title"));
+		item->Link_ = GetLink (entry, 0);
+		item->Guid_ = entry.Text (entry.FirstChild (0, "id"));
+		item->PubDate_ = FromRFC3339 (entry.Text (entry.FirstChild (0, "updated")));
+		item->Unread_ = true;
+		item->Categories_ = GetAllCategories (entry, 0);
+		item->Author_ = GetAuthor (entry, 0);
+		item->NumComments_ = GetNumComments (entry, 0);
+		item->CommentsLink_ = GetCommentsRSS (entry, 0);
+		item->CommentsPageLink_ = GetCommentsLink (entry, 0);
+
+		auto summary = entry.FirstChild (0, "content");
+		if (summary < 0)
+			summary = entry.FirstChild (0, "summary");
+		item->Description_ = ParseEscapeAware (entry, summary);
+		GetDescription (entry, 0, item->Description_);
+
+		item->Enclosures_ = GetEnclosures (entry, 0, item->ItemID_);
+		item->Enclosures_ += GetEncEnclosures (entry, 0, item->ItemID_);
+
+		const auto& point = GetGeoPoint (entry, 0);
+		item->Latitude_ = point.first;
+		item->Longitude_ = point.second;
+		item->MRSSEntries_ = GetMediaRSS (entry, item->ItemID_, context);
+
+		return item;
+	}
+
+	Atom03StreamParser& Atom03StreamParser::Instance ()
+	{
+		static Atom03StreamParser inst;
+		return inst;
+	}
+
+	bool Atom03StreamParser::CouldParse (const QXmlStreamReader& reader) const
+	{
+		return reader.name () == "feed" &&
+				reader.attributes ().value ("version") == "0.3";
+	}
+
+	void Atom03StreamParser::FillChannel (Channel& chan,
+			const FeedElements& head, const AuthorTracker& author) const
+	{
+		chan.Title_ = head.Text (head.FirstChild (0, "title")).trimmed ();
+		if (chan.Title_.isEmpty ())
+			chan.Title_ = QObject::tr ("(No title)");
+		chan.LastBuild_ = FromRFC3339 (head.Text (head.FirstChild (0, "updated")));
+		chan.Link_ = GetLink (head, 0);
+		chan.Description_ = head.Text (head.FirstChild (0, "tagline"));
+		chan.Language_ = "<>";
+		chan.Author_ = author.GetAuthor ();
+	}
+
+	Item_ptr Atom03StreamParser::ParseItem (const FeedElements& entry,
+			const IDType_t& channelId, const MRSSLocatedData& context) const
+	{
+		const auto item = std::make_shared<Item> (channelId);
+
+		item->Title_ = ParseEscapeAware (entry, entry.FirstChild (0, "title"));
+		item->Link_ = GetLink (entry, 0);
+		item->Guid_ = entry.Text (entry.FirstChild (0, "id"));
+		item->Unread_ = true;
+
+		auto date = entry.FirstChild (0, "modified");
+		if (date < 0)
+			date = entry.FirstChild (0, "issued");
+		item->PubDate_ = FromRFC3339 (entry.Text (date));
+
+		auto summary = entry.FirstChild (0, "content");
+		if (summary < 0)
+			summary = entry.FirstChild (0, "summary");
+		item->Description_ = ParseEscapeAware (entry, summary);
+		GetDescription (entry, 0, item->Description_);
+
+		item->Categories_ += GetAllCategories (entry, 0);
+		item->Author_ = GetAuthor (entry, 0);
+
+		item->NumComments_ = GetNumComments (entry, 0);
+		item->CommentsLink_ = GetCommentsRSS (entry, 0);
+		item->CommentsPageLink_ = GetCommentsLink (entry, 0);
+
+		item->Enclosures_ = GetEnclosures (entry, 0, item->ItemID_);
+		item->Enclosures_ += GetEncEnclosures (entry, 0, item->ItemID_);
+
+		const auto& point = GetGeoPoint (entry, 0);
+		item->Latitude_ = point.first;
+		item->Longitude_ = point.second;
+		item->MRSSEntries_ = GetMediaRSS (entry, item->ItemID_, context);
+
+		return item;
+	}
+}
+}
@@ -0,0 +1,92 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#pragma once
+
+#include "streamparser.h"
+
+namespace LeechCraft
+{
+namespace Aggregator
+{
+	/** @brief Base class for the streaming parsers of Atom feeds.
+	 *
+	 * An Atom document contains exactly one channel, the feed element
+	 * itself, so its entries are parsed as soon as their closing
+	 * tags are read.
+	 */
+	class AtomStreamParser : public StreamParser
+	{
+	protected:
+		channels_container_t Parse (QXmlStreamReader&,
+				const IDType_t&) const override;
+
+		/** @brief Fills the channel fields from its non-entry elements.
+		 *
+		 * @param[in] channel The channel to fill.
+		 * @param[in] head The feed element with its children except
+		 * entries.
+		 * @param[in] author The author data collected from the whole
+		 * feed, including entries.
+		 */
+		virtual void FillChannel (Channel& channel,
+				const FeedElements& head, const AuthorTracker& author) const = 0;
+		virtual Item_ptr ParseItem (const FeedElements&,
+				const IDType_t&, const MRSSLocatedData&) const = 0;
+
+		QString ParseEscapeAware (const FeedElements&, int) const;
+		QList<Enclosure> GetEnclosures (const FeedElements&, int, const IDType_t&) const;
+	};
+
+	class Atom10StreamParser : public AtomStreamParser
+	{
+		Atom10StreamParser () = default;
+	public:
+		static Atom10StreamParser& Instance ();
+
+		bool CouldParse (const QXmlStreamReader&) const override;
+	protected:
+		void FillChannel (Channel&, const FeedElements&, const AuthorTracker&) const override;
+		Item_ptr ParseItem (const FeedElements&, const IDType_t&, const MRSSLocatedData&) const override;
+	};
+
+	class Atom03StreamParser : public AtomStreamParser
+	{
+		Atom03StreamParser () = default;
+	public:
+		static Atom03StreamParser& Instance ();
+
+		bool CouldParse (const QXmlStreamReader&) const override;
+	protected:
+		void FillChannel (Channel&, const FeedElements&, const AuthorTracker&) const override;
+		Item_ptr ParseItem (const FeedElements&, const IDType_t&, const MRSSLocatedData&) const override;
+	};
+}
+}
@@ -34,14 +34,14 @@
 #include <QPixmap>
 #include "channel.h"
 #include "item.h"
-#include "core.h"
+#include "poolsmanager.h"
 
 namespace LeechCraft
 {
 namespace Aggregator
 {
 	Channel::Channel (const IDType_t& id)
-	: ChannelID_ (Core::Instance ().GetPool (PTChannel).GetID ())
+	: ChannelID_ (PoolsManager::Instance ().GetPool (PTChannel).GetID ())
 	, FeedID_ (id)
 	{
 	}
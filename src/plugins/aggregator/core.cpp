@@ -36,8 +36,11 @@
 #include <QDesktopServices>
 #include <QUrl>
 #include <QTimer>
+#include <QBuffer>
 #include <QTextCodec>
+#include <QXmlStreamReader>
 #include <QXmlStreamWriter>
+#include <QDomDocument>
 #include <QNetworkReply>
 #include <interfaces/iwebbrowser.h>
 #include <interfaces/core/icoreproxy.h>
@@ -57,11 +60,8 @@
 #include "core.h"
 #include "xmlsettingsmanager.h"
 #include "parserfactory.h"
-#include "rss20parser.h"
-#include "rss10parser.h"
-#include "rss091parser.h"
-#include "atom10parser.h"
-#include "atom03parser.h"
+#include "rssstreamparser.h"
+#include "atomstreamparser.h"
 #include "channelsmodel.h"
 #include "opmlparser.h"
 #include "opmlwriter.h"
@@ -75,6 +75,8 @@
 #include "dbupdatethreadworker.h"
 #include "dumbstorage.h"
 #include "storagebackendmanager.h"
+#include "feedupdatescheduler.h"
+#include "poolsmanager.h"
 
 namespace LeechCraft
 {
@@ -115,6 +117,7 @@ namespace Aggregator
 	void Core::SetProxy (ICoreProxy_ptr proxy)
 	{
 		Proxy_ = proxy;
+		StorageBackendManager::Instance ().SetTagsManager (proxy->GetTagsManager ());
 	}
 
 	ICoreProxy_ptr Core::GetProxy () const
@@ -127,11 +130,6 @@ namespace Aggregator
 		PluginManager_->AddPlugin (plugin);
 	}
 
-	Util::IDPool<IDType_t>& Core::GetPool (PoolType type)
-	{
-		return Pools_ [type];
-	}
-
 	bool Core::CouldHandle (const Entity& e)
 	{
 		if (!e.Entity_.canConvert<QUrl> () ||
@@ -295,14 +293,28 @@ namespace Aggregator
 							&Core::hookGotNewItems);
 				});
 
-		ParserFactory::Instance ().Register (&RSS20Parser::Instance ());
-		ParserFactory::Instance ().Register (&Atom10Parser::Instance ());
-		ParserFactory::Instance ().Register (&RSS091Parser::Instance ());
-		ParserFactory::Instance ().Register (&Atom03Parser::Instance ());
-		ParserFactory::Instance ().Register (&RSS10Parser::Instance ());
+		ParserFactory::Instance ().Register (&RSS20StreamParser::Instance ());
+		ParserFactory::Instance ().Register (&Atom10StreamParser::Instance ());
+		ParserFactory::Instance ().Register (&RSS091StreamParser::Instance ());
+		ParserFactory::Instance ().Register (&Atom03StreamParser::Instance ());
+		ParserFactory::Instance ().Register (&RSS10StreamParser::Instance ());
 
 		JobHolderRepresentation_->setSourceModel (ChannelsModel_);
 
+		UpdateScheduler_ = new FeedUpdateScheduler (Proxy_->GetNetworkAccessManager (), this);
+		connect (UpdateScheduler_,
+				&FeedUpdateScheduler::feedFetched,
+				this,
+				&Core::handleFeedFetched);
+		connect (UpdateScheduler_,
+				&FeedUpdateScheduler::feedFetchFailed,
+				this,
+				&Core::handleFeedFetchFailed);
+		connect (&StorageBackendManager::Instance (),
+				&StorageBackendManager::feedRemoved,
+				UpdateScheduler_,
+				&FeedUpdateScheduler::Forget);
+
 		CustomUpdateTimer_ = new QTimer (this);
 		CustomUpdateTimer_->start (60 * 1000);
 		connect (CustomUpdateTimer_,
@@ -315,7 +327,7 @@ namespace Aggregator
 		connect (UpdateTimer_,
 				&QTimer::timeout,
 				this,
-				&Core::updateFeeds);
+				&Core::handlePeriodicUpdate);
 
 		auto now = QDateTime::currentDateTime ();
 		auto lastUpdated = XmlSettingsManager::Instance ()->Property ("LastUpdateDateTime", now).toDateTime ();
@@ -326,7 +338,7 @@ namespace Aggregator
 					updateDiff > interval * 60)
 				QTimer::singleShot (7000,
 						this,
-						SLOT (updateFeeds ()));
+						SLOT (handlePeriodicUpdate ()));
 			else
 				UpdateTimer_->start (updateDiff * 1000);
 		}
@@ -359,13 +371,7 @@ namespace Aggregator
 		if (!result)
 			return false;
 
-		Pools_.clear ();
-		for (int type = 0; type < PTMAX; ++type)
-		{
-			Util::IDPool<IDType_t> pool;
-			pool.SetID (StorageBackend_->GetHighestID (static_cast<PoolType> (type)) + 1);
-			Pools_ [static_cast<PoolType> (type)] = pool;
-		}
+		PoolsManager::Instance ().ReloadPools (*StorageBackend_);
 
 		return true;
 	}
@@ -450,6 +456,11 @@ namespace Aggregator
 		return Proxy_->GetPluginsManager ()->GetAllCastableTo<IWebBrowser*> ().value (0);
 	}
 
+	QFuture<QList<StorageBackend::ItemSearchResult>> Core::SearchItems (const StorageBackend::ItemSearchParams& params)
+	{
+		return DBUpThread_->ScheduleImpl (&DBUpdateThreadWorker::SearchItems, params);
+	}
+
 	void Core::MarkChannelAsRead (const QModelIndex& i)
 	{
 		MarkChannel (i, false);
@@ -557,6 +568,7 @@ namespace Aggregator
 					false);
 			return;
 		}
+		UpdateScheduler_->ResetBackoff (channel.FeedID_);
 		UpdateFeed (channel.FeedID_);
 	}
 
@@ -783,64 +795,80 @@ namespace Aggregator
 			return;
 		}
 
-		channels_container_t channels;
-		if (pj.Role_ != PendingJob::RFeedExternalData)
+		if (pj.Role_ == PendingJob::RFeedExternalData)
+			HandleExternalData (pj.URL_, file);
+		else
+			HandleFeedDocument (pj, file,
+					[&file] { file.copy (QDir::tempPath () + "/failedFile.xml"); });
+	}
+
+	bool Core::HandleFeedDocument (const PendingJob& pj,
+			QIODevice& device, const std::function<void ()>& saveFailed)
+	{
+		QXmlStreamReader reader (&device);
+		const auto reportParseError = [&]
 		{
-			QByteArray data = file.readAll ();
-			QDomDocument doc;
-			QString errorMsg;
-			int errorLine, errorColumn;
-			if (!doc.setContent (data, true, &errorMsg, &errorLine, &errorColumn))
-			{
-				file.copy (QDir::tempPath () + "/failedFile.xml");
-				ErrorNotification (tr ("Feed error"),
-						tr ("XML file parse error: %1, line %2, column %3, filename %4, from %5")
-						.arg (errorMsg)
-						.arg (errorLine)
-						.arg (errorColumn)
-						.arg (pj.Filename_)
-						.arg (pj.URL_));
-				return;
-			}
+			saveFailed ();
+			ErrorNotification (tr ("Feed error"),
+					tr ("XML file parse error: %1, line %2, column %3, filename %4, from %5")
+					.arg (reader.errorString ())
+					.arg (reader.lineNumber ())
+					.arg (reader.columnNumber ())
+					.arg (pj.Filename_)
+					.arg (pj.URL_));
+		};
 
-			Parser *parser = ParserFactory::Instance ().Return (doc);
-			if (!parser)
-			{
-				file.copy (QDir::tempPath () + "/failedFile.xml");
-				ErrorNotification (tr ("Feed error"),
-						tr ("Could not find parser to parse file %1 from %2")
-						.arg (pj.Filename_)
-						.arg (pj.URL_));
-				return;
-			}
+		if (!StreamParser::ReadToRoot (reader))
+		{
+			reportParseError ();
+			return false;
+		}
 
-			IDType_t feedId = IDNotFound;
-			if (pj.Role_ == PendingJob::RFeedAdded)
-			{
-				Feed feed;
-				feed.URL_ = pj.URL_;
-				StorageBackend_->AddFeed (feed);
-				feedId = feed.FeedID_;
-			}
-			else
-				feedId = StorageBackend_->FindFeed (pj.URL_);
+		const auto parser = ParserFactory::Instance ().ReturnStream (reader);
+		if (!parser)
+		{
+			saveFailed ();
+			ErrorNotification (tr ("Feed error"),
+					tr ("Could not find parser to parse file %1 from %2")
+					.arg (pj.Filename_)
+					.arg (pj.URL_));
+			return false;
+		}
 
-			if (feedId == IDNotFound)
-			{
-				ErrorNotification (tr ("Feed error"),
-						tr ("Feed with url %1 not found.").arg (pj.URL_));
-				return;
-			}
+		boost::optional<Feed> newFeed;
+		IDType_t feedId = IDNotFound;
+		if (pj.Role_ == PendingJob::RFeedAdded)
+		{
+			newFeed = Feed {};
+			newFeed->URL_ = pj.URL_;
+			feedId = newFeed->FeedID_;
+		}
+		else
+			feedId = StorageBackend_->FindFeed (pj.URL_);
 
-			channels = parser->ParseFeed (doc, feedId);
+		if (feedId == IDNotFound)
+		{
+			ErrorNotification (tr ("Feed error"),
+					tr ("Feed with url %1 not found.").arg (pj.URL_));
+			return false;
 		}
 
+		const auto& channels = parser->ParseFeed (reader, feedId);
+		if (reader.hasError ())
+		{
+			reportParseError ();
+			return false;
+		}
+
+		if (newFeed)
+			StorageBackend_->AddFeed (*newFeed);
+
 		if (pj.Role_ == PendingJob::RFeedAdded)
 			HandleFeedAdded (channels, pj);
 		else if (pj.Role_ == PendingJob::RFeedUpdated)
 			HandleFeedUpdated (channels, pj);
-		else if (pj.Role_ == PendingJob::RFeedExternalData)
-			HandleExternalData (pj.URL_, file);
+
+		return true;
 	}
 
 	void Core::handleJobRemoved (int id)
@@ -895,6 +923,11 @@ namespace Aggregator
 	}
 
 	void Core::updateFeeds ()
+	{
+		UpdateFeeds (UpdateOrigin::User);
+	}
+
+	void Core::UpdateFeeds (UpdateOrigin origin)
 	{
 		for (const auto id : StorageBackend_->GetFeedsIDs ())
 		{
@@ -902,6 +935,14 @@ namespace Aggregator
 			if (StorageBackend_->GetFeedSettings (id).value_or (Feed::FeedSettings {}).UpdateTimeout_)
 				continue;
 
+			// Only the periodic updates respect the increased intervals
+			// of the unchanged feeds, the user asking to update is a
+			// good reason to check them right now.
+			if (origin == UpdateOrigin::User)
+				UpdateScheduler_->ResetBackoff (id);
+			else if (!UpdateScheduler_->ShouldUpdate (id))
+				continue;
+
 			UpdateFeed (id);
 		}
 		XmlSettingsManager::Instance ()->setProperty ("LastUpdateDateTime", QDateTime::currentDateTime ());
@@ -980,85 +1021,59 @@ namespace Aggregator
 		}
 	}
 
-	void Core::rotateUpdatesQueue ()
+	void Core::handlePeriodicUpdate ()
 	{
-		if (UpdatesQueue_.isEmpty ())
-			return;
-
-		const IDType_t id = UpdatesQueue_.takeFirst ();
-
-		if (!UpdatesQueue_.isEmpty ())
-			QTimer::singleShot (2000,
-					this,
-					SLOT (rotateUpdatesQueue ()));
-
-		const auto& maybeFeed = StorageBackend_->GetFeed (id);
-		if (!maybeFeed)
-		{
-			qWarning () << Q_FUNC_INFO
-					<< "no feed for id"
-					<< id;
-			return;
-		}
-
-		const auto& url = maybeFeed->URL_;
-		for (const auto& pair : Util::Stlize (PendingJobs_))
-			if (pair.second.URL_ == url)
-			{
-				const auto id = pair.first;
-				QObject *provider = ID2Downloader_ [id];
-				IDownload *downloader = qobject_cast<IDownload*> (provider);
-				if (downloader)
-				{
-					qWarning () << Q_FUNC_INFO
-						<< "stalled task detected from"
-						<< downloader
-						<< "trying to kill...";
-
-					downloader->KillTask (id);
-					ID2Downloader_.remove (id);
-					qWarning () << Q_FUNC_INFO
-						<< "killed!";
-				}
-				else
-					qWarning () << Q_FUNC_INFO
-						<< "provider is not a downloader:"
-						<< provider
-						<< "; cannot kill the task";
-			}
-		PendingJobs_.clear ();
-
-		QString filename = Util::GetTemporaryName ();
+		UpdateFeeds (UpdateOrigin::Timer);
+	}
 
-		Entity e = Util::MakeEntity (QUrl (url),
-				filename,
-				Internal |
-					DoNotNotifyUser |
-					DoNotSaveInHistory |
-					NotPersistent |
-					DoNotAnnounceEntity);
+	void Core::handleFeedFetched (IDType_t feedId, const QString& url, const QByteArray& data)
+	{
+		QBuffer buffer;
+		buffer.setData (data);
+		buffer.open (QIODevice::ReadOnly);
 
-		PendingJob pj =
+		const auto& failedPath = QDir::tempPath () + "/failedFile.xml";
+		const PendingJob pj
 		{
 			PendingJob::RFeedUpdated,
 			url,
-			filename,
+			failedPath,
 			{},
 			{}
 		};
+		const auto parsed = HandleFeedDocument (pj, buffer,
+				[&failedPath, &data]
+				{
+					QFile file (failedPath);
+					if (file.open (QIODevice::WriteOnly))
+						file.write (data);
+				});
+		if (parsed)
+			UpdateScheduler_->CommitBody (feedId);
+	}
 
-		const auto& delegateResult = Proxy_->GetEntityManager ()->DelegateEntity (e);
-		if (!delegateResult)
-		{
-			ErrorNotification ("Aggregator",
-					tr ("Could not find plugin for feed with URL %1")
-						.arg (url));
+	void Core::handleFeedFetchFailed (IDType_t, const QString& url, QNetworkReply::NetworkError error)
+	{
+		if (XmlSettingsManager::Instance ()->property ("BeSilent").toBool ())
 			return;
-		}
 
-		HandleProvider (delegateResult.Handler_, delegateResult.ID_);
-		PendingJobs_ [delegateResult.ID_] = pj;
-		Updates_ [id] = QDateTime::currentDateTime ();
+		QString msg;
+		switch (error)
+		{
+			case QNetworkReply::HostNotFoundError:
+			case QNetworkReply::ContentNotFoundError:
+				msg = tr ("Address not found:<br />%1");
+				break;
+			case QNetworkReply::ContentAccessDenied:
+			case QNetworkReply::AuthenticationRequiredError:
+				msg = tr ("Access denied:<br />%1");
+				break;
+			default:
+				msg = tr ("Unknown error for:<br />%1");
+				break;
+		}
+		ErrorNotification (tr ("Download error"),
+				msg.arg (url));
 	}
 
 	void Core::FetchPixmap (const Channel& channel)
@@ -1184,12 +1199,17 @@ namespace Aggregator
 
 	void Core::UpdateFeed (const IDType_t& id)
 	{
-		if (UpdatesQueue_.isEmpty ())
-			QTimer::singleShot (500,
-					this,
-					SLOT (rotateUpdatesQueue ()));
+		const auto& maybeFeed = StorageBackend_->GetFeed (id);
+		if (!maybeFeed)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "no feed for id"
+					<< id;
+			return;
+		}
 
-		UpdatesQueue_ << id;
+		UpdateScheduler_->Enqueue (id, QUrl { maybeFeed->URL_ });
+		Updates_ [id] = QDateTime::currentDateTime ();
 	}
 
 	void Core::HandleProvider (QObject *provider, int id)
@@ -30,16 +30,18 @@
 #pragma once
 
 #include <memory>
+#include <functional>
 #include <QAbstractItemModel>
 #include <QString>
 #include <QMap>
 #include <QPair>
 #include <QList>
 #include <QDateTime>
+#include <QFuture>
+#include <QNetworkReply>
 #include <interfaces/idownload.h>
 #include <interfaces/core/icoreproxy.h>
 #include <interfaces/core/ihookproxy.h>
-#include <util/idpool.h>
 #include "item.h"
 #include "channel.h"
 #include "feed.h"
@@ -47,7 +49,6 @@
 #include "dbupdatethreadfwd.h"
 
 class QTimer;
-class QNetworkReply;
 class QFile;
 class QSortFilterProxyModel;
 class QToolBar;
@@ -66,6 +67,7 @@ namespace Aggregator
 	class JobHolderRepresentation;
 	class ChannelsFilterModel;
 	class PluginManager;
+	class FeedUpdateScheduler;
 
 	class Core : public QObject
 	{
@@ -119,7 +121,7 @@ namespace Aggregator
 		ICoreProxy_ptr Proxy_;
 		bool Initialized_ = false;
 
-		QList<IDType_t> UpdatesQueue_;
+		FeedUpdateScheduler *UpdateScheduler_ = nullptr;
 
 		PluginManager *PluginManager_ = nullptr;
 
@@ -128,8 +130,6 @@ namespace Aggregator
 		Util::ShortcutManager *ShortcutMgr_ = nullptr;
 
 		Core ();
-	private:
-		QHash<PoolType, Util::IDPool<IDType_t>> Pools_;
 	public:
 		struct ChannelInfo
 		{
@@ -150,8 +150,6 @@ namespace Aggregator
 
 		void AddPlugin (QObject*);
 
-		Util::IDPool<IDType_t>& GetPool (PoolType);
-
 		bool CouldHandle (const LeechCraft::Entity&);
 		void Handle (LeechCraft::Entity);
 		void StartAddingOPML (const QString&);
@@ -178,6 +176,12 @@ namespace Aggregator
 			*/
 		QSortFilterProxyModel* GetChannelsModel () const;
 		IWebBrowser* GetWebBrowser () const;
+
+		/** Performs the items search in the storage thread.
+			*
+			* @sa StorageBackend::SearchItems()
+			*/
+		QFuture<QList<StorageBackend::ItemSearchResult>> SearchItems (const StorageBackend::ItemSearchParams&);
 		void MarkChannelAsRead (const QModelIndex&);
 		void MarkChannelAsUnread (const QModelIndex&);
 
@@ -221,17 +225,27 @@ namespace Aggregator
 		void handleJobRemoved (int);
 		void handleJobError (int, IDownload::Error);
 		void handleCustomUpdates ();
-		void rotateUpdatesQueue ();
+		void handlePeriodicUpdate ();
+		void handleFeedFetched (IDType_t, const QString&, const QByteArray&);
+		void handleFeedFetchFailed (IDType_t, const QString&, QNetworkReply::NetworkError);
 	private:
 		void FetchPixmap (const Channel&);
 		void FetchFavicon (const Channel&);
 		void HandleExternalData (const QString&, const QFile&);
+		bool HandleFeedDocument (const PendingJob&, QIODevice&, const std::function<void ()>&);
 		void HandleFeedAdded (const channels_container_t&,
 				const PendingJob&);
 		void HandleFeedUpdated (const channels_container_t&,
 				const PendingJob&);
 		void MarkChannel (const QModelIndex&, bool);
 		void UpdateFeed (const IDType_t&);
+
+		enum class UpdateOrigin
+		{
+			User,
+			Timer
+		};
+		void UpdateFeeds (UpdateOrigin);
 		void HandleProvider (QObject*, int);
 		void ErrorNotification (const QString&, const QString&, bool = true) const;
 	signals:
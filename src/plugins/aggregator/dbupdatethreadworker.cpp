@@ -34,10 +34,10 @@
 #include <QtDebug>
 #include <util/xpc/util.h>
 #include <util/xpc/defaulthookproxy.h>
-#include <util/sll/lazy.h>
 #include <interfaces/core/ientitymanager.h>
 #include "xmlsettingsmanager.h"
 #include "storagebackend.h"
+#include "itemsmerge.h"
 
 namespace LeechCraft
 {
@@ -107,19 +107,8 @@ namespace Aggregator
 		Proxy_->GetEntityManager ()->HandleEntity (Util::MakeNotification ("Aggregator", str, Priority::Info));
 	}
 
-	bool DBUpdateThreadWorker::AddItem (Item& item, const Channel& channel, const Feed::FeedSettings& settings)
+	void DBUpdateThreadWorker::HandleNewItem (const Item& item, const Channel& channel, const Feed::FeedSettings& settings)
 	{
-		if (item.PubDate_.isValid ())
-		{
-			if (item.PubDate_.daysTo (QDateTime::currentDateTime ()) >= settings.ItemAge_)
-				return false;
-		}
-		else
-			item.FixDate ();
-
-		item.ChannelID_ = channel.ChannelID_;
-		SB_->AddItem (item);
-
 		emit hookGotNewItems (std::make_shared<Util::DefaultHookProxy> (), { item });
 
 		const auto iem = Proxy_->GetEntityManager ();
@@ -133,40 +122,20 @@ namespace Aggregator
 				de.Additional_ [" Tags"] = channel.Tags_;
 				iem->HandleEntity (de);
 			}
-
-		return true;
 	}
 
-	bool DBUpdateThreadWorker::UpdateItem (const Item& item, Item ourItem)
+	void DBUpdateThreadWorker::UpdateChannel (const Channel_ptr& channel,
+			const Channel& ourChannel, const Feed::FeedSettings& settings)
 	{
-		if (!IsModified (ourItem, item))
-			return false;
-
-		ourItem.Description_ = item.Description_;
-		ourItem.Categories_ = item.Categories_;
-		ourItem.NumComments_ = item.NumComments_;
-		ourItem.CommentsLink_ = item.CommentsLink_;
-		ourItem.CommentsPageLink_ = item.CommentsPageLink_;
-		ourItem.Latitude_ = item.Latitude_;
-		ourItem.Longitude_ = item.Longitude_;
+		const auto& merge = PrepareItemsMerge (*SB_, *channel, ourChannel, settings);
 
-		for (auto enc : item.Enclosures_)
-			if (!ourItem.Enclosures_.contains (enc))
-			{
-				enc.ItemID_ = ourItem.ItemID_;
-				ourItem.Enclosures_ << enc;
-			}
-
-		for (auto entry : item.MRSSEntries_)
-			if (!ourItem.MRSSEntries_.contains (entry))
-			{
-				entry.ItemID_ = ourItem.ItemID_;
-				ourItem.MRSSEntries_ << entry;
-			}
+		if (!SB_->MergeItems (merge))
+			return;
 
-		SB_->UpdateItem (ourItem);
+		for (const auto& item : merge.Added_)
+			HandleNewItem (item, ourChannel, settings);
 
-		return true;
+		NotifyUpdates (merge.Added_.size (), merge.Updated_.size (), channel);
 	}
 
 	void DBUpdateThreadWorker::NotifyUpdates (int newItems, int updatedItems, const Channel_ptr& channel)
@@ -195,6 +164,11 @@ namespace Aggregator
 		Proxy_->GetEntityManager ()->HandleEntity (Util::MakeNotification ("Aggregator", str, Priority::Info));
 	}
 
+	QList<StorageBackend::ItemSearchResult> DBUpdateThreadWorker::SearchItems (const StorageBackend::ItemSearchParams& params)
+	{
+		return SB_->SearchItems (params);
+	}
+
 	void DBUpdateThreadWorker::toggleChannelUnread (IDType_t channel, bool state)
 	{
 		SB_->ToggleChannelUnread (channel, state);
@@ -213,8 +187,6 @@ namespace Aggregator
 		}
 
 		const auto& feedSettings = GetFeedSettings (feedId);
-		const auto ipc = feedSettings.NumItems_;
-		const auto days = feedSettings.ItemAge_;
 
 		for (const auto& channel : channels)
 		{
@@ -226,40 +198,7 @@ namespace Aggregator
 				continue;
 			}
 
-			const auto& ourChannel = *maybeOurChannel;
-
-			int newItems = 0;
-			int updatedItems = 0;
-
-			for (const auto& itemPtr : channel->Items_)
-			{
-				auto& item = *itemPtr;
-
-				auto mkLazy = [] (auto&& f) { return Util::MakeLazyF<boost::optional<IDType_t>> (f); };
-				const auto& ourItemID = Util::Msum ({
-							mkLazy ([&] { return SB_->FindItem (item.Title_, item.Link_, ourChannel.ChannelID_); }),
-							mkLazy ([&] { return SB_->FindItemByLink (item.Link_, ourChannel.ChannelID_); }),
-							mkLazy ([&]
-									{
-										if (!item.Link_.isEmpty ())
-											return boost::optional<IDType_t> {};
-
-										return SB_->FindItemByTitle (item.Title_, ourChannel.ChannelID_);
-									})
-						}) ();
-				if (ourItemID)
-				{
-					if (const auto& ourItem = SB_->GetItem (*ourItemID);
-						ourItem && UpdateItem (item, *ourItem))
-						++updatedItems;
-				}
-				else if (AddItem (item, ourChannel, feedSettings))
-					++newItems;
-			}
-
-			SB_->TrimChannel (ourChannel.ChannelID_, days, ipc);
-
-			NotifyUpdates (newItems, updatedItems, channel);
+			UpdateChannel (channel, *maybeOurChannel, feedSettings);
 		}
 	}
 }
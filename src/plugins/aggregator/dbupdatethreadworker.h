@@ -38,13 +38,12 @@
 #include "common.h"
 #include "channel.h"
 #include "feed.h"
+#include "storagebackend.h"
 
 namespace LeechCraft
 {
 namespace Aggregator
 {
-	class StorageBackend;
-
 	class DBUpdateThreadWorker : public QObject
 	{
 		Q_OBJECT
@@ -55,11 +54,13 @@ namespace Aggregator
 		DBUpdateThreadWorker (const ICoreProxy_ptr&, QObject* = nullptr);
 
 		void WithWorker (const std::function<void (DBUpdateThreadWorker*)>&);
+
+		QList<StorageBackend::ItemSearchResult> SearchItems (const StorageBackend::ItemSearchParams&);
 	private:
 		Feed::FeedSettings GetFeedSettings (IDType_t);
 		void AddChannel (const Channel& channel, const Feed::FeedSettings& settings);
-		bool AddItem (Item& item, const Channel& channel, const Feed::FeedSettings& settings);
-		bool UpdateItem (const Item& item, Item ourItem);
+		void HandleNewItem (const Item& item, const Channel& channel, const Feed::FeedSettings& settings);
+		void UpdateChannel (const Channel_ptr& channel, const Channel& ourChannel, const Feed::FeedSettings& settings);
 		void NotifyUpdates (int newItems, int updatedItems, const Channel_ptr& channel);
 	public slots:
 		void toggleChannelUnread (IDType_t channel, bool state);
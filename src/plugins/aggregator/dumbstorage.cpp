@@ -61,6 +61,15 @@ namespace Aggregator
 	{
 	}
 
+	boost::optional<StorageBackend::FeedValidators> DumbStorage::GetFeedValidators (const IDType_t&) const
+	{
+		return {};
+	}
+
+	void DumbStorage::SetFeedValidators (const FeedValidators&)
+	{
+	}
+
 	channels_shorts_t DumbStorage::GetChannels (const IDType_t&) const
 	{
 		return {};
@@ -85,6 +94,11 @@ namespace Aggregator
 		return {};
 	}
 
+	StorageBackend::ChannelItemsIndex DumbStorage::GetChannelItemsIndex (const IDType_t&) const
+	{
+		return {};
+	}
+
 	int DumbStorage::GetUnreadItems (const IDType_t&) const
 	{
 		return {};
@@ -143,6 +157,11 @@ namespace Aggregator
 	{
 	}
 
+	bool DumbStorage::MergeItems (const ItemsMerge&)
+	{
+		return false;
+	}
+
 	void DumbStorage::RemoveItems (const QSet<IDType_t>&)
 	{
 	}
@@ -188,6 +207,11 @@ namespace Aggregator
 		return {};
 	}
 
+	QList<StorageBackend::ItemSearchResult> DumbStorage::SearchItems (const ItemSearchParams&) const
+	{
+		return {};
+	}
+
 	IDType_t DumbStorage::GetHighestID (const PoolType&) const
 	{
 		return {};
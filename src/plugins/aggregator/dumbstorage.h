@@ -44,11 +44,14 @@ namespace Aggregator
 		IDType_t FindFeed (const QString&) const override;
 		boost::optional<Feed::FeedSettings> GetFeedSettings (const IDType_t&) const override;
 		void SetFeedSettings (const Feed::FeedSettings&) override;
+		boost::optional<FeedValidators> GetFeedValidators (const IDType_t&) const override;
+		void SetFeedValidators (const FeedValidators&) override;
 		channels_shorts_t GetChannels (const IDType_t&) const override;
 		boost::optional<Channel> GetChannel (const IDType_t&) const override;
 		IDType_t FindChannel (const QString&, const QString&, const IDType_t&) const override;
 		void TrimChannel (const IDType_t&, int, int) override;
 		items_shorts_t GetItems (const IDType_t&) const override;
+		ChannelItemsIndex GetChannelItemsIndex (const IDType_t&) const override;
 		int GetUnreadItems (const IDType_t&) const override;
 		boost::optional<Item> GetItem (const IDType_t&) const override;
 		boost::optional<IDType_t> FindItem (const QString&, const QString&, const IDType_t&) const override;
@@ -62,6 +65,7 @@ namespace Aggregator
 		void UpdateChannel (const ChannelShort&) override;
 		void UpdateItem (const Item&) override;
 		void UpdateItem (const ItemShort&) override;
+		bool MergeItems (const ItemsMerge&) override;
 		void RemoveItems (const QSet<IDType_t>&) override;
 		void RemoveChannel (const IDType_t&) override;
 		void RemoveFeed (const IDType_t&) override;
@@ -72,6 +76,7 @@ namespace Aggregator
 		QList<ITagsManager::tag_id> GetItemTags (const IDType_t&) override;
 		void SetItemTags (const IDType_t&, const QList<ITagsManager::tag_id>&) override;
 		QList<IDType_t> GetItemsForTag (const ITagsManager::tag_id&) override;
+		QList<ItemSearchResult> SearchItems (const ItemSearchParams&) const override;
 		IDType_t GetHighestID (const PoolType&) const override;
 	};
 }
@@ -0,0 +1,264 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "feedelements.h"
+#include <algorithm>
+#include <iterator>
+#include <QXmlStreamReader>
+
+namespace LeechCraft
+{
+namespace Aggregator
+{
+	FeedElements FeedElements::Read (QXmlStreamReader& reader)
+	{
+		FeedElements result;
+		result.ReadChildren (reader, result.Open (reader, -1));
+		return result;
+	}
+
+	FeedElements FeedElements::ReadRoot (QXmlStreamReader& reader)
+	{
+		FeedElements result;
+		result.Close (result.Open (reader, -1));
+		return result;
+	}
+
+	int FeedElements::Append (QXmlStreamReader& reader)
+	{
+		const auto elem = Open (reader, 0);
+		ReadChildren (reader, elem);
+		Close (0);
+		return elem;
+	}
+
+	bool FeedElements::IsEmpty () const
+	{
+		return Elements_.isEmpty ();
+	}
+
+	const QString& FeedElements::Name (int elem) const
+	{
+		static const QString empty;
+		return IsValid (elem) ? Elements_.at (elem).Name_ : empty;
+	}
+
+	const QString& FeedElements::NS (int elem) const
+	{
+		static const QString empty;
+		return IsValid (elem) ? Elements_.at (elem).NS_ : empty;
+	}
+
+	int FeedElements::Parent (int elem) const
+	{
+		return IsValid (elem) ? Elements_.at (elem).Parent_ : -1;
+	}
+
+	QString FeedElements::Text (int elem) const
+	{
+		if (!IsValid (elem))
+			return {};
+
+		const auto& element = Elements_.at (elem);
+		switch (element.EndChunk_ - element.FirstChunk_)
+		{
+		case 0:
+			return {};
+		case 1:
+			return Chunks_.at (element.FirstChunk_);
+		default:
+			break;
+		}
+
+		QString result;
+		for (int i = element.FirstChunk_; i < element.EndChunk_; ++i)
+			result += Chunks_.at (i);
+		return result;
+	}
+
+	bool FeedElements::HasAttribute (int elem, const QString& name) const
+	{
+		if (!IsValid (elem))
+			return false;
+
+		const auto& attrs = Elements_.at (elem).Attrs_;
+		return std::any_of (attrs.begin (), attrs.end (),
+				[&name] (const QXmlStreamAttribute& attr) { return attr.name () == name; });
+	}
+
+	QString FeedElements::Attribute (int elem, const QString& name, const QString& def) const
+	{
+		if (!IsValid (elem))
+			return def;
+
+		for (const auto& attr : Elements_.at (elem).Attrs_)
+			if (attr.name () == name)
+				return attr.value ().toString ();
+		return def;
+	}
+
+	QString FeedElements::AttributeNS (int elem,
+			const QString& ns, const QString& name, const QString& def) const
+	{
+		if (!IsValid (elem))
+			return def;
+
+		for (const auto& attr : Elements_.at (elem).Attrs_)
+			if (attr.name () == name && attr.namespaceUri () == ns)
+				return attr.value ().toString ();
+		return def;
+	}
+
+	int FeedElements::FirstChild (int elem, const QString& name) const
+	{
+		for (const auto child : ByTagName (elem, name))
+			if (Elements_.at (child).Parent_ == elem)
+				return child;
+		return -1;
+	}
+
+	QVector<int> FeedElements::Children (int elem, const QString& name) const
+	{
+		auto result = ByTagName (elem, name);
+		result.erase (std::remove_if (result.begin (), result.end (),
+					[this, elem] (int child) { return Elements_.at (child).Parent_ != elem; }),
+				result.end ());
+		return result;
+	}
+
+	QVector<int> FeedElements::ChildrenNS (int elem, const QString& ns, const QString& name) const
+	{
+		auto result = ByTagNameNS (elem, ns, name);
+		result.erase (std::remove_if (result.begin (), result.end (),
+					[this, elem] (int child) { return Elements_.at (child).Parent_ != elem; }),
+				result.end ());
+		return result;
+	}
+
+	QVector<int> FeedElements::ByTagName (int elem, const QString& name) const
+	{
+		return FilterDescendants (elem, ByName_.value (name));
+	}
+
+	QVector<int> FeedElements::ByTagNameNS (int elem, const QString& ns, const QString& name) const
+	{
+		return FilterDescendants (elem, ByNSName_.value ({ ns, name }));
+	}
+
+	int FeedElements::FirstByTagNameNS (int elem, const QString& ns, const QString& name) const
+	{
+		if (!IsValid (elem))
+			return -1;
+
+		const auto pos = ByNSName_.find ({ ns, name });
+		if (pos == ByNSName_.end ())
+			return -1;
+
+		const auto& indexes = *pos;
+		const auto it = std::upper_bound (indexes.begin (), indexes.end (), elem);
+		if (it == indexes.end () || *it >= Elements_.at (elem).End_)
+			return -1;
+		return *it;
+	}
+
+	bool FeedElements::IsValid (int elem) const
+	{
+		return elem >= 0 && elem < Elements_.size ();
+	}
+
+	int FeedElements::Open (QXmlStreamReader& reader, int parent)
+	{
+		const auto idx = Elements_.size ();
+
+		const auto& ns = reader.namespaceUri ().toString ();
+		const auto& name = reader.name ().toString ();
+		Elements_.append ({
+				ns,
+				name,
+				reader.attributes (),
+				parent,
+				idx + 1,
+				Chunks_.size (),
+				Chunks_.size ()
+			});
+
+		ByName_ [name] << idx;
+		ByNSName_ [{ ns, name }] << idx;
+
+		return idx;
+	}
+
+	void FeedElements::Close (int elem)
+	{
+		auto& element = Elements_ [elem];
+		element.End_ = Elements_.size ();
+		element.EndChunk_ = Chunks_.size ();
+	}
+
+	void FeedElements::ReadChildren (QXmlStreamReader& reader, int elem)
+	{
+		QVector<int> stack { elem };
+		while (!reader.atEnd ())
+			switch (reader.readNext ())
+			{
+			case QXmlStreamReader::StartElement:
+				stack << Open (reader, stack.last ());
+				break;
+			case QXmlStreamReader::EndElement:
+				Close (stack.takeLast ());
+				if (stack.isEmpty ())
+					return;
+				break;
+			case QXmlStreamReader::Characters:
+				if (!reader.isWhitespace () || reader.isCDATA ())
+					Chunks_ << reader.text ().toString ();
+				break;
+			default:
+				break;
+			}
+
+		while (!stack.isEmpty ())
+			Close (stack.takeLast ());
+	}
+
+	QVector<int> FeedElements::FilterDescendants (int elem, const QVector<int>& indexes) const
+	{
+		if (!IsValid (elem) || indexes.isEmpty ())
+			return {};
+
+		const auto begin = std::upper_bound (indexes.begin (), indexes.end (), elem);
+		const auto end = std::lower_bound (begin, indexes.end (), Elements_.at (elem).End_);
+		QVector<int> result;
+		result.reserve (end - begin);
+		std::copy (begin, end, std::back_inserter (result));
+		return result;
+	}
+}
+}
@@ -0,0 +1,166 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QPair>
+#include <QXmlStreamAttributes>
+
+class QXmlStreamReader;
+
+namespace LeechCraft
+{
+namespace Aggregator
+{
+	/** @brief A compact read-only snapshot of an XML subtree.
+	 *
+	 * The elements are stored in a flat array in document order, so the
+	 * descendants of any element form a contiguous range right after it.
+	 * Additionally, the elements are indexed by their local name and by
+	 * their namespace and local name pair, so that the lookups the DOM
+	 * parsers perform via <code>elementsByTagName()</code> and
+	 * <code>elementsByTagNameNS()</code> are hash lookups instead of tree
+	 * walks.
+	 *
+	 * Name matching follows the QDom conventions the DOM parsers rely
+	 * on: non-namespaced lookups and attribute lookups compare local
+	 * names, and whitespace-only text nodes are dropped.
+	 *
+	 * Elements are identified by their indexes, with 0 being the root.
+	 * Negative indexes denote null elements: all the accessors accept
+	 * them and return empty values.
+	 */
+	class FeedElements
+	{
+		struct Element
+		{
+			QString NS_;
+			QString Name_;
+			QXmlStreamAttributes Attrs_;
+			int Parent_;
+			int End_;
+			int FirstChunk_;
+			int EndChunk_;
+		};
+
+		QVector<Element> Elements_;
+		QStringList Chunks_;
+
+		QHash<QString, QVector<int>> ByName_;
+		QHash<QPair<QString, QString>, QVector<int>> ByNSName_;
+	public:
+		/** @brief Reads the element the reader is positioned at.
+		 *
+		 * The reader is expected to be at a StartElement token. After
+		 * this function returns, the reader is at the matching
+		 * EndElement token, unless an error occurred.
+		 *
+		 * @param[in] reader The XML stream reader.
+		 * @return The element with all its descendants.
+		 */
+		static FeedElements Read (QXmlStreamReader& reader);
+
+		/** @brief Creates a tree consisting of the current element alone.
+		 *
+		 * Only the name and the attributes of the element the reader is
+		 * positioned at are stored, and the reader is not advanced. The
+		 * children could be added later via Append().
+		 *
+		 * @param[in] reader The XML stream reader.
+		 * @return The tree with just the root element.
+		 */
+		static FeedElements ReadRoot (QXmlStreamReader& reader);
+
+		/** @brief Appends the current element as the last root child.
+		 *
+		 * The semantics regarding the reader are the same as in Read().
+		 *
+		 * @param[in] reader The XML stream reader.
+		 * @return The index of the appended element.
+		 */
+		int Append (QXmlStreamReader& reader);
+
+		bool IsEmpty () const;
+
+		const QString& Name (int elem) const;
+		const QString& NS (int elem) const;
+		int Parent (int elem) const;
+
+		/** @brief Returns the concatenated text of the element.
+		 *
+		 * This mirrors <code>QDomElement::text()</code>.
+		 */
+		QString Text (int elem) const;
+
+		bool HasAttribute (int elem, const QString& name) const;
+		QString Attribute (int elem, const QString& name, const QString& def = {}) const;
+		QString AttributeNS (int elem, const QString& ns, const QString& name, const QString& def = {}) const;
+
+		/** @brief Returns the first child element with the given name or
+		 * -1 if there is no such element.
+		 */
+		int FirstChild (int elem, const QString& name) const;
+
+		/** @brief Returns the child elements with the given name.
+		 */
+		QVector<int> Children (int elem, const QString& name) const;
+
+		/** @brief Returns the child elements with the given namespace and
+		 * name.
+		 */
+		QVector<int> ChildrenNS (int elem, const QString& ns, const QString& name) const;
+
+		/** @brief Returns the descendants of the element with the given
+		 * local name, in document order.
+		 */
+		QVector<int> ByTagName (int elem, const QString& name) const;
+
+		/** @brief Returns the descendants of the element with the given
+		 * namespace and local name, in document order.
+		 */
+		QVector<int> ByTagNameNS (int elem, const QString& ns, const QString& name) const;
+
+		/** @brief Returns the first descendant with the given namespace
+		 * and local name or -1 if there is no such element.
+		 */
+		int FirstByTagNameNS (int elem, const QString& ns, const QString& name) const;
+	private:
+		bool IsValid (int) const;
+		int Open (QXmlStreamReader&, int);
+		void Close (int);
+		void ReadChildren (QXmlStreamReader&, int);
+		QVector<int> FilterDescendants (int, const QVector<int>&) const;
+	};
+}
+}
@@ -0,0 +1,326 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "feedupdatescheduler.h"
+#include <algorithm>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QCryptographicHash>
+#include <QtDebug>
+#include "xmlsettingsmanager.h"
+#include "storagebackendmanager.h"
+
+namespace LeechCraft
+{
+namespace Aggregator
+{
+	namespace
+	{
+		const int MaxBackoff = 3;
+
+		const int JitterStep = 250;
+		const int MaxJitter = 30 * 1000;
+
+		const int FetchTimeout = 2 * 60 * 1000;
+
+		int GetLimit (const char *prop)
+		{
+			return std::max (1, XmlSettingsManager::Instance ()->property (prop).toInt ());
+		}
+	}
+
+	FeedUpdateScheduler::FeedUpdateScheduler (QNetworkAccessManager *nam, QObject *parent)
+	: QObject { parent }
+	, NAM_ { nam }
+	, DispatchTimer_ { new QTimer { this } }
+	{
+		DispatchTimer_->setSingleShot (true);
+		connect (DispatchTimer_,
+				&QTimer::timeout,
+				this,
+				&FeedUpdateScheduler::Dispatch);
+	}
+
+	void FeedUpdateScheduler::Enqueue (IDType_t feedId, const QUrl& url)
+	{
+		if (InFlight_.contains (feedId) ||
+				std::any_of (Queue_.begin (), Queue_.end (),
+						[feedId] (const QueuedFeed& feed) { return feed.FeedID_ == feedId; }))
+			return;
+
+		const auto window = std::min (Queue_.size () * JitterStep, MaxJitter);
+		const auto delay = std::uniform_int_distribution<int> { 0, window } (PRG_);
+		Queue_.append ({ feedId, url, QDateTime::currentDateTime ().addMSecs (delay) });
+
+		if (!DispatchTimer_->isActive () || DispatchTimer_->remainingTime () > delay)
+			DispatchTimer_->start (delay);
+	}
+
+	bool FeedUpdateScheduler::ShouldUpdate (IDType_t feedId)
+	{
+		const auto pos = States_.find (feedId);
+		if (pos == States_.end () || !pos->SkipsLeft_)
+			return true;
+
+		--pos->SkipsLeft_;
+		return false;
+	}
+
+	void FeedUpdateScheduler::ResetBackoff (IDType_t feedId)
+	{
+		const auto pos = States_.find (feedId);
+		if (pos != States_.end ())
+			MarkChanged (*pos, true);
+	}
+
+	void FeedUpdateScheduler::CommitBody (IDType_t feedId)
+	{
+		const auto pos = States_.find (feedId);
+		if (pos == States_.end ())
+			return;
+
+		pos->Body_ = pos->PendingBody_;
+		SaveBody (feedId, pos->Body_);
+	}
+
+	void FeedUpdateScheduler::Forget (IDType_t feedId)
+	{
+		States_.remove (feedId);
+		Queue_.erase (std::remove_if (Queue_.begin (), Queue_.end (),
+					[feedId] (const QueuedFeed& feed) { return feed.FeedID_ == feedId; }),
+				Queue_.end ());
+
+		if (const auto reply = InFlight_.take (feedId))
+		{
+			const auto& host = reply->request ().url ().host ();
+			if (!--InFlightPerHost_ [host])
+				InFlightPerHost_.remove (host);
+
+			disconnect (reply, nullptr, this, nullptr);
+			reply->abort ();
+			reply->deleteLater ();
+
+			Dispatch ();
+		}
+	}
+
+	const FeedUpdateScheduler::Stats& FeedUpdateScheduler::GetStats () const
+	{
+		return Stats_;
+	}
+
+	FeedUpdateScheduler::FeedState& FeedUpdateScheduler::GetState (IDType_t feedId)
+	{
+		auto pos = States_.find (feedId);
+		if (pos != States_.end ())
+			return *pos;
+
+		FeedState state;
+		if (const auto& sb = StorageBackendManager::Instance ().MakeStorageBackendForThread ())
+			if (const auto& validators = sb->GetFeedValidators (feedId))
+				state.Body_ =
+				{
+					validators->ETag_,
+					validators->LastModified_,
+					validators->BodyHash_,
+					validators->BodySize_
+				};
+		return *States_.insert (feedId, state);
+	}
+
+	void FeedUpdateScheduler::SaveBody (IDType_t feedId, const BodyInfo& body)
+	{
+		if (const auto& sb = StorageBackendManager::Instance ().MakeStorageBackendForThread ())
+			sb->SetFeedValidators ({ feedId, body.ETag_, body.LastModified_, body.Hash_, body.Size_ });
+	}
+
+	void FeedUpdateScheduler::Dispatch ()
+	{
+		const auto maxTotal = GetLimit ("MaxParallelUpdates");
+		const auto maxPerHost = GetLimit ("MaxParallelUpdatesPerHost");
+
+		const auto& now = QDateTime::currentDateTime ();
+		QDateTime nextWakeup;
+
+		for (auto it = Queue_.begin (); it != Queue_.end () && InFlight_.size () < maxTotal; )
+		{
+			if (it->NotBefore_ > now)
+			{
+				if (!nextWakeup.isValid () || it->NotBefore_ < nextWakeup)
+					nextWakeup = it->NotBefore_;
+				++it;
+				continue;
+			}
+
+			if (InFlightPerHost_.value (it->URL_.host ()) >= maxPerHost)
+			{
+				++it;
+				continue;
+			}
+
+			const auto feed = *it;
+			it = Queue_.erase (it);
+			Start (feed);
+		}
+
+		if (nextWakeup.isValid ())
+			DispatchTimer_->start (std::max<qint64> (now.msecsTo (nextWakeup), 0));
+	}
+
+	void FeedUpdateScheduler::Start (const QueuedFeed& feed)
+	{
+		QNetworkRequest req { feed.URL_ };
+		req.setAttribute (QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+		req.setAttribute (QNetworkRequest::CacheSaveControlAttribute, false);
+		req.setAttribute (QNetworkRequest::FollowRedirectsAttribute, true);
+
+		const auto& body = GetState (feed.FeedID_).Body_;
+		if (!body.ETag_.isEmpty ())
+			req.setRawHeader ("If-None-Match", body.ETag_);
+		if (!body.LastModified_.isEmpty ())
+			req.setRawHeader ("If-Modified-Since", body.LastModified_);
+
+		const auto reply = NAM_->get (req);
+		InFlight_ [feed.FeedID_] = reply;
+		++InFlightPerHost_ [feed.URL_.host ()];
+
+		QElapsedTimer timer;
+		timer.start ();
+		connect (reply,
+				&QNetworkReply::finished,
+				this,
+				[=] { HandleFinished (feed, reply, timer.elapsed ()); });
+
+		QTimer::singleShot (FetchTimeout,
+				reply,
+				[reply, url = feed.URL_]
+				{
+					if (!reply->isRunning ())
+						return;
+
+					qWarning () << Q_FUNC_INFO
+							<< "fetching"
+							<< url
+							<< "timed out, aborting";
+					reply->abort ();
+				});
+	}
+
+	void FeedUpdateScheduler::HandleFinished (const QueuedFeed& feed, QNetworkReply *reply, qint64 latency)
+	{
+		reply->deleteLater ();
+
+		if (InFlight_.value (feed.FeedID_) != reply)
+			return;
+
+		InFlight_.remove (feed.FeedID_);
+		const auto& host = feed.URL_.host ();
+		if (!--InFlightPerHost_ [host])
+			InFlightPerHost_.remove (host);
+
+		++Stats_.Fetches_;
+		Stats_.TotalLatency_ += latency;
+		Stats_.MaxLatency_ = std::max (Stats_.MaxLatency_, latency);
+
+		const auto& url = feed.URL_.toString ();
+
+		const auto statePos = States_.find (feed.FeedID_);
+		if (statePos == States_.end ())
+		{
+			Dispatch ();
+			return;
+		}
+		auto& state = *statePos;
+
+		if (reply->error () != QNetworkReply::NoError)
+		{
+			++Stats_.Failures_;
+			qWarning () << Q_FUNC_INFO
+					<< "error fetching"
+					<< url
+					<< reply->error ()
+					<< reply->errorString ();
+			emit feedFetchFailed (feed.FeedID_, url, reply->error ());
+		}
+		else if (reply->attribute (QNetworkRequest::HttpStatusCodeAttribute).toInt () == 304)
+		{
+			++Stats_.NotModified_;
+
+			Stats_.BytesSaved_ += state.Body_.Size_;
+			MarkChanged (state, false);
+		}
+		else
+		{
+			const auto& data = reply->readAll ();
+			Stats_.BytesFetched_ += data.size ();
+
+			auto& pending = state.PendingBody_;
+			pending.ETag_ = reply->rawHeader ("ETag");
+			pending.LastModified_ = reply->rawHeader ("Last-Modified");
+			pending.Hash_ = QCryptographicHash::hash (data, QCryptographicHash::Md5);
+			pending.Size_ = data.size ();
+
+			const bool changed = pending.Hash_ != state.Body_.Hash_;
+			if (!changed)
+			{
+				const bool sameValidators = pending.ETag_ == state.Body_.ETag_ &&
+						pending.LastModified_ == state.Body_.LastModified_;
+				state.Body_ = pending;
+				if (!sameValidators)
+					SaveBody (feed.FeedID_, state.Body_);
+			}
+			MarkChanged (state, changed);
+
+			if (changed)
+				emit feedFetched (feed.FeedID_, url, data);
+			else
+				++Stats_.SameBody_;
+		}
+
+		Dispatch ();
+	}
+
+	void FeedUpdateScheduler::MarkChanged (FeedState& state, bool changed)
+	{
+		if (changed)
+		{
+			state.Backoff_ = 0;
+			state.SkipsLeft_ = 0;
+		}
+		else
+		{
+			state.Backoff_ = std::min (state.Backoff_ + 1, MaxBackoff);
+			state.SkipsLeft_ = (1 << state.Backoff_) - 1;
+		}
+	}
+}
+}
@@ -0,0 +1,202 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#pragma once
+
+#include <random>
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QUrl>
+#include <QDateTime>
+#include <QNetworkReply>
+#include "common.h"
+
+class QNetworkAccessManager;
+class QTimer;
+
+namespace LeechCraft
+{
+namespace Aggregator
+{
+	/** @brief Schedules and performs the network fetches of feed updates.
+	 *
+	 * The scheduler keeps a queue of feeds to be fetched and starts the
+	 * fetches respecting both the global limit on the number of
+	 * simultaneous requests and the per-host one. Feeds enqueued in bulk
+	 * are spread over time with a random jitter.
+	 *
+	 * For each feed the scheduler remembers the validators (ETag and
+	 * Last-Modified) of the last response and issues conditional
+	 * requests, so feeds that haven't changed are neither downloaded nor
+	 * parsed. Bodies identical to the previous one are also dropped.
+	 * The validators and the hash of a new body are only remembered
+	 * once the body has been parsed successfully, see CommitBody(), and
+	 * are kept in the storage along with the feed.
+	 *
+	 * Feeds that are found unchanged get their interval increased: they
+	 * are skipped on some of the following periodic updates, see
+	 * ShouldUpdate(). The interval is reset as soon as the feed changes
+	 * or the user explicitly asks to update it, see ResetBackoff().
+	 */
+	class FeedUpdateScheduler : public QObject
+	{
+		Q_OBJECT
+	public:
+		/** @brief Fetch statistics collected since the scheduler creation.
+		 */
+		struct Stats
+		{
+			int Fetches_ = 0;
+			int Failures_ = 0;
+			int NotModified_ = 0;
+			int SameBody_ = 0;
+			qint64 BytesFetched_ = 0;
+			qint64 BytesSaved_ = 0;
+			qint64 TotalLatency_ = 0;
+			qint64 MaxLatency_ = 0;
+		};
+	private:
+		QNetworkAccessManager * const NAM_;
+
+		QTimer * const DispatchTimer_;
+
+		struct QueuedFeed
+		{
+			IDType_t FeedID_;
+			QUrl URL_;
+			QDateTime NotBefore_;
+		};
+		QList<QueuedFeed> Queue_;
+
+		struct BodyInfo
+		{
+			QByteArray ETag_;
+			QByteArray LastModified_;
+			QByteArray Hash_;
+			qint64 Size_ = 0;
+		};
+
+		struct FeedState
+		{
+			BodyInfo Body_;
+			BodyInfo PendingBody_;
+
+			int Backoff_ = 0;
+			int SkipsLeft_ = 0;
+		};
+		QHash<IDType_t, FeedState> States_;
+
+		QHash<IDType_t, QNetworkReply*> InFlight_;
+		QHash<QString, int> InFlightPerHost_;
+
+		Stats Stats_;
+
+		std::mt19937 PRG_ { std::random_device {} () };
+	public:
+		FeedUpdateScheduler (QNetworkAccessManager*, QObject* = nullptr);
+
+		/** @brief Enqueues the feed for fetching.
+		 *
+		 * Does nothing if the feed is already queued or being fetched.
+		 *
+		 * @param[in] feedId The ID of the feed.
+		 * @param[in] url The URL of the feed.
+		 */
+		void Enqueue (IDType_t feedId, const QUrl& url);
+
+		/** @brief Checks whether the feed should be updated on this
+		 * periodic update.
+		 *
+		 * Each call for a feed whose interval has been increased counts
+		 * as a skipped update.
+		 *
+		 * @param[in] feedId The ID of the feed.
+		 * @return Whether the feed should be updated now.
+		 */
+		bool ShouldUpdate (IDType_t feedId);
+
+		/** @brief Resets the increased interval of the given feed.
+		 *
+		 * This is intended to be called when the user explicitly asks to
+		 * update the feed.
+		 *
+		 * @param[in] feedId The ID of the feed.
+		 */
+		void ResetBackoff (IDType_t feedId);
+
+		/** @brief Remembers the last fetched body of the feed.
+		 *
+		 * This should be called once the body passed to feedFetched()
+		 * has been parsed successfully. Until then, the same body is
+		 * not considered unchanged, so a body that has failed to parse
+		 * is parsed again on the next update.
+		 *
+		 * @param[in] feedId The ID of the feed.
+		 */
+		void CommitBody (IDType_t feedId);
+
+		/** @brief Forgets everything about the given feed.
+		 *
+		 * The fetch of the feed, if any, is aborted.
+		 */
+		void Forget (IDType_t feedId);
+
+		const Stats& GetStats () const;
+	private:
+		FeedState& GetState (IDType_t);
+		void SaveBody (IDType_t, const BodyInfo&);
+
+		void Dispatch ();
+		void Start (const QueuedFeed&);
+		void HandleFinished (const QueuedFeed&, QNetworkReply*, qint64 latency);
+		void MarkChanged (FeedState&, bool changed);
+	signals:
+		/** @brief Emitted when the feed has been fetched and has changed.
+		 *
+		 * The handler is expected to call CommitBody() if it has
+		 * successfully parsed the data.
+		 *
+		 * @param[out] feedId The ID of the feed.
+		 * @param[out] url The URL of the feed.
+		 * @param[out] data The body of the response.
+		 */
+		void feedFetched (IDType_t feedId, const QString& url, const QByteArray& data);
+
+		/** @brief Emitted when fetching the feed has failed.
+		 *
+		 * @param[out] feedId The ID of the feed.
+		 * @param[out] url The URL of the feed.
+		 * @param[out] error The network error.
+		 */
+		void feedFetchFailed (IDType_t feedId, const QString& url, QNetworkReply::NetworkError error);
+	};
+}
+}
@@ -33,7 +33,7 @@
 #include <QDataStream>
 #include <QtDebug>
 #include "item.h"
-#include "core.h"
+#include "poolsmanager.h"
 
 namespace LeechCraft
 {
@@ -128,7 +128,7 @@ namespace Aggregator
 	}
 
 	Enclosure::Enclosure (const IDType_t& item)
-	: EnclosureID_ (Core::Instance ().GetPool (PTEnclosure).GetID ())
+	: EnclosureID_ (PoolsManager::Instance ().GetPool (PTEnclosure).GetID ())
 	, ItemID_ (item)
 	{
 	}
@@ -150,7 +150,7 @@ namespace Aggregator
 #define MRSS_IDMEM(a) MRSS##a##ID_
 #define MRSS_DEFINE_CTORS(a) \
 	MRSS_CN(a)::MRSS_CN(a) (const IDType_t& mrssEntry) \
-	: MRSS_IDMEM(a) (Core::Instance ().GetPool (MRSS_ENUM(a)).GetID ()) \
+	: MRSS_IDMEM(a) (PoolsManager::Instance ().GetPool (MRSS_ENUM(a)).GetID ()) \
 	, MRSSEntryID_ (mrssEntry) \
 	{ \
 	} \
@@ -179,7 +179,7 @@ namespace Aggregator
 #undef MRSS_EXPANDER
 
 	MRSSEntry::MRSSEntry (const IDType_t& itemId)
-	: MRSSEntryID_ (Core::Instance ().GetPool (PTMRSSEntry).GetID ())
+	: MRSSEntryID_ (PoolsManager::Instance ().GetPool (PTMRSSEntry).GetID ())
 	, ItemID_ (itemId)
 	{
 	}
@@ -192,7 +192,7 @@ namespace Aggregator
 
 	Item::Item (const IDType_t& channel)
 	: ChannelID_ (channel)
-	, ItemID_ (Core::Instance ().GetPool (PTItem).GetID ())
+	, ItemID_ (PoolsManager::Instance ().GetPool (PTItem).GetID ())
 	{
 	}
 
@@ -81,6 +81,21 @@ namespace Aggregator
 		invalidate ();
 	}
 
+	void ItemsFilterModel::SetMatchedItems (const boost::optional<QSet<IDType_t>>& items)
+	{
+		MatchedItems_ = items;
+		invalidateFilter ();
+	}
+
+	void ItemsFilterModel::AddMatchedItems (const QSet<IDType_t>& items)
+	{
+		if (!MatchedItems_ || items.isEmpty ())
+			return;
+
+		*MatchedItems_ += items;
+		invalidateFilter ();
+	}
+
 	bool ItemsFilterModel::filterAcceptsRow (int sourceRow,
 			const QModelIndex& sourceParent) const
 	{
@@ -104,6 +119,10 @@ namespace Aggregator
 				!TaggedItems_.contains (ItemsWidget_->GetItemIDFromRow (sourceRow)))
 			return false;
 
+		if (MatchedItems_ &&
+				!MatchedItems_->contains (ItemsWidget_->GetItemIDFromRow (sourceRow)))
+			return false;
+
 		return QSortFilterProxyModel::filterAcceptsRow (sourceRow, sourceParent);
 	}
 
@@ -32,6 +32,7 @@
 #include <QSortFilterProxyModel>
 #include <QSet>
 #include <QString>
+#include <boost/optional.hpp>
 #include <interfaces/core/itagsmanager.h>
 #include "common.h"
 
@@ -50,12 +51,24 @@ namespace Aggregator
 		QSet<QString> ItemCategories_;
 		ItemsWidget *ItemsWidget_ = nullptr;
 		QSet<IDType_t> TaggedItems_;
+		boost::optional<QSet<IDType_t>> MatchedItems_;
 	public:
 		ItemsFilterModel (QObject* = 0);
 
 		void SetItemsWidget (ItemsWidget*);
 		void SetHideRead (bool);
 		void SetItemTags (QList<ITagsManager::tag_id>);
+
+		/** @brief Restricts the model to the given items.
+		 *
+		 * If the set is not initialized, all the items are accepted.
+		 */
+		void SetMatchedItems (const boost::optional<QSet<IDType_t>>&);
+
+		/** @brief Adds the given items to the ones set via
+		 * SetMatchedItems().
+		 */
+		void AddMatchedItems (const QSet<IDType_t>&);
 	protected:
 		virtual bool filterAcceptsRow (int, const QModelIndex&) const;
 		virtual bool lessThan (const QModelIndex&, const QModelIndex&) const;
@@ -151,6 +151,30 @@ namespace Aggregator
 		endResetModel ();
 	}
 
+	void ItemsListModel::AddItems (const QList<IDType_t>& items)
+	{
+		QSet<IDType_t> known;
+		for (const auto& item : CurrentItems_)
+			known << item.ItemID_;
+
+		const auto& sb = GetSB ();
+		items_shorts_t added;
+		for (const IDType_t& itemId : items)
+			if (!known.contains (itemId))
+				if (const auto& item = sb->GetItem (itemId))
+				{
+					added.push_back (item->ToShort ());
+					known << itemId;
+				}
+
+		if (added.empty ())
+			return;
+
+		beginInsertRows ({}, CurrentItems_.size (), CurrentItems_.size () + added.size () - 1);
+		CurrentItems_.insert (CurrentItems_.end (), added.begin (), added.end ());
+		endInsertRows ();
+	}
+
 	void ItemsListModel::RemoveItems (const QSet<IDType_t>& ids)
 	{
 		if (ids.isEmpty ())
@@ -73,6 +73,10 @@ namespace Aggregator
 		QStringList GetCategories (int) const;
 		void Reset (IDType_t, IDType_t);
 		void Reset (const QList<IDType_t>&);
+
+		/** Appends the given items that are not in the model yet.
+		 */
+		void AddItems (const QList<IDType_t>&);
 		void RemoveItems (const QSet<IDType_t>&);
 		void ItemDataUpdated (const Item&);
 
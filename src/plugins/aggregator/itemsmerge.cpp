@@ -0,0 +1,140 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "itemsmerge.h"
+#include <QHash>
+
+namespace LeechCraft
+{
+namespace Aggregator
+{
+	namespace
+	{
+		bool PrepareNewItem (Item& item, const Channel& channel, const Feed::FeedSettings& settings)
+		{
+			if (item.PubDate_.isValid ())
+			{
+				if (item.PubDate_.daysTo (QDateTime::currentDateTime ()) >= settings.ItemAge_)
+					return false;
+			}
+			else
+				item.FixDate ();
+
+			item.ChannelID_ = channel.ChannelID_;
+			return true;
+		}
+
+		bool MergeItem (const Item& item, Item& ourItem)
+		{
+			if (!IsModified (ourItem, item))
+				return false;
+
+			ourItem.Description_ = item.Description_;
+			ourItem.Categories_ = item.Categories_;
+			ourItem.NumComments_ = item.NumComments_;
+			ourItem.CommentsLink_ = item.CommentsLink_;
+			ourItem.CommentsPageLink_ = item.CommentsPageLink_;
+			ourItem.Latitude_ = item.Latitude_;
+			ourItem.Longitude_ = item.Longitude_;
+
+			for (auto enc : item.Enclosures_)
+				if (!ourItem.Enclosures_.contains (enc))
+				{
+					enc.ItemID_ = ourItem.ItemID_;
+					ourItem.Enclosures_ << enc;
+				}
+
+			for (auto entry : item.MRSSEntries_)
+				if (!ourItem.MRSSEntries_.contains (entry))
+				{
+					entry.ItemID_ = ourItem.ItemID_;
+					ourItem.MRSSEntries_ << entry;
+				}
+
+			return true;
+		}
+	}
+
+	StorageBackend::ItemsMerge PrepareItemsMerge (const StorageBackend& sb,
+			const Channel& parsed, const Channel& ourChannel, const Feed::FeedSettings& settings)
+	{
+		auto index = sb.GetChannelItemsIndex (ourChannel.ChannelID_);
+
+		StorageBackend::ItemsMerge merge
+		{
+			ourChannel.ChannelID_,
+			{},
+			{},
+			settings.ItemAge_,
+			settings.NumItems_
+		};
+
+		// Items might repeat inside a single feed, so the ones that are
+		// going to be added are tracked as well.
+		QHash<IDType_t, int> addedPositions;
+		QHash<IDType_t, int> updatedPositions;
+
+		for (const auto& itemPtr : parsed.Items_)
+		{
+			auto& item = *itemPtr;
+
+			if (const auto& ourItemID = index.Find (item.Title_, item.Link_))
+			{
+				if (addedPositions.contains (*ourItemID))
+				{
+					MergeItem (item, merge.Added_ [addedPositions [*ourItemID]]);
+					continue;
+				}
+
+				if (updatedPositions.contains (*ourItemID))
+				{
+					MergeItem (item, merge.Updated_ [updatedPositions [*ourItemID]]);
+					continue;
+				}
+
+				if (auto ourItem = sb.GetItem (*ourItemID);
+					ourItem && MergeItem (item, *ourItem))
+				{
+					updatedPositions [*ourItemID] = merge.Updated_.size ();
+					merge.Updated_ << *ourItem;
+				}
+			}
+			else if (PrepareNewItem (item, ourChannel, settings))
+			{
+				index.Add (item.ItemID_, item.Title_, item.Link_);
+				addedPositions [item.ItemID_] = merge.Added_.size ();
+				merge.Added_ << item;
+			}
+		}
+
+		return merge;
+	}
+}
+}
@@ -0,0 +1,61 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#pragma once
+
+#include "storagebackend.h"
+#include "channel.h"
+#include "feed.h"
+
+namespace LeechCraft
+{
+namespace Aggregator
+{
+	/** @brief Classifies the items of a freshly parsed channel.
+	 *
+	 * Splits the items of the \em parsed channel into the ones that are
+	 * new to the \em ourChannel stored in \em sb and the ones that
+	 * update already stored items. The stored items are looked up via
+	 * a single StorageBackend::GetChannelItemsIndex() call.
+	 *
+	 * New items that are older than allowed by the \em settings are
+	 * skipped. The rest of the new items get their channel ID fixed.
+	 *
+	 * @param[in] sb The storage backend containing \em ourChannel.
+	 * @param[in] parsed The channel as it has been parsed.
+	 * @param[in] ourChannel The stored counterpart of \em parsed.
+	 * @param[in] settings The settings of the feed of the channel.
+	 * @return The merge ready to be passed to
+	 * StorageBackend::MergeItems().
+	 */
+	StorageBackend::ItemsMerge PrepareItemsMerge (const StorageBackend& sb,
+			const Channel& parsed, const Channel& ourChannel, const Feed::FeedSettings& settings);
+}
+}
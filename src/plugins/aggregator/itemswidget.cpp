@@ -48,6 +48,7 @@
 #include <util/shortcuts/shortcutmanager.h>
 #include <util/util.h>
 #include <util/sll/overload.h>
+#include <util/threads/futures.h>
 #include <interfaces/core/itagsmanager.h>
 #include <interfaces/core/ientitymanager.h>
 #include "core.h"
@@ -101,6 +102,8 @@ namespace Aggregator
 		QTimer *SelectedChecker_;
 		QModelIndex LastSelectedIndex_;
 		QModelIndex LastSelectedChannel_;
+
+		quint64 SearchGeneration_ = 0;
 	};
 
 	ItemsWidget::ItemsWidget (QWidget *parent)
@@ -1353,6 +1356,7 @@ namespace Aggregator
 	{
 		Impl_->ItemsFilterModel_->setFilterCaseSensitivity (state ?
 				Qt::CaseSensitive : Qt::CaseInsensitive);
+		updateItemsFilter ();
 	}
 
 	void ItemsWidget::on_ActionItemCommentsSubscribe__triggered ()
@@ -1494,7 +1498,7 @@ namespace Aggregator
 	void ItemsWidget::updateItemsFilter ()
 	{
 		const int section = Impl_->Ui_.SearchType_->currentIndex ();
-		if (section == 4)
+		if (section == 5)
 		{
 			const auto& sb = StorageBackendManager::Instance ().MakeStorageBackendForThread ();
 			Impl_->CurrentItemsModel_->Reset (sb->GetItemsForTag ("_important"));
@@ -1502,26 +1506,93 @@ namespace Aggregator
 		else
 			CurrentChannelChanged (Impl_->LastSelectedChannel_);
 
+		++Impl_->SearchGeneration_;
+
 		const QString& text = Impl_->Ui_.SearchLine_->text ();
 		switch (section)
 		{
-		case 1:
+		case 2:
+			Impl_->ItemsFilterModel_->SetMatchedItems ({});
 			Impl_->ItemsFilterModel_->setFilterWildcard (text);
 			break;
-		case 2:
+		case 3:
+			Impl_->ItemsFilterModel_->SetMatchedItems ({});
 			Impl_->ItemsFilterModel_->setFilterRegExp (text);
 			break;
 		default:
-			Impl_->ItemsFilterModel_->setFilterFixedString (text);
+			Impl_->ItemsFilterModel_->setFilterFixedString ({});
+			StartSearch (text, section == 1, section == 5);
 			break;
 		}
 
 		QList<ITagsManager::tag_id> tags;
-		if (section == 3)
+		if (section == 4)
 			tags << "_important";
 		Impl_->ItemsFilterModel_->SetItemTags (tags);
 	}
 
+	namespace
+	{
+		const int SearchPageSize = 500;
+	}
+
+	void ItemsWidget::StartSearch (const QString& text, bool fixedString, bool allChannels)
+	{
+		if (text.trimmed ().isEmpty ())
+		{
+			Impl_->ItemsFilterModel_->SetMatchedItems ({});
+			return;
+		}
+
+		StorageBackend::ItemSearchParams params;
+		params.Text_ = text;
+		params.FixedString_ = fixedString;
+		params.CaseSensitivity_ = Impl_->Ui_.CaseSensitiveSearch_->isChecked () ?
+				Qt::CaseSensitive :
+				Qt::CaseInsensitive;
+		params.Limit_ = SearchPageSize;
+
+		const auto currentChannel = Impl_->CurrentItemsModel_->GetCurrentChannel ();
+		if (!allChannels && !Impl_->MergeMode_ && currentChannel != IDNotFound)
+			params.ChannelID_ = currentChannel;
+
+		/* Without a channel nothing is shown, so the hits from all the
+		 * channels are loaded into the model as they arrive.
+		 */
+		const bool loadHits = !allChannels && !Impl_->MergeMode_ && currentChannel == IDNotFound;
+
+		// The items are shown as soon as each page of the results arrives.
+		Impl_->ItemsFilterModel_->SetMatchedItems (QSet<IDType_t> {});
+		FetchSearchPage (params, Impl_->SearchGeneration_, loadHits);
+	}
+
+	void ItemsWidget::FetchSearchPage (const StorageBackend::ItemSearchParams& params,
+			quint64 generation, bool loadHits)
+	{
+		Util::Sequence (this, Core::Instance ().SearchItems (params)) >>
+				[this, params, generation, loadHits] (const QList<StorageBackend::ItemSearchResult>& hits)
+				{
+					if (generation != Impl_->SearchGeneration_)
+						return;
+
+					QList<IDType_t> ids;
+					ids.reserve (hits.size ());
+					for (const auto& hit : hits)
+						ids << hit.ItemID_;
+
+					if (loadHits)
+						Impl_->CurrentItemsModel_->AddItems (ids);
+					Impl_->ItemsFilterModel_->AddMatchedItems (QSet<IDType_t>::fromList (ids));
+
+					if (hits.size () < params.Limit_)
+						return;
+
+					auto next = params;
+					next.Offset_ += hits.size ();
+					FetchSearchPage (next, generation, loadHits);
+				};
+	}
+
 	void ItemsWidget::selectorVisiblityChanged ()
 	{
 		if (!XmlSettingsManager::Instance ()->
@@ -30,7 +30,10 @@
 #pragma once
 
 #include <QWidget>
+#include <QSet>
+#include <boost/optional.hpp>
 #include "ui_itemswidget.h"
+#include "storagebackend.h"
 #include "item.h"
 #include "channel.h"
 
@@ -129,6 +132,8 @@ namespace Aggregator
 		QString ToHtml (const Item&);
 		void RestoreSplitter ();
 		QList<QPersistentModelIndex> GetSelected () const;
+		void StartSearch (const QString&, bool fixedString, bool allChannels);
+		void FetchSearchPage (const StorageBackend::ItemSearchParams&, quint64 generation, bool loadHits);
 	private slots:
 		void invalidateMergeMode ();
 		void on_ActionHideReadItems__triggered ();
@@ -0,0 +1,171 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <QString>
+#include <QList>
+#include "item.h"
+#include "poolsmanager.h"
+
+namespace LeechCraft
+{
+namespace Aggregator
+{
+	/** @brief MediaRSS data that may be located at any level of a feed.
+	 *
+	 * Elements like media:title or media:thumbnail may appear in a
+	 * media:content element as well as in any of its parents, with the
+	 * innermost ones taking precedence.
+	 */
+	struct MRSSLocatedData
+	{
+		boost::optional<QString> URL_;
+		boost::optional<QString> Rating_;
+		boost::optional<QString> RatingScheme_;
+		boost::optional<QString> Title_;
+		boost::optional<QString> Description_;
+		boost::optional<QString> Keywords_;
+		boost::optional<QString> CopyrightURL_;
+		boost::optional<QString> CopyrightText_;
+		boost::optional<int> RatingAverage_;
+		boost::optional<int> RatingCount_;
+		boost::optional<int> RatingMin_;
+		boost::optional<int> RatingMax_;
+		boost::optional<int> Views_;
+		boost::optional<int> Favs_;
+		boost::optional<QString> Tags_;
+		QList<MRSSThumbnail> Thumbnails_;
+		QList<MRSSCredit> Credits_;
+		QList<MRSSComment> Comments_;
+		QList<MRSSPeerLink> PeerLinks_;
+		QList<MRSSScene> Scenes_;
+
+		/**  Updates *this's fields according to the
+			* child. Some kind of merge.
+			*/
+		MRSSLocatedData& operator+= (const MRSSLocatedData& child)
+		{
+			if (child.URL_)
+				URL_.reset (*child.URL_);
+			if (child.Rating_)
+				Rating_.reset (*child.Rating_);
+			if (child.RatingScheme_)
+				RatingScheme_.reset (*child.RatingScheme_);
+			if (child.Title_)
+				Title_.reset (*child.Title_);
+			if (child.Description_)
+				Description_.reset (*child.Description_);
+			if (child.Keywords_)
+				Keywords_.reset (*child.Keywords_);
+			if (child.CopyrightURL_)
+				CopyrightURL_.reset (*child.CopyrightURL_);
+			if (child.CopyrightText_)
+				CopyrightText_.reset (*child.CopyrightText_);
+			if (child.RatingAverage_)
+				RatingAverage_.reset (*child.RatingAverage_);
+			if (child.RatingCount_)
+				RatingCount_.reset (*child.RatingCount_);
+			if (child.RatingMin_)
+				RatingMin_.reset (*child.RatingMin_);
+			if (child.RatingMax_)
+				RatingMax_.reset (*child.RatingMax_);
+			if (child.Views_)
+				Views_.reset (*child.Views_);
+			if (child.Favs_)
+				Favs_.reset (*child.Favs_);
+			if (child.Tags_)
+				Tags_.reset (*child.Tags_);
+
+			Thumbnails_ += child.Thumbnails_;
+			Credits_ += child.Credits_;
+			Comments_ += child.Comments_;
+			PeerLinks_ += child.PeerLinks_;
+			Scenes_ += child.Scenes_;
+			return *this;
+		}
+
+		/** Returns a copy of this data with the thumbnails, credits,
+			* comments, peer links and scenes bound to the given entry
+			* and having fresh IDs, so that the data inherited by
+			* several entries doesn't end up sharing the same rows.
+			*/
+		MRSSLocatedData ForEntry (const IDType_t& entryId) const
+		{
+			auto result = *this;
+			Rebind (result.Thumbnails_, entryId, PTMRSSThumbnail, &MRSSThumbnail::MRSSThumbnailID_);
+			Rebind (result.Credits_, entryId, PTMRSSCredit, &MRSSCredit::MRSSCreditID_);
+			Rebind (result.Comments_, entryId, PTMRSSComment, &MRSSComment::MRSSCommentID_);
+			Rebind (result.PeerLinks_, entryId, PTMRSSPeerLink, &MRSSPeerLink::MRSSPeerLinkID_);
+			Rebind (result.Scenes_, entryId, PTMRSSScene, &MRSSScene::MRSSSceneID_);
+			return result;
+		}
+
+		/** Fills the fields of the entry that don't come from the
+			* media:content element's own attributes.
+			*/
+		void FillEntry (MRSSEntry& entry) const
+		{
+			entry.Rating_ = Rating_.get_value_or (QString ());
+			entry.RatingScheme_ = RatingScheme_.get_value_or (QString ());
+			entry.Title_ = Title_.get_value_or (QString ());
+			entry.Description_ = Description_.get_value_or (QString ());
+			entry.Keywords_ = Keywords_.get_value_or (QString ());
+			entry.CopyrightURL_ = CopyrightURL_.get_value_or (QString ());
+			entry.CopyrightText_ = CopyrightText_.get_value_or (QString ());
+			entry.RatingAverage_ = RatingAverage_.get_value_or (0);
+			entry.RatingCount_ = RatingCount_.get_value_or (0);
+			entry.RatingMin_ = RatingMin_.get_value_or (0);
+			entry.RatingMax_ = RatingMax_.get_value_or (0);
+			entry.Views_ = Views_.get_value_or (0);
+			entry.Favs_ = Favs_.get_value_or (0);
+			entry.Tags_ = Tags_.get_value_or (QString ());
+			entry.Thumbnails_ = Thumbnails_;
+			entry.Credits_ = Credits_;
+			entry.Comments_ = Comments_;
+			entry.PeerLinks_ = PeerLinks_;
+			entry.Scenes_ = Scenes_;
+		}
+	private:
+		template<typename T>
+		static void Rebind (QList<T>& list, const IDType_t& entryId,
+				PoolType poolType, IDType_t T::*idMember)
+		{
+			auto& pool = PoolsManager::Instance ().GetPool (poolType);
+			for (auto& elem : list)
+			{
+				elem.*idMember = pool.GetID ();
+				elem.MRSSEntryID_ = entryId;
+			}
+		}
+	};
+}
+}
@@ -34,6 +34,7 @@
 #include <QObject>
 #include <QtDebug>
 #include <util/sll/prelude.h>
+#include "mrsslocateddata.h"
 
 uint qHash (const QDomNode& node)
 {
@@ -318,73 +319,7 @@ namespace Aggregator
 
 	class MRSSParser
 	{
-		struct ArbitraryLocatedData
-		{
-			boost::optional<QString> URL_;
-			boost::optional<QString> Rating_;
-			boost::optional<QString> RatingScheme_;
-			boost::optional<QString> Title_;
-			boost::optional<QString> Description_;
-			boost::optional<QString> Keywords_;
-			boost::optional<QString> CopyrightURL_;
-			boost::optional<QString> CopyrightText_;
-			boost::optional<int> RatingAverage_;
-			boost::optional<int> RatingCount_;
-			boost::optional<int> RatingMin_;
-			boost::optional<int> RatingMax_;
-			boost::optional<int> Views_;
-			boost::optional<int> Favs_;
-			boost::optional<QString> Tags_;
-			QList<MRSSThumbnail> Thumbnails_;
-			QList<MRSSCredit> Credits_;
-			QList<MRSSComment> Comments_;
-			QList<MRSSPeerLink> PeerLinks_;
-			QList<MRSSScene> Scenes_;
-
-			/**  Updates *this's fields according to the
-				* child. Some kind of merge.
-				*/
-			ArbitraryLocatedData& operator+= (const ArbitraryLocatedData& child)
-			{
-				if (child.URL_)
-					URL_.reset (*child.URL_);
-				if (child.Rating_)
-					Rating_.reset (*child.Rating_);
-				if (child.RatingScheme_)
-					RatingScheme_.reset (*child.RatingScheme_);
-				if (child.Title_)
-					Title_.reset (*child.Title_);
-				if (child.Description_)
-					Description_.reset (*child.Description_);
-				if (child.Keywords_)
-					Keywords_.reset (*child.Keywords_);
-				if (child.CopyrightURL_)
-					CopyrightURL_.reset (*child.CopyrightURL_);
-				if (child.CopyrightText_)
-					CopyrightText_.reset (*child.CopyrightText_);
-				if (child.RatingAverage_)
-					RatingAverage_.reset (*child.RatingAverage_);
-				if (child.RatingCount_)
-					RatingCount_.reset (*child.RatingCount_);
-				if (child.RatingMin_)
-					RatingMin_.reset (*child.RatingMin_);
-				if (child.RatingMax_)
-					RatingMax_.reset (*child.RatingMax_);
-				if (child.Views_)
-					Views_.reset (*child.Views_);
-				if (child.Favs_)
-					Favs_.reset (*child.Favs_);
-				if (child.Tags_)
-					Tags_.reset (*child.Tags_);
-
-				Thumbnails_ += child.Thumbnails_;
-				Credits_ += child.Credits_;
-				Comments_ += child.Comments_;
-				PeerLinks_ += child.PeerLinks_;
-				Scenes_ += child.Scenes_;
-				return *this;
-			}
-		};
+		using ArbitraryLocatedData = MRSSLocatedData;
 
 		QHash<QDomNode, ArbitraryLocatedData> Cache_;
 
@@ -446,25 +381,7 @@ namespace Aggregator
 				entry.Height_ = en.attribute ("height").toInt ();
 				entry.Lang_ = en.attribute ("lang");
 
-				entry.Rating_ = d.Rating_.get_value_or (QString ());
-				entry.RatingScheme_ = d.RatingScheme_.get_value_or (QString ());
-				entry.Title_ = d.Title_.get_value_or (QString ());
-				entry.Description_ = d.Description_.get_value_or (QString ());
-				entry.Keywords_ = d.Keywords_.get_value_or (QString ());
-				entry.CopyrightURL_ = d.CopyrightURL_.get_value_or (QString ());
-				entry.CopyrightText_ = d.CopyrightText_.get_value_or (QString ());
-				entry.RatingAverage_ = d.RatingAverage_.get_value_or (0);
-				entry.RatingCount_ = d.RatingCount_.get_value_or (0);
-				entry.RatingMin_ = d.RatingMin_.get_value_or (0);
-				entry.RatingMax_ = d.RatingMax_.get_value_or (0);
-				entry.Views_ = d.Views_.get_value_or (0);
-				entry.Favs_ = d.Favs_.get_value_or (0);
-				entry.Tags_ = d.Tags_.get_value_or (QString ());
-				entry.Thumbnails_ = d.Thumbnails_;
-				entry.Credits_ = d.Credits_;
-				entry.Comments_ = d.Comments_;
-				entry.PeerLinks_ = d.PeerLinks_;
-				entry.Scenes_ = d.Scenes_;
+				d.FillEntry (entry);
 
 				result << entry;
 			}
@@ -793,7 +710,7 @@ namespace Aggregator
 		return MRSSParser (itemId) (item);
 	}
 
-	QDateTime Parser::FromRFC3339 (const QString& t) const
+	QDateTime Parser::FromRFC3339 (const QString& t)
 	{
 		if (t.size () < 19)
 			return QDateTime ();
@@ -41,6 +41,8 @@ namespace Aggregator
 	class Parser
 	{
 		friend class MRSSParser;
+		friend class StreamParser;
+		friend class StreamMRSSParser;
 	public:
 		virtual ~Parser () = default;
 		/** @brief Indicates whether parser could parse the document.
@@ -95,7 +97,7 @@ namespace Aggregator
 		QList<MRSSEntry> GetMediaRSS (const QDomElement&,
 				const IDType_t&) const;
 
-		QDateTime FromRFC3339 (const QString&) const;
+		static QDateTime FromRFC3339 (const QString&);
 		static QString UnescapeHTML (const QString&);
 	};
 }
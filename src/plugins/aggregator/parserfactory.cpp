@@ -29,7 +29,7 @@
 
 #include <QtDebug>
 #include "parserfactory.h"
-#include "parser.h"
+#include "streamparser.h"
 
 namespace LeechCraft
 {
@@ -41,15 +41,15 @@ namespace Aggregator
 		return inst;
 	}
 	
-	void ParserFactory::Register (Parser *parser)
+	void ParserFactory::Register (StreamParser *parser)
 	{
-		Parsers_.append (parser);
+		StreamParsers_.append (parser);
 	}
-	
-	Parser* ParserFactory::Return (const QDomDocument& doc) const
+
+	StreamParser* ParserFactory::ReturnStream (const QXmlStreamReader& reader) const
 	{
-		for (auto parser : Parsers_)
-			if (parser->CouldParse (doc))
+		for (auto parser : StreamParsers_)
+			if (parser->CouldParse (reader))
 				return parser;
 		return nullptr;
 	}
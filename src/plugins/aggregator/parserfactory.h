@@ -31,23 +31,23 @@
 #define PLUGINS_AGGREGATOR_PARSERFACTORY_H
 #include <QList>
 
-class QDomDocument;
+class QXmlStreamReader;
 
 namespace LeechCraft
 {
 namespace Aggregator
 {
-	class Parser;
+	class StreamParser;
 
 	class ParserFactory
 	{
-		QList<Parser*> Parsers_;
+		QList<StreamParser*> StreamParsers_;
 
 		ParserFactory () = default;
 	public:
 		static ParserFactory& Instance ();
-		void Register (Parser*);
-		Parser* Return (const QDomDocument&) const;
+		void Register (StreamParser*);
+		StreamParser* ReturnStream (const QXmlStreamReader&) const;
 	};
 }
 }
@@ -30,34 +30,48 @@
 #include "rssparser.h"
 #include <QDomDocument>
 #include <QLocale>
+#include <QMap>
 #include <QtDebug>
 
 namespace LeechCraft
 {
 namespace Aggregator
 {
+	namespace
+	{
+		const QMap<QString, int>& GetTimezoneOffsets ()
+		{
+			static const QMap<QString, int> offsets
+			{
+				{ "GMT", 0 },
+				{ "UT", 0 },
+				{ "Z", 0 },
+				{ "EST", -5 },
+				{ "EDT", -4 },
+				{ "CST", -6 },
+				{ "CDT", -5 },
+				{ "MST", -7 },
+				{ "MDT", -6 },
+				{ "PST", -8 },
+				{ "PDT", -7 },
+				{ "A", -1 },
+				{ "M", -12 },
+				{ "N", 1 },
+				{ "Y", +12 }
+			};
+			return offsets;
+		}
+	}
+
 	RSSParser::RSSParser ()
 	{
-		TimezoneOffsets_ ["GMT"] = TimezoneOffsets_ ["UT"] = TimezoneOffsets_ ["Z"] = 0;
-		TimezoneOffsets_ ["EST"] = -5;
-		TimezoneOffsets_ ["EDT"] = -4;
-		TimezoneOffsets_ ["CST"] = -6;
-		TimezoneOffsets_ ["CDT"] = -5;
-		TimezoneOffsets_ ["MST"] = -7;
-		TimezoneOffsets_ ["MDT"] = -6;
-		TimezoneOffsets_ ["PST"] = -8;
-		TimezoneOffsets_ ["PDT"] = -7;
-		TimezoneOffsets_ ["A"] = -1;
-		TimezoneOffsets_ ["M"] = -12;
-		TimezoneOffsets_ ["N"] = 1;
-		TimezoneOffsets_ ["Y"] = +12;
 	}
 	
 	RSSParser::~RSSParser ()
 	{
 	}
 	
-	QDateTime RSSParser::RFC822TimeToQDateTime (const QString& t) const
+	QDateTime RSSParser::RFC822TimeToQDateTime (const QString& t)
 	{
 		if (t.size () < 20)
 			return QDateTime ();
@@ -84,7 +98,7 @@ namespace Aggregator
 			}
 		}
 		else
-			hoursShift = TimezoneOffsets_.value (timezone, 0);
+			hoursShift = GetTimezoneOffsets ().value (timezone, 0);
 	
 		//HACK: This we don't need this according to rfc, but we added it
 		//	to be compatible with some buggy rss generators
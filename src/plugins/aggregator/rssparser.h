@@ -29,7 +29,6 @@
 
 #ifndef PLUGINS_AGGREGATOR_RSSPARSER_H
 #define PLUGINS_AGGREGATOR_RSSPARSER_H
-#include <QMap>
 #include <QString>
 #include "parser.h"
 #include "channel.h"
@@ -42,14 +41,13 @@ namespace Aggregator
 {
 	class RSSParser : public Parser
 	{
+		friend class StreamParser;
 	protected:
-		QMap<QString, int> TimezoneOffsets_;
-
 		RSSParser ();
 	public:
 		virtual ~RSSParser ();
 	protected:
-		QDateTime RFC822TimeToQDateTime (const QString&) const;
+		static QDateTime RFC822TimeToQDateTime (const QString&);
 		QList<Enclosure> GetEnclosures (const QDomElement&, const IDType_t&) const;
 	};
 }
@@ -0,0 +1,360 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "rssstreamparser.h"
+#include <QMap>
+#include <QObject>
+#include <QXmlStreamReader>
+#include <QtDebug>
+#include "feedelements.h"
+
+namespace LeechCraft
+{
+namespace Aggregator
+{
+	channels_container_t RSSStreamParser::Parse (QXmlStreamReader& reader,
+			const IDType_t& feedId) const
+	{
+		channels_container_t channels;
+
+		auto root = FeedElements::ReadRoot (reader);
+		while (reader.readNextStartElement ())
+		{
+			if (reader.name () == "channel")
+				channels.push_back (ParseChannel (reader, feedId, GetMRSSLocatedData (root, 0)));
+			else
+				root.Append (reader);
+		}
+
+		return channels;
+	}
+
+	Channel_ptr RSSStreamParser::ParseChannel (QXmlStreamReader& reader, const IDType_t& feedId,
+			const MRSSLocatedData& rootContext) const
+	{
+		const auto chan = std::make_shared<Channel> (feedId);
+		auto& itemsList = chan->Items_;
+		itemsList.reserve (20);
+
+		auto head = FeedElements::ReadRoot (reader);
+		AuthorTracker author;
+
+		auto context = rootContext;
+		bool contextDirty = false;
+
+		while (reader.readNextStartElement ())
+		{
+			if (reader.name () != "item")
+			{
+				const auto child = head.Append (reader);
+				TrackAuthor (author, head, child);
+				contextDirty = true;
+				continue;
+			}
+
+			const auto& itemElems = FeedElements::Read (reader);
+			TrackAuthor (author, itemElems, 0);
+
+			if (contextDirty)
+			{
+				context = rootContext;
+				context += GetMRSSLocatedData (head, 0);
+				contextDirty = false;
+			}
+
+			itemsList.push_back (ParseItem (itemElems, chan->ChannelID_, context));
+		}
+
+		FillChannel (*chan, head, author);
+
+		if (!chan->LastBuild_.isValid () || chan->LastBuild_.isNull ())
+		{
+			if (!itemsList.empty ())
+				chan->LastBuild_ = itemsList.at (0)->PubDate_;
+			else
+				chan->LastBuild_ = QDateTime::currentDateTime ();
+		}
+
+		return chan;
+	}
+
+	QList<Enclosure> RSSStreamParser::GetEnclosures (const FeedElements& elems,
+			int entry, const IDType_t& item) const
+	{
+		QList<Enclosure> result;
+		for (const auto link : elems.ByTagName (entry, "enclosure"))
+		{
+			Enclosure e (item);
+			e.URL_ = elems.Attribute (link, "url");
+			e.Type_ = elems.Attribute (link, "type");
+			e.Length_ = elems.Attribute (link, "length", "-1").toLongLong ();
+			e.Lang_ = elems.Attribute (link, "hreflang");
+			result << e;
+		}
+		return result;
+	}
+
+	RSS20StreamParser& RSS20StreamParser::Instance ()
+	{
+		static RSS20StreamParser inst;
+		return inst;
+	}
+
+	bool RSS20StreamParser::CouldParse (const QXmlStreamReader& reader) const
+	{
+		return reader.name () == "rss" &&
+			reader.attributes ().value ("version") == "2.0";
+	}
+
+	void RSS20StreamParser::FillChannel (Channel& chan,
+			const FeedElements& head, const AuthorTracker& author) const
+	{
+		auto childText = [&head] (const QString& name) { return head.Text (head.FirstChild (0, name)); };
+
+		chan.Title_ = childText ("title").trimmed ();
+		chan.Description_ = childText ("description");
+		chan.Link_ = GetLink (head, 0);
+		chan.LastBuild_ = RFC822TimeToQDateTime (childText ("lastBuildDate"));
+		chan.Language_ = childText ("language");
+		chan.Author_ = author.GetAuthor ();
+		if (chan.Author_.isEmpty ())
+			chan.Author_ = childText ("managingEditor");
+		if (chan.Author_.isEmpty ())
+			chan.Author_ = childText ("webMaster");
+		chan.PixmapURL_ = head.Attribute (head.FirstChild (0, "image"), "url");
+	}
+
+	Item_ptr RSS20StreamParser::ParseItem (const FeedElements& item,
+			const IDType_t& channelId, const MRSSLocatedData& context) const
+	{
+		auto childText = [&item] (const QString& name) { return item.Text (item.FirstChild (0, name)); };
+
+		const auto result = std::make_shared<Item> (channelId);
+		result->Title_ = UnescapeHTML (childText ("title"));
+		if (result->Title_.isEmpty ())
+			result->Title_ = "<>";
+		result->Link_ = childText ("link");
+
+		result->Description_ = childText ("description");
+		GetDescription (item, 0, result->Description_);
+
+		if (const auto& duration = GetITunesDuration (item, 0))
+		{
+			if (!result->Description_.isEmpty ())
+				result->Description_ += "<br /><br />";
+			result->Description_ += QObject::tr ("Duration: %1")
+				.arg (*duration);
+		}
+
+		const auto& pubDateText = childText ("pubDate");
+		if (pubDateText.size ())
+		{
+			result->PubDate_ = RFC822TimeToQDateTime (pubDateText);
+			if (!result->PubDate_.isValid () || result->PubDate_.isNull ())
+				result->PubDate_ = QDateTime::currentDateTime ();
+		}
+
+		result->Guid_ = childText ("guid");
+		if (result->Guid_.isEmpty ())
+			result->Guid_ = "empty";
+		result->Categories_ = GetAllCategories (item, 0);
+		result->Unread_ = true;
+		result->Author_ = GetAuthor (item, 0);
+		result->NumComments_ = GetNumComments (item, 0);
+		result->CommentsLink_ = GetCommentsRSS (item, 0);
+		result->CommentsPageLink_ = GetCommentsLink (item, 0);
+		result->Enclosures_ = GetEnclosures (item, 0, result->ItemID_);
+		result->Enclosures_ += GetEncEnclosures (item, 0, result->ItemID_);
+		const auto& point = GetGeoPoint (item, 0);
+		result->Latitude_ = point.first;
+		result->Longitude_ = point.second;
+		result->MRSSEntries_ = GetMediaRSS (item, result->ItemID_, context);
+		return result;
+	}
+
+	RSS091StreamParser& RSS091StreamParser::Instance ()
+	{
+		static RSS091StreamParser inst;
+		return inst;
+	}
+
+	bool RSS091StreamParser::CouldParse (const QXmlStreamReader& reader) const
+	{
+		const auto& version = reader.attributes ().value ("version");
+		return reader.name () == "rss" &&
+			(version == "0.91" || version == "0.92");
+	}
+
+	void RSS091StreamParser::FillChannel (Channel& chan,
+			const FeedElements& head, const AuthorTracker&) const
+	{
+		chan.Title_ = head.Text (head.FirstChild (0, "title")).trimmed ();
+		chan.Description_ = head.Text (head.FirstChild (0, "description"));
+		chan.Link_ = head.Text (head.FirstChild (0, "link"));
+	}
+
+	Item_ptr RSS091StreamParser::ParseItem (const FeedElements& item,
+			const IDType_t& channelId, const MRSSLocatedData&) const
+	{
+		auto childText = [&item] (const QString& name) { return item.Text (item.FirstChild (0, name)); };
+
+		const auto result = std::make_shared<Item> (channelId);
+		result->Title_ = UnescapeHTML (childText ("title"));
+		if (result->Title_.isEmpty ())
+			result->Title_ = "<>";
+		result->Link_ = childText ("link");
+		result->Description_ = childText ("description");
+		GetDescription (item, 0, result->Description_);
+		result->PubDate_ = RFC822TimeToQDateTime (childText ("pubDate"));
+		if (!result->PubDate_.isValid () || result->PubDate_.isNull ())
+		{
+			qWarning () << "Aggregator RSS 0.91: Can't parse item pubDate: "
+					<< childText ("pubDate");
+			result->PubDate_ = QDateTime::currentDateTime ();
+		}
+		result->Guid_ = childText ("guid");
+		if (result->Guid_.isEmpty ())
+			result->Guid_ = "empty";
+		result->Categories_ = GetAllCategories (item, 0);
+		result->Unread_ = true;
+		result->Author_ = GetAuthor (item, 0);
+		result->NumComments_ = GetNumComments (item, 0);
+		result->CommentsLink_ = GetCommentsRSS (item, 0);
+		result->CommentsPageLink_ = GetCommentsLink (item, 0);
+		result->Enclosures_ = GetEnclosures (item, 0, result->ItemID_);
+		result->Enclosures_ += GetEncEnclosures (item, 0, result->ItemID_);
+		const auto& point = GetGeoPoint (item, 0);
+		result->Latitude_ = point.first;
+		result->Longitude_ = point.second;
+		return result;
+	}
+
+	RSS10StreamParser& RSS10StreamParser::Instance ()
+	{
+		static RSS10StreamParser inst;
+		return inst;
+	}
+
+	bool RSS10StreamParser::CouldParse (const QXmlStreamReader& reader) const
+	{
+		return reader.name () == "RDF";
+	}
+
+	channels_container_t RSS10StreamParser::Parse (QXmlStreamReader& reader,
+			const IDType_t& feedId) const
+	{
+		channels_container_t result;
+
+		QMap<QString, Channel_ptr> item2Channel;
+		QList<FeedElements> pendingItems;
+
+		auto handleItem = [&] (const FeedElements& itemElems)
+		{
+			const auto& channel = item2Channel.value (itemElems.AttributeNS (0, RDF (), "about"));
+			if (!channel)
+				return false;
+
+			channel->Items_.push_back (ParseItem (itemElems, channel->ChannelID_));
+			return true;
+		};
+
+		while (reader.readNextStartElement ())
+		{
+			if (reader.name () == "item")
+			{
+				auto itemElems = FeedElements::Read (reader);
+				if (!handleItem (itemElems))
+					pendingItems << std::move (itemElems);
+				continue;
+			}
+
+			if (reader.name () != "channel")
+			{
+				reader.skipCurrentElement ();
+				continue;
+			}
+
+			const auto& channelDescr = FeedElements::Read (reader);
+			auto childText = [&channelDescr] (const QString& name)
+			{
+				return channelDescr.Text (channelDescr.FirstChild (0, name));
+			};
+
+			const auto channel = std::make_shared<Channel> (feedId);
+			channel->Title_ = childText ("title").trimmed ();
+			channel->Link_ = childText ("link");
+			channel->Description_ = childText ("description");
+			channel->PixmapURL_ = channelDescr.Text (channelDescr.FirstChild (channelDescr.FirstChild (0, "image"), "url"));
+			channel->LastBuild_ = GetDCDateTime (channelDescr, 0);
+
+			const auto itemsRoot = channelDescr.FirstChild (0, "items");
+			const auto& seqs = channelDescr.ByTagNameNS (itemsRoot, RDF (), "Seq");
+			if (seqs.isEmpty ())
+				continue;
+
+			for (const auto li : channelDescr.ByTagNameNS (seqs.first (), RDF (), "li"))
+				item2Channel [channelDescr.Attribute (li, "resource")] = channel;
+
+			result.push_back (channel);
+		}
+
+		for (const auto& itemElems : pendingItems)
+			handleItem (itemElems);
+
+		return result;
+	}
+
+	Item_ptr RSS10StreamParser::ParseItem (const FeedElements& itemDescr, const IDType_t& channelId) const
+	{
+		auto childText = [&itemDescr] (const QString& name) { return itemDescr.Text (itemDescr.FirstChild (0, name)); };
+
+		const auto item = std::make_shared<Item> (channelId);
+		item->Title_ = childText ("title");
+		item->Link_ = childText ("link");
+		item->Description_ = childText ("description");
+		GetDescription (itemDescr, 0, item->Description_);
+
+		item->Categories_ = GetAllCategories (itemDescr, 0);
+		item->Author_ = GetAuthor (itemDescr, 0);
+		item->PubDate_ = GetDCDateTime (itemDescr, 0);
+		item->Unread_ = true;
+		item->NumComments_ = GetNumComments (itemDescr, 0);
+		item->CommentsLink_ = GetCommentsRSS (itemDescr, 0);
+		item->CommentsPageLink_ = GetCommentsLink (itemDescr, 0);
+		item->Enclosures_ = GetEncEnclosures (itemDescr, 0, item->ItemID_);
+		const auto& point = GetGeoPoint (itemDescr, 0);
+		item->Latitude_ = point.first;
+		item->Longitude_ = point.second;
+		if (item->Guid_.isEmpty ())
+			item->Guid_ = "empty";
+		return item;
+	}
+}
+}
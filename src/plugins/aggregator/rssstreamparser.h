@@ -0,0 +1,114 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#pragma once
+
+#include "streamparser.h"
+
+namespace LeechCraft
+{
+namespace Aggregator
+{
+	/** @brief Base class for the streaming parsers of RSS 0.9x and 2.0.
+	 *
+	 * These feeds have their items inside the channel elements, so each
+	 * item is parsed as soon as its closing tag is read.
+	 */
+	class RSSStreamParser : public StreamParser
+	{
+	protected:
+		channels_container_t Parse (QXmlStreamReader&,
+				const IDType_t&) const override;
+
+		/** @brief Fills the channel fields from its non-item elements.
+		 *
+		 * @param[in] channel The channel to fill.
+		 * @param[in] head The channel element with its children except
+		 * items.
+		 * @param[in] author The author data collected from the whole
+		 * channel, including items.
+		 */
+		virtual void FillChannel (Channel& channel,
+				const FeedElements& head, const AuthorTracker& author) const = 0;
+		virtual Item_ptr ParseItem (const FeedElements&,
+				const IDType_t&, const MRSSLocatedData&) const = 0;
+
+		QList<Enclosure> GetEnclosures (const FeedElements&, int, const IDType_t&) const;
+	private:
+		Channel_ptr ParseChannel (QXmlStreamReader&, const IDType_t&,
+				const MRSSLocatedData&) const;
+	};
+
+	class RSS20StreamParser : public RSSStreamParser
+	{
+		RSS20StreamParser () = default;
+	public:
+		static RSS20StreamParser& Instance ();
+
+		bool CouldParse (const QXmlStreamReader&) const override;
+	protected:
+		void FillChannel (Channel&, const FeedElements&, const AuthorTracker&) const override;
+		Item_ptr ParseItem (const FeedElements&, const IDType_t&, const MRSSLocatedData&) const override;
+	};
+
+	class RSS091StreamParser : public RSSStreamParser
+	{
+		RSS091StreamParser () = default;
+	public:
+		static RSS091StreamParser& Instance ();
+
+		bool CouldParse (const QXmlStreamReader&) const override;
+	protected:
+		void FillChannel (Channel&, const FeedElements&, const AuthorTracker&) const override;
+		Item_ptr ParseItem (const FeedElements&, const IDType_t&, const MRSSLocatedData&) const override;
+	};
+
+	/** @brief Streaming parser for RSS 1.0 (RDF) feeds.
+	 *
+	 * In RSS 1.0 the items are siblings of the channels, and the
+	 * channels refer to them via rdf:Seq lists. Items that come before
+	 * the channel referring to them are kept until the end of the
+	 * document.
+	 */
+	class RSS10StreamParser : public StreamParser
+	{
+		RSS10StreamParser () = default;
+	public:
+		static RSS10StreamParser& Instance ();
+
+		bool CouldParse (const QXmlStreamReader&) const override;
+	protected:
+		channels_container_t Parse (QXmlStreamReader&,
+				const IDType_t&) const override;
+	private:
+		Item_ptr ParseItem (const FeedElements&, const IDType_t&) const;
+	};
+}
+}
@@ -29,6 +29,7 @@
 
 #include "sqlstoragebackend.h"
 #include <stdexcept>
+#include <algorithm>
 #include <QDir>
 #include <QDebug>
 #include <QBuffer>
@@ -44,7 +45,7 @@
 #include <interfaces/core/icoreproxy.h>
 #include <interfaces/core/itagsmanager.h>
 #include "xmlsettingsmanager.h"
-#include "core.h"
+#include "storagebackendmanager.h"
 
 namespace LeechCraft
 {
@@ -179,6 +180,30 @@ namespace Aggregator
 				":auto_download_enclosures"
 				")").arg (orReplace));
 
+		FeedValidatorsGetter_ = QSqlQuery (DB_);
+		FeedValidatorsGetter_.prepare ("SELECT "
+				"etag, "
+				"last_modified, "
+				"body_hash, "
+				"body_size "
+				"FROM feeds_validators "
+				"WHERE feed_id = :feed_id");
+
+		FeedValidatorsSetter_ = QSqlQuery (DB_);
+		FeedValidatorsSetter_.prepare (QString ("INSERT %1 INTO feeds_validators ("
+				"feed_id, "
+				"etag, "
+				"last_modified, "
+				"body_hash, "
+				"body_size"
+				") VALUES ("
+				":feed_id, "
+				":etag, "
+				":last_modified, "
+				":body_hash, "
+				":body_size"
+				")").arg (orReplace));
+
 		ChannelsShortSelector_ = QSqlQuery (DB_);
 		ChannelsShortSelector_.prepare ("SELECT "
 				"channel_id, "
@@ -230,6 +255,15 @@ namespace Aggregator
 				"ORDER BY pub_date DESC, "
 				"title DESC");
 
+		ItemsIndexSelector_ = QSqlQuery (DB_);
+		ItemsIndexSelector_.prepare ("SELECT "
+				"item_id, "
+				"title, "
+				"url "
+				"FROM items "
+				"WHERE channel_id = :channel_id "
+				"ORDER BY item_id");
+
 		ItemFullSelector_ = QSqlQuery (DB_);
 		ItemFullSelector_.prepare ("SELECT "
 				"title, "
@@ -759,6 +793,32 @@ namespace Aggregator
 		GetItemsForTag_ = QSqlQuery (DB_);
 		GetItemsForTag_.prepare ("SELECT item_id FROM items2tags "
 				"WHERE tag = :tag");
+
+		if (HasFTS_)
+		{
+			SearchItems_ = QSqlQuery (DB_);
+			SearchItems_.prepare ("SELECT "
+					"rowid, "
+					"rank, "
+					"snippet (items_fts, -1, '<b>', '</b>', '...', 16), "
+					"title, description, author, category "
+					"FROM items_fts "
+					"WHERE items_fts MATCH :query "
+					"ORDER BY rank "
+					"LIMIT :limit OFFSET :offset");
+
+			SearchChannelItems_ = QSqlQuery (DB_);
+			SearchChannelItems_.prepare ("SELECT "
+					"items_fts.rowid, "
+					"items_fts.rank, "
+					"snippet (items_fts, -1, '<b>', '</b>', '...', 16), "
+					"items.title, items.description, items.author, items.category "
+					"FROM items_fts JOIN items ON items.item_id = items_fts.rowid "
+					"WHERE items_fts MATCH :query "
+					"AND items.channel_id = :channel_id "
+					"ORDER BY items_fts.rank "
+					"LIMIT :limit OFFSET :offset");
+		}
 	}
 
 	ids_t SQLStorageBackend::GetFeedsIDs () const
@@ -856,6 +916,225 @@ namespace Aggregator
 		return result;
 	}
 
+	namespace
+	{
+		QStringList GetSearchWords (const QString& text)
+		{
+			return text.split (' ', QString::SkipEmptyParts);
+		}
+
+		QString MakeFTSTerm (QString word, bool prefix)
+		{
+			return '"' + word.replace ('"', "\"\"") + '"' + (prefix ? "*" : "");
+		}
+
+		QString MakeFTSQuery (const QStringList& words)
+		{
+			QStringList terms;
+			for (const auto& word : words)
+				terms << MakeFTSTerm (word, true);
+			return terms.join (' ');
+		}
+
+		bool HasWordChars (const QString& word)
+		{
+			return std::any_of (word.begin (), word.end (),
+					[] (const QChar& c) { return c.isLetterOrNumber (); });
+		}
+
+		/** The text of a fixed string search may start and end in the
+		 * middle of some words, so only the words in between are known
+		 * to be full words, and the last one is known to be a prefix.
+		 * The first one is a suffix of some word, which FTS can't match.
+		 *
+		 * Returns an empty string if nothing can be matched via FTS.
+		 */
+		QString MakeFixedStringFTSQuery (const QString& text)
+		{
+			const auto& words = GetSearchWords (text);
+			if (words.size () < 2)
+				return {};
+
+			QStringList terms;
+			for (int i = 1; i < words.size (); ++i)
+				if (HasWordChars (words.at (i)))
+					terms << MakeFTSTerm (words.at (i), i == words.size () - 1);
+			return terms.join (' ');
+		}
+
+		bool IsAscii (const QString& text)
+		{
+			return std::all_of (text.begin (), text.end (),
+					[] (const QChar& c) { return c.unicode () < 128; });
+		}
+
+		/** Escapes the LIKE wildcards so that the text is matched as is,
+		 * with backslash as the escape character.
+		 */
+		QString EscapeLikePattern (QString text)
+		{
+			return text.replace ('\\', "\\\\")
+					.replace ('%', "\\%")
+					.replace ('_', "\\_");
+		}
+	}
+
+	QList<StorageBackend::ItemSearchResult> SQLStorageBackend::SearchItems (const ItemSearchParams& params) const
+	{
+		if (params.FixedString_)
+			return SearchItemsFixed (params);
+
+		const auto& words = GetSearchWords (params.Text_);
+		if (words.isEmpty ())
+			return {};
+
+		const auto& candidates = HasFTS_ ?
+				SearchItemsFTS (MakeFTSQuery (words), params.ChannelID_, params.Limit_, params.Offset_) :
+				SearchItemsLike (words, params.ChannelID_, params.Limit_, params.Offset_);
+
+		QList<ItemSearchResult> result;
+		result.reserve (candidates.size ());
+		for (const auto& candidate : candidates)
+			result << candidate.Result_;
+		return result;
+	}
+
+	QList<StorageBackend::ItemSearchResult> SQLStorageBackend::SearchItemsFixed (const ItemSearchParams& params) const
+	{
+		const auto& text = params.Text_;
+		if (text.isEmpty ())
+			return {};
+
+		// FTS or LIKE only narrow the candidates down, and then the text is
+		// looked for literally. LIKE is case-insensitive only for ASCII in
+		// SQLite, so it can't be used for narrowing otherwise.
+		const auto& ftsQuery = HasFTS_ ? MakeFixedStringFTSQuery (text) : QString {};
+		const bool canUseLike = Type_ == SBPostgres ||
+				params.CaseSensitivity_ == Qt::CaseSensitive ||
+				IsAscii (text);
+		const auto& likeWords = canUseLike ? QStringList { text } : QStringList {};
+
+		const int chunkSize = std::max (params.Limit_ * 4, 256);
+
+		QList<ItemSearchResult> result;
+		int toSkip = params.Offset_;
+		for (int chunkOffset = 0; ; chunkOffset += chunkSize)
+		{
+			const auto& candidates = ftsQuery.isEmpty () ?
+					SearchItemsLike (likeWords, params.ChannelID_, chunkSize, chunkOffset) :
+					SearchItemsFTS (ftsQuery, params.ChannelID_, chunkSize, chunkOffset);
+
+			for (const auto& candidate : candidates)
+			{
+				const auto& fields = candidate.Fields_;
+				if (std::none_of (fields.begin (), fields.end (),
+						[&] (const QString& field) { return field.contains (text, params.CaseSensitivity_); }))
+					continue;
+
+				if (toSkip)
+				{
+					--toSkip;
+					continue;
+				}
+
+				result << candidate.Result_;
+				if (result.size () >= params.Limit_)
+					return result;
+			}
+
+			if (candidates.size () < chunkSize)
+				return result;
+		}
+	}
+
+	QList<SQLStorageBackend::SearchCandidate> SQLStorageBackend::SearchItemsFTS (const QString& ftsQuery,
+			const boost::optional<IDType_t>& channelId, int limit, int offset) const
+	{
+		auto& query = channelId ? SearchChannelItems_ : SearchItems_;
+		query.bindValue (":query", ftsQuery);
+		query.bindValue (":limit", limit);
+		query.bindValue (":offset", offset);
+		if (channelId)
+			query.bindValue (":channel_id", *channelId);
+
+		if (!query.exec ())
+		{
+			Util::DBLock::DumpError (query);
+			return {};
+		}
+
+		QList<SearchCandidate> result;
+		while (query.next ())
+			result.append ({
+					{
+						query.value (0).value<IDType_t> (),
+						query.value (1).toDouble (),
+						query.value (2).toString ()
+					},
+					{
+						query.value (3).toString (),
+						query.value (4).toString (),
+						query.value (5).toString (),
+						query.value (6).toString ()
+					}
+				});
+		query.finish ();
+		return result;
+	}
+
+	QList<SQLStorageBackend::SearchCandidate> SQLStorageBackend::SearchItemsLike (const QStringList& words,
+			const boost::optional<IDType_t>& channelId, int limit, int offset) const
+	{
+		const QString like = Type_ == SBPostgres ? "ILIKE" : "LIKE";
+
+		QStringList conditions;
+		for (int i = 0; i < words.size (); ++i)
+		{
+			QStringList fields;
+			for (const auto& field : { "title", "description", "author", "category" })
+				fields << QString ("%1 %2 :word%3 ESCAPE '\\'").arg (field).arg (like).arg (i);
+			conditions << "(" + fields.join (" OR ") + ")";
+		}
+		if (channelId)
+			conditions << "channel_id = :channel_id";
+		if (conditions.isEmpty ())
+			conditions << "1 = 1";
+
+		QSqlQuery query (DB_);
+		query.prepare (QString ("SELECT item_id, title, description, author, category FROM items "
+					"WHERE %1 ORDER BY item_id LIMIT :limit OFFSET :offset")
+				.arg (conditions.join (" AND ")));
+		for (int i = 0; i < words.size (); ++i)
+			query.bindValue (QString (":word%1").arg (i), '%' + EscapeLikePattern (words.at (i)) + '%');
+		if (channelId)
+			query.bindValue (":channel_id", *channelId);
+		query.bindValue (":limit", limit);
+		query.bindValue (":offset", offset);
+
+		if (!query.exec ())
+		{
+			Util::DBLock::DumpError (query);
+			return {};
+		}
+
+		QList<SearchCandidate> result;
+		while (query.next ())
+			result.append ({
+					{
+						query.value (0).value<IDType_t> (),
+						0,
+						query.value (1).toString ()
+					},
+					{
+						query.value (1).toString (),
+						query.value (2).toString (),
+						query.value (3).toString (),
+						query.value (4).toString ()
+					}
+				});
+		return result;
+	}
+
 	IDType_t SQLStorageBackend::GetHighestID (const PoolType& type) const
 	{
 		QString field, table;
@@ -1004,6 +1283,40 @@ namespace Aggregator
 			LeechCraft::Util::DBLock::DumpError (FeedSettingsSetter_);
 	}
 
+	boost::optional<StorageBackend::FeedValidators> SQLStorageBackend::GetFeedValidators (const IDType_t& feedId) const
+	{
+		FeedValidatorsGetter_.bindValue (":feed_id", feedId);
+		if (!FeedValidatorsGetter_.exec ())
+			Util::DBLock::DumpError (FeedValidatorsGetter_);
+
+		if (!FeedValidatorsGetter_.next ())
+			return {};
+
+		FeedValidators result
+		{
+			feedId,
+			FeedValidatorsGetter_.value (0).toByteArray (),
+			FeedValidatorsGetter_.value (1).toByteArray (),
+			FeedValidatorsGetter_.value (2).toByteArray (),
+			FeedValidatorsGetter_.value (3).toLongLong ()
+		};
+		FeedValidatorsGetter_.finish ();
+
+		return result;
+	}
+
+	void SQLStorageBackend::SetFeedValidators (const FeedValidators& validators)
+	{
+		FeedValidatorsSetter_.bindValue (":feed_id", validators.FeedID_);
+		FeedValidatorsSetter_.bindValue (":etag", QString::fromLatin1 (validators.ETag_));
+		FeedValidatorsSetter_.bindValue (":last_modified", QString::fromLatin1 (validators.LastModified_));
+		FeedValidatorsSetter_.bindValue (":body_hash", validators.BodyHash_);
+		FeedValidatorsSetter_.bindValue (":body_size", validators.BodySize_);
+
+		if (!FeedValidatorsSetter_.exec ())
+			Util::DBLock::DumpError (FeedValidatorsSetter_);
+	}
+
 	channels_shorts_t SQLStorageBackend::GetChannels (const IDType_t& feedId) const
 	{
 		channels_shorts_t shorts;
@@ -1030,7 +1343,7 @@ namespace Aggregator
 
 			UnreadItemsCounter_.finish ();
 
-			QStringList tags = Core::Instance ().GetProxy ()->
+			QStringList tags = StorageBackendManager::Instance ().
 				GetTagsManager ()->Split (ChannelsShortSelector_.value (4).toString ());
 			ChannelShort sh
 			{
@@ -1070,7 +1383,7 @@ namespace Aggregator
 		channel.Description_ = ChannelsFullSelector_.value (3).toString ();
 		channel.LastBuild_ = ChannelsFullSelector_.value (4).toDateTime ();
 		QString tags = ChannelsFullSelector_.value (5).toString ();
-		channel.Tags_ = Core::Instance ().GetProxy ()->GetTagsManager ()->Split (tags);
+		channel.Tags_ = StorageBackendManager::Instance ().GetTagsManager ()->Split (tags);
 		channel.Language_ = ChannelsFullSelector_.value (6).toString ();
 		channel.Author_ = ChannelsFullSelector_.value (7).toString ();
 		channel.PixmapURL_ = ChannelsFullSelector_.value (8).toString ();
@@ -1154,6 +1467,15 @@ namespace Aggregator
 
 	void SQLStorageBackend::TrimChannel (const IDType_t& channelId,
 			int days, int number)
+	{
+		emit itemsRemoved (TrimChannelItems (channelId, days, number));
+
+		if (const auto channel = GetChannel (channelId))
+			emit channelDataUpdated (*channel);
+	}
+
+	QSet<IDType_t> SQLStorageBackend::TrimChannelItems (const IDType_t& channelId,
+			int days, int number)
 	{
 		const auto& cutoff = QDateTime::currentDateTime ().addDays (-days);
 
@@ -1174,8 +1496,6 @@ namespace Aggregator
 		while (ChannelNumberGetter_.next ())
 			removedIds << ChannelNumberGetter_.value (0).value<IDType_t> ();
 
-		emit itemsRemoved (removedIds);
-
 		ChannelDateTrimmer_.bindValue (":channel_id", channelId);
 		ChannelDateTrimmer_.bindValue (":date", cutoff);
 		if (!ChannelDateTrimmer_.exec ())
@@ -1186,8 +1506,7 @@ namespace Aggregator
 		if (!ChannelNumberTrimmer_.exec ())
 			LeechCraft::Util::DBLock::DumpError (ChannelNumberTrimmer_);
 
-		if (const auto channel = GetChannel (channelId))
-			emit channelDataUpdated (*channel);
+		return removedIds;
 	}
 
 	items_shorts_t SQLStorageBackend::GetItems (const IDType_t& channelId) const
@@ -1223,6 +1542,26 @@ namespace Aggregator
 		return shorts;
 	}
 
+	StorageBackend::ChannelItemsIndex SQLStorageBackend::GetChannelItemsIndex (const IDType_t& channelId) const
+	{
+		ItemsIndexSelector_.bindValue (":channel_id", channelId);
+		if (!ItemsIndexSelector_.exec ())
+		{
+			Util::DBLock::DumpError (ItemsIndexSelector_);
+			return {};
+		}
+
+		ChannelItemsIndex index;
+		while (ItemsIndexSelector_.next ())
+			index.Add (ItemsIndexSelector_.value (0).value<IDType_t> (),
+					ItemsIndexSelector_.value (1).toString (),
+					ItemsIndexSelector_.value (2).toString ());
+
+		ItemsIndexSelector_.finish ();
+
+		return index;
+	}
+
 	int SQLStorageBackend::GetUnreadItems (const IDType_t& channelId) const
 	{
 		int unread = 0;
@@ -1339,7 +1678,7 @@ namespace Aggregator
 		UpdateChannel_.bindValue (":description", channel.Description_);
 		UpdateChannel_.bindValue (":last_build", channel.LastBuild_);
 		UpdateChannel_.bindValue (":tags",
-				Core::Instance ().GetProxy ()->GetTagsManager ()->Join (channel.Tags_));
+				StorageBackendManager::Instance ().GetTagsManager ()->Join (channel.Tags_));
 		UpdateChannel_.bindValue (":language", channel.Language_);
 		UpdateChannel_.bindValue (":author", channel.Author_);
 		UpdateChannel_.bindValue (":pixmap_url", channel.PixmapURL_);
@@ -1391,7 +1730,7 @@ namespace Aggregator
 
 		UpdateShortChannel_.bindValue (":channel_id", channel.ChannelID_);
 		UpdateShortChannel_.bindValue (":last_build", channel.LastBuild_);
-		UpdateShortChannel_.bindValue (":tags", Core::Instance ().GetProxy ()->GetTagsManager ()->Join (channel.Tags_));
+		UpdateShortChannel_.bindValue (":tags", StorageBackendManager::Instance ().GetTagsManager ()->Join (channel.Tags_));
 		UpdateShortChannel_.bindValue (":display_title", channel.DisplayTitle_);
 
 		if (!UpdateShortChannel_.exec ())
@@ -1415,6 +1754,17 @@ namespace Aggregator
 	}
 
 	void SQLStorageBackend::UpdateItem (const Item& item)
+	{
+		WriteUpdatedItem (item);
+
+		if (const auto& channel = GetChannel (item.ChannelID_))
+		{
+			emit itemDataUpdated (item, *channel);
+			emit channelDataUpdated (*channel);
+		}
+	}
+
+	void SQLStorageBackend::WriteUpdatedItem (const Item& item)
 	{
 		UpdateItem_.bindValue (":item_id", item.ItemID_);
 		UpdateItem_.bindValue (":description", item.Description_);
@@ -1447,12 +1797,54 @@ namespace Aggregator
 
 		WriteEnclosures (item.Enclosures_);
 		WriteMRSSEntries (item.MRSSEntries_);
+	}
+
+	bool SQLStorageBackend::MergeItems (const ItemsMerge& merge)
+	{
+		QSet<IDType_t> removedIds;
 
-		if (const auto& channel = GetChannel (item.ChannelID_))
 		{
-			emit itemDataUpdated (item, *channel);
-			emit channelDataUpdated (*channel);
+			Util::DBLock lock (DB_);
+			try
+			{
+				lock.Init ();
+
+				for (const auto& item : merge.Added_)
+					WriteNewItem (item);
+				for (const auto& item : merge.Updated_)
+					WriteUpdatedItem (item);
+
+				removedIds = TrimChannelItems (merge.ChannelID_, merge.TrimDays_, merge.TrimNumber_);
+			}
+			catch (const std::runtime_error& e)
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "unable to merge items into"
+						<< merge.ChannelID_
+						<< e.what ();
+				return false;
+			}
+
+			lock.Good ();
 		}
+
+		const auto& channel = GetChannel (merge.ChannelID_);
+		if (!channel)
+			return true;
+
+		for (const auto& item : merge.Added_)
+			if (!removedIds.contains (item.ItemID_))
+				emit itemDataUpdated (item, *channel);
+		for (const auto& item : merge.Updated_)
+			if (!removedIds.contains (item.ItemID_))
+				emit itemDataUpdated (item, *channel);
+
+		if (!removedIds.isEmpty ())
+			emit itemsRemoved (removedIds);
+
+		emit channelDataUpdated (*channel);
+
+		return true;
 	}
 
 	void SQLStorageBackend::UpdateItem (const ItemShort& item)
@@ -1495,7 +1887,7 @@ namespace Aggregator
 		InsertChannel_.bindValue (":description", channel.Description_);
 		InsertChannel_.bindValue (":last_build", channel.LastBuild_);
 		InsertChannel_.bindValue (":tags",
-				Core::Instance ().GetProxy ()->GetTagsManager ()->Join (channel.Tags_));
+				StorageBackendManager::Instance ().GetTagsManager ()->Join (channel.Tags_));
 		InsertChannel_.bindValue (":language", channel.Language_);
 		InsertChannel_.bindValue (":author", channel.Author_);
 		InsertChannel_.bindValue (":pixmap_url", channel.PixmapURL_);
@@ -1523,6 +1915,17 @@ namespace Aggregator
 	}
 
 	void SQLStorageBackend::AddItem (const Item& item)
+	{
+		WriteNewItem (item);
+
+		if (const auto& channel = GetChannel (item.ChannelID_))
+		{
+			emit itemDataUpdated (item, *channel);
+			emit channelDataUpdated (*channel);
+		}
+	}
+
+	void SQLStorageBackend::WriteNewItem (const Item& item)
 	{
 		InsertItem_.bindValue (":item_id", item.ItemID_);
 		InsertItem_.bindValue (":channel_id", item.ChannelID_);
@@ -1556,12 +1959,6 @@ namespace Aggregator
 
 		WriteEnclosures (item.Enclosures_);
 		WriteMRSSEntries (item.MRSSEntries_);
-
-		if (const auto& channel = GetChannel (item.ChannelID_))
-		{
-			emit itemDataUpdated (item, *channel);
-			emit channelDataUpdated (*channel);
-		}
 	}
 
 	namespace
@@ -1815,6 +2212,41 @@ namespace Aggregator
 			}
 		}
 
+		if (!tables.contains ("feeds_validators"))
+		{
+			if (!query.exec (QString ("CREATE TABLE feeds_validators ("
+							"feed_id BIGINT UNIQUE REFERENCES feeds ON DELETE CASCADE, "
+							"etag TEXT, "
+							"last_modified TEXT, "
+							"body_hash %1, "
+							"body_size BIGINT"
+							");").arg (GetBlobType ())))
+			{
+				Util::DBLock::DumpError (query);
+				return false;
+			}
+
+			if (Type_ == SBPostgres)
+			{
+				if (!query.exec ("CREATE RULE \"replace_feeds_validators\" AS "
+									"ON INSERT TO \"feeds_validators\" "
+									"WHERE "
+										"EXISTS (SELECT 1 FROM feeds_validators "
+											"WHERE feed_id = NEW.feed_id) "
+									"DO INSTEAD "
+										"(UPDATE feeds_validators SET "
+											"etag = NEW.etag, "
+											"last_modified = NEW.last_modified, "
+											"body_hash = NEW.body_hash, "
+											"body_size = NEW.body_size "
+											"WHERE feed_id = NEW.feed_id)"))
+				{
+					Util::DBLock::DumpError (query);
+					return false;
+				}
+			}
+		}
+
 		if (!tables.contains ("channels"))
 		{
 			if (!query.exec (QString ("CREATE TABLE channels ("
@@ -2172,6 +2604,67 @@ namespace Aggregator
 			}
 		}
 
+		if (Type_ == SBSQLite)
+			HasFTS_ = InitializeFTS (tables);
+
+		return true;
+	}
+
+	bool SQLStorageBackend::InitializeFTS (const QStringList& tables)
+	{
+		if (tables.contains ("items_fts"))
+			return true;
+
+		Util::DBLock lock (DB_);
+		try
+		{
+			lock.Init ();
+		}
+		catch (const std::runtime_error& e)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< e.what ();
+			return false;
+		}
+
+		const QStringList queries
+		{
+			"CREATE VIRTUAL TABLE items_fts USING fts5 ("
+				"title, "
+				"description, "
+				"author, "
+				"category, "
+				"content = 'items', "
+				"content_rowid = 'item_id'"
+				");",
+			"CREATE TRIGGER items_fts_insert AFTER INSERT ON items BEGIN "
+				"INSERT INTO items_fts (rowid, title, description, author, category) "
+				"VALUES (new.item_id, new.title, new.description, new.author, new.category); "
+				"END;",
+			"CREATE TRIGGER items_fts_delete AFTER DELETE ON items BEGIN "
+				"INSERT INTO items_fts (items_fts, rowid, title, description, author, category) "
+				"VALUES ('delete', old.item_id, old.title, old.description, old.author, old.category); "
+				"END;",
+			"CREATE TRIGGER items_fts_update AFTER UPDATE OF title, description, author, category ON items BEGIN "
+				"INSERT INTO items_fts (items_fts, rowid, title, description, author, category) "
+				"VALUES ('delete', old.item_id, old.title, old.description, old.author, old.category); "
+				"INSERT INTO items_fts (rowid, title, description, author, category) "
+				"VALUES (new.item_id, new.title, new.description, new.author, new.category); "
+				"END;",
+			"INSERT INTO items_fts (items_fts) VALUES ('rebuild');"
+		};
+
+		QSqlQuery query (DB_);
+		for (const auto& queryStr : queries)
+			if (!query.exec (queryStr))
+			{
+				Util::DBLock::DumpError (query);
+				qWarning () << Q_FUNC_INFO
+						<< "unable to create the full-text index, falling back to plain search";
+				return false;
+			}
+
+		lock.Good ();
 		return true;
 	}
 
@@ -46,6 +46,8 @@ namespace Aggregator
 		QSqlDatabase DB_;
 
 		const Type Type_;
+
+		bool HasFTS_ = false;
 							/** Returns:
 							 * - last_update
 							 *
@@ -77,6 +79,24 @@ namespace Aggregator
 							 * - item_age
 							 */
 							FeedSettingsSetter_,
+							/** Returns:
+							 * - etag
+							 * - last_modified
+							 * - body_hash
+							 * - body_size
+							 *
+							 * Binds:
+							 * - feed_id
+							 */
+							FeedValidatorsGetter_,
+							/** Binds:
+							 * - feed_id
+							 * - etag
+							 * - last_modified
+							 * - body_hash
+							 * - body_size
+							 */
+							FeedValidatorsSetter_,
 							/** Returns:
 							 * - channel_id
 							 * - title
@@ -125,6 +145,15 @@ namespace Aggregator
 							 * - channel_id
 							 */
 							ItemsShortSelector_,
+							/** Returns:
+							 * - item_id
+							 * - title
+							 * - url
+							 *
+							 * Binds:
+							 * - channel_id
+							 */
+							ItemsIndexSelector_,
 							/** Returns:
 							 * - title
 							 * - url
@@ -571,7 +600,38 @@ namespace Aggregator
 							 * Binds:
 							 * - tag
 							 */
-							GetItemsForTag_;
+							GetItemsForTag_,
+							/** Returns:
+							 * - item_id
+							 * - rank
+							 * - snippet
+							 * - title
+							 * - description
+							 * - author
+							 * - category
+							 *
+							 * Binds:
+							 * - query
+							 * - limit
+							 * - offset
+							 */
+							SearchItems_,
+							/** Returns:
+							 * - item_id
+							 * - rank
+							 * - snippet
+							 * - title
+							 * - description
+							 * - author
+							 * - category
+							 *
+							 * Binds:
+							 * - query
+							 * - channel_id
+							 * - limit
+							 * - offset
+							 */
+							SearchChannelItems_;
 	public:
 		SQLStorageBackend (Type, const QString&);
 		~SQLStorageBackend ();
@@ -583,11 +643,14 @@ namespace Aggregator
 		IDType_t FindFeed (const QString&) const override;
 		boost::optional<Feed::FeedSettings> GetFeedSettings (const IDType_t&) const override;
 		void SetFeedSettings (const Feed::FeedSettings&) override;
+		boost::optional<FeedValidators> GetFeedValidators (const IDType_t&) const override;
+		void SetFeedValidators (const FeedValidators&) override;
 		channels_shorts_t GetChannels (const IDType_t&) const override;
 		boost::optional<Channel> GetChannel (const IDType_t&) const override;
 		IDType_t FindChannel (const QString& , const QString&, const IDType_t&) const override;
 		void TrimChannel (const IDType_t&, int, int) override;
 		items_shorts_t GetItems (const IDType_t&) const override;
+		ChannelItemsIndex GetChannelItemsIndex (const IDType_t&) const override;
 		int GetUnreadItems (const IDType_t&) const override;
 		boost::optional<Item> GetItem (const IDType_t&) const override;
 		boost::optional<IDType_t> FindItem (const QString&, const QString&, const IDType_t&) const override;
@@ -600,6 +663,7 @@ namespace Aggregator
 		void UpdateChannel (const ChannelShort&) override;
 		void UpdateItem (const Item&) override;
 		void UpdateItem (const ItemShort&) override;
+		bool MergeItems (const ItemsMerge&) override;
 		void AddChannel (const Channel&) override;
 		void AddItem (const Item&) override;
 		void RemoveItems (const QSet<IDType_t>&) override;
@@ -614,14 +678,30 @@ namespace Aggregator
 		void SetItemTags (const IDType_t&, const QList<ITagsManager::tag_id>&) override;
 		QList<IDType_t> GetItemsForTag (const ITagsManager::tag_id&) override;
 
+		QList<ItemSearchResult> SearchItems (const ItemSearchParams&) const override;
+
 		IDType_t GetHighestID (const PoolType&) const override;
 	private:
 		QString GetBlobType () const;
 		bool InitializeTables ();
+		bool InitializeFTS (const QStringList&);
+
+		struct SearchCandidate
+		{
+			ItemSearchResult Result_;
+			QStringList Fields_;
+		};
+		QList<SearchCandidate> SearchItemsFTS (const QString&, const boost::optional<IDType_t>&, int, int) const;
+		QList<SearchCandidate> SearchItemsLike (const QStringList&, const boost::optional<IDType_t>&, int, int) const;
+		QList<ItemSearchResult> SearchItemsFixed (const ItemSearchParams&) const;
+
 		QByteArray SerializePixmap (const QImage&) const;
 		QImage UnserializePixmap (const QByteArray&) const;
 
 		void FillItem (const QSqlQuery&, Item&) const;
+		void WriteNewItem (const Item&);
+		void WriteUpdatedItem (const Item&);
+		QSet<IDType_t> TrimChannelItems (const IDType_t&, int, int);
 		void WriteEnclosures (const QList<Enclosure>&);
 		void GetEnclosures (const IDType_t&, QList<Enclosure>&) const;
 		void WriteMRSSEntries (const QList<MRSSEntry>&);
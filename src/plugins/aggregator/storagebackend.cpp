@@ -53,6 +53,40 @@ namespace Aggregator
 		return Create (type, id);
 	}
 
+	void StorageBackend::ChannelItemsIndex::Add (IDType_t id, const QString& title, const QString& link)
+	{
+		const auto addNew = [id] (auto& hash, const auto& key)
+		{
+			if (!hash.contains (key))
+				hash [key] = id;
+		};
+
+		addNew (ByTitleLink_, qMakePair (title, link));
+		if (!link.isEmpty ())
+			addNew (ByLink_, link);
+		addNew (ByTitle_, title);
+	}
+
+	boost::optional<IDType_t> StorageBackend::ChannelItemsIndex::Find (const QString& title, const QString& link) const
+	{
+		const auto titleLinkPos = ByTitleLink_.find (qMakePair (title, link));
+		if (titleLinkPos != ByTitleLink_.end ())
+			return *titleLinkPos;
+
+		if (!link.isEmpty ())
+		{
+			const auto linkPos = ByLink_.find (link);
+			if (linkPos != ByLink_.end ())
+				return *linkPos;
+			return {};
+		}
+
+		const auto titlePos = ByTitle_.find (title);
+		if (titlePos != ByTitle_.end ())
+			return *titlePos;
+		return {};
+	}
+
 	StorageBackend_ptr StorageBackend::Create (Type type, const QString& id)
 	{
 		StorageBackend_ptr result;
@@ -32,6 +32,7 @@
 #include <boost/optional.hpp>
 #include <QObject>
 #include <QSet>
+#include <QHash>
 #include <interfaces/core/ihookproxy.h>
 #include <interfaces/core/itagsmanager.h>
 #include "feed.h"
@@ -55,6 +56,139 @@ namespace Aggregator
 		struct ChannelNotFoundError {};
 		struct ItemNotFoundError {};
 
+		/** @brief In-memory index of the items stored in a channel.
+		 *
+		 * Maps the identifying fields of the items to their IDs so that
+		 * a whole freshly parsed channel could be classified into new
+		 * and already known items without querying the storage for each
+		 * item.
+		 *
+		 * @sa GetChannelItemsIndex()
+		 */
+		struct ChannelItemsIndex
+		{
+			QHash<QPair<QString, QString>, IDType_t> ByTitleLink_;
+			QHash<QString, IDType_t> ByLink_;
+			QHash<QString, IDType_t> ByTitle_;
+
+			/** @brief Registers the item with the given title and link.
+			 *
+			 * If there is already an item with the same key, the old
+			 * mapping is preserved.
+			 */
+			void Add (IDType_t id, const QString& title, const QString& link);
+
+			/** @brief Finds an item just like FindItem(),
+			 * FindItemByLink() and FindItemByTitle() would do in turn.
+			 */
+			boost::optional<IDType_t> Find (const QString& title, const QString& link) const;
+		};
+
+		/** @brief Describes a merge of a parsed channel into the storage.
+		 *
+		 * @sa MergeItems()
+		 */
+		struct ItemsMerge
+		{
+			IDType_t ChannelID_;
+
+			/** @brief Items that are not in the storage yet.
+			 */
+			QList<Item> Added_;
+
+			/** @brief Already stored items with their updated contents.
+			 */
+			QList<Item> Updated_;
+
+			/** @brief Max age of the items in days, as in TrimChannel().
+			 */
+			int TrimDays_;
+
+			/** @brief Max number of the items, as in TrimChannel().
+			 */
+			int TrimNumber_;
+		};
+
+		/** @brief A single hit of the full-text items search.
+		 *
+		 * @sa SearchItems()
+		 */
+		struct ItemSearchResult
+		{
+			IDType_t ItemID_;
+
+			/** @brief The relevance of the hit, the lower the better.
+			 */
+			double Rank_;
+
+			/** @brief The fragment of the item around the matched terms
+			 * with the terms wrapped into <code>&lt;b&gt;</code>.
+			 */
+			QString Snippet_;
+		};
+
+		/** @brief The parameters of the items search.
+		 *
+		 * @sa SearchItems()
+		 */
+		struct ItemSearchParams
+		{
+			/** @brief The text to search for.
+			 */
+			QString Text_;
+
+			/** @brief The channel to search in, or all the channels if
+			 * not set.
+			 */
+			boost::optional<IDType_t> ChannelID_;
+
+			/** @brief Whether the text should be matched literally.
+			 *
+			 * If set, the whole text should be found as is (respecting
+			 * CaseSensitivity_) in one of the searched fields of an item.
+			 * Otherwise, each word of the text is matched as a prefix of
+			 * some word of the item, ignoring the case.
+			 */
+			bool FixedString_ = false;
+
+			/** @brief The case sensitivity of the fixed string matching.
+			 */
+			Qt::CaseSensitivity CaseSensitivity_ = Qt::CaseInsensitive;
+
+			/** @brief The number of the hits to skip.
+			 */
+			int Offset_ = 0;
+
+			/** @brief The maximum number of the hits to return.
+			 */
+			int Limit_ = 100;
+		};
+
+		/** @brief The HTTP validators of the last parsed body of a feed.
+		 *
+		 * @sa GetFeedValidators(), SetFeedValidators()
+		 */
+		struct FeedValidators
+		{
+			IDType_t FeedID_;
+
+			/** @brief The raw value of the ETag header.
+			 */
+			QByteArray ETag_;
+
+			/** @brief The raw value of the Last-Modified header.
+			 */
+			QByteArray LastModified_;
+
+			/** @brief The hash of the body.
+			 */
+			QByteArray BodyHash_;
+
+			/** @brief The size of the body in bytes.
+			 */
+			qint64 BodySize_ = 0;
+		};
+
 		enum Type
 		{
 			SBSQLite,
@@ -117,6 +251,22 @@ namespace Aggregator
 		 */
 		virtual void SetFeedSettings (const Feed::FeedSettings& settings) = 0;
 
+		/** @brief Returns the validators of the feed's last parsed body.
+		 *
+		 * @param[in] feed Feed's ID.
+		 * @return The validators, or an empty optional if none have been
+		 * stored for the feed.
+		 */
+		virtual boost::optional<FeedValidators> GetFeedValidators (const IDType_t& feed) const = 0;
+
+		/** @brief Sets the validators of the feed's last parsed body.
+		 *
+		 * Replaces the old validators if they exist.
+		 *
+		 * @param[in] validators New feed's validators.
+		 */
+		virtual void SetFeedValidators (const FeedValidators& validators) = 0;
+
 		/** @brief Get all the channels of a feed in the container.
 		 *
 		 * Returns short information about channels in the storage which
@@ -173,6 +323,19 @@ namespace Aggregator
 		 */
 		virtual items_shorts_t GetItems (const IDType_t& channelId) const = 0;
 
+		/** @brief Returns the index of the items in the given channel.
+		 *
+		 * The index is built with a single query and is intended to be
+		 * used instead of calling FindItem(), FindItemByLink() and
+		 * FindItemByTitle() for each item of an updated channel.
+		 *
+		 * @param[in] channelId The ID of the channel.
+		 * @return The index of the items in the channel.
+		 *
+		 * @sa MergeItems()
+		 */
+		virtual ChannelItemsIndex GetChannelItemsIndex (const IDType_t& channelId) const = 0;
+
 		/** @brief Counts unread items number in a given channel.
 		 *
 		 * A possibly optimized version of getting items via
@@ -340,6 +503,20 @@ namespace Aggregator
 		 */
 		virtual void UpdateItem (const ItemShort& item) = 0;
 
+		/** @brief Writes the results of a channel update in one go.
+		 *
+		 * Adds the new items, updates the existing ones and then trims the
+		 * channel, all in a single transaction. This is equivalent to
+		 * calling AddItem(), UpdateItem() and TrimChannel(), but the
+		 * channelDataUpdated() signal is emitted only once.
+		 *
+		 * If any of the writes fails, the whole merge is rolled back.
+		 *
+		 * @param[in] merge The items to be written.
+		 * @return Whether the merge has been committed.
+		 */
+		virtual bool MergeItems (const ItemsMerge& merge) = 0;
+
 		/** @brief Removes an already existing item.
 		 *
 		 * This function emits channelDataUpdated() and itemsRemoved()
@@ -422,6 +599,20 @@ namespace Aggregator
 		virtual void SetItemTags (const IDType_t& id, const QList<ITagsManager::tag_id>& tags) = 0;
 		virtual QList<IDType_t> GetItemsForTag (const ITagsManager::tag_id& tag) = 0;
 
+		/** @brief Performs a full-text search over the stored items.
+		 *
+		 * The titles, descriptions, authors and categories of the items
+		 * are searched according to the params, see ItemSearchParams
+		 * for details.
+		 *
+		 * This function may take a while, so it's better to call it
+		 * off the GUI thread.
+		 *
+		 * @param[in] params The parameters of the search.
+		 * @return The hits, most relevant first.
+		 */
+		virtual QList<ItemSearchResult> SearchItems (const ItemSearchParams& params) const = 0;
+
 		/** @brief Searches for highest id of given type in the database
 		 *
 		 * @param[in] type of id to find
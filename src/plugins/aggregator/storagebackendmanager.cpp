@@ -103,6 +103,16 @@ namespace Aggregator
 		}
 	}
 
+	void StorageBackendManager::SetTagsManager (const ITagsManager *tm)
+	{
+		TagsManager_ = tm;
+	}
+
+	const ITagsManager* StorageBackendManager::GetTagsManager () const
+	{
+		return TagsManager_;
+	}
+
 	void StorageBackendManager::Register (const StorageBackend_ptr& backend)
 	{
 		auto backendPtr = backend.get ();
@@ -34,6 +34,8 @@
 #include <util/sll/eitherfwd.h>
 #include "storagebackend.h"
 
+class ITagsManager;
+
 namespace LeechCraft
 {
 class StorageBackend;
@@ -45,6 +47,7 @@ namespace Aggregator
 		Q_OBJECT
 
 		StorageBackend_ptr PrimaryStorageBackend_;
+		const ITagsManager *TagsManager_ = nullptr;
 
 		StorageBackendManager () = default;
 	public:
@@ -64,6 +67,13 @@ namespace Aggregator
 		StorageBackend_ptr MakeStorageBackendForThread () const;
 
 		void Register (const StorageBackend_ptr&);
+
+		/** @brief Sets the tags manager used to store channels tags.
+		 *
+		 * This should be called before any storage is created.
+		 */
+		void SetTagsManager (const ITagsManager*);
+		const ITagsManager* GetTagsManager () const;
 	signals:
 		void channelAdded (const Channel& channel) const;
 
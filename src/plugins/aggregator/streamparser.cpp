@@ -0,0 +1,535 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "streamparser.h"
+#include <algorithm>
+#include <QHash>
+#include <QObject>
+#include <QXmlStreamReader>
+#include <QtDebug>
+#include <util/sll/prelude.h>
+#include "feedelements.h"
+#include "parser.h"
+#include "rssparser.h"
+
+namespace LeechCraft
+{
+namespace Aggregator
+{
+	bool StreamParser::ReadToRoot (QXmlStreamReader& reader)
+	{
+		while (!reader.atEnd ())
+			if (reader.readNext () == QXmlStreamReader::StartElement)
+				return true;
+		return false;
+	}
+
+	channels_container_t StreamParser::ParseFeed (QXmlStreamReader& reader,
+			const IDType_t& feedId) const
+	{
+		auto channels = Parse (reader, feedId);
+		for (const auto& channel : channels)
+		{
+			if (channel->Link_.isEmpty ())
+			{
+				qWarning () << Q_FUNC_INFO
+					<< "detected empty link for"
+					<< channel->Title_;
+				channel->Link_ = "about:blank";
+			}
+			for (const auto& item : channel->Items_)
+				item->Title_ = item->Title_.trimmed ().simplified ();
+		}
+		return channels;
+	}
+
+	QString StreamParser::AuthorTracker::GetAuthor () const
+	{
+		if (ITunes_)
+			return *ITunes_;
+		if (DC_)
+			return *DC_;
+		return Plain_.get_value_or (QString {});
+	}
+
+	namespace
+	{
+		int FirstSelfOrDescendant (const FeedElements& elems, int elem,
+				const QString& ns, const QString& name)
+		{
+			if (elems.NS (elem) == ns && elems.Name (elem) == name)
+				return elem;
+			return elems.FirstByTagNameNS (elem, ns, name);
+		}
+	}
+
+	void StreamParser::TrackAuthor (AuthorTracker& tracker, const FeedElements& elems, int elem) const
+	{
+		auto track = [&] (boost::optional<QString>& field, int found)
+		{
+			if (!field && found >= 0)
+				field = elems.Text (found);
+		};
+
+		track (tracker.ITunes_, FirstSelfOrDescendant (elems, elem, Parser::ITunes_, "author"));
+		track (tracker.DC_, FirstSelfOrDescendant (elems, elem, Parser::DC_, "creator"));
+
+		if (elems.Name (elem) == "author")
+			track (tracker.Plain_, elem);
+		else if (const auto& plain = elems.ByTagName (elem, "author"); !plain.isEmpty ())
+			track (tracker.Plain_, plain.first ());
+	}
+
+	const QString& StreamParser::RDF ()
+	{
+		return Parser::RDF_;
+	}
+
+	namespace
+	{
+		QStringList Texts (const FeedElements& elems, const QVector<int>& indexes)
+		{
+			QStringList result;
+			result.reserve (indexes.size ());
+			for (const auto idx : indexes)
+				result << elems.Text (idx);
+			return result;
+		}
+
+		QString FirstText (const FeedElements& elems, const QVector<int>& indexes)
+		{
+			return indexes.isEmpty () ? QString {} : elems.Text (indexes.first ());
+		}
+	}
+
+	QString StreamParser::GetDescription (const FeedElements& elems, int parent) const
+	{
+		const auto& texts = Texts (elems, elems.ByTagNameNS (parent, Parser::Content_, "encoded")) +
+				Texts (elems, elems.ByTagNameNS (parent, Parser::ITunes_, "summary"));
+
+		if (texts.isEmpty ())
+			return {};
+
+		return *std::max_element (texts.begin (), texts.end (), Util::ComparingBy (&QString::size));
+	}
+
+	void StreamParser::GetDescription (const FeedElements& elems, int parent, QString& cand) const
+	{
+		const auto& extContent = GetDescription (elems, parent);
+		if (extContent.size () > cand.size ())
+			cand = extContent;
+	}
+
+	QString StreamParser::GetLink (const FeedElements& elems, int parent) const
+	{
+		for (const auto link : elems.Children (parent, "link"))
+		{
+			if (elems.HasAttribute (link, "rel") && elems.Attribute (link, "rel") != "alternate")
+				continue;
+
+			return elems.HasAttribute (link, "href") ?
+					elems.Attribute (link, "href") :
+					elems.Text (link);
+		}
+		return {};
+	}
+
+	QString StreamParser::GetAuthor (const FeedElements& elems, int parent) const
+	{
+		if (const auto itunes = elems.FirstByTagNameNS (parent, Parser::ITunes_, "author"); itunes >= 0)
+			return elems.Text (itunes);
+		if (const auto dc = elems.FirstByTagNameNS (parent, Parser::DC_, "creator"); dc >= 0)
+			return elems.Text (dc);
+		return FirstText (elems, elems.ByTagName (parent, "author"));
+	}
+
+	QString StreamParser::GetCommentsRSS (const FeedElements& elems, int parent) const
+	{
+		return elems.Text (elems.FirstByTagNameNS (parent, Parser::WFW_, "commentRss"));
+	}
+
+	QString StreamParser::GetCommentsLink (const FeedElements& elems, int parent) const
+	{
+		return elems.Text (elems.FirstByTagNameNS (parent, "", "comments"));
+	}
+
+	int StreamParser::GetNumComments (const FeedElements& elems, int parent) const
+	{
+		const auto comments = elems.FirstByTagNameNS (parent, Parser::Slash_, "comments");
+		return comments >= 0 ? elems.Text (comments).toInt () : -1;
+	}
+
+	boost::optional<QString> StreamParser::GetITunesDuration (const FeedElements& elems, int parent) const
+	{
+		const auto duration = elems.FirstByTagNameNS (parent, Parser::ITunes_, "duration");
+		if (duration < 0)
+			return {};
+		return elems.Text (duration);
+	}
+
+	QDateTime StreamParser::GetDCDateTime (const FeedElements& elems, int parent) const
+	{
+		const auto date = elems.FirstByTagNameNS (parent, Parser::DC_, "date");
+		return date >= 0 ? FromRFC3339 (elems.Text (date)) : QDateTime {};
+	}
+
+	QStringList StreamParser::GetAllCategories (const FeedElements& elems, int parent) const
+	{
+		auto dc = Texts (elems, elems.ByTagNameNS (parent, Parser::DC_, "subject"));
+		dc.removeAll ("");
+
+		auto plain = Texts (elems, elems.ByTagName (parent, "category"));
+		plain.removeAll ("");
+
+		QStringList itunes;
+		for (const auto& keywords : Texts (elems, elems.ByTagNameNS (parent, Parser::ITunes_, "keywords")))
+			itunes += QObject::tr ("Podcast %1").arg (keywords);
+		itunes.removeAll ("");
+
+		return dc + plain + itunes;
+	}
+
+	QList<Enclosure> StreamParser::GetEncEnclosures (const FeedElements& elems,
+			int parent, const IDType_t& itemId) const
+	{
+		QList<Enclosure> result;
+		for (const auto link : elems.ByTagNameNS (parent, Parser::Enc_, "enclosure"))
+		{
+			Enclosure e (itemId);
+			e.URL_ = elems.AttributeNS (link, Parser::RDF_, "resource");
+			e.Type_ = elems.AttributeNS (link, Parser::Enc_, "type");
+			e.Length_ = elems.AttributeNS (link, Parser::Enc_, "length", "-1").toLongLong ();
+			e.Lang_ = "";
+			result << e;
+		}
+		return result;
+	}
+
+	QPair<double, double> StreamParser::GetGeoPoint (const FeedElements& elems, int parent) const
+	{
+		const auto lat = elems.FirstByTagNameNS (parent, Parser::GeoRSSW3_, "lat");
+		const auto lon = elems.FirstByTagNameNS (parent, Parser::GeoRSSW3_, "long");
+		if (lat >= 0 && lon >= 0)
+			return { elems.Text (lat).toDouble (), elems.Text (lon).toDouble () };
+
+		const auto point = elems.FirstByTagNameNS (parent, Parser::GeoRSSSimple_, "point");
+		if (point >= 0)
+		{
+			const auto& splitted = elems.Text (point).split (' ', QString::KeepEmptyParts);
+			if (splitted.size () == 2)
+				return { splitted.at (0).toDouble (), splitted.at (1).toDouble () };
+		}
+
+		return { 0, 0 };
+	}
+
+	class StreamMRSSParser
+	{
+		const FeedElements& Elems_;
+		const QString& NS_ = Parser::MediaRSS_;
+
+		QHash<int, MRSSLocatedData> Cache_;
+	public:
+		StreamMRSSParser (const FeedElements& elems)
+		: Elems_ { elems }
+		{
+		}
+
+		QList<MRSSEntry> Parse (const IDType_t& itemId, const MRSSLocatedData& context)
+		{
+			QList<MRSSEntry> result;
+			for (const auto group : Elems_.ByTagNameNS (0, NS_, "group"))
+				result += CollectChildren (group, itemId, context);
+			result += CollectChildren (0, itemId, context);
+			return result;
+		}
+
+		/** The resulting data is shared between all the entries below
+		 * the element, so it only has placeholder IDs that are
+		 * replaced by MRSSLocatedData::ForEntry().
+		 */
+		MRSSLocatedData Collect (int element)
+		{
+			const auto pos = Cache_.find (element);
+			if (pos != Cache_.end ())
+				return *pos;
+
+			MRSSLocatedData result;
+			result.URL_ = GetURL (element);
+			result.Title_ = GetUnescaped (element, "title");
+			result.Description_ = GetUnescaped (element, "description");
+			if (const auto keywords = FirstChild (element, "keywords"); keywords >= 0)
+				result.Keywords_ = Elems_.Text (keywords);
+
+			if (const auto rating = FirstChild (element, "rating"); rating >= 0)
+			{
+				result.Rating_ = Elems_.Text (rating);
+				result.RatingScheme_ = Elems_.Attribute (rating, "scheme", "urn:simple");
+			}
+
+			if (const auto copyright = FirstChild (element, "copyright"); copyright >= 0)
+			{
+				result.CopyrightText_ = Elems_.Text (copyright);
+				if (Elems_.HasAttribute (copyright, "url"))
+					result.CopyrightURL_ = Elems_.Attribute (copyright, "url");
+			}
+
+			if (const auto comm = FirstChild (element, "community"); comm >= 0)
+			{
+				if (const auto stars = Elems_.FirstByTagNameNS (comm, NS_, "starRating"); stars >= 0)
+				{
+					result.RatingAverage_ = GetInt (stars, "average");
+					result.RatingCount_ = GetInt (stars, "count");
+					result.RatingMin_ = GetInt (stars, "min");
+					result.RatingMax_ = GetInt (stars, "max");
+				}
+
+				if (const auto stat = Elems_.FirstByTagNameNS (comm, NS_, "statistics"); stat >= 0)
+				{
+					result.Views_ = GetInt (stat, "views");
+					result.Favs_ = GetInt (stat, "favorites");
+				}
+
+				if (const auto tags = Elems_.FirstByTagNameNS (comm, NS_, "tags"); tags >= 0)
+					result.Tags_ = Elems_.Text (tags);
+			}
+
+			result.Thumbnails_ = GetThumbnails (element);
+			result.Credits_ = GetCredits (element);
+			result.Comments_ = GetComments (element);
+			result.PeerLinks_ = GetPeerLinks (element);
+			result.Scenes_ = GetScenes (element);
+
+			Cache_ [element] = result;
+			return result;
+		}
+	private:
+		QList<MRSSEntry> CollectChildren (int holder, const IDType_t& itemId, const MRSSLocatedData& context)
+		{
+			QList<MRSSEntry> result;
+			for (const auto en : Elems_.ByTagNameNS (holder, NS_, "content"))
+			{
+				MRSSEntry entry (itemId);
+
+				QVector<int> parents;
+				for (auto parent = en; parent >= 0; parent = Elems_.Parent (parent))
+					parents.prepend (parent);
+
+				auto d = context;
+				for (const auto parent : parents)
+					d += Collect (parent);
+				d = d.ForEntry (entry.MRSSEntryID_);
+
+				if (Elems_.HasAttribute (en, "url"))
+					entry.URL_ = Elems_.Attribute (en, "url");
+				else
+				{
+					const auto player = Elems_.FirstByTagNameNS (en, NS_, "player");
+					if (player < 0)
+						qWarning () << Q_FUNC_INFO
+							<< "bad feed with no players and urls";
+					entry.URL_ = Elems_.Attribute (player, "url");
+				}
+
+				entry.Size_ = Elems_.Attribute (en, "fileSize").toInt ();
+				entry.Type_ = Elems_.Attribute (en, "type");
+				entry.Medium_ = Elems_.Attribute (en, "medium");
+				entry.IsDefault_ = (Elems_.Attribute (en, "isDefault") == "true");
+				entry.Expression_ = Elems_.Attribute (en, "expression");
+				if (entry.Expression_.isEmpty ())
+					entry.Expression_ = "full";
+				entry.Bitrate_ = Elems_.Attribute (en, "bitrate").toInt ();
+				entry.Framerate_ = Elems_.Attribute (en, "framerate").toDouble ();
+				entry.SamplingRate_ = Elems_.Attribute (en, "samplingrate").toDouble ();
+				entry.Channels_ = Elems_.Attribute (en, "channels").toInt ();
+				entry.Duration_ = Elems_.Attribute (en, "duration").toInt ();
+				entry.Width_ = Elems_.Attribute (en, "width").toInt ();
+				entry.Height_ = Elems_.Attribute (en, "height").toInt ();
+				entry.Lang_ = Elems_.Attribute (en, "lang");
+
+				d.FillEntry (entry);
+
+				result << entry;
+			}
+			return result;
+		}
+
+		int FirstChild (int element, const QString& name) const
+		{
+			const auto& children = Elems_.ChildrenNS (element, NS_, name);
+			return children.isEmpty () ? -1 : children.first ();
+		}
+
+		boost::optional<QString> GetURL (int element) const
+		{
+			const auto player = FirstChild (element, "player");
+			if (player < 0)
+				return {};
+			return Elems_.Attribute (player, "url");
+		}
+
+		boost::optional<QString> GetUnescaped (int element, const QString& name) const
+		{
+			const auto child = FirstChild (element, name);
+			if (child < 0)
+				return {};
+			return Parser::UnescapeHTML (Elems_.Text (child));
+		}
+
+		boost::optional<int> GetInt (int elem, const QString& attrname) const
+		{
+			if (!Elems_.HasAttribute (elem, attrname))
+				return {};
+
+			bool ok = false;
+			const auto result = Elems_.Attribute (elem, attrname).toInt (&ok);
+			if (!ok)
+				return {};
+			return result;
+		}
+
+		QList<MRSSThumbnail> GetThumbnails (int element) const
+		{
+			QList<MRSSThumbnail> result;
+			for (const auto thumbNode : Elems_.ChildrenNS (element, NS_, "thumbnail"))
+			{
+				MRSSThumbnail thumb (0, 0);
+				thumb.URL_ = Elems_.Attribute (thumbNode, "url");
+				thumb.Width_ = GetInt (thumbNode, "width").get_value_or (0);
+				thumb.Height_ = GetInt (thumbNode, "height").get_value_or (0);
+				thumb.Time_ = Elems_.Attribute (thumbNode, "time");
+				result << thumb;
+			}
+			return result;
+		}
+
+		QList<MRSSCredit> GetCredits (int element) const
+		{
+			QList<MRSSCredit> result;
+			for (const auto creditNode : Elems_.ChildrenNS (element, NS_, "credit"))
+			{
+				if (!Elems_.HasAttribute (creditNode, "role"))
+					continue;
+
+				MRSSCredit credit (0, 0);
+				credit.Role_ = Elems_.Attribute (creditNode, "role");
+				credit.Who_ = Elems_.Text (creditNode);
+				result << credit;
+			}
+			return result;
+		}
+
+		QList<MRSSComment> GetComments (int element) const
+		{
+			QList<MRSSComment> result;
+
+			auto collect = [&] (const QString& parentName, const QString& childName, const QString& type)
+			{
+				const auto parent = FirstChild (element, parentName);
+				if (parent < 0)
+					return;
+
+				for (const auto child : Elems_.ByTagNameNS (parent, NS_, childName))
+				{
+					MRSSComment comment (0, 0);
+					comment.Type_ = type;
+					comment.Comment_ = Elems_.Text (child);
+					result << comment;
+				}
+			};
+
+			collect ("comments", "comment", QObject::tr ("Comments"));
+			collect ("responses", "response", QObject::tr ("Responses"));
+			collect ("backLinks", "backLink", QObject::tr ("Backlinks"));
+
+			return result;
+		}
+
+		QList<MRSSPeerLink> GetPeerLinks (int element) const
+		{
+			QList<MRSSPeerLink> result;
+			for (const auto linkNode : Elems_.ChildrenNS (element, NS_, "peerLink"))
+			{
+				MRSSPeerLink pl (0, 0);
+				pl.Link_ = Elems_.Attribute (linkNode, "href");
+				pl.Type_ = Elems_.Attribute (linkNode, "type");
+				result << pl;
+			}
+			return result;
+		}
+
+		QList<MRSSScene> GetScenes (int element) const
+		{
+			QList<MRSSScene> result;
+
+			const auto scenes = FirstChild (element, "scenes");
+			if (scenes < 0)
+				return result;
+
+			for (const auto sceneNode : Elems_.ByTagNameNS (scenes, NS_, "scene"))
+			{
+				MRSSScene scene (0, 0);
+				scene.Title_ = Elems_.Text (Elems_.FirstChild (sceneNode, "sceneTitle"));
+				scene.Description_ = Elems_.Text (Elems_.FirstChild (sceneNode, "sceneDescription"));
+				scene.StartTime_ = Elems_.Text (Elems_.FirstChild (sceneNode, "sceneStartTime"));
+				scene.EndTime_ = Elems_.Text (Elems_.FirstChild (sceneNode, "sceneEndTime"));
+				result << scene;
+			}
+			return result;
+		}
+	};
+
+	MRSSLocatedData StreamParser::GetMRSSLocatedData (const FeedElements& elems, int element) const
+	{
+		return StreamMRSSParser { elems }.Collect (element);
+	}
+
+	QList<MRSSEntry> StreamParser::GetMediaRSS (const FeedElements& elems,
+			const IDType_t& itemId, const MRSSLocatedData& context) const
+	{
+		return StreamMRSSParser { elems }.Parse (itemId, context);
+	}
+
+	QDateTime StreamParser::FromRFC3339 (const QString& str)
+	{
+		return Parser::FromRFC3339 (str);
+	}
+
+	QDateTime StreamParser::RFC822TimeToQDateTime (const QString& str)
+	{
+		return RSSParser::RFC822TimeToQDateTime (str);
+	}
+
+	QString StreamParser::UnescapeHTML (const QString& str)
+	{
+		return Parser::UnescapeHTML (str);
+	}
+}
+}
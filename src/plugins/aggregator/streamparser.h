@@ -0,0 +1,158 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <QPair>
+#include <QStringList>
+#include "channel.h"
+#include "mrsslocateddata.h"
+
+class QXmlStreamReader;
+
+namespace LeechCraft
+{
+namespace Aggregator
+{
+	class FeedElements;
+
+	/** @brief Base class for the streaming feed parsers.
+	 *
+	 * Unlike Parser, the streaming parsers never build the DOM of the
+	 * whole document. Instead, they read the feed from a
+	 * QXmlStreamReader, keeping in memory only the channel-level
+	 * elements and the item being parsed right now (as a FeedElements
+	 * snapshot), and parse each item as soon as it is read.
+	 *
+	 * The resulting channels and items are the same as the ones
+	 * produced by the corresponding DOM parsers, with the only exception
+	 * of MediaRSS elements that are direct children of the channel but
+	 * come after some items: they are only taken into account for the
+	 * items following them.
+	 */
+	class StreamParser
+	{
+	public:
+		virtual ~StreamParser () = default;
+
+		/** @brief Advances the reader to the root element of the document.
+		 *
+		 * @param[in] reader The reader of the document.
+		 * @return Whether the root element has been found without
+		 * errors.
+		 */
+		static bool ReadToRoot (QXmlStreamReader& reader);
+
+		/** @brief Indicates whether parser could parse the document.
+		 *
+		 * @param[in] reader The reader positioned at the root element
+		 * of the document.
+		 * @return Whether the document could be parsed.
+		 */
+		virtual bool CouldParse (const QXmlStreamReader& reader) const = 0;
+
+		/** @brief Parses the document.
+		 *
+		 * The reader is expected to be positioned at the root element of
+		 * the document, and it's up to the caller to check the reader for
+		 * errors after this function returns.
+		 *
+		 * @param[in] reader The reader positioned at the root element.
+		 * @param[in] feedId The ID of the parent feed.
+		 * @return Container (channels_container_t) with new items.
+		 *
+		 * @sa Parser::ParseFeed()
+		 */
+		channels_container_t ParseFeed (QXmlStreamReader& reader,
+				const IDType_t& feedId) const;
+	protected:
+		/** @brief Tracks the first author-related elements in a subtree.
+		 *
+		 * Mirrors GetAuthor() for subtrees that are read in parts, like
+		 * a channel with its items.
+		 *
+		 * @sa TrackAuthor()
+		 */
+		struct AuthorTracker
+		{
+			boost::optional<QString> ITunes_;
+			boost::optional<QString> DC_;
+			boost::optional<QString> Plain_;
+
+			QString GetAuthor () const;
+		};
+
+		virtual channels_container_t Parse (QXmlStreamReader&,
+				const IDType_t&) const = 0;
+
+		/** @brief Updates the tracker with the given element and its
+		 * descendants.
+		 */
+		void TrackAuthor (AuthorTracker&, const FeedElements&, int) const;
+
+		static const QString& RDF ();
+
+		QString GetDescription (const FeedElements&, int) const;
+		void GetDescription (const FeedElements&, int, QString&) const;
+		QString GetLink (const FeedElements&, int) const;
+		QString GetAuthor (const FeedElements&, int) const;
+		QString GetCommentsRSS (const FeedElements&, int) const;
+		QString GetCommentsLink (const FeedElements&, int) const;
+		int GetNumComments (const FeedElements&, int) const;
+		boost::optional<QString> GetITunesDuration (const FeedElements&, int) const;
+		QDateTime GetDCDateTime (const FeedElements&, int) const;
+		QStringList GetAllCategories (const FeedElements&, int) const;
+		QList<Enclosure> GetEncEnclosures (const FeedElements&, int, const IDType_t&) const;
+		QPair<double, double> GetGeoPoint (const FeedElements&, int) const;
+
+		/** @brief Collects the MediaRSS data of the direct children of
+		 * the element.
+		 *
+		 * This is used to collect the data located at the feed and
+		 * channel levels to be later passed to GetMediaRSS().
+		 */
+		MRSSLocatedData GetMRSSLocatedData (const FeedElements&, int) const;
+
+		/** @brief Returns the MediaRSS entries of the item.
+		 *
+		 * @param[in] elems The item's elements.
+		 * @param[in] itemId The ID of the item.
+		 * @param[in] context The MediaRSS data located above the item.
+		 */
+		QList<MRSSEntry> GetMediaRSS (const FeedElements& elems,
+				const IDType_t& itemId, const MRSSLocatedData& context) const;
+
+		static QDateTime FromRFC3339 (const QString&);
+		static QDateTime RFC822TimeToQDateTime (const QString&);
+		static QString UnescapeHTML (const QString&);
+	};
+}
+}
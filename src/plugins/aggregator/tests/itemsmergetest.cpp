@@ -0,0 +1,318 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "itemsmergetest.h"
+#include <algorithm>
+#include <QtTest>
+#include <QElapsedTimer>
+#include <interfaces/core/itagsmanager.h>
+#include <util/sll/either.h>
+#include "itemsmerge.h"
+#include "poolsmanager.h"
+#include "storagebackendmanager.h"
+#include "xmlsettingsmanager.h"
+
+QTEST_GUILESS_MAIN (LeechCraft::Aggregator::ItemsMergeTest)
+
+namespace LeechCraft
+{
+namespace Aggregator
+{
+	namespace
+	{
+		class FakeTagsManager : public ITagsManager
+		{
+		public:
+			tag_id GetID (const QString& tag) override
+			{
+				return tag;
+			}
+
+			QString GetTag (tag_id id) const override
+			{
+				return id;
+			}
+
+			QStringList GetAllTags () const override
+			{
+				return {};
+			}
+
+			QStringList Split (const QString& string) const override
+			{
+				return string.split (";", QString::SkipEmptyParts);
+			}
+
+			QStringList SplitToIDs (const QString& string) override
+			{
+				return Split (string);
+			}
+
+			QString Join (const QStringList& tags) const override
+			{
+				return tags.join (";");
+			}
+
+			QString JoinIDs (const QStringList& ids) const override
+			{
+				return Join (ids);
+			}
+
+			QAbstractItemModel* GetModel () override
+			{
+				return nullptr;
+			}
+
+			QObject* GetQObject () override
+			{
+				return nullptr;
+			}
+		};
+
+		QDateTime Now ()
+		{
+			// Milliseconds don't survive the round trip through the DB.
+			auto now = QDateTime::currentDateTime ();
+			now.setTime (now.time ().addMSecs (-now.time ().msec ()));
+			return now;
+		}
+
+		Item_ptr MakeItem (IDType_t channelId, const QString& name, const QString& descr)
+		{
+			const auto& item = std::make_shared<Item> (channelId);
+			item->Title_ = name;
+			item->Link_ = "http://example.com/items/" + name;
+			item->Description_ = descr;
+			item->PubDate_ = Now ();
+			item->Unread_ = true;
+			return item;
+		}
+
+		Channel AddChannel (StorageBackend& sb, const QString& name, int itemsCount)
+		{
+			Feed feed;
+			feed.URL_ = "http://example.com/feeds/" + name;
+
+			const auto& channel = std::make_shared<Channel> (feed.FeedID_);
+			channel->Title_ = name;
+			channel->Link_ = "http://example.com/" + name;
+			for (int i = 0; i < itemsCount; ++i)
+				channel->Items_.push_back (MakeItem (channel->ChannelID_,
+						QString { "%1 item %2" }.arg (name).arg (i), "initial"));
+			feed.Channels_.push_back (channel);
+
+			sb.AddFeed (feed);
+
+			return *channel;
+		}
+
+		Channel MakeParsed (const Channel& ourChannel, const items_container_t& items)
+		{
+			Channel parsed { ourChannel.FeedID_ };
+			parsed.Title_ = ourChannel.Title_;
+			parsed.Link_ = ourChannel.Link_;
+			parsed.Items_ = items;
+			return parsed;
+		}
+
+		Item_ptr CopyItem (const Item_ptr& item)
+		{
+			const auto& copy = std::make_shared<Item> (*item);
+			copy->ItemID_ = PoolsManager::Instance ().GetPool (PTItem).GetID ();
+			return copy;
+		}
+
+		Feed::FeedSettings MakeSettings (const Channel& channel)
+		{
+			Feed::FeedSettings settings;
+			settings.FeedID_ = channel.FeedID_;
+			settings.ItemAge_ = 30;
+			settings.NumItems_ = 1000;
+			return settings;
+		}
+	}
+
+	void ItemsMergeTest::initTestCase ()
+	{
+		Home_ = std::make_unique<QTemporaryDir> ();
+		QVERIFY (Home_->isValid ());
+		qputenv ("HOME", Home_->path ().toUtf8 ());
+		QVERIFY (QDir { Home_->path () }.mkpath (".leechcraft/aggregator"));
+
+		const auto xsm = XmlSettingsManager::Instance ();
+		xsm->setProperty ("StorageType", "SQLite");
+		xsm->setProperty ("SQLiteVacuum", false);
+		xsm->setProperty ("SQLiteJournalMode", "DELETE");
+		xsm->setProperty ("SQLiteSynchronous", "FULL");
+		xsm->setProperty ("SQLiteTempStore", "DEFAULT");
+
+		TagsManager_ = std::make_unique<FakeTagsManager> ();
+		StorageBackendManager::Instance ().SetTagsManager (TagsManager_.get ());
+
+		const auto& result = StorageBackendManager::Instance ().CreatePrimaryStorage ();
+		QVERIFY (result.IsRight ());
+		SB_ = result.GetRight ();
+
+		PoolsManager::Instance ().ReloadPools (*SB_);
+	}
+
+	void ItemsMergeTest::cleanupTestCase ()
+	{
+		SB_.reset ();
+		Home_.reset ();
+	}
+
+	void ItemsMergeTest::testNewItems ()
+	{
+		const auto& ourChannel = AddChannel (*SB_, "new", 3);
+
+		auto items = ourChannel.Items_;
+		for (int i = 0; i < 2; ++i)
+			items.push_back (MakeItem (0, QString { "new fresh %1" }.arg (i), "fresh"));
+
+		const auto& parsed = MakeParsed (ourChannel, items);
+		const auto& merge = PrepareItemsMerge (*SB_, parsed, ourChannel, MakeSettings (ourChannel));
+		QCOMPARE (merge.Added_.size (), 2);
+		QVERIFY (merge.Updated_.isEmpty ());
+		for (const auto& item : merge.Added_)
+			QCOMPARE (item.ChannelID_, ourChannel.ChannelID_);
+
+		QVERIFY (SB_->MergeItems (merge));
+		QCOMPARE (SB_->GetItems (ourChannel.ChannelID_).size (), static_cast<size_t> (5));
+	}
+
+	void ItemsMergeTest::testUpdatedItems ()
+	{
+		const auto& ourChannel = AddChannel (*SB_, "updated", 3);
+
+		auto items = ourChannel.Items_;
+		items [1] = CopyItem (items [1]);
+		items [1]->Description_ = "changed";
+
+		const auto& parsed = MakeParsed (ourChannel, items);
+		const auto& merge = PrepareItemsMerge (*SB_, parsed, ourChannel, MakeSettings (ourChannel));
+		QVERIFY (merge.Added_.isEmpty ());
+		QCOMPARE (merge.Updated_.size (), 1);
+		QCOMPARE (merge.Updated_ [0].ItemID_, ourChannel.Items_ [1]->ItemID_);
+
+		QVERIFY (SB_->MergeItems (merge));
+
+		const auto& stored = SB_->GetItem (ourChannel.Items_ [1]->ItemID_);
+		QVERIFY (stored);
+		QCOMPARE (stored->Description_, QString { "changed" });
+		QCOMPARE (SB_->GetItems (ourChannel.ChannelID_).size (), static_cast<size_t> (3));
+	}
+
+	void ItemsMergeTest::testRepeatedItems ()
+	{
+		const auto& ourChannel = AddChannel (*SB_, "repeated", 1);
+
+		const auto& fresh = MakeItem (0, "repeated fresh", "first");
+		auto repeated = CopyItem (fresh);
+		repeated->Description_ = "second";
+
+		const auto& parsed = MakeParsed (ourChannel, { fresh, repeated });
+		const auto& merge = PrepareItemsMerge (*SB_, parsed, ourChannel, MakeSettings (ourChannel));
+		QCOMPARE (merge.Added_.size (), 1);
+		QVERIFY (merge.Updated_.isEmpty ());
+		QCOMPARE (merge.Added_ [0].Description_, QString { "second" });
+	}
+
+	void ItemsMergeTest::testTooOldItems ()
+	{
+		const auto& ourChannel = AddChannel (*SB_, "old", 1);
+
+		const auto& old = MakeItem (0, "old fresh", "old");
+		old->PubDate_ = Now ().addDays (-100);
+
+		const auto& parsed = MakeParsed (ourChannel, { old });
+		const auto& merge = PrepareItemsMerge (*SB_, parsed, ourChannel, MakeSettings (ourChannel));
+		QVERIFY (merge.Added_.isEmpty ());
+		QVERIFY (merge.Updated_.isEmpty ());
+	}
+
+	void ItemsMergeTest::benchMergeFeeds ()
+	{
+		const int FeedsCount = 1000;
+		const int ItemsPerFeed = 50;
+		const int UpdatedPerRound = 5;
+		const int NewPerRound = 5;
+
+		QElapsedTimer timer;
+		timer.start ();
+
+		QList<Channel> channels;
+		QList<items_container_t> feedsItems;
+		for (int i = 0; i < FeedsCount; ++i)
+		{
+			channels << AddChannel (*SB_, QString { "bench%1" }.arg (i), ItemsPerFeed);
+			feedsItems << channels.last ().Items_;
+		}
+
+		qDebug () << "created" << FeedsCount << "feeds in" << timer.restart () << "ms";
+
+		int round = 0;
+		QBENCHMARK
+		{
+			++round;
+			timer.restart ();
+
+			for (int feedIdx = 0; feedIdx < FeedsCount; ++feedIdx)
+			{
+				const auto& ourChannel = channels.at (feedIdx);
+
+				auto& feedItems = feedsItems [feedIdx];
+				for (int i = 0; i < UpdatedPerRound; ++i)
+				{
+					auto& item = feedItems [(round * UpdatedPerRound + i) % ItemsPerFeed];
+					item = CopyItem (item);
+					item->Description_ = QString { "round %1" }.arg (round);
+				}
+
+				auto items = feedItems;
+				for (int i = 0; i < NewPerRound; ++i)
+					items.push_back (MakeItem (0,
+							QString { "%1 round %2 item %3" }.arg (ourChannel.Title_).arg (round).arg (i),
+							"fresh"));
+
+				const auto& parsed = MakeParsed (ourChannel, items);
+				const auto& merge = PrepareItemsMerge (*SB_, parsed, ourChannel, MakeSettings (ourChannel));
+				QCOMPARE (merge.Added_.size (), NewPerRound);
+				QCOMPARE (merge.Updated_.size (), UpdatedPerRound);
+				QVERIFY (SB_->MergeItems (merge));
+			}
+
+			const auto elapsed = std::max<qint64> (timer.elapsed (), 1);
+			qDebug () << "merged" << FeedsCount << "feeds in" << elapsed << "ms,"
+					<< FeedsCount * 1000 / elapsed << "feeds/s";
+		}
+	}
+}
+}
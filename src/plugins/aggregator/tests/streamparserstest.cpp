@@ -0,0 +1,463 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "streamparserstest.h"
+#include <algorithm>
+#include <QtTest>
+#include <QDomDocument>
+#include <QElapsedTimer>
+#include <QSet>
+#include <QXmlStreamReader>
+#include "rss20parser.h"
+#include "rss10parser.h"
+#include "rss091parser.h"
+#include "atom10parser.h"
+#include "atom03parser.h"
+#include "rssstreamparser.h"
+#include "atomstreamparser.h"
+
+QTEST_GUILESS_MAIN (LeechCraft::Aggregator::StreamParsersTest)
+
+namespace LeechCraft
+{
+namespace Aggregator
+{
+	namespace
+	{
+		const IDType_t FeedID = 1;
+
+		const char RSS20Feed [] = R"(<?xml version="1.0" encoding="UTF-8"?>
+<rss version="2.0"
+		xmlns:media="http://search.yahoo.com/mrss/"
+		xmlns:dc="http://purl.org/dc/elements/1.1/"
+		xmlns:wfw="http://wellformedweb.org/CommentAPI/"
+		xmlns:slash="http://purl.org/rss/1.0/modules/slash/"
+		xmlns:content="http://purl.org/rss/1.0/modules/content/"
+		xmlns:georss="http://www.georss.org/georss">
+	<channel>
+		<title> RSS 2.0 channel </title>
+		<link>http://example.com/</link>
+		<description>Channel description</description>
+		<language>en</language>
+		<lastBuildDate>Sat, 07 Sep 2019 10:00:00 GMT</lastBuildDate>
+		<image>
+			<url>http://example.com/logo.png</url>
+			<title>Logo</title>
+			<link>http://example.com/</link>
+		</image>
+		<media:thumbnail url="http://example.com/channel.jpg" width="64" height="64"/>
+		<media:credit role="publisher">Channel Publisher</media:credit>
+		<media:rating scheme="urn:simple">nonadult</media:rating>
+		<item>
+			<title>  First
+				item  </title>
+			<link>http://example.com/1</link>
+			<guid>http://example.com/1</guid>
+			<description>&lt;p&gt;First description&lt;/p&gt;</description>
+			<content:encoded><![CDATA[<p>First <b>full</b> description</p>]]></content:encoded>
+			<pubDate>Fri, 06 Sep 2019 08:00:00 GMT</pubDate>
+			<dc:creator>First Author</dc:creator>
+			<category>one</category>
+			<category>two</category>
+			<comments>http://example.com/1#comments</comments>
+			<wfw:commentRss>http://example.com/1/comments.rss</wfw:commentRss>
+			<slash:comments>3</slash:comments>
+			<georss:point>45.5 -122.5</georss:point>
+			<enclosure url="http://example.com/1.mp3" length="1024" type="audio/mpeg"/>
+			<media:content url="http://example.com/1.mp4" fileSize="2048" type="video/mp4"
+					medium="video" isDefault="true" duration="60" width="640" height="480">
+				<media:title>First video</media:title>
+				<media:thumbnail url="http://example.com/1.jpg" width="320" height="240" time="00:00:05"/>
+				<media:credit role="author">Video Author</media:credit>
+				<media:peerLink type="application/x-bittorrent" href="http://example.com/1.torrent"/>
+				<media:comments>
+					<media:comment>Nice</media:comment>
+					<media:comment>Very nice</media:comment>
+				</media:comments>
+				<media:scenes>
+					<media:scene>
+						<sceneTitle>Intro</sceneTitle>
+						<sceneDescription>The beginning</sceneDescription>
+						<sceneStartTime>00:00</sceneStartTime>
+						<sceneEndTime>00:10</sceneEndTime>
+					</media:scene>
+				</media:scenes>
+			</media:content>
+		</item>
+		<item>
+			<title>Second item</title>
+			<link>http://example.com/2</link>
+			<guid>http://example.com/2</guid>
+			<description>Second description</description>
+			<pubDate>Thu, 05 Sep 2019 08:00:00 GMT</pubDate>
+			<author>second@example.com (Second Author)</author>
+			<media:group>
+				<media:title>Grouped</media:title>
+				<media:thumbnail url="http://example.com/2.jpg"/>
+				<media:content url="http://example.com/2-low.mp4" bitrate="300" type="video/mp4"/>
+				<media:content url="http://example.com/2-high.mp4" bitrate="1200" type="video/mp4">
+					<media:keywords>high, quality</media:keywords>
+				</media:content>
+			</media:group>
+		</item>
+		<item>
+			<title>Third item</title>
+			<link>http://example.com/3</link>
+			<description>No media here</description>
+			<pubDate>Wed, 04 Sep 2019 08:00:00 GMT</pubDate>
+		</item>
+	</channel>
+</rss>
+)";
+
+		const char RSS091Feed [] = R"(<?xml version="1.0" encoding="UTF-8"?>
+<rss version="0.91">
+	<channel>
+		<title>RSS 0.91 channel</title>
+		<link>http://example.com/091</link>
+		<description>Old school</description>
+		<language>en-us</language>
+		<lastBuildDate>Sat, 07 Sep 2019 10:00:00 GMT</lastBuildDate>
+		<item>
+			<title>Old item</title>
+			<link>http://example.com/091/1</link>
+			<description>Old description</description>
+		</item>
+		<item>
+			<title>Another old item</title>
+			<link>http://example.com/091/2</link>
+			<description>Another old description</description>
+		</item>
+	</channel>
+</rss>
+)";
+
+		const char RSS10Feed [] = R"(<?xml version="1.0" encoding="UTF-8"?>
+<rdf:RDF
+		xmlns:rdf="http://www.w3.org/1999/02/22-rdf-syntax-ns#"
+		xmlns:dc="http://purl.org/dc/elements/1.1/"
+		xmlns="http://purl.org/rss/1.0/">
+	<channel rdf:about="http://example.com/rdf">
+		<title>RSS 1.0 channel</title>
+		<link>http://example.com/rdf</link>
+		<description>RDF description</description>
+		<dc:date>2019-09-07T10:00:00Z</dc:date>
+		<items>
+			<rdf:Seq>
+				<rdf:li rdf:resource="http://example.com/rdf/1"/>
+				<rdf:li rdf:resource="http://example.com/rdf/2"/>
+			</rdf:Seq>
+		</items>
+	</channel>
+	<item rdf:about="http://example.com/rdf/1">
+		<title>RDF item</title>
+		<link>http://example.com/rdf/1</link>
+		<description>RDF item description</description>
+		<dc:date>2019-09-06T08:00:00Z</dc:date>
+		<dc:creator>RDF Author</dc:creator>
+		<dc:subject>rdf</dc:subject>
+	</item>
+	<item rdf:about="http://example.com/rdf/2">
+		<title>Another RDF item</title>
+		<link>http://example.com/rdf/2</link>
+		<description>Another RDF item description</description>
+		<dc:date>2019-09-05T08:00:00Z</dc:date>
+	</item>
+</rdf:RDF>
+)";
+
+		const char Atom10Feed [] = R"(<?xml version="1.0" encoding="UTF-8"?>
+<feed xmlns="http://www.w3.org/2005/Atom" xmlns:media="http://search.yahoo.com/mrss/">
+	<title>Atom 1.0 feed</title>
+	<subtitle type="html">&lt;b&gt;Atom&lt;/b&gt; subtitle</subtitle>
+	<link rel="alternate" href="http://example.com/atom"/>
+	<link rel="self" href="http://example.com/atom.xml"/>
+	<updated>2019-09-07T10:00:00Z</updated>
+	<author><name>Feed Author</name></author>
+	<id>urn:example:atom</id>
+	<media:thumbnail url="http://example.com/atom.jpg"/>
+	<entry>
+		<title type="html">First &amp;lt;entry&amp;gt;</title>
+		<link rel="alternate" href="http://example.com/atom/1"/>
+		<link rel="enclosure" href="http://example.com/atom/1.ogg" type="audio/ogg" length="4096"/>
+		<id>urn:example:atom:1</id>
+		<updated>2019-09-06T08:00:00Z</updated>
+		<published>2019-09-06T07:00:00+02:00</published>
+		<author><name>Entry Author</name></author>
+		<category term="atom"/>
+		<summary>Entry summary</summary>
+		<content type="html">&lt;p&gt;Entry content&lt;/p&gt;</content>
+		<media:content url="http://example.com/atom/1.mp4" type="video/mp4">
+			<media:description>Atom video</media:description>
+		</media:content>
+	</entry>
+	<entry>
+		<title>Second entry</title>
+		<link href="http://example.com/atom/2"/>
+		<id>urn:example:atom:2</id>
+		<updated>2019-09-05T08:00:00Z</updated>
+		<summary>Second summary</summary>
+	</entry>
+</feed>
+)";
+
+		const char Atom03Feed [] = R"(<?xml version="1.0" encoding="UTF-8"?>
+<feed version="0.3" xmlns="http://purl.org/atom/ns#">
+	<title>Atom 0.3 feed</title>
+	<tagline>Atom 0.3 tagline</tagline>
+	<link rel="alternate" type="text/html" href="http://example.com/atom03"/>
+	<modified>2019-09-07T10:00:00Z</modified>
+	<author><name>Old Atom Author</name></author>
+	<entry>
+		<title>Old entry</title>
+		<link rel="alternate" type="text/html" href="http://example.com/atom03/1"/>
+		<id>urn:example:atom03:1</id>
+		<issued>2019-09-06T08:00:00Z</issued>
+		<modified>2019-09-06T08:00:00Z</modified>
+		<summary>Old summary</summary>
+		<content type="text/html" mode="escaped">&lt;p&gt;Old content&lt;/p&gt;</content>
+	</entry>
+</feed>
+)";
+
+		QList<const Parser*> DOMParsers ()
+		{
+			return
+			{
+				&RSS20Parser::Instance (),
+				&Atom10Parser::Instance (),
+				&RSS091Parser::Instance (),
+				&Atom03Parser::Instance (),
+				&RSS10Parser::Instance ()
+			};
+		}
+
+		QList<const StreamParser*> StreamParsers ()
+		{
+			return
+			{
+				&RSS20StreamParser::Instance (),
+				&Atom10StreamParser::Instance (),
+				&RSS091StreamParser::Instance (),
+				&Atom03StreamParser::Instance (),
+				&RSS10StreamParser::Instance ()
+			};
+		}
+
+		channels_container_t ParseDOM (const QByteArray& data)
+		{
+			QDomDocument doc;
+			if (!doc.setContent (data, true))
+				return {};
+
+			for (const auto parser : DOMParsers ())
+				if (parser->CouldParse (doc))
+					return parser->ParseFeed (doc, FeedID);
+			return {};
+		}
+
+		channels_container_t ParseStream (const QByteArray& data)
+		{
+			QXmlStreamReader reader { data };
+			if (!StreamParser::ReadToRoot (reader))
+				return {};
+
+			for (const auto parser : StreamParsers ())
+				if (parser->CouldParse (reader))
+				{
+					const auto& result = parser->ParseFeed (reader, FeedID);
+					return reader.hasError () ? channels_container_t {} : result;
+				}
+			return {};
+		}
+
+		QByteArray MakeLargeFeed (int itemsCount)
+		{
+			QByteArray result = R"(<?xml version="1.0" encoding="UTF-8"?>
+<rss version="2.0" xmlns:media="http://search.yahoo.com/mrss/" xmlns:dc="http://purl.org/dc/elements/1.1/">
+<channel>
+<title>Large channel</title>
+<link>http://example.com/large</link>
+<description>Lots of items</description>
+<lastBuildDate>Sat, 07 Sep 2019 10:00:00 GMT</lastBuildDate>
+<media:thumbnail url="http://example.com/large.jpg"/>
+)";
+			for (int i = 0; i < itemsCount; ++i)
+				result += QString { R"(<item>
+<title>Item %1</title>
+<link>http://example.com/large/%1</link>
+<guid>http://example.com/large/%1</guid>
+<description>&lt;p&gt;The description of the item number %1, long enough to look like a real one.&lt;/p&gt;</description>
+<pubDate>Fri, 06 Sep 2019 08:00:00 GMT</pubDate>
+<dc:creator>Author %1</dc:creator>
+<category>large</category>
+<enclosure url="http://example.com/large/%1.mp3" length="1024" type="audio/mpeg"/>
+<media:content url="http://example.com/large/%1.mp4" type="video/mp4">
+<media:thumbnail url="http://example.com/large/%1.jpg"/>
+</media:content>
+</item>
+)" }.arg (i).toUtf8 ();
+			result += "</channel>\n</rss>\n";
+			return result;
+		}
+	}
+
+	void StreamParsersTest::testSameAsDOM_data ()
+	{
+		QTest::addColumn<QByteArray> ("feed");
+
+		QTest::newRow ("RSS 2.0") << QByteArray { RSS20Feed };
+		QTest::newRow ("RSS 0.91") << QByteArray { RSS091Feed };
+		QTest::newRow ("RSS 1.0") << QByteArray { RSS10Feed };
+		QTest::newRow ("Atom 1.0") << QByteArray { Atom10Feed };
+		QTest::newRow ("Atom 0.3") << QByteArray { Atom03Feed };
+	}
+
+	void StreamParsersTest::testSameAsDOM ()
+	{
+		QFETCH (QByteArray, feed);
+
+		const auto& domChannels = ParseDOM (feed);
+		const auto& streamChannels = ParseStream (feed);
+		QVERIFY (!domChannels.empty ());
+		QCOMPARE (streamChannels.size (), domChannels.size ());
+
+		for (size_t i = 0; i < domChannels.size (); ++i)
+		{
+			const auto& dom = *domChannels [i];
+			const auto& stream = *streamChannels [i];
+
+			QCOMPARE (stream.FeedID_, dom.FeedID_);
+			QCOMPARE (stream.Title_, dom.Title_);
+			QCOMPARE (stream.Link_, dom.Link_);
+			QCOMPARE (stream.Description_, dom.Description_);
+			QCOMPARE (stream.LastBuild_, dom.LastBuild_);
+			QCOMPARE (stream.Language_, dom.Language_);
+			QCOMPARE (stream.Author_, dom.Author_);
+			QCOMPARE (stream.PixmapURL_, dom.PixmapURL_);
+			QCOMPARE (stream.Items_.size (), dom.Items_.size ());
+
+			for (size_t j = 0; j < dom.Items_.size (); ++j)
+			{
+				const auto& domItem = *dom.Items_ [j];
+				const auto& streamItem = *stream.Items_ [j];
+
+				QCOMPARE (streamItem.ChannelID_, stream.ChannelID_);
+				QCOMPARE (streamItem.Guid_, domItem.Guid_);
+				QCOMPARE (streamItem.PubDate_, domItem.PubDate_);
+				if (IsModified (domItem, streamItem))
+				{
+					Diff (domItem, streamItem);
+					QFAIL ("stream parser's item differs from the DOM parser's one");
+				}
+			}
+		}
+	}
+
+	void StreamParsersTest::testInheritedMRSSIDs ()
+	{
+		const auto& channels = ParseStream (QByteArray { RSS20Feed });
+		QCOMPARE (channels.size (), static_cast<size_t> (1));
+
+		QSet<IDType_t> entries;
+		QSet<IDType_t> thumbnails;
+		QSet<IDType_t> credits;
+		int entriesCount = 0;
+		int inheritedThumbs = 0;
+
+		for (const auto& item : channels.front ()->Items_)
+			for (const auto& entry : item->MRSSEntries_)
+			{
+				++entriesCount;
+				QCOMPARE (entry.ItemID_, item->ItemID_);
+				QVERIFY (!entries.contains (entry.MRSSEntryID_));
+				entries << entry.MRSSEntryID_;
+
+				for (const auto& thumb : entry.Thumbnails_)
+				{
+					QCOMPARE (thumb.MRSSEntryID_, entry.MRSSEntryID_);
+					QVERIFY (!thumbnails.contains (thumb.MRSSThumbnailID_));
+					thumbnails << thumb.MRSSThumbnailID_;
+
+					if (thumb.URL_ == "http://example.com/channel.jpg")
+						++inheritedThumbs;
+				}
+
+				for (const auto& credit : entry.Credits_)
+				{
+					QCOMPARE (credit.MRSSEntryID_, entry.MRSSEntryID_);
+					QVERIFY (!credits.contains (credit.MRSSCreditID_));
+					credits << credit.MRSSCreditID_;
+				}
+
+				for (const auto& comment : entry.Comments_)
+					QCOMPARE (comment.MRSSEntryID_, entry.MRSSEntryID_);
+				for (const auto& link : entry.PeerLinks_)
+					QCOMPARE (link.MRSSEntryID_, entry.MRSSEntryID_);
+				for (const auto& scene : entry.Scenes_)
+					QCOMPARE (scene.MRSSEntryID_, entry.MRSSEntryID_);
+			}
+
+		QVERIFY (entriesCount >= 3);
+		QCOMPARE (inheritedThumbs, entriesCount);
+	}
+
+	void StreamParsersTest::benchParse_data ()
+	{
+		QTest::addColumn<bool> ("stream");
+
+		QTest::newRow ("DOM") << false;
+		QTest::newRow ("stream") << true;
+	}
+
+	void StreamParsersTest::benchParse ()
+	{
+		QFETCH (bool, stream);
+
+		const int ItemsCount = 5000;
+		const auto& feed = MakeLargeFeed (ItemsCount);
+
+		QElapsedTimer timer;
+		QBENCHMARK
+		{
+			timer.start ();
+
+			const auto& channels = stream ? ParseStream (feed) : ParseDOM (feed);
+			QCOMPARE (channels.size (), static_cast<size_t> (1));
+			QCOMPARE (channels.front ()->Items_.size (), static_cast<size_t> (ItemsCount));
+
+			const auto elapsed = std::max<qint64> (timer.elapsed (), 1);
+			qDebug () << "parsed" << feed.size () / 1024 << "KiB in" << elapsed << "ms,"
+					<< ItemsCount * 1000 / elapsed << "items/s,"
+					<< feed.size () / 1024 * 1000 / elapsed << "KiB/s";
+		}
+	}
+}
+}
@@ -50,7 +50,7 @@ namespace AdiumStyles
 		Q_OBJECT
 		Q_INTERFACES (IInfo IPlugin2 LeechCraft::Azoth::IResourcePlugin)
 
-		LC_PLUGIN_METADATA ("org.LeechCraft.Azoth.AdiumStyles")
+		LC_PLUGIN_METADATA_FILE ("org.LeechCraft.Azoth.AdiumStyles", "manifest.json")
 
 		IProxyObject *Proxy_;
 		QObjectList ResourceSources_;
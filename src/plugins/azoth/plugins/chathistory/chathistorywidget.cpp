@@ -53,6 +53,15 @@ namespace ChatHistory
 {
 	using namespace std::placeholders;
 
+	namespace
+	{
+		/* The number of in-chat search hits fetched at once, so that
+		 * stepping through the results doesn't rescan the history on
+		 * each step.
+		 */
+		const int SearchHitsBatch = 50;
+	}
+
 	ChatHistoryWidget::ChatHistoryWidget (const InitParams& params, ICLEntry *entry, QWidget *parent)
 	: QWidget (parent)
 	, Params_ (params)
@@ -110,6 +119,11 @@ namespace ChatHistory
 				this,
 				SLOT (clearHistory ()))->setProperty ("ActionIcon", "list-remove");
 
+		connect (Params_.StorageMgr_,
+				SIGNAL (logItemsAdded (QString, QString)),
+				this,
+				SLOT (handleLogItemsAdded (QString, QString)));
+
 		Util::Sequence (this, Params_.StorageMgr_->GetOurAccounts ()) >>
 				[this] (const QStringList& accs) { HandleGotOurAccounts (accs); };
 	}
@@ -471,6 +485,27 @@ namespace ChatHistory
 			Ui_.Calendar_->setDateTextFormat ({ year, month, day }, fmt);
 	}
 
+	void ChatHistoryWidget::HandleGotSearchHits (SearchHitsCache cache,
+			ChatFindBox::FindFlags flags, const SearchHitsResult_t& result)
+	{
+		if (cache.Account_ != CurrentAccount_ ||
+				cache.Entry_ != CurrentEntry_ ||
+				cache.Text_ != PreviousSearchText_)
+			return;
+
+		if (const auto err = result.MaybeLeft ())
+		{
+			HandleGotSearchPosition (cache.Account_, cache.Entry_, SearchResult_t::Left (*err));
+			return;
+		}
+
+		cache.Hits_ = result.GetRight ();
+		HitsCache_ = cache;
+
+		if (!TryCachedSearch (flags))
+			RequestSearch (flags);
+	}
+
 	void ChatHistoryWidget::on_AccountBox__currentIndexChanged (int idx)
 	{
 		const auto& id = Ui_.AccountBox_->itemData (idx).toString ();
@@ -495,6 +530,7 @@ namespace ChatHistory
 		{
 			SearchShift_ = 0;
 			PreviousSearchText_.clear ();
+			HitsCache_.reset ();
 			Backpages_ = 0;
 			SearchResultPosition_ = -1;
 		}
@@ -544,6 +580,7 @@ namespace ChatHistory
 		{
 			SearchShift_ = 0;
 			PreviousSearchText_ = text;
+			HitsCache_.reset ();
 		}
 		else if (!(flags & ChatFindBox::FindBackwards))
 			++SearchShift_;
@@ -586,6 +623,7 @@ namespace ChatHistory
 			return;
 
 		Params_.StorageMgr_->ClearHistory (CurrentAccount_, CurrentEntry_);
+		HitsCache_.reset ();
 
 		Ui_.Contacts_->clearSelection ();
 		if (const auto item = FindContactItem (CurrentEntry_))
@@ -626,6 +664,16 @@ namespace ChatHistory
 		return nullptr;
 	}
 
+	void ChatHistoryWidget::handleLogItemsAdded (const QString& accountId, const QString& entryId)
+	{
+		// the hits are counted from the newest message, so the new ones
+		// shift all the cached positions
+		if (HitsCache_ &&
+				HitsCache_->Account_ == accountId &&
+				HitsCache_->Entry_ == entryId)
+			HitsCache_.reset ();
+	}
+
 	void ChatHistoryWidget::ShowLoading ()
 	{
 		const auto& html = "<html><head/><body><span style='color:#666666'>" +
@@ -660,6 +708,31 @@ namespace ChatHistory
 
 	void ChatHistoryWidget::RequestSearch (ChatFindBox::FindFlags flags)
 	{
+		if (!CurrentAccount_.isEmpty () && !CurrentEntry_.isEmpty ())
+		{
+			if (TryCachedSearch (flags))
+				return;
+
+			const bool cs = flags & ChatFindBox::FindCaseSensitively;
+			const int offset = SearchShift_ / SearchHitsBatch * SearchHitsBatch;
+			const SearchHitsCache cache
+			{
+				CurrentAccount_,
+				CurrentEntry_,
+				PreviousSearchText_,
+				cs,
+				offset,
+				{}
+			};
+
+			const auto& future = Params_.StorageMgr_->SearchHits (CurrentAccount_, CurrentEntry_,
+					PreviousSearchText_, offset, SearchHitsBatch, cs);
+			Util::Sequence (this, future) >>
+					std::bind (&ChatHistoryWidget::HandleGotSearchHits,
+							this, cache, flags, _1);
+			return;
+		}
+
 		const auto& future = Params_.StorageMgr_->Search (CurrentAccount_, CurrentEntry_,
 				PreviousSearchText_, SearchShift_,
 				flags & ChatFindBox::FindCaseSensitively);
@@ -667,6 +740,26 @@ namespace ChatHistory
 				std::bind (&ChatHistoryWidget::HandleGotSearchPosition,
 						this, CurrentAccount_, CurrentEntry_, _1);
 	}
+
+	bool ChatHistoryWidget::TryCachedSearch (ChatFindBox::FindFlags flags)
+	{
+		if (!HitsCache_ ||
+				HitsCache_->Account_ != CurrentAccount_ ||
+				HitsCache_->Entry_ != CurrentEntry_ ||
+				HitsCache_->Text_ != PreviousSearchText_ ||
+				HitsCache_->CS_ != static_cast<bool> (flags & ChatFindBox::FindCaseSensitively))
+			return false;
+
+		const int idx = SearchShift_ - HitsCache_->Offset_;
+		if (idx < 0 || idx >= SearchHitsBatch)
+			return false;
+
+		const auto& position = idx < HitsCache_->Hits_.size () ?
+				boost::optional<int> { HitsCache_->Hits_.at (idx).Position_ } :
+				boost::optional<int> {};
+		HandleGotSearchPosition (CurrentAccount_, CurrentEntry_, SearchResult_t::Right (position));
+		return true;
+	}
 }
 }
 }
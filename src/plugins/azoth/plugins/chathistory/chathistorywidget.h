@@ -85,6 +85,18 @@ namespace ChatHistory
 		QString CurrentAccount_;
 		QString CurrentEntry_;
 		QString PreviousSearchText_;
+
+		struct SearchHitsCache
+		{
+			QString Account_;
+			QString Entry_;
+			QString Text_;
+			bool CS_;
+			int Offset_;
+			QList<SearchHit> Hits_;
+		};
+		boost::optional<SearchHitsCache> HitsCache_;
+
 		QToolBar *Toolbar_;
 
 		QHash<QString, QString> EntryID2NameCache_;
@@ -111,6 +123,7 @@ namespace ChatHistory
 		void HandleGotChatLogs (const QString&, const QString&, const ChatLogsResult_t&);
 		void HandleGotSearchPosition (const QString&, const QString&, const SearchResult_t&);
 		void HandleGotDaysForSheet (const QString&, const QString&, int, int, const DaysResult_t&);
+		void HandleGotSearchHits (SearchHitsCache, ChatFindBox::FindFlags, const SearchHitsResult_t&);
 	private slots:
 		void on_AccountBox__currentIndexChanged (int);
 		void handleContactSelected (const QModelIndex&);
@@ -125,6 +138,8 @@ namespace ChatHistory
 
 		void on_HistView__anchorClicked (const QUrl&);
 		void handleBgLinkRequested (const QUrl&);
+
+		void handleLogItemsAdded (const QString&, const QString&);
 	private:
 		QStandardItem* FindContactItem (const QString&) const;
 
@@ -132,6 +147,7 @@ namespace ChatHistory
 		void UpdateDates ();
 		void RequestLogs ();
 		void RequestSearch (ChatFindBox::FindFlags);
+		bool TryCachedSearch (ChatFindBox::FindFlags);
 	signals:
 		void removeSelf (QWidget*);
 
@@ -34,6 +34,7 @@
 #include <QSqlDatabase>
 #include <QSqlError>
 #include <QDir>
+#include <QTimer>
 #include <QtDebug>
 #include <util/db/dblock.h>
 #include <util/db/util.h>
@@ -69,8 +70,28 @@ namespace ChatHistory
 	: QObject (parent)
 	, DB_ (std::make_shared<QSqlDatabase> (QSqlDatabase::addDatabase ("QSQLITE",
 			Util::GenConnectionName ("Azoth.ChatHistory.HistoryConnection"))))
+	, FlushTimer_ (new QTimer (this))
 	{
 		DB_->setDatabaseName (GetDatabasePath ());
+
+		FlushTimer_->setSingleShot (true);
+		FlushTimer_->setInterval (500);
+		connect (FlushTimer_,
+				&QTimer::timeout,
+				this,
+				&Storage::FlushPendingWrites);
+	}
+
+	Storage::~Storage ()
+	{
+		if (!DB_->isOpen ())
+			return;
+
+		FlushPendingWrites ();
+
+		QSqlQuery checkpoint (*DB_);
+		if (!checkpoint.exec ("PRAGMA wal_checkpoint(TRUNCATE);"))
+			Util::DBLock::DumpError (checkpoint);
 	}
 
 	QString Storage::GetDatabasePath ()
@@ -100,6 +121,18 @@ namespace ChatHistory
 		pragma.exec ("PRAGMA foreign_keys = ON;");
 		pragma.exec ("PRAGMA synchronous = OFF");
 
+		/* The writer appends to the WAL instead of rewriting the pages
+		 * in place, which is much cheaper for the small batches of
+		 * messages. SQLite checkpoints the log back into the database
+		 * once it exceeds wal_autocheckpoint pages, and journal_size_limit
+		 * truncates it after that, so the log stays bounded even in the
+		 * busiest rooms.
+		 */
+		if (!pragma.exec ("PRAGMA journal_mode = WAL;"))
+			Util::DBLock::DumpError (pragma);
+		pragma.exec ("PRAGMA wal_autocheckpoint = 1000;");
+		pragma.exec ("PRAGMA journal_size_limit = 4194304;");
+
 		InitializeTables ();
 
 		MaxTimestampSelector_ = QSqlQuery (*DB_);
@@ -164,29 +197,14 @@ namespace ChatHistory
 				"AND Date >= :lower_date "
 				"AND Date <= :upper_date");
 
-		LogsSearcher_ = QSqlQuery (*DB_);
-		LogsSearcher_.prepare ("SELECT Rowid FROM azoth_history "
-				"WHERE Id = :inner_entry_id "
-				"AND AccountID = :inner_account_id "
-				"AND ((Message LIKE :text AND :insensitive) OR (Message GLOB :ctext AND :sensitive)) "
-				"ORDER BY Rowid DESC "
-				"LIMIT 1 OFFSET :offset;");
+		RowIDRange2Count_ = QSqlQuery (*DB_);
+		RowIDRange2Count_.prepare ("SELECT COUNT(1) FROM azoth_history "
+				"WHERE Id = :entry_id "
+				"AND AccountID = :account_id "
+				"AND rowid > :lower_rowid "
+				"AND rowid <= :upper_rowid");
 
-		LogsSearcherWOContact_ = QSqlQuery (*DB_);
-		LogsSearcherWOContact_.prepare ("SELECT Date, Id FROM azoth_history "
-				"WHERE AccountID = :account_id "
-				"AND Date = (SELECT Date FROM azoth_history "
-				"	WHERE AccountID = :inner_account_id "
-				"	AND ((Message LIKE :text AND :insensitive) OR (Message GLOB :ctext AND :sensitive)) "
-				"	ORDER BY Rowid DESC "
-				"	LIMIT 1 OFFSET :offset);");
-
-		LogsSearcherWOContactAccount_ = QSqlQuery (*DB_);
-		LogsSearcherWOContactAccount_.prepare ("SELECT Date, Id, AccountID FROM azoth_history "
-				"WHERE Date = (SELECT Date FROM azoth_history "
-				"	WHERE ((Message LIKE :text AND :insensitive) OR (Message GLOB :ctext AND :sensitive)) "
-				"	ORDER BY Rowid DESC "
-				"	LIMIT 1 OFFSET :offset);");
+		PrepareSearchers ();
 
 		HistoryGetter_ = QSqlQuery (*DB_);
 		HistoryGetter_.prepare ("SELECT Date, Direction, Message, Variant, Type, RichMessage, EscapePolicy "
@@ -320,6 +338,8 @@ namespace ChatHistory
 
 		UpdateTables ();
 
+		HasFTS_ = InitializeFTS (tables);
+
 		if (!query.exec ("CREATE INDEX IF NOT EXISTS azoth_history_id_accountid ON azoth_history (Id, AccountId);"))
 		{
 			Util::DBLock::DumpError (query);
@@ -367,6 +387,146 @@ namespace ChatHistory
 		}
 	}
 
+	bool Storage::InitializeFTS (const QStringList& tables)
+	{
+		if (tables.contains ("azoth_history_fts"))
+			return true;
+
+		const QStringList queries
+		{
+			"CREATE VIRTUAL TABLE azoth_history_fts USING fts5 ("
+				"Message, "
+				"content = 'azoth_history', "
+				"tokenize = 'trigram'"
+				");",
+			"CREATE TRIGGER azoth_history_fts_insert AFTER INSERT ON azoth_history BEGIN "
+				"INSERT INTO azoth_history_fts (rowid, Message) VALUES (new.rowid, new.Message); "
+				"END;",
+			"CREATE TRIGGER azoth_history_fts_delete AFTER DELETE ON azoth_history BEGIN "
+				"INSERT INTO azoth_history_fts (azoth_history_fts, rowid, Message) "
+				"VALUES ('delete', old.rowid, old.Message); "
+				"END;",
+			"CREATE TRIGGER azoth_history_fts_update AFTER UPDATE OF Message ON azoth_history BEGIN "
+				"INSERT INTO azoth_history_fts (azoth_history_fts, rowid, Message) "
+				"VALUES ('delete', old.rowid, old.Message); "
+				"INSERT INTO azoth_history_fts (rowid, Message) VALUES (new.rowid, new.Message); "
+				"END;",
+			"INSERT INTO azoth_history_fts (azoth_history_fts) VALUES ('rebuild');"
+		};
+
+		QSqlQuery query { *DB_ };
+		if (!query.exec ("SAVEPOINT azoth_history_fts;"))
+		{
+			Util::DBLock::DumpError (query);
+			return false;
+		}
+
+		for (const auto& queryStr : queries)
+			if (!query.exec (queryStr))
+			{
+				Util::DBLock::DumpError (query);
+				qWarning () << Q_FUNC_INFO
+						<< "unable to create the full-text index, searching would be slow";
+				query.exec ("ROLLBACK TO azoth_history_fts;");
+				query.exec ("RELEASE azoth_history_fts;");
+				return false;
+			}
+
+		query.exec ("RELEASE azoth_history_fts;");
+		return true;
+	}
+
+	namespace
+	{
+		QString MatchCondition (const QString& table)
+		{
+			return QString ("((%1.Message LIKE :text AND :insensitive) OR (%1.Message GLOB :ctext AND :sensitive))")
+					.arg (table);
+		}
+	}
+
+	void Storage::PrepareSearchers ()
+	{
+		/* The FTS variants use the trigram index to select the
+		 * candidates and then check them against the very same
+		 * condition the plain ones use. The index folds the case of all
+		 * the characters and not just of the ASCII ones as LIKE does, so
+		 * the candidates are a superset of the actual results, and the
+		 * results are the same.
+		 */
+		const QString plainSource = "azoth_history h";
+		const QString ftsSource = "azoth_history_fts f JOIN azoth_history h ON h.rowid = f.rowid";
+		const QString ftsCondition = "f.Message LIKE :fts_text AND ";
+
+		auto prepare = [this] (QSqlQuery& query, const QString& queryStr)
+		{
+			query = QSqlQuery (*DB_);
+			if (!query.prepare (queryStr))
+				Util::DBLock::DumpError (query);
+		};
+
+		const auto& logsSearcher = QString ("SELECT h.Rowid FROM %1 "
+				"WHERE %2"
+				"h.Id = :inner_entry_id "
+				"AND h.AccountID = :inner_account_id "
+				"AND %3 "
+				"ORDER BY h.Rowid DESC "
+				"LIMIT 1 OFFSET :offset;");
+		prepare (LogsSearcher_,
+				logsSearcher.arg (plainSource, QString {}, MatchCondition ("h")));
+
+		const auto& woContactSearcher = QString ("SELECT h.Rowid, h.Id FROM %1 "
+				"WHERE %2"
+				"h.AccountID = :inner_account_id "
+				"AND %3 "
+				"ORDER BY h.Rowid DESC "
+				"LIMIT 1 OFFSET :offset;");
+		prepare (LogsSearcherWOContact_,
+				woContactSearcher.arg (plainSource, QString {}, MatchCondition ("h")));
+
+		const auto& woContactAccountSearcher = QString ("SELECT h.Rowid, h.Id, h.AccountID FROM %1 "
+				"WHERE %2"
+				"%3 "
+				"ORDER BY h.Rowid DESC "
+				"LIMIT 1 OFFSET :offset;");
+		prepare (LogsSearcherWOContactAccount_,
+				woContactAccountSearcher.arg (plainSource, QString {}, MatchCondition ("h")));
+
+		const auto& hitsSearcher = QString ("SELECT h.Rowid, h.Date FROM %1 "
+				"WHERE %2"
+				"h.Id = :entry_id "
+				"AND h.AccountID = :account_id "
+				"AND %3 "
+				"ORDER BY h.Rowid DESC "
+				"LIMIT :limit OFFSET :offset;");
+		prepare (HitsSearcher_,
+				hitsSearcher.arg (plainSource, QString {}, MatchCondition ("h")));
+
+		if (!HasFTS_)
+			return;
+
+		prepare (LogsSearcherFTS_,
+				logsSearcher.arg (ftsSource, ftsCondition, MatchCondition ("h")));
+		prepare (LogsSearcherWOContactFTS_,
+				woContactSearcher.arg (ftsSource, ftsCondition, MatchCondition ("h")));
+		prepare (LogsSearcherWOContactAccountFTS_,
+				woContactAccountSearcher.arg (ftsSource, ftsCondition, MatchCondition ("h")));
+		prepare (HitsSearcherFTS_,
+				hitsSearcher.arg (ftsSource, ftsCondition, MatchCondition ("h")));
+	}
+
+	bool Storage::CanUseFTS (const QString& text) const
+	{
+		/* The candidates are selected by a LIKE pattern, so the text
+		 * shouldn't contain anything that is special for either LIKE or
+		 * GLOB for the superset property to hold.
+		 */
+		static const QString specials = "%_*?[]\\";
+		return HasFTS_ &&
+				std::none_of (text.begin (), text.end (),
+						[] (QChar c) { return specials.contains (c); });
+	}
+
 	QHash<QString, qint32> Storage::GetUsers ()
 	{
 		if (!UserSelector_.exec ())
@@ -540,31 +700,33 @@ namespace ChatHistory
 
 		const qint32 intEntryId = Users_ [entryId];
 		const qint32 intAccId = Accounts_ [accountId];
-		LogsSearcher_.bindValue (":entry_id", intEntryId);
-		LogsSearcher_.bindValue (":account_id", intAccId);
-		LogsSearcher_.bindValue (":inner_entry_id", intEntryId);
-		LogsSearcher_.bindValue (":inner_account_id", intAccId);
-		LogsSearcher_.bindValue (":text", '%' + text + '%');
-		LogsSearcher_.bindValue (":ctext", '*' + text + '*');
-		LogsSearcher_.bindValue (":sensitive", static_cast<int> (cs));
-		LogsSearcher_.bindValue (":insensitive", static_cast<int> (!cs));
-		LogsSearcher_.bindValue (":offset", shift);
-		if (!LogsSearcher_.exec ())
-		{
-			Util::DBLock::DumpError (LogsSearcher_);
+		auto& query = CanUseFTS (text) ? LogsSearcherFTS_ : LogsSearcher_;
+		query.bindValue (":entry_id", intEntryId);
+		query.bindValue (":account_id", intAccId);
+		query.bindValue (":inner_entry_id", intEntryId);
+		query.bindValue (":inner_account_id", intAccId);
+		query.bindValue (":text", '%' + text + '%');
+		query.bindValue (":fts_text", '%' + text + '%');
+		query.bindValue (":ctext", '*' + text + '*');
+		query.bindValue (":sensitive", static_cast<int> (cs));
+		query.bindValue (":insensitive", static_cast<int> (!cs));
+		query.bindValue (":offset", shift);
+		if (!query.exec ())
+		{
+			Util::DBLock::DumpError (query);
 			return {};
 		}
-		auto guard = CleanupQueryGuard (LogsSearcher_);
+		auto guard = CleanupQueryGuard (query);
 
-		if (!LogsSearcher_.next ())
+		if (!query.next ())
 		{
 			qWarning () << Q_FUNC_INFO
 					<< "unable to move to the next entry";
-			Util::DBLock::DumpError (LogsSearcher_);
+			Util::DBLock::DumpError (query);
 			return {};
 		}
 
-		return { intEntryId, intAccId, LogsSearcher_.value (0).value<qint64> () };
+		return { intEntryId, intAccId, query.value (0).value<qint64> () };
 	}
 
 	Storage::RawSearchResult Storage::SearchImpl (const QString& accountId,
@@ -581,63 +743,67 @@ namespace ChatHistory
 		}
 
 		const qint32 intAccId = Accounts_ [accountId];
-		LogsSearcherWOContact_.bindValue (":account_id", intAccId);
-		LogsSearcherWOContact_.bindValue (":inner_account_id", intAccId);
-		LogsSearcherWOContact_.bindValue (":text", '%' + text + '%');
-		LogsSearcherWOContact_.bindValue (":ctext", '*' + text + '*');
-		LogsSearcherWOContact_.bindValue (":sensitive", static_cast<int> (cs));
-		LogsSearcherWOContact_.bindValue (":insensitive", static_cast<int> (!cs));
-		LogsSearcherWOContact_.bindValue (":offset", shift);
-		if (!LogsSearcherWOContact_.exec ())
-		{
-			Util::DBLock::DumpError (LogsSearcherWOContact_);
+		auto& query = CanUseFTS (text) ? LogsSearcherWOContactFTS_ : LogsSearcherWOContact_;
+		query.bindValue (":account_id", intAccId);
+		query.bindValue (":inner_account_id", intAccId);
+		query.bindValue (":text", '%' + text + '%');
+		query.bindValue (":fts_text", '%' + text + '%');
+		query.bindValue (":ctext", '*' + text + '*');
+		query.bindValue (":sensitive", static_cast<int> (cs));
+		query.bindValue (":insensitive", static_cast<int> (!cs));
+		query.bindValue (":offset", shift);
+		if (!query.exec ())
+		{
+			Util::DBLock::DumpError (query);
 			return RawSearchResult ();
 		}
 
-		if (!LogsSearcherWOContact_.next ())
+		if (!query.next ())
 		{
 			qWarning () << Q_FUNC_INFO
 					<< "unable to move to the next entry";
 			return RawSearchResult ();
 		}
 
-		auto guard = CleanupQueryGuard (LogsSearcherWOContact_);
+		auto guard = CleanupQueryGuard (query);
 
 		return
 		{
-			LogsSearcherWOContact_.value (1).toInt (),
+			query.value (1).toInt (),
 			intAccId,
-			LogsSearcherWOContact_.value (0).value<qint64> ()
+			query.value (0).value<qint64> ()
 		};
 	}
 
 	Storage::RawSearchResult Storage::SearchImpl (const QString& text, int shift, bool cs)
 	{
-		LogsSearcherWOContactAccount_.bindValue (":text", '%' + text + '%');
-		LogsSearcherWOContactAccount_.bindValue (":ctext", '*' + text + '*');
-		LogsSearcherWOContactAccount_.bindValue (":sensitive", static_cast<int> (cs));
-		LogsSearcherWOContactAccount_.bindValue (":insensitive", static_cast<int> (!cs));
-		LogsSearcherWOContactAccount_.bindValue (":offset", shift);
-		if (!LogsSearcherWOContactAccount_.exec ())
-		{
-			Util::DBLock::DumpError (LogsSearcherWOContactAccount_);
+		auto& query = CanUseFTS (text) ? LogsSearcherWOContactAccountFTS_ : LogsSearcherWOContactAccount_;
+		query.bindValue (":text", '%' + text + '%');
+		query.bindValue (":fts_text", '%' + text + '%');
+		query.bindValue (":ctext", '*' + text + '*');
+		query.bindValue (":sensitive", static_cast<int> (cs));
+		query.bindValue (":insensitive", static_cast<int> (!cs));
+		query.bindValue (":offset", shift);
+		if (!query.exec ())
+		{
+			Util::DBLock::DumpError (query);
 			return RawSearchResult ();
 		}
 
-		if (!LogsSearcherWOContactAccount_.next ())
+		if (!query.next ())
 		{
 			qWarning () << Q_FUNC_INFO
 					<< "unable to move to the next entry";
 			return RawSearchResult ();
 		}
 
-		auto guard = CleanupQueryGuard (LogsSearcherWOContactAccount_);
+		auto guard = CleanupQueryGuard (query);
 
 		return
 		{
-			LogsSearcherWOContactAccount_.value (1).toInt (),
-			LogsSearcherWOContactAccount_.value (2).toInt (),
-			LogsSearcherWOContactAccount_.value (0).value<qint64> ()
+			query.value (1).toInt (),
+			query.value (2).toInt (),
+			query.value (0).value<qint64> ()
 		};
 	}
 
@@ -687,6 +853,8 @@ namespace ChatHistory
 
 	boost::optional<int> Storage::GetAllHistoryCount ()
 	{
+		FlushPendingWrites ();
+
 		QSqlQuery query { *DB_ };
 		if (!query.exec ("SELECT COUNT(1) FROM azoth_history"))
 		{
@@ -706,6 +874,8 @@ namespace ChatHistory
 
 	void Storage::RegenUsersCache ()
 	{
+		FlushPendingWrites ();
+
 		QSqlQuery query (*DB_);
 		if (!query.exec ("DELETE FROM azoth_acc2users2;") ||
 			!query.exec ("INSERT INTO azoth_acc2users2 (AccountId, UserId) SELECT DISTINCT AccountId, Id FROM azoth_history;"))
@@ -795,19 +965,182 @@ namespace ChatHistory
 			const QString& entryID, const QString& visibleName,
 			const QList<LogItem>& items, bool fuzzy)
 	{
-		Util::DBLock lock (*DB_);
-		try
-		{
-			lock.Init ();
-		}
-		catch (const std::exception& e)
+		PendingWrites_.append ({ accountID, entryID, visibleName, items, fuzzy });
+		PendingItemsCount_ += items.size ();
+
+		if (fuzzy || PendingItemsCount_ >= MaxBatchSize_)
+			FlushPendingWrites ();
+		else if (!FlushTimer_->isActive ())
+			FlushTimer_->start ();
+	}
+
+	void Storage::SetWriteBatching (int windowMs, int maxBatchSize)
+	{
+		FlushTimer_->setInterval (std::max (windowMs, 0));
+		MaxBatchSize_ = std::max (maxBatchSize, 1);
+
+		if (PendingItemsCount_ >= MaxBatchSize_)
+			FlushPendingWrites ();
+	}
+
+	void Storage::FlushPendingWrites ()
+	{
+		FlushTimer_->stop ();
+
+		if (PendingWrites_.isEmpty ())
+			return;
+
+		const auto writes = std::move (PendingWrites_);
+		PendingWrites_.clear ();
+		const auto itemsCount = PendingItemsCount_;
+		PendingItemsCount_ = 0;
+
+		QList<CacheState> states;
+		const auto requeue = [&]
 		{
+			for (auto i = states.rbegin (); i != states.rend (); ++i)
+				RestoreCacheState (*i);
+
 			qWarning () << Q_FUNC_INFO
-					<< "unable to start transaction:"
-					<< e.what ();
+					<< "requeueing"
+					<< itemsCount
+					<< "messages";
+			PendingWrites_ = writes + PendingWrites_;
+			PendingItemsCount_ += itemsCount;
+			FlushTimer_->start ();
+		};
+
+		if (!DB_->transaction ())
+		{
+			Util::DBLock::DumpError (DB_->lastError ());
+			requeue ();
 			return;
 		}
 
+		const auto abort = [&] (const QSqlQuery& query)
+		{
+			Util::DBLock::DumpError (query);
+			if (!DB_->rollback ())
+				Util::DBLock::DumpError (DB_->lastError ());
+			requeue ();
+		};
+
+		/* Each chunk is written under its own savepoint, so that a single
+		 * broken chunk doesn't take the rest of the batch down with it.
+		 */
+		QSqlQuery savepoint (*DB_);
+		for (const auto& write : writes)
+		{
+			states << GetCacheState (write);
+
+			if (!savepoint.exec ("SAVEPOINT azoth_history_write;"))
+			{
+				abort (savepoint);
+				return;
+			}
+
+			if (!WriteMessages (write))
+			{
+				if (!savepoint.exec ("ROLLBACK TO azoth_history_write;"))
+				{
+					abort (savepoint);
+					return;
+				}
+				RestoreCacheState (states.last ());
+
+				if (!WriteMessagesOneByOne (write))
+				{
+					abort (savepoint);
+					return;
+				}
+			}
+
+			if (!savepoint.exec ("RELEASE azoth_history_write;"))
+			{
+				abort (savepoint);
+				return;
+			}
+		}
+
+		if (!DB_->commit ())
+		{
+			Util::DBLock::DumpError (DB_->lastError ());
+			if (!DB_->rollback ())
+				Util::DBLock::DumpError (DB_->lastError ());
+			requeue ();
+		}
+	}
+
+	bool Storage::WriteMessagesOneByOne (const PendingMessages& messages)
+	{
+		QSqlQuery savepoint (*DB_);
+		for (const auto& item : messages.Items_)
+		{
+			auto single = messages;
+			single.Items_ = { item };
+
+			const auto& state = GetCacheState (single);
+			if (!savepoint.exec ("SAVEPOINT azoth_history_row;"))
+			{
+				Util::DBLock::DumpError (savepoint);
+				return false;
+			}
+
+			if (!WriteMessages (single))
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "dropping the message from"
+						<< messages.EntryID_
+						<< "at"
+						<< item.Date_;
+
+				if (!savepoint.exec ("ROLLBACK TO azoth_history_row;"))
+				{
+					Util::DBLock::DumpError (savepoint);
+					return false;
+				}
+				RestoreCacheState (state);
+			}
+
+			if (!savepoint.exec ("RELEASE azoth_history_row;"))
+			{
+				Util::DBLock::DumpError (savepoint);
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	Storage::CacheState Storage::GetCacheState (const PendingMessages& messages) const
+	{
+		const auto& entryId = messages.EntryID_;
+		return
+		{
+			messages.AccountID_,
+			entryId,
+			Accounts_.contains (messages.AccountID_),
+			Users_.contains (entryId),
+			Users_.contains (entryId) && EntryCache_.contains (Users_ [entryId])
+		};
+	}
+
+	void Storage::RestoreCacheState (const CacheState& state)
+	{
+		if (!state.HadEntryCache_ && Users_.contains (state.EntryID_))
+			EntryCache_.remove (Users_ [state.EntryID_]);
+		if (!state.HadUser_)
+			Users_.remove (state.EntryID_);
+		if (!state.HadAccount_)
+			Accounts_.remove (state.AccountID_);
+	}
+
+	bool Storage::WriteMessages (const PendingMessages& messages)
+	{
+		const auto& accountID = messages.AccountID_;
+		const auto& entryID = messages.EntryID_;
+		const bool fuzzy = messages.Fuzzy_;
+
 		if (!Accounts_.contains (accountID))
 			try
 			{
@@ -819,8 +1152,10 @@ namespace ChatHistory
 						<< accountID
 						<< "unable to add account ID to the DB:"
 						<< e.what ();
-				return;
+				return false;
 			}
+		if (!Accounts_.contains (accountID))
+			return false;
 
 		if (!Users_.contains (entryID))
 			try
@@ -833,21 +1168,23 @@ namespace ChatHistory
 						<< entryID
 						<< "unable to add the user to the DB:"
 						<< e.what ();
-				return;
+				return false;
 			}
+		if (!Users_.contains (entryID))
+			return false;
 
 		auto userId = Users_ [entryID];
 		if (!EntryCache_.contains (userId))
 		{
 			EntryCacheSetter_.bindValue (":id", userId);
-			EntryCacheSetter_.bindValue (":visible_name", visibleName);
+			EntryCacheSetter_.bindValue (":visible_name", messages.VisibleName_);
 			if (!EntryCacheSetter_.exec ())
 				Util::DBLock::DumpError (EntryCacheSetter_);
 
-			EntryCache_ [userId] = visibleName;
+			EntryCache_ [userId] = messages.VisibleName_;
 		}
 
-		for (const auto& logItem : items)
+		for (const auto& logItem : messages.Items_)
 		{
 			auto& query = fuzzy ? MessageDumperFuzzy_ : MessageDumper_;
 
@@ -859,15 +1196,17 @@ namespace ChatHistory
 			if (!query.exec ())
 			{
 				Util::DBLock::DumpError (query);
-				return;
+				return false;
 			}
 		}
 
-		lock.Good ();
+		return true;
 	}
 
 	IHistoryPlugin::MaxTimestampResult_t Storage::GetMaxTimestamp (const QString& accountId)
 	{
+		FlushPendingWrites ();
+
 		using R_t = IHistoryPlugin::MaxTimestampResult_t;
 
 		if (!Accounts_.contains (accountId))
@@ -886,13 +1225,17 @@ namespace ChatHistory
 		return R_t::Right (MaxTimestampSelector_.value (0).toDateTime ());
 	}
 
-	QStringList Storage::GetOurAccounts () const
+	QStringList Storage::GetOurAccounts ()
 	{
+		FlushPendingWrites ();
+
 		return Accounts_.keys ();
 	}
 
 	UsersForAccountResult_t Storage::GetUsersForAccount (const QString& accountId)
 	{
+		FlushPendingWrites ();
+
 		if (!Accounts_.contains (accountId))
 		{
 			qWarning () << Q_FUNC_INFO
@@ -949,6 +1292,8 @@ namespace ChatHistory
 	ChatLogsResult_t Storage::GetChatLogs (const QString& accountId,
 			const QString& entryId, int backpages, int amount)
 	{
+		FlushPendingWrites ();
+
 		if (!Accounts_.contains (accountId))
 		{
 			qWarning () << Q_FUNC_INFO
@@ -999,6 +1344,8 @@ namespace ChatHistory
 	SearchResult_t Storage::Search (const QString& accountId,
 			const QString& entryId, const QString& text, int shift, bool cs)
 	{
+		FlushPendingWrites ();
+
 		RawSearchResult res;
 		if (!accountId.isEmpty () && !entryId.isEmpty ())
 			res = SearchImpl (accountId, entryId, text, shift, cs);
@@ -1013,8 +1360,103 @@ namespace ChatHistory
 		return SearchRowIdImpl (res.AccountID_, res.EntryID_, res.RowID_);
 	}
 
+	SearchHitsResult_t Storage::SearchHits (const QString& accountId,
+			const QString& entryId, const QString& text, int offset, int limit, bool cs)
+	{
+		FlushPendingWrites ();
+
+		if (!Accounts_.contains (accountId))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "Accounts_ doesn't contain"
+					<< accountId
+					<< "; raw contents"
+					<< Accounts_;
+			return SearchHitsResult_t::Left ("Unknown account.");
+		}
+		if (!Users_.contains (entryId))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "Users_ doesn't contain"
+					<< entryId
+					<< "; raw contents"
+					<< Users_;
+			return SearchHitsResult_t::Left ("Unknown user.");
+		}
+
+		const qint32 intEntryId = Users_ [entryId];
+		const qint32 intAccId = Accounts_ [accountId];
+
+		auto& query = CanUseFTS (text) ? HitsSearcherFTS_ : HitsSearcher_;
+		query.bindValue (":entry_id", intEntryId);
+		query.bindValue (":account_id", intAccId);
+		query.bindValue (":text", '%' + text + '%');
+		query.bindValue (":fts_text", '%' + text + '%');
+		query.bindValue (":ctext", '*' + text + '*');
+		query.bindValue (":sensitive", static_cast<int> (cs));
+		query.bindValue (":insensitive", static_cast<int> (!cs));
+		query.bindValue (":offset", offset);
+		query.bindValue (":limit", limit);
+		if (!query.exec ())
+		{
+			Util::DBLock::DumpError (query);
+			return SearchHitsResult_t::Left ("Unable to execute search query.");
+		}
+
+		QList<SearchHit> hits;
+		{
+			auto guard = CleanupQueryGuard (query);
+			while (query.next ())
+				hits.append ({
+						query.value (0).value<qint64> (),
+						query.value (1).toDateTime (),
+						0
+					});
+		}
+
+		if (hits.isEmpty ())
+			return SearchHitsResult_t::Right (hits);
+
+		/* Only the position of the newest hit is computed from scratch,
+		 * the other ones are derived by counting the messages between
+		 * the adjacent hits, so the whole batch costs about the same as
+		 * a single full count.
+		 */
+		const auto& firstPos = SearchRowIdImpl (intAccId, intEntryId, hits.first ().RowID_);
+		if (const auto& err = firstPos.MaybeLeft ())
+			return SearchHitsResult_t::Left (*err);
+		const auto& maybeFirst = firstPos.GetRight ();
+		if (!maybeFirst)
+			return SearchHitsResult_t::Left ("Unable to get the position of the first hit.");
+
+		hits.first ().Position_ = *maybeFirst;
+
+		RowIDRange2Count_.bindValue (":entry_id", intEntryId);
+		RowIDRange2Count_.bindValue (":account_id", intAccId);
+		for (int i = 1; i < hits.size (); ++i)
+		{
+			RowIDRange2Count_.bindValue (":lower_rowid", hits.at (i).RowID_);
+			RowIDRange2Count_.bindValue (":upper_rowid", hits.at (i - 1).RowID_);
+			if (!RowIDRange2Count_.exec ())
+			{
+				Util::DBLock::DumpError (RowIDRange2Count_);
+				return SearchHitsResult_t::Left ("Unable to execute search query.");
+			}
+
+			auto guard = CleanupQueryGuard (RowIDRange2Count_);
+			if (!RowIDRange2Count_.next ())
+				return SearchHitsResult_t::Left ("Unable to get the position of a hit.");
+
+			hits [i].Position_ = hits.at (i - 1).Position_ + RowIDRange2Count_.value (0).toInt ();
+		}
+
+		return SearchHitsResult_t::Right (hits);
+	}
+
 	SearchResult_t Storage::SearchDate (const QString& account, const QString& entry, const QDateTime& dt)
 	{
+		FlushPendingWrites ();
+
 		if (!Accounts_.contains (account))
 		{
 			qWarning () << Q_FUNC_INFO
@@ -1041,6 +1483,8 @@ namespace ChatHistory
 
 	DaysResult_t Storage::GetDaysForSheet (const QString& account, const QString& entry, int year, int month)
 	{
+		FlushPendingWrites ();
+
 		if (!Accounts_.contains (account))
 		{
 			qWarning () << Q_FUNC_INFO
@@ -1090,6 +1534,8 @@ namespace ChatHistory
 
 	void Storage::ClearHistory (const QString& accountId, const QString& entryId)
 	{
+		FlushPendingWrites ();
+
 		if (!Accounts_.contains (accountId) ||
 				!Users_.contains (entryId))
 		{
@@ -39,6 +39,7 @@
 #include "storagestructures.h"
 
 class QSqlDatabase;
+class QTimer;
 
 namespace LeechCraft
 {
@@ -64,11 +65,17 @@ namespace ChatHistory
 		QSqlQuery MessageDumperFuzzy_;
 		QSqlQuery UsersForAccountGetter_;
 		QSqlQuery RowID2Pos_;
+		QSqlQuery RowIDRange2Count_;
 		QSqlQuery Date2Pos_;
 		QSqlQuery GetMonthDates_;
 		QSqlQuery LogsSearcher_;
 		QSqlQuery LogsSearcherWOContact_;
 		QSqlQuery LogsSearcherWOContactAccount_;
+		QSqlQuery HitsSearcher_;
+		QSqlQuery LogsSearcherFTS_;
+		QSqlQuery LogsSearcherWOContactFTS_;
+		QSqlQuery LogsSearcherWOContactAccountFTS_;
+		QSqlQuery HitsSearcherFTS_;
 		QSqlQuery HistoryGetter_;
 		QSqlQuery HistoryClearer_;
 		QSqlQuery UserClearer_;
@@ -81,6 +88,35 @@ namespace ChatHistory
 
 		QHash<qint32, QString> EntryCache_;
 
+		bool HasFTS_ = false;
+
+		struct PendingMessages
+		{
+			QString AccountID_;
+			QString EntryID_;
+			QString VisibleName_;
+			QList<LogItem> Items_;
+			bool Fuzzy_;
+		};
+		QList<PendingMessages> PendingWrites_;
+		int PendingItemsCount_ = 0;
+		int MaxBatchSize_ = 100;
+
+		QTimer * const FlushTimer_;
+
+		/* Which of the IDs cached in Accounts_, Users_ and EntryCache_
+		 * for a write were there before it, so that the ones it has added
+		 * can be forgotten if the write is rolled back.
+		 */
+		struct CacheState
+		{
+			QString AccountID_;
+			QString EntryID_;
+			bool HadAccount_;
+			bool HadUser_;
+			bool HadEntryCache_;
+		};
+
 		struct RawSearchResult
 		{
 			qint32 EntryID_ = 0;
@@ -94,6 +130,7 @@ namespace ChatHistory
 		};
 	public:
 		Storage (QObject* = nullptr);
+		~Storage ();
 
 		struct GeneralError
 		{
@@ -111,19 +148,61 @@ namespace ChatHistory
 
 		IHistoryPlugin::MaxTimestampResult_t GetMaxTimestamp (const QString&);
 
-		QStringList GetOurAccounts () const;
+		QStringList GetOurAccounts ();
 		UsersForAccountResult_t GetUsersForAccount (const QString&);
 		ChatLogsResult_t GetChatLogs (const QString& accountId,
 				const QString& entryId, int backpages, int amount);
 
+		/** @brief Queues the messages to be written to the database.
+		 *
+		 * The messages are written in a single transaction with the other
+		 * ones queued within the batching window (see SetWriteBatching()),
+		 * or right away if the fuzzy mode is requested. The queue is
+		 * flushed before any read, so the readers always see the queued
+		 * messages.
+		 */
 		void AddMessages (const QString& accountId, const QString& entryId,
 				const QString& visibleName, const QList<LogItem>&, bool fuzzy);
 
+		/** @brief Sets up the batching of the written messages.
+		 *
+		 * @param[in] windowMs The maximum time a message spends in the
+		 * queue before being written, in milliseconds.
+		 * @param[in] maxBatchSize The number of the queued messages that
+		 * triggers writing them regardless of the window.
+		 */
+		void SetWriteBatching (int windowMs, int maxBatchSize);
+
+		/** @brief Writes all the queued messages in a single transaction.
+		 *
+		 * If the transaction itself fails, the messages are put back to
+		 * the queue to be retried later. If a chunk of messages fails,
+		 * its messages are retried one by one, and only the ones that
+		 * still fail are dropped.
+		 */
+		void FlushPendingWrites ();
+
 		SearchResult_t Search (const QString& accountId, const QString& entryId,
 				const QString& text, int shift, bool cs);
 		SearchResult_t SearchDate (const QString& accountId,
 				const QString& entryId, const QDateTime& dt);
 
+		/** @brief Returns a batch of the search hits in the given chat.
+		 *
+		 * The hits are ordered from the newest to the oldest, and the
+		 * text is matched just like in Search().
+		 *
+		 * @param[in] accountId The ID of the account.
+		 * @param[in] entryId The ID of the entry.
+		 * @param[in] text The text to search for.
+		 * @param[in] offset The number of the newest hits to skip.
+		 * @param[in] limit The maximum number of hits to return.
+		 * @param[in] cs Whether the search is case sensitive.
+		 * @return The hits, or the error message.
+		 */
+		SearchHitsResult_t SearchHits (const QString& accountId, const QString& entryId,
+				const QString& text, int offset, int limit, bool cs);
+
 		DaysResult_t GetDaysForSheet (const QString& accountId, const QString& entryId, int year, int month);
 
 		boost::optional<int> GetAllHistoryCount ();
@@ -133,6 +212,15 @@ namespace ChatHistory
 	private:
 		void InitializeTables ();
 		void UpdateTables ();
+		bool InitializeFTS (const QStringList&);
+		void PrepareSearchers ();
+
+		bool CanUseFTS (const QString&) const;
+
+		bool WriteMessages (const PendingMessages&);
+		bool WriteMessagesOneByOne (const PendingMessages&);
+		CacheState GetCacheState (const PendingMessages&) const;
+		void RestoreCacheState (const CacheState&);
 
 		QHash<QString, qint32> GetUsers ();
 		qint32 GetUserID (const QString&);
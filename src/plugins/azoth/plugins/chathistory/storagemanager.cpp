@@ -41,6 +41,7 @@
 #include <interfaces/azoth/irichtextmessage.h>
 #include "storage.h"
 #include "loggingstatekeeper.h"
+#include "xmlsettingsmanager.h"
 
 namespace LeechCraft
 {
@@ -67,6 +68,10 @@ namespace ChatHistory
 					HandleStorageError (res.GetLeft ());
 				};
 
+		XmlSettingsManager::Instance ().RegisterObject ({ "WriteBatchWindow", "WriteBatchSize" },
+				this, "handleWriteBatchingChanged");
+		handleWriteBatchingChanged ();
+
 		auto checker = Util::ConsistencyChecker::Create (Storage::GetDatabasePath (), "Azoth ChatHistory");
 		Util::Sequence (this, checker->StartCheck ()) >>
 				Util::Visitor
@@ -94,6 +99,14 @@ namespace ChatHistory
 				};
 	}
 
+	void StorageManager::handleWriteBatchingChanged ()
+	{
+		const auto& xsm = XmlSettingsManager::Instance ();
+		StorageThread_->ScheduleImpl (&Storage::SetWriteBatching,
+				xsm.property ("WriteBatchWindow").toInt (),
+				xsm.property ("WriteBatchSize").toInt ());
+	}
+
 	namespace
 	{
 		QString GetVisibleName (const ICLEntry *entry)
@@ -168,6 +181,8 @@ namespace ChatHistory
 				visibleName,
 				items,
 				fuzzy);
+
+		emit logItemsAdded (accountId, entryId);
 	}
 
 	QFuture<IHistoryPlugin::MaxTimestampResult_t> StorageManager::GetMaxTimestamp (const QString& accId)
@@ -202,6 +217,12 @@ namespace ChatHistory
 		return StorageThread_->ScheduleImpl (&Storage::SearchDate, accountId, entryId, dt);
 	}
 
+	QFuture<SearchHitsResult_t> StorageManager::SearchHits (const QString& accountId, const QString& entryId,
+			const QString& text, int offset, int limit, bool cs)
+	{
+		return StorageThread_->ScheduleImpl (&Storage::SearchHits, accountId, entryId, text, offset, limit, cs);
+	}
+
 	QFuture<DaysResult_t> StorageManager::GetDaysForSheet (const QString& accountId, const QString& entryId, int year, int month)
 	{
 		return StorageThread_->ScheduleImpl (&Storage::GetDaysForSheet, accountId, entryId, year, month);
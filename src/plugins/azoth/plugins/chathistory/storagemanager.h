@@ -45,6 +45,8 @@ namespace ChatHistory
 
 	class StorageManager : public QObject
 	{
+		Q_OBJECT
+
 		const std::shared_ptr<StorageThread> StorageThread_;
 		LoggingStateKeeper * const LoggingStateKeeper_;
 	public:
@@ -65,6 +67,8 @@ namespace ChatHistory
 		QFuture<SearchResult_t> Search (const QString& accountId, const QString& entryId,
 				const QString& text, int shift, bool cs);
 		QFuture<SearchResult_t> Search (const QString& accountId, const QString& entryId, const QDateTime& dt);
+		QFuture<SearchHitsResult_t> SearchHits (const QString& accountId, const QString& entryId,
+				const QString& text, int offset, int limit, bool cs);
 
 		QFuture<DaysResult_t> GetDaysForSheet (const QString& accountId, const QString& entryId, int year, int month);
 		void ClearHistory (const QString& accountId, const QString& entryId);
@@ -74,6 +78,10 @@ namespace ChatHistory
 		void StartStorage ();
 		void HandleStorageError (const Storage::InitializationError_t&);
 		void HandleDumpFinished (qint64, qint64);
+	private slots:
+		void handleWriteBatchingChanged ();
+	signals:
+		void logItemsAdded (const QString& accountId, const QString& entryId);
 	};
 }
 }
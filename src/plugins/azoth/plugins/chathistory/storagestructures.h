@@ -31,6 +31,7 @@
 
 #include <boost/optional.hpp>
 #include <QStringList>
+#include <QDateTime>
 #include <util/sll/either.h>
 #include <interfaces/azoth/imessage.h>
 #include <interfaces/azoth/ihistoryplugin.h>
@@ -56,6 +57,19 @@ namespace ChatHistory
 
 	using SearchResult_t = Util::Either<QString, boost::optional<int>>;
 
+	struct SearchHit
+	{
+		qint64 RowID_;
+		QDateTime Date_;
+
+		/** The number of messages newer than this one in the same chat,
+		 * that is, the position as understood by GetChatLogs().
+		 */
+		int Position_;
+	};
+
+	using SearchHitsResult_t = Util::Either<QString, QList<SearchHit>>;
+
 	using DaysResult_t = Util::Either<QString, QList<int>>;
 }
 }
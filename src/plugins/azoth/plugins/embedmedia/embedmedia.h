@@ -49,7 +49,7 @@ namespace EmbedMedia
 		Q_OBJECT
 		Q_INTERFACES (IInfo IPlugin2)
 
-		LC_PLUGIN_METADATA ("org.LeechCraft.Azoth.EmbedMedia")
+		LC_PLUGIN_METADATA_FILE ("org.LeechCraft.Azoth.EmbedMedia", "manifest.json")
 
 		QString	ScriptContent_;
 	public:
@@ -49,7 +49,7 @@ namespace Juick
 		Q_OBJECT
 		Q_INTERFACES (IInfo IPlugin2)
 
-		LC_PLUGIN_METADATA ("org.LeechCraft.Azoth.Juick")
+		LC_PLUGIN_METADATA_FILE ("org.LeechCraft.Azoth.Juick", "manifest.json")
 
 		QRegExp UserRX_;
 		QRegExp PostRX_;
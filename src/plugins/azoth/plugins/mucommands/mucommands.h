@@ -54,7 +54,7 @@ namespace MuCommands
 				IPlugin2
 				LeechCraft::Azoth::IProvideCommands)
 
-		LC_PLUGIN_METADATA ("org.LeechCraft.Azoth.MuCommands")
+		LC_PLUGIN_METADATA_FILE ("org.LeechCraft.Azoth.MuCommands", "manifest.json")
 
 		StaticCommand Names_;
 		StaticCommand ListUrls_;
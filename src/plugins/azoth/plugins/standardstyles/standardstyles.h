@@ -49,7 +49,7 @@ namespace StandardStyles
 		Q_OBJECT
 		Q_INTERFACES (IInfo IPlugin2 LeechCraft::Azoth::IResourcePlugin)
 
-		LC_PLUGIN_METADATA ("org.LeechCraft.Azoth.StandardStyles")
+		LC_PLUGIN_METADATA_FILE ("org.LeechCraft.Azoth.StandardStyles", "manifest.json")
 
 		IProxyObject *Proxy_;
 		QObjectList ResourceSources_;
@@ -34,12 +34,15 @@
 #include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/path.hpp>
 #include <boost/filesystem/fstream.hpp>
+#include <boost/optional.hpp>
 #include <QFile>
 #include <QDir>
 #include <QFileInfo>
 #include <QSettings>
 #include <QToolBar>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QtConcurrentMap>
 #include <QMenu>
 #include <QDomDocument>
 #include <QDomElement>
@@ -94,6 +97,7 @@
 #include "notifymanager.h"
 #include "sessionsettingsmanager.h"
 #include "cachedstatuskeeper.h"
+#include "torrentstore.h"
 #include "geoip.h"
 #include "sessionstats.h"
 
@@ -115,6 +119,8 @@ namespace BitTorrent
 	Core::Core ()
 	: StatusKeeper_ { new CachedStatusKeeper { this } }
 	, NotifyManager_ { new NotifyManager { this } }
+	, UpdateBatcher_ { StatusKeeper_, RowIndex_ }
+	, ModelUpdateTimer_ { new QTimer }
 	, FinishedTimer_ { new QTimer }
 	, WarningWatchdog_ { new QTimer }
 	, GeoIP_ { std::make_shared<GeoIP> () }
@@ -227,6 +233,17 @@ namespace BitTorrent
 				SLOT (queryLibtorrent ()));
 		WarningWatchdog_->start (2000);
 
+		/* Caps the rate of dataChanged() emissions, no matter how often
+		 * libtorrent posts status updates.
+		 */
+		const int MaxModelUpdatesPerSecond = 4;
+		ModelUpdateTimer_->setSingleShot (true);
+		ModelUpdateTimer_->setInterval (1000 / MaxModelUpdatesPerSecond);
+		connect (ModelUpdateTimer_.get (),
+				SIGNAL (timeout ()),
+				this,
+				SLOT (flushModelUpdates ()));
+
 		connect (SessionSettingsMgr_,
 				SIGNAL (scrapeRequested ()),
 				this,
@@ -236,16 +253,30 @@ namespace BitTorrent
 				this,
 				SLOT (writeSettings ()));
 
+		Store_ = std::make_shared<TorrentStore> (Util::CreateIfNotExists ("bittorrent/store"));
 		RestoreTorrents ();
 	}
 
 	void Core::Release ()
 	{
+		QElapsedTimer timer;
+		timer.start ();
+
 		Session_->pause ();
-		writeSettings ();
+		WriteSettings (StatusSource::Live);
+		WaitForResumeData ();
+		Store_.reset ();
+
+		qDebug () << Q_FUNC_INFO
+				<< "saved"
+				<< Handles_.size ()
+				<< "torrents in"
+				<< timer.elapsed ()
+				<< "ms";
 
 		FinishedTimer_.reset ();
 		WarningWatchdog_.reset ();
+		ModelUpdateTimer_.reset ();
 
 		qDeleteAll (children ());
 
@@ -257,6 +288,7 @@ namespace BitTorrent
 	{
 		Proxy_ = proxy;
 		ShortcutMgr_ = new ShortcutManager (proxy, this);
+		TorrentMaker_ = new TorrentMaker (proxy, this);
 		LiveStreamManager_ = std::make_shared<LiveStreamManager> (StatusKeeper_, proxy);
 	}
 
@@ -270,6 +302,11 @@ namespace BitTorrent
 		return ShortcutMgr_;
 	}
 
+	TorrentMaker* Core::GetTorrentMaker () const
+	{
+		return TorrentMaker_;
+	}
+
 	SessionSettingsManager* Core::GetSessionSettingsManager () const
 	{
 		return SessionSettingsMgr_;
@@ -958,9 +995,9 @@ namespace BitTorrent
 			params
 		};
 
-		beginInsertRows ({}, Handles_.size (), Handles_.size ());
-		Handles_ << tmp;
-		endInsertRows ();
+		AppendTorrent (tmp, path);
+		OrderDirty_ = true;
+		MarkDirty (Handles_.size () - 1);
 
 		return tmp.ID_;
 	}
@@ -1022,14 +1059,13 @@ namespace BitTorrent
 
 		handle.auto_managed (autoManaged);
 
-		beginInsertRows (QModelIndex (), Handles_.size (), Handles_.size ());
 		auto torrentFileName = QString::fromStdString (handle
 					.status (libtorrent::torrent_handle::query_name).name);
 		if (!torrentFileName.endsWith (".torrent"))
 			torrentFileName.append (".torrent");
 
 		const auto newId = Proxy_->GetID ();
-		Handles_.append ({
+		AppendTorrent ({
 				priorities,
 				handle,
 				contents,
@@ -1038,8 +1074,7 @@ namespace BitTorrent
 				autoManaged,
 				newId,
 				params
-			});
-		endInsertRows ();
+			}, path);
 
 		if (tryLive)
 		{
@@ -1047,7 +1082,8 @@ namespace BitTorrent
 			handle.resume ();
 		}
 
-		ScheduleSave ();
+		OrderDirty_ = true;
+		MarkDirty (Handles_.size () - 1);
 		return newId;
 	}
 
@@ -1073,7 +1109,13 @@ namespace BitTorrent
 		beginRemoveRows (QModelIndex (), pos, pos);
 		Session_->remove_torrent (Handles_.at (pos).Handle_, roptions);
 		int id = Handles_.at (pos).ID_;
+		const auto& hash = Handles_.at (pos).InfoHash_;
+		RowIndex_.Remove (hash);
+		DirtyTorrents_.remove (hash);
+		Store_->Remove (hash);
+		OrderDirty_ = true;
 		Handles_.removeAt (pos);
+		ReindexRows (pos);
 		Proxy_->FreeID (id);
 		endRemoveRows ();
 
@@ -1220,6 +1262,7 @@ namespace BitTorrent
 		{
 			Handles_ [idx].FilePriorities_.at (file) = priority;
 			Handles_.at (idx).Handle_.prioritize_files (Handles_.at (idx).FilePriorities_);
+			MarkDirty (idx);
 		}
 		catch (...)
 		{
@@ -1311,6 +1354,7 @@ namespace BitTorrent
 
 		Handles_.at (idx).Handle_.auto_managed (man);
 		Handles_ [idx].AutoManaged_ = man;
+		MarkDirty (idx);
 	}
 
 	bool Core::IsTorrentSequentialDownload (int idx) const
@@ -1347,8 +1391,12 @@ namespace BitTorrent
 
 	void Core::MakeTorrent (const NewTorrentParams& params) const
 	{
-		const auto tm = new TorrentMaker { Proxy_ };
-		tm->Start (params);
+		MakeTorrents ({ params });
+	}
+
+	void Core::MakeTorrents (const QList<NewTorrentParams>& params) const
+	{
+		TorrentMaker_->Start (params);
 	}
 
 	void Core::SetExternalAddress (const QString& address)
@@ -1405,8 +1453,10 @@ namespace BitTorrent
 		return result;
 	}
 
-	void Core::SaveResumeData (const libtorrent::save_resume_data_alert& a) const
+	void Core::SaveResumeData (const libtorrent::save_resume_data_alert& a)
 	{
+		PendingResumeData_ = std::max (PendingResumeData_ - 1, 0);
+
 		const auto torrent = FindHandle (a.handle);
 		if (torrent == Handles_.end ())
 		{
@@ -1425,23 +1475,24 @@ namespace BitTorrent
 			return;
 		}
 
-		const auto& filePath = Util::CreateIfNotExists ("bittorrent")
-				.filePath (torrent->TorrentFileName_ + ".resume");
-		QFile file { filePath };
+		QByteArray resumeData;
+		libtorrent::bencode (std::back_inserter (resumeData), *a.resume_data.get ());
+		Store_->SaveResumeData (torrent->InfoHash_, resumeData);
+	}
 
-		if (!file.open (QIODevice::WriteOnly))
-		{
-			qWarning () << QString ("Could not open file %1 for write: %2")
-				.arg (file.fileName ())
-				.arg (file.errorString ());
-			return;
-		}
+	void Core::HandleResumeDataFailed ()
+	{
+		PendingResumeData_ = std::max (PendingResumeData_ - 1, 0);
+	}
 
-		std::deque<char> outbuf;
-		libtorrent::bencode (std::back_inserter (outbuf), *a.resume_data.get ());
+	void Core::HandleStorageMoved (const libtorrent::torrent_handle& handle, const QString& path)
+	{
+		const auto torrent = FindHandle (handle);
+		if (torrent == Handles_.end ())
+			return;
 
-		for (size_t i = 0; i < outbuf.size (); ++i)
-			file.write (&outbuf.at (i), 1);
+		torrent->SavePath_ = path;
+		MarkDirty (std::distance (Handles_.begin (), torrent));
 	}
 
 	void Core::HandleMetadata (const libtorrent::metadata_received_alert& a)
@@ -1474,11 +1525,12 @@ namespace BitTorrent
 		e ["info"] = infoE;
 		libtorrent::bencode (std::back_inserter (torrent->TorrentFileContents_), e);
 
+		const auto row = std::distance (Handles_.begin (), torrent);
 		qDebug () << "HandleMetadata"
-			<< std::distance (Handles_.begin (), torrent)
+			<< row
 			<< torrent->TorrentFileName_;
 
-		ScheduleSave ();
+		MarkDirty (row);
 	}
 
 	void Core::PieceRead (const libtorrent::read_piece_alert& a)
@@ -1488,20 +1540,16 @@ namespace BitTorrent
 
 	void Core::UpdateStatus (const std::vector<libtorrent::torrent_status>& statuses)
 	{
-		for (const auto& status : statuses)
-		{
-			StatusKeeper_->HandleStatusUpdatePosted (status);
-			const auto pos = FindHandle (status.handle);
-			if (pos == Handles_.end ())
-			{
-				qWarning () << Q_FUNC_INFO
-						<< "unknown handle";
-				continue;
-			}
+		UpdateBatcher_.Post (statuses);
 
-			const auto row = std::distance (Handles_.begin (), pos);
-			emit dataChanged (index (row, 0), index (row, columnCount () - 1));
-		}
+		if (UpdateBatcher_.HasPending () && !ModelUpdateTimer_->isActive ())
+			ModelUpdateTimer_->start ();
+	}
+
+	void Core::flushModelUpdates ()
+	{
+		for (const auto& range : UpdateBatcher_.TakeChangedRanges ())
+			emit dataChanged (index (range.first, 0), index (range.second, columnCount () - 1));
 	}
 
 	void Core::HandleTorrentChecked (const libtorrent::torrent_handle& h)
@@ -1539,10 +1587,14 @@ namespace BitTorrent
 			Handles_.at (*i).Handle_.queue_position_up ();
 			std::swap (Handles_ [*i],
 					Handles_ [*i - 1]);
+			ReindexRows (*i - 1, *i + 1);
+			OrderDirty_ = true;
 
 			emit dataChanged (index (*i - 1, 0),
 					index (*i, columnCount () - 1));
 		}
+
+		ScheduleSave ();
 	}
 
 	void Core::MoveDown (const std::vector<int>& selections)
@@ -1561,10 +1613,14 @@ namespace BitTorrent
 			Handles_.at (*i).Handle_.queue_position_down ();
 			std::swap (Handles_ [*i],
 					Handles_ [*i + 1]);
+			ReindexRows (*i, *i + 2);
+			OrderDirty_ = true;
 
 			emit dataChanged (index (*i, 0),
 					index (*i + 1, columnCount () - 1));
 		}
+
+		ScheduleSave ();
 	}
 
 	void Core::MoveToTop (const std::vector<int>& selections)
@@ -1580,6 +1636,9 @@ namespace BitTorrent
 		for (auto i = selections.rbegin (),
 				end = selections.rend (); i != end; ++i)
 			MoveToTop (*i);
+
+		OrderDirty_ = true;
+		ScheduleSave ();
 	}
 
 	void Core::MoveToBottom (const std::vector<int>& selections)
@@ -1595,6 +1654,9 @@ namespace BitTorrent
 		for (auto i = selections.begin (),
 				end = selections.end (); i != end; ++i)
 			MoveToBottom (*i);
+
+		OrderDirty_ = true;
+		ScheduleSave ();
 	}
 
 	QList<FileInfo> Core::GetTorrentFiles (int idx) const
@@ -1639,14 +1701,39 @@ namespace BitTorrent
 
 	auto Core::FindHandle (const libtorrent::torrent_handle& h) -> HandleDict_t::iterator
 	{
-		return std::find_if (Handles_.begin (), Handles_.end (),
-				[&h] (const TorrentStruct& ts) { return ts.Handle_ == h; });
+		const auto row = RowIndex_.Find (h.info_hash ());
+		if (row < 0 || Handles_.at (row).Handle_ != h)
+			return Handles_.end ();
+
+		return Handles_.begin () + row;
 	}
 
 	auto Core::FindHandle (const libtorrent::torrent_handle& h) const -> HandleDict_t::const_iterator
 	{
-		return std::find_if (Handles_.begin (), Handles_.end (),
-				[&h] (const TorrentStruct& ts) { return ts.Handle_ == h; });
+		const auto row = RowIndex_.Find (h.info_hash ());
+		if (row < 0 || Handles_.at (row).Handle_ != h)
+			return Handles_.end ();
+
+		return Handles_.begin () + row;
+	}
+
+	void Core::AppendTorrent (TorrentStruct torrent, const QString& savePath)
+	{
+		torrent.SavePath_ = savePath;
+
+		beginInsertRows ({}, Handles_.size (), Handles_.size ());
+		Handles_ << torrent;
+		RowIndex_.Insert (torrent.InfoHash_, Handles_.size () - 1);
+		endInsertRows ();
+	}
+
+	void Core::ReindexRows (int from, int to)
+	{
+		if (to < 0)
+			to = Handles_.size ();
+
+		RowIndex_.Reindex (Handles_, from, to,
+				[] (const TorrentStruct& torrent) { return torrent.InfoHash_; });
 	}
 
 	void Core::MoveToTop (int row)
@@ -1659,6 +1746,7 @@ namespace BitTorrent
 
 		beginInsertRows (QModelIndex (), 0, 0);
 		Handles_.push_front (tmp);
+		ReindexRows (0, row + 1);
 		endInsertRows ();
 	}
 
@@ -1672,16 +1760,155 @@ namespace BitTorrent
 
 		beginInsertRows (QModelIndex (), Handles_.size (), Handles_.size ());
 		Handles_.push_back (tmp);
+		ReindexRows (row);
 		endInsertRows ();
 	}
 
+	namespace
+	{
+		boost::optional<libtorrent::add_torrent_params> MakeRestoreParams (const QByteArray& data,
+				const QByteArray& resumeData,
+				const std::string& path,
+				bool automanaged,
+				bool pause,
+				libtorrent::storage_mode_t storageMode)
+		{
+			libtorrent::bdecode_node e;
+			if (!DecodeEntry (data, e))
+				return {};
+
+			try
+			{
+				libtorrent::add_torrent_params atp;
+				atp.ti = boost::make_shared<libtorrent::torrent_info> (e);
+				atp.storage_mode = storageMode;
+				atp.save_path = path;
+				if (!automanaged)
+					atp.flags &= ~libtorrent::add_torrent_params::flag_auto_managed;
+				if (pause)
+					atp.flags |= libtorrent::add_torrent_params::flag_paused;
+				atp.flags |= libtorrent::add_torrent_params::flag_duplicate_is_error;
+
+				std::copy (resumeData.constData (),
+						resumeData.constData () + resumeData.size (),
+						std::back_inserter (atp.resume_data));
+
+				return atp;
+			}
+			catch (const libtorrent::libtorrent_exception& e)
+			{
+				qWarning () << Q_FUNC_INFO << e.what ();
+				return {};
+			}
+		}
+	}
+
 	void Core::RestoreTorrents ()
 	{
-		const auto& torrentsDir = Util::CreateIfNotExists ("bittorrent");
+		QElapsedTimer timer;
+		timer.start ();
 
 		QSettings settings (QCoreApplication::organizationName (),
 				QCoreApplication::applicationName () + "_Torrent");
 		settings.beginGroup ("Core");
+
+		if (Store_->IsInitialized ())
+		{
+			RestoreStoredTorrents ();
+			RemoveLegacyTorrents (settings);
+		}
+		else
+			RestoreLegacyTorrents (settings);
+
+		int filters = settings.beginReadArray ("IPFilter");
+		for (int i = 0; i < filters; ++i)
+		{
+			settings.setArrayIndex (i);
+			BanRange_t range (settings.value ("First").toString (),
+					settings.value ("Last").toString ());
+			bool block = settings.value ("Block").toBool ();
+			BanPeers (range, block);
+		}
+		settings.endArray ();
+		settings.endGroup ();
+
+		qDebug () << Q_FUNC_INFO
+				<< "restored"
+				<< Handles_.size ()
+				<< "torrents in"
+				<< timer.elapsed ()
+				<< "ms";
+	}
+
+	void Core::RestoreStoredTorrents ()
+	{
+		const auto& records = Store_->Load ();
+		qDebug () << Q_FUNC_INFO << "gonna restore" << records.size () << "torrents";
+
+		/* Parsing the torrent files is the most expensive part, and it
+		 * doesn't need the session.
+		 */
+		const auto storageMode = GetCurrentStorageMode ();
+		const auto& params = QtConcurrent::blockingMapped (records,
+				std::function<boost::optional<libtorrent::add_torrent_params> (TorrentRecord)>
+				{
+					[storageMode] (const TorrentRecord& record)
+					{
+						return MakeRestoreParams (record.TorrentFileContents_,
+								record.ResumeData_,
+								record.SavePath_.toStdString (),
+								record.AutoManaged_,
+								record.Parameters_ & NoAutostart,
+								storageMode);
+					}
+				});
+
+		Handles_.reserve (records.size ());
+		RowIndex_.Reserve (records.size ());
+
+		for (int i = 0; i < records.size (); ++i)
+		{
+			const auto& record = records.at (i);
+			if (!params.at (i))
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "unable to parse"
+						<< record.TorrentFileName_;
+				continue;
+			}
+
+			auto handle = AddRestoredTorrent (*params.at (i));
+			if (!handle.is_valid ())
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "got invalid handle for"
+						<< record.TorrentFileName_;
+				continue;
+			}
+
+			auto priorities = record.FilePriorities_;
+			if (priorities.empty ())
+				priorities.resize (params.at (i)->ti->num_files (), 1);
+
+			handle.prioritize_files (priorities);
+
+			AppendTorrent ({
+					priorities,
+					handle,
+					record.TorrentFileContents_,
+					record.TorrentFileName_,
+					record.Tags_,
+					record.AutoManaged_,
+					Proxy_->GetID (),
+					record.Parameters_
+				}, record.SavePath_);
+		}
+	}
+
+	void Core::RestoreLegacyTorrents (QSettings& settings)
+	{
+		const auto& torrentsDir = Util::CreateIfNotExists ("bittorrent");
+
 		int torrents = settings.beginReadArray ("AddedTorrents");
 		qDebug () << Q_FUNC_INFO << "gonna restore" << torrents << "torrents";
 		for (int i = 0; i < torrents; ++i)
@@ -1747,8 +1974,7 @@ namespace BitTorrent
 
 			handle.prioritize_files (priorities);
 
-			beginInsertRows ({}, Handles_.size (), Handles_.size ());
-			Handles_.append ({
+			AppendTorrent ({
 					priorities,
 					handle,
 					data,
@@ -1757,23 +1983,61 @@ namespace BitTorrent
 					automanaged,
 					Proxy_->GetID (),
 					taskParameters
-				});
-			endInsertRows ();
+				}, pathStr);
 			qDebug () << "restored a torrent";
+
+			/* The resume data isn't known to the store yet, so ask for it
+			 * even if libtorrent thinks it's up to date.
+			 */
+			handle.save_resume_data ();
+			++PendingResumeData_;
 		}
 		settings.endArray ();
 
-		int filters = settings.beginReadArray ("IPFilter");
-		for (int i = 0; i < filters; ++i)
+		/* Migrate everything to the new store at once.
+		 */
+		for (int i = 0; i < Handles_.size (); ++i)
+			DirtyTorrents_ << Handles_.at (i).InfoHash_;
+		OrderDirty_ = true;
+		ScheduleSave ();
+	}
+
+	void Core::RemoveLegacyTorrents (QSettings& settings)
+	{
+		/* The store is only considered initialized after it has been
+		 * written to, so the legacy data isn't the only copy anymore.
+		 */
+		QStringList filenames;
+		const int torrents = settings.beginReadArray ("AddedTorrents");
+		for (int i = 0; i < torrents; ++i)
 		{
 			settings.setArrayIndex (i);
-			BanRange_t range (settings.value ("First").toString (),
-					settings.value ("Last").toString ());
-			bool block = settings.value ("Block").toBool ();
-			BanPeers (range, block);
+			filenames << settings.value ("Filename").toString ();
 		}
 		settings.endArray ();
-		settings.endGroup ();
+
+		if (!torrents)
+			return;
+
+		const auto& torrentsDir = Util::CreateIfNotExists ("bittorrent");
+		for (const auto& filename : filenames)
+		{
+			if (filename.isEmpty ())
+				continue;
+
+			for (const auto& name : QStringList { filename, filename + ".resume" })
+				if (torrentsDir.exists (name) && !torrentsDir.remove (name))
+					qWarning () << Q_FUNC_INFO
+							<< "unable to remove legacy file"
+							<< name;
+		}
+
+		settings.remove ("AddedTorrents");
+
+		qDebug () << Q_FUNC_INFO
+				<< "removed"
+				<< torrents
+				<< "migrated legacy torrents";
 	}
 
 	libtorrent::torrent_handle Core::RestoreSingleTorrent (const QByteArray& data,
@@ -1782,37 +2046,26 @@ namespace BitTorrent
 			bool automanaged,
 			bool pause)
 	{
-		libtorrent::torrent_handle handle;
+		const auto& atp = MakeRestoreParams (data, resumeData, path.string (),
+				automanaged, pause, GetCurrentStorageMode ());
+		if (!atp)
+			return {};
 
-		libtorrent::bdecode_node e;
-		if (!DecodeEntry (data, e))
-			return handle;
+		return AddRestoredTorrent (*atp);
+	}
 
+	libtorrent::torrent_handle Core::AddRestoredTorrent (libtorrent::add_torrent_params atp)
+	{
 		try
 		{
-			libtorrent::add_torrent_params atp;
-			atp.ti = boost::make_shared<libtorrent::torrent_info> (e);
-			atp.storage_mode = GetCurrentStorageMode ();
-			atp.save_path = path.string ();
-			if (!automanaged)
-				atp.flags &= ~libtorrent::add_torrent_params::flag_auto_managed;
-			if (pause)
-				atp.flags |= libtorrent::add_torrent_params::flag_paused;
-			atp.flags |= libtorrent::add_torrent_params::flag_duplicate_is_error;
-
-			std::copy (resumeData.constData (),
-					resumeData.constData () + resumeData.size (),
-					std::back_inserter (atp.resume_data));
-
-			handle = Session_->add_torrent (atp);
+			return Session_->add_torrent (atp);
 		}
 		catch (const libtorrent::libtorrent_exception& e)
 		{
 			qWarning () << Q_FUNC_INFO << e.what ();
 			HandleLibtorrentException (e);
+			return {};
 		}
-
-		return handle;
 	}
 
 	void Core::HandleSingleFinished (int i)
@@ -1923,6 +2176,7 @@ namespace BitTorrent
 
 		Handles_ [torrent].Tags_ = Util::Map (tags,
 				[this] (const QString& tag) { return Proxy_->GetTagsManager ()->GetID (tag); });
+		MarkDirty (torrent);
 	}
 
 	void Core::ScheduleSave ()
@@ -1937,6 +2191,64 @@ namespace BitTorrent
 		SaveScheduled_ = true;
 	}
 
+	void Core::MarkDirty (int row)
+	{
+		DirtyTorrents_ << Handles_.at (row).InfoHash_;
+		ScheduleSave ();
+	}
+
+	TorrentRecord Core::MakeRecord (const TorrentStruct& torrent) const
+	{
+		TorrentRecord record;
+		record.TorrentFileContents_ = torrent.TorrentFileContents_;
+		record.TorrentFileName_ = torrent.TorrentFileName_;
+		record.SavePath_ = torrent.SavePath_;
+		record.Tags_ = torrent.Tags_;
+		record.Parameters_ = torrent.Parameters_;
+		record.AutoManaged_ = torrent.AutoManaged_;
+		record.FilePriorities_ = torrent.FilePriorities_;
+		return record;
+	}
+
+	void Core::RequestResumeData (StatusSource source)
+	{
+		const auto needsSave = [this, source] (const libtorrent::torrent_handle& handle)
+		{
+			switch (source)
+			{
+			case StatusSource::Cached:
+				return StatusKeeper_->GetStatus (handle, 0).need_save_resume;
+			case StatusSource::Live:
+				return handle.need_save_resume_data ();
+			}
+
+			return true;
+		};
+
+		for (const auto& torrent : Handles_)
+			if (needsSave (torrent.Handle_))
+			{
+				torrent.Handle_.save_resume_data ();
+				++PendingResumeData_;
+			}
+	}
+
+	void Core::WaitForResumeData ()
+	{
+		QElapsedTimer timer;
+		timer.start ();
+
+		while (PendingResumeData_ > 0 && timer.elapsed () < 10 * 1000)
+			if (Session_->wait_for_alert (libtorrent::seconds (1)))
+				queryLibtorrent ();
+
+		if (PendingResumeData_ > 0)
+			qWarning () << Q_FUNC_INFO
+					<< "gave up waiting for"
+					<< PendingResumeData_
+					<< "resume data";
+	}
+
 	void Core::HandleLibtorrentException (const libtorrent::libtorrent_exception& e)
 	{
 		ShowError (tr ("Error code %1 of category:<blockquote>%2</blockquote>"
@@ -1956,77 +2268,50 @@ namespace BitTorrent
 
 	void Core::writeSettings ()
 	{
-		SaveScheduled_ = false;
+		WriteSettings (StatusSource::Cached);
+	}
 
-		const auto& torrentsDir = Util::CreateIfNotExists ("bittorrent");
+	void Core::WriteSettings (StatusSource source)
+	{
+		SaveScheduled_ = false;
 
-		QSettings settings (QCoreApplication::organizationName (),
-				QCoreApplication::applicationName () + "_Torrent");
-		settings.beginGroup ("Core");
-		settings.beginWriteArray ("AddedTorrents");
-		for (int i = 0; i < Handles_.size (); ++i)
+		for (const auto& hash : DirtyTorrents_)
 		{
-			settings.setArrayIndex (i);
-			if (!CheckValidity (i))
-			{
-				qWarning () << Q_FUNC_INFO
-					<< "invalid torrent"
-					<< i;
+			const auto row = RowIndex_.Find (hash);
+			if (row < 0)
 				continue;
-			}
-			if (Handles_.at (i).TorrentFileName_.isEmpty ())
+
+			const auto& torrent = Handles_.at (row);
+			if (torrent.TorrentFileName_.isEmpty ())
 			{
 				qWarning () << Q_FUNC_INFO
 					<< "empty file name"
-					<< i;
+					<< row;
 				continue;
 			}
-			int oldCurrent = CurrentTorrent_;
-			CurrentTorrent_ = i;
+
 			try
 			{
-				QFile file_info (torrentsDir.filePath (Handles_.at (i).TorrentFileName_));
-				if (!file_info.open (QIODevice::WriteOnly))
-					ShowError (QString ("Cannot write settings! "
-								"Cannot open file %1 for write!")
-							.arg (Handles_.at (i).TorrentFileName_));
-				else
-				{
-					file_info.write (Handles_.at (i).TorrentFileContents_);
-					file_info.close ();
-
-					const auto& handle = Handles_.at (i).Handle_;
-					if (handle.need_save_resume_data ())
-						handle.save_resume_data ();
-
-					const auto& savePath = StatusKeeper_->GetStatus (handle,
-								libtorrent::torrent_handle::query_save_path).save_path;
-					settings.setValue ("SavePath", QString::fromUtf8 (savePath.c_str ()));
-					settings.setValue ("Filename", Handles_.at (i).TorrentFileName_);
-					settings.setValue ("Tags", Handles_.at (i).Tags_);
-					settings.setValue ("ID", Handles_.at (i).ID_);
-					settings.setValue ("Parameters", static_cast<int> (Handles_.at (i).Parameters_));
-					settings.setValue ("AutoManaged", Handles_.at (i).AutoManaged_);
-
-					QByteArray prioritiesLine;
-					std::copy (Handles_.at (i).FilePriorities_.begin (),
-							Handles_.at (i).FilePriorities_.end (),
-							std::back_inserter (prioritiesLine));
-					settings.setValue ("Priorities", prioritiesLine);
-				}
+				Store_->Save (hash, MakeRecord (torrent));
 			}
 			catch (const std::exception& e)
 			{
 				qWarning () << Q_FUNC_INFO << e.what ();
 			}
-			catch (...)
-			{
-				qWarning () << Q_FUNC_INFO << "unknown exception";
-			}
-			CurrentTorrent_ = oldCurrent;
 		}
-		settings.endArray ();
+		DirtyTorrents_.clear ();
 
+		if (OrderDirty_)
+		{
+			Store_->SaveOrder (Util::Map (Handles_, [] (const TorrentStruct& torrent) { return torrent.InfoHash_; }));
+			OrderDirty_ = false;
+		}
+
+		RequestResumeData (source);
+
+		QSettings settings (QCoreApplication::organizationName (),
+				QCoreApplication::applicationName () + "_Torrent");
+		settings.beginGroup ("Core");
 		settings.beginWriteArray ("IPFilter");
 		settings.remove ("");
 		int i = 0;
@@ -2050,10 +2335,6 @@ namespace BitTorrent
 		QByteArray sessionStateBA;
 		libtorrent::bencode (std::back_inserter (sessionStateBA), sessionState);
 		XmlSettingsManager::Instance ()->setProperty ("SessionState", sessionStateBA);
-
-		Session_->wait_for_alert (libtorrent::time_duration (5));
-
-		queryLibtorrent ();
 	}
 
 	void Core::checkFinished ()
@@ -2124,6 +2405,8 @@ namespace BitTorrent
 
 		void operator() (const libtorrent::save_resume_data_failed_alert& a) const
 		{
+			Core_.HandleResumeDataFailed ();
+
 			const auto& text = QObject::tr ("Saving resume data failed for torrent:<br />%1<br />%2")
 					.arg (GetTorrentName (a.handle))
 					.arg (QString::fromUtf8 (a.error.message ().c_str ()));
@@ -2132,6 +2415,8 @@ namespace BitTorrent
 
 		void operator() (const libtorrent::storage_moved_alert& a) const
 		{
+			Core_.HandleStorageMoved (a.handle, QString::fromUtf8 (a.storage_path ()));
+
 			const auto& text = QObject::tr ("Storage for torrent:<br />%1"
 						"<br />moved successfully to:<br />%2")
 					.arg (GetTorrentName (a.handle))
@@ -37,7 +37,9 @@
 #include <QPair>
 #include <QList>
 #include <QVector>
+#include <QSet>
 #include <QIcon>
+#include <libtorrent/add_torrent_params.hpp>
 #include <libtorrent/alert_types.hpp>
 #include <libtorrent/torrent_info.hpp>
 #include <libtorrent/torrent_handle.hpp>
@@ -48,12 +50,14 @@
 #include "torrentinfo.h"
 #include "fileinfo.h"
 #include "peerinfo.h"
+#include "torrentrowindex.h"
 
 class QTimer;
 class QDomElement;
 class QToolBar;
 class QStandardItemModel;
 class QDataStream;
+class QSettings;
 
 namespace libtorrent
 {
@@ -77,8 +81,11 @@ namespace BitTorrent
 	class TorrentFilesModel;
 	class RepresentationModel;
 	class LiveStreamManager;
+	class TorrentMaker;
 	class SessionSettingsManager;
 	class CachedStatusKeeper;
+	class TorrentStore;
+	struct TorrentRecord;
 	class GeoIP;
 	struct SessionStats;
 	struct NewTorrentParams;
@@ -101,6 +108,7 @@ namespace BitTorrent
 		{
 			std::vector<int> FilePriorities_ = {};
 			libtorrent::torrent_handle Handle_;
+			libtorrent::sha1_hash InfoHash_;
 			QByteArray TorrentFileContents_ = {};
 			QString TorrentFileName_ = {};
 			TorrentState State_ = TSIdle;
@@ -109,6 +117,7 @@ namespace BitTorrent
 				*/
 			QStringList Tags_;
 			bool AutoManaged_ = true;
+			QString SavePath_;
 
 			int ID_;
 			TaskParameters Parameters_;
@@ -120,6 +129,7 @@ namespace BitTorrent
 					int id,
 					TaskParameters params)
 			: Handle_ { handle }
+			, InfoHash_ { handle.info_hash () }
 			, Tags_ { tags }
 			, ID_ { id }
 			, Parameters_ { params }
@@ -136,6 +146,7 @@ namespace BitTorrent
 					TaskParameters params)
 			: FilePriorities_ { prios }
 			, Handle_ { handle }
+			, InfoHash_ { handle.info_hash () }
 			, TorrentFileContents_ { torrentFile }
 			, TorrentFileName_ { filename }
 			, Tags_ { tags }
@@ -164,6 +175,15 @@ namespace BitTorrent
 
 		typedef QList<TorrentStruct> HandleDict_t;
 		HandleDict_t Handles_;
+		TorrentRowIndex RowIndex_;
+
+		StatusUpdateBatcher UpdateBatcher_;
+		std::shared_ptr<QTimer> ModelUpdateTimer_;
+
+		std::shared_ptr<TorrentStore> Store_;
+		QSet<libtorrent::sha1_hash> DirtyTorrents_;
+		bool OrderDirty_ = false;
+		int PendingResumeData_ = 0;
 		QList<QString> Headers_;
 		mutable int CurrentTorrent_ = -1;
 		std::shared_ptr<QTimer> FinishedTimer_, WarningWatchdog_;
@@ -175,6 +195,7 @@ namespace BitTorrent
 		ICoreProxy_ptr Proxy_;
 		QMenu *Menu_ = nullptr;
 		Util::ShortcutManager *ShortcutMgr_ = nullptr;
+		TorrentMaker *TorrentMaker_ = nullptr;
 
 		std::shared_ptr<GeoIP> GeoIP_;
 
@@ -219,6 +240,7 @@ namespace BitTorrent
 		ICoreProxy_ptr GetProxy () const;
 
 		Util::ShortcutManager* GetShortcutManager () const;
+		TorrentMaker* GetTorrentMaker () const;
 
 		SessionSettingsManager* GetSessionSettingsManager () const;
 
@@ -322,6 +344,7 @@ namespace BitTorrent
 		bool IsTorrentSuperSeeding (int) const;
 		void SetTorrentSuperSeeding (bool, int);
 		void MakeTorrent (const NewTorrentParams&) const;
+		void MakeTorrents (const QList<NewTorrentParams>&) const;
 		void SetExternalAddress (const QString&);
 		QString GetExternalAddress () const;
 		void BanPeers (const BanRange_t&, bool = true);
@@ -329,7 +352,9 @@ namespace BitTorrent
 		QMap<BanRange_t, bool> GetFilter () const;
 		bool CheckValidity (int) const;
 
-		void SaveResumeData (const libtorrent::save_resume_data_alert&) const;
+		void SaveResumeData (const libtorrent::save_resume_data_alert&);
+		void HandleResumeDataFailed ();
+		void HandleStorageMoved (const libtorrent::torrent_handle&, const QString&);
 		void HandleMetadata (const libtorrent::metadata_received_alert&);
 		void PieceRead (const libtorrent::read_piece_alert&);
 		void UpdateStatus (const std::vector<libtorrent::torrent_status>&);
@@ -346,14 +371,38 @@ namespace BitTorrent
 		HandleDict_t::iterator FindHandle (const libtorrent::torrent_handle&);
 		HandleDict_t::const_iterator FindHandle (const libtorrent::torrent_handle&) const;
 
+		void AppendTorrent (TorrentStruct, const QString& savePath);
+		void ReindexRows (int from, int to = -1);
+
+		void MarkDirty (int);
+		TorrentRecord MakeRecord (const TorrentStruct&) const;
+
+		/** Where to take the torrents' need_save_resume flag from.
+		 *
+		 * The cached status may be a few seconds old, which is fine for
+		 * the periodic saves, but not when shutting down.
+		 */
+		enum class StatusSource
+		{
+			Cached,
+			Live
+		};
+		void WriteSettings (StatusSource);
+		void RequestResumeData (StatusSource);
+		void WaitForResumeData ();
+
 		void MoveToTop (int);
 		void MoveToBottom (int);
 		void RestoreTorrents ();
+		void RestoreStoredTorrents ();
+		void RestoreLegacyTorrents (QSettings&);
+		void RemoveLegacyTorrents (QSettings&);
 		libtorrent::torrent_handle RestoreSingleTorrent (const QByteArray&,
 				const QByteArray&,
 				const boost::filesystem::path&,
 				bool,
 				bool);
+		libtorrent::torrent_handle AddRestoredTorrent (libtorrent::add_torrent_params);
 
 		void HandleSingleFinished (int);
 		void HandleFileRenamed (const libtorrent::file_renamed_alert&);
@@ -379,6 +428,7 @@ namespace BitTorrent
 		void checkFinished ();
 		void scrape ();
 		void queryLibtorrent ();
+		void flushModelUpdates ();
 	signals:
 		void addToHistory (const QString&, const QString&, quint64,
 				const QDateTime&, const QStringList&);
@@ -28,8 +28,12 @@
  **********************************************************************/
 
 #include "livestreamdevice.h"
+#include <algorithm>
+#include <QTimer>
 #include <QtDebug>
+#include <libtorrent/version.hpp>
 #include "cachedstatuskeeper.h"
+#include "xmlsettingsmanager.h"
 
 namespace LeechCraft
 {
@@ -37,8 +41,41 @@ namespace BitTorrent
 {
 	using th = libtorrent::torrent_handle;
 
+	namespace
+	{
+		const int MinWindowPieces = 2;
+		const int MinPieceDeadline = 100;
+		const int NoRatePieceDeadline = 60000;
+		const int NotReadyDeadline = 1000000;
+		const int BoundaryPieceDeadline = 500;
+		const int ReadRetryInterval = 1000;
+
+		int SelectFile (const libtorrent::torrent_info& ti, int fileIdx)
+		{
+			const auto& files = ti.files ();
+			if (fileIdx >= files.num_files ())
+				throw std::runtime_error { LiveStreamDevice::tr ("No file %1 in the torrent.")
+							.arg (fileIdx)
+							.toStdString () };
+
+			if (fileIdx >= 0)
+				return fileIdx;
+
+			int largest = 0;
+			for (int i = 1; i < files.num_files (); ++i)
+				if (files.file_size (i) > files.file_size (largest))
+					largest = i;
+			return largest;
+		}
+	}
+
+	qint64 LiveStreamDevice::Stats::GetThroughput () const
+	{
+		return BytesRead_ * 1000 / std::max<qint64> (ElapsedMsecs_, 1);
+	}
+
 	LiveStreamDevice::LiveStreamDevice (const libtorrent::torrent_handle& h,
-			CachedStatusKeeper *keeper, QObject *parent)
+			CachedStatusKeeper *keeper, int fileIdx, QObject *parent)
 	: QIODevice (parent)
 	, StatusKeeper_ (keeper)
 	, Handle_ (h)
@@ -52,10 +89,18 @@ namespace BitTorrent
 			return *tf;
 		} ()
 	}
+	, FileIdx_ (SelectFile (TI_, fileIdx))
+	, FileOffset_ (TI_.files ().file_offset (FileIdx_))
+	, FileSize_ (TI_.files ().file_size (FileIdx_))
+	, FirstPiece_ (FileOffset_ / PieceLength_)
+	, LastPiece_ ((FileOffset_ + std::max<qint64> (FileSize_, 1) - 1) / PieceLength_)
+	, Have_ (TI_.num_pieces (), false)
+	, ScanFrom_ (FirstPiece_)
+	, FirstMissing_ (FirstPiece_)
 	{
-		const auto& tpath = keeper->GetStatus (h, th::query_save_path).save_path;
-		const auto& fpath = TI_.files ().file_path (0);
-		File_.setFileName (QString::fromStdString (tpath + '/' + fpath));
+		const auto& pieces = keeper->GetStatus (h, th::query_pieces).pieces;
+		for (int i = FirstPiece_; i <= LastPiece_ && i < pieces.size (); ++i)
+			Have_ [i] = pieces [i];
 
 		if (!QIODevice::open (QIODevice::ReadOnly | QIODevice::Unbuffered))
 		{
@@ -65,24 +110,42 @@ namespace BitTorrent
 			throw std::runtime_error { QIODevice::errorString ().toStdString () };
 		}
 
+		Lifetime_.start ();
+
 		reschedule ();
 	}
 
+	LiveStreamDevice::~LiveStreamDevice ()
+	{
+		const auto& stats = GetStats ();
+		qDebug () << Q_FUNC_INFO
+				<< QString::fromStdString (TI_.files ().file_path (FileIdx_))
+				<< "read"
+				<< stats.BytesRead_
+				<< "bytes at"
+				<< stats.GetThroughput ()
+				<< "bytes/s, stalled"
+				<< stats.Stalls_
+				<< "times for"
+				<< stats.StallMsecs_
+				<< "ms";
+	}
+
 	qint64 LiveStreamDevice::bytesAvailable () const
 	{
-		qint64 result = 0;
-		const auto& pieces = StatusKeeper_->GetStatus (Handle_, th::query_pieces).pieces;
-		qDebug () << Q_FUNC_INFO << Offset_ << ReadPos_ << pieces [ReadPos_];
-		for (int i = ReadPos_; pieces [i]; ++i)
-		{
-			result += TI_.piece_size (i);
-			qDebug () << "added:" << result;
-		}
-		result -= Offset_;
-		if (result < 0)
-			result = 0;
-		qDebug () << "result:" << result;
-		return result;
+		const auto pos = this->pos ();
+		if (pos >= FileSize_)
+			return 0;
+
+		const auto current = PieceAt (pos);
+		const auto missing = GetFirstMissing (current);
+		if (missing == current)
+			return 0;
+
+		const auto end = missing > LastPiece_ ?
+				FileSize_ :
+				missing * PieceLength_ - FileOffset_;
+		return end - pos + QIODevice::bytesAvailable ();
 	}
 
 	bool LiveStreamDevice::isSequential () const
@@ -100,82 +163,122 @@ namespace BitTorrent
 		return true;
 	}
 
-	qint64 LiveStreamDevice::pos () const
-	{
-		qint64 result = 0;
-		for (int i = 0; i < ReadPos_; ++i)
-			result += TI_.piece_size (i);
-		result += Offset_;
-		return result;
-	}
-
 	bool LiveStreamDevice::seek (qint64 pos)
 	{
-		QIODevice::seek (pos);
-		qDebug () << Q_FUNC_INFO << pos;
-
-		int i = 0;
-		while (pos >= TI_.piece_size (i))
-			pos -= TI_.piece_size (i++);
-		ReadPos_ = i;
-		Offset_ = pos;
+		if (!QIODevice::seek (pos))
+			return false;
 
-		qDebug () << ReadPos_ << Offset_;
-
-		reschedule ();
+		EndStall ();
+		ScheduleWindow (pos);
 
 		return true;
 	}
 
 	qint64 LiveStreamDevice::size () const
 	{
-		return StatusKeeper_->GetStatus (Handle_, 0).total_wanted;
+		return FileSize_;
 	}
 
-	void LiveStreamDevice::PieceRead (const libtorrent::read_piece_alert&)
+	void LiveStreamDevice::PieceRead (const libtorrent::read_piece_alert& a)
 	{
+		const auto piece = a.piece;
+		if (piece < FirstPiece_ || piece > LastPiece_)
+			return;
+
+		Reading_.remove (piece);
+
+#if LIBTORRENT_VERSION_NUM >= 10100
+		const auto& error = a.error;
+#else
+		const auto& error = a.ec;
+#endif
+		if (error)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to read piece"
+					<< piece
+					<< QString::fromStdString (error.message ());
+			QTimer::singleShot (ReadRetryInterval,
+					this,
+					SLOT (reschedule ()));
+			return;
+		}
+
+		Have_ [piece] = true;
+		Deadlines_.remove (piece);
+
+		if (piece >= WindowStart_ && piece <= WindowEnd_)
+			Buffers_ [piece] = a.buffer;
+
 		CheckReady ();
-		CheckNextChunk ();
-		reschedule ();
+		if (!IsReady_)
+			return;
+
+		const auto current = PieceAt (pos ());
+		if (piece < current || piece >= GetFirstMissing (current))
+			return;
+
+		EndStall ();
+		emit readyRead ();
 	}
 
 	void LiveStreamDevice::CheckReady ()
 	{
-		const auto& pieces = StatusKeeper_->GetStatus (Handle_, th::query_pieces).pieces;
-		if (!IsReady_ &&
-				pieces [0] &&
-				pieces [NumPieces_ - 1])
-		{
-			std::vector<int> prios (NumPieces_, 1);
-			Handle_.prioritize_pieces (prios);
+		if (IsReady_ ||
+				!Have_ [FirstPiece_] ||
+				!Have_ [LastPiece_])
+			return;
 
-			IsReady_ = true;
-			emit ready (this);
-		}
+		std::vector<int> prios (TI_.num_pieces (), 1);
+		Handle_.prioritize_pieces (prios);
+
+		IsReady_ = true;
+		reschedule ();
+
+		emit ready (this);
+	}
+
+	LiveStreamDevice::Stats LiveStreamDevice::GetStats () const
+	{
+		auto stats = Stats_;
+		stats.ElapsedMsecs_ = Lifetime_.elapsed ();
+		if (StallTimer_.isValid ())
+			stats.StallMsecs_ += StallTimer_.elapsed ();
+		return stats;
 	}
 
 	qint64 LiveStreamDevice::readData (char *data, qint64 max)
 	{
-		if (!File_.open (QIODevice::ReadOnly))
+		const auto pos = this->pos ();
+		if (pos >= FileSize_)
+			return 0;
+
+		const auto available = bytesAvailable ();
+		if (!available)
 		{
-			qWarning () << Q_FUNC_INFO
-				<< "could not open underlying file"
-				<< File_.fileName ()
-				<< File_.errorString ();
-			return -1;
+			if (!StallTimer_.isValid ())
+			{
+				StallTimer_.start ();
+				++Stats_.Stalls_;
+			}
+			return 0;
 		}
-		qint64 ba = bytesAvailable ();
-		File_.seek (pos ());
-		const qint64 result = File_.read (data, std::min (max, ba));
-		File_.close ();
 
-		qDebug () << Q_FUNC_INFO << result << Offset_ << ReadPos_ << max << ba;
+		const auto result = std::min (max, available);
+		for (qint64 done = 0; done < result; )
+		{
+			const auto offset = FileOffset_ + pos + done;
+			const int piece = offset / PieceLength_;
+			const auto inPiece = offset - piece * PieceLength_;
+			const auto chunk = std::min (result - done, PieceLength_ - inPiece);
+			std::copy_n (Buffers_.value (piece).get () + inPiece, chunk, data + done);
+			done += chunk;
+		}
 
-		Offset_ += result;
-		while (Offset_ >= TI_.piece_size (ReadPos_))
-			Offset_ -= TI_.piece_size (ReadPos_++);
+		Stats_.BytesRead_ += result;
 
-		qDebug () << Offset_ << ReadPos_ << bytesAvailable ();
+		if (PieceAt (pos + result) != WindowStart_)
+			ScheduleWindow (pos + result);
 
 		return result;
 	}
@@ -185,56 +288,115 @@ namespace BitTorrent
 		return -1;
 	}
 
-	void LiveStreamDevice::CheckNextChunk ()
+	int LiveStreamDevice::PieceAt (qint64 pos) const
 	{
-		bool hasMoreData = false;
-		const auto& pieces = StatusKeeper_->GetStatus (Handle_, th::query_pieces).pieces;
-		for (int i = ReadPos_ + 1;
-				i < NumPieces_ && pieces [i];
-				++i, hasMoreData = true);
-
-		if (hasMoreData)
-			emit readyRead ();
+		pos = std::min (pos, FileSize_ - 1);
+		return std::max<qint64> (FileOffset_ + pos, 0) / PieceLength_;
 	}
 
-	void LiveStreamDevice::reschedule ()
+	int LiveStreamDevice::GetFirstMissing (int from) const
 	{
-		const auto& status = StatusKeeper_->GetStatus (Handle_, th::query_pieces);
-		const auto& pieces = status.pieces;
-		int speed = status.download_payload_rate;
-		int size = TI_.piece_length ();
-		const int time = speed ?
-			static_cast<double> (size) / speed * 1000 :
-			60000;
-
-		int thisDeadline = 0;
-		for (int i = ReadPos_; i < NumPieces_; ++i)
-			if (!pieces [i])
-				Handle_.set_piece_deadline (i,
-						IsReady_ ?
-							(thisDeadline += time) :
-							1000000,
-						1);
-		if (!IsReady_)
+		if (from < ScanFrom_ || from > FirstMissing_)
 		{
-			std::vector<int> prios (NumPieces_, 0);
-			if (pieces.size () > 1)
-				prios [1] = 1;
+			ScanFrom_ = from;
+			FirstMissing_ = from;
+		}
+
+		while (FirstMissing_ <= LastPiece_ && Buffers_.contains (FirstMissing_))
+			++FirstMissing_;
+
+		return FirstMissing_;
+	}
+
+	int LiveStreamDevice::GetWindowPieces () const
+	{
+		const qint64 bytes = XmlSettingsManager::Instance ()->
+				property ("LiveStreamReadAhead").toInt () * 1024 * 1024;
+		return std::max<qint64> (MinWindowPieces, (bytes + PieceLength_ - 1) / PieceLength_);
+	}
+
+	void LiveStreamDevice::EndStall ()
+	{
+		if (!StallTimer_.isValid ())
+			return;
 
-			if (!pieces [0])
+		Stats_.StallMsecs_ += StallTimer_.elapsed ();
+		StallTimer_.invalidate ();
+	}
+
+	void LiveStreamDevice::ScheduleWindow (qint64 pos)
+	{
+		const auto current = PieceAt (pos);
+		const auto windowEnd = std::min (LastPiece_, current + GetWindowPieces () - 1);
+		WindowStart_ = current;
+		WindowEnd_ = windowEnd;
+
+		for (auto it = Deadlines_.begin (); it != Deadlines_.end (); )
+			if (*it < current || *it > windowEnd)
 			{
-				qDebug () << "scheduling first piece";
-				Handle_.set_piece_deadline (0, 500, 1);
-				prios [0] = 7;
+				Handle_.reset_piece_deadline (*it);
+				it = Deadlines_.erase (it);
 			}
-			if (!pieces [NumPieces_ - 1])
+			else
+				++it;
+
+		for (auto it = Buffers_.begin (); it != Buffers_.end (); )
+			if (it.key () < current || it.key () > windowEnd)
+				it = Buffers_.erase (it);
+			else
+				++it;
+
+		ScanFrom_ = current;
+		FirstMissing_ = current;
+
+		const auto rate = StatusKeeper_->GetStatus (Handle_, 0).download_payload_rate;
+		const int perPiece = rate ?
+				std::max<qint64> (PieceLength_ * 1000 / rate, MinPieceDeadline) :
+				NoRatePieceDeadline;
+
+		int deadline = 0;
+		for (int i = current; i <= windowEnd; ++i)
+		{
+			if (Buffers_.contains (i))
+				continue;
+
+			if (Have_ [i])
 			{
-				qDebug () << "scheduling last piece";
-				Handle_.set_piece_deadline (NumPieces_ - 1, 500, 1);
-				prios [NumPieces_ - 1] = 7;
+				if (!Reading_.contains (i))
+				{
+					Handle_.read_piece (i);
+					Reading_ << i;
+				}
+				continue;
 			}
-			Handle_.prioritize_pieces (prios);
+
+			deadline += perPiece;
+			Handle_.set_piece_deadline (i,
+					IsReady_ ? deadline : NotReadyDeadline,
+					th::alert_when_available);
+			Deadlines_ << i;
 		}
+
+		if (IsReady_)
+			return;
+
+		std::vector<int> prios (TI_.num_pieces (), 0);
+		for (int i = current; i <= windowEnd; ++i)
+			prios [i] = 1;
+
+		for (const auto piece : { FirstPiece_, LastPiece_ })
+			if (!Have_ [piece])
+			{
+				Handle_.set_piece_deadline (piece, BoundaryPieceDeadline, th::alert_when_available);
+				prios [piece] = 7;
+			}
+
+		Handle_.prioritize_pieces (prios);
+	}
+
+	void LiveStreamDevice::reschedule ()
+	{
+		ScheduleWindow (pos ());
 	}
 }
 }
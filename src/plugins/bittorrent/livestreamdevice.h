@@ -29,8 +29,11 @@
 
 #pragma once
 
-#include <QVector>
-#include <QFile>
+#include <vector>
+#include <boost/shared_array.hpp>
+#include <QSet>
+#include <QHash>
+#include <QElapsedTimer>
 #include <libtorrent/torrent_handle.hpp>
 #include <libtorrent/torrent_info.hpp>
 #include <libtorrent/alert_types.hpp>
@@ -44,38 +47,81 @@ namespace BitTorrent
 	class LiveStreamDevice : public QIODevice
 	{
 		Q_OBJECT
+	public:
+		struct Stats
+		{
+			qint64 BytesRead_ = 0;
+			qint64 ElapsedMsecs_ = 0;
+
+			int Stalls_ = 0;
+			qint64 StallMsecs_ = 0;
 
+			qint64 GetThroughput () const;
+		};
+	private:
 		CachedStatusKeeper * const StatusKeeper_;
 
 		const libtorrent::torrent_handle Handle_;
 		const libtorrent::torrent_info TI_;
-		const int NumPieces_ = TI_.num_pieces ();
-
-		int LastIndex_ = 0;
-		// Which piece would be read next.
-		int ReadPos_ = 0;
-		// Offset in the next piece pointed by ReadPos_;
-		int Offset_ = 0;
-		bool IsReady_ = 0;
-		QFile File_;
+		const qint64 PieceLength_ = TI_.piece_length ();
+
+		const int FileIdx_;
+		// Offset of the streamed file in the torrent's data.
+		const qint64 FileOffset_;
+		const qint64 FileSize_;
+		const int FirstPiece_;
+		const int LastPiece_;
+
+		std::vector<bool> Have_;
+		QSet<int> Deadlines_;
+
+		/* Pieces are read via read_piece() and not from the file on disk,
+		 * since a freshly verified piece may still be in libtorrent's
+		 * write cache. Only the pieces in the read-ahead window are kept.
+		 */
+		QHash<int, boost::shared_array<char>> Buffers_;
+		QSet<int> Reading_;
+
+		// Caches the first piece without a buffer after ScanFrom_.
+		mutable int ScanFrom_;
+		mutable int FirstMissing_;
+
+		int WindowStart_ = -1;
+		int WindowEnd_ = -1;
+
+		bool IsReady_ = false;
+
+		QElapsedTimer Lifetime_;
+		QElapsedTimer StallTimer_;
+		Stats Stats_;
 	public:
-		LiveStreamDevice (const libtorrent::torrent_handle&, CachedStatusKeeper*, QObject* = nullptr);
+		/** Streams the file with the given index, or the largest one
+		 * if fileIdx is negative.
+		 */
+		LiveStreamDevice (const libtorrent::torrent_handle&, CachedStatusKeeper*,
+				int fileIdx = -1, QObject* = nullptr);
+		~LiveStreamDevice ();
 
 		virtual qint64 bytesAvailable () const;
 		virtual bool isSequential () const;
 		virtual bool isWritable () const;
 		virtual bool open (OpenMode);
-		virtual qint64 pos () const;
 		virtual bool seek (qint64);
 		virtual qint64 size () const;
 
 		void PieceRead (const libtorrent::read_piece_alert&);
 		void CheckReady ();
+
+		Stats GetStats () const;
 	protected:
 		virtual qint64 readData (char*, qint64);
 		virtual qint64 writeData (const char*, qint64);
 	private:
-		void CheckNextChunk ();
+		int PieceAt (qint64) const;
+		int GetFirstMissing (int) const;
+		int GetWindowPieces () const;
+		void EndStall ();
+		void ScheduleWindow (qint64);
 	private slots:
 		void reschedule ();
 	signals:
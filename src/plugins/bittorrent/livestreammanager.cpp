@@ -75,17 +75,8 @@ namespace BitTorrent
 
 	void LiveStreamManager::PieceRead (const libtorrent::read_piece_alert& a)
 	{
-		const auto& handle = a.handle;
-
-		if (!Handle2Device_.contains (handle))
-		{
-			qWarning () << Q_FUNC_INFO
-					<< "Handle2Device_ doesn't contain handle"
-					<< Handle2Device_.size ();
-			return;
-		}
-
-		Handle2Device_ [handle]->PieceRead (a);
+		if (const auto device = Handle2Device_.value (a.handle))
+			device->PieceRead (a);
 	}
 
 	void LiveStreamManager::handleDeviceReady (LiveStreamDevice *lsd)
@@ -0,0 +1,203 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "piecehasher.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <QThreadPool>
+#include <QtConcurrentRun>
+#include <QFuture>
+#include <libtorrent/hasher.hpp>
+
+namespace LeechCraft
+{
+namespace BitTorrent
+{
+	namespace
+	{
+		const qint64 MinBatchBytes = 16 * 1024 * 1024;
+		const qint64 MaxBatchBytes = 128 * 1024 * 1024;
+
+		struct PendingBatch
+		{
+			int From_;
+			std::vector<libtorrent::sha1_hash> Hashes_;
+			QList<QFuture<void>> Futures_;
+
+			void Wait ()
+			{
+				for (auto& future : Futures_)
+					future.waitForFinished ();
+				Futures_.clear ();
+			}
+		};
+
+		void StartHashing (PendingBatch& batch, const libtorrent::file_storage& fs,
+				const char *data, int count, QThreadPool *pool)
+		{
+			batch.Hashes_.assign (count, libtorrent::sha1_hash {});
+
+			const auto pieceLength = fs.piece_length ();
+			const auto chunks = std::min (count, std::max (pool->maxThreadCount (), 1));
+			for (int chunk = 0; chunk < chunks; ++chunk)
+			{
+				const int chunkBegin = count * chunk / chunks;
+				const int chunkEnd = count * (chunk + 1) / chunks;
+				batch.Futures_ << QtConcurrent::run (pool,
+						[&batch, &fs, data, pieceLength, chunkBegin, chunkEnd]
+						{
+							for (int i = chunkBegin; i < chunkEnd; ++i)
+							{
+								const auto piece = batch.From_ + i;
+								libtorrent::hasher hasher
+								{
+									data + static_cast<qint64> (i) * pieceLength,
+									fs.piece_size (piece)
+								};
+								batch.Hashes_ [i] = hasher.final ();
+							}
+						});
+			}
+		}
+	}
+
+	PieceHasher::PieceHasher (const libtorrent::file_storage& fs, const QString& basePath, QThreadPool *pool)
+	: FS_ (fs)
+	, BasePath_ (basePath.toUtf8 ().constData ())
+	, Pool_ (pool)
+	{
+	}
+
+	int PieceHasher::Hash (int from, const Handler_f& handler, const std::atomic<bool>& cancelled)
+	{
+		const auto numPieces = FS_.num_pieces ();
+		const auto batchPieces = GetBatchPieces ();
+
+		std::vector<char> buffers [2];
+		int currentBuffer = 0;
+
+		PendingBatch pending;
+		bool hasPending = false;
+		auto finishPending = [&]
+		{
+			if (!hasPending)
+				return;
+
+			pending.Wait ();
+			hasPending = false;
+			for (int i = 0; i < static_cast<int> (pending.Hashes_.size ()); ++i)
+				handler (pending.From_ + i, pending.Hashes_ [i]);
+		};
+
+		int next = from;
+		try
+		{
+			while (next < numPieces && !cancelled)
+			{
+				const auto count = std::min (batchPieces, numPieces - next);
+				const int bytes = (count - 1) * FS_.piece_length () +
+						FS_.piece_size (next + count - 1);
+
+				auto& buffer = buffers [currentBuffer];
+				buffer.resize (bytes);
+				ReadBlock (buffer.data (), next, bytes);
+
+				finishPending ();
+
+				pending.From_ = next;
+				StartHashing (pending, FS_, buffer.data (), count, Pool_);
+				hasPending = true;
+
+				next += count;
+				currentBuffer = 1 - currentBuffer;
+			}
+		}
+		catch (...)
+		{
+			pending.Wait ();
+			throw;
+		}
+
+		finishPending ();
+
+		CurrentFile_.close ();
+		CurrentFileIdx_ = -1;
+
+		return next;
+	}
+
+	int PieceHasher::GetBatchPieces () const
+	{
+		const qint64 pieceLength = FS_.piece_length ();
+		const auto threads = std::max (Pool_->maxThreadCount (), 1);
+		const auto batchBytes = qBound (MinBatchBytes, 2 * threads * pieceLength, MaxBatchBytes);
+		return std::max<int> (batchBytes / pieceLength, 1);
+	}
+
+	void PieceHasher::ReadBlock (char *data, int piece, int size)
+	{
+		for (const auto& slice : FS_.map_block (piece, 0, size))
+		{
+			if (FS_.pad_file_at (slice.file_index))
+			{
+				std::fill (data, data + slice.size, 0);
+				data += slice.size;
+				continue;
+			}
+
+			if (CurrentFileIdx_ != slice.file_index)
+			{
+				CurrentFile_.close ();
+				CurrentFileIdx_ = -1;
+
+				const auto& path = FS_.file_path (slice.file_index, BasePath_);
+				CurrentFile_.setFileName (QString::fromUtf8 (path.c_str ()));
+				if (!CurrentFile_.open (QIODevice::ReadOnly))
+					throw std::runtime_error ("unable to open " + path + ": " +
+							CurrentFile_.errorString ().toStdString ());
+
+				CurrentFileIdx_ = slice.file_index;
+			}
+
+			if (CurrentFile_.pos () != slice.offset &&
+					!CurrentFile_.seek (slice.offset))
+				throw std::runtime_error ("unable to seek in " +
+						CurrentFile_.fileName ().toStdString ());
+
+			if (CurrentFile_.read (data, slice.size) != slice.size)
+				throw std::runtime_error ("unable to read " +
+						CurrentFile_.fileName ().toStdString () + ": file is shorter than expected");
+
+			data += slice.size;
+		}
+	}
+}
+}
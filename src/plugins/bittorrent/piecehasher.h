@@ -0,0 +1,87 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <QFile>
+#include <QString>
+#include <libtorrent/file_storage.hpp>
+#include <libtorrent/peer_id.hpp>
+
+class QThreadPool;
+
+namespace LeechCraft
+{
+namespace BitTorrent
+{
+	/** Computes piece hashes of the files described by a file_storage.
+	 *
+	 * The data is read sequentially in blocks spanning several pieces,
+	 * and each block is hashed on the given thread pool while the next
+	 * one is being read.
+	 */
+	class PieceHasher
+	{
+		const libtorrent::file_storage& FS_;
+		const std::string BasePath_;
+		QThreadPool * const Pool_;
+
+		int CurrentFileIdx_ = -1;
+		QFile CurrentFile_;
+	public:
+		using Handler_f = std::function<void (int, const libtorrent::sha1_hash&)>;
+
+		/** @param[in] fs The files to hash, with the piece length set.
+		 * @param[in] basePath The directory the paths in fs are
+		 * relative to.
+		 * @param[in] pool The pool the hashing is run on.
+		 */
+		PieceHasher (const libtorrent::file_storage& fs, const QString& basePath, QThreadPool *pool);
+
+		/** Hashes the pieces starting at from, invoking handler for
+		 * each of them in order on the calling thread.
+		 *
+		 * Hashing stops early once cancelled is set, though the pieces
+		 * already being hashed are still reported.
+		 *
+		 * @return The index of the first piece that hasn't been hashed,
+		 * which is the number of pieces if everything is done.
+		 *
+		 * @exception std::runtime_error If a file could not be read.
+		 */
+		int Hash (int from, const Handler_f& handler, const std::atomic<bool>& cancelled);
+	private:
+		int GetBatchPieces () const;
+		void ReadBlock (char*, int, int);
+	};
+}
+}
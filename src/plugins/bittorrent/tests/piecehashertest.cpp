@@ -0,0 +1,235 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "piecehashertest.h"
+#include <QtTest>
+#include <QThread>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <libtorrent/create_torrent.hpp>
+#include "piecehasher.h"
+
+QTEST_GUILESS_MAIN (LeechCraft::BitTorrent::PieceHasherTest)
+
+namespace LeechCraft
+{
+namespace BitTorrent
+{
+	namespace
+	{
+		const int SmallPieceSize = 16 * 1024;
+		const int BenchPieceSize = 256 * 1024;
+
+		const QList<qint64> FileSizes
+		{
+			20 * 1024 * 1024 + 1,
+			13 * 1024 * 1024 + 777,
+			7 * 1024 * 1024 + 5
+		};
+
+		void WriteFile (const QString& path, qint64 size, quint32 seed)
+		{
+			QByteArray data;
+			data.resize (size);
+			for (auto& c : data)
+			{
+				seed = seed * 1664525 + 1013904223;
+				c = static_cast<char> (seed >> 24);
+			}
+
+			QFile file { path };
+			QVERIFY (file.open (QIODevice::WriteOnly));
+			QCOMPARE (file.write (data), size);
+		}
+
+		struct Files
+		{
+			libtorrent::file_storage FS_;
+			std::unique_ptr<libtorrent::create_torrent> CT_;
+
+			Files (const QString& path, int pieceSize)
+			{
+				libtorrent::add_files (FS_, path.toUtf8 ().constData ());
+				CT_.reset (new libtorrent::create_torrent { FS_, pieceSize });
+			}
+		};
+
+		QList<QByteArray> ComputeReference (const libtorrent::file_storage& fs, const QString& base)
+		{
+			QByteArray all;
+			for (int i = 0; i < fs.num_files (); ++i)
+			{
+				QFile file { QString::fromUtf8 (fs.file_path (i, base.toUtf8 ().constData ()).c_str ()) };
+				if (!file.open (QIODevice::ReadOnly))
+					return {};
+				all += file.readAll ();
+			}
+
+			QList<QByteArray> result;
+			for (int i = 0; i < fs.num_pieces (); ++i)
+				result << QCryptographicHash::hash (all.mid (static_cast<qint64> (i) * fs.piece_length (), fs.piece_size (i)),
+						QCryptographicHash::Sha1);
+			return result;
+		}
+
+		QList<QByteArray> Hash (PieceHasher& hasher, int numPieces,
+				int from = 0, int cancelAfter = -1, int *next = nullptr)
+		{
+			QList<QByteArray> result;
+			for (int i = 0; i < numPieces; ++i)
+				result << QByteArray {};
+
+			std::atomic<bool> cancelled { false };
+			const auto res = hasher.Hash (from,
+					[&] (int piece, const libtorrent::sha1_hash& hash)
+					{
+						const auto& str = hash.to_string ();
+						result [piece] = QByteArray { str.c_str (), static_cast<int> (str.size ()) };
+						if (piece == cancelAfter)
+							cancelled = true;
+					},
+					cancelled);
+			if (next)
+				*next = res;
+			return result;
+		}
+	}
+
+	void PieceHasherTest::initTestCase ()
+	{
+		Dir_.reset (new QTemporaryDir);
+		QVERIFY (QDir { Dir_->path () }.mkdir ("data"));
+
+		for (int i = 0; i < FileSizes.size (); ++i)
+			WriteFile (Dir_->path () + "/data/file" + QString::number (i), FileSizes.at (i), i + 1);
+	}
+
+	void PieceHasherTest::testMatchesReference ()
+	{
+		Files files { Dir_->path () + "/data", SmallPieceSize };
+		const auto& reference = ComputeReference (files.FS_, Dir_->path ());
+		QCOMPARE (reference.size (), files.FS_.num_pieces ());
+
+		QThreadPool pool;
+		pool.setMaxThreadCount (4);
+		PieceHasher hasher { files.FS_, Dir_->path (), &pool };
+		QCOMPARE (Hash (hasher, files.FS_.num_pieces ()), reference);
+	}
+
+	void PieceHasherTest::testSingleThread ()
+	{
+		Files files { Dir_->path () + "/data", SmallPieceSize };
+		const auto& reference = ComputeReference (files.FS_, Dir_->path ());
+
+		QThreadPool pool;
+		pool.setMaxThreadCount (1);
+		PieceHasher hasher { files.FS_, Dir_->path (), &pool };
+		QCOMPARE (Hash (hasher, files.FS_.num_pieces ()), reference);
+	}
+
+	void PieceHasherTest::testCancelResume ()
+	{
+		Files files { Dir_->path () + "/data", SmallPieceSize };
+		const auto numPieces = files.FS_.num_pieces ();
+		const auto& reference = ComputeReference (files.FS_, Dir_->path ());
+
+		QThreadPool pool;
+		pool.setMaxThreadCount (2);
+		PieceHasher hasher { files.FS_, Dir_->path (), &pool };
+
+		int next = 0;
+		auto hashes = Hash (hasher, numPieces, 0, 0, &next);
+		QVERIFY (next > 0);
+		QVERIFY (next < numPieces);
+		for (int i = next; i < numPieces; ++i)
+			QVERIFY (hashes.at (i).isEmpty ());
+
+		const auto& rest = Hash (hasher, numPieces, next, -1, &next);
+		QCOMPARE (next, numPieces);
+		for (int i = 0; i < numPieces; ++i)
+			if (hashes.at (i).isEmpty ())
+				hashes [i] = rest.at (i);
+		QCOMPARE (hashes, reference);
+	}
+
+	void PieceHasherTest::testMissingFile ()
+	{
+		QTemporaryDir dir;
+		QVERIFY (QDir { dir.path () }.mkdir ("data"));
+		WriteFile (dir.path () + "/data/file", 1024 * 1024, 1);
+
+		Files files { dir.path () + "/data", SmallPieceSize };
+		QVERIFY (QFile::remove (dir.path () + "/data/file"));
+
+		QThreadPool pool;
+		PieceHasher hasher { files.FS_, dir.path (), &pool };
+		QVERIFY_EXCEPTION_THROWN (Hash (hasher, files.FS_.num_pieces ()), std::runtime_error);
+	}
+
+	void PieceHasherTest::benchHashing_data ()
+	{
+		QTest::addColumn<int> ("threads");
+
+		QList<int> counts { 1, 2, 4, 8 };
+		const auto ideal = QThread::idealThreadCount ();
+		if (!counts.contains (ideal))
+			counts << ideal;
+
+		for (const auto count : counts)
+			QTest::newRow (QString ("%1 threads").arg (count).toUtf8 ().constData ()) << count;
+	}
+
+	void PieceHasherTest::benchHashing ()
+	{
+		QFETCH (int, threads);
+
+		Files files { Dir_->path () + "/data", BenchPieceSize };
+
+		QThreadPool pool;
+		pool.setMaxThreadCount (threads);
+		PieceHasher hasher { files.FS_, Dir_->path (), &pool };
+
+		QElapsedTimer timer;
+		int runs = 0;
+		timer.start ();
+		QBENCHMARK
+		{
+			Hash (hasher, files.FS_.num_pieces ());
+			++runs;
+		}
+
+		const auto elapsed = std::max<qint64> (timer.elapsed (), 1);
+		qDebug () << threads
+				<< "threads:"
+				<< files.FS_.total_size () * runs / 1024 / 1024 * 1000 / elapsed
+				<< "MiB/s";
+	}
+}
+}
@@ -0,0 +1,211 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "torrentrowindextest.h"
+#include <algorithm>
+#include <QtTest>
+#include <libtorrent/version.hpp>
+#include <libtorrent/torrent_handle.hpp>
+
+#if LIBTORRENT_VERSION_NUM >= 10100
+#include <libtorrent/torrent_status.hpp>
+#endif
+
+#include "torrentrowindex.h"
+#include "cachedstatuskeeper.h"
+
+QTEST_APPLESS_MAIN (LeechCraft::BitTorrent::TorrentRowIndexTest)
+
+namespace LeechCraft
+{
+namespace BitTorrent
+{
+	namespace
+	{
+		const int SyntheticTorrentsCount = 10000;
+
+		libtorrent::sha1_hash MakeHash (int num)
+		{
+			const auto& bytes = QCryptographicHash::hash (QByteArray::number (num), QCryptographicHash::Sha1);
+			return libtorrent::sha1_hash { bytes.constData () };
+		}
+
+		QList<libtorrent::sha1_hash> MakeHashes (int count)
+		{
+			QList<libtorrent::sha1_hash> result;
+			result.reserve (count);
+			for (int i = 0; i < count; ++i)
+				result << MakeHash (i);
+			return result;
+		}
+
+		auto Identity = [] (const libtorrent::sha1_hash& hash) { return hash; };
+
+		TorrentRowIndex MakeIndex (const QList<libtorrent::sha1_hash>& hashes)
+		{
+			TorrentRowIndex index;
+			index.Reserve (hashes.size ());
+			index.Reindex (hashes, 0, hashes.size (), Identity);
+			return index;
+		}
+
+		std::vector<libtorrent::torrent_status> MakeStatuses (const QList<libtorrent::sha1_hash>& hashes)
+		{
+			std::vector<libtorrent::torrent_status> result;
+			result.reserve (hashes.size ());
+			for (const auto& hash : hashes)
+			{
+				libtorrent::torrent_status status;
+				status.info_hash = hash;
+				result.push_back (status);
+			}
+
+			/* libtorrent posts the updates in no particular order.
+			 */
+			std::reverse (result.begin (), result.end ());
+			return result;
+		}
+	}
+
+	void TorrentRowIndexTest::testFind ()
+	{
+		const auto& hashes = MakeHashes (10);
+		const auto& index = MakeIndex (hashes);
+
+		for (int i = 0; i < hashes.size (); ++i)
+			QCOMPARE (index.Find (hashes.at (i)), i);
+	}
+
+	void TorrentRowIndexTest::testFindMissing ()
+	{
+		const auto& index = MakeIndex (MakeHashes (10));
+		QCOMPARE (index.Find (MakeHash (10)), -1);
+	}
+
+	void TorrentRowIndexTest::testReindexAfterRemove ()
+	{
+		auto hashes = MakeHashes (10);
+		auto index = MakeIndex (hashes);
+
+		const auto removed = hashes.takeAt (3);
+		index.Remove (removed);
+		index.Reindex (hashes, 3, hashes.size (), Identity);
+
+		QCOMPARE (index.Find (removed), -1);
+		for (int i = 0; i < hashes.size (); ++i)
+			QCOMPARE (index.Find (hashes.at (i)), i);
+	}
+
+	void TorrentRowIndexTest::testReindexAfterMoveToTop ()
+	{
+		auto hashes = MakeHashes (10);
+		auto index = MakeIndex (hashes);
+
+		hashes.push_front (hashes.takeAt (5));
+		index.Reindex (hashes, 0, 6, Identity);
+
+		for (int i = 0; i < hashes.size (); ++i)
+			QCOMPARE (index.Find (hashes.at (i)), i);
+	}
+
+	void TorrentRowIndexTest::testCoalesceEmpty ()
+	{
+		QCOMPARE (CoalesceRows ({}).isEmpty (), true);
+	}
+
+	void TorrentRowIndexTest::testCoalesceUnsorted ()
+	{
+		const QList<QPair<int, int>> expected { { 0, 2 }, { 5, 5 }, { 7, 8 } };
+		QCOMPARE (CoalesceRows ({ 8, 1, 5, 0, 7, 2 }), expected);
+	}
+
+	void TorrentRowIndexTest::testCoalesceDuplicates ()
+	{
+		const QList<QPair<int, int>> expected { { 1, 3 } };
+		QCOMPARE (CoalesceRows ({ 3, 1, 2, 2, 1 }), expected);
+	}
+
+	void TorrentRowIndexTest::testBatcherSkipsRemoved ()
+	{
+		auto hashes = MakeHashes (10);
+		auto index = MakeIndex (hashes);
+
+		CachedStatusKeeper keeper;
+		StatusUpdateBatcher batcher { &keeper, index };
+		batcher.Post (MakeStatuses (hashes));
+
+		const auto removed = hashes.takeAt (3);
+		index.Remove (removed);
+		index.Reindex (hashes, 3, hashes.size (), Identity);
+
+		const QList<QPair<int, int>> expected { { 0, 8 } };
+		QCOMPARE (batcher.TakeChangedRanges (), expected);
+		QCOMPARE (batcher.HasPending (), false);
+	}
+
+	void TorrentRowIndexTest::benchUpdateStatusLinear ()
+	{
+		const auto& hashes = MakeHashes (SyntheticTorrentsCount);
+		const auto& statuses = MakeStatuses (hashes);
+
+		int changes = 0;
+		QBENCHMARK
+		{
+			for (const auto& status : statuses)
+			{
+				const auto pos = std::find (hashes.begin (), hashes.end (), status.info_hash);
+				if (pos != hashes.end ())
+					++changes;
+			}
+		}
+		QVERIFY (changes);
+	}
+
+	void TorrentRowIndexTest::benchUpdateStatusIndexed ()
+	{
+		const auto& hashes = MakeHashes (SyntheticTorrentsCount);
+		const auto& statuses = MakeStatuses (hashes);
+		const auto& index = MakeIndex (hashes);
+
+		CachedStatusKeeper keeper;
+		StatusUpdateBatcher batcher { &keeper, index };
+
+		QList<QPair<int, int>> ranges;
+		QBENCHMARK
+		{
+			batcher.Post (statuses);
+			ranges = batcher.TakeChangedRanges ();
+		}
+
+		const QList<QPair<int, int>> expected { { 0, SyntheticTorrentsCount - 1 } };
+		QCOMPARE (ranges, expected);
+	}
+}
+}
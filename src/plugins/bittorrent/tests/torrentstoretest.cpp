@@ -0,0 +1,195 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "torrentstoretest.h"
+#include <QtTest>
+#include <QTemporaryDir>
+#include "torrentstore.h"
+
+QTEST_GUILESS_MAIN (LeechCraft::BitTorrent::TorrentStoreTest)
+
+namespace LeechCraft
+{
+namespace BitTorrent
+{
+	namespace
+	{
+		const int SyntheticTorrentsCount = 5000;
+
+		libtorrent::sha1_hash MakeHash (int num)
+		{
+			const auto& bytes = QCryptographicHash::hash (QByteArray::number (num), QCryptographicHash::Sha1);
+			return libtorrent::sha1_hash { bytes.constData () };
+		}
+
+		TorrentRecord MakeRecord (int num)
+		{
+			TorrentRecord record;
+			record.TorrentFileContents_ = QByteArray (16 * 1024, 'a' + num % 26);
+			record.TorrentFileName_ = QString::number (num) + ".torrent";
+			record.SavePath_ = "/tmp/downloads";
+			record.Tags_ = QStringList { "tag" + QString::number (num % 10) };
+			record.Parameters_ = num % 2 ? NoAutostart : NoParameters;
+			record.AutoManaged_ = num % 3;
+			record.FilePriorities_.assign (num % 20 + 1, 1);
+			return record;
+		}
+
+		void SaveSynthetic (TorrentStore& store, int count)
+		{
+			QList<libtorrent::sha1_hash> order;
+			for (int i = 0; i < count; ++i)
+			{
+				store.Save (MakeHash (i), MakeRecord (i));
+				order << MakeHash (i);
+			}
+			store.SaveOrder (order);
+			store.Flush ();
+		}
+	}
+
+	void TorrentStoreTest::testUninitialized ()
+	{
+		QTemporaryDir dir;
+		TorrentStore store { dir.path () };
+		QCOMPARE (store.IsInitialized (), false);
+		QCOMPARE (store.Load ().size (), 0);
+	}
+
+	void TorrentStoreTest::testRoundtrip ()
+	{
+		QTemporaryDir dir;
+		{
+			TorrentStore store { dir.path () };
+			SaveSynthetic (store, 3);
+		}
+
+		TorrentStore store { dir.path () };
+		QCOMPARE (store.IsInitialized (), true);
+
+		const auto& records = store.Load ();
+		QCOMPARE (records.size (), 3);
+
+		const auto& expected = MakeRecord (1);
+		const auto& record = records.at (1);
+		QCOMPARE (record.TorrentFileContents_, expected.TorrentFileContents_);
+		QCOMPARE (record.TorrentFileName_, expected.TorrentFileName_);
+		QCOMPARE (record.SavePath_, expected.SavePath_);
+		QCOMPARE (record.Tags_, expected.Tags_);
+		QCOMPARE (record.Parameters_, expected.Parameters_);
+		QCOMPARE (record.AutoManaged_, expected.AutoManaged_);
+		QVERIFY (record.FilePriorities_ == expected.FilePriorities_);
+	}
+
+	void TorrentStoreTest::testOrder ()
+	{
+		QTemporaryDir dir;
+		TorrentStore store { dir.path () };
+		SaveSynthetic (store, 3);
+
+		store.SaveOrder ({ MakeHash (2), MakeHash (0), MakeHash (1) });
+		store.Flush ();
+
+		const auto& records = store.Load ();
+		QCOMPARE (records.size (), 3);
+		QCOMPARE (records.at (0).TorrentFileName_, QString { "2.torrent" });
+		QCOMPARE (records.at (1).TorrentFileName_, QString { "0.torrent" });
+		QCOMPARE (records.at (2).TorrentFileName_, QString { "1.torrent" });
+	}
+
+	void TorrentStoreTest::testUnorderedGoLast ()
+	{
+		QTemporaryDir dir;
+		TorrentStore store { dir.path () };
+		SaveSynthetic (store, 3);
+
+		store.Save (MakeHash (3), MakeRecord (3));
+		store.Flush ();
+
+		const auto& records = store.Load ();
+		QCOMPARE (records.size (), 4);
+		QCOMPARE (records.at (3).TorrentFileName_, QString { "3.torrent" });
+	}
+
+	void TorrentStoreTest::testRemove ()
+	{
+		QTemporaryDir dir;
+		TorrentStore store { dir.path () };
+		SaveSynthetic (store, 3);
+
+		store.Remove (MakeHash (1));
+		store.Flush ();
+
+		const auto& records = store.Load ();
+		QCOMPARE (records.size (), 2);
+		QCOMPARE (records.at (0).TorrentFileName_, QString { "0.torrent" });
+		QCOMPARE (records.at (1).TorrentFileName_, QString { "2.torrent" });
+	}
+
+	void TorrentStoreTest::testResumeData ()
+	{
+		QTemporaryDir dir;
+		TorrentStore store { dir.path () };
+		SaveSynthetic (store, 2);
+
+		store.SaveResumeData (MakeHash (1), "resume");
+		store.Flush ();
+
+		const auto& records = store.Load ();
+		QCOMPARE (records.at (0).ResumeData_, QByteArray {});
+		QCOMPARE (records.at (1).ResumeData_, QByteArray { "resume" });
+	}
+
+	void TorrentStoreTest::benchSave ()
+	{
+		QTemporaryDir dir;
+		TorrentStore store { dir.path () };
+
+		QBENCHMARK_ONCE
+		{
+			SaveSynthetic (store, SyntheticTorrentsCount);
+		}
+	}
+
+	void TorrentStoreTest::benchLoad ()
+	{
+		QTemporaryDir dir;
+		TorrentStore store { dir.path () };
+		SaveSynthetic (store, SyntheticTorrentsCount);
+
+		QList<TorrentRecord> records;
+		QBENCHMARK
+		{
+			records = store.Load ();
+		}
+		QCOMPARE (records.size (), SyntheticTorrentsCount);
+	}
+}
+}
@@ -27,22 +27,31 @@
  * DEALINGS IN THE SOFTWARE.
  **********************************************************************/
 
+
 #include "torrentmaker.h"
-#include <deque>
+#include <atomic>
+#include <vector>
 #include <boost/filesystem.hpp>
-#include <QFile>
+#include <QSaveFile>
 #include <QFileInfo>
-#include <QProgressDialog>
+#include <QDateTime>
 #include <QMessageBox>
 #include <QDir>
+#include <QMenu>
+#include <QAction>
+#include <QTimer>
+#include <QStandardItemModel>
+#include <QtConcurrentRun>
 #include <QtDebug>
-#include <QMainWindow>
 #include <libtorrent/create_torrent.hpp>
 #include <util/xpc/util.h>
+#include <util/threads/futures.h>
+#include <interfaces/ijobholder.h>
 #include <interfaces/core/icoreproxy.h>
 #include <interfaces/core/irootwindowsmanager.h>
 #include <interfaces/core/ientitymanager.h>
 #include "core.h"
+#include "piecehasher.h"
 
 namespace LeechCraft
 {
@@ -50,6 +59,8 @@ namespace BitTorrent
 {
 	namespace
 	{
+		const int ProgressUpdateInterval = 500;
+
 		bool FileFilter (const boost::filesystem::path& filename)
 		{
 			if (filename.leaf ().string () [0] == '.')
@@ -63,91 +74,404 @@ namespace BitTorrent
 				return true;
 			return false;
 		}
+
+		QList<QDateTime> GetStamps (const libtorrent::file_storage& fs, const QString& basePath)
+		{
+			const std::string base { basePath.toUtf8 ().constData () };
+
+			QList<QDateTime> result;
+			for (int i = 0; i < fs.num_files (); ++i)
+				if (!fs.pad_file_at (i))
+				{
+					const auto& path = fs.file_path (i, base);
+					result << QFileInfo { QString::fromUtf8 (path.c_str ()) }.lastModified ();
+				}
+			return result;
+		}
+
+		void SetMetadata (libtorrent::create_torrent& ct,
+				const NewTorrentParams& params, const QString& creator)
+		{
+			ct.set_creator (creator.toUtf8 ().constData ());
+			if (!params.Comment_.isEmpty ())
+				ct.set_comment (params.Comment_.toUtf8 ());
+			for (const auto& seed : params.URLSeeds_)
+				ct.add_url_seed (seed.toStdString ());
+			ct.set_priv (!params.DHTEnabled_);
+
+			if (params.DHTEnabled_)
+				for (const auto& node : params.DHTNodes_)
+				{
+					const auto& splitted = node.split (":");
+					ct.add_node (std::pair<std::string, int> (splitted [0].trimmed ().toStdString (),
+								splitted [1].trimmed ().toInt ()));
+				}
+
+			ct.add_tracker (params.AnnounceURL_.toStdString ());
+		}
+
+		QString WriteTorrent (libtorrent::create_torrent& ct, const QString& filename)
+		{
+			std::vector<char> buffer;
+			libtorrent::bencode (std::back_inserter (buffer), ct.generate ());
+
+			QSaveFile file { filename };
+			if (!file.open (QIODevice::WriteOnly))
+				return TorrentMaker::tr ("could not open file %1 for write: %2")
+						.arg (filename)
+						.arg (file.errorString ());
+
+			if (file.write (buffer.data (), buffer.size ()) != static_cast<qint64> (buffer.size ()) ||
+					!file.commit ())
+				return TorrentMaker::tr ("could not write file %1: %2")
+						.arg (filename)
+						.arg (file.errorString ());
+
+			return {};
+		}
 	}
 
+	struct TorrentMaker::Batch
+	{
+		int Remaining_;
+		QList<QPair<QString, QString>> Created_;
+	};
+
+	struct TorrentMaker::Job
+	{
+		enum class State
+		{
+			Queued,
+			Running,
+			Cancelled,
+			Failed,
+			Finished
+		};
+
+		NewTorrentParams Params_;
+		QString Output_;
+		QString Creator_;
+		std::shared_ptr<Batch> Batch_;
+
+		libtorrent::file_storage FS_;
+		std::unique_ptr<libtorrent::create_torrent> CT_;
+		QList<QDateTime> Stamps_;
+
+		std::atomic<bool> Cancelled_ { false };
+		std::atomic<bool> Started_ { false };
+		std::atomic<int> NextPiece_ { 0 };
+		std::atomic<int> TotalPieces_ { 0 };
+		bool Written_ = false;
+		bool Settled_ = false;
+
+		State State_ = State::Queued;
+		QString Error_;
+
+		QList<QStandardItem*> Row_;
+		std::unique_ptr<QMenu> Menu_;
+		QAction *CancelAction_ = nullptr;
+		QAction *ResumeAction_ = nullptr;
+		QAction *RemoveAction_ = nullptr;
+	};
+
 	TorrentMaker::TorrentMaker (const ICoreProxy_ptr& proxy, QObject *parent)
 	: QObject { parent }
 	, Proxy_ { proxy }
+	, Model_ { new QStandardItemModel { this } }
+	, ProgressTimer_ { new QTimer { this } }
 	{
+		JobPool_.setMaxThreadCount (1);
+
+		ProgressTimer_->setInterval (ProgressUpdateInterval);
+		connect (ProgressTimer_,
+				SIGNAL (timeout ()),
+				this,
+				SLOT (updateProgress ()));
 	}
 
-	void TorrentMaker::Start (NewTorrentParams params)
+	TorrentMaker::~TorrentMaker ()
 	{
-		QString filename = params.Output_;
-		if (!filename.endsWith (".torrent"))
-			filename.append (".torrent");
-		QFile file (filename);
-		if (!file.open (QIODevice::WriteOnly | QIODevice::Truncate))
-		{
-			ReportError (tr ("Could not open file %1 for write!").arg (filename));
+		for (const auto& job : Jobs_)
+			job->Cancelled_ = true;
+		JobPool_.waitForDone ();
+	}
+
+	QAbstractItemModel* TorrentMaker::GetModel () const
+	{
+		return Model_;
+	}
+
+	void TorrentMaker::Start (const QList<NewTorrentParams>& paramsList)
+	{
+		if (paramsList.isEmpty ())
 			return;
+
+		const auto batch = std::make_shared<Batch> ();
+		batch->Remaining_ = paramsList.size ();
+
+		const auto& creator = QString ("LeechCraft BitTorrent %1").arg (Proxy_->GetVersion ());
+
+		for (const auto& params : paramsList)
+		{
+			const auto job = std::make_shared<Job> ();
+			job->Params_ = params;
+			job->Output_ = params.Output_;
+			if (!job->Output_.endsWith (".torrent"))
+				job->Output_.append (".torrent");
+			job->Creator_ = creator;
+			job->Batch_ = batch;
+
+			job->Row_ =
+			{
+				new QStandardItem { QFileInfo { job->Output_ }.fileName () },
+				new QStandardItem,
+				new QStandardItem
+			};
+			Util::InitJobHolderRow (job->Row_);
+
+			job->Menu_.reset (new QMenu);
+			const std::weak_ptr<Job> weak { job };
+			job->CancelAction_ = job->Menu_->addAction (tr ("Cancel torrent creation"),
+					this,
+					[this, weak] { if (const auto job = weak.lock ()) Cancel (job); });
+			job->ResumeAction_ = job->Menu_->addAction (tr ("Resume torrent creation"),
+					this,
+					[this, weak] { if (const auto job = weak.lock ()) Run (job); });
+			job->RemoveAction_ = job->Menu_->addAction (tr ("Remove"),
+					this,
+					[this, weak] { if (const auto job = weak.lock ()) RemoveJob (job); });
+			for (const auto item : job->Row_)
+				item->setData (QVariant::fromValue<QMenu*> (job->Menu_.get ()), RoleContextMenu);
+
+			Model_->appendRow (job->Row_);
+			Jobs_ << job;
+
+			Run (job);
 		}
+	}
+
+	void TorrentMaker::Run (const Job_ptr& job)
+	{
+		if (job->Settled_)
+		{
+			job->Settled_ = false;
+			++job->Batch_->Remaining_;
+		}
+
+		job->Cancelled_ = false;
+		job->Started_ = false;
+		job->Error_.clear ();
+		job->State_ = Job::State::Queued;
+		UpdateRow (job);
+
+		const auto hashPool = &HashPool_;
+		const auto worker = [job, hashPool] () -> QString
+		{
+			if (job->Cancelled_)
+				return {};
+
+			job->Started_ = true;
 
-		libtorrent::file_storage fs;
-		const auto& fullPath = std::string (params.Path_.toUtf8 ().constData ());
-		libtorrent::add_files (fs, fullPath, FileFilter);
-		libtorrent::create_torrent ct (fs, params.PieceSize_);
-
-		ct.set_creator (qPrintable (QString ("LeechCraft BitTorrent %1")
-					.arg (Core::Instance ()->GetProxy ()->GetVersion ())));
-		if (!params.Comment_.isEmpty ())
-			ct.set_comment (params.Comment_.toUtf8 ());
-		for (int i = 0; i < params.URLSeeds_.size (); ++i)
-			ct.add_url_seed (params.URLSeeds_.at (0).toStdString ());
-		ct.set_priv (!params.DHTEnabled_);
-
-		if (params.DHTEnabled_)
-			for (int i = 0; i < params.DHTNodes_.size (); ++i)
+			const auto& path = QDir::cleanPath (job->Params_.Path_);
+			const auto& basePath = QFileInfo { path }.absolutePath ();
+
+			const auto& outputDir = QFileInfo { job->Output_ }.absolutePath ();
+			if (!QFileInfo { outputDir }.isWritable ())
+				return tr ("could not open file %1 for write")
+						.arg (job->Output_);
+
+			if (job->CT_ && job->Stamps_ != GetStamps (job->FS_, basePath))
 			{
-				QStringList splitted = params.DHTNodes_.at (i).split (":");
-				ct.add_node (std::pair<std::string, int> (splitted [0].trimmed ().toStdString (),
-							splitted [1].trimmed ().toInt ()));
+				qDebug () << Q_FUNC_INFO
+						<< "files have been modified since the hashing has been stopped, restarting"
+						<< path;
+				job->CT_.reset ();
+			}
+
+			if (!job->CT_)
+			{
+				job->FS_ = libtorrent::file_storage {};
+				libtorrent::add_files (job->FS_, path.toUtf8 ().constData (), FileFilter);
+				if (!job->FS_.num_files ())
+					return tr ("no files to create the torrent from in %1")
+							.arg (path);
+
+				job->CT_.reset (new libtorrent::create_torrent { job->FS_, job->Params_.PieceSize_ });
+				SetMetadata (*job->CT_, job->Params_, job->Creator_);
+
+				job->Stamps_ = GetStamps (job->FS_, basePath);
+				job->NextPiece_ = 0;
+				job->TotalPieces_ = job->CT_->num_pieces ();
 			}
 
-		ct.add_tracker (params.AnnounceURL_.toStdString ());
+			try
+			{
+				PieceHasher hasher { job->FS_, basePath, hashPool };
+				hasher.Hash (job->NextPiece_,
+						[job] (int piece, const libtorrent::sha1_hash& hash)
+						{
+							job->CT_->set_hash (piece, hash);
+							job->NextPiece_ = piece + 1;
+						},
+						job->Cancelled_);
+			}
+			catch (const std::exception& e)
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "hashing failed:"
+						<< e.what ();
+				return QString::fromUtf8 (e.what ());
+			}
+
+			if (job->NextPiece_ < job->TotalPieces_)
+				return {};
+
+			const auto& error = WriteTorrent (*job->CT_, job->Output_);
+			job->Written_ = error.isEmpty ();
+			return error;
+		};
 
-		QProgressDialog pd;
-		pd.setWindowTitle (tr ("Hashing torrent..."));
-		pd.setMaximum (ct.num_pieces ());
+		Util::Sequence (this, QtConcurrent::run (&JobPool_, worker)) >>
+				[this, job] (const QString& error)
+				{
+					job->Error_ = error;
+					HandleFinished (job);
+				};
 
-		boost::system::error_code hashesError;
-		libtorrent::set_piece_hashes (ct,
-				fullPath,
-				[&pd] (int i) { pd.setValue (i); },
-				hashesError);
-		if (hashesError)
+		ProgressTimer_->start ();
+	}
+
+	void TorrentMaker::Cancel (const Job_ptr& job)
+	{
+		job->Cancelled_ = true;
+		UpdateRow (job);
+	}
+
+	void TorrentMaker::HandleFinished (const Job_ptr& job)
+	{
+		if (!job->Error_.isEmpty ())
 		{
-			QString message = QString::fromUtf8 (hashesError.message ().c_str ());
-			qWarning () << Q_FUNC_INFO
-					<< "while in libtorrent::set_piece_hashes():"
-					<< message
-					<< hashesError.category ().name ();
+			job->State_ = Job::State::Failed;
 			ReportError (tr ("Torrent creation failed: %1")
-					.arg (message));
-			return;
+					.arg (job->Error_));
 		}
+		else if (!job->Written_)
+			job->State_ = Job::State::Cancelled;
+		else
+		{
+			job->State_ = Job::State::Finished;
+			job->Batch_->Created_.append ({ job->Output_, job->Params_.Path_ });
+		}
+
+		job->Settled_ = true;
+		--job->Batch_->Remaining_;
+
+		if (job->State_ == Job::State::Finished)
+			RemoveJob (job);
+		else
+			UpdateRow (job);
+
+		OfferSeeding (job->Batch_);
+	}
 
-		libtorrent::entry e = ct.generate ();
-		std::deque<char> outbuf;
-		libtorrent::bencode (std::back_inserter (outbuf), e);
+	void TorrentMaker::RemoveJob (const Job_ptr& job)
+	{
+		if (job->State_ == Job::State::Queued || job->State_ == Job::State::Running)
+			return;
+
+		Model_->removeRow (job->Row_.first ()->row ());
+		Jobs_.removeOne (job);
+		job->Menu_.release ()->deleteLater ();
+	}
+
+	void TorrentMaker::OfferSeeding (const std::shared_ptr<Batch>& batch)
+	{
+		if (batch->Remaining_ || batch->Created_.isEmpty ())
+			return;
 
-		for (size_t i = 0; i < outbuf.size (); ++i)
-			file.write (&outbuf.at (i), 1);
-		file.close ();
+		// Failed or cancelled jobs may still be resumed later, so what is
+		// offered now is not offered again when they finish.
+		const auto created = batch->Created_;
+		batch->Created_.clear ();
 
-		auto rootWM = Core::Instance ()->GetProxy ()->GetRootWindowsManager ();
+		const auto& question = created.size () == 1 ?
+				tr ("Torrent file generated: %1.<br />Do you want to start seeding now?")
+					.arg (QDir::toNativeSeparators (created.first ().first)) :
+				tr ("%n torrent file(s) generated. Do you want to start seeding now?", 0, created.size ());
+
+		auto rootWM = Proxy_->GetRootWindowsManager ();
 		if (QMessageBox::question (rootWM->GetPreferredWindow (),
 					"LeechCraft",
-					tr ("Torrent file generated: %1.<br />Do you want to start seeding now?")
-						.arg (QDir::toNativeSeparators (filename)),
-					QMessageBox::Yes | QMessageBox::No) ==
-				QMessageBox::Yes)
-			Core::Instance ()->AddFile (filename,
-					QString::fromUtf8 (fullPath.c_str ()),
+					question,
+					QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes)
+			return;
+
+		for (const auto& pair : created)
+			Core::Instance ()->AddFile (pair.first,
+					pair.second,
 					QStringList (),
 					false);
 	}
 
+	void TorrentMaker::UpdateRow (const Job_ptr& job)
+	{
+		const auto done = job->NextPiece_.load ();
+		const auto total = job->TotalPieces_.load ();
+
+		if (job->State_ == Job::State::Queued && job->Started_)
+			job->State_ = Job::State::Running;
+
+		QString status;
+		switch (job->State_)
+		{
+		case Job::State::Queued:
+			status = tr ("Waiting...");
+			break;
+		case Job::State::Running:
+			status = job->Cancelled_ ?
+					tr ("Cancelling...") :
+					tr ("Hashing...");
+			break;
+		case Job::State::Cancelled:
+			status = tr ("Cancelled");
+			break;
+		case Job::State::Failed:
+			status = tr ("Failed: %1").arg (job->Error_);
+			break;
+		case Job::State::Finished:
+			status = tr ("Finished");
+			break;
+		}
+		job->Row_.value (JobHolderColumn::JobStatus)->setText (status);
+
+		const auto isActive = job->State_ == Job::State::Queued ||
+				job->State_ == Job::State::Running;
+		job->CancelAction_->setEnabled (isActive && !job->Cancelled_);
+		job->ResumeAction_->setEnabled (!isActive);
+		job->RemoveAction_->setEnabled (!isActive);
+
+		Util::SetJobHolderProgress (job->Row_, done, total,
+				tr ("%1 of %2 pieces").arg (done).arg (total));
+	}
+
+	void TorrentMaker::updateProgress ()
+	{
+		bool hasActive = false;
+		for (const auto& job : Jobs_)
+		{
+			const auto isActive = job->State_ == Job::State::Queued ||
+					job->State_ == Job::State::Running;
+			if (!isActive)
+				continue;
+
+			hasActive = true;
+			UpdateRow (job);
+		}
+
+		if (!hasActive)
+			ProgressTimer_->stop ();
+	}
+
 	void TorrentMaker::ReportError (const QString& error)
 	{
 		const auto& entity = Util::MakeNotification ("BitTorrent", error, Priority::Critical);
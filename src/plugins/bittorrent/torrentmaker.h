@@ -27,26 +27,69 @@
  * DEALINGS IN THE SOFTWARE.
  **********************************************************************/
 
+
 #pragma once
 
+#include <memory>
 #include <QObject>
+#include <QThreadPool>
 #include <interfaces/core/icoreproxy.h>
 #include "newtorrentparams.h"
 
+class QAbstractItemModel;
+class QStandardItemModel;
+class QTimer;
+
 namespace LeechCraft
 {
 namespace BitTorrent
 {
+	/** Creates torrents in background jobs.
+	 *
+	 * Each torrent is a job with its own row in the model returned by
+	 * GetModel(). Jobs are run one after another, with the pieces of
+	 * each job hashed in parallel. A job can be cancelled via its
+	 * context menu and later resumed from the first piece that hasn't
+	 * been hashed yet.
+	 */
 	class TorrentMaker : public QObject
 	{
 		Q_OBJECT
 
 		const ICoreProxy_ptr Proxy_;
+		QStandardItemModel * const Model_;
+		QTimer * const ProgressTimer_;
+
+		QThreadPool JobPool_;
+		QThreadPool HashPool_;
+
+		struct Batch;
+		struct Job;
+		using Job_ptr = std::shared_ptr<Job>;
+		QList<Job_ptr> Jobs_;
 	public:
 		TorrentMaker (const ICoreProxy_ptr&, QObject* = 0);
-		void Start (NewTorrentParams);
+		~TorrentMaker ();
+
+		QAbstractItemModel* GetModel () const;
+
+		/** Creates a job for each of the params.
+		 *
+		 * When every job of the batch has either finished, failed or
+		 * been cancelled, the user is asked whether the created torrents
+		 * should be seeded.
+		 */
+		void Start (const QList<NewTorrentParams>&);
 	private:
+		void Run (const Job_ptr&);
+		void Cancel (const Job_ptr&);
+		void HandleFinished (const Job_ptr&);
+		void RemoveJob (const Job_ptr&);
+		void OfferSeeding (const std::shared_ptr<Batch>&);
+		void UpdateRow (const Job_ptr&);
 		void ReportError (const QString&);
+	private slots:
+		void updateProgress ();
 	};
 }
 }
@@ -58,6 +58,7 @@
 #include <util/tags/tagscompletionmodel.h>
 #include <util/tags/tagscompleter.h>
 #include <util/util.h>
+#include <util/models/mergemodel.h>
 #include <util/xpc/util.h>
 #include <util/shortcuts/shortcutmanager.h>
 #include "core.h"
@@ -72,6 +73,7 @@
 #include "ipfilterdialog.h"
 #include "speedselectoraction.h"
 #include "torrenttab.h"
+#include "torrentmaker.h"
 #include "sessionsettingsmanager.h"
 #include "sessionstats.h"
 
@@ -142,6 +144,13 @@ namespace BitTorrent
 				SIGNAL (removeTab (QWidget*)));
 
 		ReprProxy_ = new ReprProxy (Core::Instance ());
+
+		QStringList reprHeaders;
+		for (int i = 0; i < ReprProxy_->columnCount (); ++i)
+			reprHeaders << ReprProxy_->headerData (i, Qt::Horizontal).toString ();
+		ReprModel_ = new Util::MergeModel (reprHeaders, this);
+		ReprModel_->AddModel (ReprProxy_);
+		ReprModel_->AddModel (Core::Instance ()->GetTorrentMaker ()->GetModel ());
 	}
 
 	void TorrentPlugin::SecondInit ()
@@ -323,17 +332,15 @@ namespace BitTorrent
 
 	QAbstractItemModel* TorrentPlugin::GetRepresentation () const
 	{
-		return ReprProxy_;
+		return ReprModel_;
 	}
 
 	void TorrentPlugin::handleTasksTreeSelectionCurrentRowChanged (const QModelIndex& si, const QModelIndex&)
 	{
-		QModelIndex mapped = Core::Instance ()->GetProxy ()->MapToSource (si);
-		if (mapped.model () != GetRepresentation ())
-			mapped = QModelIndex ();
+		const auto row = MapToTorrentRow (si);
 
-		Core::Instance ()->SetCurrentTorrent (mapped.row ());
-		if (mapped.isValid ())
+		Core::Instance ()->SetCurrentTorrent (row);
+		if (row >= 0)
 			TabWidget_->InvalidateSelection ();
 
 		setActionsEnabled ();
@@ -529,9 +536,9 @@ namespace BitTorrent
 		QList<int> rows;
 		Q_FOREACH (QModelIndex si, sis)
 		{
-			QModelIndex mapped = Core::Instance ()->GetProxy ()->MapToSource (si);
-			if (mapped.isValid ())
-				rows << mapped.row ();
+			const auto row = MapToTorrentRow (si);
+			if (row >= 0)
+				rows << row;
 		}
 
 		auto rootWM = Core::Instance ()->GetProxy ()->GetRootWindowsManager ();
@@ -578,9 +585,12 @@ namespace BitTorrent
 			return;
 		}
 
-		QList<int> rows;
 		Q_FOREACH (QModelIndex si, sis)
-			Core::Instance ()->ResumeTorrent (Core::Instance ()->GetProxy ()->MapToSource (si).row ());
+		{
+			const auto row = MapToTorrentRow (si);
+			if (row >= 0)
+				Core::Instance ()->ResumeTorrent (row);
+		}
 		setActionsEnabled ();
 	}
 
@@ -598,41 +608,52 @@ namespace BitTorrent
 			return;
 		}
 
-		QList<int> rows;
 		Q_FOREACH (QModelIndex si, sis)
-			Core::Instance ()->PauseTorrent (Core::Instance ()->GetProxy ()->MapToSource (si).row ());
+		{
+			const auto row = MapToTorrentRow (si);
+			if (row >= 0)
+				Core::Instance ()->PauseTorrent (row);
+		}
 		setActionsEnabled ();
 	}
 
-	namespace
+	int TorrentPlugin::MapToTorrentRow (const QModelIndex& si) const
 	{
-		std::vector<int> GetSelections (QAbstractItemModel *model,
-				QObject *sender)
-		{
-			QModelIndexList sis;
-			try
-			{
-				sis = Util::GetSummarySelectedRows (sender);
-			}
-			catch (const std::runtime_error& e)
-			{
-				qWarning () << Q_FUNC_INFO
-						<< e.what ();
-				throw;
-			}
+		const auto& mapped = Core::Instance ()->GetProxy ()->MapToSource (si);
+		if (mapped.model () != ReprModel_)
+			return -1;
 
-			std::vector<int> selections;
-			Q_FOREACH (QModelIndex si, sis)
-			{
-				QModelIndex mapped = Core::Instance ()->GetProxy ()->MapToSource (si);
-				if (mapped.model () != model)
-					continue;
-				selections.push_back (mapped.row ());
-			}
+		const auto& source = ReprModel_->mapToSource (mapped);
+		if (source.model () != ReprProxy_)
+			return -1;
+
+		return ReprProxy_->mapToSource (source).row ();
+	}
+
+	std::vector<int> TorrentPlugin::GetSelections (QObject *sender) const
+	{
+		QModelIndexList sis;
+		try
+		{
+			sis = Util::GetSummarySelectedRows (sender);
+		}
+		catch (const std::runtime_error& e)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< e.what ();
+			throw;
+		}
 
-			return selections;
+		std::vector<int> selections;
+		Q_FOREACH (QModelIndex si, sis)
+		{
+			const auto row = MapToTorrentRow (si);
+			if (row >= 0)
+				selections.push_back (row);
 		}
-	};
+
+		return selections;
+	}
 
 	void TorrentPlugin::on_MoveUp__triggered ()
 	{
@@ -651,7 +672,7 @@ namespace BitTorrent
 		std::vector<int> selections;
 		try
 		{
-			selections = GetSelections (GetRepresentation (), sender ());
+			selections = GetSelections (sender ());
 		}
 		catch (const std::exception& e)
 		{
@@ -672,7 +693,7 @@ namespace BitTorrent
 		Q_FOREACH (QModelIndex si, sis)
 		{
 			QModelIndex sibling = si.sibling (si.row () - 1, si.column ());
-			if (Core::Instance ()->GetProxy ()->MapToSource (sibling).model () != GetRepresentation ())
+			if (MapToTorrentRow (sibling) < 0)
 				continue;
 
 			selection.select (sibling, sibling);
@@ -700,7 +721,7 @@ namespace BitTorrent
 		std::vector<int> selections;
 		try
 		{
-			selections = GetSelections (GetRepresentation (), sender ());
+			selections = GetSelections (sender ());
 		}
 		catch (const std::exception& e)
 		{
@@ -721,7 +742,7 @@ namespace BitTorrent
 		Q_FOREACH (QModelIndex si, sis)
 		{
 			QModelIndex sibling = si.sibling (si.row () + 1, si.column ());
-			if (Core::Instance ()->GetProxy ()->MapToSource (sibling).model () != GetRepresentation ())
+			if (MapToTorrentRow (sibling) < 0)
 				continue;
 
 			selection.select (sibling, sibling);
@@ -736,8 +757,7 @@ namespace BitTorrent
 	{
 		try
 		{
-			Core::Instance ()->MoveToTop (GetSelections (GetRepresentation (),
-					sender ()));
+			Core::Instance ()->MoveToTop (GetSelections (sender ()));
 		}
 		catch (const std::exception& e)
 		{
@@ -751,8 +771,7 @@ namespace BitTorrent
 	{
 		try
 		{
-			Core::Instance ()->MoveToBottom (GetSelections (GetRepresentation (),
-					sender ()));
+			Core::Instance ()->MoveToBottom (GetSelections (sender ()));
 		}
 		catch (const std::exception& e)
 		{
@@ -766,7 +785,7 @@ namespace BitTorrent
 	{
 		try
 		{
-			Q_FOREACH (int torrent, GetSelections (GetRepresentation (), sender ()))
+			Q_FOREACH (int torrent, GetSelections (sender ()))
 				Core::Instance ()->ForceReannounce (torrent);
 		}
 		catch (const std::exception& e)
@@ -781,7 +800,7 @@ namespace BitTorrent
 	{
 		try
 		{
-			Q_FOREACH (int torrent, GetSelections (GetRepresentation (), sender ()))
+			Q_FOREACH (int torrent, GetSelections (sender ()))
 				Core::Instance ()->ForceRecheck (torrent);
 		}
 		catch (const std::exception& e)
@@ -807,10 +826,15 @@ namespace BitTorrent
 		}
 
 		std::vector<libtorrent::announce_entry> allTrackers;
+		QList<int> rows;
 		Q_FOREACH (QModelIndex si, sis)
 		{
-			auto those = Core::Instance ()->GetTrackers (Core::Instance ()->
-					GetProxy ()->MapToSource (si).row ());
+			const auto row = MapToTorrentRow (si);
+			if (row < 0)
+				continue;
+
+			rows << row;
+			auto those = Core::Instance ()->GetTrackers (row);
 			std::copy (those.begin (), those.end (), std::back_inserter (allTrackers));
 		}
 
@@ -840,8 +864,8 @@ namespace BitTorrent
 			return;
 
 		const auto& trackers = changer.GetTrackers ();
-		for (const auto& si : sis)
-			Core::Instance ()->SetTrackers (trackers, Proxy_->MapToSource (si).row ());
+		for (const auto row : rows)
+			Core::Instance ()->SetTrackers (trackers, row);
 	}
 
 	void TorrentPlugin::on_MoveFiles__triggered ()
@@ -31,6 +31,7 @@
 
 #include <memory>
 #include <deque>
+#include <vector>
 #include <QMainWindow>
 #include <QToolBar>
 #include <interfaces/iinfo.h>
@@ -59,6 +60,11 @@ class QSortFilterProxyModel;
 
 namespace LeechCraft
 {
+namespace Util
+{
+	class MergeModel;
+}
+
 namespace BitTorrent
 {
 	class AddTorrent;
@@ -150,6 +156,7 @@ namespace BitTorrent
 		TorrentTab *TorrentTab_;
 
 		QSortFilterProxyModel *ReprProxy_;
+		Util::MergeModel *ReprModel_;
 	public:
 		// IInfo
 		void Init (ICoreProxy_ptr);
@@ -226,6 +233,9 @@ namespace BitTorrent
 		void SetupCore ();
 		void SetupStuff ();
 		void SetupActions ();
+
+		int MapToTorrentRow (const QModelIndex&) const;
+		std::vector<int> GetSelections (QObject*) const;
 	signals:
 		void jobFinished (int);
 		void jobRemoved (int);
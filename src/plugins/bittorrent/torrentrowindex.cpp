@@ -0,0 +1,125 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "torrentrowindex.h"
+#include <algorithm>
+#include "cachedstatuskeeper.h"
+
+namespace LeechCraft
+{
+namespace BitTorrent
+{
+	void TorrentRowIndex::Clear ()
+	{
+		Hash2Row_.clear ();
+	}
+
+	void TorrentRowIndex::Reserve (int size)
+	{
+		Hash2Row_.reserve (size);
+	}
+
+	void TorrentRowIndex::Insert (const libtorrent::sha1_hash& hash, int row)
+	{
+		Hash2Row_ [hash] = row;
+	}
+
+	void TorrentRowIndex::Remove (const libtorrent::sha1_hash& hash)
+	{
+		Hash2Row_.remove (hash);
+	}
+
+	int TorrentRowIndex::Find (const libtorrent::sha1_hash& hash) const
+	{
+		return Hash2Row_.value (hash, -1);
+	}
+
+	QList<QPair<int, int>> CoalesceRows (QVector<int> rows)
+	{
+		if (rows.isEmpty ())
+			return {};
+
+		std::sort (rows.begin (), rows.end ());
+
+		QList<QPair<int, int>> result;
+		QPair<int, int> current { rows.at (0), rows.at (0) };
+		for (const auto row : rows)
+		{
+			if (row <= current.second + 1)
+			{
+				current.second = std::max (current.second, row);
+				continue;
+			}
+
+			result << current;
+			current = { row, row };
+		}
+		result << current;
+
+		return result;
+	}
+
+	StatusUpdateBatcher::StatusUpdateBatcher (CachedStatusKeeper *keeper, const TorrentRowIndex& index)
+	: Keeper_ { keeper }
+	, Index_ (index)
+	{
+	}
+
+	void StatusUpdateBatcher::Post (const std::vector<libtorrent::torrent_status>& statuses)
+	{
+		Changed_.reserve (Changed_.size () + statuses.size ());
+		for (const auto& status : statuses)
+		{
+			Keeper_->HandleStatusUpdatePosted (status);
+			Changed_ << status.info_hash;
+		}
+	}
+
+	bool StatusUpdateBatcher::HasPending () const
+	{
+		return !Changed_.isEmpty ();
+	}
+
+	QList<QPair<int, int>> StatusUpdateBatcher::TakeChangedRanges ()
+	{
+		QVector<int> rows;
+		rows.reserve (Changed_.size ());
+		for (const auto& hash : Changed_)
+		{
+			const auto row = Index_.Find (hash);
+			if (row >= 0)
+				rows << row;
+		}
+		Changed_.clear ();
+
+		return CoalesceRows (rows);
+	}
+}
+}
@@ -0,0 +1,134 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#pragma once
+
+#include <cstring>
+#include <vector>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSet>
+#include <QVector>
+#include <libtorrent/version.hpp>
+#include <libtorrent/peer_id.hpp>
+#include <libtorrent/torrent_handle.hpp>
+
+#if LIBTORRENT_VERSION_NUM >= 10100
+#include <libtorrent/torrent_status.hpp>
+#endif
+
+namespace libtorrent
+{
+	/* Info hashes are uniformly distributed already, so their first
+	 * bytes make a good enough hash.
+	 */
+	inline uint qHash (const sha1_hash& hash, uint seed = 0)
+	{
+		uint result = 0;
+		std::memcpy (&result, &*hash.begin (), sizeof (result));
+		return result ^ seed;
+	}
+}
+
+namespace LeechCraft
+{
+namespace BitTorrent
+{
+	class CachedStatusKeeper;
+
+	/** Maps the info hashes of the torrents to their rows in the model.
+	 *
+	 * The rows are kept in sync by the model itself via Insert(),
+	 * Remove() and Reindex() whenever the rows are added, removed or
+	 * moved around.
+	 */
+	class TorrentRowIndex
+	{
+		QHash<libtorrent::sha1_hash, int> Hash2Row_;
+	public:
+		void Clear ();
+		void Reserve (int);
+
+		void Insert (const libtorrent::sha1_hash&, int row);
+		void Remove (const libtorrent::sha1_hash&);
+
+		/** Returns the row of the torrent with the given info hash, or -1
+		 * if there is no such torrent.
+		 */
+		int Find (const libtorrent::sha1_hash&) const;
+
+		/** Updates the rows from \em from to \em to (not inclusive) of
+		 * the given \em cont, using \em getter to obtain the info hash of
+		 * each element.
+		 */
+		template<typename Cont, typename Getter>
+		void Reindex (const Cont& cont, int from, int to, Getter getter)
+		{
+			for (int i = from; i < to; ++i)
+				Hash2Row_ [getter (cont.at (i))] = i;
+		}
+	};
+
+	/** Sorts the given \em rows and merges them into contiguous ranges.
+	 *
+	 * Each range is represented by its first and last rows, inclusive.
+	 */
+	QList<QPair<int, int>> CoalesceRows (QVector<int> rows);
+
+	/** Accumulates the status updates posted by the session between the
+	 * model updates, so that the views are notified once per batch.
+	 */
+	class StatusUpdateBatcher
+	{
+		CachedStatusKeeper * const Keeper_;
+		const TorrentRowIndex& Index_;
+
+		QSet<libtorrent::sha1_hash> Changed_;
+	public:
+		StatusUpdateBatcher (CachedStatusKeeper*, const TorrentRowIndex&);
+
+		/** Passes the \em statuses to the status keeper and remembers
+		 * the torrents they belong to.
+		 */
+		void Post (const std::vector<libtorrent::torrent_status>& statuses);
+
+		bool HasPending () const;
+
+		/** Returns the ranges of the rows changed since the last call,
+		 * as CoalesceRows() does.
+		 *
+		 * The torrents removed after their updates have been posted are
+		 * skipped.
+		 */
+		QList<QPair<int, int>> TakeChangedRanges ();
+	};
+}
+}
@@ -0,0 +1,273 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "torrentstore.h"
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <boost/optional.hpp>
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include <QSet>
+#include <QtConcurrentMap>
+#include <QtConcurrentRun>
+#include <QtDebug>
+
+namespace LeechCraft
+{
+namespace BitTorrent
+{
+	namespace
+	{
+		const quint8 RecordVersion = 1;
+
+		const QString RecordSuffix = ".record";
+		const QString ResumeSuffix = ".resume";
+
+		QString ToName (const libtorrent::sha1_hash& hash)
+		{
+			return QString::fromLatin1 (QByteArray::fromStdString (hash.to_string ()).toHex ());
+		}
+
+		QDataStream& operator<< (QDataStream& out, const TorrentRecord& record)
+		{
+			QByteArray priorities;
+			priorities.reserve (record.FilePriorities_.size ());
+			std::copy (record.FilePriorities_.begin (), record.FilePriorities_.end (),
+					std::back_inserter (priorities));
+
+			out << RecordVersion
+					<< record.TorrentFileName_
+					<< record.TorrentFileContents_
+					<< record.SavePath_
+					<< record.Tags_
+					<< static_cast<int> (record.Parameters_)
+					<< record.AutoManaged_
+					<< priorities;
+			return out;
+		}
+
+		QDataStream& operator>> (QDataStream& in, TorrentRecord& record)
+		{
+			quint8 version = 0;
+			in >> version;
+			if (version != RecordVersion)
+			{
+				in.setStatus (QDataStream::ReadCorruptData);
+				return in;
+			}
+
+			int parameters = 0;
+			QByteArray priorities;
+			in >> record.TorrentFileName_
+					>> record.TorrentFileContents_
+					>> record.SavePath_
+					>> record.Tags_
+					>> parameters
+					>> record.AutoManaged_
+					>> priorities;
+
+			record.Parameters_ = static_cast<TaskParameters> (parameters);
+			record.FilePriorities_.assign (priorities.begin (), priorities.end ());
+			return in;
+		}
+
+		bool WriteFile (const QString& path, const QByteArray& data)
+		{
+			QSaveFile file { path };
+			if (!file.open (QIODevice::WriteOnly))
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "unable to open"
+						<< path
+						<< file.errorString ();
+				return false;
+			}
+
+			file.write (data);
+			if (!file.commit ())
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "unable to write"
+						<< path
+						<< file.errorString ();
+				return false;
+			}
+
+			return true;
+		}
+
+		QByteArray ReadFile (const QString& path)
+		{
+			QFile file { path };
+			if (!file.open (QIODevice::ReadOnly))
+				return {};
+
+			return file.readAll ();
+		}
+	}
+
+	TorrentStore::TorrentStore (const QDir& dir)
+	: Dir_ { dir }
+	{
+		WritePool_.setMaxThreadCount (1);
+	}
+
+	TorrentStore::~TorrentStore ()
+	{
+		Flush ();
+	}
+
+	bool TorrentStore::IsInitialized () const
+	{
+		return QFile::exists (GetOrderPath ());
+	}
+
+	void TorrentStore::Save (const libtorrent::sha1_hash& hash, const TorrentRecord& record)
+	{
+		QByteArray data;
+		{
+			QDataStream out { &data, QIODevice::WriteOnly };
+			out << record;
+		}
+
+		const auto& path = GetRecordPath (ToName (hash));
+		QtConcurrent::run (&WritePool_, [path, data] { WriteFile (path, data); });
+	}
+
+	void TorrentStore::SaveResumeData (const libtorrent::sha1_hash& hash, const QByteArray& data)
+	{
+		const auto& path = GetResumePath (ToName (hash));
+		QtConcurrent::run (&WritePool_, [path, data] { WriteFile (path, data); });
+	}
+
+	void TorrentStore::SaveOrder (const QList<libtorrent::sha1_hash>& hashes)
+	{
+		QByteArray data;
+		data.reserve (hashes.size () * 41);
+		for (const auto& hash : hashes)
+			data += ToName (hash).toLatin1 () + '\n';
+
+		const auto& path = GetOrderPath ();
+		QtConcurrent::run (&WritePool_, [path, data] { WriteFile (path, data); });
+	}
+
+	void TorrentStore::Remove (const libtorrent::sha1_hash& hash)
+	{
+		const auto& name = ToName (hash);
+		const auto& recordPath = GetRecordPath (name);
+		const auto& resumePath = GetResumePath (name);
+		QtConcurrent::run (&WritePool_,
+				[recordPath, resumePath]
+				{
+					QFile::remove (recordPath);
+					QFile::remove (resumePath);
+				});
+	}
+
+	void TorrentStore::Flush ()
+	{
+		WritePool_.waitForDone ();
+	}
+
+	QList<TorrentRecord> TorrentStore::Load () const
+	{
+		QStringList names;
+		QSet<QString> knownNames;
+		for (const auto& line : ReadFile (GetOrderPath ()).split ('\n'))
+		{
+			const auto& name = QString::fromLatin1 (line.trimmed ());
+			if (name.isEmpty () || knownNames.contains (name))
+				continue;
+
+			names << name;
+			knownNames << name;
+		}
+
+		/* The records saved after the order file was last written (for
+		 * instance, right before a crash) go last.
+		 */
+		for (const auto& filename : Dir_.entryList ({ "*" + RecordSuffix }, QDir::Files))
+		{
+			const auto& name = filename.left (filename.size () - RecordSuffix.size ());
+			if (!knownNames.contains (name))
+				names << name;
+		}
+
+		const auto& records = QtConcurrent::blockingMapped (names,
+				std::function<boost::optional<TorrentRecord> (QString)>
+				{
+					[this] (const QString& name) -> boost::optional<TorrentRecord>
+					{
+						const auto& data = ReadFile (GetRecordPath (name));
+						if (data.isEmpty ())
+							return {};
+
+						TorrentRecord record;
+						QDataStream in { data };
+						in >> record;
+						if (in.status () != QDataStream::Ok)
+						{
+							qWarning () << Q_FUNC_INFO
+									<< "corrupted record"
+									<< name;
+							return {};
+						}
+
+						record.ResumeData_ = ReadFile (GetResumePath (name));
+						return record;
+					}
+				});
+
+		QList<TorrentRecord> result;
+		result.reserve (records.size ());
+		for (const auto& record : records)
+			if (record)
+				result << *record;
+		return result;
+	}
+
+	QString TorrentStore::GetRecordPath (const QString& name) const
+	{
+		return Dir_.filePath (name + RecordSuffix);
+	}
+
+	QString TorrentStore::GetResumePath (const QString& name) const
+	{
+		return Dir_.filePath (name + ResumeSuffix);
+	}
+
+	QString TorrentStore::GetOrderPath () const
+	{
+		return Dir_.filePath ("order");
+	}
+}
+}
@@ -0,0 +1,106 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#pragma once
+
+#include <vector>
+#include <QDir>
+#include <QList>
+#include <QStringList>
+#include <QThreadPool>
+#include <libtorrent/peer_id.hpp>
+#include <interfaces/structures.h>
+
+namespace LeechCraft
+{
+namespace BitTorrent
+{
+	/** The persisted state of a single torrent.
+	 */
+	struct TorrentRecord
+	{
+		QByteArray TorrentFileContents_;
+		QString TorrentFileName_;
+		QString SavePath_;
+		QStringList Tags_;
+		TaskParameters Parameters_ = NoParameters;
+		bool AutoManaged_ = true;
+		std::vector<int> FilePriorities_;
+
+		/** Filled only by TorrentStore::Load(), the resume data is saved
+		 * separately via TorrentStore::SaveResumeData().
+		 */
+		QByteArray ResumeData_;
+	};
+
+	/** Keeps the torrents of the session, one file per torrent.
+	 *
+	 * Each torrent is stored in its own file named after its info hash,
+	 * so only the changed torrents need to be written. All writes are
+	 * atomic and happen in order in a background thread.
+	 */
+	class TorrentStore
+	{
+		const QDir Dir_;
+		QThreadPool WritePool_;
+	public:
+		TorrentStore (const QDir& dir);
+
+		/** Waits until all the scheduled writes finish.
+		 */
+		~TorrentStore ();
+
+		TorrentStore (const TorrentStore&) = delete;
+		TorrentStore& operator= (const TorrentStore&) = delete;
+
+		/** Checks whether the store has ever been saved to.
+		 */
+		bool IsInitialized () const;
+
+		void Save (const libtorrent::sha1_hash&, const TorrentRecord&);
+		void SaveResumeData (const libtorrent::sha1_hash&, const QByteArray&);
+		void SaveOrder (const QList<libtorrent::sha1_hash>&);
+		void Remove (const libtorrent::sha1_hash&);
+
+		/** Waits until all the scheduled writes finish.
+		 */
+		void Flush ();
+
+		/** Loads all the torrents in the last saved order, reading them
+		 * in parallel.
+		 */
+		QList<TorrentRecord> Load () const;
+	private:
+		QString GetRecordPath (const QString&) const;
+		QString GetResumePath (const QString&) const;
+		QString GetOrderPath () const;
+	};
+}
+}
@@ -55,7 +55,7 @@ namespace Kinotify
 		Q_OBJECT
 		Q_INTERFACES (IInfo IEntityHandler IHaveSettings)
 
-		LC_PLUGIN_METADATA ("org.LeechCraft.Kinotify")
+		LC_PLUGIN_METADATA_FILE ("org.LeechCraft.Kinotify", "manifest.json")
 
 		ICoreProxy_ptr Proxy_;
 
@@ -36,7 +36,7 @@
 #include <QStandardItemModel>
 #include <QMessageBox>
 #include <QClipboard>
-#include <QMutexLocker>
+#include <QReadWriteLock>
 #include <QFileInfo>
 #include <QAction>
 #include <QtDebug>
@@ -325,7 +325,7 @@ namespace LMP
 		if (info.LocalPath_.isEmpty ())
 			return;
 
-		QMutexLocker tlLocker (&Core::Instance ().GetLocalFileResolver ()->GetMutex ());
+		QReadLocker tlLocker (&Core::Instance ().GetLocalFileResolver ()->GetLock ());
 
 		auto r = Core::Instance ().GetLocalFileResolver ()->GetFileRef (info.LocalPath_);
 		auto tag = r.tag ();
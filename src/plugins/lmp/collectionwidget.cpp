@@ -54,9 +54,11 @@ namespace LMP
 	{
 		class CollectionFilterModel : public QSortFilterProxyModel
 		{
+			const LocalCollection * const Collection_;
 		public:
-			CollectionFilterModel (QObject *parent = nullptr)
+			CollectionFilterModel (const LocalCollection *collection, QObject *parent = nullptr)
 			: QSortFilterProxyModel { parent }
+			, Collection_ { collection }
 			{
 				setDynamicSortFilter (true);
 			}
@@ -67,6 +69,37 @@ namespace LMP
 				if (source.data (LocalCollectionModel::Role::IsTrackIgnored).toBool ())
 					return false;
 
+				const auto& pattern = filterRegExp ().pattern ();
+
+				// The local collection populates its albums and tracks
+				// lazily, so the filter asks the storage for the matches
+				// instead of walking the (mostly empty) tree.
+				const auto& artistId = source.data (LocalCollectionModel::Role::ArtistID);
+				if (pattern.isEmpty () || !artistId.isValid ())
+					return AcceptsRecursively (source, pattern);
+
+				const auto& matches = Collection_->MatchFilter (pattern);
+				if (matches.Artists_.contains (artistId.toInt ()))
+					return true;
+
+				const auto albumId = source.data (LocalCollectionModel::Role::AlbumID).toInt ();
+				switch (source.data (LocalCollectionModel::Role::Node).toInt ())
+				{
+				case LocalCollectionModel::NodeType::Artist:
+					return matches.ArtistsWithMatches_.contains (artistId.toInt ());
+				case LocalCollectionModel::NodeType::Album:
+					return matches.Albums_.contains (albumId) ||
+							matches.AlbumsWithMatches_.contains (albumId);
+				case LocalCollectionModel::NodeType::Track:
+					return matches.Albums_.contains (albumId) ||
+							matches.Tracks_.contains (source.data (LocalCollectionModel::Role::TrackID).toInt ());
+				}
+
+				return false;
+			}
+		private:
+			bool AcceptsRecursively (const QModelIndex& source, const QString& pattern) const
+			{
 				const auto type = source.data (LocalCollectionModel::Role::Node).toInt ();
 				const bool isTrack = type == LocalCollectionModel::NodeType::Track;
 				const auto childrenCount = sourceModel ()->rowCount (source);
@@ -75,8 +108,6 @@ namespace LMP
 						if (filterAcceptsRow (i, source))
 							return true;
 
-				const auto& pattern = filterRegExp ().pattern ();
-
 				if (pattern.isEmpty () && !isTrack && childrenCount)
 					return false;
 
@@ -96,7 +127,7 @@ namespace LMP
 	CollectionWidget::CollectionWidget (QWidget *parent)
 	: QWidget { parent }
 	, Player_ { Core::Instance ().GetPlayer () }
-	, CollectionFilterModel_ { new CollectionFilterModel { this } }
+	, CollectionFilterModel_ { new CollectionFilterModel { Core::Instance ().GetLocalCollection (), this } }
 	{
 		Ui_.setupUi (this);
 
@@ -111,6 +142,10 @@ namespace LMP
 				SIGNAL (scanProgressChanged (int)),
 				this,
 				SLOT (handleScanProgress (int)));
+		connect (Core::Instance ().GetLocalCollection (),
+				SIGNAL (scanStatsChanged (int, qint64)),
+				this,
+				SLOT (handleScanStats (int, qint64)));
 		connect (Core::Instance ().GetLocalCollection (),
 				SIGNAL (scanFinished ()),
 				Ui_.ScanProgress_,
@@ -178,7 +213,7 @@ namespace LMP
 	namespace
 	{
 		template<typename T>
-		QList<T> CollectFromModel (const QModelIndex& root, int role)
+		QList<T> CollectFromModel (QAbstractItemModel *model, const QModelIndex& root, int role)
 		{
 			QList<T> result;
 
@@ -186,9 +221,11 @@ namespace LMP
 			if (!var.isNull ())
 				result << var.value<T> ();
 
-			auto model = root.model ();
+			if (model->canFetchMore (root))
+				model->fetchMore (root);
+
 			for (int i = 0; i < model->rowCount (root); ++i)
-				result += CollectFromModel<T> (root.child (i, 0), role);
+				result += CollectFromModel<T> (model, model->index (i, 0, root), role);
 
 			return result;
 		}
@@ -197,7 +234,8 @@ namespace LMP
 	void CollectionWidget::handleCollectionRemove ()
 	{
 		const auto& index = Ui_.CollectionTree_->currentIndex ();
-		const auto& paths = CollectFromModel<QString> (index, LocalCollectionModel::Role::TrackPath);
+		const auto& paths = CollectFromModel<QString> (Ui_.CollectionTree_->model (),
+				index, LocalCollectionModel::Role::TrackPath);
 		if (paths.isEmpty ())
 			return;
 
@@ -209,7 +247,8 @@ namespace LMP
 	void CollectionWidget::handleCollectionDelete ()
 	{
 		const auto& index = Ui_.CollectionTree_->currentIndex ();
-		const auto& paths = CollectFromModel<QString> (index, LocalCollectionModel::Role::TrackPath);
+		const auto& paths = CollectFromModel<QString> (Ui_.CollectionTree_->model (),
+				index, LocalCollectionModel::Role::TrackPath);
 		if (paths.isEmpty ())
 			return;
 
@@ -330,5 +369,16 @@ namespace LMP
 			Ui_.ScanProgress_->show ();
 		Ui_.ScanProgress_->setValue (progress);
 	}
+
+	void CollectionWidget::handleScanStats (int filesPerSecond, qint64 bytesRead)
+	{
+		const auto& rate = tr ("%n file(s)/s", 0, filesPerSecond);
+		Ui_.ScanProgress_->setFormat (bytesRead ?
+				tr ("%p% (%1, %2 read)")
+					.arg (rate)
+					.arg (Util::MakePrettySize (bytesRead)) :
+				tr ("%p% (%1)")
+					.arg (rate));
+	}
 }
 }
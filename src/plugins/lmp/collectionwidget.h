@@ -65,6 +65,7 @@ namespace LMP
 		void on_CollectionTree__customContextMenuRequested (const QPoint&);
 
 		void handleScanProgress (int);
+		void handleScanStats (int, qint64);
 	signals:
 		void hookCollectionContextMenuRequested (LeechCraft::IHookProxy_ptr,
 				QMenu*,
@@ -95,6 +95,7 @@ namespace LMP
 		M_->ProgressManager_.AddSyncManager (&M_->SyncManager_);
 		M_->ProgressManager_.AddSyncManager (&M_->SyncUnmountableManager_);
 		M_->ProgressManager_.AddSyncManager (&M_->CloudUpMgr_);
+		M_->ProgressManager_.AddRgAnalysisManager (&M_->RgMgr_);
 
 		M_->CollectionsManager_.Add (M_->Collection_.GetCollectionModel ());
 	}
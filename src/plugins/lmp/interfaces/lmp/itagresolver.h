@@ -31,7 +31,7 @@
 
 #include <QtPlugin>
 
-class QMutex;
+class QReadWriteLock;
 
 namespace TagLib
 {
@@ -66,9 +66,15 @@ namespace LMP
 
 		virtual TagLib::FileRef GetFileRef (const QString&) const = 0;
 		virtual ResolveResult_t ResolveInfo (const QString&) = 0;
-		virtual QMutex& GetMutex () = 0;
+
+		/** @brief Returns the lock guarding TagLib access to files.
+		 *
+		 * The lock should be held for reading while reading tags and
+		 * for writing while modifying them.
+		 */
+		virtual QReadWriteLock& GetLock () = 0;
 	};
 }
 }
 
-Q_DECLARE_INTERFACE (LeechCraft::LMP::ITagResolver, "org.LeechCraft.LMP.ITagResolver/1.0")
+Q_DECLARE_INTERFACE (LeechCraft::LMP::ITagResolver, "org.LeechCraft.LMP.ITagResolver/2.0")
@@ -35,6 +35,7 @@
 #include <QtConcurrentMap>
 #include <QtConcurrentRun>
 #include <QTimer>
+#include <QFileInfo>
 #include <QtDebug>
 #include <util/sll/either.h>
 #include <util/xpc/util.h>
@@ -42,6 +43,7 @@
 #include <util/sll/delayedexecutor.h>
 #include <util/threads/futures.h>
 #include "localcollectionstorage.h"
+#include "collectionscan.h"
 #include "core.h"
 #include "util.h"
 #include "localfileresolver.h"
@@ -55,10 +57,18 @@ namespace LeechCraft
 {
 namespace LMP
 {
+	namespace
+	{
+		const int ScanBatchSize = 1000;
+	}
+
 	LocalCollection::LocalCollection (QObject *parent)
 	: QObject (parent)
 	, Storage_ (new LocalCollectionStorage (this))
-	, CollectionModel_ (new LocalCollectionModel (Storage_, this))
+	, CollectionModel_ (new LocalCollectionModel ([this] (int id) { return GetArtist (id).Albums_; },
+			[this] (int id) { return GetAlbumTracks (id); },
+			[this] (int id) { return Storage_->GetTrackStats (id); },
+			this))
 	, FilesWatcher_ (new LocalCollectionWatcher (this))
 	, AlbumArtMgr_ (new AlbumArtManager (this))
 	, Watcher_ (new QFutureWatcher<MediaInfo> (this))
@@ -67,16 +77,20 @@ namespace LMP
 				SIGNAL (finished ()),
 				this,
 				SLOT (handleScanFinished ()));
+		connect (Watcher_,
+				SIGNAL (resultsReadyAt (int, int)),
+				this,
+				SLOT (handleScanResults (int, int)));
 		connect (Watcher_,
 				SIGNAL (progressValueChanged (int)),
 				this,
-				SIGNAL (scanProgressChanged (int)));
+				SLOT (handleScanProgress (int)));
 
 		Util::Sequence (this, QtConcurrent::run ([] { return LocalCollectionStorage ().Load (); })) >>
 				[this] (const LocalCollectionStorage::LoadResult& result)
 				{
 					Storage_->Load (result);
-					HandleNewArtists (result.Artists_, result.IgnoredTracks_);
+					HandleLoaded (result);
 
 					IsReady_ = true;
 					emit collectionReady ();
@@ -116,7 +130,49 @@ namespace LMP
 
 	QVariant LocalCollection::GetTrackData (int trackId, LocalCollectionModel::Role role) const
 	{
-		return CollectionModel_->GetTrackData (trackId, role);
+		const auto& album = GetTrackAlbum (trackId);
+		if (!album)
+			return {};
+
+		const auto pos = std::find_if (album->Tracks_.begin (), album->Tracks_.end (),
+				[trackId] (const auto& track) { return track.ID_ == trackId; });
+		if (pos == album->Tracks_.end ())
+			return {};
+
+		const auto& track = *pos;
+		switch (role)
+		{
+		case LocalCollectionModel::Role::Node:
+			return LocalCollectionModel::NodeType::Track;
+		case LocalCollectionModel::Role::ArtistName:
+			return GetArtist (AlbumID2ArtistID_.value (album->ID_)).Name_;
+		case LocalCollectionModel::Role::ArtistID:
+			return AlbumID2ArtistID_.value (album->ID_);
+		case LocalCollectionModel::Role::AlbumYear:
+			return album->Year_;
+		case LocalCollectionModel::Role::AlbumName:
+			return album->Name_;
+		case LocalCollectionModel::Role::AlbumArt:
+			return album->CoverPath_.isEmpty () ? QVariant {} : album->CoverPath_;
+		case LocalCollectionModel::Role::AlbumID:
+			return album->ID_;
+		case LocalCollectionModel::Role::TrackID:
+			return track.ID_;
+		case LocalCollectionModel::Role::TrackNumber:
+			return track.Number_;
+		case LocalCollectionModel::Role::TrackTitle:
+			return track.Name_;
+		case LocalCollectionModel::Role::TrackPath:
+			return track.FilePath_;
+		case LocalCollectionModel::Role::TrackGenres:
+			return track.Genres_;
+		case LocalCollectionModel::Role::TrackLength:
+			return track.Length_;
+		case LocalCollectionModel::Role::IsTrackIgnored:
+			return IgnoredTracks_.contains (trackId);
+		}
+
+		return {};
 	}
 
 	void LocalCollection::Clear ()
@@ -132,17 +188,12 @@ namespace LMP
 		Track2Album_.clear ();
 		AlbumID2Album_.clear ();
 		AlbumID2ArtistID_.clear ();
+		LoadedAlbums_.clear ();
 
-		RemoveRootPaths (RootPaths_);
-	}
+		IgnoredTracks_.clear ();
+		HasMatches_ = false;
 
-	namespace
-	{
-		struct IterateResult
-		{
-			QSet<QString> UnchangedFiles_;
-			QSet<QString> ChangedFiles_;
-		};
+		RemoveRootPaths (RootPaths_);
 	}
 
 	void LocalCollection::Scan (const QString& path, bool root)
@@ -154,57 +205,50 @@ namespace LMP
 				.property ("FollowSymLinks").toBool ();
 		auto worker = [path, symLinks]
 		{
-			IterateResult result;
-
 			LocalCollectionStorage storage;
 
-			const auto& paths = storage.GetTracksPaths ();
-
-			const auto& allInfos = RecIterateInfo (path, symLinks);
-			for (const auto& info : allInfos)
+			LocalCollectionStorage::FileStamps_t snapshot;
+			try
 			{
-				const auto& trackPath = info.absoluteFilePath ();
-				const auto& mtime = info.lastModified ();
-				try
-				{
-					const auto& storedDt = storage.GetMTime (trackPath);
-					if (storedDt.isValid () &&
-							std::abs (storedDt.msecsTo (mtime)) < 1500)
-					{
-						result.UnchangedFiles_ << trackPath;
-						continue;
-					}
-				}
-				catch (const std::exception& e)
-				{
-					qWarning () << Q_FUNC_INFO
-							<< "error getting mtime"
-							<< trackPath
-							<< e.what ();
-				}
+				snapshot = storage.GetFileStamps (path);
+			}
+			catch (const std::exception& e)
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "error getting file stamps for"
+						<< path
+						<< e.what ();
+			}
 
-				if (paths.contains (trackPath))
-				{
-					try
-					{
-						storage.SetMTime (trackPath, mtime);
-					}
-					catch (const std::exception& e)
-					{
-						qWarning () << Q_FUNC_INFO
-								<< "error setting mtime"
-								<< trackPath
-								<< e.what ();
-					}
-				}
-				result.ChangedFiles_ << trackPath;
+			auto result = DiffScan (RecIterateInfo (path, symLinks), snapshot);
+
+			QList<QPair<QString, LocalCollectionStorage::FileStamp>> unchangedStamps;
+			for (const auto& pair : result.StampsToWrite_)
+				if (!result.ChangedFiles_.contains (pair.first))
+					unchangedStamps << pair;
+
+			try
+			{
+				storage.SetFileStamps (unchangedStamps);
+			}
+			catch (const std::exception& e)
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "error writing"
+						<< unchangedStamps.size ()
+						<< "file stamps"
+						<< e.what ();
 			}
 
 			return result;
 		};
 		Util::Sequence (this, QtConcurrent::run (worker)) >>
-				[this, path] (const IterateResult& result)
+				[this, path] (const ScanDiff& result)
 				{
+					for (const auto& pair : result.StampsToWrite_)
+						if (result.ChangedFiles_.contains (pair.first))
+							PendingStamps_ [pair.first] = pair.second;
+
 					CheckRemovedFiles (result.ChangedFiles_ + result.UnchangedFiles_, path);
 
 					if (Watcher_->isRunning ())
@@ -249,6 +293,47 @@ namespace LMP
 			Scan (path, true);
 	}
 
+	void LocalCollection::UpdateFiles (const QSet<QString>& changed, const QSet<QString>& removed)
+	{
+		QStringList toRemove;
+		for (const auto& path : removed)
+		{
+			if (PresentPaths_.contains (path))
+			{
+				toRemove << path;
+				continue;
+			}
+
+			const auto& prefix = path + '/';
+			for (const auto& present : PresentPaths_)
+				if (present.startsWith (prefix))
+					toRemove << present;
+		}
+
+		for (const auto& path : toRemove)
+			RemoveTrack (path);
+
+		QSet<QString> toResolve;
+		for (const auto& path : changed)
+		{
+			const QFileInfo info { path };
+			if (!info.isFile ())
+				continue;
+
+			toResolve << path;
+			if (PresentPaths_.contains (path))
+				PendingStamps_ [path] = { info.lastModified ().toMSecsSinceEpoch (), info.size () };
+		}
+
+		if (toResolve.isEmpty ())
+			return;
+
+		if (Watcher_->isRunning ())
+			NewPathsQueue_ << toResolve;
+		else
+			InitiateScan (toResolve);
+	}
+
 	LocalCollection::DirStatus LocalCollection::GetDirStatus (const QString& dir) const
 	{
 		if (RootPaths_.contains (dir))
@@ -315,7 +400,9 @@ namespace LMP
 
 	Collection::Album_ptr LocalCollection::GetAlbum (int albumId) const
 	{
-		return AlbumID2Album_ [albumId];
+		const auto& album = AlbumID2Album_.value (albumId);
+		EnsureTracks (album);
+		return album;
 	}
 
 	int LocalCollection::FindTrack (const QString& path) const
@@ -330,7 +417,7 @@ namespace LMP
 
 	Collection::Album_ptr LocalCollection::GetTrackAlbum (int trackId) const
 	{
-		return AlbumID2Album_ [Track2Album_ [trackId]];
+		return GetAlbum (Track2Album_.value (trackId, -1));
 	}
 
 	QList<int> LocalCollection::GetDynamicPlaylist (DynamicPlaylist type) const
@@ -420,9 +507,155 @@ namespace LMP
 
 	Collection::Artists_t LocalCollection::GetAllArtists () const
 	{
+		if (LoadedAlbums_.size () < AlbumID2Album_.size ())
+		{
+			try
+			{
+				const auto& tracks = Storage_->GetAllAlbumsTracks ();
+				for (const auto& album : AlbumID2Album_)
+					if (!LoadedAlbums_.contains (album->ID_))
+					{
+						album->Tracks_ = tracks.value (album->ID_);
+						LoadedAlbums_ << album->ID_;
+					}
+			}
+			catch (const std::exception& e)
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "error loading the tracks:"
+						<< e.what ();
+			}
+		}
+
 		return Artists_;
 	}
 
+	const LocalCollection::FilterMatches& LocalCollection::MatchFilter (const QString& pattern) const
+	{
+		if (HasMatches_ && MatchesPattern_ == pattern)
+			return Matches_;
+
+		LocalCollectionStorage::FilterMatches direct;
+		try
+		{
+			direct = Storage_->FindMatching (pattern);
+		}
+		catch (const std::exception& e)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "error matching"
+					<< pattern
+					<< e.what ();
+		}
+
+		FilterMatches matches { direct.Artists_, direct.Albums_, direct.Tracks_, {}, {} };
+
+		for (const auto trackId : matches.Tracks_)
+		{
+			const auto albumId = Track2Album_.value (trackId, -1);
+			if (albumId != -1)
+				matches.AlbumsWithMatches_ << albumId;
+		}
+
+		for (const auto& artist : Artists_)
+			if (std::any_of (artist.Albums_.begin (), artist.Albums_.end (),
+					[&matches] (const auto& album)
+					{
+						return matches.Albums_.contains (album->ID_) ||
+								matches.AlbumsWithMatches_.contains (album->ID_);
+					}))
+				matches.ArtistsWithMatches_ << artist.ID_;
+
+		MatchesPattern_ = pattern;
+		Matches_ = matches;
+		HasMatches_ = true;
+		return Matches_;
+	}
+
+	void LocalCollection::EnsureTracks (const Collection::Album_ptr& album) const
+	{
+		if (!album || LoadedAlbums_.contains (album->ID_))
+			return;
+
+		try
+		{
+			album->Tracks_ = Storage_->GetAlbumTracks (album->ID_);
+		}
+		catch (const std::exception& e)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "error loading the tracks of"
+					<< album->ID_
+					<< e.what ();
+			return;
+		}
+
+		LoadedAlbums_ << album->ID_;
+	}
+
+	QList<Collection::Track> LocalCollection::GetAlbumTracks (int albumId) const
+	{
+		// The model keeps the tracks it has fetched on its own, so there
+		// is no point in keeping them here as well.
+		const auto& album = AlbumID2Album_.value (albumId);
+		if (album && LoadedAlbums_.contains (albumId))
+			return album->Tracks_;
+
+		try
+		{
+			return Storage_->GetAlbumTracks (albumId);
+		}
+		catch (const std::exception& e)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "error loading the tracks of"
+					<< albumId
+					<< e.what ();
+			return {};
+		}
+	}
+
+	void LocalCollection::HandleLoaded (const LocalCollectionStorage::LoadResult& result)
+	{
+		Artists_ = result.Artists_;
+		PostprocessArtistsInfos (Artists_, [this] (const Collection::Album_ptr& album) { EnsureTracks (album); });
+
+		const auto autoFetchAA = XmlSettingsManager::Instance ().property ("AutoFetchAlbumArt").toBool ();
+		for (const auto& artist : Artists_)
+			for (const auto& album : artist.Albums_)
+			{
+				if (autoFetchAA)
+					AlbumArtMgr_->CheckAlbumArt (artist, album);
+
+				if (!AlbumID2Album_.contains (album->ID_))
+				{
+					AlbumID2Album_ [album->ID_] = album;
+					AlbumID2ArtistID_ [album->ID_] = artist.ID_;
+				}
+			}
+
+		for (const auto& track : result.Tracks_)
+		{
+			PresentPaths_ << track.Path_;
+			Path2Track_ [track.Path_] = track.ID_;
+			Track2Path_ [track.ID_] = track.Path_;
+			Track2Album_ [track.ID_] = track.AlbumID_;
+		}
+
+		// the tracks of the united split albums now belong to the first one
+		for (const auto albumId : LoadedAlbums_)
+			if (const auto& album = AlbumID2Album_.value (albumId))
+				for (const auto& track : album->Tracks_)
+					Track2Album_ [track.ID_] = albumId;
+
+		IgnoredTracks_ = result.IgnoredTracks_;
+		HasMatches_ = false;
+
+		CollectionModel_->AddArtists (Artists_);
+		for (const auto item : IgnoredTracks_)
+			CollectionModel_->IgnoreTrack (item);
+	}
+
 	void LocalCollection::HandleExistingInfos (const QList<MediaInfo>& infos)
 	{
 		for (const auto& info : infos)
@@ -599,7 +832,8 @@ namespace LMP
 			return true;
 		}
 
-		void UniteSplitAlbums (Collection::Artists_t& artists)
+		void UniteSplitAlbums (Collection::Artists_t& artists,
+				const std::function<void (Collection::Album_ptr)>& loadTracks)
 		{
 			QHash<QPair<int, QString>, QList<Collection::Album_ptr>> potentialSplitAlbums;
 
@@ -622,20 +856,28 @@ namespace LMP
 					<< "candidates:"
 					<< potentialSplitAlbums.keys ();
 			for (const auto& albumsSet : potentialSplitAlbums)
+			{
+				if (loadTracks)
+					for (const auto& album : albumsSet)
+						loadTracks (album);
+
 				UniteSplitTryMerge (artists, albumsSet);
+			}
 		}
 	}
 
-	void LocalCollection::PostprocessArtistsInfos (Collection::Artists_t& artists)
+	void LocalCollection::PostprocessArtistsInfos (Collection::Artists_t& artists,
+			const std::function<void (Collection::Album_ptr)>& loadTracks)
 	{
 		qDebug () << "postproc begin";
-		UniteSplitAlbums (artists);
+		UniteSplitAlbums (artists, loadTracks);
 		qDebug () << "postproc end";
 	}
 
-	void LocalCollection::HandleNewArtists (Collection::Artists_t artists, const QSet<int>& ignored)
+	void LocalCollection::HandleNewArtists (Collection::Artists_t artists)
 	{
 		PostprocessArtistsInfos (artists);
+		HasMatches_ = false;
 
 		int albumCount = 0;
 		int trackCount = 0;
@@ -676,10 +918,12 @@ namespace LMP
 				auto& presentAlbum = AlbumID2Album_ [album->ID_];
 				if (!presentAlbum)
 				{
+					// a new album, so all its tracks are already here
 					presentAlbum = album;
 					AlbumID2ArtistID_ [album->ID_] = artist.ID_;
+					LoadedAlbums_ << album->ID_;
 				}
-				else if (presentAlbum != album)
+				else if (presentAlbum != album && LoadedAlbums_.contains (album->ID_))
 					presentAlbum->Tracks_ << album->Tracks_;
 
 				for (const auto& track : album->Tracks_)
@@ -694,9 +938,6 @@ namespace LMP
 
 		CollectionModel_->AddArtists (artists);
 
-		for (const auto item : ignored)
-			CollectionModel_->IgnoreTrack (item);
-
 		if (shouldEmit &&
 				trackCount)
 		{
@@ -724,6 +965,7 @@ namespace LMP
 			throw;
 		}
 
+		IgnoredTracks_ << id;
 		CollectionModel_->IgnoreTrack (id);
 	}
 
@@ -752,6 +994,8 @@ namespace LMP
 		Track2Path_.remove (id);
 		Track2Album_.remove (id);
 		PresentPaths_.remove (path);
+		IgnoredTracks_.remove (id);
+		HasMatches_ = false;
 
 		if (!album)
 			return;
@@ -780,6 +1024,7 @@ namespace LMP
 
 		AlbumID2Album_.remove (id);
 		AlbumID2ArtistID_.remove (id);
+		LoadedAlbums_.remove (id);
 
 		CollectionModel_->RemoveAlbum (id);
 
@@ -870,10 +1115,17 @@ namespace LMP
 	{
 		auto resolver = Core::Instance ().GetLocalFileResolver ();
 
+		const auto style = XmlSettingsManager::Instance ().property ("FastCollectionScan").toBool () ?
+				TagLib::AudioProperties::Fast :
+				TagLib::AudioProperties::Accurate;
+
+		ScanTimer_.start ();
+		ScanStartBytes_ = resolver->GetBytesRead ();
+
 		emit scanStarted (newPaths.size ());
-		auto worker = [resolver] (const QString& path)
+		auto worker = [resolver, style] (const QString& path)
 		{
-			return resolver->ResolveInfo (path).ToRight ([] (const ResolveError& error)
+			return resolver->ResolveInfo (path, style).ToRight ([] (const ResolveError& error)
 					{
 						qWarning () << Q_FUNC_INFO
 								<< "error resolving media info for"
@@ -887,6 +1139,55 @@ namespace LMP
 		Watcher_->setFuture (future);
 	}
 
+	void LocalCollection::FlushPendingInfos ()
+	{
+		if (PendingInfos_.isEmpty ())
+			return;
+
+		QList<MediaInfo> newInfos, existingInfos;
+		QList<QPair<QString, LocalCollectionStorage::FileStamp>> stamps;
+		for (const auto& info : PendingInfos_)
+		{
+			const auto& path = info.LocalPath_;
+			if (path.isEmpty ())
+				continue;
+
+			const auto stampPos = PendingStamps_.find (path);
+			if (stampPos != PendingStamps_.end ())
+			{
+				stamps.append ({ path, *stampPos });
+				PendingStamps_.erase (stampPos);
+			}
+
+			if (PresentPaths_.contains (path))
+				existingInfos << info;
+			else
+			{
+				newInfos << info;
+				PresentPaths_ += path;
+			}
+		}
+		PendingInfos_.clear ();
+
+		auto newArts = Storage_->AddToCollection (newInfos);
+		HandleNewArtists (newArts);
+
+		HandleExistingInfos (existingInfos);
+
+		try
+		{
+			Storage_->SetFileStamps (stamps);
+		}
+		catch (const std::exception& e)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "error writing"
+					<< stamps.size ()
+					<< "file stamps"
+					<< e.what ();
+		}
+	}
+
 	void LocalCollection::RecordPlayedTrack (const QString& path)
 	{
 		if (Path2Track_.contains (path))
@@ -914,33 +1215,49 @@ namespace LMP
 			Scan (rootPath, true);
 	}
 
-	void LocalCollection::handleScanFinished ()
+	void LocalCollection::handleScanResults (int begin, int end)
 	{
-		auto future = Watcher_->future ();
-		QList<MediaInfo> newInfos, existingInfos;
-		for (const auto& info : future)
-		{
-			const auto& path = info.LocalPath_;
-			if (path.isEmpty ())
-				continue;
+		for (int i = begin; i < end; ++i)
+			PendingInfos_ << Watcher_->resultAt (i);
 
-			if (PresentPaths_.contains (path))
-				existingInfos << info;
-			else
-			{
-				newInfos << info;
-				PresentPaths_ += path;
-			}
-		}
+		if (PendingInfos_.size () >= ScanBatchSize)
+			FlushPendingInfos ();
+	}
 
+	void LocalCollection::handleScanProgress (int progress)
+	{
+		emit scanProgressChanged (progress);
+
+		const auto elapsed = std::max<qint64> (ScanTimer_.elapsed (), 1);
+		const auto bytesRead = Core::Instance ().GetLocalFileResolver ()->GetBytesRead () - ScanStartBytes_;
+		emit scanStatsChanged (progress * 1000 / elapsed, bytesRead);
+	}
+
+	void LocalCollection::handleScanFinished ()
+	{
 		emit scanFinished ();
 
-		auto newArts = Storage_->AddToCollection (newInfos);
-		HandleNewArtists (newArts);
+		FlushPendingInfos ();
+
+		qDebug () << Q_FUNC_INFO
+				<< "scanned"
+				<< Watcher_->progressMaximum ()
+				<< "files in"
+				<< ScanTimer_.elapsed ()
+				<< "ms, TagLib has read"
+				<< Core::Instance ().GetLocalFileResolver ()->GetBytesRead () - ScanStartBytes_
+				<< "bytes";
 
 		if (!NewPathsQueue_.isEmpty ())
+		{
 			InitiateScan (NewPathsQueue_.takeFirst ());
-		else if (UpdateNewTracks_)
+			return;
+		}
+
+		// whatever is left belongs to files that failed to resolve
+		PendingStamps_.clear ();
+
+		if (UpdateNewTracks_)
 		{
 			const auto& artistsMsg = tr ("%n new artist(s)", 0, UpdateNewArtists_);
 			const auto& albumsMsg = tr ("%n new album(s)", 0, UpdateNewAlbums_);
@@ -953,8 +1270,6 @@ namespace LMP
 
 			UpdateNewArtists_ = UpdateNewAlbums_ = UpdateNewTracks_ = 0;
 		}
-
-		HandleExistingInfos (existingInfos);
 	}
 
 	void LocalCollection::saveRootPaths ()
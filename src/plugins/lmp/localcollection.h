@@ -29,15 +29,18 @@
 
 #pragma once
 
+#include <functional>
 #include <QObject>
 #include <QHash>
 #include <QSet>
 #include <QFutureWatcher>
+#include <QElapsedTimer>
 #include <QIcon>
 #include "interfaces/lmp/collectiontypes.h"
 #include "interfaces/lmp/ilocalcollection.h"
 #include "mediainfo.h"
 #include "localcollectionmodel.h"
+#include "localcollectionstorage.h"
 
 class QStandardItemModel;
 class QStandardItem;
@@ -81,12 +84,47 @@ namespace LMP
 		QHash<int, Collection::Album_ptr> AlbumID2Album_;
 		QHash<int, int> AlbumID2ArtistID_;
 
+		/* The albums whose Tracks_ are filled. The collection is loaded
+		 * without the tracks, and they are only read from the storage for
+		 * the albums that are actually asked for, see EnsureTracks().
+		 */
+		mutable QSet<int> LoadedAlbums_;
+
+		QSet<int> IgnoredTracks_;
+
 		QFutureWatcher<MediaInfo> *Watcher_;
 		QList<QSet<QString>> NewPathsQueue_;
+		QList<MediaInfo> PendingInfos_;
+
+		/* Stamps of changed tracks known to the collection, written only
+		 * after they are successfully resolved again.
+		 */
+		LocalCollectionStorage::FileStamps_t PendingStamps_;
+
+		QElapsedTimer ScanTimer_;
+		qint64 ScanStartBytes_ = 0;
 
 		int UpdateNewArtists_ = 0;
 		int UpdateNewAlbums_ = 0;
 		int UpdateNewTracks_ = 0;
+	public:
+		/** The IDs of the collection items matching a filter pattern.
+		 */
+		struct FilterMatches
+		{
+			// the items matching the pattern themselves
+			QSet<int> Artists_;
+			QSet<int> Albums_;
+			QSet<int> Tracks_;
+
+			// the items having matching items below them
+			QSet<int> ArtistsWithMatches_;
+			QSet<int> AlbumsWithMatches_;
+		};
+	private:
+		mutable QString MatchesPattern_;
+		mutable FilterMatches Matches_;
+		mutable bool HasMatches_ = false;
 	public:
 		enum class DynamicPlaylist
 		{
@@ -124,6 +162,13 @@ namespace LMP
 		void Unscan (const QString&);
 		void Rescan ();
 
+		/** Re-resolves the changed tracks and drops the removed ones.
+		 *
+		 * Each removed path may be either a track or a directory, in
+		 * which case all the tracks below it are dropped.
+		 */
+		void UpdateFiles (const QSet<QString>& changed, const QSet<QString>& removed);
+
 		DirStatus GetDirStatus (const QString&) const;
 		QStringList GetDirs () const;
 
@@ -146,16 +191,34 @@ namespace LMP
 
 		QList<int> GetAlbumArtists (int) const;
 		Collection::Artist GetArtist (int) const;
+		/** Returns all the artists with all their albums and tracks.
+		 *
+		 * This loads the tracks of the whole collection, so it should
+		 * only be used when all of them are really needed.
+		 */
 		Collection::Artists_t GetAllArtists () const override;
 
+		/** Returns the artists, albums and tracks matching the given
+		 * pattern along with the ones having matching items below.
+		 *
+		 * The matches are looked up in the storage and cached until the
+		 * pattern or the collection changes.
+		 */
+		const FilterMatches& MatchFilter (const QString& pattern) const;
+
 		void IgnoreTrack (const QString&);
 		void RemoveTrack (const QString&);
 		void RecordPlayedTrack (const QString&);
 		void RecordPlayedTrack (int, const QDateTime&) override;
 	private:
+		void EnsureTracks (const Collection::Album_ptr&) const;
+		QList<Collection::Track> GetAlbumTracks (int) const;
+
+		void HandleLoaded (const LocalCollectionStorage::LoadResult&);
 		void HandleExistingInfos (const QList<MediaInfo>&);
-		void PostprocessArtistsInfos (Collection::Artists_t&);
-		void HandleNewArtists (Collection::Artists_t, const QSet<int>& = {});
+		void PostprocessArtistsInfos (Collection::Artists_t&,
+				const std::function<void (Collection::Album_ptr)>& loadTracks = {});
+		void HandleNewArtists (Collection::Artists_t);
 		void RemoveAlbum (int);
 		Collection::Artists_t::iterator RemoveArtist (Collection::Artists_t::iterator);
 
@@ -165,13 +228,17 @@ namespace LMP
 		void CheckRemovedFiles (const QSet<QString>& scanned, const QString& root);
 
 		void InitiateScan (const QSet<QString>&);
+		void FlushPendingInfos ();
 		void RescanOnLoad ();
 	private slots:
+		void handleScanResults (int, int);
+		void handleScanProgress (int);
 		void handleScanFinished ();
 		void saveRootPaths ();
 	signals:
 		void scanStarted (int);
 		void scanProgressChanged (int);
+		void scanStatsChanged (int filesPerSecond, qint64 bytesRead);
 		void scanFinished ();
 
 		void collectionReady ();
@@ -31,56 +31,128 @@
 #include <numeric>
 #include <QUrl>
 #include <QMimeData>
-#include <interfaces/core/iiconthememanager.h>
 #include <util/sll/prelude.h>
-#include <util/sll/unreachable.h>
-#include "core.h"
-#include "localcollection.h"
-#include "localcollectionstorage.h"
-#include "util.h"
+#include <util/lmp/util.h>
 
 namespace LeechCraft
 {
 namespace LMP
 {
-	LocalCollectionModel::LocalCollectionModel (LocalCollectionStorage *storage, QObject *parent)
-	: DndActionsMixin<QStandardItemModel> { parent }
-	, Storage_ { storage }
+	LocalCollectionModel::LocalCollectionModel (const ArtistAlbumsGetter_f& getAlbums,
+			const AlbumTracksGetter_f& getTracks,
+			const TrackStatsGetter_f& getStats,
+			QObject *parent)
+	: DndActionsMixin<QAbstractItemModel> { parent }
+	, GetArtistAlbums_ { getAlbums }
+	, GetAlbumTracks_ { getTracks }
+	, GetTrackStats_ { getStats }
 	{
 		setSupportedDragActions (Qt::CopyAction);
 	}
 
+	QModelIndex LocalCollectionModel::index (int row, int column, const QModelIndex& parent) const
+	{
+		if (!hasIndex (row, column, parent))
+			return {};
+
+		const auto& children = ChildrenOf (parent.isValid () ? static_cast<int> (parent.internalId ()) : -1);
+		return createIndex (row, column, static_cast<quintptr> (children.at (row)));
+	}
+
+	QModelIndex LocalCollectionModel::parent (const QModelIndex& index) const
+	{
+		if (!index.isValid ())
+			return {};
+
+		return NodeIndex (Nodes_.at (static_cast<int> (index.internalId ())).Parent_);
+	}
+
+	int LocalCollectionModel::rowCount (const QModelIndex& parent) const
+	{
+		if (parent.column () > 0)
+			return 0;
+
+		return ChildrenOf (parent.isValid () ? static_cast<int> (parent.internalId ()) : -1).size ();
+	}
+
+	int LocalCollectionModel::columnCount (const QModelIndex&) const
+	{
+		return 1;
+	}
+
+	bool LocalCollectionModel::hasChildren (const QModelIndex& parent) const
+	{
+		if (!parent.isValid ())
+			return !Roots_.isEmpty ();
+
+		if (parent.column () > 0)
+			return false;
+
+		const auto& node = Nodes_.at (static_cast<int> (parent.internalId ()));
+		if (node.Type_ == NodeType::Track)
+			return false;
+
+		return !node.IsFetched_ || !node.Children_.isEmpty ();
+	}
+
+	bool LocalCollectionModel::canFetchMore (const QModelIndex& parent) const
+	{
+		if (!parent.isValid () || parent.column () > 0)
+			return false;
+
+		const auto& node = Nodes_.at (static_cast<int> (parent.internalId ()));
+		return node.Type_ != NodeType::Track && !node.IsFetched_;
+	}
+
+	void LocalCollectionModel::fetchMore (const QModelIndex& parent)
+	{
+		if (canFetchMore (parent))
+			FetchChildren (static_cast<int> (parent.internalId ()));
+	}
+
+	Qt::ItemFlags LocalCollectionModel::flags (const QModelIndex& index) const
+	{
+		if (!index.isValid ())
+			return Qt::NoItemFlags;
+
+		return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsDragEnabled;
+	}
+
 	QStringList LocalCollectionModel::mimeTypes () const
 	{
 		return { "text/uri-list" };
 	}
 
-	namespace
+	QStringList LocalCollectionModel::CollectPaths (int nodeIdx) const
 	{
-		template<typename T, LocalCollectionModel::Role Role>
-		QList<T> CollectTrackValues (const QModelIndex& index, const QAbstractItemModel *model)
+		const auto& node = Nodes_.at (nodeIdx);
+		if (node.Type_ == NodeType::Track)
+			return { node.Path_ };
+
+		if (!node.IsFetched_)
 		{
-			const auto type = index.data (LocalCollectionModel::Role::Node).toInt ();
-			if (type == LocalCollectionModel::NodeType::Track)
-				return { index.data (Role).value<T> () };
+			const auto& albums = node.Type_ == NodeType::Album ?
+					QList<int> { node.ID_ } :
+					Util::Map (GetArtistAlbums_ (node.ID_), [] (const auto& album) { return album->ID_; });
 
-			QList<T> result;
-			for (int i = 0; i < model->rowCount (index); ++i)
-				result += CollectTrackValues<T, Role> (model->index (i, 0, index), model);
+			QStringList result;
+			for (const auto albumId : albums)
+				result += Util::Map (GetAlbumTracks_ (albumId), &Collection::Track::FilePath_);
 			return result;
 		}
 
-		QStringList CollectPaths (const QModelIndex& index, const QAbstractItemModel *model)
-		{
-			return CollectTrackValues<QString, LocalCollectionModel::Role::TrackPath> (index, model);
-		}
+		QStringList result;
+		for (const auto child : node.Children_)
+			result += CollectPaths (child);
+		return result;
 	}
 
 	QMimeData* LocalCollectionModel::mimeData (const QModelIndexList& indexes) const
 	{
 		QList<QUrl> urls;
 		for (const auto& index : indexes)
-			urls += Util::Map (CollectPaths (index, this), &QUrl::fromLocalFile);
+			if (index.isValid ())
+				urls += Util::Map (CollectPaths (static_cast<int> (index.internalId ())), &QUrl::fromLocalFile);
 
 		if (urls.isEmpty ())
 			return nullptr;
@@ -90,87 +162,174 @@ namespace LMP
 		return result;
 	}
 
-	namespace
+	struct LocalCollectionModel::TooltipState
 	{
-		struct RefreshTooltipState
-		{
-			Collection::TrackStats LastStats_;
-			QString VisibleName_;
-		};
+		Collection::TrackStats LastStats_;
+		QString VisibleName_;
+	};
 
-		QString GetVisibleName (int type, QStandardItem *item)
+	LocalCollectionModel::TooltipState LocalCollectionModel::RefreshTooltip (int nodeIdx) const
+	{
+		const auto& node = Nodes_.at (nodeIdx);
+		if (node.Type_ == NodeType::Track)
 		{
-			switch (type)
+			const auto& stats = GetTrackStats_ (node.ID_);
+
+			if (stats)
 			{
-			case LocalCollectionModel::NodeType::Track:
-				return item->data (LocalCollectionModel::Role::TrackTitle).toString ();
-			case LocalCollectionModel::NodeType::Album:
-				return item->data (LocalCollectionModel::Role::AlbumName).toString ();
-			case LocalCollectionModel::NodeType::Artist:
-				return item->data (LocalCollectionModel::Role::ArtistName).toString ();
+				const auto& last = tr ("Last playback: %1")
+						.arg (FormatDateTime (stats.LastPlay_));
+				const auto& total = tr ("Played %n time(s) since %1", 0, stats.Playcount_)
+						.arg (FormatDateTime (stats.Added_));
+				Tooltips_ [nodeIdx] = last + "\n" + total;
 			}
+			else
+				Tooltips_ [nodeIdx] = tr ("Never has been played");
 
-			Util::Unreachable ();
+			return { stats, node.Name_ };
 		}
 
-		RefreshTooltipState RefreshTooltip (QStandardItem *item, LocalCollectionStorage *storage)
+		TooltipState latest;
+		auto consider = [&latest] (const TooltipState& candidate)
 		{
-			const auto type = item->data (LocalCollectionModel::Role::Node).toInt ();
-			if (type == LocalCollectionModel::NodeType::Track)
-			{
-				const auto trackId = item->data (LocalCollectionModel::Role::TrackID).toInt ();
-				const auto& stats = storage->GetTrackStats (trackId);
-
-				if (stats)
-				{
-					const auto& last = LocalCollectionModel::tr ("Last playback: %1")
-							.arg (FormatDateTime (stats.LastPlay_));
-					const auto& total = LocalCollectionModel::tr ("Played %n time(s) since %1", 0, stats.Playcount_)
-							.arg (FormatDateTime (stats.Added_));
-					item->setToolTip (last + "\n" + total);
-				}
-				else
-					item->setToolTip (LocalCollectionModel::tr ("Never has been played"));
+			latest = std::max (candidate, latest,
+					Util::ComparingBy ([] (const auto& state) { return state.LastStats_.LastPlay_; }));
+		};
 
-				return { stats, GetVisibleName (type, item) };
-			}
+		if (node.IsFetched_)
+			for (const auto child : node.Children_)
+				consider (RefreshTooltip (child));
+		else if (node.Type_ == NodeType::Album)
+			for (const auto& track : GetAlbumTracks_ (node.ID_))
+				consider ({ GetTrackStats_ (track.ID_), track.Name_ });
+		else
+			for (const auto& album : GetArtistAlbums_ (node.ID_))
+				consider ({ GetLatestAlbumStats (album->ID_), album->Name_ });
+
+		if (!latest.LastStats_)
+		{
+			Tooltips_ [nodeIdx] = tr ("Never has been played");
+			return {};
+		}
 
-			RefreshTooltipState latest;
-			for (int i = 0; i < item->rowCount (); ++i)
-				latest = std::max (RefreshTooltip (item->child (i), storage), latest,
-						Util::ComparingBy ([] (const auto& state) { return state.LastStats_.LastPlay_; }));
-			if (!latest.LastStats_)
-			{
-				item->setToolTip (LocalCollectionModel::tr ("Never has been played"));
-				return {};
-			}
+		Tooltips_ [nodeIdx] = tr ("Last playback: %1 (%2)")
+				.arg (FormatDateTime (latest.LastStats_.LastPlay_))
+				.arg ("<em>" + latest.VisibleName_ + "</em>");
 
-			const auto& lastStr = LocalCollectionModel::tr ("Last playback: %1 (%2)")
-					.arg (FormatDateTime (latest.LastStats_.LastPlay_))
-					.arg ("<em>" + latest.VisibleName_ + "</em>");
-			item->setToolTip (lastStr);
+		return { latest.LastStats_, node.Name_ };
+	}
 
-			return { latest.LastStats_, GetVisibleName (type, item) };
+	Collection::TrackStats LocalCollectionModel::GetLatestAlbumStats (int albumId) const
+	{
+		Collection::TrackStats latest;
+		for (const auto& track : GetAlbumTracks_ (albumId))
+		{
+			const auto& stats = GetTrackStats_ (track.ID_);
+			if (stats && (!latest || stats.LastPlay_ > latest.LastPlay_))
+				latest = stats;
 		}
+		return latest;
 	}
 
 	QVariant LocalCollectionModel::data (const QModelIndex& index, int role) const
 	{
-		if (role == Qt::ToolTipRole)
+		if (!index.isValid ())
+			return {};
+
+		return NodeData (static_cast<int> (index.internalId ()), role);
+	}
+
+	QVariant LocalCollectionModel::NodeData (int nodeIdx, int role) const
+	{
+		const auto& node = Nodes_.at (nodeIdx);
+
+		auto ancestor = [this, &node] (NodeType type) -> const TreeNode&
+		{
+			auto current = &node;
+			while (current->Type_ != type)
+				current = &Nodes_.at (current->Parent_);
+			return *current;
+		};
+
+		switch (role)
+		{
+		case Qt::DisplayRole:
+			switch (node.Type_)
+			{
+			case NodeType::Artist:
+				return node.Name_;
+			case NodeType::Album:
+			case NodeType::Track:
+				return QString::fromUtf8 ("%1 — %2")
+						.arg (node.Number_)
+						.arg (node.Name_);
+			}
+			break;
+		case Qt::DecorationRole:
+			if (node.Type_ == NodeType::Artist)
+				return ArtistIcon_;
+			break;
+		case Qt::ToolTipRole:
+			if (!Tooltips_.contains (nodeIdx))
+				RefreshTooltip (nodeIdx);
+			return Tooltips_.value (nodeIdx);
+		case Role::Node:
+			return node.Type_;
+		case Role::ArtistName:
+			return ancestor (NodeType::Artist).Name_;
+		case Role::ArtistID:
+			return ancestor (NodeType::Artist).ID_;
+		case Role::AlbumID:
+			if (node.Type_ != NodeType::Artist)
+				return ancestor (NodeType::Album).ID_;
+			break;
+		case Role::AlbumYear:
+			if (node.Type_ != NodeType::Artist)
+				return ancestor (NodeType::Album).Number_;
+			break;
+		case Role::AlbumName:
+			if (node.Type_ != NodeType::Artist)
+				return ancestor (NodeType::Album).Name_;
+			break;
+		case Role::AlbumArt:
+			if (node.Type_ == NodeType::Album && !node.Path_.isEmpty ())
+				return node.Path_;
+			break;
+		}
+
+		if (node.Type_ != NodeType::Track)
+			return {};
+
+		switch (role)
 		{
-			const auto item = itemFromIndex (index);
-			if (item->data (role).isNull ())
-				RefreshTooltip (item, Storage_);
+		case Role::TrackID:
+			return node.ID_;
+		case Role::TrackNumber:
+			return node.Number_;
+		case Role::TrackTitle:
+			return node.Name_;
+		case Role::TrackPath:
+			return node.Path_;
+		case Role::TrackGenres:
+			return node.Genres_;
+		case Role::TrackLength:
+			return node.Length_;
+		case Role::IsTrackIgnored:
+			return node.IsIgnored_;
 		}
 
-		return QStandardItemModel::data (index, role);
+		return {};
 	}
 
 	QList<QUrl> LocalCollectionModel::ToSourceUrls (const QList<QModelIndex>& indexes) const
 	{
 		const auto& paths = std::accumulate (indexes.begin (), indexes.end (), QStringList {},
 				[this] (const QStringList& paths, const QModelIndex& item)
-					{ return paths + CollectPaths (item, this); });
+				{
+					return item.isValid () ?
+							paths + CollectPaths (static_cast<int> (item.internalId ())) :
+							paths;
+				});
 
 		QList<QUrl> result;
 		result.reserve (paths.size ());
@@ -179,140 +338,340 @@ namespace LMP
 		return result;
 	}
 
-	namespace
+	void LocalCollectionModel::AddArtists (const Collection::Artists_t& artists)
 	{
-		template<typename T, typename Init, typename Parent, typename Idx>
-		QStandardItem* GetItem (T& c, Init f, Parent parent, Idx idx)
+		// Building the initial tree row by row would emit a pair of
+		// signals per row, which is way slower than a single reset.
+		const bool reset = Roots_.isEmpty ();
+		if (reset)
 		{
-			auto& item = c [idx];
-			if (item)
-				return item;
-
-			item = new QStandardItem;
-			item->setEditable (false);
-			f (item);
-			parent->appendRow (item);
-			return item;
+			beginResetModel ();
+			IsBatchInsert_ = true;
 		}
 
-		template<typename T, typename Init, typename Parent, typename Idx, typename... Idxs>
-		QStandardItem* GetItem (T& c, Init f, Parent parent, Idx idx, Idxs... idxs)
-		{
-			return GetItem (c [idx], f, parent, idxs...);
-		}
-	}
-
-	void LocalCollectionModel::AddArtists (const Collection::Artists_t& artists)
-	{
 		for (const auto& artist : artists)
 		{
-			auto artistItem = GetItem (Artist2Item_,
-					[this, &artist] (QStandardItem *item)
-					{
-						item->setIcon (ArtistIcon_);
-						item->setText (artist.Name_);
-						item->setData (artist.Name_, Role::ArtistName);
-						item->setData (NodeType::Artist, Role::Node);
-					},
-					this,
-					artist.ID_);
-
-			for (auto album : artist.Albums_)
+			const auto artistNode = Artist2Node_.value (artist.ID_, -1);
+			if (artistNode == -1)
 			{
-				auto albumItem = GetItem (Album2Item_,
-						[album, artist] (QStandardItem *item)
-						{
-							item->setText (QString::fromUtf8 ("%1 — %2")
-									.arg (album->Year_)
-									.arg (album->Name_));
-							item->setData (album->Year_, Role::AlbumYear);
-							item->setData (album->Name_, Role::AlbumName);
-							item->setData (artist.Name_, Role::ArtistName);
-							item->setData (NodeType::Album, Role::Node);
-							if (!album->CoverPath_.isEmpty ())
-								item->setData (album->CoverPath_, Role::AlbumArt);
-						},
-						artistItem,
-						album->ID_,
-						artist.ID_);
+				TreeNode node;
+				node.Type_ = NodeType::Artist;
+				node.ID_ = artist.ID_;
+				node.Name_ = Intern (artist.Name_);
+				AppendChild (-1, std::move (node));
+				continue;
+			}
 
-				for (const auto& track : album->Tracks_)
+			// The albums and tracks below the not yet fetched nodes are
+			// queried as a whole when fetching them.
+			if (!Nodes_.at (artistNode).IsFetched_)
+				continue;
+
+			for (const auto& album : artist.Albums_)
+			{
+				const auto albumNode = Album2Nodes_.value (album->ID_).value (artist.ID_, -1);
+				if (albumNode == -1)
 				{
-					const QString& name = QString::fromUtf8 ("%1 — %2")
-							.arg (track.Number_)
-							.arg (track.Name_);
-					auto item = new QStandardItem (name);
-					item->setEditable (false);
-					item->setData (album->Year_, Role::AlbumYear);
-					item->setData (album->Name_, Role::AlbumName);
-					item->setData (artist.Name_, Role::ArtistName);
-					item->setData (track.ID_, Role::TrackID);
-					item->setData (track.Number_, Role::TrackNumber);
-					item->setData (track.Name_, Role::TrackTitle);
-					item->setData (track.FilePath_, Role::TrackPath);
-					item->setData (track.Genres_, Role::TrackGenres);
-					item->setData (track.Length_, Role::TrackLength);
-					item->setData (NodeType::Track, Role::Node);
-					albumItem->appendRow (item);
-
-					Track2Item_ [track.ID_] = item;
+					AppendChild (artistNode, MakeAlbumNode (*album));
+					continue;
 				}
+
+				if (!Nodes_.at (albumNode).IsFetched_)
+					continue;
+
+				for (const auto& track : album->Tracks_)
+					if (!Track2Node_.contains (track.ID_))
+						AppendChild (albumNode, MakeTrackNode (track));
 			}
 		}
+
+		if (reset)
+		{
+			IsBatchInsert_ = false;
+			endResetModel ();
+		}
 	}
 
 	void LocalCollectionModel::Clear ()
 	{
-		clear ();
+		beginResetModel ();
 
-		Artist2Item_.clear ();
-		Album2Item_.clear ();
-		Track2Item_.clear ();
+		Nodes_.clear ();
+		FreeNodes_.clear ();
+		Roots_.clear ();
+
+		StringsPool_.clear ();
+		GenresPool_.clear ();
+
+		Artist2Node_.clear ();
+		Album2Nodes_.clear ();
+		Track2Node_.clear ();
+
+		IgnoredTracks_.clear ();
+
+		Tooltips_.clear ();
+
+		endResetModel ();
 	}
 
 	void LocalCollectionModel::IgnoreTrack (int id)
 	{
-		auto item = Track2Item_.value (id);
-		item->setData (true, IsTrackIgnored);
+		IgnoredTracks_ << id;
+
+		const auto nodeIdx = Track2Node_.value (id, -1);
+		if (nodeIdx == -1)
+			return;
+
+		Nodes_ [nodeIdx].IsIgnored_ = true;
+
+		const auto& index = NodeIndex (nodeIdx);
+		emit dataChanged (index, index);
 	}
 
 	void LocalCollectionModel::RemoveTrack (int id)
 	{
-		auto item = Track2Item_.take (id);
-		item->parent ()->removeRow (item->row ());
+		const auto nodeIdx = Track2Node_.value (id, -1);
+		if (nodeIdx != -1)
+			RemoveNode (nodeIdx);
 	}
 
 	void LocalCollectionModel::RemoveAlbum (int id)
 	{
-		for (const auto item : Album2Item_.take (id))
-			item->parent ()->removeRow (item->row ());
-	}
-
-	QVariant LocalCollectionModel::GetTrackData (int trackId, LocalCollectionModel::Role role) const
-	{
-		const auto item = Track2Item_.value (trackId);
-		return item ? item->data (role) : QVariant ();
+		for (const auto nodeIdx : Album2Nodes_.value (id))
+			RemoveNode (nodeIdx);
 	}
 
 	void LocalCollectionModel::RemoveArtist (int id)
 	{
-		removeRow (Artist2Item_.take (id)->row ());
+		const auto nodeIdx = Artist2Node_.value (id, -1);
+		if (nodeIdx != -1)
+			RemoveNode (nodeIdx);
 	}
 
 	void LocalCollectionModel::SetAlbumArt (int id, const QString& path)
 	{
-		for (const auto item : Album2Item_.value (id))
-			item->setData (path, Role::AlbumArt);
+		for (const auto nodeIdx : Album2Nodes_.value (id))
+		{
+			Nodes_ [nodeIdx].Path_ = path;
+
+			const auto& index = NodeIndex (nodeIdx);
+			emit dataChanged (index, index);
+		}
 	}
 
 	void LocalCollectionModel::UpdatePlayStats (int trackId)
 	{
-		auto item = Track2Item_ [trackId];
+		const auto nodeIdx = Track2Node_.value (trackId, -1);
+		if (nodeIdx != -1)
+			ResetTooltips (nodeIdx);
+		else
+			// the tooltips of the not fetched albums and artists might
+			// still depend on this track
+			Tooltips_.clear ();
+	}
+
+	QString LocalCollectionModel::Intern (const QString& str)
+	{
+		const auto pos = StringsPool_.constFind (str);
+		if (pos != StringsPool_.constEnd ())
+			return *pos;
+
+		StringsPool_.insert (str);
+		return str;
+	}
+
+	QStringList LocalCollectionModel::Intern (const QStringList& list)
+	{
+		if (list.isEmpty ())
+			return {};
+
+		const auto pos = GenresPool_.constFind (list);
+		if (pos != GenresPool_.constEnd ())
+			return *pos;
+
+		GenresPool_ [list] = list;
+		return list;
+	}
+
+	QVector<int>& LocalCollectionModel::ChildrenOf (int nodeIdx)
+	{
+		return nodeIdx == -1 ? Roots_ : Nodes_ [nodeIdx].Children_;
+	}
+
+	const QVector<int>& LocalCollectionModel::ChildrenOf (int nodeIdx) const
+	{
+		return nodeIdx == -1 ? Roots_ : Nodes_.at (nodeIdx).Children_;
+	}
+
+	QModelIndex LocalCollectionModel::NodeIndex (int nodeIdx) const
+	{
+		if (nodeIdx == -1)
+			return {};
+
+		return createIndex (Nodes_.at (nodeIdx).Row_, 0, static_cast<quintptr> (nodeIdx));
+	}
+
+	LocalCollectionModel::TreeNode LocalCollectionModel::MakeAlbumNode (const Collection::Album& album)
+	{
+		TreeNode node;
+		node.Type_ = NodeType::Album;
+		node.ID_ = album.ID_;
+		node.Number_ = album.Year_;
+		node.Name_ = Intern (album.Name_);
+		node.Path_ = album.CoverPath_;
+		return node;
+	}
+
+	LocalCollectionModel::TreeNode LocalCollectionModel::MakeTrackNode (const Collection::Track& track)
+	{
+		TreeNode node;
+		node.Type_ = NodeType::Track;
+		node.IsIgnored_ = IgnoredTracks_.contains (track.ID_);
+		node.ID_ = track.ID_;
+		node.Number_ = track.Number_;
+		node.Length_ = track.Length_;
+		node.Name_ = track.Name_;
+		node.Path_ = track.FilePath_;
+		node.Genres_ = Intern (track.Genres_);
+		return node;
+	}
+
+	int LocalCollectionModel::AppendChild (int parent, TreeNode&& node)
+	{
+		const auto row = ChildrenOf (parent).size ();
+		if (!IsBatchInsert_)
+			beginInsertRows (NodeIndex (parent), row, row);
+
+		node.Parent_ = parent;
+		node.Row_ = row;
 
-		while (item)
+		int nodeIdx = 0;
+		if (!FreeNodes_.isEmpty ())
+		{
+			nodeIdx = FreeNodes_.takeLast ();
+			Nodes_ [nodeIdx] = std::move (node);
+		}
+		else
+		{
+			nodeIdx = Nodes_.size ();
+			Nodes_.push_back (std::move (node));
+		}
+
+		// Nodes_ might have been reallocated, so the reference is only
+		// taken now.
+		ChildrenOf (parent).push_back (nodeIdx);
+
+		const auto& added = Nodes_.at (nodeIdx);
+		switch (added.Type_)
+		{
+		case NodeType::Artist:
+			Artist2Node_ [added.ID_] = nodeIdx;
+			break;
+		case NodeType::Album:
+			Album2Nodes_ [added.ID_] [Nodes_.at (parent).ID_] = nodeIdx;
+			break;
+		case NodeType::Track:
+			Track2Node_ [added.ID_] = nodeIdx;
+			break;
+		}
+
+		if (!IsBatchInsert_)
+			endInsertRows ();
+
+		return nodeIdx;
+	}
+
+	void LocalCollectionModel::FetchChildren (int nodeIdx)
+	{
+		Nodes_ [nodeIdx].IsFetched_ = true;
+
+		const auto id = Nodes_.at (nodeIdx).ID_;
+
+		QVector<TreeNode> children;
+		switch (Nodes_.at (nodeIdx).Type_)
+		{
+		case NodeType::Artist:
+			for (const auto& album : GetArtistAlbums_ (id))
+				children << MakeAlbumNode (*album);
+			break;
+		case NodeType::Album:
+			for (const auto& track : GetAlbumTracks_ (id))
+				if (!Track2Node_.contains (track.ID_))
+					children << MakeTrackNode (track);
+			break;
+		case NodeType::Track:
+			return;
+		}
+
+		if (children.isEmpty ())
+			return;
+
+		beginInsertRows (NodeIndex (nodeIdx), 0, children.size () - 1);
+		IsBatchInsert_ = true;
+		for (auto& child : children)
+			AppendChild (nodeIdx, std::move (child));
+		IsBatchInsert_ = false;
+		endInsertRows ();
+	}
+
+	void LocalCollectionModel::RemoveNode (int nodeIdx)
+	{
+		const auto parent = Nodes_.at (nodeIdx).Parent_;
+		const auto row = Nodes_.at (nodeIdx).Row_;
+
+		beginRemoveRows (NodeIndex (parent), row, row);
+
+		auto& siblings = ChildrenOf (parent);
+		siblings.remove (row);
+		for (int i = row; i < siblings.size (); ++i)
+			Nodes_ [siblings.at (i)].Row_ = i;
+
+		FreeSubtree (nodeIdx);
+
+		endRemoveRows ();
+
+		ResetTooltips (parent);
+	}
+
+	void LocalCollectionModel::FreeSubtree (int nodeIdx)
+	{
+		for (const auto child : Nodes_.at (nodeIdx).Children_)
+			FreeSubtree (child);
+
+		const auto& node = Nodes_.at (nodeIdx);
+		switch (node.Type_)
+		{
+		case NodeType::Artist:
+			Artist2Node_.remove (node.ID_);
+			break;
+		case NodeType::Album:
+		{
+			const auto pos = Album2Nodes_.find (node.ID_);
+			if (pos != Album2Nodes_.end ())
+			{
+				pos->remove (Nodes_.at (node.Parent_).ID_);
+				if (pos->isEmpty ())
+					Album2Nodes_.erase (pos);
+			}
+			break;
+		}
+		case NodeType::Track:
+			Track2Node_.remove (node.ID_);
+			break;
+		}
+
+		Tooltips_.remove (nodeIdx);
+
+		Nodes_ [nodeIdx] = {};
+		FreeNodes_ << nodeIdx;
+	}
+
+	void LocalCollectionModel::ResetTooltips (int nodeIdx)
+	{
+		while (nodeIdx != -1)
 		{
-			item->setToolTip ({});
-			item = item->parent ();
+			Tooltips_.remove (nodeIdx);
+			nodeIdx = Nodes_.at (nodeIdx).Parent_;
 		}
 	}
 }
@@ -29,8 +29,12 @@
 
 #pragma once
 
-#include <QStandardItemModel>
+#include <functional>
+#include <QAbstractItemModel>
 #include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QIcon>
 #include <util/models/dndactionsmixin.h>
 #include "interfaces/lmp/icollectionmodel.h"
 #include "interfaces/lmp/collectiontypes.h"
@@ -39,21 +43,15 @@ namespace LeechCraft
 {
 namespace LMP
 {
-	class LocalCollectionStorage;
-
-	class LocalCollectionModel : public Util::DndActionsMixin<QStandardItemModel>
+	class LocalCollectionModel : public Util::DndActionsMixin<QAbstractItemModel>
 							   , public ICollectionModel
 	{
 		Q_OBJECT
-
-		LocalCollectionStorage * const Storage_;
-
-		QIcon ArtistIcon_ = QIcon::fromTheme ("view-media-artist");
-
-		QHash<int, QStandardItem*> Artist2Item_;
-		QHash<int, QHash<int, QStandardItem*>> Album2Item_;
-		QHash<int, QStandardItem*> Track2Item_;
 	public:
+		typedef std::function<Collection::TrackStats (int)> TrackStatsGetter_f;
+		typedef std::function<QList<Collection::Album_ptr> (int)> ArtistAlbumsGetter_f;
+		typedef std::function<QList<Collection::Track> (int)> AlbumTracksGetter_f;
+
 		enum NodeType
 		{
 			Artist,
@@ -74,10 +72,88 @@ namespace LMP
 			TrackPath,
 			TrackGenres,
 			TrackLength,
-			IsTrackIgnored
+			IsTrackIgnored,
+			ArtistID,
+			AlbumID
+		};
+	private:
+		const ArtistAlbumsGetter_f GetArtistAlbums_;
+		const AlbumTracksGetter_f GetAlbumTracks_;
+		const TrackStatsGetter_f GetTrackStats_;
+
+		QIcon ArtistIcon_ = QIcon::fromTheme ("view-media-artist");
+
+		/** A single row of the tree.
+		 *
+		 * Rows don't carry any per-role data: everything is computed in
+		 * data() from these fields and the fields of the ancestors. The
+		 * names are interned, so artists and albums sharing a name (and
+		 * genre lists) share the string data.
+		 *
+		 * The children of artists and albums are only created when the
+		 * view asks for them via fetchMore(), so IsFetched_ tells whether
+		 * Children_ is actually populated.
+		 */
+		struct TreeNode
+		{
+			NodeType Type_ = NodeType::Track;
+			bool IsIgnored_ = false;
+			bool IsFetched_ = false;
+
+			int ID_ = -1;
+			int Parent_ = -1;
+			int Row_ = 0;
+
+			// album year or track number
+			int Number_ = 0;
+			int Length_ = 0;
+
+			QString Name_;
+			// track path or album cover path
+			QString Path_;
+			QStringList Genres_;
+
+			QVector<int> Children_;
 		};
 
-		LocalCollectionModel (LocalCollectionStorage*, QObject*);
+		QVector<TreeNode> Nodes_;
+		QVector<int> FreeNodes_;
+		QVector<int> Roots_;
+
+		QSet<QString> StringsPool_;
+		QHash<QStringList, QStringList> GenresPool_;
+
+		QHash<int, int> Artist2Node_;
+		QHash<int, QHash<int, int>> Album2Nodes_;
+		QHash<int, int> Track2Node_;
+
+		QSet<int> IgnoredTracks_;
+
+		mutable QHash<int, QString> Tooltips_;
+
+		// the rows signals are emitted by the caller for the whole batch
+		bool IsBatchInsert_ = false;
+	public:
+		/** Constructs the model showing the artists passed to
+		 * AddArtists().
+		 *
+		 * The albums of an artist and the tracks of an album are queried
+		 * via the corresponding getters when the view first expands the
+		 * artist or the album.
+		 */
+		LocalCollectionModel (const ArtistAlbumsGetter_f&,
+				const AlbumTracksGetter_f&,
+				const TrackStatsGetter_f&,
+				QObject*);
+
+		QModelIndex index (int row, int column, const QModelIndex& parent = {}) const override;
+		QModelIndex parent (const QModelIndex&) const override;
+		int rowCount (const QModelIndex& parent = {}) const override;
+		int columnCount (const QModelIndex& parent = {}) const override;
+		bool hasChildren (const QModelIndex& parent = {}) const override;
+		bool canFetchMore (const QModelIndex& parent) const override;
+		void fetchMore (const QModelIndex& parent) override;
+		Qt::ItemFlags flags (const QModelIndex&) const override;
 
 		QStringList mimeTypes () const override;
 		QMimeData* mimeData (const QModelIndexList&) const override;
@@ -95,9 +171,31 @@ namespace LMP
 		void RemoveArtist (int);
 
 		void SetAlbumArt (int, const QString&);
-		QVariant GetTrackData (int trackId, Role) const;
 
 		void UpdatePlayStats (int);
+	private:
+		struct TooltipState;
+
+		QString Intern (const QString&);
+		QStringList Intern (const QStringList&);
+
+		QVector<int>& ChildrenOf (int);
+		const QVector<int>& ChildrenOf (int) const;
+		QModelIndex NodeIndex (int) const;
+
+		TreeNode MakeAlbumNode (const Collection::Album&);
+		TreeNode MakeTrackNode (const Collection::Track&);
+
+		int AppendChild (int parent, TreeNode&& node);
+		void FetchChildren (int);
+		void RemoveNode (int);
+		void FreeSubtree (int);
+		void ResetTooltips (int);
+
+		QVariant NodeData (int, int role) const;
+		QStringList CollectPaths (int) const;
+		TooltipState RefreshTooltip (int) const;
+		Collection::TrackStats GetLatestAlbumStats (int albumId) const;
 	};
 }
 }
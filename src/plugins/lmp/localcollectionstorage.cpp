@@ -154,7 +154,8 @@ namespace LMP
 					break;
 				}
 
-			SetMTime (info.LocalPath_, QFileInfo { info.LocalPath_ }.lastModified ());
+			const QFileInfo fileInfo { info.LocalPath_ };
+			SetFileStamp (info.LocalPath_, { fileInfo.lastModified ().toMSecsSinceEpoch (), fileInfo.size () });
 		}
 		lock.Good ();
 
@@ -199,6 +200,7 @@ namespace LMP
 		LoadResult result =
 		{
 			artists,
+			GetTrackLocations (),
 			PresentArtists_,
 			PresentAlbums_,
 			GetIgnoredTracks ().toSet ()
@@ -232,377 +234,158 @@ namespace LMP
 		return result;
 	}
 
-	void LocalCollectionStorage::IgnoreTrack (int id)
+	namespace
 	{
-		IgnoreTrack_.bindValue (":track_id", id);
-		if (!IgnoreTrack_.exec ())
+		template<typename F>
+		void ReadTracks (QSqlQuery& tracks, QSqlQuery& genres, F&& handler)
 		{
-			Util::DBLock::DumpError (IgnoreTrack_);
-			throw std::runtime_error ("cannot ignore track");
-		}
-	}
-
-	QList<int> LocalCollectionStorage::GetIgnoredTracks ()
-	{
-		if (!GetIgnoredTracks_.exec ())
-		{
-			Util::DBLock::DumpError (GetIgnoredTracks_);
-			throw std::runtime_error ("cannot get ignored tracks track");
-		}
-
-		QList<int> result;
-		while (GetIgnoredTracks_.next ())
-			result << GetIgnoredTracks_.value (0).toInt ();
-
-		GetIgnoredTracks_.finish ();
-
-		return result;
-	}
-
-	void LocalCollectionStorage::RemoveTrack (int id)
-	{
-		RemoveTrack_.bindValue (":track_id", id);
-		if (!RemoveTrack_.exec ())
-		{
-			Util::DBLock::DumpError (RemoveTrack_);
-			throw std::runtime_error ("cannot remove track");
-		}
-	}
-
-	void LocalCollectionStorage::RemoveAlbum (int id)
-	{
-		RemoveAlbum_.bindValue (":album_id", id);
-		if (!RemoveAlbum_.exec ())
-		{
-			Util::DBLock::DumpError (RemoveAlbum_);
-			throw std::runtime_error ("cannot remove album");
-		}
-
-		PresentAlbums_.remove (PresentAlbums_.key (id));
-	}
+			QHash<int, QStringList> trackGenres;
+			while (genres.next ())
+				trackGenres [genres.value (0).toInt ()] << genres.value (1).toString ();
+			genres.finish ();
 
-	void LocalCollectionStorage::RemoveArtist (int id)
-	{
-		RemoveArtist_.bindValue (":artist_id", id);
-		if (!RemoveArtist_.exec ())
-		{
-			Util::DBLock::DumpError (RemoveArtist_);
-			throw std::runtime_error ("cannot remove artist");
+			while (tracks.next ())
+			{
+				const int trackId = tracks.value (1).toInt ();
+				handler (tracks.value (0).toInt (),
+						Collection::Track
+						{
+							trackId,
+							tracks.value (2).toInt (),
+							tracks.value (3).toString (),
+							tracks.value (4).toInt (),
+							trackGenres.value (trackId),
+							tracks.value (5).toString ()
+						});
+			}
+			tracks.finish ();
 		}
-
-		PresentArtists_.remove (PresentArtists_.key (id));
 	}
 
-	void LocalCollectionStorage::SetAlbumArt (int id, const QString& path)
+	QList<Collection::Track> LocalCollectionStorage::GetAlbumTracks (int albumId)
 	{
-		SetAlbumArt_.bindValue (":album_id", id);
-		SetAlbumArt_.bindValue (":cover_path", path);
-		if (!SetAlbumArt_.exec ())
+		GetAlbumTracks_.bindValue (":album_id", albumId);
+		GetAlbumGenres_.bindValue (":album_id", albumId);
+		if (!GetAlbumGenres_.exec ())
 		{
-			Util::DBLock::DumpError (SetAlbumArt_);
-			throw std::runtime_error ("cannot update album art");
+			Util::DBLock::DumpError (GetAlbumGenres_);
+			throw std::runtime_error ("cannot fetch album genres");
 		}
-	}
-
-	Collection::TrackStats LocalCollectionStorage::GetTrackStats (int trackId)
-	{
-		GetTrackStats_.bindValue (":track_id", trackId);
-		if (!GetTrackStats_.exec ())
+		if (!GetAlbumTracks_.exec ())
 		{
-			Util::DBLock::DumpError (GetTrackStats_);
-			throw std::runtime_error ("cannot fetch track statistics");
+			GetAlbumGenres_.finish ();
+			Util::DBLock::DumpError (GetAlbumTracks_);
+			throw std::runtime_error ("cannot fetch album tracks");
 		}
 
-		if (!GetTrackStats_.next ())
-			return Collection::TrackStats ();
-
-		Collection::TrackStats result =
-		{
-			trackId,
-			GetTrackStats_.value (0).toInt (),
-			GetTrackStats_.value (1).toDateTime (),
-			GetTrackStats_.value (2).toDateTime (),
-			GetTrackStats_.value (3).toInt (),
-			GetTrackStats_.value (4).toInt ()
-		};
-		GetTrackStats_.finish ();
-
+		QList<Collection::Track> result;
+		ReadTracks (GetAlbumTracks_, GetAlbumGenres_,
+				[&result] (int, Collection::Track&& track) { result << std::move (track); });
 		return result;
 	}
 
-	void LocalCollectionStorage::SetTrackStats (const Collection::TrackStats& stats)
-	{
-		SetTrackStats_.bindValue (":track_id", stats.TrackID_);
-		SetTrackStats_.bindValue (":playcount", stats.Playcount_);
-		SetTrackStats_.bindValue (":added", stats.Added_);
-		SetTrackStats_.bindValue (":last_play", stats.LastPlay_);
-
-		if (!SetTrackStats_.exec ())
-		{
-			Util::DBLock::DumpError (SetTrackStats_);
-			throw std::runtime_error ("cannot set track statistics");
-		}
-	}
-
-	void LocalCollectionStorage::RecordTrackPlayed (int trackId, const QDateTime& date)
+	QHash<int, QList<Collection::Track>> LocalCollectionStorage::GetAllAlbumsTracks ()
 	{
-		AppendToPlayHistory_.bindValue (":track_id", trackId);
-		AppendToPlayHistory_.bindValue (":date", date);
-
-		if (!AppendToPlayHistory_.exec ())
-			Util::DBLock::DumpError (AppendToPlayHistory_);
-
-		UpdateTrackStats_.bindValue (":track_id", trackId);
-		UpdateTrackStats_.bindValue (":track_id_pc", trackId);
-		UpdateTrackStats_.bindValue (":track_id_add", trackId);
-		UpdateTrackStats_.bindValue (":track_id_lp", trackId);
-		UpdateTrackStats_.bindValue (":add_date", date);
-		UpdateTrackStats_.bindValue (":play_date", date);
-
-		if (!UpdateTrackStats_.exec ())
+		QSqlQuery genres (DB_);
+		if (!genres.exec ("SELECT TrackId, Name FROM genres;"))
 		{
-			Util::DBLock::DumpError (UpdateTrackStats_);
-			throw std::runtime_error ("cannot update track statistics");
+			Util::DBLock::DumpError (genres);
+			throw std::runtime_error ("cannot fetch genres");
 		}
-	}
 
-	QDateTime LocalCollectionStorage::GetMTime (const QString& filepath)
-	{
-		GetFileMTime_.bindValue (":filepath", filepath);
-		if (!GetFileMTime_.exec ())
+		QSqlQuery tracks (DB_);
+		if (!tracks.exec ("SELECT AlbumID, Id, TrackNumber, Name, Length, Path FROM tracks;"))
 		{
-			Util::DBLock::DumpError (GetFileMTime_);
-			throw std::runtime_error ("cannot get file mtime");
+			Util::DBLock::DumpError (tracks);
+			throw std::runtime_error ("cannot fetch tracks");
 		}
 
-		const auto& result = GetFileMTime_.next () ?
-				GetFileMTime_.value (0).toDateTime () :
-				QDateTime ();
-		GetFileMTime_.finish ();
+		QHash<int, QList<Collection::Track>> result;
+		ReadTracks (tracks, genres,
+				[&result] (int albumId, Collection::Track&& track) { result [albumId] << std::move (track); });
 		return result;
 	}
 
-	void LocalCollectionStorage::SetMTime (const QString& filepath, const QDateTime& mtime)
-	{
-		SetFileMTime_.bindValue (":filepath", filepath);
-		SetFileMTime_.bindValue (":mtime", mtime);
-		if (!SetFileMTime_.exec ())
-		{
-			Util::DBLock::DumpError (SetFileMTime_);
-			throw std::runtime_error ("cannot set file mtime");
-		}
-	}
-
-	const int LovedStateID = 1;
-	const int BannedStateID = 2;
-
-	void LocalCollectionStorage::SetTrackLoved (int trackId)
-	{
-		MarkLovedBanned (trackId, LovedStateID);
-	}
-
-	void LocalCollectionStorage::SetTrackBanned (int trackId)
-	{
-		MarkLovedBanned (trackId, BannedStateID);
-	}
-
-	void LocalCollectionStorage::ClearTrackLovedBanned (int trackId)
-	{
-		RemoveLovedBanned_.bindValue (":track_id", trackId);
-		if (!RemoveLovedBanned_.exec ())
-		{
-			Util::DBLock::DumpError (RemoveLovedBanned_);
-			throw std::runtime_error ("cannot remove track from loved/banned");
-		}
-	}
-
-	QList<int> LocalCollectionStorage::GetLovedTracks ()
+	LocalCollectionStorage::FilterMatches LocalCollectionStorage::FindMatching (const QString& pattern)
 	{
-		return GetLovedBanned (LovedStateID);
-	}
-
-	QList<int> LocalCollectionStorage::GetBannedTracks ()
-	{
-		return GetLovedBanned (BannedStateID);
-	}
+		auto escaped = pattern;
+		escaped.replace ("\\", "\\\\");
+		escaped.replace ("%", "\\%");
+		escaped.replace ("_", "\\_");
+		const QString like = "%" + escaped + "%";
 
-	QList<int> LocalCollectionStorage::GetOutdatedRgTracks ()
-	{
-		if (!GetOutdatedRgData_.exec ())
+		auto getIds = [this, &like] (const QString& queryStr, const QStringList& placeholders)
 		{
-			Util::DBLock::DumpError (GetOutdatedRgData_);
-			throw std::runtime_error ("cannot fetch outdated track RG data");
-		}
-
-		QList<int> result;
-		while (GetOutdatedRgData_.next ())
-			result << GetOutdatedRgData_.value (0).toInt ();
-		return result;
-	}
-
-	void LocalCollectionStorage::SetRgTrackInfo (int trackId, const RGData& data)
-	{
-		GetFileIdMTime_.bindValue (":track_id", trackId);
-		if (!GetFileIdMTime_.exec ())
-		{
-			Util::DBLock::DumpError (GetFileIdMTime_);
-			throw std::runtime_error ("cannot get file mtime");
-		}
-
-		const auto& mtime = GetFileIdMTime_.next () ?
-				GetFileIdMTime_.value (0).toDateTime () :
-				QDateTime ();
-		GetFileIdMTime_.finish ();
-
-		SetTrackRgData_.bindValue (":track_id", trackId);
-		SetTrackRgData_.bindValue (":mtime", mtime);
-		SetTrackRgData_.bindValue (":track_gain", data.TrackGain_);
-		SetTrackRgData_.bindValue (":track_peak", data.TrackPeak_);
-		SetTrackRgData_.bindValue (":album_gain", data.AlbumGain_);
-		SetTrackRgData_.bindValue (":album_peak", data.AlbumPeak_);
-
-		if (!SetTrackRgData_.exec ())
-		{
-			Util::DBLock::DumpError (SetTrackRgData_);
-			throw std::runtime_error ("cannot set track RG data");
-		}
-	}
-
-	RGData LocalCollectionStorage::GetRgTrackInfo (const QString& filepath)
-	{
-		GetTrackRgData_.bindValue (":filepath", filepath);
-
-		if (!GetTrackRgData_.exec ())
-		{
-			Util::DBLock::DumpError (GetTrackRgData_);
-			throw std::runtime_error ("cannot get track RG data");
-		}
-
-		if (!GetTrackRgData_.next ())
-			return {};
+			QSqlQuery query (DB_);
+			query.prepare (queryStr);
+			for (const auto& placeholder : placeholders)
+				query.bindValue (placeholder, like);
+			if (!query.exec ())
+			{
+				Util::DBLock::DumpError (query);
+				throw std::runtime_error ("cannot search the collection");
+			}
 
-		const RGData data
-		{
-			GetTrackRgData_.value (0).toDouble (),
-			GetTrackRgData_.value (1).toDouble (),
-			GetTrackRgData_.value (2).toDouble (),
-			GetTrackRgData_.value (3).toDouble ()
+			QSet<int> result;
+			while (query.next ())
+				result << query.value (0).toInt ();
+			return result;
 		};
 
-		GetTrackRgData_.finish ();
-
-		return data;
-	}
-
-	void LocalCollectionStorage::MarkLovedBanned (int trackId, int state)
-	{
-		SetLovedBanned_.bindValue (":track_id", trackId);
-		SetLovedBanned_.bindValue (":state", state);
-		if (!SetLovedBanned_.exec ())
+		return
 		{
-			Util::DBLock::DumpError (SetLovedBanned_);
-			throw std::runtime_error ("cannot mark track as loved/banned");
-		}
+			getIds ("SELECT Id FROM artists WHERE Name LIKE :name ESCAPE '\\';",
+					{ ":name" }),
+			getIds ("SELECT Id FROM albums WHERE Name LIKE :name ESCAPE '\\' "
+					"OR Year LIKE :year ESCAPE '\\';",
+					{ ":name", ":year" }),
+			getIds ("SELECT Id FROM tracks WHERE Name LIKE :name ESCAPE '\\' "
+					"OR TrackNumber LIKE :number ESCAPE '\\';",
+					{ ":name", ":number" })
+		};
 	}
 
-	QList<int> LocalCollectionStorage::GetLovedBanned (int state)
+	QHash<int, Collection::Album_ptr> LocalCollectionStorage::GetAllAlbums ()
 	{
-		GetLovedBanned_.bindValue (":state", state);
-		if (!GetLovedBanned_.exec ())
+		if (!GetAlbums_.exec ())
 		{
-			Util::DBLock::DumpError (GetLovedBanned_);
-			throw std::runtime_error ("cannot get loved/banned tracks");
+			Util::DBLock::DumpError (GetAlbums_);
+			throw std::runtime_error ("cannot fetch albums");
 		}
 
-		QList<int> result;
-		while (GetLovedBanned_.next ())
-			result << GetLovedBanned_.value (0).toInt ();
-		GetLovedBanned_.finish ();
-		return result;
-	}
-
-	Collection::Artists_t LocalCollectionStorage::GetAllArtists ()
-	{
-		Collection::Artists_t artists;
-
-		if (!GetArtists_.exec ())
+		QHash<int, Collection::Album_ptr> albums;
+		while (GetAlbums_.next ())
 		{
-			Util::DBLock::DumpError (GetArtists_);
-			throw std::runtime_error ("cannot fetch artists");
-		}
-		while (GetArtists_.next ())
-		{
-			Collection::Artist a =
+			const Collection::Album a
 			{
-				GetArtists_.value (0).toInt (),
-				GetArtists_.value (1).toString (),
-				QList<Collection::Album_ptr> ()
+				GetAlbums_.value (0).toInt (),
+				GetAlbums_.value (1).toString (),
+				GetAlbums_.value (2).toInt (),
+				GetAlbums_.value (3).toString (),
+				{}
 			};
-
-			artists << a;
+			albums [a.ID_] = std::make_shared<Collection::Album> (a);
 		}
-		GetArtists_.finish ();
+		GetAlbums_.finish ();
 
-		return artists;
+		return albums;
 	}
 
-	QHash<int, Collection::Album_ptr> LocalCollectionStorage::GetAllAlbums ()
+	QList<LocalCollectionStorage::TrackLocation> LocalCollectionStorage::GetTrackLocations ()
 	{
-		QHash<int, Collection::Album_ptr> newAlbums;
-
 		QSqlQuery getter (DB_);
-		QHash<int, QStringList> trackGenres;
-		if (!getter.exec ("SELECT TrackId, Name FROM genres;"))
+		if (!getter.exec ("SELECT Id, AlbumID, Path FROM tracks;"))
 		{
 			Util::DBLock::DumpError (getter);
-			throw std::runtime_error ("cannot fetch genres");
+			throw std::runtime_error ("cannot fetch tracks");
 		}
 
+		QList<TrackLocation> result;
 		while (getter.next ())
-			trackGenres [getter.value (0).toInt ()] << getter.value (1).toString ();
-
-		if (!getter.exec ("SELECT albums.Id, albums.Name, albums.Year, albums.CoverPath, tracks.Id, tracks.TrackNumber, tracks.Name, tracks.Length, tracks.Path FROM tracks INNER JOIN albums ON tracks.AlbumID = albums.Id;"))
-		{
-			Util::DBLock::DumpError (getter);
-			throw std::runtime_error ("cannot fetch albums");
-		}
-
-		while (getter.next ())
-		{
-			const int albumID = getter.value (0).toInt ();
-			auto albumPos = newAlbums.find (albumID);
-			if (albumPos == newAlbums.end ())
-			{
-				const Collection::Album a
-				{
-					albumID,
-					getter.value (1).toString (),
-					getter.value (2).toInt (),
-					getter.value (3).toString (),
-					{}
-				};
-				albumPos = newAlbums.insert (albumID, std::make_shared<Collection::Album> (a));
-			}
-
-			auto albumPtr = *albumPos;
-			auto& tracks = albumPtr->Tracks_;
-
-			const int trackId = getter.value (4).toInt ();
-			Collection::Track t
-			{
-				trackId,
-				getter.value (5).toInt (),
-				getter.value (6).toString (),
-				getter.value (7).toInt (),
-				trackGenres.value (trackId),
-				getter.value (8).toString ()
-			};
-
-			tracks << t;
-		}
+			result.append ({ getter.value (0).toInt (), getter.value (1).toInt (), getter.value (2).toString () });
 		getter.finish ();
 
-		return newAlbums;
+		return result;
 	}
 
 	void LocalCollectionStorage::AddArtist (Collection::Artist& artist)
@@ -709,11 +492,20 @@ namespace LMP
 		GetArtists_.prepare ("SELECT Id, Name FROM artists;");
 
 		GetAlbums_ = QSqlQuery (DB_);
-		GetAlbums_.prepare ("SELECT Id, Name, Year, CoverPath FROM albums;");
+		GetAlbums_.prepare ("SELECT Id, Name, Year, CoverPath FROM albums "
+				"WHERE EXISTS (SELECT 1 FROM tracks WHERE tracks.AlbumID = albums.Id);");
 
 		GetAllTracks_ = QSqlQuery (DB_);
 		GetAllTracks_.prepare ("SELECT Id, Path FROM tracks;");
 
+		GetAlbumTracks_ = QSqlQuery (DB_);
+		GetAlbumTracks_.prepare ("SELECT AlbumID, Id, TrackNumber, Name, Length, Path FROM tracks "
+				"WHERE AlbumID = :album_id;");
+
+		GetAlbumGenres_ = QSqlQuery (DB_);
+		GetAlbumGenres_.prepare ("SELECT genres.TrackId, genres.Name FROM genres "
+				"INNER JOIN tracks ON genres.TrackId = tracks.Id WHERE tracks.AlbumID = :album_id;");
+
 		AddArtist_ = QSqlQuery (DB_);
 		AddArtist_.prepare ("INSERT INTO artists (Name) VALUES (:name);");
 
@@ -767,11 +559,15 @@ namespace LMP
 		GetFileIdMTime_ = QSqlQuery (DB_);
 		GetFileIdMTime_.prepare ("SELECT MTime FROM fileTimes WHERE fileTimes.TrackID = :track_id;");
 
-		GetFileMTime_ = QSqlQuery (DB_);
-		GetFileMTime_.prepare ("SELECT MTime FROM fileTimes, tracks WHERE tracks.Path = :filepath AND tracks.Id = fileTimes.TrackID;");
+		GetFileStamps_ = QSqlQuery (DB_);
+		GetFileStamps_.setForwardOnly (true);
+		GetFileStamps_.prepare ("SELECT tracks.Path, fileTimes.MTime, fileTimes.Size "
+				"FROM tracks LEFT JOIN fileTimes ON fileTimes.TrackID = tracks.Id "
+				"WHERE tracks.Path >= :root_begin AND tracks.Path < :root_end;");
 
-		SetFileMTime_ = QSqlQuery (DB_);
-		SetFileMTime_.prepare ("INSERT OR REPLACE INTO fileTimes (TrackID, MTime) VALUES ((SELECT Id FROM tracks WHERE Path = :filepath), :mtime);");
+		SetFileStamp_ = QSqlQuery (DB_);
+		SetFileStamp_.prepare ("INSERT OR REPLACE INTO fileTimes (TrackID, MTime, Size) "
+				"VALUES ((SELECT Id FROM tracks WHERE Path = :filepath), :mtime, :size);");
 
 		GetLovedBanned_ = QSqlQuery (DB_);
 		GetLovedBanned_.prepare ("SELECT TrackId FROM lovedBanned WHERE State = :state;");
@@ -797,6 +593,22 @@ namespace LMP
 				" VALUES "
 				"(:track_id, :mtime, :track_gain, :track_peak, :album_gain, :album_peak);");
 
+		CacheTrackRgData_ = QSqlQuery (DB_);
+		CacheTrackRgData_.prepare ("INSERT OR REPLACE INTO rgcache "
+				"(Path, MTime, TrackGain, TrackPeak, AlbumGain, AlbumPeak)"
+				" VALUES "
+				"((SELECT Path FROM tracks WHERE Id = :track_id), :mtime, :track_gain, :track_peak, :album_gain, :album_peak);");
+
+		RestoreCachedRgData_ = QSqlQuery (DB_);
+		RestoreCachedRgData_.prepare ("INSERT OR REPLACE INTO rgdata "
+				"(TrackId, LastMTime, TrackGain, TrackPeak, AlbumGain, AlbumPeak) "
+				"SELECT tracks.Id, rgcache.MTime, rgcache.TrackGain, rgcache.TrackPeak, rgcache.AlbumGain, rgcache.AlbumPeak "
+				"FROM tracks "
+				"JOIN fileTimes ON fileTimes.TrackID = tracks.Id "
+				"JOIN rgcache ON rgcache.Path = tracks.Path AND rgcache.MTime = fileTimes.MTime "
+				"LEFT OUTER JOIN rgdata ON rgdata.TrackId = tracks.Id "
+				"WHERE rgdata.LastMTime IS NULL OR rgdata.LastMTime != fileTimes.MTime;");
+
 		AppendToPlayHistory_ = QSqlQuery (DB_);
 		AppendToPlayHistory_.prepare ("INSERT INTO playhistory "
 				"(TrackId, Date) VALUES (:track_id, :date);");
@@ -860,7 +672,8 @@ namespace LMP
 				"CREATE TABLE fileTimes ("
 				"Id INTEGER PRIMARY KEY AUTOINCREMENT, "
 				"TrackID INTEGER UNIQUE NOT NULL REFERENCES tracks (Id) ON DELETE CASCADE, "
-				"MTime TIMESTAMP NOT NULL"
+				"MTime TIMESTAMP NOT NULL, "
+				"Size INTEGER"
 				");");
 		table2query << QueryPair_t ("rgdata",
 				"CREATE TABLE rgdata ("
@@ -872,6 +685,15 @@ namespace LMP
 				"AlbumGain DOUBLE NOT NULL, "
 				"AlbumPeak DOUBLE NOT NULL "
 				");");
+		table2query << QueryPair_t ("rgcache",
+				"CREATE TABLE rgcache ("
+				"Path TEXT PRIMARY KEY, "
+				"MTime TIMESTAMP NOT NULL, "
+				"TrackGain DOUBLE NOT NULL, "
+				"TrackPeak DOUBLE NOT NULL, "
+				"AlbumGain DOUBLE NOT NULL, "
+				"AlbumPeak DOUBLE NOT NULL "
+				");");
 		table2query << QueryPair_t ("playhistory",
 				"CREATE TABLE playhistory ("
 				"Id INTEGER PRIMARY KEY AUTOINCREMENT, "
@@ -932,7 +754,33 @@ namespace LMP
 			XmlSettingsManager::Instance ().setProperty ("TracksTableVersion", 2);
 		}
 
+		const auto fileTimesTableVersion = XmlSettingsManager::Instance ()
+				.Property ("FileTimesTableVersion", 1).toInt ();
+		if (fileTimesTableVersion < 2)
+		{
+			QSqlQuery q { DB_ };
+			if (!q.exec ("PRAGMA table_info (fileTimes);"))
+			{
+				Util::DBLock::DumpError (q);
+				throw std::runtime_error ("cannot get fileTimes table info");
+			}
+
+			QSet<QString> columns;
+			while (q.next ())
+				columns << q.value (1).toString ();
+
+			if (!columns.contains ("Size") &&
+					!q.exec ("ALTER TABLE fileTimes ADD COLUMN Size INTEGER;"))
+			{
+				Util::DBLock::DumpError (q);
+				throw std::runtime_error ("cannot add Size column to fileTimes");
+			}
+			XmlSettingsManager::Instance ().setProperty ("FileTimesTableVersion", 2);
+		}
+
 		QSqlQuery (DB_).exec ("CREATE UNIQUE INDEX IF NOT EXISTS index_tracksPaths ON tracks (Path);");
+		QSqlQuery (DB_).exec ("CREATE INDEX IF NOT EXISTS index_tracksAlbums ON tracks (AlbumID);");
+		QSqlQuery (DB_).exec ("CREATE INDEX IF NOT EXISTS index_genresTracks ON genres (TrackId);");
 
 		lock.Good ();
 	}
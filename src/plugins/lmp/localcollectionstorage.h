@@ -53,6 +53,8 @@ namespace LMP
 		QSqlQuery GetArtists_;
 		QSqlQuery GetAlbums_;
 		QSqlQuery GetAllTracks_;
+		QSqlQuery GetAlbumTracks_;
+		QSqlQuery GetAlbumGenres_;
 
 		QSqlQuery AddArtist_;
 		QSqlQuery AddAlbum_;
@@ -74,8 +76,8 @@ namespace LMP
 		QSqlQuery UpdateTrackStats_;
 
 		QSqlQuery GetFileIdMTime_;
-		QSqlQuery GetFileMTime_;
-		QSqlQuery SetFileMTime_;
+		QSqlQuery GetFileStamps_;
+		QSqlQuery SetFileStamp_;
 
 		// 1 is loved, 2 is banned
 		QSqlQuery GetLovedBanned_;
@@ -85,12 +87,29 @@ namespace LMP
 		QSqlQuery GetOutdatedRgData_;
 		QSqlQuery GetTrackRgData_;
 		QSqlQuery SetTrackRgData_;
+		QSqlQuery CacheTrackRgData_;
+		QSqlQuery RestoreCachedRgData_;
 
 		QSqlQuery AppendToPlayHistory_;
 	public:
+		/** The bare minimum about a track that is needed to map it to
+		 * its file and its album without loading the track itself.
+		 */
+		struct TrackLocation
+		{
+			int ID_;
+			int AlbumID_;
+			QString Path_;
+		};
+
+		/** The skeleton of the collection: the artists and their albums
+		 * have their Tracks_ empty, the tracks are loaded on demand via
+		 * GetAlbumTracks().
+		 */
 		struct LoadResult
 		{
 			Collection::Artists_t Artists_;
+			QList<TrackLocation> Tracks_;
 
 			QHash<QString, int> PresentArtists_;
 			QHash<QString, int> PresentAlbums_;
@@ -98,6 +117,26 @@ namespace LMP
 			QSet<int> IgnoredTracks_;
 		};
 
+		struct FileStamp
+		{
+			/** Milliseconds since epoch, or -1 if the file is known to
+			 * the collection but has never been stamped.
+			 */
+			qint64 MTime_ = -1;
+			qint64 Size_ = -1;
+		};
+		typedef QHash<QString, FileStamp> FileStamps_t;
+
+		/** The artists, albums and tracks whose own fields match a
+		 * filter pattern, without regard to their children or parents.
+		 */
+		struct FilterMatches
+		{
+			QSet<int> Artists_;
+			QSet<int> Albums_;
+			QSet<int> Tracks_;
+		};
+
 		LocalCollectionStorage (QObject* = nullptr);
 		~LocalCollectionStorage ();
 
@@ -108,6 +147,15 @@ namespace LMP
 
 		QStringList GetTracksPaths ();
 
+		QList<Collection::Track> GetAlbumTracks (int albumId);
+		QHash<int, QList<Collection::Track>> GetAllAlbumsTracks ();
+
+		/** Returns the artists with names, the albums with names or
+		 * years and the tracks with titles or numbers containing the
+		 * given pattern, case-insensitively.
+		 */
+		FilterMatches FindMatching (const QString& pattern);
+
 		void IgnoreTrack (int);
 		QList<int> GetIgnoredTracks ();
 
@@ -121,8 +169,9 @@ namespace LMP
 		void SetTrackStats (const Collection::TrackStats&);
 		void RecordTrackPlayed (int, const QDateTime&);
 
-		QDateTime GetMTime (const QString&);
-		void SetMTime (const QString&, const QDateTime&);
+		FileStamps_t GetFileStamps (const QString& root);
+		void SetFileStamp (const QString&, const FileStamp&);
+		void SetFileStamps (const QList<QPair<QString, FileStamp>>&);
 
 		void SetTrackLoved (int);
 		void SetTrackBanned (int);
@@ -133,12 +182,21 @@ namespace LMP
 		QList<int> GetOutdatedRgTracks ();
 		void SetRgTrackInfo (int, const RGData&);
 		RGData GetRgTrackInfo (const QString&);
+
+		/** Restores the ReplayGain data of the tracks whose files were
+		 * already analysed with the same mtime, even if they have been
+		 * removed from the collection since then.
+		 *
+		 * Returns the number of restored tracks.
+		 */
+		int RestoreRgDataFromCache ();
 	private:
 		void MarkLovedBanned (int, int);
 		QList<int> GetLovedBanned (int);
 
 		Collection::Artists_t GetAllArtists ();
 		QHash<int, Collection::Album_ptr> GetAllAlbums ();
+		QList<TrackLocation> GetTrackLocations ();
 
 		void AddArtist (Collection::Artist&);
 		void AddAlbum (const Collection::Artist&, Collection::Album&);
@@ -30,29 +30,51 @@
 #include "localcollectionwatcher.h"
 #include <algorithm>
 #include <QTimer>
+#include <util/xpc/util.h>
 #include "core.h"
 #include "localcollection.h"
 #include "recursivedirwatcher.h"
+#include "util.h"
 
 namespace LeechCraft
 {
 namespace LMP
 {
+	namespace
+	{
+		const int FallbackRescanInterval = 15 * 60 * 1000;
+	}
+
 	LocalCollectionWatcher::LocalCollectionWatcher (QObject *parent)
 	: QObject (parent)
 	, Watcher_ (new RecursiveDirWatcher (this))
 	, ScanTimer_ (new QTimer (this))
+	, FallbackTimer_ (new QTimer (this))
 	{
 		connect (Watcher_,
 				SIGNAL (directoryChanged (QString)),
 				this,
 				SLOT (handleDirectoryChanged (QString)));
+		connect (Watcher_,
+				SIGNAL (filesChanged (QStringList, QStringList)),
+				this,
+				SLOT (handleFilesChanged (QStringList, QStringList)));
+		connect (Watcher_,
+				SIGNAL (watchLimitReached (QString)),
+				this,
+				SLOT (handleWatchLimitReached (QString)));
 
 		ScanTimer_->setSingleShot (true);
 		connect (ScanTimer_,
 				SIGNAL (timeout ()),
 				this,
 				SLOT (rescanQueue ()));
+
+		FallbackTimer_->setInterval (FallbackRescanInterval);
+		connect (FallbackTimer_,
+				SIGNAL (timeout ()),
+				this,
+				SLOT (rescanFallbackRoots ()));
 	}
 
 	void LocalCollectionWatcher::AddPath (const QString& path)
@@ -63,6 +85,10 @@ namespace LMP
 	void LocalCollectionWatcher::RemovePath (const QString& path)
 	{
 		Watcher_->RemoveRoot (path);
+
+		FallbackRoots_.removeAll (path);
+		if (FallbackRoots_.isEmpty ())
+			FallbackTimer_->stop ();
 	}
 
 	void LocalCollectionWatcher::ScheduleDir (const QString& dir)
@@ -87,6 +113,31 @@ namespace LMP
 		ScheduleDir (path);
 	}
 
+	void LocalCollectionWatcher::handleFilesChanged (const QStringList& changed, const QStringList& removed)
+	{
+		QSet<QString> changedTracks;
+		for (const auto& path : changed)
+			if (IsAudioFilePath (path))
+				changedTracks << path;
+
+		Core::Instance ().GetLocalCollection ()->UpdateFiles (changedTracks, removed.toSet ());
+	}
+
+	void LocalCollectionWatcher::handleWatchLimitReached (const QString& root)
+	{
+		if (FallbackRoots_.contains (root))
+			return;
+
+		FallbackRoots_ << root;
+		FallbackTimer_->start ();
+
+		const auto& msg = tr ("Too many directories to watch for changes in %1, it will be "
+				"rescanned every %n minute(s) instead. Consider raising the "
+				"fs.inotify.max_user_watches limit.", 0, FallbackRescanInterval / 60000)
+				.arg (root);
+		Core::Instance ().SendEntity (Util::MakeNotification ("LMP", msg, Priority::Warning));
+	}
+
 	void LocalCollectionWatcher::rescanQueue ()
 	{
 		for (const auto& path : ScheduledDirs_)
@@ -94,5 +145,11 @@ namespace LMP
 
 		ScheduledDirs_.clear ();
 	}
+
+	void LocalCollectionWatcher::rescanFallbackRoots ()
+	{
+		for (const auto& root : FallbackRoots_)
+			ScheduleDir (root);
+	}
 }
 }
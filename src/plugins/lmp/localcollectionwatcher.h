@@ -51,6 +51,10 @@ namespace LMP
 
 		QList<QString> ScheduledDirs_;
 		QTimer * const ScanTimer_;
+
+		// Roots that couldn't be watched fully and are rescanned instead.
+		QStringList FallbackRoots_;
+		QTimer * const FallbackTimer_;
 	public:
 		LocalCollectionWatcher (QObject* = nullptr);
 
@@ -60,7 +64,10 @@ namespace LMP
 		void ScheduleDir (const QString&);
 	private slots:
 		void handleDirectoryChanged (const QString&);
+		void handleFilesChanged (const QStringList&, const QStringList&);
+		void handleWatchLimitReached (const QString&);
 		void rescanQueue ();
+		void rescanFallbackRoots ();
 	};
 }
 }
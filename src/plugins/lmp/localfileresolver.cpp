@@ -30,8 +30,10 @@
 #include "localfileresolver.h"
 #include <QtDebug>
 #include <QFileInfo>
+#include <taglib/taglib.h>
 #include <taglib/fileref.h>
 #include <taglib/tag.h>
+#include <taglib/tfilestream.h>
 #include <util/sll/prelude.h>
 #include <util/sll/either.h>
 #include "util/lmp/gstutil.h"
@@ -41,16 +43,52 @@ namespace LeechCraft
 {
 namespace LMP
 {
+#if TAGLIB_MAJOR_VERSION == 1 && TAGLIB_MINOR_VERSION >= 11
+#define LMP_COUNT_TAGLIB_READS
+	namespace
+	{
+		class CountingStream : public TagLib::FileStream
+		{
+			std::atomic<qint64>& Counter_;
+		public:
+			CountingStream (TagLib::FileName name, std::atomic<qint64>& counter)
+			: TagLib::FileStream { name, true }
+			, Counter_ (counter)
+			{
+			}
+
+			TagLib::ByteVector readBlock (unsigned long length) override
+			{
+				auto result = TagLib::FileStream::readBlock (length);
+				Counter_ += result.size ();
+				return result;
+			}
+		};
+	}
+#endif
+
 	TagLib::FileRef LocalFileResolver::GetFileRef (const QString& file) const
 	{
+		return GetFileRef (file, TagLib::AudioProperties::Accurate);
+	}
+
+	TagLib::FileRef LocalFileResolver::GetFileRef (const QString& file,
+			TagLib::AudioProperties::ReadStyle style) const
+	{
 #ifdef Q_OS_WIN32
-		return TagLib::FileRef (reinterpret_cast<const wchar_t*> (file.utf16 ()));
+		return TagLib::FileRef (reinterpret_cast<const wchar_t*> (file.utf16 ()), true, style);
 #else
-		return TagLib::FileRef (file.toUtf8 ().constData (), true, TagLib::AudioProperties::Accurate);
+		return TagLib::FileRef (file.toUtf8 ().constData (), true, style);
 #endif
 	}
 
 	LocalFileResolver::ResolveResult_t LocalFileResolver::ResolveInfo (const QString& file)
+	{
+		return ResolveInfo (file, TagLib::AudioProperties::Accurate);
+	}
+
+	LocalFileResolver::ResolveResult_t LocalFileResolver::ResolveInfo (const QString& file,
+			TagLib::AudioProperties::ReadStyle style)
 	{
 		const auto& modified = QFileInfo (file).lastModified ();
 
@@ -64,9 +102,22 @@ namespace LMP
 			}
 		}
 
-		QMutexLocker tlLocker (&TaglibMutex_);
+		QReadLocker tlLocker (&TaglibLock_);
 
-		auto r = GetFileRef (file);
+#ifdef LMP_COUNT_TAGLIB_READS
+#ifdef Q_OS_WIN32
+		CountingStream stream { reinterpret_cast<const wchar_t*> (file.utf16 ()), BytesRead_ };
+#else
+		const auto& encodedName = file.toUtf8 ();
+		CountingStream stream { encodedName.constData (), BytesRead_ };
+#endif
+		if (!stream.isOpen ())
+			return ResolveResult_t::Left ({ file, "cannot open file" });
+
+		TagLib::FileRef r { &stream, true, style };
+#else
+		auto r = GetFileRef (file, style);
+#endif
 		auto tag = r.tag ();
 		if (!tag)
 			return ResolveResult_t::Left ({ file, "cannot get audio tags" });
@@ -104,9 +155,14 @@ namespace LMP
 		return ResolveResult_t::Right (info);
 	}
 
-	QMutex& LocalFileResolver::GetMutex ()
+	QReadWriteLock& LocalFileResolver::GetLock ()
+	{
+		return TaglibLock_;
+	}
+
+	qint64 LocalFileResolver::GetBytesRead () const
 	{
-		return TaglibMutex_;
+		return BytesRead_;
 	}
 
 	void LocalFileResolver::flushCache ()
@@ -29,11 +29,11 @@
 
 #pragma once
 
+#include <atomic>
 #include <stdexcept>
 #include <QObject>
 #include <QHash>
 #include <QReadWriteLock>
-#include <QMutex>
 #include <QDateTime>
 #include <taglib/fileref.h>
 #include "interfaces/lmp/itagresolver.h"
@@ -49,15 +49,26 @@ namespace LMP
 		Q_OBJECT
 		Q_INTERFACES (LeechCraft::LMP::ITagResolver)
 
-		QMutex TaglibMutex_;
+		QReadWriteLock TaglibLock_;
 		QReadWriteLock CacheLock_;
 		QHash<QString, QPair<QDateTime, MediaInfo>> Cache_;
+
+		std::atomic<qint64> BytesRead_ { 0 };
 	public:
 		using QObject::QObject;
 
 		TagLib::FileRef GetFileRef (const QString&) const;
+		TagLib::FileRef GetFileRef (const QString&, TagLib::AudioProperties::ReadStyle) const;
+
 		ResolveResult_t ResolveInfo (const QString&);
-		QMutex& GetMutex ();
+		ResolveResult_t ResolveInfo (const QString&, TagLib::AudioProperties::ReadStyle);
+
+		QReadWriteLock& GetLock ();
+
+		/** Returns the number of bytes TagLib has read from files so
+		 * far, or 0 if the TagLib version doesn't allow counting them.
+		 */
+		qint64 GetBytesRead () const;
 	private slots:
 		void flushCache ();
 	};
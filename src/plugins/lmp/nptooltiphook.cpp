@@ -37,6 +37,7 @@
 #include <QFile>
 #include <QtDebug>
 #include <util/util.h>
+#include <util/lmp/util.h>
 #include "nowplayingpixmaphandler.h"
 #include "core.h"
 #include "localcollection.h"
@@ -50,7 +50,7 @@ namespace Fradj
 		Q_OBJECT
 		Q_INTERFACES (IInfo IPlugin2 LeechCraft::LMP::IFilterPlugin)
 
-		LC_PLUGIN_METADATA ("org.LeechCraft.LMP.FrAdj")
+		LC_PLUGIN_METADATA_FILE ("org.LeechCraft.LMP.FrAdj", "manifest.json")
 	public:
 		void Init (ICoreProxy_ptr);
 		void SecondInit ();
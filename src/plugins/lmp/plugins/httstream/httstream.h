@@ -50,7 +50,7 @@ namespace HttStream
 		Q_OBJECT
 		Q_INTERFACES (IInfo IPlugin2 LeechCraft::LMP::IFilterPlugin)
 
-		LC_PLUGIN_METADATA ("org.LeechCraft.LMP.HttStream")
+		LC_PLUGIN_METADATA_FILE ("org.LeechCraft.LMP.HttStream", "manifest.json")
 	public:
 		void Init (ICoreProxy_ptr);
 		void SecondInit ();
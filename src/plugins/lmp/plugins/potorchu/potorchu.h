@@ -50,7 +50,7 @@ namespace Potorchu
 		Q_OBJECT
 		Q_INTERFACES (IInfo IPlugin2 LeechCraft::LMP::ILMPPlugin LeechCraft::LMP::IFilterPlugin)
 
-		LC_PLUGIN_METADATA ("org.LeechCraft.LMP.Potorchu")
+		LC_PLUGIN_METADATA_FILE ("org.LeechCraft.LMP.Potorchu", "manifest.json")
 
 		ILMPProxy_ptr LmpProxy_;
 	public:
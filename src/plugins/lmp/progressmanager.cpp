@@ -32,6 +32,7 @@
 #include <util/xpc/util.h>
 #include <interfaces/ijobholder.h>
 #include "sync/syncmanagerbase.h"
+#include "rganalysismanager.h"
 
 namespace LeechCraft
 {
@@ -60,8 +61,16 @@ namespace LMP
 				SLOT (handleUploadProgress (int, int, SyncManagerBase*)));
 	}
 
+	void ProgressManager::AddRgAnalysisManager (RgAnalysisManager *rgMgr)
+	{
+		connect (rgMgr,
+				SIGNAL (progress (int, int, RgAnalysisManager*)),
+				this,
+				SLOT (handleRgProgress (int, int, RgAnalysisManager*)));
+	}
+
 	void ProgressManager::HandleWithHash (int done, int total,
-			SyncManagerBase *syncer, Syncer2Row_t& hash, const QString& name, const QString& status)
+			QObject *syncer, Syncer2Row_t& hash, const QString& name, const QString& status)
 	{
 		if (!hash.contains (syncer))
 		{
@@ -104,5 +113,18 @@ namespace LMP
 		HandleWithHash (done, total, syncer, UpRows_,
 				tr ("Audio upload"), tr ("Uploading..."));
 	}
+
+	void ProgressManager::handleRgProgress (int done, int total, RgAnalysisManager *rgMgr)
+	{
+		HandleWithHash (done, total, rgMgr, RgRows_,
+				tr ("ReplayGain analysis"), tr ("Analyzing..."));
+
+		if (!RgRows_.contains (rgMgr))
+			return;
+
+		const auto& status = tr ("%n album(s) in queue", 0, rgMgr->GetQueueDepth ()) +
+				", " + tr ("%1 albums/min").arg (rgMgr->GetAlbumsPerMinute (), 0, 'f', 1);
+		RgRows_ [rgMgr].value (JobHolderColumn::JobStatus)->setText (status);
+	}
 }
 }
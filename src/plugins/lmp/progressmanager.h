@@ -41,6 +41,7 @@ namespace LeechCraft
 namespace LMP
 {
 	class SyncManagerBase;
+	class RgAnalysisManager;
 
 	class ProgressManager : public QObject
 	{
@@ -48,21 +49,24 @@ namespace LMP
 
 		QStandardItemModel *Model_;
 
-		typedef QHash<SyncManagerBase*, QList<QStandardItem*>> Syncer2Row_t;
+		typedef QHash<QObject*, QList<QStandardItem*>> Syncer2Row_t;
 		Syncer2Row_t TCRows_;
 		Syncer2Row_t UpRows_;
+		Syncer2Row_t RgRows_;
 	public:
 		ProgressManager (QObject* = 0);
 
 		QAbstractItemModel* GetModel () const;
 
 		void AddSyncManager (SyncManagerBase*);
+		void AddRgAnalysisManager (RgAnalysisManager*);
 	private:
-		void HandleWithHash (int, int, SyncManagerBase*,
+		void HandleWithHash (int, int, QObject*,
 				Syncer2Row_t&, const QString&, const QString&);
 	private slots:
 		void handleTCProgress (int, int, SyncManagerBase*);
 		void handleUploadProgress (int, int, SyncManagerBase*);
+		void handleRgProgress (int, int, RgAnalysisManager*);
 	};
 }
 }
@@ -30,6 +30,7 @@
 #pragma once
 
 #include <QObject>
+#include <QStringList>
 
 namespace LeechCraft
 {
@@ -48,7 +49,25 @@ namespace LMP
 		void AddRoot (const QString&);
 		void RemoveRoot (const QString&);
 	signals:
+		/** Something has changed somewhere in the given directory, and it
+		 * should be rescanned.
+		 */
 		void directoryChanged (const QString&);
+
+		/** The given files have been created or modified, and the given
+		 * files or directories have been removed.
+		 *
+		 * Only emitted by backends that are able to track individual
+		 * files, which currently is the inotify one.
+		 */
+		void filesChanged (const QStringList& changed, const QStringList& removed);
+
+		/** The system limit on watched directories has been reached, so
+		 * changes under the given root may go unnoticed.
+		 *
+		 * Only emitted by the inotify backend.
+		 */
+		void watchLimitReached (const QString& root);
 	};
 }
 }
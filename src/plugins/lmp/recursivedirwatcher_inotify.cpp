@@ -0,0 +1,404 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "recursivedirwatcher_inotify.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <QSocketNotifier>
+#include <QTimer>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QtDebug>
+#include <QtConcurrentRun>
+#include <util/threads/futures.h>
+#include "xmlsettingsmanager.h"
+
+namespace LeechCraft
+{
+namespace LMP
+{
+	namespace
+	{
+		const quint32 WatchMask = IN_CREATE | IN_CLOSE_WRITE |
+				IN_MOVED_FROM | IN_MOVED_TO |
+				IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF |
+				IN_ONLYDIR;
+
+		const int DebounceMsecs = 1500;
+		const int MaxDelayMsecs = 10000;
+
+		typedef QList<QPair<int, QString>> Watches_t;
+
+		struct WatchResult
+		{
+			Watches_t Watches_;
+			QStringList Files_;
+			bool OutOfWatches_ = false;
+		};
+
+		/** The watch is added before the directory is listed, so nothing
+		 * created in between is missed.
+		 */
+		WatchResult DoWatchTree (int fd, const QString& root, bool collectFiles, bool followSymLinks)
+		{
+			WatchResult result;
+
+			auto dirFilter = QDir::Dirs | QDir::NoDotAndDotDot;
+			if (!followSymLinks)
+				dirFilter |= QDir::NoSymLinks;
+
+			// followed symlinks may form cycles
+			QSet<QString> visited;
+
+			QStringList queue { root };
+			while (!queue.isEmpty ())
+			{
+				const auto& path = queue.takeLast ();
+
+				if (followSymLinks)
+				{
+					const auto& canonical = QFileInfo { path }.canonicalFilePath ();
+					if (visited.contains (canonical))
+						continue;
+					visited << canonical;
+				}
+
+				const auto wd = inotify_add_watch (fd, QFile::encodeName (path).constData (), WatchMask);
+				if (wd < 0)
+				{
+					const auto err = errno;
+					qWarning () << Q_FUNC_INFO
+							<< "unable to watch"
+							<< path
+							<< std::strerror (err);
+					if (err == ENOSPC)
+					{
+						qWarning () << Q_FUNC_INFO
+								<< "out of inotify watches, consider raising fs.inotify.max_user_watches";
+						result.OutOfWatches_ = true;
+						break;
+					}
+					continue;
+				}
+
+				result.Watches_.append ({ wd, path });
+
+				const QDir dir { path };
+				for (const auto& item : dir.entryList (dirFilter))
+					queue << dir.filePath (item);
+
+				if (collectFiles)
+					for (const auto& item : dir.entryList (QDir::Files))
+						result.Files_ << dir.filePath (item);
+			}
+
+			return result;
+		}
+
+		bool IsUnder (const QString& path, const QString& dir)
+		{
+			return path.size () > dir.size () &&
+					path.startsWith (dir) &&
+					path.at (dir.size ()) == '/';
+		}
+	}
+
+	RecursiveDirWatcherImpl::RecursiveDirWatcherImpl (QObject *parent)
+	: QObject { parent }
+	, FD_ { inotify_init1 (IN_NONBLOCK | IN_CLOEXEC) }
+	, DebounceTimer_ { new QTimer { this } }
+	{
+		DebounceTimer_->setSingleShot (true);
+		connect (DebounceTimer_,
+				SIGNAL (timeout ()),
+				this,
+				SLOT (flush ()));
+
+		if (FD_ < 0)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to initialize inotify:"
+					<< std::strerror (errno);
+			return;
+		}
+
+		Notifier_ = new QSocketNotifier { FD_, QSocketNotifier::Read, this };
+		connect (Notifier_,
+				SIGNAL (activated (int)),
+				this,
+				SLOT (readEvents ()));
+	}
+
+	RecursiveDirWatcherImpl::~RecursiveDirWatcherImpl ()
+	{
+		delete Notifier_;
+		if (FD_ >= 0)
+			close (FD_);
+	}
+
+	void RecursiveDirWatcherImpl::AddRoot (const QString& root)
+	{
+		if (FD_ < 0 || Roots_.contains (root))
+			return;
+
+		Roots_ << root;
+
+		qDebug () << Q_FUNC_INFO << "scanning" << root;
+		WatchTree (root, false);
+	}
+
+	void RecursiveDirWatcherImpl::RemoveRoot (const QString& root)
+	{
+		if (!Roots_.removeAll (root))
+			return;
+
+		if (std::any_of (Roots_.begin (), Roots_.end (),
+				[&root] (const QString& other) { return IsUnder (root, other); }))
+			return;
+
+		RemoveWatches (root);
+	}
+
+	void RecursiveDirWatcherImpl::WatchTree (const QString& root, bool newDir)
+	{
+		const bool symLinks = XmlSettingsManager::Instance ()
+				.property ("FollowSymLinks").toBool ();
+
+		++PendingTrees_;
+		Util::Sequence (this, QtConcurrent::run (DoWatchTree, FD_, root, newDir, symLinks)) >>
+				[this, root, newDir] (const WatchResult& result)
+				{
+					--PendingTrees_;
+
+					if (!newDir && !Roots_.contains (root))
+					{
+						for (const auto& pair : result.Watches_)
+						{
+							Orphaned_.remove (pair.first);
+							if (!WD2Path_.contains (pair.first))
+								inotify_rm_watch (FD_, pair.first);
+						}
+						if (!PendingTrees_)
+							Orphaned_.clear ();
+						return;
+					}
+
+					AddWatches (result.Watches_);
+					for (const auto& file : result.Files_)
+						MarkChanged (file);
+
+					if (result.OutOfWatches_)
+						for (const auto& watchedRoot : Roots_)
+							if (watchedRoot == root || IsUnder (root, watchedRoot))
+								emit watchLimitReached (watchedRoot);
+
+					if (!newDir)
+						qDebug () << Q_FUNC_INFO
+								<< "watching"
+								<< result.Watches_.size ()
+								<< "directories under"
+								<< root;
+				};
+	}
+
+	void RecursiveDirWatcherImpl::AddWatches (const Watches_t& watches)
+	{
+		for (const auto& pair : watches)
+		{
+			WD2Path_ [pair.first] = pair.second;
+			Path2WD_ [pair.second] = pair.first;
+		}
+
+		for (const auto& pair : watches)
+			for (const auto& event : Orphaned_.take (pair.first))
+				HandleEvent (pair.first, event.Mask_, event.Name_);
+
+		if (!PendingTrees_)
+			Orphaned_.clear ();
+	}
+
+	void RecursiveDirWatcherImpl::RemoveWatches (const QString& dir)
+	{
+		for (auto i = Path2WD_.begin (); i != Path2WD_.end (); )
+		{
+			if (i.key () != dir && !IsUnder (i.key (), dir))
+			{
+				++i;
+				continue;
+			}
+
+			// the watch may already be gone if the directory has been deleted
+			inotify_rm_watch (FD_, *i);
+			WD2Path_.remove (*i);
+			i = Path2WD_.erase (i);
+		}
+	}
+
+	void RecursiveDirWatcherImpl::HandleEvent (int wd, quint32 mask, const QString& name)
+	{
+		if (mask & IN_Q_OVERFLOW)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "inotify queue overflow, falling back to full rescan";
+			for (const auto& root : Roots_)
+				emit directoryChanged (root);
+			return;
+		}
+
+		const auto dirPos = WD2Path_.find (wd);
+		if (dirPos == WD2Path_.end ())
+		{
+			if (PendingTrees_)
+				Orphaned_ [wd].append ({ mask, name });
+			return;
+		}
+
+		if (mask & IN_IGNORED)
+		{
+			const auto path = *dirPos;
+			WD2Path_.erase (dirPos);
+			if (Path2WD_.value (path, -1) == wd)
+				Path2WD_.remove (path);
+			return;
+		}
+
+		const auto dir = *dirPos;
+
+		if (mask & (IN_DELETE_SELF | IN_MOVE_SELF))
+		{
+			// non-root directories are also reported by their parents
+			if (Roots_.contains (dir))
+				MarkRemoved (dir);
+			if (mask & IN_MOVE_SELF)
+				RemoveWatches (dir);
+			return;
+		}
+
+		const auto& path = dir + '/' + name;
+
+		if (mask & IN_ISDIR)
+		{
+			if (mask & (IN_CREATE | IN_MOVED_TO))
+				HandleNewDir (path);
+			else if (mask & (IN_DELETE | IN_MOVED_FROM))
+			{
+				RemoveWatches (path);
+				MarkRemoved (path);
+			}
+			return;
+		}
+
+		// IN_CREATE is ignored for files: the file is picked up once it's
+		// closed after writing, so half-copied files aren't resolved.
+		if (mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+			MarkChanged (path);
+		else if (mask & (IN_DELETE | IN_MOVED_FROM))
+			MarkRemoved (path);
+	}
+
+	void RecursiveDirWatcherImpl::HandleNewDir (const QString& path)
+	{
+		WatchTree (path, true);
+	}
+
+	void RecursiveDirWatcherImpl::MarkChanged (const QString& path)
+	{
+		PendingRemoved_.remove (path);
+		PendingChanged_ << path;
+		ScheduleFlush ();
+	}
+
+	void RecursiveDirWatcherImpl::MarkRemoved (const QString& path)
+	{
+		PendingChanged_.remove (path);
+		PendingRemoved_ << path;
+		ScheduleFlush ();
+	}
+
+	void RecursiveDirWatcherImpl::ScheduleFlush ()
+	{
+		if (!PendingSince_.isValid ())
+			PendingSince_.start ();
+
+		// a steady stream of events shouldn't postpone the flush forever
+		DebounceTimer_->start (PendingSince_.elapsed () >= MaxDelayMsecs ? 0 : DebounceMsecs);
+	}
+
+	void RecursiveDirWatcherImpl::readEvents ()
+	{
+		alignas (inotify_event) char buffer [64 * 1024];
+
+		while (true)
+		{
+			const auto len = read (FD_, buffer, sizeof (buffer));
+			if (len < 0 && errno == EINTR)
+				continue;
+			if (len <= 0)
+			{
+				if (len < 0 && errno != EAGAIN)
+					qWarning () << Q_FUNC_INFO
+							<< "error reading inotify events:"
+							<< std::strerror (errno);
+				break;
+			}
+
+			for (auto ptr = buffer; ptr < buffer + len; )
+			{
+				const auto event = reinterpret_cast<const inotify_event*> (ptr);
+				ptr += sizeof (inotify_event) + event->len;
+
+				const auto& name = event->len ?
+						QFile::decodeName (event->name) :
+						QString {};
+				HandleEvent (event->wd, event->mask, name);
+			}
+		}
+	}
+
+	void RecursiveDirWatcherImpl::flush ()
+	{
+		PendingSince_.invalidate ();
+
+		if (PendingChanged_.isEmpty () && PendingRemoved_.isEmpty ())
+			return;
+
+		const auto& changed = PendingChanged_.toList ();
+		const auto& removed = PendingRemoved_.toList ();
+		PendingChanged_.clear ();
+		PendingRemoved_.clear ();
+
+		emit filesChanged (changed, removed);
+	}
+}
+}
@@ -0,0 +1,113 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QElapsedTimer>
+
+class QSocketNotifier;
+class QTimer;
+
+namespace LeechCraft
+{
+namespace LMP
+{
+	/** Watches whole directory trees via a single inotify instance.
+	 *
+	 * Individual file events are coalesced over a short debounce window
+	 * and reported as precise sets of changed and removed paths via the
+	 * filesChanged() signal. directoryChanged() is only emitted for a
+	 * root when the kernel event queue overflows and the exact changes
+	 * are thus unknown.
+	 *
+	 * If the inotify watch limit is hit, watchLimitReached() is emitted
+	 * for the affected root, which is then only partially watched.
+	 */
+	class RecursiveDirWatcherImpl : public QObject
+	{
+		Q_OBJECT
+
+		const int FD_;
+		QSocketNotifier *Notifier_ = nullptr;
+
+		QStringList Roots_;
+
+		QHash<int, QString> WD2Path_;
+		QHash<QString, int> Path2WD_;
+
+		struct Event
+		{
+			quint32 Mask_;
+			QString Name_;
+		};
+
+		/* Directory trees are watched in a separate thread, so events for
+		 * freshly added watches may arrive before the watches are known.
+		 * They are kept here while any tree is still being watched.
+		 */
+		int PendingTrees_ = 0;
+		QHash<int, QList<Event>> Orphaned_;
+
+		QSet<QString> PendingChanged_;
+		QSet<QString> PendingRemoved_;
+
+		QTimer * const DebounceTimer_;
+		QElapsedTimer PendingSince_;
+	public:
+		RecursiveDirWatcherImpl (QObject*);
+		~RecursiveDirWatcherImpl ();
+
+		void AddRoot (const QString&);
+		void RemoveRoot (const QString&);
+	private:
+		void WatchTree (const QString& root, bool newDir);
+		void AddWatches (const QList<QPair<int, QString>>&);
+		void RemoveWatches (const QString&);
+
+		void HandleEvent (int wd, quint32 mask, const QString& name);
+		void HandleNewDir (const QString&);
+
+		void MarkChanged (const QString&);
+		void MarkRemoved (const QString&);
+		void ScheduleFlush ();
+	private slots:
+		void readEvents ();
+		void flush ();
+	signals:
+		void directoryChanged (const QString&);
+		void watchLimitReached (const QString&);
+		void filesChanged (const QStringList& changed, const QStringList& removed);
+	};
+}
+}
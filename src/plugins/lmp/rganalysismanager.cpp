@@ -28,6 +28,8 @@
  **********************************************************************/
 
 #include "rganalysismanager.h"
+#include <algorithm>
+#include <QThread>
 #include "localcollection.h"
 #include "localcollectionstorage.h"
 #include "engine/rganalyser.h"
@@ -46,9 +48,31 @@ namespace LMP
 				SIGNAL (scanFinished ()),
 				this,
 				SLOT (handleScanFinished ()));
+		connect (Coll_,
+				SIGNAL (collectionReady ()),
+				this,
+				SLOT (restorePending ()));
 
 		XmlSettingsManager::Instance ().RegisterObject ("AutobuildRG",
 				this, "handleScanFinished");
+		XmlSettingsManager::Instance ().RegisterObject ("RgAnalysisThreads",
+				this, "rotateQueue");
+
+		if (Coll_->IsReady ())
+			restorePending ();
+	}
+
+	int RgAnalysisManager::GetQueueDepth () const
+	{
+		return AlbumsQueue_.size () + Running_.size ();
+	}
+
+	double RgAnalysisManager::GetAlbumsPerMinute () const
+	{
+		if (!BatchTimer_.isValid () || !DoneAlbums_)
+			return 0;
+
+		return DoneAlbums_ * 60 * 1000. / std::max<qint64> (BatchTimer_.elapsed (), 1);
 	}
 
 	namespace
@@ -57,11 +81,70 @@ namespace LMP
 		{
 			return XmlSettingsManager::Instance ().property ("AutobuildRG").toBool ();
 		}
+
+		int GetPoolSize ()
+		{
+			const auto configured = XmlSettingsManager::Instance ()
+					.property ("RgAnalysisThreads").toInt ();
+			return configured > 0 ?
+					configured :
+					std::max (QThread::idealThreadCount (), 1);
+		}
+	}
+
+	void RgAnalysisManager::Enqueue (const Collection::Album_ptr& album)
+	{
+		if (PendingAlbums_.contains (album->ID_))
+			return;
+
+		if (AlbumsQueue_.isEmpty () && Running_.isEmpty ())
+		{
+			DoneAlbums_ = 0;
+			TotalAlbums_ = 0;
+			BatchTimer_.start ();
+		}
+
+		PendingAlbums_ << album->ID_;
+		AlbumsQueue_ << album;
+		++TotalAlbums_;
+	}
+
+	void RgAnalysisManager::SavePending () const
+	{
+		QVariantList ids;
+		for (auto id : PendingAlbums_)
+			ids << id;
+		XmlSettingsManager::Instance ().setProperty ("RgPendingAlbums", ids);
+	}
+
+	void RgAnalysisManager::EmitProgress ()
+	{
+		emit progress (DoneAlbums_, TotalAlbums_, this);
+
+		if (DoneAlbums_ == TotalAlbums_ && BatchTimer_.isValid ())
+		{
+			qDebug () << Q_FUNC_INFO
+					<< "analysed"
+					<< DoneAlbums_
+					<< "albums in"
+					<< BatchTimer_.elapsed ()
+					<< "ms,"
+					<< GetAlbumsPerMinute ()
+					<< "albums per minute";
+			BatchTimer_.invalidate ();
+		}
 	}
 
 	void RgAnalysisManager::handleAnalysed ()
 	{
-		const auto& result = CurrentAnalyser_->GetResult ();
+		const auto analyser = qobject_cast<RgAnalyser*> (sender ());
+		if (!analyser || !Running_.contains (analyser))
+			return;
+
+		const auto albumId = Running_.take (analyser);
+		analyser->deleteLater ();
+
+		const auto& result = analyser->GetResult ();
 
 		for (const auto& track : result.Tracks_)
 		{
@@ -83,30 +166,74 @@ namespace LMP
 					});
 		}
 
-		CurrentAnalyser_.reset ();
+		PendingAlbums_.remove (albumId);
+		++DoneAlbums_;
+		SavePending ();
+
 		rotateQueue ();
 	}
 
 	void RgAnalysisManager::rotateQueue ()
 	{
-		if (AlbumsQueue_.isEmpty ())
-			return;
-
 		if (!IsScanAllowed ())
 		{
+			for (const auto& album : AlbumsQueue_)
+				PendingAlbums_.remove (album->ID_);
 			AlbumsQueue_.clear ();
+			TotalAlbums_ = DoneAlbums_ + Running_.size ();
+			SavePending ();
+			EmitProgress ();
 			return;
 		}
 
-		QStringList paths;
-		for (const auto& track : AlbumsQueue_.takeFirst ()->Tracks_)
-			paths << track.FilePath_;
+		const auto poolSize = GetPoolSize ();
+		while (Running_.size () < poolSize && !AlbumsQueue_.isEmpty ())
+		{
+			const auto& album = AlbumsQueue_.takeFirst ();
+
+			QStringList paths;
+			for (const auto& track : album->Tracks_)
+				paths << track.FilePath_;
 
-		CurrentAnalyser_ = std::make_shared<RgAnalyser> (paths);
-		connect (CurrentAnalyser_.get (),
-				SIGNAL (finished ()),
-				this,
-				SLOT (handleAnalysed ()));
+			if (paths.isEmpty ())
+			{
+				PendingAlbums_.remove (album->ID_);
+				++DoneAlbums_;
+				continue;
+			}
+
+			const auto analyser = new RgAnalyser { paths, this };
+			connect (analyser,
+					SIGNAL (finished ()),
+					this,
+					SLOT (handleAnalysed ()));
+			Running_ [analyser] = album->ID_;
+		}
+
+		EmitProgress ();
+	}
+
+	void RgAnalysisManager::restorePending ()
+	{
+		if (!IsScanAllowed ())
+			return;
+
+		const auto& ids = XmlSettingsManager::Instance ()
+				.Property ("RgPendingAlbums", QVariantList {}).toList ();
+		if (ids.isEmpty ())
+			return;
+
+		for (const auto& id : ids)
+			if (const auto& album = Coll_->GetAlbum (id.toInt ()))
+				Enqueue (album);
+
+		qDebug () << Q_FUNC_INFO
+				<< "resuming ReplayGain analysis of"
+				<< AlbumsQueue_.size ()
+				<< "albums";
+
+		SavePending ();
+		rotateQueue ();
 	}
 
 	void RgAnalysisManager::handleScanFinished ()
@@ -115,20 +242,36 @@ namespace LMP
 		if (!IsScanAllowed ())
 			return;
 
+		const auto storage = Coll_->GetStorage ();
+
+		try
+		{
+			if (const auto restored = storage->RestoreRgDataFromCache ())
+				qDebug () << Q_FUNC_INFO
+						<< "restored ReplayGain data for"
+						<< restored
+						<< "tracks from cache";
+		}
+		catch (const std::exception& e)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to restore cached ReplayGain data:"
+					<< e.what ();
+		}
+
 		QSet<int> albums;
-		for (const auto track : Coll_->GetStorage ()->GetOutdatedRgTracks ())
+		for (const auto track : storage->GetOutdatedRgTracks ())
 			albums << Coll_->GetTrackAlbumId (track);
 
-		const bool wasEmpty = AlbumsQueue_.isEmpty ();
-
 		for (auto albumId : albums)
 			if (const auto& album = Coll_->GetAlbum (albumId))
-				AlbumsQueue_ << album;
+				Enqueue (album);
 
 		qDebug () << AlbumsQueue_.size ()
 				<< "albums to rescan";
-		if (wasEmpty)
-			rotateQueue ();
+
+		SavePending ();
+		rotateQueue ();
 	}
 }
 }
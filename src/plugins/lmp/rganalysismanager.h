@@ -30,7 +30,9 @@
 #pragma once
 
 #include <QObject>
+#include <QHash>
 #include <QSet>
+#include <QElapsedTimer>
 #include "interfaces/lmp/collectiontypes.h"
 
 namespace LeechCraft
@@ -46,16 +48,31 @@ namespace LMP
 
 		LocalCollection * const Coll_;
 
-		std::shared_ptr<RgAnalyser> CurrentAnalyser_;
+		QHash<RgAnalyser*, int> Running_;
 
 		QList<Collection::Album_ptr> AlbumsQueue_;
+		QSet<int> PendingAlbums_;
+
+		int DoneAlbums_ = 0;
+		int TotalAlbums_ = 0;
+		QElapsedTimer BatchTimer_;
 	public:
 		RgAnalysisManager (LocalCollection *coll, QObject* = nullptr);
+
+		int GetQueueDepth () const;
+		double GetAlbumsPerMinute () const;
+	private:
+		void Enqueue (const Collection::Album_ptr&);
+		void SavePending () const;
+		void EmitProgress ();
 	private slots:
 		void handleAnalysed ();
 		void rotateQueue ();
+		void restorePending ();
 	public slots:
 		void handleScanFinished ();
+	signals:
+		void progress (int done, int total, RgAnalysisManager*);
 	};
 }
 }
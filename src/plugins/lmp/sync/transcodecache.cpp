@@ -0,0 +1,210 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "transcodecache.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QtConcurrentRun>
+#include <QtDebug>
+#include <util/sys/paths.h>
+#include <util/threads/futures.h>
+#include "transcodejob.h"
+#include "transcodingparams.h"
+#include "../xmlsettingsmanager.h"
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+namespace LeechCraft
+{
+namespace LMP
+{
+	namespace
+	{
+		qint64 GetCacheLimit ()
+		{
+			return XmlSettingsManager::Instance ().property ("TranscodeCacheSize").toLongLong () * 1024 * 1024;
+		}
+
+		bool LinkOrCopy (const QString& from, const QString& to)
+		{
+#ifdef Q_OS_UNIX
+			if (!link (QFile::encodeName (from).constData (), QFile::encodeName (to).constData ()))
+				return true;
+#endif
+			return QFile::copy (from, to);
+		}
+
+		/** Returns the change of the cache size, or -1 if the file could
+		 * not be cached.
+		 */
+		qint64 StoreFile (const QString& transcoded, const QString& cached)
+		{
+			const auto oldSize = QFileInfo { cached }.size ();
+			QFile::remove (cached);
+			if (!LinkOrCopy (transcoded, cached))
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "unable to cache"
+						<< transcoded
+						<< "as"
+						<< cached;
+				return -1;
+			}
+
+			return QFileInfo { cached }.size () - oldSize;
+		}
+
+		/** Removes the oldest files until the total size fits the limit,
+		 * returning the resulting total size.
+		 */
+		qint64 EvictFiles (const QDir& dir, qint64 limit)
+		{
+			const auto& infos = dir.entryInfoList (QDir::Files, QDir::Time);
+
+			qint64 total = 0;
+			for (const auto& info : infos)
+				total += info.size ();
+
+			for (auto i = infos.size () - 1; i >= 0 && total > limit; --i)
+			{
+				const auto& info = infos.at (i);
+				if (QFile::remove (info.absoluteFilePath ()))
+					total -= info.size ();
+			}
+
+			return total;
+		}
+	}
+
+	TranscodeCache::TranscodeCache (QObject *parent)
+	: QObject { parent }
+	, Dir_ { Util::GetUserDir (Util::UserDir::Cache, "lmp/transcoded") }
+	{
+	}
+
+	QFuture<QString> TranscodeCache::Find (const QString& source, const TranscodingParams& params) const
+	{
+		if (GetCacheLimit () <= 0)
+			return Util::MakeReadyFuture (QString {});
+
+		const auto& cached = GetCachedPath (source, params);
+		if (cached.isEmpty ())
+			return Util::MakeReadyFuture (QString {});
+
+		const auto& result = BuildTranscodedPath (source, params);
+		return QtConcurrent::run ([cached, result] () -> QString
+				{
+					if (!QFile::exists (cached))
+						return {};
+
+					if (!LinkOrCopy (cached, result))
+					{
+						qWarning () << Q_FUNC_INFO
+								<< "unable to copy cached"
+								<< cached
+								<< "to"
+								<< result;
+						return {};
+					}
+
+					return result;
+				});
+	}
+
+	QFuture<qint64> TranscodeCache::Store (const QString& source,
+			const TranscodingParams& params, const QString& transcoded)
+	{
+		const auto limit = GetCacheLimit ();
+		if (limit <= 0)
+			return Util::MakeReadyFuture<qint64> (-1);
+
+		const auto& cached = GetCachedPath (source, params);
+		if (cached.isEmpty ())
+			return Util::MakeReadyFuture<qint64> (-1);
+
+		const auto future = QtConcurrent::run (StoreFile, transcoded, cached);
+		Util::Sequence (this, future) >>
+				[this, limit] (qint64 delta)
+				{
+					if (delta == -1)
+						return;
+
+					if (TotalSize_ >= 0)
+						TotalSize_ += delta;
+
+					if (TotalSize_ < 0 || TotalSize_ > limit)
+						Evict (limit);
+				};
+		return future;
+	}
+
+	QString TranscodeCache::GetCachedPath (const QString& source, const TranscodingParams& params) const
+	{
+		const auto& format = Formats {}.GetFormat (params.FormatID_);
+		if (!format)
+			return {};
+
+		/* The source is identified by its path, size and modification time
+		 * instead of a hash of its contents. Hashing would mean reading
+		 * every source file in full on each sync just to find out whether
+		 * it needs transcoding, while a changed file gets a new mtime
+		 * anyway.
+		 */
+		const QFileInfo fi { source };
+
+		QCryptographicHash hash { QCryptographicHash::Sha1 };
+		hash.addData (fi.absoluteFilePath ().toUtf8 ());
+		hash.addData (QByteArray::number (fi.size ()));
+		hash.addData (QByteArray::number (fi.lastModified ().toMSecsSinceEpoch ()));
+		hash.addData (params.FormatID_.toUtf8 ());
+		hash.addData (QByteArray::number (static_cast<int> (params.BitrateType_)));
+		hash.addData (QByteArray::number (params.Quality_));
+
+		return Dir_.absoluteFilePath (hash.result ().toHex () + '.' + format->GetFileExtension ());
+	}
+
+	void TranscodeCache::Evict (qint64 limit)
+	{
+		if (IsEvicting_)
+			return;
+
+		IsEvicting_ = true;
+		Util::Sequence (this, QtConcurrent::run (EvictFiles, Dir_, limit)) >>
+				[this] (qint64 total)
+				{
+					IsEvicting_ = false;
+					TotalSize_ = total;
+				};
+	}
+}
+}
@@ -0,0 +1,88 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#pragma once
+
+#include <QObject>
+#include <QDir>
+#include <QString>
+#include <QFuture>
+
+namespace LeechCraft
+{
+namespace LMP
+{
+	struct TranscodingParams;
+
+	/** Keeps the results of transcoding so that syncing the same files to
+	 * several devices (or syncing them again) doesn't re-encode them.
+	 *
+	 * Entries are keyed by the source file identity (path, size and
+	 * modification time) and the format-related transcoding params. The
+	 * total cache size is limited by the TranscodeCacheSize setting, with
+	 * the oldest entries evicted first.
+	 *
+	 * Copying files to and from the cache happens in a separate thread.
+	 */
+	class TranscodeCache : public QObject
+	{
+		Q_OBJECT
+
+		const QDir Dir_;
+
+		// The total size of the cache, or -1 if it's not known yet.
+		qint64 TotalSize_ = -1;
+		bool IsEvicting_ = false;
+	public:
+		TranscodeCache (QObject* = nullptr);
+
+		/** Returns a future with a fresh temporary copy of the cached
+		 * result of transcoding the source with the params, or a null
+		 * string if there is none.
+		 *
+		 * The copy is a hard link where possible, so it's cheap to
+		 * create and safe to remove once it's been copied to the device.
+		 */
+		QFuture<QString> Find (const QString& source, const TranscodingParams&) const;
+
+		/** Stores the transcoded file in the cache.
+		 *
+		 * The returned future finishes once the file is stored, and the
+		 * transcoded file must not be removed before that. It contains
+		 * the change of the cache size, or -1 if the file hasn't been
+		 * cached.
+		 */
+		QFuture<qint64> Store (const QString& source, const TranscodingParams&, const QString& transcoded);
+	private:
+		QString GetCachedPath (const QString& source, const TranscodingParams&) const;
+		void Evict (qint64 limit);
+	};
+}
+}
@@ -33,6 +33,7 @@
 #include <QMap>
 #include <QDir>
 #include <QUuid>
+#include <QReadWriteLock>
 #include <QtDebug>
 #include <taglib/tag.h>
 #include "transcodingparams.h"
@@ -50,41 +51,38 @@ namespace LeechCraft
 {
 namespace LMP
 {
-	namespace
+	QString BuildTranscodedPath (const QString& path, const TranscodingParams& params)
 	{
-		QString BuildTranscodedPath (const QString& path, const TranscodingParams& params)
+		static const auto tmpDirName = []
 		{
-			static const auto tmpDirName = []
-			{
 #ifdef Q_OS_UNIX
-				return QString { "lmp_transcode_%1" }
-						.arg (getuid ());
+			return QString { "lmp_transcode_%1" }
+					.arg (getuid ());
 #else
-				return "lmp_transcode";
+			return "lmp_transcode";
 #endif
-			} ();
+		} ();
 
-			QDir dir = QDir::temp ();
-			if (!dir.exists (tmpDirName))
-				dir.mkdir (tmpDirName);
-			if (!dir.cd (tmpDirName))
-				throw std::runtime_error ("unable to cd into temp dir");
+		QDir dir = QDir::temp ();
+		if (!dir.exists (tmpDirName))
+			dir.mkdir (tmpDirName);
+		if (!dir.cd (tmpDirName))
+			throw std::runtime_error ("unable to cd into temp dir");
 
-			const QFileInfo fi (path);
+		const QFileInfo fi (path);
 
-			const auto format = Formats ().GetFormat (params.FormatID_);
+		const auto format = Formats ().GetFormat (params.FormatID_);
 
-			auto result = dir.absoluteFilePath (fi.fileName ());
-			auto ext = format->GetFileExtension ();
-			ext.prepend (QUuid::createUuid ().toString () + ".");
-			const auto dotIdx = result.lastIndexOf ('.');
-			if (dotIdx == -1)
-				result += '.' + ext;
-			else
-				result.replace (dotIdx + 1, result.size () - dotIdx, ext);
+		auto result = dir.absoluteFilePath (fi.fileName ());
+		auto ext = format->GetFileExtension ();
+		ext.prepend (QUuid::createUuid ().toString () + ".");
+		const auto dotIdx = result.lastIndexOf ('.');
+		if (dotIdx == -1)
+			result += '.' + ext;
+		else
+			result.replace (dotIdx + 1, result.size () - dotIdx, ext);
 
-			return result;
-		}
+		return result;
 	}
 
 	TranscodeJob::TranscodeJob (const QString& path, const TranscodingParams& params, QObject* parent)
@@ -152,7 +150,7 @@ namespace LMP
 		{
 			const auto resolver = Core::Instance ().GetLocalFileResolver ();
 
-			QMutexLocker locker (&resolver->GetMutex ());
+			QWriteLocker locker (&resolver->GetLock ());
 
 			auto fromRef = resolver->GetFileRef (from);
 			auto toRef = resolver->GetFileRef (to);
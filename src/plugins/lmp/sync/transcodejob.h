@@ -38,6 +38,11 @@ namespace LMP
 {
 	struct TranscodingParams;
 
+	/** Returns a new unique path in the temporary transcoding directory for
+	 * the result of transcoding the given file with the given params.
+	 */
+	QString BuildTranscodedPath (const QString& path, const TranscodingParams& params);
+
 	class TranscodeJob : public QObject
 	{
 		Q_OBJECT
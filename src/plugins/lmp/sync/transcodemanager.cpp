@@ -28,11 +28,15 @@
  **********************************************************************/
 
 #include "transcodemanager.h"
+#include <algorithm>
+#include <memory>
 #include <QStringList>
 #include <QtDebug>
 #include <QFileInfo>
-#include <util/sll/prelude.h>
+#include <util/threads/futures.h>
 #include "transcodejob.h"
+#include "../core.h"
+#include "../localcollection.h"
 
 namespace LeechCraft
 {
@@ -40,6 +44,7 @@ namespace LMP
 {
 	TranscodeManager::TranscodeManager (QObject *parent)
 	: QObject (parent)
+	, Cache_ (new TranscodeCache (this))
 	{
 	}
 
@@ -50,6 +55,23 @@ namespace LMP
 			return filename.endsWith (".flac", Qt::CaseInsensitive) ||
 					filename.endsWith (".alac", Qt::CaseInsensitive);
 		}
+
+		qint64 EstimateLength (const QString& path)
+		{
+			const auto coll = Core::Instance ().GetLocalCollection ();
+			const auto trackId = coll->FindTrack (path);
+			if (trackId != -1)
+			{
+				const auto length = coll->GetTrackData (trackId, LocalCollectionModel::TrackLength).toLongLong ();
+				if (length > 0)
+					return length;
+			}
+
+			// Assume about 800 kbps for tracks outside of the collection,
+			// which is a sane guess for the lossless files that take
+			// the longest to encode.
+			return QFileInfo { path }.size () / (100 * 1024);
+		}
 	}
 
 	void TranscodeManager::Enqueue (QStringList files, const TranscodingParams& params)
@@ -71,34 +93,72 @@ namespace LMP
 			files.erase (partPos, files.end ());
 		}
 
-		Queue_ += Util::Map (files,
-				[&params] (const QString& file) { return qMakePair (file, params); });
+		// the jobs are started once all the files are looked up in the
+		// cache, so that the longest ones really go first
+		const auto pending = std::make_shared<int> (files.size ());
+		for (const auto& file : files)
+			Util::Sequence (this, Cache_->Find (file, params)) >>
+					[this, file, params, pending] (const QString& cached)
+					{
+						if (!cached.isEmpty ())
+						{
+							qDebug () << Q_FUNC_INFO
+									<< "using cached transcoding result for"
+									<< file;
+							emit fileReady (file, cached, params.FilePattern_);
+						}
+						else
+						{
+							const QueueItem item { file, params, EstimateLength (file) };
+							const auto pos = std::upper_bound (Queue_.begin (), Queue_.end (), item,
+									[] (const QueueItem& left, const QueueItem& right)
+										{ return left.EstimatedLength_ > right.EstimatedLength_; });
+							Queue_.insert (pos, item);
+						}
+
+						if (!--*pending)
+							StartJobs ();
+					};
+	}
 
-		while (RunningJobs_.size () < params.NumThreads_ && !Queue_.isEmpty ())
+	void TranscodeManager::StartJobs ()
+	{
+		while (!Queue_.isEmpty () &&
+				RunningJobs_.size () < Queue_.first ().Params_.NumThreads_)
 			EnqueueJob (Queue_.takeFirst ());
 	}
 
-	void TranscodeManager::EnqueueJob (const QPair<QString, TranscodingParams>& pair)
+	void TranscodeManager::EnqueueJob (const QueueItem& item)
 	{
-		auto job = new TranscodeJob (pair.first, pair.second, this);
-		RunningJobs_ << job;
+		auto job = new TranscodeJob (item.Path_, item.Params_, this);
+		RunningJobs_ [job] = item.Params_;
 		connect (job,
 				SIGNAL (done (TranscodeJob*, bool)),
 				this,
 				SLOT (handleDone (TranscodeJob*, bool)));
-		emit fileStartedTranscoding (QFileInfo (pair.first).fileName ());
+		emit fileStartedTranscoding (QFileInfo (item.Path_).fileName ());
 	}
 
 	void TranscodeManager::handleDone (TranscodeJob *job, bool success)
 	{
-		RunningJobs_.removeAll (job);
+		const auto& params = RunningJobs_.take (job);
 		job->deleteLater ();
 
-		if (!Queue_.isEmpty ())
-			EnqueueJob (Queue_.takeFirst ());
+		StartJobs ();
 
 		if (success)
-			emit fileReady (job->GetOrigPath (), job->GetTranscodedPath (), job->GetTargetPattern ());
+		{
+			// the transcoded file is removed once it's copied to the
+			// device, so it should be cached before that
+			Util::Sequence (this, Cache_->Store (job->GetOrigPath (), params, job->GetTranscodedPath ())) >>
+					[this,
+						origPath = job->GetOrigPath (),
+						transcodedPath = job->GetTranscodedPath (),
+						pattern = job->GetTargetPattern ()] (qint64)
+					{
+						emit fileReady (origPath, transcodedPath, pattern);
+					};
+		}
 		else
 			emit fileFailed (job->GetOrigPath ());
 	}
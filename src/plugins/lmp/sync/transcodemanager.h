@@ -30,8 +30,9 @@
 #pragma once
 
 #include <QObject>
-#include <QPair>
+#include <QHash>
 #include "transcodingparams.h"
+#include "transcodecache.h"
 
 namespace LeechCraft
 {
@@ -39,19 +40,36 @@ namespace LMP
 {
 	class TranscodeJob;
 
+	/** Schedules the transcoding jobs, longest tracks first.
+	 *
+	 * Each file is encoded by a separate ffmpeg process, see TranscodeJob.
+	 */
 	class TranscodeManager : public QObject
 	{
 		Q_OBJECT
 
-		QList<QPair<QString, TranscodingParams>> Queue_;
+		struct QueueItem
+		{
+			QString Path_;
+			TranscodingParams Params_;
+			qint64 EstimatedLength_;
+		};
 
-		QList<TranscodeJob*> RunningJobs_;
+		/** Sorted by the estimated length, longest first, so that a long
+		 * track doesn't end up being encoded alone after everything else.
+		 */
+		QList<QueueItem> Queue_;
+
+		QHash<TranscodeJob*, TranscodingParams> RunningJobs_;
+
+		TranscodeCache * const Cache_;
 	public:
 		TranscodeManager (QObject* = 0);
 
 		void Enqueue (QStringList, const TranscodingParams&);
 	private:
-		void EnqueueJob (const QPair<QString, TranscodingParams>&);
+		void StartJobs ();
+		void EnqueueJob (const QueueItem&);
 	private slots:
 		void handleDone (TranscodeJob*, bool);
 	signals:
@@ -81,6 +81,9 @@ namespace LMP
 			}
 		}
 
+		if (canFetchMore (idx))
+			fetchMore (idx);
+
 		for (int i = 0, rc = rowCount (idx); i < rc; ++i)
 			setData (index (i, 0, idx), data, Qt::CheckStateRole);
 
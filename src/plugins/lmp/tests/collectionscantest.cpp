@@ -0,0 +1,208 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "collectionscantest.h"
+#include <QtTest>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include "collectionscan.h"
+
+QTEST_GUILESS_MAIN (LeechCraft::LMP::CollectionScanTest)
+
+namespace LeechCraft
+{
+namespace LMP
+{
+	namespace
+	{
+		void WriteFile (const QString& path, const QByteArray& contents)
+		{
+			QFile file { path };
+			QVERIFY (file.open (QIODevice::WriteOnly));
+			QCOMPARE (file.write (contents), static_cast<qint64> (contents.size ()));
+		}
+
+		QList<QFileInfo> Walk (const QString& root)
+		{
+			QList<QFileInfo> result;
+			QDirIterator it { root, { "*.mp3" }, QDir::Files, QDirIterator::Subdirectories };
+			while (it.hasNext ())
+			{
+				it.next ();
+				result << it.fileInfo ();
+			}
+			return result;
+		}
+
+		LocalCollectionStorage::FileStamp Stamp (const QFileInfo& info)
+		{
+			return { info.lastModified ().toMSecsSinceEpoch (), info.size () };
+		}
+
+		LocalCollectionStorage::FileStamps_t Snapshot (const QList<QFileInfo>& infos)
+		{
+			LocalCollectionStorage::FileStamps_t result;
+			result.reserve (infos.size ());
+			for (const auto& info : infos)
+				result [info.absoluteFilePath ()] = Stamp (info);
+			return result;
+		}
+	}
+
+	void CollectionScanTest::init ()
+	{
+		Dir_.reset (new QTemporaryDir);
+		QVERIFY (Dir_->isValid ());
+
+		WriteFile (Dir_->filePath ("a.mp3"), "first");
+		WriteFile (Dir_->filePath ("b.mp3"), "second");
+	}
+
+	void CollectionScanTest::cleanup ()
+	{
+		Dir_.reset ();
+	}
+
+	void CollectionScanTest::testNewFiles ()
+	{
+		const auto& infos = Walk (Dir_->path ());
+		const auto& diff = DiffScan (infos, {});
+
+		QCOMPARE (diff.ChangedFiles_.size (), 2);
+		QVERIFY (diff.UnchangedFiles_.isEmpty ());
+		QVERIFY (diff.StampsToWrite_.isEmpty ());
+	}
+
+	void CollectionScanTest::testUnchangedFiles ()
+	{
+		const auto& infos = Walk (Dir_->path ());
+		const auto& diff = DiffScan (infos, Snapshot (infos));
+
+		QCOMPARE (diff.UnchangedFiles_.size (), 2);
+		QVERIFY (diff.ChangedFiles_.isEmpty ());
+		QVERIFY (diff.StampsToWrite_.isEmpty ());
+	}
+
+	void CollectionScanTest::testMTimeChanged ()
+	{
+		const auto& infos = Walk (Dir_->path ());
+		auto snapshot = Snapshot (infos);
+
+		const auto& path = Dir_->filePath ("a.mp3");
+		snapshot [path].MTime_ -= 10 * 1000;
+
+		const auto& diff = DiffScan (infos, snapshot);
+		QCOMPARE (diff.ChangedFiles_, QSet<QString> { path });
+		QCOMPARE (diff.UnchangedFiles_.size (), 1);
+		QCOMPARE (diff.StampsToWrite_.size (), 1);
+		QCOMPARE (diff.StampsToWrite_.first ().first, path);
+		QCOMPARE (diff.StampsToWrite_.first ().second.MTime_,
+				QFileInfo { path }.lastModified ().toMSecsSinceEpoch ());
+	}
+
+	void CollectionScanTest::testSizeChanged ()
+	{
+		const auto& infos = Walk (Dir_->path ());
+		auto snapshot = Snapshot (infos);
+
+		const auto& path = Dir_->filePath ("b.mp3");
+		snapshot [path].Size_ += 1;
+
+		const auto& diff = DiffScan (infos, snapshot);
+		QCOMPARE (diff.ChangedFiles_, QSet<QString> { path });
+		QCOMPARE (diff.StampsToWrite_.size (), 1);
+		QCOMPARE (diff.StampsToWrite_.first ().second.Size_, QFileInfo { path }.size ());
+	}
+
+	void CollectionScanTest::testLegacyStamp ()
+	{
+		const auto& infos = Walk (Dir_->path ());
+		auto snapshot = Snapshot (infos);
+
+		const auto& path = Dir_->filePath ("a.mp3");
+		snapshot [path].Size_ = -1;
+
+		const auto& diff = DiffScan (infos, snapshot);
+		QCOMPARE (diff.UnchangedFiles_.size (), 2);
+		QVERIFY (diff.ChangedFiles_.isEmpty ());
+		QCOMPARE (diff.StampsToWrite_.size (), 1);
+		QCOMPARE (diff.StampsToWrite_.first ().first, path);
+	}
+
+	void CollectionScanTest::testNeverStamped ()
+	{
+		const auto& infos = Walk (Dir_->path ());
+		auto snapshot = Snapshot (infos);
+
+		const auto& path = Dir_->filePath ("b.mp3");
+		snapshot [path] = {};
+
+		const auto& diff = DiffScan (infos, snapshot);
+		QCOMPARE (diff.ChangedFiles_, QSet<QString> { path });
+		QCOMPARE (diff.StampsToWrite_.size (), 1);
+	}
+
+	void CollectionScanTest::benchNoChangeRescan ()
+	{
+		const int ArtistsCount = 2000;
+		const int TracksPerArtist = 100;
+
+		QTemporaryDir dir;
+		QVERIFY (dir.isValid ());
+
+		QElapsedTimer timer;
+		timer.start ();
+
+		QDir root { dir.path () };
+		for (int artist = 0; artist < ArtistsCount; ++artist)
+		{
+			const auto& artistDir = QString { "artist%1" }.arg (artist);
+			QVERIFY (root.mkdir (artistDir));
+			for (int track = 0; track < TracksPerArtist; ++track)
+				WriteFile (root.filePath (artistDir + QString { "/%1.mp3" }.arg (track)), {});
+		}
+
+		qDebug () << "created" << ArtistsCount * TracksPerArtist << "files in" << timer.restart () << "ms";
+
+		const auto& snapshot = Snapshot (Walk (dir.path ()));
+		QCOMPARE (snapshot.size (), ArtistsCount * TracksPerArtist);
+
+		ScanDiff diff;
+		QBENCHMARK
+		{
+			diff = DiffScan (Walk (dir.path ()), snapshot);
+		}
+
+		QCOMPARE (diff.UnchangedFiles_.size (), ArtistsCount * TracksPerArtist);
+		QVERIFY (diff.ChangedFiles_.isEmpty ());
+		QVERIFY (diff.StampsToWrite_.isEmpty ());
+	}
+}
+}
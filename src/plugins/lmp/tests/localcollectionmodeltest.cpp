@@ -0,0 +1,339 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "localcollectionmodeltest.h"
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QUrl>
+#include <QFile>
+#include "localcollectionmodel.h"
+
+QTEST_MAIN (LeechCraft::LMP::LocalCollectionModelTest)
+
+namespace LeechCraft
+{
+namespace LMP
+{
+	namespace
+	{
+		Collection::Artists_t MakeCollection (int artists, int albums, int tracks, int idsOffset = 0)
+		{
+			const QStringList genres { "rock", "metal" };
+
+			Collection::Artists_t result;
+			int trackId = idsOffset;
+			for (int ar = 0; ar < artists; ++ar)
+			{
+				Collection::Artist artist { idsOffset + ar, QString { "Artist %1" }.arg (ar), {} };
+				for (int al = 0; al < albums; ++al)
+				{
+					const auto albumId = idsOffset + ar * albums + al;
+					auto album = std::make_shared<Collection::Album> ();
+					*album = { albumId, QString { "Album %1" }.arg (al), 2000 + al, {}, {} };
+					for (int tr = 0; tr < tracks; ++tr)
+						album->Tracks_.append ({
+								trackId++,
+								tr + 1,
+								QString { "Track %1" }.arg (tr),
+								180 + tr,
+								genres,
+								QString { "/music/%1/%2/%3.flac" }.arg (ar).arg (al).arg (tr)
+							});
+					artist.Albums_ << album;
+				}
+				result << artist;
+			}
+			return result;
+		}
+
+		qint64 GetRSSKiB ()
+		{
+			QFile file { "/proc/self/status" };
+			if (!file.open (QIODevice::ReadOnly))
+				return 0;
+
+			for (const auto& line : file.readAll ().split ('\n'))
+				if (line.startsWith ("VmRSS:"))
+					return line.mid (6).trimmed ().split (' ').value (0).toLongLong ();
+
+			return 0;
+		}
+
+		std::unique_ptr<LocalCollectionModel> MakeModel (const Collection::Artists_t& collection,
+				int *albumsQueries = nullptr, int *tracksQueries = nullptr)
+		{
+			QHash<int, QList<Collection::Album_ptr>> albums;
+			QHash<int, QList<Collection::Track>> tracks;
+			for (const auto& artist : collection)
+			{
+				albums [artist.ID_] = artist.Albums_;
+				for (const auto& album : artist.Albums_)
+					tracks [album->ID_] = album->Tracks_;
+			}
+
+			return std::make_unique<LocalCollectionModel> (
+					[albums, albumsQueries] (int id)
+					{
+						if (albumsQueries)
+							++*albumsQueries;
+						return albums.value (id);
+					},
+					[tracks, tracksQueries] (int id)
+					{
+						if (tracksQueries)
+							++*tracksQueries;
+						return tracks.value (id);
+					},
+					[] (int) { return Collection::TrackStats {}; },
+					nullptr);
+		}
+
+		// expands the whole tree like a view that's been asked to
+		void FetchAll (QAbstractItemModel& model, const QModelIndex& parent = {})
+		{
+			if (model.canFetchMore (parent))
+				model.fetchMore (parent);
+			for (int i = 0; i < model.rowCount (parent); ++i)
+				FetchAll (model, model.index (i, 0, parent));
+		}
+	}
+
+	void LocalCollectionModelTest::init ()
+	{
+		AlbumsQueries_ = 0;
+		TracksQueries_ = 0;
+
+		Collection_ = MakeCollection (2, 2, 3);
+		Model_ = MakeModel (Collection_, &AlbumsQueries_, &TracksQueries_);
+		Model_->AddArtists (Collection_);
+	}
+
+	void LocalCollectionModelTest::cleanup ()
+	{
+		Model_.reset ();
+	}
+
+	void LocalCollectionModelTest::testLazyFetch ()
+	{
+		QCOMPARE (AlbumsQueries_, 0);
+		QCOMPARE (TracksQueries_, 0);
+
+		const auto& artist = Model_->index (1, 0);
+		QVERIFY (Model_->hasChildren (artist));
+		QVERIFY (Model_->canFetchMore (artist));
+		QCOMPARE (Model_->rowCount (artist), 0);
+
+		QSignalSpy spy { Model_.get (), SIGNAL (rowsInserted (QModelIndex, int, int)) };
+		Model_->fetchMore (artist);
+		QCOMPARE (spy.size (), 1);
+		QCOMPARE (AlbumsQueries_, 1);
+		QCOMPARE (TracksQueries_, 0);
+		QVERIFY (!Model_->canFetchMore (artist));
+		QCOMPARE (Model_->rowCount (artist), 2);
+
+		const auto& album = Model_->index (0, 0, artist);
+		QVERIFY (Model_->canFetchMore (album));
+		Model_->fetchMore (album);
+		QCOMPARE (TracksQueries_, 1);
+		QCOMPARE (Model_->rowCount (album), 3);
+		QVERIFY (!Model_->hasChildren (Model_->index (0, 0, album)));
+
+		Model_->fetchMore (album);
+		QCOMPARE (TracksQueries_, 1);
+		QCOMPARE (Model_->rowCount (album), 3);
+	}
+
+	void LocalCollectionModelTest::testStructure ()
+	{
+		FetchAll (*Model_);
+
+		QCOMPARE (Model_->rowCount (), 2);
+
+		const auto& artist = Model_->index (1, 0);
+		QCOMPARE (Model_->rowCount (artist), 2);
+
+		const auto& album = Model_->index (1, 0, artist);
+		QCOMPARE (Model_->rowCount (album), 3);
+		QCOMPARE (Model_->parent (album), artist);
+
+		const auto& track = Model_->index (2, 0, album);
+		QCOMPARE (Model_->rowCount (track), 0);
+		QCOMPARE (Model_->parent (track), album);
+		QVERIFY (!Model_->parent (artist).isValid ());
+	}
+
+	void LocalCollectionModelTest::testRoles ()
+	{
+		FetchAll (*Model_);
+
+		const auto& artist = Model_->index (1, 0);
+		const auto& album = Model_->index (1, 0, artist);
+		const auto& track = Model_->index (2, 0, album);
+
+		QCOMPARE (artist.data ().toString (), QString { "Artist 1" });
+		QCOMPARE (artist.data (LocalCollectionModel::Role::Node).toInt (),
+				static_cast<int> (LocalCollectionModel::NodeType::Artist));
+
+		QCOMPARE (album.data ().toString (), QString::fromUtf8 ("2001 — Album 1"));
+		QCOMPARE (album.data (LocalCollectionModel::Role::ArtistName).toString (), QString { "Artist 1" });
+		QCOMPARE (album.data (LocalCollectionModel::Role::AlbumYear).toInt (), 2001);
+
+		QCOMPARE (track.data ().toString (), QString::fromUtf8 ("3 — Track 2"));
+		QCOMPARE (track.data (LocalCollectionModel::Role::ArtistName).toString (), QString { "Artist 1" });
+		QCOMPARE (track.data (LocalCollectionModel::Role::AlbumName).toString (), QString { "Album 1" });
+		QCOMPARE (track.data (LocalCollectionModel::Role::TrackPath).toString (), QString { "/music/1/1/2.flac" });
+		QCOMPARE (track.data (LocalCollectionModel::Role::TrackLength).toInt (), 182);
+		QCOMPARE (track.data (LocalCollectionModel::Role::TrackGenres).toStringList (), (QStringList { "rock", "metal" }));
+
+		QCOMPARE (track.data (LocalCollectionModel::Role::ArtistID).toInt (), Collection_ [1].ID_);
+		QCOMPARE (track.data (LocalCollectionModel::Role::AlbumID).toInt (), Collection_ [1].Albums_ [1]->ID_);
+		QVERIFY (artist.data (LocalCollectionModel::Role::AlbumID).isNull ());
+		QCOMPARE (Model_->ToSourceUrls ({ album }).size (), 3);
+	}
+
+	void LocalCollectionModelTest::testIncrementalAdd ()
+	{
+		FetchAll (*Model_);
+
+		QSignalSpy spy { Model_.get (), SIGNAL (rowsInserted (QModelIndex, int, int)) };
+
+		// only the artist row, its albums and tracks are fetched on demand
+		Model_->AddArtists (MakeCollection (1, 1, 1, 1000));
+		QCOMPARE (Model_->rowCount (), 3);
+		QCOMPARE (spy.size (), 1);
+
+		Model_->AddArtists (Collection_);
+		QCOMPARE (Model_->rowCount (), 3);
+		QCOMPARE (spy.size (), 1);
+
+		// a new track in an already fetched album is added right away
+		auto album = std::make_shared<Collection::Album> (*Collection_ [0].Albums_ [0]);
+		album->Tracks_ = { { 500, 4, "Track 3", 183, {}, "/music/0/0/3.flac" } };
+		Model_->AddArtists ({ { Collection_ [0].ID_, Collection_ [0].Name_, { album } } });
+		QCOMPARE (spy.size (), 2);
+		QCOMPARE (Model_->rowCount (Model_->index (0, 0, Model_->index (0, 0))), 4);
+	}
+
+	void LocalCollectionModelTest::testRemoveTrack ()
+	{
+		FetchAll (*Model_);
+
+		const auto& album = Model_->index (0, 0, Model_->index (0, 0));
+		const auto trackId = Model_->index (1, 0, album).data (LocalCollectionModel::Role::TrackID).toInt ();
+		const auto lastId = Model_->index (2, 0, album).data (LocalCollectionModel::Role::TrackID).toInt ();
+
+		Model_->RemoveTrack (trackId);
+		QCOMPARE (Model_->rowCount (album), 2);
+		QCOMPARE (Model_->ToSourceUrls ({ album }).size (), 2);
+		QCOMPARE (Model_->index (1, 0, album).data (LocalCollectionModel::Role::TrackID).toInt (), lastId);
+		QCOMPARE (Model_->parent (Model_->index (1, 0, album)).row (), 0);
+	}
+
+	void LocalCollectionModelTest::testRemoveArtist ()
+	{
+		Model_->RemoveArtist (0);
+		QCOMPARE (Model_->rowCount (), 1);
+		QCOMPARE (Model_->index (0, 0).data ().toString (), QString { "Artist 1" });
+
+		Model_->AddArtists (MakeCollection (1, 1, 1));
+		QCOMPARE (Model_->rowCount (), 2);
+
+		const auto& readded = Model_->index (1, 0);
+		QVERIFY (Model_->canFetchMore (readded));
+		Model_->fetchMore (readded);
+		QCOMPARE (Model_->rowCount (readded), 2);
+	}
+
+	void LocalCollectionModelTest::testIgnoreTrack ()
+	{
+		QSignalSpy spy { Model_.get (), SIGNAL (dataChanged (QModelIndex, QModelIndex, QVector<int>)) };
+
+		// not fetched yet, so there is no row to update
+		Model_->IgnoreTrack (0);
+		QCOMPARE (spy.size (), 0);
+
+		FetchAll (*Model_);
+		const auto& album = Model_->index (0, 0, Model_->index (0, 0));
+		QVERIFY (Model_->index (0, 0, album).data (LocalCollectionModel::Role::IsTrackIgnored).toBool ());
+
+		Model_->IgnoreTrack (1);
+		QCOMPARE (spy.size (), 1);
+		QVERIFY (Model_->index (1, 0, album).data (LocalCollectionModel::Role::IsTrackIgnored).toBool ());
+	}
+
+	void LocalCollectionModelTest::testUnfetchedPaths ()
+	{
+		const auto& artist = Model_->index (0, 0);
+		QCOMPARE (Model_->ToSourceUrls ({ artist }).size (), 6);
+		QCOMPARE (Model_->ToSourceUrls ({ artist }).value (0), QUrl::fromLocalFile ("/music/0/0/0.flac"));
+
+		// collecting the paths doesn't populate the tree
+		QCOMPARE (Model_->rowCount (artist), 0);
+		QVERIFY (Model_->canFetchMore (artist));
+	}
+
+	void LocalCollectionModelTest::benchStartup ()
+	{
+		const int ArtistsCount = 4000;
+		const int AlbumsPerArtist = 10;
+		const int TracksPerAlbum = 10;
+
+		const auto& collection = MakeCollection (ArtistsCount, AlbumsPerArtist, TracksPerAlbum);
+
+		QElapsedTimer timer;
+		const auto rssBefore = GetRSSKiB ();
+		timer.start ();
+
+		const auto model = MakeModel (collection);
+		model->AddArtists (collection);
+
+		qDebug () << "built the tree of"
+				<< ArtistsCount * AlbumsPerArtist * TracksPerAlbum
+				<< "tracks in"
+				<< timer.elapsed ()
+				<< "ms, RSS grew by"
+				<< (GetRSSKiB () - rssBefore) / 1024
+				<< "MiB";
+
+		QCOMPARE (model->rowCount (), ArtistsCount);
+		QCOMPARE (model->rowCount (model->index (0, 0)), 0);
+
+		timer.restart ();
+		const auto& artist = model->index (0, 0);
+		model->fetchMore (artist);
+		model->fetchMore (model->index (0, 0, artist));
+		qDebug () << "expanded an album in"
+				<< timer.nsecsElapsed () / 1000
+				<< "us";
+
+		QCOMPARE (model->rowCount (artist), AlbumsPerArtist);
+	}
+}
+}
@@ -53,34 +53,52 @@ namespace LeechCraft
 {
 namespace LMP
 {
-	QList<QFileInfo> RecIterateInfo (const QString& dirPath, bool followSymlinks, std::atomic<bool> *stopFlag)
+	namespace
 	{
-		static const QStringList nameFilters
+		const QStringList& GetAudioNameFilters ()
 		{
-			"*.aiff",
-			"*.ape",
-			"*.asf",
-			"*.flac",
-			"*.m4a",
-			"*.mp3",
-			"*.mp4",
-			"*.mpc",
-			"*.mpeg",
-			"*.mpg",
-			"*.ogg",
-			"*.tta",
-			"*.wav",
-			"*.wma",
-			"*.wv",
-			"*.wvp"
-		};
+			static const QStringList nameFilters
+			{
+				"*.aiff",
+				"*.ape",
+				"*.asf",
+				"*.flac",
+				"*.m4a",
+				"*.mp3",
+				"*.mp4",
+				"*.mpc",
+				"*.mpeg",
+				"*.mpg",
+				"*.ogg",
+				"*.tta",
+				"*.wav",
+				"*.wma",
+				"*.wv",
+				"*.wvp"
+			};
+
+			return nameFilters;
+		}
+	}
+
+	bool IsAudioFilePath (const QString& path)
+	{
+		for (const auto& filter : GetAudioNameFilters ())
+			if (path.endsWith (filter.midRef (1), Qt::CaseInsensitive))
+				return true;
+
+		return false;
+	}
+
+	QList<QFileInfo> RecIterateInfo (const QString& dirPath, bool followSymlinks, std::atomic<bool> *stopFlag)
+	{
+		const auto& nameFilters = GetAudioNameFilters ();
 
 		const QFileInfo dirInfo (dirPath);
 		if (dirInfo.isFile ())
 		{
-			for (const auto& filter : nameFilters)
-				if (dirPath.endsWith (filter.mid (1), Qt::CaseInsensitive))
-					return { dirInfo };
+			if (IsAudioFilePath (dirPath))
+				return { dirInfo };
 
 			return {};
 		}
@@ -249,22 +267,6 @@ namespace LMP
 		return { isEnabled ? flagSym : disabledFlagSym, color };
 	}
 
-	QString FormatDateTime (const QDateTime& datetime)
-	{
-		const QDateTime& current = QDateTime::currentDateTime ();
-		const int days = datetime.daysTo (current);
-
-		QLocale defLocale;
-		if (days > 30)
-			return defLocale.toString (datetime, "MMMM yyyy");
-		else if (days >= 7)
-			return QObject::tr ("%n day(s) ago", 0, days);
-		else if (days >= 1)
-			return defLocale.toString (datetime, "dddd");
-		else
-			return defLocale.toString (datetime.time ());
-	}
-
 	namespace
 	{
 		void PerformDownload (QString to,
@@ -48,6 +48,8 @@ namespace LMP
 {
 	struct MediaInfo;
 
+	bool IsAudioFilePath (const QString&);
+
 	QList<QFileInfo> RecIterateInfo (const QString& dirPath,
 			bool followSymlinks = false, std::atomic<bool> *stopFlag = nullptr);
 	QStringList RecIterate (const QString& dirPath, bool followSymlinks = false);
@@ -79,8 +81,6 @@ namespace LMP
 
 	QPair<QString, QColor> GetRuleSymbol (const Entity&);
 
-	QString FormatDateTime (const QDateTime& datetime);
-
 	void GrabTracks (const QList<Media::AudioInfo>& infos, QWidget *parent = nullptr);
 	void GrabTracks (const QList<MediaInfo>& infos, QWidget *parent = nullptr);
 }
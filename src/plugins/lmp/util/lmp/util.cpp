@@ -28,6 +28,9 @@
  **********************************************************************/
 
 #include "util.h"
+#include <QDateTime>
+#include <QLocale>
+#include <QObject>
 #include <util/util.h>
 #include <util/sll/qtutil.h>
 #include <interfaces/lmp/mediainfo.h>
@@ -121,5 +124,21 @@ namespace LMP
 
 		return names;
 	}
+
+	QString FormatDateTime (const QDateTime& datetime)
+	{
+		const QDateTime& current = QDateTime::currentDateTime ();
+		const int days = datetime.daysTo (current);
+
+		QLocale defLocale;
+		if (days > 30)
+			return defLocale.toString (datetime, "MMMM yyyy");
+		else if (days >= 7)
+			return QObject::tr ("%n day(s) ago", 0, days);
+		else if (days >= 1)
+			return defLocale.toString (datetime, "dddd");
+		else
+			return defLocale.toString (datetime.time ());
+	}
 }
 }
@@ -36,6 +36,8 @@
 template<typename, typename>
 class QMap;
 
+class QDateTime;
+
 namespace LeechCraft
 {
 namespace LMP
@@ -62,6 +64,8 @@ namespace LMP
 			const QList<MediaInfo>& infos,
 			const std::function<void (int, QString)>& setter,
 			SubstitutionFlags flags = SFSafeFilesystem);
+
+	QString FormatDateTime (const QDateTime& datetime);
 }
 }
 
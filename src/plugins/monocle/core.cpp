@@ -34,6 +34,7 @@
 #include <interfaces/iplugin2.h>
 #include "interfaces/monocle/iredirectproxy.h"
 #include "pixmapcachemanager.h"
+#include "renderqueue.h"
 #include "recentlyopenedmanager.h"
 #include "defaultbackendmanager.h"
 #include "docstatemanager.h"
@@ -46,6 +47,7 @@ namespace Monocle
 {
 	Core::Core ()
 	: CacheManager_ (new PixmapCacheManager (this))
+	, RenderQueue_ (new RenderQueue (this))
 	, ROManager_ (new RecentlyOpenedManager (this))
 	, DefaultBackendManager_ (new DefaultBackendManager (this))
 	, DocStateManager_ (new DocStateManager (this))
@@ -168,6 +170,11 @@ namespace Monocle
 		return CacheManager_;
 	}
 
+	RenderQueue* Core::GetRenderQueue () const
+	{
+		return RenderQueue_;
+	}
+
 	RecentlyOpenedManager* Core::GetROManager () const
 	{
 		return ROManager_;
@@ -30,6 +30,7 @@
 #include "pagegraphicsitem.h"
 #include <limits>
 #include <cmath>
+#include <algorithm>
 #include <QtDebug>
 #include <QtConcurrentRun>
 #include <QFutureWatcher>
@@ -40,10 +41,14 @@
 #include <QGraphicsView>
 #include <QMenu>
 #include <QWidgetAction>
+#include <QPainter>
 #include <interfaces/core/iiconthememanager.h>
 #include <util/threads/futures.h>
+#include "interfaces/monocle/isupportregionrendering.h"
 #include "core.h"
 #include "pixmapcachemanager.h"
+#include "renderqueue.h"
+#include "xmlsettingsmanager.h"
 #include "arbitraryrotationwidget.h"
 #include "pageslayoutmanager.h"
 
@@ -51,6 +56,19 @@ namespace LeechCraft
 {
 namespace Monocle
 {
+	namespace
+	{
+		const int TileSize = 512;
+
+		// Pages with more pixels than this are rendered in tiles.
+		const qreal TiledAreaThreshold = 4 * 1024 * 1024;
+
+		const qreal PlaceholderArea = 512 * 1024;
+
+		// Tiles this close to the viewport are rendered in advance.
+		const int PrefetchMargin = TileSize;
+	}
+
 	PageGraphicsItem::PageGraphicsItem (IDocument_ptr doc, int page, QGraphicsItem *parent)
 	: QGraphicsPixmapItem (parent)
 	, Doc_ (doc)
@@ -64,6 +82,7 @@ namespace Monocle
 
 	PageGraphicsItem::~PageGraphicsItem ()
 	{
+		Core::Instance ().GetRenderQueue ()->Cancel (this);
 		Core::Instance ().GetPixmapCacheManager ()->PixmapDeleted (this);
 	}
 
@@ -140,6 +159,9 @@ namespace Monocle
 	{
 		setPixmap (QPixmap { QSize { 1, 1 } });
 
+		InvalidateRendered ();
+		Placeholder_ = {};
+
 		Invalid_ = true;
 	}
 
@@ -157,22 +179,38 @@ namespace Monocle
 		{
 			Invalid_ = false;
 
-			setPixmap (GetEmptyPixmap (true));
+			InvalidateRendered ();
 
-			Util::Sequence (this, Doc_->RenderPage (PageNum_, XScale_, YScale_)) >>
-					[&, prevXScale = XScale_, prevYScale = YScale_] (const QImage& img)
-					{
-						setPixmap (QPixmap::fromImage (img));
-
-						if (std::abs (prevXScale - XScale_) > std::numeric_limits<double>::epsilon () * XScale_ ||
-							std::abs (prevYScale - YScale_) > std::numeric_limits<double>::epsilon () * YScale_)
-							UpdatePixmap ();
-						else
-							Core::Instance ().GetPixmapCacheManager ()->PixmapChanged (this);
-					};
+			Tiled_ = ShouldRenderTiled ();
+			if (Tiled_)
+				setPixmap ({});
+			else
+			{
+				Placeholder_ = {};
+
+				setPixmap (GetEmptyPixmap (true));
+
+				Util::Sequence (this, Doc_->RenderPage (PageNum_, XScale_, YScale_)) >>
+						[&, prevXScale = XScale_, prevYScale = YScale_, gen = Generation_] (const QImage& img)
+						{
+							if (gen != Generation_)
+								return;
+
+							setPixmap (QPixmap::fromImage (img));
+
+							if (std::abs (prevXScale - XScale_) > std::numeric_limits<double>::epsilon () * XScale_ ||
+								std::abs (prevYScale - YScale_) > std::numeric_limits<double>::epsilon () * YScale_)
+								UpdatePixmap ();
+							else
+								Core::Instance ().GetPixmapCacheManager ()->PixmapChanged (this);
+						};
+			}
 		}
 
-		QGraphicsPixmapItem::paint (painter, option, w);
+		if (Tiled_)
+			PaintTiled (painter);
+		else
+			QGraphicsPixmapItem::paint (painter, option, w);
 		Core::Instance ().GetPixmapCacheManager ()->PixmapPainted (this);
 	}
 
@@ -238,6 +276,206 @@ namespace Monocle
 		return px;
 	}
 
+	void PageGraphicsItem::InvalidateRendered ()
+	{
+		++Generation_;
+
+		Tiles_.clear ();
+		RequestedTiles_.clear ();
+
+		// The placeholder is kept to be painted until the new one is ready.
+		PlaceholderRequested_ = false;
+
+		Core::Instance ().GetRenderQueue ()->Cancel (this);
+	}
+
+	bool PageGraphicsItem::ShouldRenderTiled () const
+	{
+		if (!XmlSettingsManager::Instance ().property ("TiledRendering").toBool ())
+			return false;
+
+		if (!qobject_cast<ISupportRegionRendering*> (Doc_->GetQObject ()))
+			return false;
+
+		const auto& size = boundingRect ().size ();
+		return size.width () * size.height () > TiledAreaThreshold;
+	}
+
+	QRectF PageGraphicsItem::GetVisibleRect () const
+	{
+		QRectF result;
+		for (auto view : scene ()->views ())
+		{
+			const auto& viewRect = view->mapToScene (view->viewport ()->rect ()).boundingRect ();
+			result = result.united (mapFromScene (viewRect).boundingRect ());
+		}
+		return result.intersected (boundingRect ());
+	}
+
+	boost::optional<double> PageGraphicsItem::GetRenderPriority (const QRectF& rect) const
+	{
+		if (!scene ())
+			return {};
+
+		const auto& sceneRect = mapToScene (rect).boundingRect ();
+		const auto& prefetchRect = sceneRect.adjusted (-PrefetchMargin, -PrefetchMargin,
+				PrefetchMargin, PrefetchMargin);
+
+		boost::optional<double> result;
+		for (auto view : scene ()->views ())
+		{
+			const auto& viewRect = view->mapToScene (view->viewport ()->rect ()).boundingRect ();
+			if (!viewRect.intersects (prefetchRect))
+				continue;
+
+			const auto& diff = sceneRect.center () - viewRect.center ();
+			const auto dist = std::hypot (diff.x (), diff.y ());
+			if (!result || dist < *result)
+				result = dist;
+		}
+		return result;
+	}
+
+	QRect PageGraphicsItem::GetTileRect (const TileIndex_t& index) const
+	{
+		const QRect pageRect { { 0, 0 }, boundingRect ().size ().toSize () };
+		const QRect tileRect { index.first * TileSize, index.second * TileSize, TileSize, TileSize };
+		return tileRect.intersected (pageRect);
+	}
+
+	void PageGraphicsItem::PaintTiled (QPainter *painter)
+	{
+		const auto& bounding = boundingRect ();
+
+		if (!PlaceholderRequested_)
+			RequestPlaceholder ();
+
+		if (Placeholder_.isNull ())
+			painter->fillRect (bounding, Qt::white);
+		else
+			painter->drawPixmap (bounding, Placeholder_, Placeholder_.rect ());
+
+		const auto& visible = GetVisibleRect ();
+		if (visible.isEmpty ())
+			return;
+
+		const QRectF pageRect { { 0, 0 }, bounding.size () };
+		const auto& wanted = visible.translated (-offset ())
+				.adjusted (-PrefetchMargin, -PrefetchMargin, PrefetchMargin, PrefetchMargin)
+				.intersected (pageRect);
+
+		// right () and bottom () are exclusive for QRectF
+		const auto firstCol = std::max (0, static_cast<int> (wanted.left ()) / TileSize);
+		const auto lastCol = (static_cast<int> (std::ceil (wanted.right ())) - 1) / TileSize;
+		const auto firstRow = std::max (0, static_cast<int> (wanted.top ()) / TileSize);
+		const auto lastRow = (static_cast<int> (std::ceil (wanted.bottom ())) - 1) / TileSize;
+
+		for (int row = firstRow; row <= lastRow; ++row)
+			for (int col = firstCol; col <= lastCol; ++col)
+			{
+				const TileIndex_t index { col, row };
+
+				const auto& tileRect = GetTileRect (index);
+				if (tileRect.isEmpty ())
+					continue;
+
+				const auto pos = Tiles_.constFind (index);
+				if (pos != Tiles_.constEnd ())
+					painter->drawPixmap (tileRect.topLeft () + offset (), *pos);
+				else if (!RequestedTiles_.contains (index))
+					RequestTile (index);
+			}
+
+		EvictTiles (wanted);
+	}
+
+	void PageGraphicsItem::RequestTile (const TileIndex_t& index)
+	{
+		RequestedTiles_ << index;
+
+		const auto& rect = GetTileRect (index);
+		Core::Instance ().GetRenderQueue ()->Enqueue (this,
+				[doc = Doc_, page = PageNum_, xs = XScale_, ys = YScale_, rect]
+				{
+					const auto isrr = qobject_cast<ISupportRegionRendering*> (doc->GetQObject ());
+					return isrr->RenderPageRegion (page, xs, ys, rect);
+				},
+				[this, rect] { return GetRenderPriority (QRectF { rect }.translated (offset ())); },
+				[this, index, rect, gen = Generation_] (const QImage& img)
+				{
+					if (gen != Generation_)
+						return;
+
+					if (img.isNull ())
+					{
+						RequestedTiles_.remove (index);
+						return;
+					}
+
+					Tiles_ [index] = QPixmap::fromImage (img);
+					Core::Instance ().GetPixmapCacheManager ()->PixmapChanged (this);
+					update (QRectF { rect }.translated (offset ()));
+				});
+	}
+
+	void PageGraphicsItem::RequestPlaceholder ()
+	{
+		PlaceholderRequested_ = true;
+
+		const auto& size = boundingRect ().size ();
+		const auto factor = std::min (std::sqrt (PlaceholderArea / (size.width () * size.height ())), 1.);
+
+		Core::Instance ().GetRenderQueue ()->Enqueue (this,
+				[doc = Doc_, page = PageNum_, xs = XScale_ * factor, ys = YScale_ * factor]
+					{ return doc->RenderPage (page, xs, ys); },
+				[this] () -> boost::optional<double>
+				{
+					if (!IsDisplayed ())
+						return {};
+					return -1.0;
+				},
+				[this, gen = Generation_] (const QImage& img)
+				{
+					if (gen != Generation_)
+						return;
+
+					if (img.isNull ())
+					{
+						PlaceholderRequested_ = false;
+						return;
+					}
+
+					if (!Tiled_)
+						return;
+
+					Placeholder_ = QPixmap::fromImage (img);
+					Core::Instance ().GetPixmapCacheManager ()->PixmapChanged (this);
+					update ();
+				});
+	}
+
+	void PageGraphicsItem::EvictTiles (const QRectF& wanted)
+	{
+		const auto& kept = wanted.adjusted (-2 * TileSize, -2 * TileSize, 2 * TileSize, 2 * TileSize);
+
+		bool evicted = false;
+		for (auto i = Tiles_.begin (); i != Tiles_.end (); )
+		{
+			if (kept.intersects (GetTileRect (i.key ())))
+			{
+				++i;
+				continue;
+			}
+
+			RequestedTiles_.remove (i.key ());
+			i = Tiles_.erase (i);
+			evicted = true;
+		}
+
+		if (evicted)
+			Core::Instance ().GetPixmapCacheManager ()->PixmapChanged (this);
+	}
+
 	bool PageGraphicsItem::IsDisplayed () const
 	{
 		const auto& thisMapped = mapToScene (boundingRect ()).boundingRect ();
@@ -254,6 +492,11 @@ namespace Monocle
 		return false;
 	}
 
+	QList<QPixmap> PageGraphicsItem::GetCachedPixmaps () const
+	{
+		return QList<QPixmap> { pixmap (), Placeholder_ } + Tiles_.values ();
+	}
+
 	QRectF PageGraphicsItem::boundingRect () const
 	{
 		auto size = Doc_->GetPageSize (PageNum_);
@@ -33,6 +33,9 @@
 #include <memory>
 #include <QGraphicsPixmapItem>
 #include <QPointer>
+#include <QHash>
+#include <QSet>
+#include <boost/optional.hpp>
 #include "interfaces/monocle/idocument.h"
 
 template<typename T>
@@ -58,6 +61,20 @@ namespace Monocle
 
 		bool Invalid_ = true;
 
+		/** Bumped each time the rendered pixmaps become stale, so that
+		 * the results of the outdated requests are ignored.
+		 */
+		quint64 Generation_ = 0;
+
+		bool Tiled_ = false;
+
+		using TileIndex_t = QPair<int, int>;
+		QHash<TileIndex_t, QPixmap> Tiles_;
+		QSet<TileIndex_t> RequestedTiles_;
+
+		QPixmap Placeholder_;
+		bool PlaceholderRequested_ = false;
+
 		std::function<void (int, QPointF)> ReleaseHandler_;
 
 		PagesLayoutManager *LayoutManager_ = nullptr;
@@ -94,6 +111,8 @@ namespace Monocle
 
 		bool IsDisplayed () const;
 
+		QList<QPixmap> GetCachedPixmaps () const;
+
 		QRectF boundingRect () const;
 		QPainterPath shape () const;
 	protected:
@@ -103,6 +122,18 @@ namespace Monocle
 		void contextMenuEvent (QGraphicsSceneContextMenuEvent*);
 	private:
 		QPixmap GetEmptyPixmap (bool fill) const;
+
+		void InvalidateRendered ();
+		bool ShouldRenderTiled () const;
+
+		QRectF GetVisibleRect () const;
+		boost::optional<double> GetRenderPriority (const QRectF&) const;
+
+		QRect GetTileRect (const TileIndex_t&) const;
+		void PaintTiled (QPainter*);
+		void RequestTile (const TileIndex_t&);
+		void RequestPlaceholder ();
+		void EvictTiles (const QRectF&);
 	private slots:
 		void rotateCCW ();
 		void rotateCW ();
@@ -54,6 +54,14 @@ namespace Monocle
 
 			return px.width () * px.height () * px.defaultDepth () / 8 * 1.5;
 		}
+
+		quint64 GetItemSize (const PageGraphicsItem *item)
+		{
+			quint64 result = 0;
+			for (const auto& px : item->GetCachedPixmaps ())
+				result += GetPixmapSize (px);
+			return result;
+		}
 	}
 
 	void PixmapCacheManager::PixmapPainted (PageGraphicsItem *item)
@@ -67,16 +75,16 @@ namespace Monocle
 		if (RecentlyUsed_.removeAll (item))
 			CurrentSize_ = std::accumulate (RecentlyUsed_.begin (), RecentlyUsed_.end (), 0,
 					[] (qint64 size, const PageGraphicsItem *item)
-						{ return size + GetPixmapSize (item->pixmap ()); });
+						{ return size + GetItemSize (item); });
 
 		RecentlyUsed_ << item;
-		CurrentSize_ += GetPixmapSize (item->pixmap ());
+		CurrentSize_ += GetItemSize (item);
 		CheckCache ();
 	}
 
 	void PixmapCacheManager::PixmapDeleted (PageGraphicsItem *item)
 	{
-		CurrentSize_ -= GetPixmapSize (item->pixmap ());
+		CurrentSize_ -= GetItemSize (item);
 		RecentlyUsed_.removeAll (item);
 	}
 
@@ -91,7 +99,7 @@ namespace Monocle
 				continue;
 			}
 
-			const quint64 pxSize = GetPixmapSize (page->pixmap ());
+			const quint64 pxSize = GetItemSize (page);
 			CurrentSize_ -= pxSize;
 			page->ClearPixmap ();
 			i = RecentlyUsed_.erase (i);
@@ -32,6 +32,7 @@
 #include <cstring>
 #include <QPainter>
 #include <QtDebug>
+#include <util/threads/futures.h>
 
 namespace LeechCraft
 {
@@ -106,7 +107,27 @@ namespace Mu
 				rect.y1 - rect.y0);
 	}
 
-	QImage Document::RenderPage (int num, double xRes, double yRes)
+	QFuture<QImage> Document::RenderPage (int num, double xRes, double yRes)
+	{
+		return Util::MakeReadyFuture (RenderImpl (num, xRes, yRes, {}));
+	}
+
+	QList<ILink_ptr> Document::GetPageLinks (int)
+	{
+		return QList<ILink_ptr> ();
+	}
+
+	QUrl Document::GetDocURL () const
+	{
+		return URL_;
+	}
+
+	QFuture<QImage> Document::RenderPageRegion (int num, double xRes, double yRes, const QRect& rect)
+	{
+		return Util::MakeReadyFuture (RenderImpl (num, xRes, yRes, rect));
+	}
+
+	QImage Document::RenderImpl (int num, double xRes, double yRes, QRect region)
 	{
 		auto page = WrapPage (pdf_load_page (MuDoc_, num), MuDoc_);
 		if (!page)
@@ -119,14 +140,27 @@ namespace Mu
 		pdf_bound_page (MuDoc_, page.get (), &rect);
 #endif
 
-		auto px = fz_new_pixmap (MuCtx_, fz_device_bgr, xRes * (rect.x1 - rect.x0), yRes * (rect.y1 - rect.y0));
+		const QRect fullRect { 0, 0,
+				static_cast<int> (xRes * (rect.x1 - rect.x0)),
+				static_cast<int> (yRes * (rect.y1 - rect.y0)) };
+		region = region.isNull () ? fullRect : region.intersected (fullRect);
+		if (region.isEmpty ())
+			return QImage ();
+
+		auto px = fz_new_pixmap (MuCtx_, fz_device_bgr, region.width (), region.height ());
 		fz_clear_pixmap (MuCtx_, px);
 		auto dev = fz_new_draw_device (MuCtx_, px);
 #if MUPDF_VERSION < 0x0102
-		pdf_run_page (MuDoc_, page.get (), dev, fz_scale (xRes, yRes), NULL);
+		const auto& matrix = fz_concat (fz_scale (xRes, yRes), fz_translate (-region.x (), -region.y ()));
+		pdf_run_page (MuDoc_, page.get (), dev, matrix, NULL);
 #else
+		fz_matrix scale;
+		fz_matrix translate;
 		fz_matrix matrix;
-		pdf_run_page (MuDoc_, page.get (), dev, fz_scale (&matrix, xRes, yRes), NULL);
+		fz_scale (&scale, xRes, yRes);
+		fz_translate (&translate, -region.x (), -region.y ());
+		fz_concat (&matrix, &scale, &translate);
+		pdf_run_page (MuDoc_, page.get (), dev, &matrix, NULL);
 #endif
 		fz_free_device (dev);
 
@@ -155,16 +189,6 @@ namespace Mu
 		p.end ();
 		return temp;
 	}
-
-	QList<ILink_ptr> Document::GetPageLinks (int)
-	{
-		return QList<ILink_ptr> ();
-	}
-
-	QUrl Document::GetDocURL () const
-	{
-		return URL_;
-	}
 }
 }
 }
@@ -38,6 +38,7 @@ extern "C"
 }
 
 #include <interfaces/monocle/idocument.h>
+#include <interfaces/monocle/isupportregionrendering.h>
 
 namespace LeechCraft
 {
@@ -47,9 +48,11 @@ namespace Mu
 {
 	class Document : public QObject
 				   , public IDocument
+				   , public ISupportRegionRendering
 	{
 		Q_OBJECT
-		Q_INTERFACES (LeechCraft::Monocle::IDocument)
+		Q_INTERFACES (LeechCraft::Monocle::IDocument
+				LeechCraft::Monocle::ISupportRegionRendering)
 
 		fz_context *MuCtx_;
 		pdf_document *MuDoc_;
@@ -67,9 +70,13 @@ namespace Mu
 		DocumentInfo GetDocumentInfo () const;
 		int GetNumPages () const;
 		QSize GetPageSize (int) const;
-		QImage RenderPage (int, double xRes, double yRes);
+		QFuture<QImage> RenderPage (int, double xRes, double yRes);
 		QList<ILink_ptr> GetPageLinks (int);
 		QUrl GetDocURL () const;
+
+		QFuture<QImage> RenderPageRegion (int, double xRes, double yRes, const QRect&);
+	private:
+		QImage RenderImpl (int, double xRes, double yRes, QRect);
 	signals:
 		void navigateRequested (const QString& , int pageNum, double x, double y);
 		void printRequested (const QList<int>&);
@@ -239,6 +239,19 @@ namespace PDF
 		page->renderToPainter (painter, 72 * xScale, 72 * yScale);
 	}
 
+	QFuture<QImage> Document::RenderPageRegion (int num, double xScale, double yScale, const QRect& rect)
+	{
+		std::shared_ptr<Poppler::Page> page (PDocument_->page (num));
+		if (!page)
+			return Util::MakeReadyFuture (QImage {});
+
+		return QtConcurrent::run ([=]
+				{
+					return page->renderToImage (72 * xScale, 72 * yScale,
+							rect.x (), rect.y (), rect.width (), rect.height ());
+				});
+	}
+
 	QMap<int, QList<QRectF>> Document::GetTextPositions (const QString& text, Qt::CaseSensitivity cs)
 	{
 		typedef QMap<int, QList<QRectF>> Result_t;
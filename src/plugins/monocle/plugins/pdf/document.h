@@ -41,6 +41,7 @@
 #include <interfaces/monocle/isearchabledocument.h>
 #include <interfaces/monocle/isaveabledocument.h>
 #include <interfaces/monocle/isupportpainting.h>
+#include <interfaces/monocle/isupportregionrendering.h>
 #include <interfaces/monocle/ihaveoptionalcontent.h>
 
 namespace Poppler
@@ -65,6 +66,7 @@ namespace PDF
 				   , public ISupportAnnotations
 				   , public ISupportForms
 				   , public ISupportPainting
+				   , public ISupportRegionRendering
 				   , public ISearchableDocument
 				   , public ISaveableDocument
 	{
@@ -77,6 +79,7 @@ namespace PDF
 				LeechCraft::Monocle::ISupportAnnotations
 				LeechCraft::Monocle::ISupportForms
 				LeechCraft::Monocle::ISupportPainting
+				LeechCraft::Monocle::ISupportRegionRendering
 				LeechCraft::Monocle::ISearchableDocument
 				LeechCraft::Monocle::ISaveableDocument)
 
@@ -112,6 +115,8 @@ namespace PDF
 
 		void PaintPage (QPainter*, int, double, double);
 
+		QFuture<QImage> RenderPageRegion (int, double, double, const QRect&);
+
 		QMap<int, QList<QRectF>> GetTextPositions (const QString&, Qt::CaseSensitivity);
 
 		SaveQueryResult CanSave () const;
@@ -28,6 +28,7 @@
  **********************************************************************/
 
 #include "document.h"
+#include <algorithm>
 #include <QTimer>
 #include <QtConcurrentMap>
 #include <util/threads/futures.h>
@@ -118,16 +119,7 @@ namespace Seen
 			return Util::MakeReadyFuture (scaled);
 		}
 
-		if (!PendingRenders_.contains (pageNum))
-		{
-			const auto page = ddjvu_page_create_by_pageno (Doc_, pageNum);
-			PendingRenders_ [pageNum] = page;
-			PendingRendersNums_ [page] = pageNum;
-
-			ScheduleRedraw (pageNum, 100);
-		}
-
-		return RenderJobs_ [pageNum] [{ xScale, yScale }].future ();
+		return ScheduleRender (pageNum, xScale, yScale, {});
 	}
 
 	QList<ILink_ptr> Document::GetPageLinks (int)
@@ -140,6 +132,14 @@ namespace Seen
 		return DocURL_;
 	}
 
+	QFuture<QImage> Document::RenderPageRegion (int pageNum, double xScale, double yScale, const QRect& rect)
+	{
+		if (DebugRedraws ())
+			qDebug () << Q_FUNC_INFO << pageNum << xScale << yScale << rect;
+
+		return ScheduleRender (pageNum, xScale, yScale, rect);
+	}
+
 	ddjvu_document_t* Document::GetNativeDoc () const
 	{
 		return Doc_;
@@ -167,6 +167,30 @@ namespace Seen
 		ScheduleRedraw (PendingRendersNums_ [page], 100);
 	}
 
+	QFuture<QImage> Document::ScheduleRender (int pageNum, double xScale, double yScale, const QRect& rect)
+	{
+		if (!PendingRenders_.contains (pageNum))
+		{
+			const auto page = ddjvu_page_create_by_pageno (Doc_, pageNum);
+			PendingRenders_ [pageNum] = page;
+			PendingRendersNums_ [page] = pageNum;
+
+			ScheduleRedraw (pageNum, 100);
+		}
+
+		auto& jobs = RenderJobs_ [pageNum];
+		const auto pos = std::find_if (jobs.begin (), jobs.end (),
+				[&] (const RenderJob& job)
+				{
+					return job.XScale_ == xScale && job.YScale_ == yScale && job.Rect_ == rect;
+				});
+		if (pos != jobs.end ())
+			return pos->Future_.future ();
+
+		jobs.append ({ xScale, yScale, rect, {} });
+		return jobs.last ().Future_.future ();
+	}
+
 	void Document::ScheduleRedraw (int page, int timeoutHint)
 	{
 		if (ScheduledRedraws_.isEmpty ())
@@ -214,7 +238,7 @@ namespace Seen
 		{
 			int PageNum_;
 			ddjvu_page_t *Page_;
-			RenderJobsPerScale_t RenderJobs_;
+			QList<RenderJob> RenderJobs_;
 			QSize SrcSize_;
 		};
 
@@ -237,22 +261,32 @@ namespace Seen
 						const auto& srcSize = ctx.SrcSize_;
 
 						Result result;
-						for (const auto& pair : Util::Stlize (ctx.RenderJobs_))
+						for (const auto& job : ctx.RenderJobs_)
 						{
-							const auto& scale = pair.first;
-							const auto& size = srcSize.scaled (srcSize.width () * scale.first,
-									srcSize.height () * scale.second,
+							const auto& size = srcSize.scaled (srcSize.width () * job.XScale_,
+									srcSize.height () * job.YScale_,
 									Qt::KeepAspectRatio);
+							const QRect fullRect { { 0, 0 }, size };
+							const auto& renderRect = job.Rect_.isNull () ?
+									fullRect :
+									job.Rect_.intersected (fullRect);
 
-							QImage img { size, QImage::Format_RGB32 };
+							QImage img { renderRect.size (), QImage::Format_RGB32 };
 
-							ddjvu_rect_s rect
+							ddjvu_rect_s pageRect
 							{
 								0,
 								0,
 								static_cast<unsigned int> (size.width ()),
 								static_cast<unsigned int> (size.height ())
 							};
+							ddjvu_rect_s rect
+							{
+								renderRect.x (),
+								renderRect.y (),
+								static_cast<unsigned int> (renderRect.width ()),
+								static_cast<unsigned int> (renderRect.height ())
+							};
 
 							int res = 0;
 							int retries = 0;
@@ -260,7 +294,7 @@ namespace Seen
 							{
 								res = ddjvu_page_render (ctx.Page_,
 										DDJVU_RENDER_COLOR,
-										&rect,
+										&pageRect,
 										&rect,
 										fmt,
 										img.bytesPerLine (),
@@ -272,23 +306,28 @@ namespace Seen
 
 							if (res == DDJVU_JOB_OK || res == DDJVU_JOB_STARTED || res == DDJVU_JOB_NOTSTARTED)
 							{
-								auto future = pair.second;
+								auto future = job.Future_;
 								if (res == DDJVU_JOB_NOTSTARTED)
 									img.fill (Qt::white);
 								Util::ReportFutureResult (future, img);
 							}
 							else
-								result.Unrendered_ [ctx.PageNum_] [scale] = pair.second;
+								result.Unrendered_ [ctx.PageNum_] << job;
 						}
 						return result;
 					}
 				},
-				+[] (Result& acc, const Result& partial) { acc.Unrendered_.unite (partial.Unrendered_); });
+				+[] (Result& acc, const Result& partial)
+				{
+					for (const auto& pair : Util::Stlize (partial.Unrendered_))
+						acc.Unrendered_ [pair.first] += pair.second;
+				});
 
 		Util::Sequence (this, future) >>
 				[this] (const Result& result)
 				{
-					RenderJobs_.unite (result.Unrendered_);
+					for (const auto& pair : Util::Stlize (result.Unrendered_))
+						RenderJobs_ [pair.first] += pair.second;
 
 					const auto& remainingJobs = RenderJobs_.keys ().toSet ();
 
@@ -37,6 +37,7 @@
 #include <libdjvu/miniexp.h>
 #include <interfaces/monocle/idocument.h>
 #include <interfaces/monocle/idynamicdocument.h>
+#include <interfaces/monocle/isupportregionrendering.h>
 
 namespace LeechCraft
 {
@@ -49,9 +50,12 @@ namespace Seen
 	class Document : public QObject
 				   , public IDocument
 				   , public IDynamicDocument
+				   , public ISupportRegionRendering
 	{
 		Q_OBJECT
-		Q_INTERFACES (LeechCraft::Monocle::IDocument LeechCraft::Monocle::IDynamicDocument)
+		Q_INTERFACES (LeechCraft::Monocle::IDocument
+				LeechCraft::Monocle::IDynamicDocument
+				LeechCraft::Monocle::ISupportRegionRendering)
 
 		ddjvu_context_t *Context_;
 		ddjvu_document_t *Doc_;
@@ -63,8 +67,17 @@ namespace Seen
 		QHash<int, ddjvu_page_t*> PendingRenders_;
 		QHash<ddjvu_page_t*, int> PendingRendersNums_;
 
-		using RenderJobsPerScale_t = QHash<QPair<double, double>, QFutureInterface<QImage>>;
-		using RenderJobs_t = QHash<int, RenderJobsPerScale_t>;
+		struct RenderJob
+		{
+			double XScale_;
+			double YScale_;
+
+			// In the scaled page coordinates, null for the whole page.
+			QRect Rect_;
+
+			QFutureInterface<QImage> Future_;
+		};
+		using RenderJobs_t = QHash<int, QList<RenderJob>>;
 		RenderJobs_t RenderJobs_;
 
 		QSet<int> ScheduledRedraws_;
@@ -86,12 +99,15 @@ namespace Seen
 		QList<ILink_ptr> GetPageLinks (int);
 		QUrl GetDocURL () const;
 
+		QFuture<QImage> RenderPageRegion (int, double xRes, double yRes, const QRect&);
+
 		ddjvu_document_t* GetNativeDoc () const;
 
 		void UpdateDocInfo ();
 		void UpdatePageInfo (ddjvu_page_t*);
 		void RedrawPage (ddjvu_page_t*);
 	private:
+		QFuture<QImage> ScheduleRender (int, double xRes, double yRes, const QRect&);
 		void ScheduleRedraw (int page, int timeoutHint);
 		void TryUpdateSizes ();
 		void TryGetPageInfo (int);
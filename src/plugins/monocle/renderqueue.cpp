@@ -0,0 +1,130 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "renderqueue.h"
+#include <algorithm>
+#include <QThread>
+#include <QTimer>
+#include <util/threads/futures.h>
+
+namespace LeechCraft
+{
+namespace Monocle
+{
+	RenderQueue::RenderQueue (QObject *parent)
+	: QObject { parent }
+	, MaxRunning_ { std::max (QThread::idealThreadCount (), 2) }
+	{
+	}
+
+	void RenderQueue::Enqueue (QObject *owner,
+			const Starter_f& starter, const Priority_f& priority, const Handler_f& handler)
+	{
+		Pending_.append ({ owner, starter, priority, handler });
+		ScheduleDispatch ();
+	}
+
+	void RenderQueue::Cancel (QObject *owner)
+	{
+		const auto pos = std::remove_if (Pending_.begin (), Pending_.end (),
+				[owner] (const Request& req) { return !req.Owner_ || req.Owner_ == owner; });
+		Pending_.erase (pos, Pending_.end ());
+	}
+
+	void RenderQueue::ScheduleDispatch ()
+	{
+		if (DispatchScheduled_)
+			return;
+
+		DispatchScheduled_ = true;
+		QTimer::singleShot (0,
+				this,
+				SLOT (dispatch ()));
+	}
+
+	void RenderQueue::dispatch ()
+	{
+		DispatchScheduled_ = false;
+
+		QList<Handler_f> dropped;
+		while (Running_ < MaxRunning_ && !Pending_.isEmpty ())
+		{
+			int bestIdx = -1;
+			double bestPriority = 0;
+
+			for (int i = 0; i < Pending_.size (); )
+			{
+				const auto& req = Pending_.at (i);
+				const auto priority = req.Owner_ ?
+						req.Priority_ () :
+						boost::optional<double> {};
+				if (!priority)
+				{
+					if (req.Owner_)
+						dropped << req.Handler_;
+					Pending_.removeAt (i);
+					continue;
+				}
+
+				if (bestIdx == -1 || *priority < bestPriority)
+				{
+					bestIdx = i;
+					bestPriority = *priority;
+				}
+				++i;
+			}
+
+			if (bestIdx == -1)
+				break;
+
+			const auto req = Pending_.takeAt (bestIdx);
+			const auto& future = req.Starter_ ();
+
+			++Running_;
+			Util::Sequence (this, future) >>
+					[this, req] (const QImage& image)
+					{
+						--Running_;
+						if (req.Owner_)
+							req.Handler_ (image);
+						ScheduleDispatch ();
+					};
+
+			// Backends like MuPDF render synchronously right in the starter,
+			// so get back to the event loop after each of their requests.
+			if (future.isFinished ())
+				break;
+		}
+
+		for (const auto& handler : dropped)
+			handler ({});
+	}
+}
+}
@@ -0,0 +1,100 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#pragma once
+
+#include <functional>
+#include <boost/optional.hpp>
+#include <QObject>
+#include <QList>
+#include <QPointer>
+#include <QFuture>
+#include <QImage>
+
+namespace LeechCraft
+{
+namespace Monocle
+{
+	/** @brief Throttles page and page region render requests.
+	 *
+	 * The queue keeps at most a fixed number of requests in flight and
+	 * starts the most urgent pending one as soon as a slot frees up.
+	 * The urgency of a request is computed at dispatch time, so that
+	 * whatever the user scrolled to in the meantime is rendered first.
+	 *
+	 * A request that turns out to be rendered synchronously ends the
+	 * current dispatch round, so such backends render one request per
+	 * event loop iteration instead of blocking it for several ones.
+	 */
+	class RenderQueue : public QObject
+	{
+		Q_OBJECT
+	public:
+		using Starter_f = std::function<QFuture<QImage> ()>;
+
+		/** Lower values are dispatched first, an empty value means the
+		 * request isn't needed anymore and should be dropped.
+		 */
+		using Priority_f = std::function<boost::optional<double> ()>;
+
+		/** Invoked with a null image if the request has been dropped.
+		 */
+		using Handler_f = std::function<void (QImage)>;
+	private:
+		struct Request
+		{
+			QPointer<QObject> Owner_;
+			Starter_f Starter_;
+			Priority_f Priority_;
+			Handler_f Handler_;
+		};
+		QList<Request> Pending_;
+
+		int Running_ = 0;
+		const int MaxRunning_;
+
+		bool DispatchScheduled_ = false;
+	public:
+		RenderQueue (QObject* = nullptr);
+
+		void Enqueue (QObject *owner, const Starter_f&, const Priority_f&, const Handler_f&);
+
+		/** Drops all the pending requests of the given owner. The
+		 * requests that are already running can't be interrupted, so
+		 * their results will still be delivered.
+		 */
+		void Cancel (QObject *owner);
+	private:
+		void ScheduleDispatch ();
+	private slots:
+		void dispatch ();
+	};
+}
+}
@@ -47,7 +47,7 @@ namespace Pogooglue
 		Q_OBJECT
 		Q_INTERFACES (IInfo IEntityHandler IDataFilter)
 
-		LC_PLUGIN_METADATA ("org.LeechCraft.Pogooglue")
+		LC_PLUGIN_METADATA_FILE ("org.LeechCraft.Pogooglue", "manifest.json")
 
 		ICoreProxy_ptr Proxy_;
 	public:
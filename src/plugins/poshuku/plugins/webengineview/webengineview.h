@@ -59,7 +59,7 @@ namespace WebEngineView
 				LeechCraft::Poshuku::IWebViewProvider
 				LeechCraft::Poshuku::IInterceptableRequests)
 
-		Q_PLUGIN_METADATA (IID "org.LeechCraft.Poshuku.WebEngineView" FILE "manifest.json")
+		LC_PLUGIN_METADATA_FILE ("org.LeechCraft.Poshuku.WebEngineView", "manifest.json")
 
 		std::shared_ptr<RequestInterceptor> Interceptor_;
 
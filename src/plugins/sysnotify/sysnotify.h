@@ -46,7 +46,7 @@ namespace Sysnotify
 		Q_OBJECT
 		Q_INTERFACES (IInfo IEntityHandler)
 
-		LC_PLUGIN_METADATA ("org.LeechCraft.SysNotify")
+		LC_PLUGIN_METADATA_FILE ("org.LeechCraft.SysNotify", "manifest.json")
 
 		std::shared_ptr<NotificationManager> Manager_;
 	public:
@@ -30,6 +30,7 @@
 #pragma once
 
 #include <memory>
+#include <QStringList>
 #include "oraldetailfwd.h"
 #include "oraltypes.h"
 
@@ -43,7 +44,30 @@ namespace LeechCraft::Util::oral::detail
 		virtual ~IInsertQueryBuilder () = default;
 
 		virtual std::shared_ptr<QSqlQuery> GetQuery (InsertAction) = 0;
+
+		/** Returns a query inserting rowsCount records in one statement.
+		 * The values are bound positionally, record after record.
+		 *
+		 * A null pointer is returned if the backend can't do this for
+		 * the given action with the same results as inserting the records
+		 * one by one.
+		 */
+		virtual std::shared_ptr<QSqlQuery> GetBatchQuery (InsertAction, int rowsCount) = 0;
 	};
 
+	inline QString MakeBatchValues (int fieldsCount, int rowsCount)
+	{
+		QStringList placeholders;
+		for (int i = 0; i < fieldsCount; ++i)
+			placeholders << "?";
+		const auto& row = "(" + placeholders.join (", ") + ")";
+
+		QStringList rows;
+		rows.reserve (rowsCount);
+		for (int i = 0; i < rowsCount; ++i)
+			rows << row;
+		return rows.join (", ");
+	}
+
 	using IInsertQueryBuilder_ptr = std::unique_ptr<IInsertQueryBuilder>;
 }
@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <stdexcept>
 #include <type_traits>
 #include <memory>
@@ -45,6 +46,7 @@
 #include <QStringList>
 #include <QDateTime>
 #include <QPair>
+#include <QHash>
 #include <QSqlQuery>
 #include <QSqlRecord>
 #include <QVariant>
@@ -58,6 +60,7 @@
 #include <util/sll/detector.h>
 #include <util/sll/unreachable.h>
 #include <util/sll/void.h>
+#include <util/sll/util.h>
 #include <util/db/dblock.h>
 #include <util/db/util.h>
 #include "oraltypes.h"
@@ -292,6 +295,49 @@ namespace oral
 			return ToVariant<T> {} (t);
 		}
 
+		/** Tags a cached query by the compile-time types that fully
+		 * determine its text, like the types of the selector, the WHERE
+		 * expression tree and the ordering.
+		 */
+		template<typename...>
+		struct QueryCacheKey
+		{
+			inline static char Tag_ = 0;
+		};
+
+		class PreparedQueriesCache
+		{
+			const QSqlDatabase DB_;
+			QHash<const void*, QSqlQuery_ptr> Queries_;
+		public:
+			PreparedQueriesCache (const QSqlDatabase& db)
+			: DB_ { db }
+			{
+			}
+
+			template<typename Key>
+			QSqlQuery_ptr Get (const QString& queryStr)
+			{
+				if (const auto& query = Queries_.value (&Key::Tag_))
+				{
+					Q_ASSERT (query->lastQuery () == queryStr);
+					return query;
+				}
+
+				const auto query = std::make_shared<QSqlQuery> (DB_);
+				if (!query->prepare (queryStr))
+				{
+					DBLock::DumpError (*query);
+					return query;
+				}
+
+				Queries_ [&Key::Tag_] = query;
+				return query;
+			}
+		};
+
+		using PreparedQueriesCache_ptr = std::shared_ptr<PreparedQueriesCache>;
+
 		template<typename T>
 		auto MakeInserter (const CachedFieldsData& data, const QSqlQuery_ptr& insertQuery, bool bindPrimaryKey)
 		{
@@ -371,6 +417,9 @@ namespace oral
 			return result;
 		}
 
+		template<typename Range>
+		using RangeValue_t = std::decay_t<decltype (*std::begin (std::declval<Range&> ()))>;
+
 		template<typename Seq>
 		class AdaptInsert
 		{
@@ -379,11 +428,18 @@ namespace oral
 
 			constexpr static bool HasAutogen_ = HasAutogenPKey<Seq> ();
 
+			/* Keeps the number of the bound values in a batch statement
+			 * below the SQLITE_MAX_VARIABLE_NUMBER default of older SQLite.
+			 */
+			constexpr static int MaxBatchValues_ = 999;
+			constexpr static int MaxBatchRows_ = 64;
+
 			IInsertQueryBuilder_ptr QueryBuilder_;
 		public:
 			template<typename ImplFactory>
 			AdaptInsert (const QSqlDatabase& db, CachedFieldsData data, ImplFactory&& factory)
-			: Data_ { RemovePKey (data) }
+			: DB_ { db }
+			, Data_ { RemovePKey (data) }
 			, QueryBuilder_ { factory.MakeInsertQueryBuilder (db, Data_) }
 			{
 			}
@@ -397,7 +453,84 @@ namespace oral
 			{
 				return Run<false> (t, action);
 			}
+
+			/** Inserts all the records from the range in a single
+			 * transaction (or as part of the current one, if any).
+			 *
+			 * If the primary key is autogenerated, the records are
+			 * inserted one by one, and the list of the generated keys is
+			 * returned in the order of the records. Otherwise the records
+			 * are inserted by multi-row statements where the backend
+			 * supports them for the given action.
+			 *
+			 * @throw std::runtime_error if the transaction can't be started.
+			 * @throw QueryException if inserting a record fails, in which
+			 * case none of the records are inserted.
+			 */
+			template<typename Range, typename = std::enable_if_t<std::is_same_v<IsDetected_t<void, RangeValue_t, const Range>, Seq>>>
+			auto operator() (const Range& range, InsertAction action = InsertAction::Default) const
+			{
+				auto db = DB_;
+				DBLock lock { db };
+				lock.Init ();
+
+				if constexpr (HasAutogen_)
+				{
+					constexpr auto index = FindPKey<Seq>::result_type::value;
+
+					QList<typename ValueAtC_t<Seq, index>::value_type> ids;
+					for (const auto& t : range)
+						ids << Run<false> (t, action);
+
+					lock.Good ();
+					return ids;
+				}
+				else
+				{
+					const auto maxRows = std::max (1, std::min (MaxBatchValues_ / std::max (Data_.Fields_.size (), 1), MaxBatchRows_));
+
+					QList<Seq> chunk;
+					for (const auto& t : range)
+					{
+						chunk << t;
+						if (chunk.size () == maxRows)
+						{
+							RunBatch (chunk, action);
+							chunk.clear ();
+						}
+					}
+					if (!chunk.isEmpty ())
+						RunBatch (chunk, action);
+
+					lock.Good ();
+				}
+			}
 		private:
+			void RunBatch (const QList<Seq>& chunk, InsertAction action) const
+			{
+				const auto query = chunk.size () > 1 ?
+						QueryBuilder_->GetBatchQuery (action, chunk.size ()) :
+						QSqlQuery_ptr {};
+				if (!query)
+				{
+					const auto inserter = MakeInserter<Seq> (Data_, QueryBuilder_->GetQuery (action), true);
+					for (const auto& t : chunk)
+						inserter (t);
+					return;
+				}
+
+				int pos = 0;
+				for (const auto& t : chunk)
+					boost::fusion::for_each (t,
+							[&] (const auto& elem) { query->bindValue (pos++, ToVariantF (elem)); });
+
+				if (!query->exec ())
+				{
+					DBLock::DumpError (*query);
+					throw QueryException ("batch insert query execution failed", query);
+				}
+			}
+
 			template<bool UpdatePKey, typename Val>
 			auto Run (Val&& t, InsertAction action) const
 			{
@@ -940,6 +1073,7 @@ namespace oral
 		{
 			const QSqlDatabase DB_;
 			const CachedFieldsData Cached_;
+			const PreparedQueriesCache_ptr Queries_;
 
 			template<
 					typename SelectorT = SelectWhole,
@@ -981,6 +1115,7 @@ namespace oral
 			SelectWrapper (const QSqlDatabase& db, const CachedFieldsData& data)
 			: DB_ { db }
 			, Cached_ (data)
+			, Queries_ { std::make_shared<PreparedQueriesCache> (db) }
 			{
 			}
 
@@ -1016,10 +1151,12 @@ namespace oral
 				Q_UNUSED (_);
 				const auto& [fields, initializer, postproc] = HandleSelector (std::forward<Selector> (selector));
 				const auto& orderStr = HandleOrder (std::forward<Order> (order));
-				return postproc (Select (fields, BuildFromClause (tree), where, binder, initializer, orderStr));
+
+				using Key_t = QueryCacheKey<std::decay_t<Selector>, ExprTree<Type, L, R>, std::decay_t<Order>>;
+				return postproc (Select<Key_t> (fields, BuildFromClause (tree), where, binder, initializer, orderStr));
 			}
 		private:
-			template<typename Binder, typename Initializer>
+			template<typename Key, typename Binder, typename Initializer>
 			auto Select (const QString& fields, const QString& from, QString where,
 					Binder&& binder, Initializer&& initializer, const QString& orderStr) const
 			{
@@ -1031,29 +1168,30 @@ namespace oral
 						where +
 						orderStr;
 
-				QSqlQuery query { DB_ };
-				query.prepare (queryStr);
+				const auto query = Queries_->Get<Key> (queryStr);
 				if constexpr (!std::is_same_v<Void, std::decay_t<Binder>>)
-					binder (query);
+					binder (*query);
 
-				if (!query.exec ())
+				if (!query->exec ())
 				{
-					DBLock::DumpError (query);
-					throw QueryException ("fetch query execution failed", std::make_shared<QSqlQuery> (query));
+					DBLock::DumpError (*query);
+					throw QueryException ("fetch query execution failed", query);
 				}
 
+				const auto finishGuard = MakeScopeGuard ([&query] { query->finish (); });
+
 				if constexpr (SelectBehaviour == SelectBehaviour::Some)
 				{
 					QList<std::result_of_t<Initializer (QSqlQuery)>> result;
-					while (query.next ())
-						result << initializer (query);
+					while (query->next ())
+						result << initializer (*query);
 					return result;
 				}
 				else
 				{
 					using RetType_t = boost::optional<std::result_of_t<Initializer (QSqlQuery)>>;
-					return query.next () ?
-							RetType_t { initializer (query) } :
+					return query->next () ?
+							RetType_t { initializer (*query) } :
 							RetType_t {};
 				}
 			}
@@ -1144,10 +1282,12 @@ namespace oral
 		{
 			const QSqlDatabase DB_;
 			const CachedFieldsData Cached_;
+			const PreparedQueriesCache_ptr Queries_;
 		public:
 			DeleteByFieldsWrapper (const QSqlDatabase& db, const CachedFieldsData& data)
 			: DB_ { db }
 			, Cached_ (data)
+			, Queries_ { std::make_shared<PreparedQueriesCache> (db) }
 			{
 			}
 
@@ -1160,10 +1300,9 @@ namespace oral
 				const auto& selectAll = "DELETE FROM " + Cached_.Table_ +
 						" WHERE " + where + ";";
 
-				QSqlQuery query { DB_ };
-				query.prepare (selectAll);
-				binder (query);
-				query.exec ();
+				const auto query = Queries_->Get<QueryCacheKey<ExprTree<Type, L, R>>> (selectAll);
+				binder (*query);
+				query->exec ();
 			}
 		};
 
@@ -1172,12 +1311,14 @@ namespace oral
 		{
 			const QSqlDatabase DB_;
 			const CachedFieldsData Cached_;
+			const PreparedQueriesCache_ptr Queries_;
 
 			std::function<void (T)> Updater_;
 		public:
 			AdaptUpdate (const QSqlDatabase& db, const CachedFieldsData& data)
 			: DB_ { db }
 			, Cached_ { data }
+			, Queries_ { std::make_shared<PreparedQueriesCache> (db) }
 			{
 				if constexpr (HasPKey)
 				{
@@ -1218,11 +1359,11 @@ namespace oral
 						" SET " + setClause +
 						" WHERE " + whereClause;
 
-				QSqlQuery query { DB_ };
-				query.prepare (update);
-				setBinder (query);
-				whereBinder (query);
-				query.exec ();
+				using Key_t = QueryCacheKey<AssignList<SL, SR>, ExprTree<WType, WL, WR>>;
+				const auto query = Queries_->Get<Key_t> (update);
+				setBinder (*query);
+				whereBinder (*query);
+				query->exec ();
 			}
 		};
 
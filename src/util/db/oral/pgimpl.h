@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <QHash>
+#include <QPair>
 #include <util/sll/visitor.h>
 #include "oraltypes.h"
 #include "oraldetailfwd.h"
@@ -44,16 +46,22 @@ namespace LeechCraft::Util::oral::detail::PostgreSQL
 
 		QSqlQuery_ptr Default_;
 		QSqlQuery_ptr Ignore_;
+		QHash<QPair<int, int>, QSqlQuery_ptr> BatchQueries_;
 
 		const QString InsertBase_;
+		const QString BatchInsertBase_;
 		const QString Updater_;
+		const int FieldsCount_;
 	public:
 		InsertQueryBuilder (const QSqlDatabase& db, const CachedFieldsData& data)
 		: DB_ { db }
 		, InsertBase_ { "INSERT INTO " + data.Table_ +
 				" (" + data.Fields_.join (", ") + ") VALUES (" +
 				data.BoundFields_.join (", ") + ") " }
+		, BatchInsertBase_ { "INSERT INTO " + data.Table_ +
+				" (" + data.Fields_.join (", ") + ") VALUES " }
 		, Updater_ { Map (data.Fields_, [] (auto&& str) { return str + " = EXCLUDED." + str; }).join (", ") }
+		, FieldsCount_ { data.Fields_.size () }
 		{
 		}
 
@@ -64,7 +72,29 @@ namespace LeechCraft::Util::oral::detail::PostgreSQL
 					[this] (InsertAction::IgnoreTag) { return GetIgnoreQuery (); },
 					[this] (InsertAction::Replace ct) { return MakeReplaceQuery (ct.Fields_); });
 		}
+
+		QSqlQuery_ptr GetBatchQuery (InsertAction action, int rowsCount) override
+		{
+			/* ON CONFLICT DO UPDATE fails if the same row is affected twice
+			 * by a single statement, so the replacing inserts aren't batched.
+			 */
+			return Visit (action.Selector_,
+					[this, rowsCount] (InsertAction::DefaultTag) { return GetBatchQueryImpl (0, rowsCount, {}); },
+					[this, rowsCount] (InsertAction::IgnoreTag) { return GetBatchQueryImpl (1, rowsCount, " ON CONFLICT DO NOTHING"); },
+					[] (const InsertAction::Replace&) { return QSqlQuery_ptr {}; });
+		}
 	private:
+		QSqlQuery_ptr GetBatchQueryImpl (int actionIdx, int rowsCount, const QString& suffix)
+		{
+			auto& query = BatchQueries_ [{ actionIdx, rowsCount }];
+			if (!query)
+			{
+				query = std::make_shared<QSqlQuery> (DB_);
+				query->prepare (BatchInsertBase_ + MakeBatchValues (FieldsCount_, rowsCount) + suffix);
+			}
+			return query;
+		}
+
 		QSqlQuery_ptr GetDefaultQuery ()
 		{
 			if (!Default_)
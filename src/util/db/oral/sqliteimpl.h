@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <QHash>
+#include <QPair>
 #include <util/sll/visitor.h>
 #include "oraltypes.h"
 #include "oraldetailfwd.h"
@@ -43,13 +45,19 @@ namespace LeechCraft::Util::oral::detail::SQLite
 		const QSqlDatabase DB_;
 
 		std::array<QSqlQuery_ptr, InsertAction::StaticCount () + 1> Queries_;
+		QHash<QPair<int, int>, QSqlQuery_ptr> BatchQueries_;
 		const QString InsertSuffix_;
+		const QString BatchInsertSuffix_;
+		const int FieldsCount_;
 	public:
 		InsertQueryBuilder (const QSqlDatabase& db, const CachedFieldsData& data)
 		: DB_ { db }
 		, InsertSuffix_ { " INTO " + data.Table_ +
 			" (" + data.Fields_.join (", ") + ") VALUES (" +
 			data.BoundFields_.join (", ") + ");" }
+		, BatchInsertSuffix_ { " INTO " + data.Table_ +
+			" (" + data.Fields_.join (", ") + ") VALUES " }
+		, FieldsCount_ { data.Fields_.size () }
 		{
 		}
 
@@ -63,6 +71,18 @@ namespace LeechCraft::Util::oral::detail::SQLite
 			}
 			return query;
 		}
+
+		QSqlQuery_ptr GetBatchQuery (InsertAction action, int rowsCount) override
+		{
+			auto& query = BatchQueries_ [{ action.Selector_.which (), rowsCount }];
+			if (!query)
+			{
+				query = std::make_shared<QSqlQuery> (DB_);
+				query->prepare (GetInsertPrefix (action) + BatchInsertSuffix_ +
+						MakeBatchValues (FieldsCount_, rowsCount) + ";");
+			}
+			return query;
+		}
 	private:
 		QString GetInsertPrefix (InsertAction action)
 		{
@@ -354,6 +354,41 @@ namespace Util
 		QCOMPARE (updated, (QList<SimpleRecord> { { 10, "meh" } }));
 	}
 
+	void OralTest::testSimpleRecordCachedSelectRebinds ()
+	{
+		auto adapted = PrepareRecords<SimpleRecord> (MakeDatabase ());
+		for (int i = 0; i < 3; ++i)
+		{
+			const auto& list = adapted->Select (sph::f<&SimpleRecord::ID_> == i);
+			QCOMPARE (list, (QList<SimpleRecord> { { i, QString::number (i) } }));
+		}
+
+		const auto& list = adapted->Select (sph::f<&SimpleRecord::ID_> > 0);
+		QCOMPARE (list, (QList<SimpleRecord> { { 1, "1" }, { 2, "2" } }));
+	}
+
+	void OralTest::testSimpleRecordCachedSelectOneRebinds ()
+	{
+		auto adapted = PrepareRecords<SimpleRecord> (MakeDatabase ());
+		QCOMPARE (adapted->SelectOne (sph::f<&SimpleRecord::ID_> < 2), (boost::optional<SimpleRecord> { { 0, "0" } }));
+
+		adapted->Update ({ 0, "meh" });
+		adapted->DeleteBy (sph::f<&SimpleRecord::ID_> == 1);
+
+		QCOMPARE (adapted->SelectOne (sph::f<&SimpleRecord::ID_> < 2), (boost::optional<SimpleRecord> { { 0, "meh" } }));
+		QCOMPARE (adapted->SelectOne (sph::f<&SimpleRecord::ID_> < 0), boost::optional<SimpleRecord> {});
+	}
+
+	void OralTest::testSimpleRecordCachedDeleteByRebinds ()
+	{
+		auto adapted = PrepareRecords<SimpleRecord> (MakeDatabase ());
+		adapted->DeleteBy (sph::f<&SimpleRecord::ID_> == 0);
+		adapted->DeleteBy (sph::f<&SimpleRecord::ID_> == 2);
+
+		const auto& list = adapted->Select ();
+		QCOMPARE (list, (QList<SimpleRecord> { { 1, "1" } }));
+	}
+
 	void OralTest::testAutoPKeyRecordInsertSelect ()
 	{
 		auto adapted = PrepareRecords<AutogenPKeyRecord> (MakeDatabase ());
@@ -487,6 +522,98 @@ namespace Util
 		QCOMPARE (list, (QList<ComplexConstraintsRecord> { {0, "second", 1, 2 }, { 0, "first", 1, 3 } }));
 	}
 
+	namespace
+	{
+		QList<SimpleRecord> MakeSimpleRecords (int from, int to)
+		{
+			QList<SimpleRecord> records;
+			for (int i = from; i < to; ++i)
+				records.push_back ({ i, QString::number (i) });
+			return records;
+		}
+	}
+
+	void OralTest::testSimpleRecordBulkInsertSelect ()
+	{
+		auto adapted = Util::oral::AdaptPtr<SimpleRecord, OralFactory> (MakeDatabase ());
+		adapted->Insert (MakeSimpleRecords (0, 3));
+
+		const auto& list = adapted->Select ();
+		QCOMPARE (list, (QList<SimpleRecord> { { 0, "0" }, { 1, "1" }, { 2, "2" } }));
+	}
+
+	void OralTest::testSimpleRecordBulkInsertManyChunks ()
+	{
+		auto adapted = Util::oral::AdaptPtr<SimpleRecord, OralFactory> (MakeDatabase ());
+		const auto& records = MakeSimpleRecords (0, 1001);
+		adapted->Insert (records);
+
+		const auto& list = adapted->Select.Build ().Order (oral::OrderBy<sph::asc<&SimpleRecord::ID_>>) ();
+		QCOMPARE (list, records);
+	}
+
+	void OralTest::testSimpleRecordBulkInsertIgnoreSelect ()
+	{
+		auto adapted = PrepareRecords<SimpleRecord> (MakeDatabase ());
+		adapted->Insert (QList<SimpleRecord> { { 1, "meh" }, { 3, "3" }, { 3, "meh" } }, lco::InsertAction::Ignore);
+
+		const auto& list = adapted->Select ();
+		QCOMPARE (list, (QList<SimpleRecord> { { 0, "0" }, { 1, "1" }, { 2, "2" }, { 3, "3" } }));
+	}
+
+	void OralTest::testSimpleRecordBulkInsertReplaceSelect ()
+	{
+		auto adapted = PrepareRecords<SimpleRecord> (MakeDatabase ());
+		adapted->Insert (QList<SimpleRecord> { { 1, "meh" }, { 3, "3" }, { 3, "meh" } },
+				lco::InsertAction::Replace::PKey<SimpleRecord>);
+
+		const auto& list = adapted->Select.Build ().Order (oral::OrderBy<sph::asc<&SimpleRecord::ID_>>) ();
+		QCOMPARE (list, (QList<SimpleRecord> { { 0, "0" }, { 1, "meh" }, { 2, "2" }, { 3, "meh" } }));
+	}
+
+	void OralTest::testSimpleRecordBulkInsertFailureRollsBack ()
+	{
+		auto adapted = PrepareRecords<SimpleRecord> (MakeDatabase ());
+		ShallThrow<oral::QueryException> ([&]
+				{
+					adapted->Insert (QList<SimpleRecord> { { 3, "3" }, { 1, "meh" } });
+				});
+
+		const auto& list = adapted->Select ();
+		QCOMPARE (list, (QList<SimpleRecord> { { 0, "0" }, { 1, "1" }, { 2, "2" } }));
+	}
+
+	void OralTest::testAutoPKeyRecordBulkInsertReturnsPKeys ()
+	{
+		auto adapted = Util::oral::AdaptPtr<AutogenPKeyRecord, OralFactory> (MakeDatabase ());
+
+		const auto& ids = adapted->Insert (QList<AutogenPKeyRecord> { { 0, "0" }, { 0, "1" }, { 0, "2" } });
+		QCOMPARE (ids, (QList<int> { 1, 2, 3 }));
+
+		const auto& list = adapted->Select ();
+		QCOMPARE (list, (QList<AutogenPKeyRecord> { { 1, "0" }, { 2, "1" }, { 3, "2" } }));
+	}
+
+	void OralTest::testComplexConstraintsRecordBulkInsertSelectReplace ()
+	{
+		auto adapted = Util::oral::AdaptPtr<ComplexConstraintsRecord, OralFactory> (MakeDatabase ());
+
+		const auto weightAgeFields = lco::InsertAction::Replace::Fields<
+				&ComplexConstraintsRecord::Weight_,
+				&ComplexConstraintsRecord::Age_
+			>;
+		adapted->Insert (QList<ComplexConstraintsRecord>
+				{
+					{ 0, "first", 1, 2 },
+					{ 0, "second", 1, 2 },
+					{ 0, "third", 1, 3 }
+				},
+				weightAgeFields);
+
+		const auto& list = adapted->Select ();
+		QCOMPARE (list, (QList<ComplexConstraintsRecord> { { 0, "second", 1, 2 }, { 0, "third", 1, 3 } }));
+	}
+
 	void OralTest::benchSimpleRecordAdapt ()
 	{
 		if constexpr (OralBench)
@@ -528,6 +655,37 @@ namespace Util
 		}
 	}
 
+	void OralTest::benchSimpleRecordInsertTransaction ()
+	{
+		if constexpr (OralBench)
+		{
+			auto db = MakeDatabase ();
+			const auto& adapted = Util::oral::Adapt<SimpleRecord, OralFactory> (db);
+			const auto& records = MakeSimpleRecords (0, 1000);
+
+			QBENCHMARK
+			{
+				Util::DBLock lock { db };
+				lock.Init ();
+				for (const auto& record : records)
+					adapted.Insert (record, lco::InsertAction::Replace::PKey<SimpleRecord>);
+				lock.Good ();
+			}
+		}
+	}
+
+	void OralTest::benchSimpleRecordBulkInsert ()
+	{
+		if constexpr (OralBench)
+		{
+			auto db = MakeDatabase ();
+			const auto& adapted = Util::oral::Adapt<SimpleRecord, OralFactory> (db);
+			const auto& records = MakeSimpleRecords (0, 1000);
+
+			QBENCHMARK { adapted.Insert (records, lco::InsertAction::Replace::PKey<SimpleRecord>); }
+		}
+	}
+
 	void OralTest::benchBaselineUpdate ()
 	{
 		if constexpr (OralBench)
@@ -559,5 +717,111 @@ namespace Util
 			QBENCHMARK { adapted.Update ({ 0, "1" }); }
 		}
 	}
+
+	namespace
+	{
+		auto PrepareBenchRecords (QSqlDatabase db)
+		{
+			auto adapted = Util::oral::Adapt<SimpleRecord, OralFactory> (db);
+
+			Util::DBLock lock { db };
+			lock.Init ();
+			for (int i = 0; i < 1000; ++i)
+				adapted.Insert ({ i, QString::number (i) });
+			lock.Good ();
+
+			return adapted;
+		}
+
+		const QString SelectByFieldsQuery = "SELECT SimpleRecord.ID, SimpleRecord.Value FROM SimpleRecord "
+				"WHERE SimpleRecord.ID = :bound_1";
+	}
+
+	void OralTest::benchBaselineSelectByFields ()
+	{
+		if constexpr (OralBench)
+		{
+			auto db = MakeDatabase ();
+			PrepareBenchRecords (db);
+
+			QSqlQuery query { db };
+			query.prepare (SelectByFieldsQuery);
+
+			int i = 0;
+			QBENCHMARK
+			{
+				query.bindValue (":bound_1", i++ % 1000);
+				query.exec ();
+				query.next ();
+				query.finish ();
+			}
+		}
+	}
+
+	void OralTest::benchBaselineSelectByFieldsReprepare ()
+	{
+		if constexpr (OralBench)
+		{
+			auto db = MakeDatabase ();
+			PrepareBenchRecords (db);
+
+			int i = 0;
+			QBENCHMARK
+			{
+				QSqlQuery query { db };
+				query.prepare (SelectByFieldsQuery);
+				query.bindValue (":bound_1", i++ % 1000);
+				query.exec ();
+				query.next ();
+			}
+		}
+	}
+
+	void OralTest::benchSimpleRecordSelectByFields ()
+	{
+		if constexpr (OralBench)
+		{
+			auto db = MakeDatabase ();
+			const auto& adapted = PrepareBenchRecords (db);
+
+			int i = 0;
+			QBENCHMARK { adapted.SelectOne (sph::f<&SimpleRecord::ID_> == i++ % 1000); }
+		}
+	}
+
+	void OralTest::benchBaselineUpdateExprTreeReprepare ()
+	{
+		if constexpr (OralBench)
+		{
+			auto db = MakeDatabase ();
+			PrepareBenchRecords (db);
+
+			int i = 0;
+			QBENCHMARK
+			{
+				QSqlQuery query { db };
+				query.prepare ("UPDATE SimpleRecord SET Value = :bound_1 WHERE SimpleRecord.ID = :bound_2");
+				query.bindValue (":bound_1", "meh");
+				query.bindValue (":bound_2", i++ % 1000);
+				query.exec ();
+			}
+		}
+	}
+
+	void OralTest::benchSimpleRecordUpdateExprTree ()
+	{
+		if constexpr (OralBench)
+		{
+			auto db = MakeDatabase ();
+			auto adapted = PrepareBenchRecords (db);
+
+			int i = 0;
+			QBENCHMARK
+			{
+				adapted.Update (sph::f<&SimpleRecord::Value_> = QString { "meh" },
+						sph::f<&SimpleRecord::ID_> == i++ % 1000);
+			}
+		}
+	}
 }
 }
@@ -70,6 +70,10 @@ namespace Util
 		void testSimpleRecordUpdateExprTree ();
 		void testSimpleRecordUpdateMultiExprTree ();
 
+		void testSimpleRecordCachedSelectRebinds ();
+		void testSimpleRecordCachedSelectOneRebinds ();
+		void testSimpleRecordCachedDeleteByRebinds ();
+
 		void testAutoPKeyRecordInsertSelect ();
 		void testAutoPKeyRecordInsertRvalueReturnsPKey ();
 		void testAutoPKeyRecordInsertConstLvalueReturnsPKey ();
@@ -83,13 +87,30 @@ namespace Util
 		void testComplexConstraintsRecordInsertSelectIgnore ();
 		void testComplexConstraintsRecordInsertSelectReplace ();
 
+		void testSimpleRecordBulkInsertSelect ();
+		void testSimpleRecordBulkInsertManyChunks ();
+		void testSimpleRecordBulkInsertIgnoreSelect ();
+		void testSimpleRecordBulkInsertReplaceSelect ();
+		void testSimpleRecordBulkInsertFailureRollsBack ();
+		void testAutoPKeyRecordBulkInsertReturnsPKeys ();
+		void testComplexConstraintsRecordBulkInsertSelectReplace ();
+
 		void benchSimpleRecordAdapt ();
 
 		void benchBaselineInsert ();
 		void benchSimpleRecordInsert ();
+		void benchSimpleRecordInsertTransaction ();
+		void benchSimpleRecordBulkInsert ();
 
 		void benchBaselineUpdate ();
 		void benchSimpleRecordUpdate ();
+
+		void benchBaselineSelectByFields ();
+		void benchBaselineSelectByFieldsReprepare ();
+		void benchSimpleRecordSelectByFields ();
+
+		void benchBaselineUpdateExprTreeReprepare ();
+		void benchSimpleRecordUpdateExprTree ();
 	};
 }
 }
@@ -129,6 +129,33 @@ namespace Util
 		return item->GetModel ()->rowCount (item->GetIndex ());
 	}
 
+	bool MergeModel::hasChildren (const QModelIndex& parent) const
+	{
+		if (!parent.isValid ())
+			return Root_->GetRowCount ();
+
+		const auto item = static_cast<ModelItem*> (parent.internalPointer ());
+		return item->GetModel ()->hasChildren (item->GetIndex ());
+	}
+
+	bool MergeModel::canFetchMore (const QModelIndex& parent) const
+	{
+		if (!parent.isValid ())
+			return false;
+
+		const auto item = static_cast<ModelItem*> (parent.internalPointer ());
+		return item->GetModel ()->canFetchMore (item->GetIndex ());
+	}
+
+	void MergeModel::fetchMore (const QModelIndex& parent)
+	{
+		if (!parent.isValid ())
+			return;
+
+		const auto item = static_cast<ModelItem*> (parent.internalPointer ());
+		item->GetModel ()->fetchMore (item->GetIndex ());
+	}
+
 	QStringList MergeModel::mimeTypes () const
 	{
 		QStringList result;
@@ -90,6 +90,17 @@ namespace LeechCraft
 			QModelIndex parent (const QModelIndex&) const override;
 			int rowCount (const QModelIndex& = QModelIndex ()) const override;
 
+			/** @brief Forwards the lazy population to the source models.
+			 *
+			 * These functions forward the calls for the valid indices to
+			 * the corresponding source models, so the source models that
+			 * populate their subtrees on demand are also populated on
+			 * demand when merged.
+			 */
+			bool hasChildren (const QModelIndex& = QModelIndex ()) const override;
+			bool canFetchMore (const QModelIndex&) const override;
+			void fetchMore (const QModelIndex&) override;
+
 			/** @brief Returns the union of MIME types of the models.
 			 *
 			 * @return The union of all the MIME types.
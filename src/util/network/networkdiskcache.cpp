@@ -28,13 +28,23 @@
  **********************************************************************/
 
 #include "networkdiskcache.h"
+#include <algorithm>
 #include <QtDebug>
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDataStream>
 #include <QDir>
-#include <QFuture>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
 #include <QMutexLocker>
+#include <QSaveFile>
+#include <QThread>
+#include <QtConcurrentRun>
 #include <util/sys/paths.h>
-#include <util/threads/futures.h>
 #include "networkdiskcachegc.h"
+#include "networkdiskcacheindex.h"
 
 namespace LeechCraft
 {
@@ -46,86 +56,475 @@ namespace Util
 		{
 			return GetUserDir (UserDir::Cache, "network/" + subpath).absolutePath ();
 		}
+
+		const QString EntriesSubdir = "lc1";
+
+		/* QNetworkDiskCache, which has been used before, kept its entries
+		 * in the data* subdirectories and the downloads in progress in the
+		 * prepared one. They are never served now, so they are dropped.
+		 */
+		const QStringList LegacySubdirs { "data*", "prepared" };
+
+		QStringList GetLegacySubdirs (const QString& cacheDir)
+		{
+			return QDir { cacheDir }.entryList (LegacySubdirs, QDir::Dirs | QDir::NoDotAndDotDot);
+		}
+
+		void RemoveLegacyEntries (const QString& cacheDir, NetworkDiskCacheIndex& index)
+		{
+			const QDir dir { cacheDir };
+			for (const auto& subdir : GetLegacySubdirs (cacheDir))
+			{
+				const auto& path = dir.filePath (subdir);
+
+				QStringList files;
+				QDirIterator it { path, QDir::Files, QDirIterator::Subdirectories };
+				while (it.hasNext ())
+					files << it.next ();
+
+				if (!QDir { path }.removeRecursively ())
+					qWarning () << Q_FUNC_INFO
+							<< "unable to remove"
+							<< path;
+
+				for (const auto& file : files)
+					if (!QFile::exists (file))
+						index.Remove (file);
+			}
+		}
+
+		const quint32 EntryMagic = 0x4c434345;
+		const quint32 EntryVersion = 1;
+
+		const auto StreamVersion = QDataStream::Qt_5_0;
+
+		QUrl NormalizeUrl (const QUrl& url)
+		{
+			return url.adjusted (QUrl::RemoveFragment);
+		}
+
+		QByteArray HashUrl (const QUrl& url)
+		{
+			return QCryptographicHash::hash (url.toEncoded (), QCryptographicHash::Sha1);
+		}
+
+		bool ReadHeader (QFile& file, QNetworkCacheMetaData& meta)
+		{
+			QDataStream istr { &file };
+			istr.setVersion (StreamVersion);
+
+			quint32 magic = 0;
+			quint32 version = 0;
+			istr >> magic >> version;
+			if (magic != EntryMagic || version != EntryVersion)
+				return false;
+
+			istr >> meta;
+			return istr.status () == QDataStream::Ok;
+		}
+
+		qint64 WriteEntry (const QString& path, const QNetworkCacheMetaData& meta, const QByteArray& data)
+		{
+			QDir {}.mkpath (QFileInfo { path }.path ());
+
+			QSaveFile file { path };
+			if (!file.open (QIODevice::WriteOnly))
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "unable to open"
+						<< path
+						<< file.errorString ();
+				return -1;
+			}
+
+			QDataStream ostr { &file };
+			ostr.setVersion (StreamVersion);
+			ostr << EntryMagic
+					<< EntryVersion
+					<< meta;
+			ostr.writeRawData (data.constData (), data.size ());
+
+			const auto size = file.pos ();
+			if (!file.commit ())
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "unable to write"
+						<< path
+						<< file.errorString ();
+				return -1;
+			}
+
+			return size;
+		}
+
+		class MappedDevice : public QBuffer
+		{
+			std::unique_ptr<QFile> File_;
+		public:
+			MappedDevice (std::unique_ptr<QFile> file, const uchar *data, qint64 size)
+			: File_ { std::move (file) }
+			{
+				setData (QByteArray::fromRawData (reinterpret_cast<const char*> (data), size));
+				open (QIODevice::ReadOnly);
+			}
+		};
+
+		QIODevice* MakeBuffer (const QByteArray& data)
+		{
+			const auto buffer = new QBuffer;
+			buffer->setData (data);
+			buffer->open (QIODevice::ReadOnly);
+			return buffer;
+		}
+
+		QIODevice* OpenEntryData (std::unique_ptr<QFile> file)
+		{
+			const auto offset = file->pos ();
+			const auto size = file->size () - offset;
+			if (size <= 0)
+				return MakeBuffer ({});
+
+			if (const auto mapped = file->map (offset, size))
+				return new MappedDevice { std::move (file), mapped, size };
+
+			return MakeBuffer (file->readAll ());
+		}
 	}
 
 	NetworkDiskCache::NetworkDiskCache (const QString& subpath, QObject *parent)
-	: QNetworkDiskCache (parent)
-	, CurrentSize_ (-1)
-	, InsertRemoveMutex_ (QMutex::Recursive)
-	, GcGuard_ (NetworkDiskCacheGC::Instance ().RegisterDirectory (GetCacheDir (subpath),
+	: QAbstractNetworkCache (parent)
+	, CacheDir_ (GetCacheDir (subpath))
+	, GcGuard_ (NetworkDiskCacheGC::Instance ().RegisterDirectory (CacheDir_,
 			[this] { return maximumCacheSize (); }))
+	, Index_ (NetworkDiskCacheGC::Instance ().GetIndex (CacheDir_))
+	{
+		IOPool_.setMaxThreadCount (std::min (QThread::idealThreadCount (), 4));
+
+		if (!GetLegacySubdirs (CacheDir_).isEmpty ())
+			QtConcurrent::run (&IOPool_, [this] { RemoveLegacyEntries (CacheDir_, *Index_); });
+	}
+
+	NetworkDiskCache::~NetworkDiskCache ()
+	{
+		IOPool_.waitForDone ();
+
+		qDeleteAll (Prepared_.keys ());
+	}
+
+	QString NetworkDiskCache::cacheDirectory () const
+	{
+		return CacheDir_;
+	}
+
+	qint64 NetworkDiskCache::maximumCacheSize () const
 	{
-		setCacheDirectory (GetCacheDir (subpath));
+		return MaxSize_;
+	}
+
+	void NetworkDiskCache::setMaximumCacheSize (qint64 size)
+	{
+		MaxSize_ = size;
+	}
+
+	auto NetworkDiskCache::GetStats () const -> Stats
+	{
+		return { Hits_, Misses_, ReadNsecs_, Writes_, WriteNsecs_ };
 	}
 
 	qint64 NetworkDiskCache::cacheSize () const
 	{
-		return CurrentSize_;
+		return Index_->GetTotalSize ();
 	}
 
 	QIODevice* NetworkDiskCache::data (const QUrl& url)
 	{
-		QMutexLocker lock (&InsertRemoveMutex_);
-		return QNetworkDiskCache::data (url);
+		QElapsedTimer timer;
+		timer.start ();
+
+		const auto& key = NormalizeUrl (url);
+		const auto dev = DataImpl (key, HashUrl (key));
+
+		ReadNsecs_ += timer.nsecsElapsed ();
+		++(dev ? Hits_ : Misses_);
+
+		return dev;
 	}
 
 	void NetworkDiskCache::insert (QIODevice *device)
 	{
-		QMutexLocker lock (&InsertRemoveMutex_);
-		if (!PendingDev2Url_.contains (device))
+		QNetworkCacheMetaData meta;
 		{
-			qWarning () << Q_FUNC_INFO
-					<< "stall device detected";
-			return;
+			QMutexLocker lock { &PreparedMutex_ };
+			if (!Prepared_.contains (device))
+			{
+				qWarning () << Q_FUNC_INFO
+						<< "stall device detected";
+				return;
+			}
+
+			meta = Prepared_.take (device);
 		}
 
-		PendingUrl2Devs_ [PendingDev2Url_.take (device)].removeAll (device);
+		const auto& data = static_cast<QBuffer*> (device)->data ();
+		delete device;
 
-		CurrentSize_ += device->size ();
-		QNetworkDiskCache::insert (device);
+		const auto& key = NormalizeUrl (meta.url ());
+		Enqueue (key, HashUrl (key), { PendingOp::Type::Write, meta, data, 0 });
 	}
 
 	QNetworkCacheMetaData NetworkDiskCache::metaData (const QUrl& url)
 	{
-		QMutexLocker lock (&InsertRemoveMutex_);
-		return QNetworkDiskCache::metaData (url);
+		const auto& key = NormalizeUrl (url);
+		const auto& hash = HashUrl (key);
+
+		{
+			auto& shard = GetShard (hash);
+			QMutexLocker lock { &shard.Mutex_ };
+			const auto pos = shard.Ops_.find (key);
+			if (pos != shard.Ops_.end ())
+				return pos->Type_ == PendingOp::Type::Remove ?
+						QNetworkCacheMetaData {} :
+						pos->Meta_;
+		}
+
+		QFile file { GetEntryPath (hash) };
+		QNetworkCacheMetaData meta;
+		if (!file.open (QIODevice::ReadOnly) || !ReadHeader (file, meta))
+			return {};
+
+		return meta;
 	}
 
-	QIODevice* NetworkDiskCache::prepare (const QNetworkCacheMetaData& metadata)
+	QIODevice* NetworkDiskCache::prepare (const QNetworkCacheMetaData& meta)
 	{
-		QMutexLocker lock (&InsertRemoveMutex_);
-		const auto dev = QNetworkDiskCache::prepare (metadata);
-		PendingDev2Url_ [dev] = metadata.url ();
-		PendingUrl2Devs_ [metadata.url ()] << dev;
+		if (!meta.isValid () || !meta.url ().isValid () || !meta.saveToDisk ())
+			return nullptr;
+
+		for (const auto& header : meta.rawHeaders ())
+			if (!header.first.compare ("content-length", Qt::CaseInsensitive))
+			{
+				if (header.second.toLongLong () > MaxSize_ * 3 / 4)
+					return nullptr;
+				break;
+			}
+
+		const auto dev = new QBuffer;
+		dev->open (QIODevice::ReadWrite);
+
+		QMutexLocker lock { &PreparedMutex_ };
+		Prepared_ [dev] = meta;
 		return dev;
 	}
 
 	bool NetworkDiskCache::remove (const QUrl& url)
 	{
-		QMutexLocker lock (&InsertRemoveMutex_);
-		for (const auto dev : PendingUrl2Devs_.take (url))
-			PendingDev2Url_.remove (dev);
-		return QNetworkDiskCache::remove (url);
+		const auto& key = NormalizeUrl (url);
+		const auto& hash = HashUrl (key);
+
+		{
+			QMutexLocker lock { &PreparedMutex_ };
+			for (auto i = Prepared_.begin (); i != Prepared_.end (); )
+				if (NormalizeUrl (i->url ()) == key)
+				{
+					delete i.key ();
+					i = Prepared_.erase (i);
+				}
+				else
+					++i;
+		}
+
+		bool hadPending = false;
+		{
+			auto& shard = GetShard (hash);
+			QMutexLocker lock { &shard.Mutex_ };
+			const auto pos = shard.Ops_.find (key);
+			hadPending = pos != shard.Ops_.end () && pos->Type_ != PendingOp::Type::Remove;
+		}
+
+		const auto existed = hadPending || Index_->Contains (GetEntryPath (hash));
+		Enqueue (key, hash, { PendingOp::Type::Remove, {}, {}, 0 });
+		return existed;
 	}
 
-	void NetworkDiskCache::updateMetaData (const QNetworkCacheMetaData& metaData)
+	void NetworkDiskCache::updateMetaData (const QNetworkCacheMetaData& meta)
 	{
-		QMutexLocker lock (&InsertRemoveMutex_);
-		QNetworkDiskCache::updateMetaData (metaData);
+		const auto& key = NormalizeUrl (meta.url ());
+		const auto& hash = HashUrl (key);
+
+		PendingOp op { PendingOp::Type::UpdateMeta, meta, {}, 0 };
+		{
+			auto& shard = GetShard (hash);
+			QMutexLocker lock { &shard.Mutex_ };
+			const auto pos = shard.Ops_.find (key);
+			if (pos != shard.Ops_.end ())
+			{
+				if (pos->Type_ == PendingOp::Type::Remove)
+					return;
+
+				op.Type_ = pos->Type_;
+				op.Data_ = pos->Data_;
+			}
+		}
+
+		Enqueue (key, hash, op);
 	}
 
-	qint64 NetworkDiskCache::expire ()
+	void NetworkDiskCache::clear ()
 	{
-		if (CurrentSize_ < 0)
+		for (auto& shard : Shards_)
 		{
-			const auto& dir = cacheDirectory ();
-			Util::Sequence (this, NetworkDiskCacheGC::Instance ().GetCurrentSize (dir)) >>
-					[this] (qint64 res) { CurrentSize_ = res; };
+			QMutexLocker lock { &shard.Mutex_ };
+			shard.Ops_.clear ();
+			shard.Queue_.clear ();
+		}
 
-			return maximumCacheSize () * 8 / 10;
+		IOPool_.waitForDone ();
+
+		if (Index_->NeedsRebuild ())
+			Index_->Rebuild ();
+		Index_->Evict (0);
+	}
+
+	auto NetworkDiskCache::GetShard (const QByteArray& hash) -> Shard&
+	{
+		return Shards_ [static_cast<uchar> (hash.at (0)) % ShardsCount];
+	}
+
+	QString NetworkDiskCache::GetEntryPath (const QByteArray& hash) const
+	{
+		return QString { "%1/%2/%3/%4.d" }
+				.arg (CacheDir_)
+				.arg (EntriesSubdir)
+				.arg (static_cast<uchar> (hash.at (0)) % ShardsCount, 0, 16)
+				.arg (QString::fromLatin1 (hash.toHex ()));
+	}
+
+	QIODevice* NetworkDiskCache::DataImpl (const QUrl& key, const QByteArray& hash)
+	{
+		{
+			auto& shard = GetShard (hash);
+			QMutexLocker lock { &shard.Mutex_ };
+			const auto pos = shard.Ops_.find (key);
+			if (pos != shard.Ops_.end ())
+				switch (pos->Type_)
+				{
+				case PendingOp::Type::Write:
+					return MakeBuffer (pos->Data_);
+				case PendingOp::Type::Remove:
+					return nullptr;
+				case PendingOp::Type::UpdateMeta:
+					break;
+				}
 		}
 
-		return CurrentSize_;
+		const auto& path = GetEntryPath (hash);
+
+		std::unique_ptr<QFile> file { new QFile { path } };
+		QNetworkCacheMetaData meta;
+		if (!file->open (QIODevice::ReadOnly) || !ReadHeader (*file, meta))
+			return nullptr;
+
+		Index_->Touch (path);
+
+		return OpenEntryData (std::move (file));
+	}
+
+	void NetworkDiskCache::Enqueue (const QUrl& key, const QByteArray& hash, PendingOp op)
+	{
+		auto& shard = GetShard (hash);
+
+		QMutexLocker lock { &shard.Mutex_ };
+		op.Serial_ = ++shard.LastSerial_;
+		shard.Ops_ [key] = op;
+		shard.Queue_.enqueue ({ key, hash });
+
+		if (shard.IsDraining_)
+			return;
+
+		shard.IsDraining_ = true;
+		QtConcurrent::run (&IOPool_, [this, &shard] { Drain (shard); });
+	}
+
+	void NetworkDiskCache::Drain (Shard& shard)
+	{
+		while (true)
+		{
+			QPair<QUrl, QByteArray> item;
+			PendingOp op;
+
+			{
+				QMutexLocker lock { &shard.Mutex_ };
+				if (shard.Queue_.isEmpty ())
+				{
+					shard.IsDraining_ = false;
+					return;
+				}
+
+				item = shard.Queue_.dequeue ();
+
+				/* Several queue items may refer to the same URL, and only
+				 * the latest operation for it matters.
+				 */
+				const auto pos = shard.Ops_.find (item.first);
+				if (pos == shard.Ops_.end ())
+					continue;
+
+				op = *pos;
+			}
+
+			Sync (item.second, op);
+
+			QMutexLocker lock { &shard.Mutex_ };
+			const auto pos = shard.Ops_.find (item.first);
+			if (pos != shard.Ops_.end () && pos->Serial_ == op.Serial_)
+				shard.Ops_.erase (pos);
+		}
+	}
+
+	void NetworkDiskCache::Sync (const QByteArray& hash, const PendingOp& op)
+	{
+		const auto& path = GetEntryPath (hash);
+
+		switch (op.Type_)
+		{
+		case PendingOp::Type::Remove:
+			QFile::remove (path);
+			Index_->Remove (path);
+			return;
+		case PendingOp::Type::UpdateMeta:
+		{
+			QFile file { path };
+			QNetworkCacheMetaData oldMeta;
+			if (!file.open (QIODevice::ReadOnly) || !ReadHeader (file, oldMeta))
+				return;
+
+			const auto& data = file.readAll ();
+			file.close ();
+
+			const auto size = WriteEntry (path, op.Meta_, data);
+			if (size >= 0)
+				Index_->Insert (path, size);
+			return;
+		}
+		case PendingOp::Type::Write:
+			break;
+		}
+
+		QElapsedTimer timer;
+		timer.start ();
+
+		const auto size = WriteEntry (path, op.Meta_, op.Data_);
+		if (size < 0)
+			return;
+
+		Index_->Insert (path, size);
+
+		WriteNsecs_ += timer.nsecsElapsed ();
+		++Writes_;
+
+		const qint64 maxSize = MaxSize_;
+		if (Index_->GetTotalSize () > maxSize)
+			Index_->Evict (maxSize * 9 / 10);
 	}
 }
 }
@@ -29,9 +29,14 @@
 
 #pragma once
 
-#include <QNetworkDiskCache>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <QAbstractNetworkCache>
 #include <QMutex>
 #include <QHash>
+#include <QQueue>
+#include <QThreadPool>
 #include <util/sll/util.h>
 #include "networkconfig.h"
 
@@ -39,32 +44,110 @@ namespace LeechCraft
 {
 namespace Util
 {
+	class NetworkDiskCacheIndex;
+
 	/** @brief A thread-safe garbage-collected network disk cache.
 	 *
-	 * This class is thread-safe unlike the original QNetworkDiskCache,
-	 * thus it can be used from multiple threads simultaneously.
+	 * This class is thread-safe and can be used from multiple threads
+	 * simultaneously. The cache state is split into several shards by
+	 * the URL hash, so requests for different URLs rarely contend for
+	 * the same lock.
+	 *
+	 * Writing the cached entries to disk (as well as updating and
+	 * removing them) happens in a separate thread pool. Until an entry
+	 * is written, it is served from memory. The entries on disk are
+	 * served via memory-mapped files whenever possible.
 	 *
-	 * Also, old cache data is automatically removed from the cache in a
-	 * background thread without blocking. The garbage collection can be
-	 * also triggered manually via the collectGarbage() slot.
+	 * Old cache data is automatically removed from the cache in a
+	 * background thread without blocking. The garbage is collected
+	 * until cache takes 90% of its maximum size, least recently used
+	 * entries being removed first.
 	 *
-	 * The garbage is collected until cache takes 90% of its maximum size.
+	 * The sizes and usage order of the cached files are tracked by a
+	 * NetworkDiskCacheIndex shared by all caches at the same path, so
+	 * neither the cache nor the garbage collector need to walk the
+	 * cache directory except for the first run or after a crash.
 	 *
 	 * @ingroup NetworkUtil
 	 */
-	class UTIL_NETWORK_API NetworkDiskCache : public QNetworkDiskCache
+	class UTIL_NETWORK_API NetworkDiskCache : public QAbstractNetworkCache
 	{
 		Q_OBJECT
 
-		qint64 CurrentSize_;
+		const QString CacheDir_;
+		std::atomic<qint64> MaxSize_ { 50 * 1024 * 1024 };
+
+		struct PendingOp
+		{
+			enum class Type
+			{
+				Write,
+				UpdateMeta,
+				Remove
+			} Type_;
+
+			QNetworkCacheMetaData Meta_;
+			QByteArray Data_;
+
+			quint64 Serial_;
+		};
+
+		struct Shard
+		{
+			QMutex Mutex_;
+
+			QHash<QUrl, PendingOp> Ops_;
+			QQueue<QPair<QUrl, QByteArray>> Queue_;
+			quint64 LastSerial_ = 0;
+			bool IsDraining_ = false;
+		};
+
+		static const int ShardsCount = 16;
+		std::array<Shard, ShardsCount> Shards_;
+
+		QMutex PreparedMutex_;
+		QHash<QIODevice*, QNetworkCacheMetaData> Prepared_;
 
-		mutable QMutex InsertRemoveMutex_;
+		std::atomic<quint64> Hits_ { 0 };
+		std::atomic<quint64> Misses_ { 0 };
+		std::atomic<qint64> ReadNsecs_ { 0 };
+		std::atomic<quint64> Writes_ { 0 };
+		std::atomic<qint64> WriteNsecs_ { 0 };
 
-		QHash<QIODevice*, QUrl> PendingDev2Url_;
-		QHash<QUrl, QList<QIODevice*>> PendingUrl2Devs_;
+		QThreadPool IOPool_;
 
 		const Util::DefaultScopeGuard GcGuard_;
+		const std::shared_ptr<NetworkDiskCacheIndex> Index_;
 	public:
+		/** @brief Usage statistics of the cache.
+		 *
+		 * The average read latency is ReadNsecs_ / (Hits_ + Misses_),
+		 * and the average write latency is WriteNsecs_ / Writes_.
+		 */
+		struct Stats
+		{
+			/** @brief The number of data() calls that found the entry.
+			 */
+			quint64 Hits_;
+
+			/** @brief The number of data() calls that didn't.
+			 */
+			quint64 Misses_;
+
+			/** @brief The total time spent in data(), in nanoseconds.
+			 */
+			qint64 ReadNsecs_;
+
+			/** @brief The number of entries written to disk.
+			 */
+			quint64 Writes_;
+
+			/** @brief The total time spent writing entries, in
+			 * nanoseconds.
+			 */
+			qint64 WriteNsecs_;
+		};
+
 		/** @brief Constructs the new disk cache.
 		 *
 		 * The cache uses a subdirectory \em subpath in the \em network
@@ -77,38 +160,78 @@ namespace Util
 		 */
 		NetworkDiskCache (const QString& subpath, QObject *parent = 0);
 
-		/** @brief Reimplemented from QNetworkDiskCache.
+		/** @brief Waits until all pending writes are finished.
+		 */
+		~NetworkDiskCache ();
+
+		/** @brief Returns the directory this cache stores its data in.
+		 *
+		 * @return The cache directory.
+		 */
+		QString cacheDirectory () const;
+
+		/** @brief Returns the maximum size of the cache, in bytes.
+		 *
+		 * @return The maximum size of the cache.
+		 *
+		 * @sa setMaximumCacheSize()
+		 */
+		qint64 maximumCacheSize () const;
+
+		/** @brief Sets the maximum size of the cache, in bytes.
+		 *
+		 * @param[in] size The new maximum size of the cache.
+		 *
+		 * @sa maximumCacheSize()
+		 */
+		void setMaximumCacheSize (qint64 size);
+
+		/** @brief Returns the usage statistics of this cache.
+		 *
+		 * @return The statistics since the cache has been created.
+		 */
+		Stats GetStats () const;
+
+		/** @brief Reimplemented from QAbstractNetworkCache.
 		 */
 		qint64 cacheSize () const override;
 
-		/** @brief Reimplemented from QNetworkDiskCache.
+		/** @brief Reimplemented from QAbstractNetworkCache.
 		 */
 		QIODevice* data (const QUrl& url) override;
 
-		/** @brief Reimplemented from QNetworkDiskCache.
+		/** @brief Reimplemented from QAbstractNetworkCache.
 		 */
 		void insert (QIODevice *device) override;
 
-		/** @brief Reimplemented from QNetworkDiskCache.
+		/** @brief Reimplemented from QAbstractNetworkCache.
 		 */
 		QNetworkCacheMetaData metaData (const QUrl& url) override;
 
-		/** @brief Reimplemented from QNetworkDiskCache.
+		/** @brief Reimplemented from QAbstractNetworkCache.
 		 */
 		QIODevice* prepare (const QNetworkCacheMetaData&) override;
 
-		/** @brief Reimplemented from QNetworkDiskCache.
+		/** @brief Reimplemented from QAbstractNetworkCache.
 		 */
 		bool remove (const QUrl& url) override;
 
-		/** @brief Reimplemented from QNetworkDiskCache.
+		/** @brief Reimplemented from QAbstractNetworkCache.
 		 */
 		void updateMetaData (const QNetworkCacheMetaData& metaData) override;
-	protected:
-		/** @brief Reimplemented from QNetworkDiskCache.
+	public slots:
+		/** @brief Reimplemented from QAbstractNetworkCache.
 		 */
-		qint64 expire () override;
+		void clear () override;
+	private:
+		Shard& GetShard (const QByteArray&);
+		QString GetEntryPath (const QByteArray&) const;
+
+		QIODevice* DataImpl (const QUrl&, const QByteArray&);
+
+		void Enqueue (const QUrl&, const QByteArray&, PendingOp);
+		void Drain (Shard&);
+		void Sync (const QByteArray&, const PendingOp&);
 	};
 }
 }
-
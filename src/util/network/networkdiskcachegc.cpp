@@ -32,12 +32,12 @@
 #include <QDir>
 #include <QDirIterator>
 #include <QtConcurrentRun>
-#include <QDateTime>
 #include <QtDebug>
 #include <util/sll/qtutil.h>
 #include <util/sll/prelude.h>
 #include <util/sll/util.h>
 #include <util/threads/futures.h>
+#include "networkdiskcacheindex.h"
 
 namespace LeechCraft
 {
@@ -61,25 +61,17 @@ namespace Util
 
 	namespace
 	{
-		struct SizeCollectInfo
+		qint64 CollectSize (const QString& cacheDirectory)
 		{
-			QMultiMap<QDateTime, QString> Items_;
-			qint64 TotalSize_ = 0;
-		};
-
-		SizeCollectInfo CollectSizes (const QString& cacheDirectory)
-		{
-			SizeCollectInfo result;
+			qint64 result = 0;
 
 			const QDir::Filters filters = QDir::AllDirs | QDir:: Files | QDir::NoDotAndDotDot;
 			QDirIterator it { cacheDirectory, filters, QDirIterator::Subdirectories };
 
 			while (it.hasNext ())
 			{
-				const auto& path = it.next ();
-				const auto& info = it.fileInfo ();
-				result.Items_.insert (info.created (), path);
-				result.TotalSize_ += info.size ();
+				it.next ();
+				result += it.fileInfo ().size ();
 			}
 
 			return result;
@@ -88,7 +80,11 @@ namespace Util
 
 	QFuture<qint64> NetworkDiskCacheGC::GetCurrentSize (const QString& path) const
 	{
-		return QtConcurrent::run ([path] { return CollectSizes (path).TotalSize_; });
+		const auto& index = GetIndex (path);
+		if (index && !index->NeedsRebuild ())
+			return MakeReadyFuture (index->GetTotalSize ());
+
+		return QtConcurrent::run ([path] { return CollectSize (path); });
 	}
 
 	Util::DefaultScopeGuard NetworkDiskCacheGC::RegisterDirectory (const QString& path,
@@ -98,9 +94,23 @@ namespace Util
 		list.push_front (sizeGetter);
 		const auto thisItem = list.begin ();
 
+		if (!Indexes_.contains (path))
+		{
+			const auto index = std::make_shared<NetworkDiskCacheIndex> (path);
+			Indexes_ [path] = index;
+
+			if (index->NeedsRebuild ())
+				QtConcurrent::run ([index] { index->Rebuild (); });
+		}
+
 		return Util::MakeScopeGuard ([this, path, thisItem] { UnregisterDirectory (path, thisItem); }).EraseType ();
 	}
 
+	std::shared_ptr<NetworkDiskCacheIndex> NetworkDiskCacheGC::GetIndex (const QString& path) const
+	{
+		return Indexes_.value (path);
+	}
+
 	void NetworkDiskCacheGC::UnregisterDirectory (const QString& path, CacheSizeGetters_t::iterator pos)
 	{
 		if (!Directories_.contains (path))
@@ -119,33 +129,21 @@ namespace Util
 
 		Directories_.remove (path);
 		LastSizes_.remove (path);
+		Indexes_.remove (path);
 	}
 
 	namespace
 	{
-		qint64 Collector (const QString& cacheDirectory, qint64 goal)
+		qint64 Collector (const std::shared_ptr<NetworkDiskCacheIndex>& index, qint64 goal)
 		{
-			if (cacheDirectory.isEmpty ())
-				return 0;
-
-			qDebug () << Q_FUNC_INFO << "running..." << cacheDirectory << goal;
-
-			auto sizeInfoResult = CollectSizes (cacheDirectory);
+			if (index->NeedsRebuild ())
+				index->Rebuild ();
 
-			for (auto i = sizeInfoResult.Items_.constBegin ();
-					i != sizeInfoResult.Items_.constEnd () && sizeInfoResult.TotalSize_ > goal;
-					++i)
-			{
-				QFile file { *i };
-				sizeInfoResult.TotalSize_ -= file.size ();
-				file.remove ();
-			}
-
-			qDebug () << "collector finished" << sizeInfoResult.TotalSize_;
-
-			return sizeInfoResult.TotalSize_;
+			const auto size = index->Evict (goal);
+			index->Save ();
+			return size;
 		}
-	};
+	}
 
 	void NetworkDiskCacheGC::handleCollect ()
 	{
@@ -157,12 +155,17 @@ namespace Util
 		}
 
 		QList<QPair<QString, int>> dirs;
+		QMap<QString, std::shared_ptr<NetworkDiskCacheIndex>> indexes;
 		for (const auto& pair : Util::Stlize (Directories_))
 		{
+			if (pair.first.isEmpty ())
+				continue;
+
 			const auto& getters = pair.second;
 			const auto minSize = (*std::min_element (getters.begin (), getters.end (),
 						Util::ComparingBy (Apply))) ();
 			dirs.append ({ pair.first, minSize });
+			indexes [pair.first] = Indexes_.value (pair.first);
 		}
 
 		if (dirs.isEmpty ())
@@ -171,11 +174,15 @@ namespace Util
 		IsCollecting_ = true;
 
 		Util::Sequence (this,
-				QtConcurrent::run ([dirs]
+				QtConcurrent::run ([dirs, indexes]
 						{
 							QMap<QString, qint64> sizes;
 							for (const auto& pair : dirs)
-								sizes [pair.first] = Collector (pair.first, pair.second);
+							{
+								qDebug () << Q_FUNC_INFO << "running..." << pair.first << pair.second;
+								sizes [pair.first] = Collector (indexes [pair.first], pair.second);
+								qDebug () << "collector finished" << sizes [pair.first];
+							}
 							return sizes;
 						})) >>
 				[this] (const QMap<QString, qint64>& sizes)
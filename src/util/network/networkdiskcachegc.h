@@ -43,6 +43,8 @@ namespace LeechCraft
 {
 namespace Util
 {
+	class NetworkDiskCacheIndex;
+
 	/** @brief Garbage collection for a set of network disk caches.
 	 *
 	 * This GC manager class aids having multiple network disk caches at
@@ -60,6 +62,8 @@ namespace Util
 
 		QMap<QString, qint64> LastSizes_;
 
+		QMap<QString, std::shared_ptr<NetworkDiskCacheIndex>> Indexes_;
+
 		bool IsCollecting_ = false;
 
 		NetworkDiskCacheGC ();
@@ -79,6 +83,9 @@ namespace Util
 		 * thread, and a future object is returned which can be used to
 		 * be notified when the calculation finishes.
 		 *
+		 * If the \em path is registered and its index is up to date, the
+		 * returned future is ready right away.
+		 *
 		 * @param[in] path The path which total size should be calculated
 		 * @return The future object for the asynchronous path size
 		 * calculation.
@@ -107,6 +114,20 @@ namespace Util
 		 */
 		Util::DefaultScopeGuard RegisterDirectory (const QString& path,
 				const std::function<int ()>& sizeGetter);
+
+		/** @brief Returns the index of the given registered \em path.
+		 *
+		 * The index is shared between all the caches registered at the
+		 * same path. If the \em path is not registered, a null pointer
+		 * is returned.
+		 *
+		 * @param[in] path The registered cache path.
+		 * @return The index of the files under the \em path, or a null
+		 * pointer.
+		 *
+		 * @sa RegisterDirectory()
+		 */
+		std::shared_ptr<NetworkDiskCacheIndex> GetIndex (const QString& path) const;
 	private:
 		void UnregisterDirectory (const QString&, CacheSizeGetters_t::iterator);
 	private slots:
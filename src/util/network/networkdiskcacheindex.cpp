@@ -0,0 +1,405 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "networkdiskcacheindex.h"
+#include <algorithm>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
+#include <QtDebug>
+
+namespace LeechCraft
+{
+namespace Util
+{
+	namespace
+	{
+		const quint32 IndexMagic = 0x4c434e49;
+		const quint32 IndexVersion = 1;
+
+		const QString IndexFilename = "lc_cache_index";
+		const QString DirtyMarkerFilename = "lc_cache_index.dirty";
+
+		/* QNetworkDiskCache keeps the entries being downloaded here, and
+		 * they aren't part of the cache yet.
+		 */
+		const QString PreparedSubdir = "prepared/";
+
+		/* The number of the files evicted from the index at once under
+		 * the lock, so that the cache isn't blocked for too long. The
+		 * files themselves are removed after the lock is released.
+		 */
+		const int EvictionChunk = 256;
+	}
+
+	NetworkDiskCacheIndex::NetworkDiskCacheIndex (const QString& dir)
+	: Dir_ { QDir { dir }.absolutePath () }
+	{
+		NeedsRebuild_ = !Load ();
+	}
+
+	NetworkDiskCacheIndex::~NetworkDiskCacheIndex ()
+	{
+		Save ();
+	}
+
+	void NetworkDiskCacheIndex::Insert (const QString& path, qint64 size)
+	{
+		const auto& relPath = ToRelative (path);
+
+		QMutexLocker locker { &Mutex_ };
+		MarkDirty ();
+		const auto pos = Entries_.find (relPath);
+		if (pos != Entries_.end ())
+			RemoveImpl (pos);
+		InsertImpl (relPath, size, NextStamp_++);
+	}
+
+	void NetworkDiskCacheIndex::Touch (const QString& path)
+	{
+		const auto& relPath = ToRelative (path);
+
+		QMutexLocker locker { &Mutex_ };
+		const auto pos = Entries_.find (relPath);
+		if (pos == Entries_.end ())
+			return;
+
+		MarkDirty ();
+		Stamp2Path_.erase (pos->Stamp_);
+		pos->Stamp_ = NextStamp_++;
+		Stamp2Path_.emplace (pos->Stamp_, relPath);
+	}
+
+	void NetworkDiskCacheIndex::Remove (const QString& path)
+	{
+		const auto& relPath = ToRelative (path);
+
+		QMutexLocker locker { &Mutex_ };
+		const auto pos = Entries_.find (relPath);
+		if (pos == Entries_.end ())
+			return;
+
+		MarkDirty ();
+		RemoveImpl (pos);
+	}
+
+	bool NetworkDiskCacheIndex::Contains (const QString& path) const
+	{
+		const auto& relPath = ToRelative (path);
+
+		QMutexLocker locker { &Mutex_ };
+		return Entries_.contains (relPath);
+	}
+
+	void NetworkDiskCacheIndex::Clear ()
+	{
+		QMutexLocker locker { &Mutex_ };
+		MarkDirty ();
+		Entries_.clear ();
+		Stamp2Path_.clear ();
+		TotalSize_ = 0;
+	}
+
+	qint64 NetworkDiskCacheIndex::GetTotalSize () const
+	{
+		QMutexLocker locker { &Mutex_ };
+		return TotalSize_;
+	}
+
+	int NetworkDiskCacheIndex::GetFilesCount () const
+	{
+		QMutexLocker locker { &Mutex_ };
+		return Entries_.size ();
+	}
+
+	bool NetworkDiskCacheIndex::NeedsRebuild () const
+	{
+		QMutexLocker locker { &Mutex_ };
+		return NeedsRebuild_;
+	}
+
+	void NetworkDiskCacheIndex::Rebuild ()
+	{
+		qint64 startStamp = 0;
+		{
+			QMutexLocker locker { &Mutex_ };
+			startStamp = NextStamp_;
+		}
+
+		struct FileInfo
+		{
+			QDateTime Created_;
+			QString Path_;
+			qint64 Size_;
+		};
+		QList<FileInfo> files;
+
+		const auto& indexPath = GetIndexPath ();
+		const auto& markerPath = GetDirtyMarkerPath ();
+		QDirIterator it { Dir_, QDir::Files | QDir::NoDotAndDotDot, QDirIterator::Subdirectories };
+		while (it.hasNext ())
+		{
+			const auto& path = it.next ();
+			if (path == indexPath || path == markerPath)
+				continue;
+
+			const auto& relPath = ToRelative (path);
+			if (relPath.startsWith (PreparedSubdir))
+				continue;
+
+			const auto& info = it.fileInfo ();
+			files.append ({ info.created (), relPath, info.size () });
+		}
+
+		std::sort (files.begin (), files.end (),
+				[] (const FileInfo& left, const FileInfo& right) { return left.Created_ < right.Created_; });
+
+		QMutexLocker locker { &Mutex_ };
+		MarkDirty ();
+
+		QSet<QString> present;
+		present.reserve (files.size ());
+		for (const auto& file : files)
+			present << file.Path_;
+
+		for (auto pos = Entries_.begin (); pos != Entries_.end (); )
+			if (pos->Stamp_ < startStamp && !present.contains (pos.key ()))
+			{
+				Stamp2Path_.erase (pos->Stamp_);
+				TotalSize_ -= pos->Size_;
+				pos = Entries_.erase (pos);
+			}
+			else
+				++pos;
+
+		files.erase (std::remove_if (files.begin (), files.end (),
+					[this] (const FileInfo& file) { return Entries_.contains (file.Path_); }),
+				files.end ());
+
+		const auto oldest = Stamp2Path_.empty () ? NextStamp_ : Stamp2Path_.begin ()->first;
+		auto stamp = oldest - files.size ();
+		for (const auto& file : files)
+			InsertImpl (file.Path_, file.Size_, stamp++);
+
+		NeedsRebuild_ = false;
+	}
+
+	qint64 NetworkDiskCacheIndex::Evict (qint64 goal)
+	{
+		while (true)
+		{
+			QStringList evicted;
+			qint64 totalSize = 0;
+			{
+				QMutexLocker locker { &Mutex_ };
+				while (evicted.size () < EvictionChunk &&
+						TotalSize_ > goal &&
+						!Stamp2Path_.empty ())
+				{
+					MarkDirty ();
+
+					const auto pos = Entries_.find (Stamp2Path_.begin ()->second);
+					evicted << pos.key ();
+					RemoveImpl (pos);
+				}
+				totalSize = TotalSize_;
+			}
+
+			if (evicted.isEmpty ())
+				return totalSize;
+
+			for (const auto& relPath : evicted)
+				QFile::remove (Dir_ + '/' + relPath);
+
+			/* Some of the files might have been stored anew while they
+			 * were being removed, and then their new versions are gone.
+			 */
+			QMutexLocker locker { &Mutex_ };
+			for (const auto& relPath : evicted)
+			{
+				const auto pos = Entries_.find (relPath);
+				if (pos != Entries_.end () && !QFile::exists (Dir_ + '/' + relPath))
+					RemoveImpl (pos);
+			}
+		}
+	}
+
+	bool NetworkDiskCacheIndex::Save ()
+	{
+		QSaveFile file { GetIndexPath () };
+		if (!file.open (QIODevice::WriteOnly))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to open"
+					<< file.fileName ()
+					<< file.errorString ();
+			return false;
+		}
+
+		QDataStream ostr { &file };
+
+		bool wasDirty = false;
+		{
+			QMutexLocker locker { &Mutex_ };
+			ostr << IndexMagic
+					<< IndexVersion
+					<< static_cast<qint32> (Entries_.size ());
+			for (const auto& pair : Stamp2Path_)
+				ostr << pair.second << Entries_.value (pair.second).Size_;
+
+			wasDirty = Dirty_;
+			Dirty_ = false;
+		}
+
+		if (!file.commit ())
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unable to save"
+					<< file.fileName ()
+					<< file.errorString ();
+
+			QMutexLocker locker { &Mutex_ };
+			Dirty_ = Dirty_ || wasDirty;
+			return false;
+		}
+
+		QMutexLocker locker { &Mutex_ };
+		if (!Dirty_)
+			QFile::remove (GetDirtyMarkerPath ());
+
+		return true;
+	}
+
+	QString NetworkDiskCacheIndex::GetIndexPath () const
+	{
+		return Dir_ + '/' + IndexFilename;
+	}
+
+	QString NetworkDiskCacheIndex::GetDirtyMarkerPath () const
+	{
+		return Dir_ + '/' + DirtyMarkerFilename;
+	}
+
+	void NetworkDiskCacheIndex::MarkDirty ()
+	{
+		if (Dirty_)
+			return;
+
+		Dirty_ = true;
+
+		QFile marker { GetDirtyMarkerPath () };
+		if (!marker.open (QIODevice::WriteOnly))
+			qWarning () << Q_FUNC_INFO
+					<< "unable to create the dirty marker"
+					<< marker.fileName ()
+					<< marker.errorString ();
+	}
+
+	QString NetworkDiskCacheIndex::ToRelative (const QString& path) const
+	{
+		if (path.size () > Dir_.size () &&
+				path.startsWith (Dir_) &&
+				path.at (Dir_.size ()) == '/')
+			return path.mid (Dir_.size () + 1);
+
+		return path;
+	}
+
+	void NetworkDiskCacheIndex::InsertImpl (const QString& relPath, qint64 size, qint64 stamp)
+	{
+		Entries_.insert (relPath, { size, stamp });
+		Stamp2Path_.emplace (stamp, relPath);
+		TotalSize_ += size;
+	}
+
+	void NetworkDiskCacheIndex::RemoveImpl (QHash<QString, Entry>::iterator pos)
+	{
+		Stamp2Path_.erase (pos->Stamp_);
+		TotalSize_ -= pos->Size_;
+		Entries_.erase (pos);
+	}
+
+	bool NetworkDiskCacheIndex::Load ()
+	{
+		if (QFile::exists (GetDirtyMarkerPath ()))
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "the index in"
+					<< Dir_
+					<< "hasn't been saved after the last changes, ignoring it";
+			Dirty_ = true;
+			return false;
+		}
+
+		QFile file { GetIndexPath () };
+		if (!file.open (QIODevice::ReadOnly))
+			return false;
+
+		QDataStream istr { &file };
+
+		quint32 magic = 0;
+		quint32 version = 0;
+		qint32 count = 0;
+		istr >> magic >> version >> count;
+		if (magic != IndexMagic || version != IndexVersion || count < 0)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "unknown index format in"
+					<< file.fileName ();
+			return false;
+		}
+
+		Entries_.reserve (count);
+		for (qint32 i = 0; i < count; ++i)
+		{
+			QString relPath;
+			qint64 size = 0;
+			istr >> relPath >> size;
+			InsertImpl (relPath, size, NextStamp_++);
+		}
+
+		if (istr.status () != QDataStream::Ok)
+		{
+			qWarning () << Q_FUNC_INFO
+					<< "truncated index"
+					<< file.fileName ();
+			Clear ();
+			return false;
+		}
+
+		return true;
+	}
+}
+}
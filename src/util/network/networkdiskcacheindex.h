@@ -0,0 +1,186 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#pragma once
+
+#include <map>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include "networkconfig.h"
+
+namespace LeechCraft
+{
+namespace Util
+{
+	/** @brief A persistent size and LRU index of a network disk cache.
+	 *
+	 * The index keeps track of the files stored in a cache directory,
+	 * their sizes and the order in which they were last used. This way
+	 * the total cache size is known without walking the directory, and
+	 * the garbage collection can evict the least recently used files
+	 * right away.
+	 *
+	 * The index is stored in the cache directory itself. It is read
+	 * upon construction, and written back by Save() and on destruction.
+	 * Before the first change since the index has been loaded or saved,
+	 * a dirty marker file is created next to it, and it's only removed
+	 * once the index is saved. If the marker is present on load (for
+	 * instance, after a crash), or there is no index file at all, the
+	 * saved index is ignored, and the index is considered incomplete
+	 * until Rebuild() is called, which merges the directory contents
+	 * into the index.
+	 *
+	 * This class is thread-safe.
+	 *
+	 * @ingroup NetworkUtil
+	 */
+	class UTIL_NETWORK_API NetworkDiskCacheIndex
+	{
+		const QString Dir_;
+
+		mutable QMutex Mutex_;
+
+		struct Entry
+		{
+			qint64 Size_;
+			qint64 Stamp_;
+		};
+		QHash<QString, Entry> Entries_;
+		std::map<qint64, QString> Stamp2Path_;
+
+		qint64 NextStamp_ = 0;
+		qint64 TotalSize_ = 0;
+
+		bool NeedsRebuild_ = true;
+		bool Dirty_ = false;
+	public:
+		/** @brief Loads the index for the given cache \em dir.
+		 *
+		 * @param[in] dir The cache directory.
+		 */
+		NetworkDiskCacheIndex (const QString& dir);
+
+		/** @brief Saves the index.
+		 */
+		~NetworkDiskCacheIndex ();
+
+		NetworkDiskCacheIndex (const NetworkDiskCacheIndex&) = delete;
+		NetworkDiskCacheIndex& operator= (const NetworkDiskCacheIndex&) = delete;
+
+		/** @brief Records a new or updated file at the given \em path.
+		 *
+		 * The file becomes the most recently used one.
+		 *
+		 * @param[in] path The absolute path to the file.
+		 * @param[in] size The size of the file.
+		 */
+		void Insert (const QString& path, qint64 size);
+
+		/** @brief Marks the file at the given \em path as just used.
+		 *
+		 * @param[in] path The absolute path to the file.
+		 */
+		void Touch (const QString& path);
+
+		/** @brief Forgets the file at the given \em path.
+		 *
+		 * @param[in] path The absolute path to the file.
+		 */
+		void Remove (const QString& path);
+
+		/** @brief Checks whether the file at the given \em path is
+		 * indexed.
+		 *
+		 * @param[in] path The absolute path to the file.
+		 * @return Whether the file is indexed.
+		 */
+		bool Contains (const QString& path) const;
+
+		/** @brief Forgets all the files.
+		 */
+		void Clear ();
+
+		/** @brief Returns the total size of the indexed files.
+		 */
+		qint64 GetTotalSize () const;
+
+		/** @brief Returns the number of the indexed files.
+		 */
+		int GetFilesCount () const;
+
+		/** @brief Checks whether the index needs to be rebuilt.
+		 *
+		 * @sa Rebuild()
+		 */
+		bool NeedsRebuild () const;
+
+		/** @brief Merges the contents of the cache directory into the
+		 * index.
+		 *
+		 * The files missing in the index are added as the least recently
+		 * used ones, and the indexed files missing in the directory are
+		 * forgotten.
+		 *
+		 * This walks the whole cache directory, so it should be called
+		 * from a background thread.
+		 */
+		void Rebuild ();
+
+		/** @brief Removes the least recently used files until the total
+		 * size is not greater than \em goal.
+		 *
+		 * @param[in] goal The desired total size of the cache.
+		 * @return The total size after the eviction.
+		 */
+		qint64 Evict (qint64 goal);
+
+		/** @brief Writes the index to the cache directory.
+		 *
+		 * The dirty marker is removed unless the index has changed
+		 * while it was being written.
+		 *
+		 * @return Whether the index has been written successfully.
+		 */
+		bool Save ();
+	private:
+		QString GetIndexPath () const;
+		QString GetDirtyMarkerPath () const;
+
+		void MarkDirty ();
+		QString ToRelative (const QString&) const;
+
+		void InsertImpl (const QString&, qint64 size, qint64 stamp);
+		void RemoveImpl (QHash<QString, Entry>::iterator);
+
+		bool Load ();
+	};
+}
+}
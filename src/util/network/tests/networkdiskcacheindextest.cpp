@@ -0,0 +1,283 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#include "networkdiskcacheindextest.h"
+#include <memory>
+#include <QtTest>
+#include <QTemporaryDir>
+#include <networkdiskcacheindex.h>
+
+QTEST_GUILESS_MAIN (LeechCraft::Util::NetworkDiskCacheIndexTest)
+
+namespace LeechCraft
+{
+namespace Util
+{
+	namespace
+	{
+		const int SyntheticEntriesCount = 200000;
+		const qint64 SyntheticEntrySize = 4096;
+
+		QString MakeFile (const QTemporaryDir& dir, const QString& name, int size)
+		{
+			const auto& path = dir.path () + '/' + name;
+			QDir {}.mkpath (QFileInfo { path }.path ());
+
+			QFile file { path };
+			file.open (QIODevice::WriteOnly);
+			file.write (QByteArray (size, 'x'));
+			return path;
+		}
+
+		QString MakeSyntheticPath (const QTemporaryDir& dir, int num)
+		{
+			return QString { "%1/data8/%2/%3.d" }
+					.arg (dir.path ())
+					.arg (num % 16, 0, 16)
+					.arg (num);
+		}
+
+		void FillSynthetic (const QTemporaryDir& dir, NetworkDiskCacheIndex& index)
+		{
+			for (int i = 0; i < SyntheticEntriesCount; ++i)
+				index.Insert (MakeSyntheticPath (dir, i), SyntheticEntrySize);
+		}
+	}
+
+	void NetworkDiskCacheIndexTest::testInsertSize ()
+	{
+		QTemporaryDir dir;
+		NetworkDiskCacheIndex index { dir.path () };
+		index.Insert (MakeFile (dir, "a", 10), 10);
+		index.Insert (MakeFile (dir, "b", 20), 20);
+
+		QCOMPARE (index.GetFilesCount (), 2);
+		QCOMPARE (index.GetTotalSize (), qint64 { 30 });
+	}
+
+	void NetworkDiskCacheIndexTest::testReinsertSize ()
+	{
+		QTemporaryDir dir;
+		NetworkDiskCacheIndex index { dir.path () };
+		const auto& path = MakeFile (dir, "a", 10);
+		index.Insert (path, 10);
+		index.Insert (path, 15);
+
+		QCOMPARE (index.GetFilesCount (), 1);
+		QCOMPARE (index.GetTotalSize (), qint64 { 15 });
+	}
+
+	void NetworkDiskCacheIndexTest::testRemove ()
+	{
+		QTemporaryDir dir;
+		NetworkDiskCacheIndex index { dir.path () };
+		const auto& path = MakeFile (dir, "a", 10);
+		index.Insert (path, 10);
+		index.Insert (MakeFile (dir, "b", 20), 20);
+		index.Remove (path);
+
+		QCOMPARE (index.GetFilesCount (), 1);
+		QCOMPARE (index.GetTotalSize (), qint64 { 20 });
+	}
+
+	void NetworkDiskCacheIndexTest::testEvictLRU ()
+	{
+		QTemporaryDir dir;
+		NetworkDiskCacheIndex index { dir.path () };
+		const auto& a = MakeFile (dir, "a", 10);
+		const auto& b = MakeFile (dir, "b", 10);
+		const auto& c = MakeFile (dir, "c", 10);
+		index.Insert (a, 10);
+		index.Insert (b, 10);
+		index.Insert (c, 10);
+		index.Touch (a);
+
+		QCOMPARE (index.Evict (20), qint64 { 20 });
+		QCOMPARE (QFile::exists (a), true);
+		QCOMPARE (QFile::exists (b), false);
+		QCOMPARE (QFile::exists (c), true);
+	}
+
+	void NetworkDiskCacheIndexTest::testPersistence ()
+	{
+		QTemporaryDir dir;
+		const auto& a = MakeFile (dir, "a", 10);
+		const auto& b = MakeFile (dir, "b", 10);
+		{
+			NetworkDiskCacheIndex index { dir.path () };
+			index.Insert (a, 10);
+			index.Insert (b, 10);
+			index.Touch (a);
+		}
+
+		NetworkDiskCacheIndex index { dir.path () };
+		QCOMPARE (index.NeedsRebuild (), false);
+		QCOMPARE (index.GetFilesCount (), 2);
+		QCOMPARE (index.GetTotalSize (), qint64 { 20 });
+
+		index.Evict (10);
+		QCOMPARE (QFile::exists (a), true);
+		QCOMPARE (QFile::exists (b), false);
+	}
+
+	void NetworkDiskCacheIndexTest::testCrashAfterChanges ()
+	{
+		QTemporaryDir dir;
+		const auto& a = MakeFile (dir, "a", 10);
+		const auto& b = MakeFile (dir, "b", 10);
+		{
+			NetworkDiskCacheIndex index { dir.path () };
+			index.Insert (a, 10);
+		}
+
+		// Leaking the index simulates a crash: it's never saved again.
+		auto crashed = std::make_unique<NetworkDiskCacheIndex> (dir.path ());
+		QCOMPARE (crashed->NeedsRebuild (), false);
+		QVERIFY (crashed->Save ());
+		crashed->Insert (b, 10);
+		crashed.release ();
+
+		NetworkDiskCacheIndex index { dir.path () };
+		QCOMPARE (index.NeedsRebuild (), true);
+
+		index.Rebuild ();
+		QCOMPARE (index.GetFilesCount (), 2);
+		QCOMPARE (index.GetTotalSize (), qint64 { 20 });
+	}
+
+	void NetworkDiskCacheIndexTest::testCrashAfterSave ()
+	{
+		QTemporaryDir dir;
+		const auto& a = MakeFile (dir, "a", 10);
+
+		auto crashed = std::make_unique<NetworkDiskCacheIndex> (dir.path ());
+		crashed->Insert (a, 10);
+		QVERIFY (crashed->Save ());
+		crashed.release ();
+
+		NetworkDiskCacheIndex index { dir.path () };
+		QCOMPARE (index.NeedsRebuild (), false);
+		QCOMPARE (index.GetFilesCount (), 1);
+	}
+
+	void NetworkDiskCacheIndexTest::testRebuild ()
+	{
+		QTemporaryDir dir;
+		MakeFile (dir, "data8/a/1.d", 10);
+		MakeFile (dir, "data8/b/2.d", 20);
+		MakeFile (dir, "prepared/3.d", 40);
+
+		NetworkDiskCacheIndex index { dir.path () };
+		QCOMPARE (index.NeedsRebuild (), true);
+
+		index.Rebuild ();
+		QCOMPARE (index.NeedsRebuild (), false);
+		QCOMPARE (index.GetFilesCount (), 2);
+		QCOMPARE (index.GetTotalSize (), qint64 { 30 });
+	}
+
+	void NetworkDiskCacheIndexTest::testRebuildKeepsNewer ()
+	{
+		QTemporaryDir dir;
+		const auto& old = MakeFile (dir, "old", 10);
+		const auto& stale = MakeFile (dir, "stale", 10);
+
+		NetworkDiskCacheIndex index { dir.path () };
+		index.Insert (stale, 10);
+		QFile::remove (stale);
+		index.Rebuild ();
+
+		QCOMPARE (index.GetFilesCount (), 1);
+
+		index.Insert (MakeFile (dir, "new", 10), 10);
+		index.Evict (10);
+		QCOMPARE (QFile::exists (old), false);
+		QCOMPARE (index.GetTotalSize (), qint64 { 10 });
+	}
+
+	void NetworkDiskCacheIndexTest::benchInsert ()
+	{
+		QTemporaryDir dir;
+		QBENCHMARK
+		{
+			NetworkDiskCacheIndex index { dir.path () };
+			FillSynthetic (dir, index);
+			index.Clear ();
+		}
+	}
+
+	void NetworkDiskCacheIndexTest::benchTouch ()
+	{
+		QTemporaryDir dir;
+		NetworkDiskCacheIndex index { dir.path () };
+		FillSynthetic (dir, index);
+
+		QBENCHMARK
+		{
+			for (int i = 0; i < SyntheticEntriesCount; i += 7)
+				index.Touch (MakeSyntheticPath (dir, i));
+		}
+
+		index.Clear ();
+	}
+
+	void NetworkDiskCacheIndexTest::benchSaveLoad ()
+	{
+		QTemporaryDir dir;
+		auto index = std::make_unique<NetworkDiskCacheIndex> (dir.path ());
+		FillSynthetic (dir, *index);
+
+		QBENCHMARK
+		{
+			index.reset ();
+			index = std::make_unique<NetworkDiskCacheIndex> (dir.path ());
+		}
+
+		QCOMPARE (index->GetFilesCount (), SyntheticEntriesCount);
+		index->Clear ();
+	}
+
+	void NetworkDiskCacheIndexTest::benchEvict ()
+	{
+		QTemporaryDir dir;
+		NetworkDiskCacheIndex index { dir.path () };
+		FillSynthetic (dir, index);
+
+		const auto goal = SyntheticEntriesCount * SyntheticEntrySize * 9 / 10;
+		QBENCHMARK_ONCE
+		{
+			index.Evict (goal);
+		}
+
+		QCOMPARE (index.GetTotalSize (), goal);
+		index.Clear ();
+	}
+}
+}
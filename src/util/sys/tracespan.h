@@ -0,0 +1,118 @@
+/**********************************************************************
+ * LeechCraft - modular cross-platform feature rich internet client.
+ * Copyright (C) 2006-2014  Georg Rudoy
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ **********************************************************************/
+
+
+#pragma once
+
+#include <utility>
+#include <QString>
+#include <interfaces/core/itracer.h>
+
+namespace LeechCraft
+{
+namespace Util
+{
+	/** @brief Records a span covering the lifetime of this object.
+	 *
+	 * The span is recorded to the given tracer on the thread this
+	 * object is destroyed in, which should be the same thread it has
+	 * been created in. If the tracer is null or disabled at the
+	 * construction time, this class does nothing.
+	 *
+	 * Typical usage:
+	 * @code
+	 * void Foo::Bar ()
+	 * {
+	 *     Util::TraceSpan span { Proxy_->GetTracer (), "myplugin", "Foo::Bar" };
+	 *     ...
+	 * }
+	 * @endcode
+	 *
+	 * @sa ITracer
+	 */
+	class TraceSpan
+	{
+		ITracer * const Tracer_;
+		const char * const Category_;
+		const char * const Name_;
+		QString DynamicName_;
+		const qint64 Start_;
+	public:
+		/** @brief Starts a span with the given static name.
+		 *
+		 * @param[in] tracer The tracer to record the span to, possibly
+		 * null.
+		 * @param[in] category The category of the span.
+		 * @param[in] name The static name of the span.
+		 */
+		TraceSpan (ITracer *tracer, const char *category, const char *name)
+		: Tracer_ { tracer && tracer->IsEnabled () ? tracer : nullptr }
+		, Category_ { category }
+		, Name_ { name }
+		, Start_ { Tracer_ ? Tracer_->Now () : 0 }
+		{
+		}
+
+		/** @brief Starts a span with the name returned by the nameGetter.
+		 *
+		 * The nameGetter is only invoked if the tracing is enabled, so
+		 * the cost of building the name isn't paid otherwise.
+		 *
+		 * @param[in] tracer The tracer to record the span to, possibly
+		 * null.
+		 * @param[in] category The category of the span.
+		 * @param[in] nameGetter The function returning the name of the
+		 * span.
+		 */
+		template<typename F, typename = decltype (QString { std::declval<F> () () })>
+		TraceSpan (ITracer *tracer, const char *category, F&& nameGetter)
+		: Tracer_ { tracer && tracer->IsEnabled () ? tracer : nullptr }
+		, Category_ { category }
+		, Name_ { nullptr }
+		, DynamicName_ { Tracer_ ? nameGetter () : QString {} }
+		, Start_ { Tracer_ ? Tracer_->Now () : 0 }
+		{
+		}
+
+		~TraceSpan ()
+		{
+			if (!Tracer_)
+				return;
+
+			if (Name_)
+				Tracer_->AddSpan (Category_, Name_, Start_, Tracer_->Now ());
+			else
+				Tracer_->AddSpan (Category_, DynamicName_, Start_, Tracer_->Now ());
+		}
+
+		TraceSpan (const TraceSpan&) = delete;
+		TraceSpan& operator= (const TraceSpan&) = delete;
+	};
+}
+}
@@ -34,6 +34,9 @@
 #include <QString>
 #include <QApplication>
 #include <QTranslator>
+#include <QThread>
+#include <QTimer>
+#include <QSemaphore>
 #include <QLocale>
 #include <QFile>
 #include <QDir>
@@ -188,7 +191,23 @@ QTranslator* LeechCraft::Util::InstallTranslator (const QString& baseName,
 	const auto& localeName = GetLocaleName ();
 	if (auto transl = LoadTranslator (baseName, localeName, prefix, appName))
 	{
-		qApp->installTranslator (transl);
+		// plugins with thread-safe Init() may call this from a worker thread
+		const auto guiThread = qApp->thread ();
+		if (QThread::currentThread () == guiThread)
+			qApp->installTranslator (transl);
+		else
+		{
+			transl->moveToThread (guiThread);
+
+			QSemaphore installed;
+			QTimer::singleShot (0, qApp,
+					[transl, &installed]
+					{
+						qApp->installTranslator (transl);
+						installed.release ();
+					});
+			installed.acquire ();
+		}
 		return transl;
 	}
 
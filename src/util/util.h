@@ -130,6 +130,10 @@ namespace LeechCraft
 		 * on Windows and /usr/[local/]share/appname/translations on
 		 * Unix.
 		 *
+		 * This function may be called from a non-GUI thread, in which
+		 * case the translator is installed in the GUI thread, and the
+		 * function blocks until that's done.
+		 *
 		 * @param[in] base Base name of the translation file.
 		 * @param[in] prefix The optional prefix of the translation
 		 * (useful if it's not LC's one).